@@ -214,6 +214,7 @@ debug_arm=0
 
 is_asm=0
 is_extra_debugging=0
+is_log_elide_compute=0
 asan=""
 
 for arg in "$@"; do
@@ -257,6 +258,10 @@ for arg in "$@"; do
    if [ "$arg" = "-asan" ]; then
       asan="-asan"
    fi
+
+   if [ "$arg" = "-log_elide_compute" ]; then
+      is_log_elide_compute=1
+   fi
 done
 
 # TODO: this could be improved upon.  There is no perfect solution AFAIK for getting the script directory, and I'm not too sure how the CDPATH thing works
@@ -319,6 +324,7 @@ if [ $is_conda -eq 1 ]; then
    printf "%s\n" "LDLIBS=${LDLIBS}"
 
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/ApplyTermUpdate.cpp" -o "$tmp_path/ApplyTermUpdate.o"
+   ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/BinSumsBoostingQuantized.cpp" -o "$tmp_path/BinSumsBoostingQuantized.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/BoosterCore.cpp" -o "$tmp_path/BoosterCore.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/BoosterShell.cpp" -o "$tmp_path/BoosterShell.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/CalcInteractionStrength.cpp" -o "$tmp_path/CalcInteractionStrength.o"
@@ -339,6 +345,7 @@ if [ $is_conda -eq 1 ]; then
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/InteractionCore.cpp" -o "$tmp_path/InteractionCore.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/InteractionShell.cpp" -o "$tmp_path/InteractionShell.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/interpretable_numerics.cpp" -o "$tmp_path/interpretable_numerics.o"
+   ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/Offload.cpp" -o "$tmp_path/Offload.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/PartitionOneDimensionalBoosting.cpp" -o "$tmp_path/PartitionOneDimensionalBoosting.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/PartitionRandomBoosting.cpp" -o "$tmp_path/PartitionRandomBoosting.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/PartitionTwoDimensionalBoosting.cpp" -o "$tmp_path/PartitionTwoDimensionalBoosting.o"
@@ -355,6 +362,7 @@ if [ $is_conda -eq 1 ]; then
 
    ${CXX} ${LDFLAGS} -shared \
    "$tmp_path/ApplyTermUpdate.o" \
+   "$tmp_path/BinSumsBoostingQuantized.o" \
    "$tmp_path/BoosterCore.o" \
    "$tmp_path/BoosterShell.o" \
    "$tmp_path/CalcInteractionStrength.o" \
@@ -375,6 +383,7 @@ if [ $is_conda -eq 1 ]; then
    "$tmp_path/InteractionCore.o" \
    "$tmp_path/InteractionShell.o" \
    "$tmp_path/interpretable_numerics.o" \
+   "$tmp_path/Offload.o" \
    "$tmp_path/PartitionOneDimensionalBoosting.o" \
    "$tmp_path/PartitionRandomBoosting.o" \
    "$tmp_path/PartitionTwoDimensionalBoosting.o" \
@@ -420,6 +429,10 @@ fi
 if [ -n "$asan" ]; then
    all_args="$all_args -fsanitize=address,undefined -fno-sanitize-recover=address,undefined"
 fi
+if [ $is_log_elide_compute -ne 0 ]; then 
+   # compile the Trace_Info and Trace_Verbose logging out of the compute zones
+   all_args="$all_args -DLOG_ELIDE_COMPUTE"
+fi
 
 all_args="$all_args -I$src_path_sanitized/inc"
 
@@ -33,6 +33,7 @@ def boost(
     create_booster_flags,
     objective,
     experimental_params=None,
+    export_sample_scores=False,
 ):
     try:
         episode_index = 0
@@ -124,7 +125,13 @@ def boost(
                         noisy_update_tensor = -noisy_update_tensor
                         booster.set_term_update(term_idx, noisy_update_tensor)
 
-                    cur_metric = booster.apply_term_update()
+                    next_term_idx = -1
+                    if greedy_portion < 1.0 and term_idx + 1 < len(term_features):
+                        # in cyclic rounds we know the next term, so let the native code build
+                        # its histogram while the new gradients are still in the CPU cache
+                        next_term_idx = term_idx + 1
+
+                    cur_metric = booster.apply_term_update(next_term_idx)
 
                     min_metric = min(cur_metric, min_metric)
 
@@ -177,6 +184,19 @@ def boost(
             else:
                 model_update = booster.get_current_model()
 
-        return None, model_update, episode_index, rng
+            sample_scores = None
+            if export_sample_scores:
+                # the booster's own scores are held at the precision of its compute zone
+                # and belong to its last model, so sum the returned model in double instead
+                sample_scores = native.calc_sample_scores(
+                    dataset,
+                    bag,
+                    init_scores,
+                    booster._n_class_scores,
+                    term_features,
+                    model_update,
+                )
+
+        return None, model_update, episode_index, rng, sample_scores
     except Exception as e:
-        return e, None, None, None
+        return e, None, None, None, None
@@ -11,7 +11,7 @@ import os
 from ...utils._explanation import gen_perf_dicts
 from ._boost import boost
 from ._utils import (
-    make_bag,
+    make_bags,
     process_terms,
     order_terms,
     remove_unused_higher_bins,
@@ -725,7 +725,7 @@ class EBMModel(BaseEstimator):
         used_seeds = set()
         rngs = []
         internal_bags = []
-        for idx in range(self.outer_bags):
+        for _ in range(self.outer_bags):
             while True:
                 bagged_rng = native.branch_rng(rng)
                 check_seed = native.generate_seed(bagged_rng)
@@ -735,15 +735,20 @@ class EBMModel(BaseEstimator):
                 if check_seed not in used_seeds:
                     break
             used_seeds.add(check_seed)
+            rngs.append(bagged_rng)
 
-            if bags is None:
-                bag = make_bag(
-                    y,
-                    self.validation_size,
-                    bagged_rng,
-                    0 <= n_classes and not is_differential_privacy,
-                )
-            else:
+        if bags is None:
+            # the outer bags are independent, so build them all at once
+            internal_bags = make_bags(
+                y,
+                self.validation_size,
+                rngs,
+                0 <= n_classes and not is_differential_privacy,
+            )
+            if internal_bags is None:
+                internal_bags = [None] * self.outer_bags
+        else:
+            for idx in range(self.outer_bags):
                 bag = bags[idx]
                 if not isinstance(bag, np.ndarray):
                     bag = np.array(bag)
@@ -760,9 +765,7 @@ class EBMModel(BaseEstimator):
                     _log.error(msg)
                     raise ValueError(msg)
                 bag = bag.astype(np.int8, copy=not bag.flags.c_contiguous)
-
-            rngs.append(bagged_rng)
-            internal_bags.append(bag)
+                internal_bags.append(bag)
 
         bag_weights = []
         for bag in internal_bags:
@@ -846,6 +849,15 @@ class EBMModel(BaseEstimator):
             feature_types_in,
         )
 
+        # the interaction stage boosts on top of the main effects, so have each booster
+        # return its sample scores instead of predicting them again from X afterwards
+        if interactions is None:
+            export_sample_scores = False
+        elif isinstance(interactions, int) or isinstance(interactions, float):
+            export_sample_scores = 0 < interactions and n_classes <= 2
+        else:
+            export_sample_scores = len(interactions) != 0
+
         parallel_args = []
         for idx in range(self.outer_bags):
             early_stopping_rounds_local = early_stopping_rounds
@@ -889,6 +901,7 @@ class EBMModel(BaseEstimator):
                     else Native.CreateBoosterFlags_Default,
                     objective,
                     None,
+                    export_sample_scores,
                 )
             )
 
@@ -901,13 +914,22 @@ class EBMModel(BaseEstimator):
         breakpoint_iteration = [[]]
         models = []
         rngs = []
-        for exception, model, bag_breakpoint_iteration, bagged_rng in results:
+        scores_bags = []
+        for (
+            exception,
+            model,
+            bag_breakpoint_iteration,
+            bagged_rng,
+            sample_scores,
+        ) in results:
             if exception is not None:
                 raise exception
             breakpoint_iteration[-1].append(bag_breakpoint_iteration)
             models.append(model)
             # retrieve our rng state since this was used outside of our process
             rngs.append(bagged_rng)
+            scores_bags.append(sample_scores)
+        del results
 
         while True:  # this isn't for looping. Just for break statements to exit
             if interactions is None:
@@ -948,25 +970,8 @@ class EBMModel(BaseEstimator):
                 if len(interactions) == 0:
                     break
 
-            initial_intercept = np.zeros(n_scores, np.float64)
-            scores_bags = []
-            for model, bag in zip(models, internal_bags):
-                # TODO: instead of going back to the original data in X, we
-                # could use the compressed and already binned data in dataset
-                scores = ebm_predict_scores(
-                    X,
-                    n_samples,
-                    feature_names_in,
-                    feature_types_in,
-                    bins,
-                    initial_intercept,
-                    model,
-                    term_features,
-                    init_score,
-                )
-                if bag is not None and np.count_nonzero(bag) != len(bag):
-                    scores = scores[bag != 0]
-                scores_bags.append(scores)
+            # scores_bags holds the sample scores that each main effect booster
+            # exported, which already include init_score and exclude bag == 0
 
             dataset = bin_native_by_dimension(
                 n_classes,
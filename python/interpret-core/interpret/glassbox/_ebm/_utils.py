@@ -384,6 +384,15 @@ def make_bag(y, test_size, rng, is_stratified):
     # if we re-generate the train/test splits that they are generated exactly
     # the same as before
 
+    bags = make_bags(y, test_size, [rng], is_stratified)
+    return None if bags is None else bags[0]
+
+
+def make_bags(y, test_size, rngs, is_stratified):
+    # generates one bag per rng, identical to calling make_bag with each rng in
+    # turn. Stratified bags are generated together in a single native call that
+    # spreads the bags across threads
+
     if test_size == 0:
         return None
     elif test_size > 0:
@@ -412,12 +421,15 @@ def make_bag(y, test_size, rng, is_stratified):
                 n_test_samples = n_classes
                 n_train_samples = n_samples - n_test_samples
 
-            return native.sample_without_replacement_stratified(
-                rng, n_classes, n_train_samples, n_test_samples, y
+            return list(
+                native.sample_without_replacement_stratified_bags(
+                    rngs, n_classes, n_train_samples, n_test_samples, y
+                )
             )
         else:
-            return native.sample_without_replacement(
-                rng, n_train_samples, n_test_samples
-            )
+            return [
+                native.sample_without_replacement(rng, n_train_samples, n_test_samples)
+                for rng in rngs
+            ]
     else:  # pragma: no cover
         raise Exception("test_size must be a positive numeric value.")
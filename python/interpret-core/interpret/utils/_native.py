@@ -3,11 +3,13 @@
 
 # TODO: Add unit tests for internal EBM interfacing
 import platform
+import atexit
 import ctypes as ct
 from ctypes.util import find_library
 import numpy as np
 import os
 import struct
+import weakref
 import logging
 from contextlib import AbstractContextManager
 import sys
@@ -24,6 +26,32 @@ class Native:
     CreateBoosterFlags_Default = 0x00000000
     CreateBoosterFlags_DifferentialPrivacy = 0x00000001
     CreateBoosterFlags_DisableApprox = 0x00000002
+    CreateBoosterFlags_QuantizeGradients8 = 0x00000008
+    CreateBoosterFlags_QuantizeGradients16 = 0x00000010
+    CreateBoosterFlags_HostOffload = 0x00000020
+    CreateBoosterFlags_FeatureStorage = 0x00000040
+    CreateBoosterFlags_CollectStats = 0x00000100
+    CreateBoosterFlags_BagBits = 0x00000400
+    CreateBoosterFlags_PinThreads = 0x00000800
+
+    # booster statistics returned by GetBoosterStats
+    _booster_phases = [
+        "bin_sums_boosting",
+        "convert_add_bin",
+        "tensor_totals_build",
+        "partition_one_dimensional",
+        "partition_two_dimensional",
+        "apply_update",
+        "metric",
+        "best_model_copy",
+    ]
+    _booster_stats = ["nanoseconds", "calls", "bytes"]
+    _term_stats = [
+        "generate_calls",
+        "generate_nanoseconds",
+        "apply_calls",
+        "apply_nanoseconds",
+    ]
 
     # TermBoostFlags
     TermBoostFlags_Default = 0x00000000
@@ -36,6 +64,7 @@ class Native:
     CreateInteractionFlags_Default = 0x00000000
     CreateInteractionFlags_DifferentialPrivacy = 0x00000001
     CreateInteractionFlags_DisableApprox = 0x00000002
+    CreateInteractionFlags_EnableNewton = 0x00000008
 
     # CalcInteractionFlags
     CalcInteractionFlags_Default = 0x00000000
@@ -149,6 +178,16 @@ class Native:
             )
         elif error_code == -21:
             return Exception("Illegal value in y for the objective")
+        elif error_code == -22:
+            return Exception("Unrecognized metric type")
+        elif error_code == -23:
+            return Exception("Metric parameter unknown")
+        elif error_code == -24:
+            return Exception("Metric parameter value malformed")
+        elif error_code == -25:
+            return Exception("Metric parameter value out of range")
+        elif error_code == -26:
+            return Exception("Metric not supported by the objective")
         else:
             return Exception(
                 f"Unrecognized native return code {error_code} in {native_function}"
@@ -201,6 +240,9 @@ class Native:
             # self._log_callback_func, otherwise it will be garbage collected
             self._log_callback_func = self._LogCallbackType(native_log)
             self._unsafe.SetLogCallback(self._log_callback_func)
+            # at Trace_Info and above libebm delivers messages from its own thread. Lowering the level drains and
+            # stops that thread, which has to happen while the interpreter can still run native_log
+            atexit.register(self._unsafe.SetTraceLevel, self._Trace_Off)
 
         self._unsafe.SetTraceLevel(trace_level)
 
@@ -295,22 +337,83 @@ class Native:
         )
         return cuts[:count_cuts]
 
-    def cut_quantile(self, X_col, min_samples_bin, is_rounded, max_cuts):
+    def cut_quantile(
+        self, X_col, min_samples_bin, is_rounded, max_cuts, sample_weight=None
+    ):
         if max_cuts < 0:
             raise Exception(f"max_cuts can't be negative: {max_cuts}.")
 
         cuts = np.empty(max_cuts, dtype=np.float64, order="C")
         count_cuts = ct.c_int64(max_cuts)
-        return_code = self._unsafe.CutQuantile(
+        if sample_weight is None:
+            return_code = self._unsafe.CutQuantile(
+                X_col.shape[0],
+                Native._make_pointer(X_col, np.float64),
+                min_samples_bin,
+                is_rounded,
+                ct.byref(count_cuts),
+                Native._make_pointer(cuts, np.float64),
+            )
+            if return_code:  # pragma: no cover
+                raise Native._get_native_exception(return_code, "CutQuantile")
+        else:
+            # min_samples_bin still counts samples, but the cuts are placed on the weighted quantiles
+            return_code = self._unsafe.CutQuantileWeighted(
+                X_col.shape[0],
+                Native._make_pointer(X_col, np.float64),
+                Native._make_pointer(sample_weight, np.float64),
+                min_samples_bin,
+                is_rounded,
+                ct.byref(count_cuts),
+                Native._make_pointer(cuts, np.float64),
+            )
+            if return_code:  # pragma: no cover
+                raise Native._get_native_exception(return_code, "CutQuantileWeighted")
+
+        return cuts[: count_cuts.value]
+
+    def create_quantile_sketch(self, max_entries):
+        quantile_sketch_handle = ct.c_void_p(0)
+        return_code = self._unsafe.CreateQuantileSketch(
+            max_entries,
+            ct.byref(quantile_sketch_handle),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "CreateQuantileSketch")
+        return quantile_sketch_handle.value
+
+    def free_quantile_sketch(self, quantile_sketch_handle):
+        self._unsafe.FreeQuantileSketch(quantile_sketch_handle)
+
+    def quantile_sketch_add_samples(
+        self, quantile_sketch_handle, X_col, sample_weight=None
+    ):
+        return_code = self._unsafe.QuantileSketchAddSamples(
+            quantile_sketch_handle,
             X_col.shape[0],
             Native._make_pointer(X_col, np.float64),
+            Native._make_pointer(sample_weight, np.float64, is_null_allowed=True),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "QuantileSketchAddSamples")
+
+    def cut_quantile_sketch(
+        self, quantile_sketch_handle, min_samples_bin, is_rounded, max_cuts
+    ):
+        if max_cuts < 0:
+            raise Exception(f"max_cuts can't be negative: {max_cuts}.")
+
+        cuts = np.empty(max_cuts, dtype=np.float64, order="C")
+        count_cuts = ct.c_int64(max_cuts)
+        return_code = self._unsafe.CutQuantileSketch(
+            quantile_sketch_handle,
             min_samples_bin,
             is_rounded,
             ct.byref(count_cuts),
             Native._make_pointer(cuts, np.float64),
         )
         if return_code:  # pragma: no cover
-            raise Native._get_native_exception(return_code, "CutQuantile")
+            raise Native._get_native_exception(return_code, "CutQuantileSketch")
 
         return cuts[: count_cuts.value]
 
@@ -483,6 +586,173 @@ class Native:
         if return_code:  # pragma: no cover
             raise Native._get_native_exception(return_code, "FillRegressionTarget")
 
+    def create_dataset_builder(self, n_features, n_weights, n_targets):
+        dataset_builder_handle = ct.c_void_p(0)
+        return_code = self._unsafe.CreateDataSetBuilder(
+            n_features,
+            n_weights,
+            n_targets,
+            ct.byref(dataset_builder_handle),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "CreateDataSetBuilder")
+        return dataset_builder_handle.value
+
+    def free_dataset_builder(self, dataset_builder_handle):
+        self._unsafe.FreeDataSetBuilder(dataset_builder_handle)
+
+    def dataset_builder_add_feature(
+        self,
+        dataset_builder_handle,
+        n_bins,
+        is_missing,
+        is_unknown,
+        is_nominal,
+        bin_indexes,
+    ):
+        return_code = self._unsafe.DataSetBuilderAddFeature(
+            dataset_builder_handle,
+            n_bins,
+            is_missing,
+            is_unknown,
+            is_nominal,
+            len(bin_indexes),
+            Native._make_pointer(bin_indexes, np.int64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "DataSetBuilderAddFeature")
+
+    def dataset_builder_add_weight(self, dataset_builder_handle, weights):
+        return_code = self._unsafe.DataSetBuilderAddWeight(
+            dataset_builder_handle,
+            len(weights),
+            Native._make_pointer(weights, np.float64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "DataSetBuilderAddWeight")
+
+    def dataset_builder_add_classification_target(
+        self, dataset_builder_handle, n_classes, targets
+    ):
+        return_code = self._unsafe.DataSetBuilderAddClassificationTarget(
+            dataset_builder_handle,
+            n_classes,
+            len(targets),
+            Native._make_pointer(targets, np.int64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(
+                return_code, "DataSetBuilderAddClassificationTarget"
+            )
+
+    def dataset_builder_add_regression_target(self, dataset_builder_handle, targets):
+        return_code = self._unsafe.DataSetBuilderAddRegressionTarget(
+            dataset_builder_handle,
+            len(targets),
+            Native._make_pointer(targets, np.float64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(
+                return_code, "DataSetBuilderAddRegressionTarget"
+            )
+
+    def create_dataset_builder_chunked(
+        self,
+        n_samples,
+        bin_counts,
+        is_missing,
+        is_unknown,
+        is_nominal,
+        n_weights,
+        n_targets,
+        n_classes,
+        file_path=None,
+    ):
+        # n_classes is ignored when there is no target and Native.Task_Regression selects regression
+        bin_counts = np.ascontiguousarray(bin_counts, np.int64)
+        is_missing = np.ascontiguousarray(is_missing, np.int32)
+        is_unknown = np.ascontiguousarray(is_unknown, np.int32)
+        is_nominal = np.ascontiguousarray(is_nominal, np.int32)
+        is_classification = 0 <= n_classes
+
+        dataset_builder_handle = ct.c_void_p(0)
+        return_code = self._unsafe.CreateDataSetBuilderChunked(
+            n_samples,
+            len(bin_counts),
+            Native._make_pointer(bin_counts, np.int64),
+            Native._make_pointer(is_missing, np.int32),
+            Native._make_pointer(is_unknown, np.int32),
+            Native._make_pointer(is_nominal, np.int32),
+            n_weights,
+            n_targets,
+            1 if is_classification else 0,
+            n_classes if is_classification else 0,
+            None if file_path is None else file_path.encode("utf-8"),
+            ct.byref(dataset_builder_handle),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(
+                return_code, "CreateDataSetBuilderChunked"
+            )
+        return dataset_builder_handle.value
+
+    def dataset_builder_append_rows(
+        self, dataset_builder_handle, bin_indexes, weights=None, targets=None
+    ):
+        # bin_indexes is a (n_features, n_rows) array, so each feature's chunk is contiguous
+        n_rows = bin_indexes.shape[1]
+        if targets is not None:
+            if targets.dtype.type is np.float64:
+                targets = np.ascontiguousarray(targets)
+            else:
+                targets = np.ascontiguousarray(targets, np.int64)
+            target_pointer = targets.ctypes.data
+        else:
+            target_pointer = None
+
+        return_code = self._unsafe.DataSetBuilderAppendRows(
+            dataset_builder_handle,
+            n_rows,
+            Native._make_pointer(bin_indexes, np.int64, 2),
+            Native._make_pointer(weights, np.float64, is_null_allowed=True),
+            target_pointer,
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "DataSetBuilderAppendRows")
+
+    def finalize_dataset_builder_to_file(self, dataset_builder_handle):
+        # for builders created with a file_path. The returned size can be used with np.memmap
+        n_bytes = ct.c_int64(0)
+        return_code = self._unsafe.FinalizeDataSetBuilder(
+            dataset_builder_handle, ct.byref(n_bytes)
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "FinalizeDataSetBuilder")
+        return n_bytes.value
+
+    def finalize_dataset_builder(self, dataset_builder_handle):
+        n_bytes = ct.c_int64(0)
+        return_code = self._unsafe.FinalizeDataSetBuilder(
+            dataset_builder_handle, ct.byref(n_bytes)
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "FinalizeDataSetBuilder")
+
+        # take ownership of the native buffer instead of copying it so that the dataset
+        # is only held in memory once. The buffer is released with FreeDataSet when the
+        # last numpy array viewing it is garbage collected.
+        dataset_ptr = ct.c_void_p(0)
+        return_code = self._unsafe.DetachDataSetBuilder(
+            dataset_builder_handle, n_bytes.value, ct.byref(dataset_ptr)
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "DetachDataSetBuilder")
+
+        buffer = (ct.c_ubyte * n_bytes.value).from_address(dataset_ptr.value)
+        weakref.finalize(buffer, self._unsafe.FreeDataSet, dataset_ptr.value)
+        # joblib loky doesn't support RawArray, but it pickles this like any ndarray
+        return np.frombuffer(buffer, np.ubyte)
+
     def check_dataset(self, dataset):
         return_code = self._unsafe.CheckDataSet(
             dataset.nbytes,
@@ -535,6 +805,64 @@ class Native:
 
         return class_counts
 
+    def calc_sample_scores(
+        self, dataset, bag, init_scores, n_class_scores, term_features, term_scores
+    ):
+        """Returns the scores of a model on the samples of a dataset, summed in double.
+
+        Args:
+            dataset: The binned dataset that the terms were boosted on.
+            bag: None, or an int8 bag whose non-zero entries select the samples.
+            init_scores: None, or the init_scores of the selected samples.
+            n_class_scores: The number of scores per sample.
+            term_features: The feature indexes of each term.
+            term_scores: The tensor of each term, as returned by get_best_model.
+
+        Returns:
+            An ndarray with one row of scores per selected sample, in the original
+            sample order, in the layout of get_sample_scores.
+        """
+
+        n_samples, _, _, _ = self.extract_dataset_header(dataset)
+        if bag is not None:
+            if bag.shape[0] != n_samples:  # pragma: no cover
+                raise ValueError("bag should be len(n_samples)")
+            n_samples = np.count_nonzero(bag)
+
+        shape = (n_samples,) if n_class_scores == 1 else (n_samples, n_class_scores)
+        sample_scores = np.zeros(shape, np.float64, "C")
+        if n_samples == 0 or n_class_scores == 0:
+            return sample_scores
+
+        dimension_counts = np.array([len(x) for x in term_features], ct.c_int64)
+        feature_indexes = np.array(
+            [idx for x in term_features for idx in x], ct.c_int64
+        )
+        scores = np.empty(0, np.float64)
+        if len(term_scores) != 0:
+            scores = np.concatenate([np.ravel(x) for x in term_scores]).astype(
+                np.float64, copy=False
+            )
+
+        if init_scores is not None:
+            init_scores = init_scores.astype(np.float64, order="C", copy=False)
+
+        return_code = self._unsafe.CalcSampleScores(
+            Native._make_pointer(dataset, np.ubyte),
+            Native._make_pointer(bag, np.int8, 1, True),
+            Native._make_pointer(init_scores, np.float64, len(shape), True),
+            n_class_scores,
+            len(dimension_counts),
+            Native._make_pointer(dimension_counts, np.int64, 1, True),
+            Native._make_pointer(feature_indexes, np.int64, 1, True),
+            Native._make_pointer(scores, np.float64, 1, True),
+            Native._make_pointer(sample_scores, np.float64, len(shape)),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "CalcSampleScores")
+
+        return sample_scores
+
     def sample_without_replacement(
         self, rng, count_training_samples, count_validation_samples
     ):
@@ -586,6 +914,118 @@ class Native:
 
         return bag
 
+    def sample_without_replacement_stratified_bags(
+        self,
+        rngs,
+        n_classes,
+        count_training_samples,
+        count_validation_samples,
+        targets,
+        n_threads=0,
+    ):
+        # rngs holds one rng per bag, each of which is advanced exactly as
+        # sample_without_replacement_stratified would advance it
+        count_samples = count_training_samples + count_validation_samples
+
+        if len(targets) != count_samples:
+            raise ValueError(
+                "count_training_samples + count_validation_samples should be equal to len(targets)"
+            )
+
+        n_bags = len(rngs)
+        bags = np.empty((n_bags, count_samples), dtype=np.int8, order="C")
+        if n_bags == 0:
+            return bags
+
+        if not targets.flags.c_contiguous:
+            # targets could be a slice with a stride. We need contiguous for C
+            targets = targets.copy()
+
+        is_deterministic = rngs[0] is not None
+        if any((rng is not None) != is_deterministic for rng in rngs):
+            raise ValueError("rngs must be either all None or all not None")
+
+        rngs_joined = np.concatenate(rngs) if is_deterministic else None
+
+        return_code = self._unsafe.SampleWithoutReplacementStratifiedBags(
+            Native._make_pointer(rngs_joined, np.ubyte, is_null_allowed=True),
+            n_bags,
+            n_classes,
+            count_training_samples,
+            count_validation_samples,
+            Native._make_pointer(targets, np.int64),
+            n_threads,
+            Native._make_pointer(bags, np.int8, 2),
+        )
+
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(
+                return_code, "SampleWithoutReplacementStratifiedBags"
+            )
+
+        if is_deterministic:
+            for rng, rng_advanced in zip(rngs, np.split(rngs_joined, n_bags)):
+                rng[:] = rng_advanced
+
+        return bags
+
+    def sample_without_replacement_stratified_bag_bits(
+        self,
+        rngs,
+        n_classes,
+        count_training_samples,
+        count_validation_samples,
+        targets,
+        n_threads=0,
+    ):
+        # same bags as sample_without_replacement_stratified_bags, but each bag
+        # is a row of uint64 words with one bit per sample that is set for training
+        count_samples = count_training_samples + count_validation_samples
+
+        if len(targets) != count_samples:
+            raise ValueError(
+                "count_training_samples + count_validation_samples should be equal to len(targets)"
+            )
+
+        n_bags = len(rngs)
+        bag_bits = np.empty(
+            (n_bags, (count_samples + 63) // 64), dtype=np.uint64, order="C"
+        )
+        if n_bags == 0:
+            return bag_bits
+
+        if not targets.flags.c_contiguous:
+            # targets could be a slice with a stride. We need contiguous for C
+            targets = targets.copy()
+
+        is_deterministic = rngs[0] is not None
+        if any((rng is not None) != is_deterministic for rng in rngs):
+            raise ValueError("rngs must be either all None or all not None")
+
+        rngs_joined = np.concatenate(rngs) if is_deterministic else None
+
+        return_code = self._unsafe.SampleWithoutReplacementStratifiedBagBits(
+            Native._make_pointer(rngs_joined, np.ubyte, is_null_allowed=True),
+            n_bags,
+            n_classes,
+            count_training_samples,
+            count_validation_samples,
+            Native._make_pointer(targets, np.int64),
+            n_threads,
+            Native._make_pointer(bag_bits, np.uint64, 2),
+        )
+
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(
+                return_code, "SampleWithoutReplacementStratifiedBagBits"
+            )
+
+        if is_deterministic:
+            for rng, rng_advanced in zip(rngs, np.split(rngs_joined, n_bags)):
+                rng[:] = rng_advanced
+
+        return bag_bits
+
     def determine_task(self, objective):
         task = ct.c_int64(0)
 
@@ -862,6 +1302,64 @@ class Native:
         ]
         self._unsafe.CutQuantile.restype = ct.c_int32
 
+        self._unsafe.CutQuantileWeighted.argtypes = [
+            # int64_t countSamples
+            ct.c_int64,
+            # double * featureVals
+            ct.c_void_p,
+            # double * weights
+            ct.c_void_p,
+            # int64_t minSamplesBin
+            ct.c_int64,
+            # int32_t isRounded
+            ct.c_int32,
+            # int64_t * countCutsInOut
+            ct.POINTER(ct.c_int64),
+            # double * cutsLowerBoundInclusiveOut
+            ct.c_void_p,
+        ]
+        self._unsafe.CutQuantileWeighted.restype = ct.c_int32
+
+        self._unsafe.CreateQuantileSketch.argtypes = [
+            # int64_t countEntriesMax
+            ct.c_int64,
+            # void ** quantileSketchHandleOut
+            ct.POINTER(ct.c_void_p),
+        ]
+        self._unsafe.CreateQuantileSketch.restype = ct.c_int32
+
+        self._unsafe.QuantileSketchAddSamples.argtypes = [
+            # void * quantileSketchHandle
+            ct.c_void_p,
+            # int64_t countSamples
+            ct.c_int64,
+            # double * featureVals
+            ct.c_void_p,
+            # double * weights
+            ct.c_void_p,
+        ]
+        self._unsafe.QuantileSketchAddSamples.restype = ct.c_int32
+
+        self._unsafe.CutQuantileSketch.argtypes = [
+            # void * quantileSketchHandle
+            ct.c_void_p,
+            # int64_t minSamplesBin
+            ct.c_int64,
+            # int32_t isRounded
+            ct.c_int32,
+            # int64_t * countCutsInOut
+            ct.POINTER(ct.c_int64),
+            # double * cutsLowerBoundInclusiveOut
+            ct.c_void_p,
+        ]
+        self._unsafe.CutQuantileSketch.restype = ct.c_int32
+
+        self._unsafe.FreeQuantileSketch.argtypes = [
+            # void * quantileSketchHandle
+            ct.c_void_p
+        ]
+        self._unsafe.FreeQuantileSketch.restype = None
+
         self._unsafe.CutWinsorized.argtypes = [
             # int64_t countSamples
             ct.c_int64,
@@ -1030,47 +1528,213 @@ class Native:
         ]
         self._unsafe.FillRegressionTarget.restype = ct.c_int32
 
-        self._unsafe.CheckDataSet.argtypes = [
-            # int64_t countBytesAllocated
+        self._unsafe.CreateDataSetBuilder.argtypes = [
+            # int64_t countFeatures
             ct.c_int64,
-            # void * dataSet
-            ct.c_void_p,
+            # int64_t countWeights
+            ct.c_int64,
+            # int64_t countTargets
+            ct.c_int64,
+            # void ** dataSetBuilderHandleOut
+            ct.POINTER(ct.c_void_p),
         ]
-        self._unsafe.CheckDataSet.restype = ct.c_int32
+        self._unsafe.CreateDataSetBuilder.restype = ct.c_int32
 
-        self._unsafe.ExtractDataSetHeader.argtypes = [
-            # void * dataSet
+        self._unsafe.DataSetBuilderAddFeature.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+            # int64_t countBins
+            ct.c_int64,
+            # int32_t isMissing
+            ct.c_int32,
+            # int32_t isUnknown
+            ct.c_int32,
+            # int32_t isNominal
+            ct.c_int32,
+            # int64_t countSamples
+            ct.c_int64,
+            # int64_t * binIndexes
             ct.c_void_p,
-            # int64_t * countSamplesOut
-            ct.POINTER(ct.c_int64),
-            # int64_t * countFeaturesOut
-            ct.POINTER(ct.c_int64),
-            # int64_t * countWeightsOut
-            ct.POINTER(ct.c_int64),
-            # int64_t * countTargetsOut
-            ct.POINTER(ct.c_int64),
         ]
-        self._unsafe.ExtractDataSetHeader.restype = ct.c_int32
+        self._unsafe.DataSetBuilderAddFeature.restype = ct.c_int32
 
-        self._unsafe.ExtractBinCounts.argtypes = [
-            # void * dataSet
+        self._unsafe.DataSetBuilderAddWeight.argtypes = [
+            # void * dataSetBuilderHandle
             ct.c_void_p,
-            # int64_t countFeaturesVerify
+            # int64_t countSamples
             ct.c_int64,
-            # int64_t * binCountsOut
+            # double * weights
             ct.c_void_p,
         ]
-        self._unsafe.ExtractBinCounts.restype = ct.c_int32
+        self._unsafe.DataSetBuilderAddWeight.restype = ct.c_int32
 
-        self._unsafe.ExtractTargetClasses.argtypes = [
-            # void * dataSet
+        self._unsafe.DataSetBuilderAddClassificationTarget.argtypes = [
+            # void * dataSetBuilderHandle
             ct.c_void_p,
-            # int64_t countTargetsVerify
+            # int64_t countClasses
             ct.c_int64,
-            # int64_t * classCountsOut
+            # int64_t countSamples
+            ct.c_int64,
+            # int64_t * targets
             ct.c_void_p,
         ]
-        self._unsafe.ExtractTargetClasses.restype = ct.c_int32
+        self._unsafe.DataSetBuilderAddClassificationTarget.restype = ct.c_int32
+
+        self._unsafe.DataSetBuilderAddRegressionTarget.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+            # int64_t countSamples
+            ct.c_int64,
+            # double * targets
+            ct.c_void_p,
+        ]
+        self._unsafe.DataSetBuilderAddRegressionTarget.restype = ct.c_int32
+
+        self._unsafe.CreateDataSetBuilderChunked.argtypes = [
+            # int64_t countSamples
+            ct.c_int64,
+            # int64_t countFeatures
+            ct.c_int64,
+            # int64_t * binCounts
+            ct.c_void_p,
+            # int32_t * isMissing
+            ct.c_void_p,
+            # int32_t * isUnknown
+            ct.c_void_p,
+            # int32_t * isNominal
+            ct.c_void_p,
+            # int64_t countWeights
+            ct.c_int64,
+            # int64_t countTargets
+            ct.c_int64,
+            # int32_t isClassification
+            ct.c_int32,
+            # int64_t countClasses
+            ct.c_int64,
+            # const char * filePath
+            ct.c_char_p,
+            # void ** dataSetBuilderHandleOut
+            ct.POINTER(ct.c_void_p),
+        ]
+        self._unsafe.CreateDataSetBuilderChunked.restype = ct.c_int32
+
+        self._unsafe.DataSetBuilderAppendRows.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+            # int64_t countRows
+            ct.c_int64,
+            # int64_t * binIndexes
+            ct.c_void_p,
+            # double * weights
+            ct.c_void_p,
+            # void * targets
+            ct.c_void_p,
+        ]
+        self._unsafe.DataSetBuilderAppendRows.restype = ct.c_int32
+
+        self._unsafe.FinalizeDataSetBuilder.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+            # int64_t * countBytesOut
+            ct.POINTER(ct.c_int64),
+        ]
+        self._unsafe.FinalizeDataSetBuilder.restype = ct.c_int32
+
+        self._unsafe.CopyDataSetBuilder.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # void * dataSetOut
+            ct.c_void_p,
+        ]
+        self._unsafe.CopyDataSetBuilder.restype = ct.c_int32
+
+        self._unsafe.DetachDataSetBuilder.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # void ** dataSetOut
+            ct.POINTER(ct.c_void_p),
+        ]
+        self._unsafe.DetachDataSetBuilder.restype = ct.c_int32
+
+        self._unsafe.FreeDataSet.argtypes = [
+            # void * dataSet
+            ct.c_void_p
+        ]
+        self._unsafe.FreeDataSet.restype = None
+
+        self._unsafe.FreeDataSetBuilder.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p
+        ]
+        self._unsafe.FreeDataSetBuilder.restype = None
+
+        self._unsafe.CheckDataSet.argtypes = [
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # void * dataSet
+            ct.c_void_p,
+        ]
+        self._unsafe.CheckDataSet.restype = ct.c_int32
+
+        self._unsafe.ExtractDataSetHeader.argtypes = [
+            # void * dataSet
+            ct.c_void_p,
+            # int64_t * countSamplesOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * countFeaturesOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * countWeightsOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * countTargetsOut
+            ct.POINTER(ct.c_int64),
+        ]
+        self._unsafe.ExtractDataSetHeader.restype = ct.c_int32
+
+        self._unsafe.ExtractBinCounts.argtypes = [
+            # void * dataSet
+            ct.c_void_p,
+            # int64_t countFeaturesVerify
+            ct.c_int64,
+            # int64_t * binCountsOut
+            ct.c_void_p,
+        ]
+        self._unsafe.ExtractBinCounts.restype = ct.c_int32
+
+        self._unsafe.ExtractTargetClasses.argtypes = [
+            # void * dataSet
+            ct.c_void_p,
+            # int64_t countTargetsVerify
+            ct.c_int64,
+            # int64_t * classCountsOut
+            ct.c_void_p,
+        ]
+        self._unsafe.ExtractTargetClasses.restype = ct.c_int32
+
+        self._unsafe.CalcSampleScores.argtypes = [
+            # void * dataSet
+            ct.c_void_p,
+            # int8_t * bag
+            ct.c_void_p,
+            # double * initScores
+            ct.c_void_p,
+            # int64_t countScores
+            ct.c_int64,
+            # int64_t countTerms
+            ct.c_int64,
+            # int64_t * dimensionCounts
+            ct.c_void_p,
+            # int64_t * featureIndexes
+            ct.c_void_p,
+            # double * termScores
+            ct.c_void_p,
+            # double * sampleScoresOut
+            ct.c_void_p,
+        ]
+        self._unsafe.CalcSampleScores.restype = ct.c_int32
 
         self._unsafe.SampleWithoutReplacement.argtypes = [
             # void * rng
@@ -1100,6 +1764,46 @@ class Native:
         ]
         self._unsafe.SampleWithoutReplacementStratified.restype = ct.c_int32
 
+        self._unsafe.SampleWithoutReplacementStratifiedBags.argtypes = [
+            # void * rngs
+            ct.c_void_p,
+            # int64_t countBags
+            ct.c_int64,
+            # int64_t countClasses
+            ct.c_int64,
+            # int64_t countTrainingSamples
+            ct.c_int64,
+            # int64_t countValidationSamples
+            ct.c_int64,
+            # int64_t * targets
+            ct.c_void_p,
+            # int64_t countThreads
+            ct.c_int64,
+            # int8_t * bagsOut
+            ct.c_void_p,
+        ]
+        self._unsafe.SampleWithoutReplacementStratifiedBags.restype = ct.c_int32
+
+        self._unsafe.SampleWithoutReplacementStratifiedBagBits.argtypes = [
+            # void * rngs
+            ct.c_void_p,
+            # int64_t countBags
+            ct.c_int64,
+            # int64_t countClasses
+            ct.c_int64,
+            # int64_t countTrainingSamples
+            ct.c_int64,
+            # int64_t countValidationSamples
+            ct.c_int64,
+            # int64_t * targets
+            ct.c_void_p,
+            # int64_t countThreads
+            ct.c_int64,
+            # uint64_t * bagBitsOut
+            ct.c_void_p,
+        ]
+        self._unsafe.SampleWithoutReplacementStratifiedBagBits.restype = ct.c_int32
+
         self._unsafe.DetermineTask.argtypes = [
             # char * objective
             ct.c_char_p,
@@ -1190,6 +1894,32 @@ class Native:
         ]
         self._unsafe.GenerateTermUpdate.restype = ct.c_int32
 
+        self._unsafe.ComputeTermGains.argtypes = [
+            # void * rng
+            ct.c_void_p,
+            # void * boosterHandle
+            ct.c_void_p,
+            # int64_t countTerms
+            ct.c_int64,
+            # int64_t * indexTerms
+            ct.c_void_p,
+            # TermBoostFlags flags
+            ct.c_int32,
+            # double learningRate
+            ct.c_double,
+            # int64_t minSamplesLeaf
+            ct.c_int64,
+            # int64_t * leavesMax
+            ct.c_void_p,
+            # int64_t countThreads
+            ct.c_int64,
+            # double * avgGainsOut
+            ct.c_void_p,
+            # int64_t * indexTermBestOut
+            ct.POINTER(ct.c_int64),
+        ]
+        self._unsafe.ComputeTermGains.restype = ct.c_int32
+
         self._unsafe.GetTermUpdateSplits.argtypes = [
             # void * boosterHandle
             ct.c_void_p,
@@ -1228,6 +1958,16 @@ class Native:
         ]
         self._unsafe.ApplyTermUpdate.restype = ct.c_int32
 
+        self._unsafe.ApplyTermUpdateFused.argtypes = [
+            # void * boosterHandle
+            ct.c_void_p,
+            # int64_t indexTermNext
+            ct.c_int64,
+            # double * avgValidationMetricOut
+            ct.POINTER(ct.c_double),
+        ]
+        self._unsafe.ApplyTermUpdateFused.restype = ct.c_int32
+
         self._unsafe.GetBestTermScores.argtypes = [
             # void * boosterHandle
             ct.c_void_p,
@@ -1248,6 +1988,58 @@ class Native:
         ]
         self._unsafe.GetCurrentTermScores.restype = ct.c_int32
 
+        self._unsafe.GetSampleScores.argtypes = [
+            # void * boosterHandle
+            ct.c_void_p,
+            # int8_t direction
+            ct.c_int8,
+            # void * dataSet
+            ct.c_void_p,
+            # int8_t * bag
+            ct.c_void_p,
+            # double * sampleScoresOut
+            ct.c_void_p,
+        ]
+        self._unsafe.GetSampleScores.restype = ct.c_int32
+
+        self._unsafe.AddTerms.argtypes = [
+            # void * boosterHandle
+            ct.c_void_p,
+            # void * dataSet
+            ct.c_void_p,
+            # int8_t * bag
+            ct.c_void_p,
+            # int64_t countTerms
+            ct.c_int64,
+            # int64_t * dimensionCounts
+            ct.c_void_p,
+            # int64_t * featureIndexes
+            ct.c_void_p,
+        ]
+        self._unsafe.AddTerms.restype = ct.c_int32
+
+        self._unsafe.SetValidationMetric.argtypes = [
+            # void * boosterHandle
+            ct.c_void_p,
+            # const char * metric
+            ct.c_char_p,
+        ]
+        self._unsafe.SetValidationMetric.restype = ct.c_int32
+
+        self._unsafe.GetBoosterStats.argtypes = [
+            # void * boosterHandle
+            ct.c_void_p,
+            # int64_t countPhaseStats
+            ct.c_int64,
+            # int64_t * phaseStatsOut
+            ct.c_void_p,
+            # int64_t countTermStats
+            ct.c_int64,
+            # int64_t * termStatsOut
+            ct.c_void_p,
+        ]
+        self._unsafe.GetBoosterStats.restype = ct.c_int32
+
         self._unsafe.CreateInteractionDetector.argtypes = [
             # void * dataSet
             ct.c_void_p,
@@ -1312,7 +2104,8 @@ class Booster(AbstractContextManager):
 
         Args:
             dataset: binned data in a compressed native form
-            bag: definition of what data is included. 1 = training, -1 = validation, 0 = not included
+            bag: definition of what data is included. 1 = training, -1 = validation, 0 = not included.
+                A uint64 bag holds bag bits from sample_without_replacement_stratified_bag_bits instead
             init_scores: predictions from a prior predictor
                 that this class will boost on top of.  For regression
                 there is 1 score per sample.  For binary classification
@@ -1336,6 +2129,14 @@ class Booster(AbstractContextManager):
         # start off with an invalid _term_idx
         self._term_idx = -1
 
+    def _is_bag_bits(self):
+        return self.bag is not None and self.bag.dtype.type is np.uint64
+
+    def _bag_pointer(self):
+        if self._is_bag_bits():
+            return Native._make_pointer(self.bag, np.uint64)
+        return Native._make_pointer(self.bag, np.int8, 1, True)
+
     def __enter__(self):
         _log.info("Booster allocation start")
 
@@ -1380,11 +2181,17 @@ class Booster(AbstractContextManager):
             self._term_shapes.append(tuple(dimensions))
 
         n_bagged_samples = n_samples
-        if self.bag is not None:
+        if self._is_bag_bits():
+            if self.bag.shape[0] != (n_samples + 63) // 64:  # pragma: no cover
+                raise ValueError("bag bits should have one bit per sample")
+        elif self.bag is not None:
             if self.bag.shape[0] != n_samples:  # pragma: no cover
                 raise ValueError("bag should be len(n_samples)")
             n_bagged_samples = np.count_nonzero(self.bag)
 
+        self._n_class_scores = n_class_scores
+        self._n_bagged_samples = n_bagged_samples
+
         init_scores = self.init_scores
         if init_scores is not None:
             if not init_scores.flags.c_contiguous:
@@ -1412,13 +2219,15 @@ class Booster(AbstractContextManager):
         flags = self.create_booster_flags
         if not native.approximates:
             flags |= Native.CreateBoosterFlags_DisableApprox
+        if self._is_bag_bits():
+            flags |= Native.CreateBoosterFlags_BagBits
 
         # Allocate external resources
         booster_handle = ct.c_void_p(0)
         return_code = native._unsafe.CreateBooster(
             Native._make_pointer(self.rng, np.ubyte, is_null_allowed=True),
             Native._make_pointer(self.dataset, np.ubyte),
-            Native._make_pointer(self.bag, np.int8, 1, True),
+            self._bag_pointer(),
             Native._make_pointer(
                 init_scores, np.float64, 1 if 1 == n_class_scores else 2, True
             ),
@@ -1506,10 +2315,75 @@ class Booster(AbstractContextManager):
         # _log.debug("Boosting step end")
         return avg_gain.value
 
-    def apply_term_update(self):
+    def compute_term_gains(
+        self,
+        rng,
+        term_idxs,
+        term_boost_flags,
+        learning_rate,
+        min_samples_leaf,
+        max_leaves,
+        n_threads=0,
+        keep_best=True,
+    ):
+        """Generates boosting step updates for several terms in parallel
+            and returns their gains without applying any of them.
+
+        Args:
+            term_idxs: The indexes of the terms to evaluate
+            term_boost_flags: C interface options
+            learning_rate: Learning rate as a float.
+            min_samples_leaf: Min observations required to split.
+            max_leaves: Max leaf nodes on feature step.
+            n_threads: Number of threads, or 0 for one per hardware thread.
+            keep_best: If True, the update of the term with the highest gain
+                is kept so that apply_term_update commits it.
+
+        Returns:
+            Tuple of the gains for each of term_idxs, and the index of the
+            term whose update was kept, or -1 if none was kept.
+        """
+
+        self._term_idx = -1
+
+        native = Native.get_native_singleton()
+
+        term_idxs = np.array(term_idxs, dtype=ct.c_int64, order="C")
+        avg_gains = np.empty(len(term_idxs), dtype=np.float64, order="C")
+        if len(term_idxs) == 0:
+            return avg_gains, -1
+
+        n_features = max(len(self.term_features[idx]) for idx in term_idxs)
+        max_leaves_arr = np.full(n_features, max_leaves, dtype=ct.c_int64, order="C")
+        best_term_idx = ct.c_int64(-1)
+
+        return_code = native._unsafe.ComputeTermGains(
+            Native._make_pointer(rng, np.ubyte, is_null_allowed=True),
+            self._booster_handle,
+            len(term_idxs),
+            Native._make_pointer(term_idxs, np.int64),
+            term_boost_flags,
+            learning_rate,
+            min_samples_leaf,
+            Native._make_pointer(max_leaves_arr, np.int64),
+            n_threads,
+            Native._make_pointer(avg_gains, np.float64),
+            ct.byref(best_term_idx) if keep_best else None,
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "ComputeTermGains")
+
+        self._term_idx = best_term_idx.value
+
+        return avg_gains, best_term_idx.value
+
+    def apply_term_update(self, next_term_idx=-1):
         """Updates the interal C state with the last model update
 
         Args:
+            next_term_idx: If non-negative, the index of the term that will be passed
+                to the next generate_term_update call. Its histogram is then built
+                while the new gradients are still in the CPU cache.
 
         Returns:
             Validation loss for the boosting step.
@@ -1521,12 +2395,23 @@ class Booster(AbstractContextManager):
         native = Native.get_native_singleton()
 
         avg_validation_metric = ct.c_double(np.inf)
-        return_code = native._unsafe.ApplyTermUpdate(
-            self._booster_handle,
-            ct.byref(avg_validation_metric),
-        )
-        if return_code:  # pragma: no cover
-            raise Native._get_native_exception(return_code, "ApplyTermUpdate")
+        if next_term_idx < 0:
+            return_code = native._unsafe.ApplyTermUpdate(
+                self._booster_handle,
+                ct.byref(avg_validation_metric),
+            )
+            if return_code:  # pragma: no cover
+                raise Native._get_native_exception(return_code, "ApplyTermUpdate")
+        else:
+            return_code = native._unsafe.ApplyTermUpdateFused(
+                self._booster_handle,
+                next_term_idx,
+                ct.byref(avg_validation_metric),
+            )
+            if return_code:  # pragma: no cover
+                raise Native._get_native_exception(
+                    return_code, "ApplyTermUpdateFused"
+                )
 
         # _log.debug("Boosting step end")
         return avg_validation_metric.value
@@ -1560,6 +2445,155 @@ class Booster(AbstractContextManager):
 
         return splits
 
+    def get_sample_scores(self):
+        """Returns the current scores of the samples in the booster.
+
+        The scores include the init_scores that the booster started from, so they
+        can be passed directly as the init_scores of a later booster or
+        interaction detector on the same bag.
+
+        Returns:
+            An ndarray with one row of scores per sample that has a non-zero bag
+            entry, in the original sample order.
+        """
+
+        native = Native.get_native_singleton()
+
+        shape = (
+            (self._n_bagged_samples,)
+            if self._n_class_scores == 1
+            else (self._n_bagged_samples, self._n_class_scores)
+        )
+        sample_scores = np.zeros(shape, np.float64, "C")
+        if self._n_bagged_samples == 0 or self._n_class_scores == 0:
+            return sample_scores
+
+        for direction in (1, -1):
+            return_code = native._unsafe.GetSampleScores(
+                self._booster_handle,
+                direction,
+                Native._make_pointer(self.dataset, np.ubyte),
+                self._bag_pointer(),
+                Native._make_pointer(sample_scores, np.float64, len(shape)),
+            )
+            if return_code:  # pragma: no cover
+                raise Native._get_native_exception(return_code, "GetSampleScores")
+
+        return sample_scores
+
+    def add_terms(self, dataset, term_features):
+        """Appends terms to the booster, keeping its current scores.
+
+        Boosting continues from where it is, so the pair stage can start from
+        the state that the mains left behind without creating a new booster.
+
+        Args:
+            dataset: binned dataset with the same samples in the same order as
+                the dataset of the booster. Its features can be binned differently.
+            term_features: List of term feature indexes into dataset
+
+        Returns:
+            The indexes of the new terms.
+        """
+
+        native = Native.get_native_singleton()
+
+        n_samples, n_features, _, _ = native.extract_dataset_header(dataset)
+        n_bag_items = (n_samples + 63) // 64 if self._is_bag_bits() else n_samples
+        if self.bag is not None and self.bag.shape[0] != n_bag_items:  # pragma: no cover
+            raise ValueError("dataset should have the same samples as the booster")
+
+        dimension_counts = np.empty(len(term_features), ct.c_int64)
+        feature_indexes = []
+        for term_idx, feature_idxs in enumerate(term_features):
+            dimension_counts.itemset(term_idx, len(feature_idxs))
+            feature_indexes.extend(feature_idxs)
+        feature_indexes = np.array(feature_indexes, ct.c_int64)
+
+        return_code = native._unsafe.AddTerms(
+            self._booster_handle,
+            Native._make_pointer(dataset, np.ubyte),
+            self._bag_pointer(),
+            len(dimension_counts),
+            Native._make_pointer(dimension_counts, np.int64),
+            Native._make_pointer(feature_indexes, np.int64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "AddTerms")
+
+        bin_counts = native.extract_bin_counts(dataset, n_features)
+        term_idx_first = len(self.term_features)
+        self.term_features = list(self.term_features)
+        for feature_idxs in term_features:
+            dimensions = [bin_counts[feature_idx] for feature_idx in feature_idxs]
+            if self._n_class_scores != 1:
+                dimensions.append(self._n_class_scores)
+            self._term_shapes.append(tuple(dimensions))
+            self.term_features.append(feature_idxs)
+
+        return list(range(term_idx_first, len(self.term_features)))
+
+    def set_validation_metric(self, metric):
+        """Chooses the metric that apply_term_update returns and early stopping uses.
+
+        Args:
+            metric: name of a registered metric, eg "auc" for binary log_loss,
+                or None to use the metric of the objective. Metrics that should
+                be maximized are returned negated.
+        """
+
+        native = Native.get_native_singleton()
+
+        return_code = native._unsafe.SetValidationMetric(
+            self._booster_handle,
+            None if metric is None else metric.encode("ascii"),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "SetValidationMetric")
+
+    def get_stats(self):
+        """Returns the timing and memory counters collected while boosting.
+
+        The booster must have been created with CreateBoosterFlags_CollectStats.
+
+        Returns:
+            A dict with one entry per boosting phase, each holding the nanoseconds, calls, and
+            bytes for that phase, and a "terms" entry that holds a list with one dict per term.
+        """
+
+        native = Native.get_native_singleton()
+
+        n_phase_stats = len(Native._booster_phases) * len(Native._booster_stats)
+        phase_stats = np.zeros(n_phase_stats, np.int64)
+        n_term_stats = len(self.term_features) * len(Native._term_stats)
+        term_stats = np.zeros(n_term_stats, np.int64)
+
+        return_code = native._unsafe.GetBoosterStats(
+            self._booster_handle,
+            n_phase_stats,
+            Native._make_pointer(phase_stats, np.int64),
+            n_term_stats,
+            Native._make_pointer(term_stats, np.int64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "GetBoosterStats")
+
+        phase_stats = phase_stats.reshape(
+            (len(Native._booster_phases), len(Native._booster_stats))
+        )
+        term_stats = term_stats.reshape(
+            (len(self.term_features), len(Native._term_stats))
+        )
+
+        stats = {}
+        for phase, values in zip(Native._booster_phases, phase_stats):
+            stats[phase] = dict(zip(Native._booster_stats, (int(x) for x in values)))
+        stats["terms"] = [
+            dict(zip(Native._term_stats, (int(x) for x in values)))
+            for values in term_stats
+        ]
+        return stats
+
     def _get_best_term_scores(self, term_idx):
         """Returns best model/function according to validation set
             for a given term.
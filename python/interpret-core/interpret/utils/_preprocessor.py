@@ -30,7 +30,9 @@ _log = logging.getLogger(__name__)
 _none_list = [None]
 
 
-def _cut_continuous(native, X_col, processing, binning, max_bins, min_samples_bin):
+def _cut_continuous(
+    native, X_col, processing, binning, max_bins, min_samples_bin, sample_weight=None
+):
     # called under: fit
 
     if (
@@ -49,10 +51,14 @@ def _cut_continuous(native, X_col, processing, binning, max_bins, min_samples_bi
 
     if processing == "quantile":
         # one bin for missing, one bin for unknown, and # of cuts is one less again
-        cuts = native.cut_quantile(X_col, min_samples_bin, 0, max_bins - 3)
+        cuts = native.cut_quantile(
+            X_col, min_samples_bin, 0, max_bins - 3, sample_weight
+        )
     elif processing == "rounded_quantile":
         # one bin for missing, one bin for unknown, and # of cuts is one less again
-        cuts = native.cut_quantile(X_col, min_samples_bin, 1, max_bins - 3)
+        cuts = native.cut_quantile(
+            X_col, min_samples_bin, 1, max_bins - 3, sample_weight
+        )
     elif processing == "uniform":
         # one bin for missing, one bin for unknown, and # of cuts is one less again
         cuts = native.cut_uniform(X_col, max_bins - 3)
@@ -320,6 +326,7 @@ class EBMPreprocessor(BaseEstimator, TransformerMixin):
                         self.binning,
                         max_bins,
                         self.min_samples_bin,
+                        sample_weight,
                     )
                     bin_indexes = native.discretize(X_col, cuts)
                     feature_bin_weights = np.bincount(
@@ -25,6 +25,9 @@ from interpret.privacy import (
     DPExplainableBoostingRegressor,
 )
 from interpret.utils import inv_link
+from interpret.utils._native import Native
+from interpret.utils._clean_x import preclean_X
+from interpret.utils._compressed_dataset import bin_native_by_dimension
 
 from io import StringIO
 import json
@@ -1243,3 +1246,45 @@ def test_ebm_scale():
     assert len(clf.bagged_intercept_) == len(clf.bagged_scores_[0])
     assert len(clf.standard_deviations_) == 2
     assert len(clf.bin_weights_) == 2
+
+
+def test_calc_sample_scores_matches_predict():
+    X, y, names, types = make_synthetic(classes=2, missing=True, objects=False)
+
+    ebm = ExplainableBoostingClassifier(names, types, interactions=[(0, 1)])
+    ebm.fit(X, y)
+
+    X_clean, n_samples = preclean_X(X, ebm.feature_names_in_, ebm.feature_types_in_)
+    y_native = np.array(y, np.int64)
+
+    # the mains and the pair are binned at different resolutions, so each level has its own dataset
+    native = Native.get_native_singleton()
+    scores = np.full(n_samples, ebm.intercept_[0], np.float64)
+    for level in (1, 2):
+        term_idxs = [
+            term_idx
+            for term_idx, feature_idxs in enumerate(ebm.term_features_)
+            if min(len(feature_idxs), 2) == level
+        ]
+        dataset = bin_native_by_dimension(
+            2,
+            level,
+            ebm.bins_,
+            X_clean,
+            y_native,
+            None,
+            ebm.feature_names_in_,
+            ebm.feature_types_in_,
+        )
+        scores += native.calc_sample_scores(
+            dataset,
+            None,
+            None,
+            1,
+            [ebm.term_features_[term_idx] for term_idx in term_idxs],
+            [ebm.term_scores_[term_idx] for term_idx in term_idxs],
+        )
+
+    # both sum the same float64 tensors, so only the order of the additions differs
+    expected = ebm.decision_function(X)
+    assert np.allclose(scores, expected, rtol=1e-12, atol=1e-12)
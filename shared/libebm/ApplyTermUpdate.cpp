@@ -13,42 +13,207 @@
 #define ZONE_main
 #include "zones.h"
 
+#include "GradientPair.hpp"
+#include "Bin.hpp"
+
 #include "Feature.hpp"
 #include "Term.hpp"
+#include "InnerBag.hpp"
 #include "Transpose.hpp"
 #include "Tensor.hpp"
 #include "BoosterCore.hpp"
 #include "BoosterShell.hpp"
+#include "BoosterStats.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
-// we made this a global because if we had put this variable inside the BoosterCore object, then we would need to dereference that before 
-// getting the count.  By making this global we can send a log message incase a bad BoosterCore object is sent into us
-// we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more 
-// times than desired, but we can live with that
-static int g_cLogApplyTermUpdate = 10;
+extern void ConvertAddBin(
+   const size_t cScores,
+   const bool bHessian,
+   const size_t cBins,
+   const bool bUInt64Src,
+   const bool bDoubleSrc,
+   const void * const aSrc,
+   const bool bUInt64Dest,
+   const bool bDoubleDest,
+   void * const aAddDest
+);
+
+// When fusing we process the samples in chunks so that the gradients and hessians written by ApplyUpdate are
+// still in the CPU cache when BinSumsBoosting reads them back for the next term.  This is the approximate number of
+// gradient and hessian bytes in each chunk.
+static constexpr size_t k_cBytesFusedChunk = size_t { 1 } << 16;
+
+static size_t GreatestCommonDivisor(size_t a, size_t b) {
+   while(size_t { 0 } != b) {
+      const size_t remainder = a % b;
+      a = b;
+      b = remainder;
+   }
+   return a;
+}
 
-EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
-   BoosterHandle boosterHandle,
-   double * avgValidationMetricOut
+static ErrorEbm ApplyUpdateFused(
+   BoosterShell * const pBoosterShell,
+   DataSubsetBoosting * const pSubset,
+   ApplyUpdateBridge * const pData,
+   const size_t iTermNext
 ) {
    ErrorEbm error;
 
-   LOG_COUNTED_N(
-      &g_cLogApplyTermUpdate,
-      Trace_Info,
-      Trace_Verbose,
-      "ApplyTermUpdate: "
-      "boosterHandle=%p, "
-      "avgValidationMetricOut=%p"
-      ,
-      static_cast<void *>(boosterHandle),
-      static_cast<void *>(avgValidationMetricOut)
+   BoosterCore * const pBoosterCore = pBoosterShell->GetBoosterCore();
+   const Term * const pTermNext = pBoosterCore->GetTerms()[iTermNext];
+
+   const size_t cScores = pBoosterCore->GetCountScores();
+   const bool bHessian = pBoosterCore->IsHessian();
+   const size_t cTensorBins = pTermNext->GetCountTensorBins();
+   EBM_ASSERT(1 <= cTensorBins);
+
+   const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+   const size_t cUIntBytes = pSubset->GetObjectiveWrapper()->m_cUIntBytes;
+   const size_t cFloatBytes = pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+
+   EBM_ASSERT(1 <= pTermNext->GetBitsRequiredMin());
+   const int cPackNext = GetCountItemsBitPacked(pTermNext->GetBitsRequiredMin(), cUIntBytes);
+   const int cPackUpdate = pData->m_cPack;
+
+   // ApplyUpdate and BinSumsBoosting both put the leftover items in the first packed word, so after the first 
+   // chunk every chunk needs to start on a packed word boundary in both the updated term and the next term
+   size_t cGroupsAlign = static_cast<size_t>(cPackNext);
+   if(k_cItemsPerBitPackNone != cPackUpdate) {
+      const size_t cPackUpdateAlign = static_cast<size_t>(cPackUpdate);
+      cGroupsAlign = cGroupsAlign / GreatestCommonDivisor(cGroupsAlign, cPackUpdateAlign) * cPackUpdateAlign;
+   }
+
+   const size_t cBytesGradHessPerSample = cFloatBytes * cScores * (bHessian ? size_t { 2 } : size_t { 1 });
+   size_t cGroupsChunk = EbmMax(k_cBytesFusedChunk / (cBytesGradHessPerSample * cSIMDPack), size_t { 1 });
+   cGroupsChunk = (cGroupsChunk + cGroupsAlign - size_t { 1 }) / cGroupsAlign * cGroupsAlign;
+
+   size_t cBytesPerFastBin;
+   if(sizeof(UIntBig) == cUIntBytes) {
+      if(sizeof(FloatBig) == cFloatBytes) {
+         cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(bHessian, cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == cFloatBytes);
+         cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(bHessian, cScores);
+      }
+   } else {
+      EBM_ASSERT(sizeof(UIntSmall) == cUIntBytes);
+      if(sizeof(FloatBig) == cFloatBytes) {
+         cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(bHessian, cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == cFloatBytes);
+         cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(bHessian, cScores);
+      }
+   }
+   EBM_ASSERT(!IsMultiplyError(cBytesPerFastBin, cTensorBins));
+
+   BinBase * const aFastBins = pBoosterShell->GetBoostingFastBinsTemp();
+   EBM_ASSERT(nullptr != aFastBins);
+   aFastBins->ZeroMem(cBytesPerFastBin, cTensorBins);
+
+   // fusing is only enabled with zero or one inner bags, which both use the inner bag at index 0
+   const InnerBag * const pInnerBag = pSubset->GetInnerBag(0);
+
+   BinSumsBoostingBridge params;
+   params.m_bHessian = bHessian ? EBM_TRUE : EBM_FALSE;
+   params.m_cScores = cScores;
+   params.m_cPack = cPackNext;
+   params.m_aGradientsAndHessians = pData->m_aGradientsAndHessians;
+   params.m_aWeights = pInnerBag->GetWeights();
+   params.m_pCountOccurrences = pInnerBag->GetCountOccurrences();
+   params.m_aPacked = pSubset->GetTermData(iTermNext, pTermNext);
+   params.m_aFastBins = aFastBins;
+#ifndef NDEBUG
+   params.m_pDebugFastBinsEnd = IndexBin(aFastBins, cBytesPerFastBin * cTensorBins);
+#endif // NDEBUG
+
+   EBM_ASSERT(0 == pSubset->GetCountSamples() % cSIMDPack);
+   size_t cGroupsRemaining = pSubset->GetCountSamples() / cSIMDPack;
+   EBM_ASSERT(1 <= cGroupsRemaining);
+
+   // the first chunk takes the remainder so that it contains the partially filled first packed words
+   size_t cGroups = cGroupsRemaining % cGroupsChunk;
+   cGroups = size_t { 0 } == cGroups ? cGroupsChunk : cGroups;
+   do {
+      const size_t cSamples = cGroups * cSIMDPack;
+
+      pData->m_cSamples = cSamples;
+      error = pSubset->ObjectiveApplyUpdate(pData);
+      if(Error_None != error) {
+         return error;
+      }
+
+      params.m_cSamples = cSamples;
+      error = pSubset->BinSumsBoosting(&params);
+      if(Error_None != error) {
+         return error;
+      }
+
+      if(k_cItemsPerBitPackNone != cPackUpdate) {
+         const size_t cWords = (cGroups - size_t { 1 }) / static_cast<size_t>(cPackUpdate) + size_t { 1 };
+         pData->m_aPacked = IndexByte(pData->m_aPacked, cWords * cSIMDPack * cUIntBytes);
+      }
+      const size_t cWordsNext = (cGroups - size_t { 1 }) / static_cast<size_t>(cPackNext) + size_t { 1 };
+      params.m_aPacked = IndexByte(params.m_aPacked, cWordsNext * cSIMDPack * cUIntBytes);
+
+      if(nullptr != pData->m_aTargets) {
+         pData->m_aTargets = IndexByte(pData->m_aTargets, cSamples * pSubset->GetCountTargetBytes());
+      }
+      if(nullptr != pData->m_aSampleScores) {
+         pData->m_aSampleScores = IndexByte(pData->m_aSampleScores, cSamples * cScores * cFloatBytes);
+      }
+      pData->m_aGradientsAndHessians = IndexByte(pData->m_aGradientsAndHessians, cSamples * cBytesGradHessPerSample);
+      params.m_aGradientsAndHessians = pData->m_aGradientsAndHessians;
+
+      if(nullptr != params.m_aWeights) {
+         params.m_aWeights = IndexByte(params.m_aWeights, cSamples * cFloatBytes);
+      }
+      if(nullptr != params.m_pCountOccurrences) {
+         params.m_pCountOccurrences += cSamples;
+      }
+
+      cGroupsRemaining -= cGroups;
+      cGroups = cGroupsChunk;
+   } while(size_t { 0 } != cGroupsRemaining);
+
+   ConvertAddBin(
+      cScores,
+      bHessian,
+      cTensorBins,
+      sizeof(UIntBig) == cUIntBytes,
+      sizeof(FloatBig) == cFloatBytes,
+      aFastBins,
+      std::is_same<UIntMain, uint64_t>::value,
+      std::is_same<FloatMain, double>::value,
+      pBoosterShell->GetBoostingMainBins()
    );
 
+   return Error_None;
+}
+
+static size_t GetCountBytesApplyUpdate(const DataSubsetBoosting * const pSubset, const ApplyUpdateBridge * const pData) {
+   // an estimate of the memory streamed: the packed bins, targets, sample scores, and gradients (and hessians)
+   const size_t cSamples = pSubset->GetCountSamples();
+   const size_t cFloatBytes = pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+   size_t cBytes = cSamples * pSubset->GetCountTargetBytes();
+   cBytes += cSamples * pData->m_cScores * cFloatBytes * (EBM_FALSE != pData->m_bHessianNeeded ? size_t { 3 } : size_t { 2 });
+   if(k_cItemsPerBitPackNone != pData->m_cPack) {
+      cBytes += cSamples / static_cast<size_t>(pData->m_cPack) * pSubset->GetObjectiveWrapper()->m_cUIntBytes;
+   }
+   return cBytes;
+}
+
+static ErrorEbm ApplyTermUpdateInternal(
+   BoosterHandle boosterHandle,
+   const IntEbm indexTermNext,
+   double * const avgValidationMetricOut
+) {
+   ErrorEbm error;
+
    if(LIKELY(nullptr != avgValidationMetricOut)) {
       // returning +inf means that boosting won't consider this to be an improvement.  After a few cycles
       // it should exit with the last model that was good if the error was ignored (it shouldn't be ignored though)
@@ -61,6 +226,9 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
       return Error_IllegalParamVal;
    }
 
+   // the gradients are about to change, so any histogram that was fused during the last update is stale
+   pBoosterShell->SetFusedTermIndex(BoosterShell::k_illegalTermIndex);
+
    const size_t iTerm = pBoosterShell->GetTermIndex();
    if(BoosterShell::k_illegalTermIndex == iTerm) {
       LOG_0(Trace_Error, "ERROR ApplyTermUpdate bad internal state.  No Term index set");
@@ -72,6 +240,18 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
    EBM_ASSERT(iTerm < pBoosterCore->GetCountTerms());
    EBM_ASSERT(nullptr != pBoosterCore->GetTerms());
 
+   // the sample scores, gradients and models are shared with every view, so wait until no other view is using them
+   const BoosterCoreGate gate(pBoosterCore, false);
+   pBoosterCore->IncrementGradientVersion();
+
+   BoosterStats * const pStats = pBoosterShell->GetStats();
+   const uint64_t tStartTerm = BoosterStats::Start(pStats);
+
+   if(static_cast<IntEbm>(pBoosterCore->GetCountTerms()) <= indexTermNext) {
+      LOG_0(Trace_Error, "ERROR ApplyTermUpdate indexTermNext above the number of terms that we have");
+      return Error_IllegalParamVal;
+   }
+
    pBoosterShell->SetTermIndex(BoosterShell::k_illegalTermIndex);
 
    Term * const pTerm = pBoosterCore->GetTerms()[iTerm];
@@ -136,6 +316,36 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
 
    double validationMetricAvg = 0.0;
 
+   OffloadQueue * const pOffloadQueue = pBoosterCore->GetOffloadQueue();
+
+   size_t iTermFused = BoosterShell::k_illegalTermIndex;
+   if(IntEbm { 0 } <= indexTermNext &&
+      0 != pBoosterCore->GetTrainingSet()->GetCountSamples() &&
+      pBoosterCore->GetCountInnerBags() <= size_t { 1 } &&
+      size_t { 0 } == pBoosterCore->GetCountBytesQuantized() &&
+      nullptr == pOffloadQueue
+   ) {
+      // With multiple inner bags we would need a histogram per bag, and quantized gradients are already
+      // calculated in chunks by ApplyUpdateQuantized, so we only fuse in the simpler cases.
+      // Offloaded subsets are already split across the worker threads so they do not fuse either
+      const Term * const pTermNext = pBoosterCore->GetTerms()[static_cast<size_t>(indexTermNext)];
+      if(size_t { 0 } != pTermNext->GetCountTensorBins() && 1 <= pTermNext->GetBitsRequiredMin()) {
+         iTermFused = static_cast<size_t>(indexTermNext);
+
+         const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(pBoosterCore->IsHessian(), pBoosterCore->GetCountScores());
+         EBM_ASSERT(!IsMultiplyError(cBytesPerMainBin, pTermNext->GetCountTensorBins()));
+         EBM_ASSERT(nullptr != pBoosterShell->GetBoostingMainBins());
+         memset(pBoosterShell->GetBoostingMainBins(), 0, cBytesPerMainBin * pTermNext->GetCountTensorBins());
+      }
+   }
+
+
+   if(0 != pBoosterCore->GetValidationSet()->GetCountSamples() && nullptr != pBoosterCore->GetMetricBins()) {
+      // the validation subsets, and the offloaded slices of them, all add into these bins. This happens before the
+      // loop below since subsets in different zones are updated on different iterations of it
+      pBoosterCore->ZeroMetricBins();
+      pBoosterCore->PrepareMetricScoreRange(aUpdateScores, pTerm->GetCountTensorBins());
+   }
 
    static_assert(std::is_same<FloatBig, FloatScore>::value || std::is_same<FloatSmall, FloatScore>::value,
       "FloatScore must be either FloatBig or FloatSmall");
@@ -161,15 +371,31 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
                data.m_aMulticlassMidwayTemp = pBoosterShell->GetMulticlassMidwayTemp();
                data.m_aUpdateTensorScores = aUpdateScores;
                data.m_cSamples = pSubset->GetCountSamples();
-               data.m_aPacked = pSubset->GetTermData(iTerm);
+               data.m_aPacked = pSubset->GetTermData(iTerm, pTerm);
                data.m_aTargets = pSubset->GetTargetData();
                data.m_aWeights = nullptr;
                data.m_aSampleScores = pSubset->GetSampleScores();
                data.m_aGradientsAndHessians = pSubset->GetGradHess();
-               error = pSubset->ObjectiveApplyUpdate(&data);
+               data.m_cMetricBins = 0;
+               data.m_aMetricBins = nullptr;
+               const size_t cBytesApplyUpdate = GetCountBytesApplyUpdate(pSubset, &data);
+               const uint64_t tStart = BoosterStats::Start(pStats);
+               if(size_t { 0 } != pBoosterCore->GetCountBytesQuantized()) {
+                  error = pBoosterCore->GetTrainingSet()->ApplyUpdateQuantized(
+                     pSubset, &data, pBoosterCore->GetCountBytesQuantized());
+               } else if(nullptr != pOffloadQueue) {
+                  // the training subsets do not depend on each other so we submit them all before waiting
+                  error = pOffloadQueue->EnqueueApplyUpdate(
+                     pSubset->GetObjectiveWrapper(), &data, pSubset->GetCountTargetBytes(), nullptr);
+               } else if(BoosterShell::k_illegalTermIndex != iTermFused) {
+                  error = ApplyUpdateFused(pBoosterShell, pSubset, &data, iTermFused);
+               } else {
+                  error = pSubset->ObjectiveApplyUpdate(&data);
+               }
                if(Error_None != error) {
                   return error;
                }
+               BoosterStats::Stop(pStats, BoosterPhase_ApplyUpdate, tStart, cBytesApplyUpdate);
             }
             ++pSubset;
          } while(pSubsetsEnd != pSubset);
@@ -207,20 +433,48 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
                data.m_aMulticlassMidwayTemp = pBoosterShell->GetMulticlassMidwayTemp();
                data.m_aUpdateTensorScores = aUpdateScores;
                data.m_cSamples = pSubset->GetCountSamples();
-               data.m_aPacked = pSubset->GetTermData(iTerm);
+               data.m_aPacked = pSubset->GetTermData(iTerm, pTerm);
                data.m_aTargets = pSubset->GetTargetData();
                data.m_aWeights = pSubset->GetInnerBag(0)->GetWeights();
                data.m_aSampleScores = pSubset->GetSampleScores();
                data.m_aGradientsAndHessians = pSubset->GetGradHess();
-               error = pSubset->ObjectiveApplyUpdate(&data);
-               if(Error_None != error) {
-                  return error;
+               data.m_cMetricBins = pBoosterCore->GetCountMetricBins();
+               data.m_aMetricBins = pBoosterCore->GetMetricBins();
+               if(nullptr != data.m_aMetricBins) {
+                  data.m_metricScoreLow = pBoosterCore->GetMetricScoreLow();
+                  data.m_metricScoreScale = pBoosterCore->GetMetricScoreScale();
+               }
+               const size_t cBytesMetric = GetCountBytesApplyUpdate(pSubset, &data);
+               const uint64_t tStart = BoosterStats::Start(pStats);
+               if(nullptr != pOffloadQueue) {
+                  // the metric is added to validationMetricAvg when the command completes
+                  error = pOffloadQueue->EnqueueApplyUpdate(
+                     pSubset->GetObjectiveWrapper(), &data, pSubset->GetCountTargetBytes(), &validationMetricAvg);
+                  if(Error_None != error) {
+                     return error;
+                  }
+               } else {
+                  error = pSubset->ObjectiveApplyUpdate(&data);
+                  if(Error_None != error) {
+                     return error;
+                  }
+                  validationMetricAvg += data.m_metricOut;
                }
-               validationMetricAvg += data.m_metricOut;
+               BoosterStats::Stop(pStats, BoosterPhase_Metric, tStart, cBytesMetric);
             }
             ++pSubset;
          } while(pSubsetsEnd != pSubset);
       }
+      if(nullptr != pOffloadQueue) {
+         // the update scores are read by the queued commands, so wait before converting them below
+         const uint64_t tStart = BoosterStats::Start(pStats);
+         error = pOffloadQueue->Synchronize();
+         if(Error_None != error) {
+            return error;
+         }
+         // the training and validation commands run together on the queue, so the wait is attributed to both as one
+         BoosterStats::AddTime(pStats, BoosterPhase_ApplyUpdate, tStart);
+      }
       if(!bIgnored) {
          break;
       }
@@ -249,25 +503,38 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
       } while(pUpdateBigEnd != pUpdateBig);
    }
 
-   if(0 != pBoosterCore->GetValidationSet()->GetCountSamples()) {
-      validationMetricAvg = pBoosterCore->FinishMetric(validationMetricAvg);
+   pBoosterShell->SetFusedTermIndex(iTermFused);
+   pBoosterShell->SetFusedGradientVersion(pBoosterCore->GetGradientVersion());
 
-      if(EBM_FALSE != pBoosterCore->MaximizeMetric()) {
-         // make it so that we always return values such that the caller wants to minimize them. If the caller
-         // wants more information they can determine if they should negate the values we return them.
-         validationMetricAvg = -validationMetricAvg;
+   if(0 != pBoosterCore->GetValidationSet()->GetCountSamples()) {
+      if(nullptr != pBoosterCore->GetMetricBins()) {
+         // registered metrics are computed over the whole validation set, so they are not averaged by weight
+         validationMetricAvg = pBoosterCore->FinishMetricBins();
+         pBoosterCore->ShrinkMetricScoreRange();
+
+         if(EBM_FALSE != pBoosterCore->MaximizeMetricBins()) {
+            validationMetricAvg = -validationMetricAvg;
+         }
+      } else {
+         validationMetricAvg = pBoosterCore->FinishMetric(validationMetricAvg);
+
+         if(EBM_FALSE != pBoosterCore->MaximizeMetric()) {
+            // make it so that we always return values such that the caller wants to minimize them. If the caller
+            // wants more information they can determine if they should negate the values we return them.
+            validationMetricAvg = -validationMetricAvg;
+         }
+
+         EBM_ASSERT(!std::isnan(validationMetricAvg)); // NaNs can happen, but we should have cleaned them up
+
+         const double totalWeight = pBoosterCore->GetValidationSet()->GetBagWeightTotal(0);
+         EBM_ASSERT(!std::isnan(totalWeight));
+         EBM_ASSERT(!std::isinf(totalWeight));
+         EBM_ASSERT(0.0 < totalWeight);
+         validationMetricAvg /= totalWeight; // if totalWeight < 1.0 then this can overflow to +inf
       }
 
       EBM_ASSERT(!std::isnan(validationMetricAvg)); // NaNs can happen, but we should have cleaned them up
 
-      const double totalWeight = pBoosterCore->GetValidationSet()->GetBagWeightTotal(0);
-      EBM_ASSERT(!std::isnan(totalWeight));
-      EBM_ASSERT(!std::isinf(totalWeight));
-      EBM_ASSERT(0.0 < totalWeight);
-      validationMetricAvg /= totalWeight; // if totalWeight < 1.0 then this can overflow to +inf
-
-      EBM_ASSERT(!std::isnan(validationMetricAvg)); // NaNs can happen, but we should have cleaned them up
-
       if(LIKELY(validationMetricAvg < pBoosterCore->GetBestModelMetric())) {
          // we keep on improving, so this is more likely than not, and we'll exit if it becomes negative a lot
          pBoosterCore->SetBestModelMetric(validationMetricAvg);
@@ -286,6 +553,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
          // with 1 pointer entry for each term.  If a term is already in the linked list there is no need to add it
          // again.  This way we can avoid a sweep of the entire list of terms on each boosting round.
 
+         const uint64_t tStart = BoosterStats::Start(pStats);
+         size_t cBytesCopy = 0;
          size_t iTermCopy = 0;
          size_t iTermCopyEnd = pBoosterCore->GetCountTerms();
          do {
@@ -296,11 +565,14 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
                   LOG_0(Trace_Verbose, "Exited ApplyTermUpdateInternal with memory allocation error in copy");
                   return error;
                }
+               cBytesCopy += pBoosterCore->GetTerms()[iTermCopy]->GetCountTensorBins() * 
+                  pBoosterCore->GetCountScores() * sizeof(FloatScore);
             } else {
                EBM_ASSERT(nullptr == pBoosterCore->GetBestModel()[iTermCopy]);
             }
             ++iTermCopy;
          } while(iTermCopy != iTermCopyEnd);
+         BoosterStats::Stop(pStats, BoosterPhase_BestModelCopy, tStart, cBytesCopy);
       }
    }
    
@@ -318,9 +590,64 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
       validationMetricAvg
    );
 
+   BoosterStats::StopTerm(pStats, iTerm, TermStat_ApplyCalls, tStartTerm);
+
    return Error_None;
 }
 
+// we made this a global because if we had put this variable inside the BoosterCore object, then we would need to dereference that before 
+// getting the count.  By making this global we can send a log message incase a bad BoosterCore object is sent into us
+// we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more 
+// times than desired, but we can live with that
+static int g_cLogApplyTermUpdate = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
+   BoosterHandle boosterHandle,
+   double * avgValidationMetricOut
+) {
+   LOG_COUNTED_N(
+      &g_cLogApplyTermUpdate,
+      Trace_Info,
+      Trace_Verbose,
+      "ApplyTermUpdate: "
+      "boosterHandle=%p, "
+      "avgValidationMetricOut=%p"
+      ,
+      static_cast<void *>(boosterHandle),
+      static_cast<void *>(avgValidationMetricOut)
+   );
+
+   return ApplyTermUpdateInternal(boosterHandle, IntEbm { -1 }, avgValidationMetricOut);
+}
+
+// we made this a global because if we had put this variable inside the BoosterCore object, then we would need to dereference that before 
+// getting the count.  By making this global we can send a log message incase a bad BoosterCore object is sent into us
+// we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more 
+// times than desired, but we can live with that
+static int g_cLogApplyTermUpdateFused = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdateFused(
+   BoosterHandle boosterHandle,
+   IntEbm indexTermNext,
+   double * avgValidationMetricOut
+) {
+   LOG_COUNTED_N(
+      &g_cLogApplyTermUpdateFused,
+      Trace_Info,
+      Trace_Verbose,
+      "ApplyTermUpdateFused: "
+      "boosterHandle=%p, "
+      "indexTermNext=%" IntEbmPrintf ", "
+      "avgValidationMetricOut=%p"
+      ,
+      static_cast<void *>(boosterHandle),
+      indexTermNext,
+      static_cast<void *>(avgValidationMetricOut)
+   );
+
+   return ApplyTermUpdateInternal(boosterHandle, indexTermNext, avgValidationMetricOut);
+}
+
 // we made this a global because if we had put this variable inside the BoosterCore object, then we would need to dereference that before 
 // getting the count.  By making this global we can send a log message incase a bad BoosterCore object is sent into us
 // we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more 
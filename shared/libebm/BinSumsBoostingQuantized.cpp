@@ -0,0 +1,158 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memset
+#include <type_traits> // std::conditional
+
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h"
+
+#define ZONE_main
+#include "zones.h"
+
+#include "GradientPair.hpp"
+#include "Bin.hpp"
+
+#include "ebm_internal.hpp"
+#include "DataSetBoosting.hpp"
+#include "InnerBag.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// The quantized version of BinSumsBoosting reads the int8/int16 gradients and hessians in the compute zone, where
+// BinSumsBoostingQuantized<TFloat> adds them into 64 bit integer words (or doubles if there are weights) in the fast
+// bins. Without weights the sums are exact. Here in the main zone we convert those words into the floating point 
+// main bins, applying the scale of each gradient and hessian slot once per bin instead of once per sample.
+
+template<bool bHessian, bool bWeight>
+static void ConvertQuantizedBins(
+   const size_t cScores,
+   const size_t cTensorBins,
+   const double * const aQuantizeScales,
+   const void * const aFastBins,
+   BinBase * const aMainBinsBase
+) {
+   typedef typename std::conditional<bWeight, double, int64_t>::type TSum;
+
+   static constexpr size_t cSlotsPerScore = bHessian ? size_t { 2 } : size_t { 1 };
+   const size_t cWordsPerBin = k_cQuantizedBinHeaderWords + cScores * cSlotsPerScore;
+
+   auto * const aMainBins = aMainBinsBase->Specialize<FloatMain, UIntMain, bHessian>();
+   const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(bHessian, cScores);
+
+   const TSum * pFastBin = static_cast<const TSum *>(aFastBins);
+   size_t iTensorBin = 0;
+   do {
+      auto * const pMainBin = IndexBin(aMainBins, cBytesPerMainBin * iTensorBin);
+
+      const UIntMain cSamples = static_cast<UIntMain>(pFastBin[0]);
+      pMainBin->SetCountSamples(pMainBin->GetCountSamples() + cSamples);
+      // without weights the kernel leaves the weight word alone since it equals the count
+      pMainBin->SetWeight(pMainBin->GetWeight() + (bWeight ? static_cast<FloatMain>(pFastBin[1]) : static_cast<FloatMain>(cSamples)));
+
+      const TSum * const aSums = pFastBin + k_cQuantizedBinHeaderWords;
+      auto * const aGradientPairs = pMainBin->GetGradientPairs();
+      size_t iScore = 0;
+      do {
+         auto * const pGradientPair = &aGradientPairs[iScore];
+         const size_t iSlot = iScore * cSlotsPerScore;
+         pGradientPair->m_sumGradients +=
+            static_cast<FloatMain>(static_cast<double>(aSums[iSlot]) * aQuantizeScales[iSlot]);
+         if(bHessian) {
+            pGradientPair->SetHess(pGradientPair->GetHess() +
+               static_cast<FloatMain>(static_cast<double>(aSums[iSlot + 1]) * aQuantizeScales[iSlot + 1]));
+         }
+         ++iScore;
+      } while(cScores != iScore);
+
+      pFastBin += cWordsPerBin;
+      ++iTensorBin;
+   } while(cTensorBins != iTensorBin);
+}
+
+extern ErrorEbm BinSumsBoostingQuantized(
+   const bool bHessian,
+   const size_t cScores,
+   const size_t cBytesQuantized,
+   const int cPack,
+   DataSubsetBoosting * const pSubset,
+   const InnerBag * const pInnerBag,
+   const void * const aPacked,
+   const size_t cTensorBins,
+   void * const aFastBins,
+   BinBase * const aMainBins
+) {
+   LOG_0(Trace_Verbose, "Entered BinSumsBoostingQuantized");
+
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(1 <= cTensorBins);
+   EBM_ASSERT(nullptr != pSubset);
+   EBM_ASSERT(nullptr != pInnerBag);
+   EBM_ASSERT(nullptr != pSubset->GetGradHessQuantized());
+   EBM_ASSERT(nullptr != pSubset->GetQuantizeScales());
+   EBM_ASSERT(nullptr != aFastBins);
+   EBM_ASSERT(nullptr != aMainBins);
+   EBM_ASSERT(sizeof(int8_t) == cBytesQuantized || sizeof(int16_t) == cBytesQuantized);
+
+   const size_t cWordsPerBin = k_cQuantizedBinHeaderWords + (bHessian ? cScores << 1 : cScores);
+   static_assert(sizeof(int64_t) == sizeof(double), "the quantized bin words are either int64_t or double");
+   static_assert(std::numeric_limits<double>::is_iec559, "memset of floats requires IEEE 754 to guarantee zeros");
+   memset(aFastBins, 0, sizeof(int64_t) * cWordsPerBin * cTensorBins);
+
+   BinSumsBoostingBridge params;
+   params.m_bHessian = bHessian ? EBM_TRUE : EBM_FALSE;
+   params.m_cScores = cScores;
+   params.m_cPack = cPack;
+   params.m_cSamples = pSubset->GetCountSamples();
+   params.m_aGradientsAndHessians = pSubset->GetGradHessQuantized();
+   params.m_aWeights = pInnerBag->GetWeights();
+   params.m_pCountOccurrences = pInnerBag->GetCountOccurrences();
+   params.m_aPacked = aPacked;
+   params.m_cBytesQuantized = cBytesQuantized;
+   params.m_aFastBins = aFastBins;
+#ifndef NDEBUG
+   params.m_pDebugFastBinsEnd = IndexByte(aFastBins, sizeof(int64_t) * cWordsPerBin * cTensorBins);
+#endif // NDEBUG
+
+   ErrorEbm error;
+   OffloadQueue * const pOffloadQueue = pSubset->GetOffloadQueue();
+   if(nullptr != pOffloadQueue) {
+      // the slices add their integer words together exactly, so the scales are applied only once to the total
+      error = pOffloadQueue->EnqueueBinSumsBoostingQuantized(pSubset->GetObjectiveWrapper(), &params, cTensorBins, 
+         aFastBins);
+      if(Error_None == error) {
+         error = pOffloadQueue->Synchronize();
+      }
+   } else {
+      error = pSubset->BinSumsBoostingQuantized(&params);
+   }
+   if(Error_None != error) {
+      return error;
+   }
+
+   if(bHessian) {
+      if(nullptr != params.m_aWeights) {
+         ConvertQuantizedBins<true, true>(cScores, cTensorBins, pSubset->GetQuantizeScales(), aFastBins, aMainBins);
+      } else {
+         ConvertQuantizedBins<true, false>(cScores, cTensorBins, pSubset->GetQuantizeScales(), aFastBins, aMainBins);
+      }
+   } else {
+      if(nullptr != params.m_aWeights) {
+         ConvertQuantizedBins<false, true>(cScores, cTensorBins, pSubset->GetQuantizeScales(), aFastBins, aMainBins);
+      } else {
+         ConvertQuantizedBins<false, false>(cScores, cTensorBins, pSubset->GetQuantizeScales(), aFastBins, aMainBins);
+      }
+   }
+
+   LOG_0(Trace_Verbose, "Exited BinSumsBoostingQuantized");
+   return Error_None;
+}
+
+} // DEFINED_ZONE_NAME
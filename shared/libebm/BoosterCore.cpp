@@ -7,6 +7,7 @@
 #include <stdlib.h> // free
 #include <stddef.h> // size_t, ptrdiff_t
 #include <limits> // numeric_limits
+#include <cmath> // std::isfinite, std::abs
 #include <thread>
 
 #include "logging.h" // EBM_ASSERT
@@ -23,8 +24,10 @@
 #include "Feature.hpp" // Feature
 #include "Term.hpp" // Term
 #include "InnerBag.hpp" // InnerBag
+#include "OuterBag.hpp" // OuterBag
 #include "TreeNode.hpp" // IsOverflowTreeNodeSize
 #include "SplitPosition.hpp" // IsOverflowSplitPositionSize
+#include "Offload.hpp" // OffloadQueue
 #include "BoosterCore.hpp"
 
 namespace DEFINED_ZONE_NAME {
@@ -36,7 +39,7 @@ class RandomDeterministic;
 
 extern ErrorEbm Unbag(
    const size_t cSamples,
-   const BagEbm * const aBag,
+   const OuterBag & bag,
    size_t * const pcTrainingSamplesOut,
    size_t * const pcValidationSamplesOut
 );
@@ -49,6 +52,18 @@ extern ErrorEbm GetObjective(
    ObjectiveWrapper * const pSIMDObjectiveWrapperOut
 ) noexcept;
 
+// the metric histogram range when the validation scores are not finite
+static constexpr double k_metricScoreLowDiverged = -16.0;
+static constexpr double k_metricScoreHighDiverged = 16.0;
+// the narrowest metric histogram range relative to the magnitude of the scores
+static constexpr double k_metricScoreWidthMin = 1e-9;
+
+extern ErrorEbm GetMetric(
+   const Config * const pConfig,
+   const char * sMetric,
+   MetricWrapper * const pMetricWrapperOut
+) noexcept;
+
 void BoosterCore::DeleteTensors(const size_t cTerms, Tensor ** const apTensors) {
    LOG_0(Trace_Info, "Entered DeleteTensors");
 
@@ -65,6 +80,50 @@ void BoosterCore::DeleteTensors(const size_t cTerms, Tensor ** const apTensors)
    LOG_0(Trace_Info, "Exited DeleteTensors");
 }
 
+static ErrorEbm FillTensors(
+   const size_t cTerms,
+   const Term * const * const apTerms,
+   const size_t cScores,
+   Tensor ** const apTensors
+) {
+   // apTensors must already be nullptr filled so that the caller can free it if we fail part way through
+   EBM_ASSERT(1 <= cTerms);
+   EBM_ASSERT(nullptr != apTerms);
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(nullptr != apTensors);
+
+   ErrorEbm error;
+
+   Tensor ** ppTensor = apTensors;
+   const Tensor * const * const ppTensorsEnd = &apTensors[cTerms];
+   const Term * const * ppTerm = apTerms;
+   do {
+      EBM_ASSERT(nullptr == *ppTensor);
+      const Term * const pTerm = *ppTerm;
+      if(size_t { 0 } != pTerm->GetCountTensorBins()) {
+         // if there are any dimensions with features having 0 bins then do not allocate the tensor
+         // since it will have 0 scores
+
+         Tensor * const pTensors = Tensor::Allocate(pTerm->GetCountDimensions(), cScores);
+         if(UNLIKELY(nullptr == pTensors)) {
+            LOG_0(Trace_Warning, "WARNING FillTensors nullptr == pTensors");
+            return Error_OutOfMemory;
+         }
+         *ppTensor = pTensors; // transfer ownership for future deletion
+
+         error = pTensors->Expand(pTerm);
+         if(Error_None != error) {
+            // already logged
+            return error;
+         }
+      }
+      ++ppTerm;
+      ++ppTensor;
+   } while(ppTensorsEnd != ppTensor);
+
+   return Error_None;
+}
+
 ErrorEbm BoosterCore::InitializeTensors(
    const size_t cTerms, 
    const Term * const * const apTerms, 
@@ -99,30 +158,10 @@ ErrorEbm BoosterCore::InitializeTensors(
    } while(ppTensorsEnd != ppTensorInit);
    *papTensorsOut = apTensors; // transfer ownership for future deletion
 
-   Tensor ** ppTensor = apTensors;
-   const Term * const * ppTerm = apTerms;
-   do {
-      const Term * const pTerm = *ppTerm;
-      if(size_t { 0 } != pTerm->GetCountTensorBins()) {
-         // if there are any dimensions with features having 0 bins then do not allocate the tensor
-         // since it will have 0 scores
-
-         Tensor * const pTensors = Tensor::Allocate(pTerm->GetCountDimensions(), cScores);
-         if(UNLIKELY(nullptr == pTensors)) {
-            LOG_0(Trace_Warning, "WARNING InitializeTensors nullptr == pTensors");
-            return Error_OutOfMemory;
-         }
-         *ppTensor = pTensors; // transfer ownership for future deletion
-
-         error = pTensors->Expand(pTerm);
-         if(Error_None != error) {
-            // already logged
-            return error;
-         }
-      }
-      ++ppTerm;
-      ++ppTensor;
-   } while(ppTensorsEnd != ppTensor);
+   error = FillTensors(cTerms, apTerms, cScores, apTensors);
+   if(Error_None != error) {
+      return error;
+   }
 
    LOG_0(Trace_Info, "Exited InitializeTensors");
    return Error_None;
@@ -131,8 +170,8 @@ ErrorEbm BoosterCore::InitializeTensors(
 BoosterCore::~BoosterCore() {
    // this only gets called after our reference count has been decremented to zero
 
-   m_trainingSet.DestructDataSetBoosting(m_cTerms, m_cInnerBags);
-   m_validationSet.DestructDataSetBoosting(m_cTerms, 0);
+   m_trainingSet.DestructDataSetBoosting(m_cTerms, m_cFeatures, m_cInnerBags);
+   m_validationSet.DestructDataSetBoosting(m_cTerms, m_cFeatures, 0);
 
    Term::FreeTerms(m_cTerms, m_apTerms);
 
@@ -143,6 +182,11 @@ BoosterCore::~BoosterCore() {
 
    FreeObjectiveWrapperInternals(&m_objectiveCpu);
    FreeObjectiveWrapperInternals(&m_objectiveSIMD);
+   FreeMetricWrapperInternals(&m_metricCpu);
+   free(m_aMetricBins);
+
+   // the datasets above free their device memory through the queue, so it needs to outlive them
+   OffloadQueue::Free(m_pOffloadQueue);
 };
 
 void BoosterCore::Free(BoosterCore * const pBoosterCore) {
@@ -267,6 +311,238 @@ static bool CheckBoosterRestrictions(
    }
 }
 
+static ErrorEbm InitializeFeatures(
+   const unsigned char * const pDataSetShared,
+   const size_t cSamples,
+   const size_t cFeatures,
+   FeatureBoosting * const aFeatures
+) {
+   EBM_ASSERT(nullptr != pDataSetShared);
+   EBM_ASSERT(1 <= cFeatures);
+   EBM_ASSERT(nullptr != aFeatures);
+
+   size_t iFeatureInitialize = size_t { 0 };
+   do {
+      bool bMissing;
+      bool bUnknown;
+      bool bNominal;
+      bool bSparse;
+      UIntShared countBins;
+      UIntShared defaultValSparse;
+      size_t cNonDefaultsSparse;
+      GetDataSetSharedFeature(
+         pDataSetShared,
+         iFeatureInitialize,
+         &bMissing,
+         &bUnknown,
+         &bNominal,
+         &bSparse,
+         &countBins,
+         &defaultValSparse,
+         &cNonDefaultsSparse
+      );
+      EBM_ASSERT(!bSparse); // we do not handle yet
+      if(IsConvertError<size_t>(countBins)) {
+         LOG_0(Trace_Error, "ERROR InitializeFeatures IsConvertError<size_t>(countBins)");
+         return Error_IllegalParamVal;
+      }
+      if(IsConvertError<UIntSplit>(countBins)) {
+         LOG_0(Trace_Error, "ERROR InitializeFeatures IsConvertError<UIntSplit>(countBins)");
+         return Error_IllegalParamVal;
+      }
+      const size_t cBins = static_cast<size_t>(countBins);
+      if(0 == cBins) {
+         if(0 != cSamples) {
+            LOG_0(Trace_Error, "ERROR InitializeFeatures countBins cannot be zero unless there are zero samples");
+            return Error_IllegalParamVal;
+         }
+
+         // we can handle 0 == cBins even though that's a degenerate case that shouldn't be boosted on.  0 bins
+         // can only occur if there were zero training and zero validation cases since the 
+         // features would require a value, even if it was 0.
+         LOG_0(Trace_Info, "INFO InitializeFeatures feature with 0 values");
+      } else if(1 == cBins) {
+         // Dimensions with 1 bin don't contribute anything to the model since they always have the same value, but 
+         // the user can specify interactions, so we handle them anyways in a consistent way by boosting on them
+         LOG_0(Trace_Info, "INFO InitializeFeatures feature with 1 value");
+      }
+      aFeatures[iFeatureInitialize].Initialize(cBins, bMissing, bUnknown, bNominal);
+
+      ++iFeatureInitialize;
+   } while(cFeatures != iFeatureInitialize);
+   return Error_None;
+}
+
+static ErrorEbm InitializeTerms(
+   const size_t cFeatures,
+   const FeatureBoosting * const aFeatures,
+   const size_t iFeatureFirst,
+   const size_t cTerms,
+   const IntEbm * const acTermDimensions,
+   const IntEbm * const aiTermFeatures,
+   Term ** const apTerms,
+   size_t * const pcTensorBinsMax,
+   size_t * const pcMainBinsMax,
+   size_t * const pcSingleDimensionBinsMax
+) {
+   // aiTermFeatures indexes into aFeatures, which starts at feature iFeatureFirst of the BoosterCore. The maximums 
+   // are only ever increased, so the caller can carry them over from terms it already has
+
+   EBM_ASSERT(1 <= cTerms);
+   EBM_ASSERT(nullptr != acTermDimensions);
+   EBM_ASSERT(nullptr != apTerms);
+   EBM_ASSERT(nullptr != pcTensorBinsMax);
+   EBM_ASSERT(nullptr != pcMainBinsMax);
+   EBM_ASSERT(nullptr != pcSingleDimensionBinsMax);
+
+   const IntEbm * piTermFeature = aiTermFeatures;
+   size_t iTerm = 0;
+   do {
+      const IntEbm countDimensions = acTermDimensions[iTerm];
+      if(countDimensions < IntEbm { 0 }) {
+         LOG_0(Trace_Error, "ERROR InitializeTerms countDimensions cannot be negative");
+         return Error_IllegalParamVal;
+      }
+      if(IntEbm { k_cDimensionsMax } < countDimensions) {
+         LOG_0(Trace_Warning, "WARNING InitializeTerms countDimensions too large and would cause out of memory condition");
+         return Error_OutOfMemory;
+      }
+      const size_t cDimensions = static_cast<size_t>(countDimensions);
+      Term * const pTerm = Term::Allocate(cDimensions);
+      if(nullptr == pTerm) {
+         LOG_0(Trace_Warning, "WARNING InitializeTerms nullptr == pTerm");
+         return Error_OutOfMemory;
+      }
+      // assign our pointer directly to our array right now so that we can't loose the memory if we decide to exit due to an error below
+      apTerms[iTerm] = pTerm;
+
+      pTerm->SetCountAuxillaryBins(0); // we only use these for pairs, so otherwise it gets left as zero
+
+      size_t cAuxillaryBinsForBuildFastTotals = 0;
+      size_t cRealDimensions = 0;
+      int cBitsRequiredMin = 0;
+      size_t cTensorBins = 1;
+      if(UNLIKELY(0 == cDimensions)) {
+         LOG_0(Trace_Info, "INFO InitializeTerms empty term");
+
+         *pcTensorBinsMax = EbmMax(*pcTensorBinsMax, size_t { 1 });
+         *pcMainBinsMax = EbmMax(*pcMainBinsMax, size_t { 1 });
+      } else {
+         if(nullptr == piTermFeature) {
+            LOG_0(Trace_Error, "ERROR InitializeTerms aiTermFeatures cannot be NULL when there are Terms with non-zero numbers of features");
+            return Error_IllegalParamVal;
+         }
+         size_t cSingleDimensionBins = 0;
+         TermFeature * pTermFeature = pTerm->GetTermFeatures();
+         const TermFeature * const pTermFeaturesEnd = &pTermFeature[cDimensions];
+         // TODO: Ideally we would flip our input dimensions so that we're aligned with the output ordering
+         //       and thus not need a transpose when transfering data to the caller. We're doing it this way
+         //       for now to test the transpose ability and also to maintain the same results as before for comparison
+         size_t iTranspose = cDimensions - 1;
+         do {
+            const IntEbm indexFeature = *piTermFeature;
+            if(indexFeature < IntEbm { 0 }) {
+               LOG_0(Trace_Error, "ERROR InitializeTerms aiTermFeatures value cannot be negative");
+               return Error_IllegalParamVal;
+            }
+            if(IsConvertError<size_t>(indexFeature)) {
+               LOG_0(Trace_Error, "ERROR InitializeTerms aiTermFeatures value too big to reference memory");
+               return Error_IllegalParamVal;
+            }
+            const size_t iFeature = static_cast<size_t>(indexFeature);
+
+            if(cFeatures <= iFeature) {
+               LOG_0(Trace_Error, "ERROR InitializeTerms aiTermFeatures value must be less than the number of features");
+               return Error_IllegalParamVal;
+            }
+
+            EBM_ASSERT(1 <= cFeatures); // since our iFeature is valid and index 0 would mean cFeatures == 1
+            EBM_ASSERT(nullptr != aFeatures);
+
+            // Clang does not seems to understand that iFeature is bound to the legal 
+            // range of m_aFeatures through the check "cFeatures <= iFeature" above
+            StopClangAnalysis();
+
+            const FeatureBoosting * const pInputFeature = &aFeatures[iFeature];
+            pTermFeature->m_pFeature = pInputFeature;
+            pTermFeature->m_iFeature = iFeatureFirst + iFeature;
+            pTermFeature->m_cStride = cTensorBins;
+            pTermFeature->m_iTranspose = iTranspose; // TODO: no tranposition yet, but move it from python to C
+
+            const size_t cBins = pInputFeature->GetCountBins();
+            if(LIKELY(size_t { 1 } < cBins)) {
+               // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting tensor loses one dimension but is 
+               // otherwise indistinquishable from the original data
+               ++cRealDimensions;
+
+               cSingleDimensionBins = cBins;
+
+               if(IsMultiplyError(cTensorBins, cBins)) {
+                  // if this overflows, we definetly won't be able to allocate it
+                  LOG_0(Trace_Warning, "WARNING InitializeTerms IsMultiplyError(cTensorStates, cBins)");
+                  return Error_OutOfMemory;
+               }
+
+               // mathematically, cTensorBins grows faster than cAuxillaryBinsForBuildFastTotals
+               EBM_ASSERT(0 == cTensorBins || cAuxillaryBinsForBuildFastTotals < cTensorBins);
+
+               // since cBins must be 2 or more, cAuxillaryBinsForBuildFastTotals must grow slower than 
+               // cTensorBins, and we checked above that cTensorBins would not overflow
+               EBM_ASSERT(!IsAddError(cAuxillaryBinsForBuildFastTotals, cTensorBins));
+
+               cAuxillaryBinsForBuildFastTotals += cTensorBins;
+            } else {
+               LOG_0(Trace_Info, "INFO InitializeTerms term with no useful features");
+            }
+            cTensorBins *= cBins;
+            // same reasoning as above: cAuxillaryBinsForBuildFastTotals grows slower than cTensorBins
+            EBM_ASSERT(0 == cTensorBins || cAuxillaryBinsForBuildFastTotals < cTensorBins);
+
+            --iTranspose;
+            ++piTermFeature;
+            ++pTermFeature;
+         } while(pTermFeaturesEnd != pTermFeature);
+
+         *pcTensorBinsMax = EbmMax(*pcTensorBinsMax, cTensorBins);
+         size_t cTotalMainBins = cTensorBins;
+         if(LIKELY(size_t { 1 } < cTensorBins)) {
+            EBM_ASSERT(1 <= cRealDimensions);
+
+            cBitsRequiredMin = CountBitsRequired(cTensorBins - size_t { 1 });
+            EBM_ASSERT(1 <= cBitsRequiredMin); // 1 < cTensorBins otherwise we'd have filtered it out above
+            EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(size_t));
+
+            if(size_t { 1 } == cRealDimensions) {
+               *pcSingleDimensionBinsMax = EbmMax(*pcSingleDimensionBinsMax, cSingleDimensionBins);
+            } else {
+               // we only use AuxillaryBins for pairs.  We wouldn't use them for random pairs, but we
+               // don't know yet if the caller will set the random boosting flag on all pairs, so allocate it
+
+               // we need to reserve 4 PAST the pointer we pass into SweepMultiDimensional!!!!.  We pass in index 20 at max, so we need 24
+               static constexpr size_t cAuxillaryBinsForSplitting = 24;
+               const size_t cAuxillaryBins = EbmMax(cAuxillaryBinsForBuildFastTotals, cAuxillaryBinsForSplitting);
+               pTerm->SetCountAuxillaryBins(cAuxillaryBins);
+
+               if(IsAddError(cTensorBins, cAuxillaryBins)) {
+                  LOG_0(Trace_Warning, "WARNING InitializeTerms IsAddError(cTensorBins, cAuxillaryBins)");
+                  return Error_OutOfMemory;
+               }
+               cTotalMainBins += cAuxillaryBins;
+            }
+         } else {
+            EBM_ASSERT(0 == cRealDimensions);
+         }
+         *pcMainBinsMax = EbmMax(*pcMainBinsMax, cTotalMainBins);
+      }
+      pTerm->SetCountRealDimensions(cRealDimensions);
+      pTerm->SetBitsRequiredMin(cBitsRequiredMin);
+      pTerm->SetCountTensorBins(cTensorBins);
+
+      ++iTerm;
+   } while(iTerm < cTerms);
+   return Error_None;
+}
+
 //static int g_TODO_removeThisThreadTest = 0;
 //void TODO_removeThisThreadTest() {
 //   g_TODO_removeThisThreadTest = 1;
@@ -337,6 +613,17 @@ ErrorEbm BoosterCore::Create(
    *ppBoosterCoreOut = pBoosterCore;
 
    pBoosterCore->m_bDisableApprox = 0 != (CreateBoosterFlags_DisableApprox & flags) ? EBM_TRUE : EBM_FALSE;
+   pBoosterCore->m_bCollectStats = 0 != (CreateBoosterFlags_CollectStats & flags);
+   pBoosterCore->m_bFeatureStorage = 0 != (CreateBoosterFlags_FeatureStorage & flags);
+   pBoosterCore->m_bBagBits = 0 != (CreateBoosterFlags_BagBits & flags);
+   const OuterBag bag = OuterBag::Make(aBag, pBoosterCore->m_bBagBits);
+
+   size_t cBytesQuantized = 0;
+   if(0 != (CreateBoosterFlags_QuantizeGradients16 & flags)) {
+      cBytesQuantized = sizeof(int16_t);
+   } else if(0 != (CreateBoosterFlags_QuantizeGradients8 & flags)) {
+      cBytesQuantized = sizeof(int8_t);
+   }
 
    UIntShared countSamples;
    size_t cFeatures;
@@ -382,55 +669,11 @@ ErrorEbm BoosterCore::Create(
       }
       pBoosterCore->m_aFeatures = aFeatures;
 
-      size_t iFeatureInitialize = size_t { 0 };
-      do {
-         bool bMissing;
-         bool bUnknown;
-         bool bNominal;
-         bool bSparse;
-         UIntShared countBins;
-         UIntShared defaultValSparse;
-         size_t cNonDefaultsSparse;
-         GetDataSetSharedFeature(
-            pDataSetShared,
-            iFeatureInitialize,
-            &bMissing,
-            &bUnknown,
-            &bNominal,
-            &bSparse,
-            &countBins,
-            &defaultValSparse,
-            &cNonDefaultsSparse
-         );
-         EBM_ASSERT(!bSparse); // we do not handle yet
-         if(IsConvertError<size_t>(countBins)) {
-            LOG_0(Trace_Error, "ERROR BoosterCore::Create IsConvertError<size_t>(countBins)");
-            return Error_IllegalParamVal;
-         }
-         if(IsConvertError<UIntSplit>(countBins)) {
-            LOG_0(Trace_Error, "ERROR BoosterCore::Create IsConvertError<UIntSplit>(countBins)");
-            return Error_IllegalParamVal;
-         }
-         const size_t cBins = static_cast<size_t>(countBins);
-         if(0 == cBins) {
-            if(0 != cSamples) {
-               LOG_0(Trace_Error, "ERROR BoosterCore::Create countBins cannot be zero unless there are zero samples");
-               return Error_IllegalParamVal;
-            }
-
-            // we can handle 0 == cBins even though that's a degenerate case that shouldn't be boosted on.  0 bins
-            // can only occur if there were zero training and zero validation cases since the 
-            // features would require a value, even if it was 0.
-            LOG_0(Trace_Info, "INFO BoosterCore::Create feature with 0 values");
-         } else if(1 == cBins) {
-            // Dimensions with 1 bin don't contribute anything to the model since they always have the same value, but 
-            // the user can specify interactions, so we handle them anyways in a consistent way by boosting on them
-            LOG_0(Trace_Info, "INFO BoosterCore::Create feature with 1 value");
-         }
-         aFeatures[iFeatureInitialize].Initialize(cBins, bMissing, bUnknown, bNominal);
-
-         ++iFeatureInitialize;
-      } while(cFeatures != iFeatureInitialize);
+      error = InitializeFeatures(pDataSetShared, cSamples, cFeatures, aFeatures);
+      if(Error_None != error) {
+         // already logged
+         return error;
+      }
    }
    LOG_0(Trace_Info, "BoosterCore::Create done feature processing");
 
@@ -447,150 +690,22 @@ ErrorEbm BoosterCore::Create(
          return Error_OutOfMemory;
       }
 
-      const IntEbm * piTermFeature = aiTermFeatures;
-      size_t iTerm = 0;
-      do {
-         const IntEbm countDimensions = acTermDimensions[iTerm];
-         if(countDimensions < IntEbm { 0 }) {
-            LOG_0(Trace_Error, "ERROR BoosterCore::Create countDimensions cannot be negative");
-            return Error_IllegalParamVal;
-         }
-         if(IntEbm { k_cDimensionsMax } < countDimensions) {
-            LOG_0(Trace_Warning, "WARNING BoosterCore::Create countDimensions too large and would cause out of memory condition");
-            return Error_OutOfMemory;
-         }
-         const size_t cDimensions = static_cast<size_t>(countDimensions);
-         Term * const pTerm = Term::Allocate(cDimensions);
-         if(nullptr == pTerm) {
-            LOG_0(Trace_Warning, "WARNING BoosterCore::Create nullptr == pTerm");
-            return Error_OutOfMemory;
-         }
-         // assign our pointer directly to our array right now so that we can't loose the memory if we decide to exit due to an error below
-         pBoosterCore->m_apTerms[iTerm] = pTerm;
-
-         pTerm->SetCountAuxillaryBins(0); // we only use these for pairs, so otherwise it gets left as zero
-
-         size_t cAuxillaryBinsForBuildFastTotals = 0;
-         size_t cRealDimensions = 0;
-         int cBitsRequiredMin = 0;
-         size_t cTensorBins = 1;
-         if(UNLIKELY(0 == cDimensions)) {
-            LOG_0(Trace_Info, "INFO BoosterCore::Create empty term");
-
-            cTensorBinsMax = EbmMax(cTensorBinsMax, size_t { 1 });
-            cMainBinsMax = EbmMax(cMainBinsMax, size_t { 1 });
-         } else {
-            if(nullptr == piTermFeature) {
-               LOG_0(Trace_Error, "ERROR BoosterCore::Create aiTermFeatures cannot be NULL when there are Terms with non-zero numbers of features");
-               return Error_IllegalParamVal;
-            }
-            size_t cSingleDimensionBins = 0;
-            TermFeature * pTermFeature = pTerm->GetTermFeatures();
-            const TermFeature * const pTermFeaturesEnd = &pTermFeature[cDimensions];
-            // TODO: Ideally we would flip our input dimensions so that we're aligned with the output ordering
-            //       and thus not need a transpose when transfering data to the caller. We're doing it this way
-            //       for now to test the transpose ability and also to maintain the same results as before for comparison
-            size_t iTranspose = cDimensions - 1;
-            do {
-               const IntEbm indexFeature = *piTermFeature;
-               if(indexFeature < IntEbm { 0 }) {
-                  LOG_0(Trace_Error, "ERROR BoosterCore::Create aiTermFeatures value cannot be negative");
-                  return Error_IllegalParamVal;
-               }
-               if(IsConvertError<size_t>(indexFeature)) {
-                  LOG_0(Trace_Error, "ERROR BoosterCore::Create aiTermFeatures value too big to reference memory");
-                  return Error_IllegalParamVal;
-               }
-               const size_t iFeature = static_cast<size_t>(indexFeature);
-
-               if(cFeatures <= iFeature) {
-                  LOG_0(Trace_Error, "ERROR BoosterCore::Create aiTermFeatures value must be less than the number of features");
-                  return Error_IllegalParamVal;
-               }
-
-               EBM_ASSERT(1 <= cFeatures); // since our iFeature is valid and index 0 would mean cFeatures == 1
-               EBM_ASSERT(nullptr != pBoosterCore->m_aFeatures);
-
-               // Clang does not seems to understand that iFeature is bound to the legal 
-               // range of m_aFeatures through the check "cFeatures <= iFeature" above
-               StopClangAnalysis();
-
-               const FeatureBoosting * const pInputFeature = &pBoosterCore->m_aFeatures[iFeature];
-               pTermFeature->m_pFeature = pInputFeature;
-               pTermFeature->m_cStride = cTensorBins;
-               pTermFeature->m_iTranspose = iTranspose; // TODO: no tranposition yet, but move it from python to C
-
-               const size_t cBins = pInputFeature->GetCountBins();
-               if(LIKELY(size_t { 1 } < cBins)) {
-                  // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting tensor loses one dimension but is 
-                  // otherwise indistinquishable from the original data
-                  ++cRealDimensions;
-
-                  cSingleDimensionBins = cBins;
-                  
-                  if(IsMultiplyError(cTensorBins, cBins)) {
-                     // if this overflows, we definetly won't be able to allocate it
-                     LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(cTensorStates, cBins)");
-                     return Error_OutOfMemory;
-                  }
-
-                  // mathematically, cTensorBins grows faster than cAuxillaryBinsForBuildFastTotals
-                  EBM_ASSERT(0 == cTensorBins || cAuxillaryBinsForBuildFastTotals < cTensorBins);
-
-                  // since cBins must be 2 or more, cAuxillaryBinsForBuildFastTotals must grow slower than 
-                  // cTensorBins, and we checked above that cTensorBins would not overflow
-                  EBM_ASSERT(!IsAddError(cAuxillaryBinsForBuildFastTotals, cTensorBins));
-
-                  cAuxillaryBinsForBuildFastTotals += cTensorBins;
-               } else {
-                  LOG_0(Trace_Info, "INFO BoosterCore::Create term with no useful features");
-               }
-               cTensorBins *= cBins;
-               // same reasoning as above: cAuxillaryBinsForBuildFastTotals grows slower than cTensorBins
-               EBM_ASSERT(0 == cTensorBins || cAuxillaryBinsForBuildFastTotals < cTensorBins);
-
-               --iTranspose;
-               ++piTermFeature;
-               ++pTermFeature;
-            } while(pTermFeaturesEnd != pTermFeature);
-
-            cTensorBinsMax = EbmMax(cTensorBinsMax, cTensorBins);
-            size_t cTotalMainBins = cTensorBins;
-            if(LIKELY(size_t { 1 } < cTensorBins)) {
-               EBM_ASSERT(1 <= cRealDimensions);
-
-               cBitsRequiredMin = CountBitsRequired(cTensorBins - size_t { 1 });
-               EBM_ASSERT(1 <= cBitsRequiredMin); // 1 < cTensorBins otherwise we'd have filtered it out above
-               EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(size_t));
-
-               if(size_t { 1 } == cRealDimensions) {
-                  cSingleDimensionBinsMax = EbmMax(cSingleDimensionBinsMax, cSingleDimensionBins);
-               } else {
-                  // we only use AuxillaryBins for pairs.  We wouldn't use them for random pairs, but we
-                  // don't know yet if the caller will set the random boosting flag on all pairs, so allocate it
-
-                  // we need to reserve 4 PAST the pointer we pass into SweepMultiDimensional!!!!.  We pass in index 20 at max, so we need 24
-                  static constexpr size_t cAuxillaryBinsForSplitting = 24;
-                  const size_t cAuxillaryBins = EbmMax(cAuxillaryBinsForBuildFastTotals, cAuxillaryBinsForSplitting);
-                  pTerm->SetCountAuxillaryBins(cAuxillaryBins);
-
-                  if(IsAddError(cTensorBins, cAuxillaryBins)) {
-                     LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsAddError(cTensorBins, cAuxillaryBins)");
-                     return Error_OutOfMemory;
-                  }
-                  cTotalMainBins += cAuxillaryBins;
-               }
-            } else {
-               EBM_ASSERT(0 == cRealDimensions);
-            }
-            cMainBinsMax = EbmMax(cMainBinsMax, cTotalMainBins);
-         }
-         pTerm->SetCountRealDimensions(cRealDimensions);
-         pTerm->SetBitsRequiredMin(cBitsRequiredMin);
-         pTerm->SetCountTensorBins(cTensorBins);
-
-         ++iTerm;
-      } while(iTerm < cTerms);
+      error = InitializeTerms(
+         cFeatures,
+         pBoosterCore->m_aFeatures,
+         0,
+         cTerms,
+         acTermDimensions,
+         aiTermFeatures,
+         pBoosterCore->m_apTerms,
+         &cTensorBinsMax,
+         &cMainBinsMax,
+         &cSingleDimensionBinsMax
+      );
+      if(Error_None != error) {
+         // already logged
+         return error;
+      }
    }
    LOG_0(Trace_Info, "BoosterCore::Create finished term processing");
 
@@ -630,6 +745,16 @@ ErrorEbm BoosterCore::Create(
       }
       LOG_0(Trace_Info, "INFO BoosterCore::Create Objective determined");
 
+      if(0 != (CreateBoosterFlags_HostOffload & flags)) {
+         error = OffloadQueue::Create(0 != (CreateBoosterFlags_PinThreads & flags), &pBoosterCore->m_pOffloadQueue);
+         if(Error_None != error) {
+            // already logged
+            return error;
+         }
+         pBoosterCore->m_objectiveCpu.m_pOffloadQueue = pBoosterCore->m_pOffloadQueue;
+         pBoosterCore->m_objectiveSIMD.m_pOffloadQueue = pBoosterCore->m_pOffloadQueue;
+      }
+
       const TaskEbm task = IdentifyTask(pBoosterCore->m_objectiveCpu.m_linkFunction);
       if(ptrdiff_t { Task_GeneralClassification } <= cClasses) {
          if(task < Task_GeneralClassification) {
@@ -663,7 +788,7 @@ ErrorEbm BoosterCore::Create(
 
             size_t cTrainingSamples;
             size_t cValidationSamples;
-            error = Unbag(cSamples, aBag, &cTrainingSamples, &cValidationSamples);
+            error = Unbag(cSamples, bag, &cTrainingSamples, &cValidationSamples);
             if(Error_None != error) {
                // already logged
                return error;
@@ -679,10 +804,20 @@ ErrorEbm BoosterCore::Create(
 
             const bool bHessian = pBoosterCore->IsHessian();
 
+            if(size_t { 0 } != cBytesQuantized && (nullptr == pBoosterCore->m_objectiveCpu.m_pBinSumsBoostingQuantizedC ||
+               (0 != pBoosterCore->m_objectiveSIMD.m_cUIntBytes && 
+               nullptr == pBoosterCore->m_objectiveSIMD.m_pBinSumsBoostingQuantizedC))) {
+               LOG_0(Trace_Warning, "WARNING BoosterCore::Create the compute zone cannot sum quantized gradients, so they will not be quantized");
+               cBytesQuantized = 0;
+            }
+
+            // quantized gradients are written directly by ApplyUpdateQuantized, except that RMSE keeps its residuals
+            const bool bFloatGradients = size_t { 0 } == cBytesQuantized || pBoosterCore->IsRmse();
+
             pBoosterCore->m_cInnerBags = cInnerBags; // this is used to destruct m_trainingSet, so store it first
             error = pBoosterCore->m_trainingSet.InitDataSetBoosting(
-               true,
-               bHessian,
+               bFloatGradients,
+               bFloatGradients && bHessian,
                !pBoosterCore->IsRmse(),
                !pBoosterCore->IsRmse(),
                rng,
@@ -693,11 +828,13 @@ ErrorEbm BoosterCore::Create(
                pDataSetShared,
                BagEbm { 1 },
                cSamples,
-               aBag,
+               bag,
                aInitScores,
                cTrainingSamples,
                cInnerBags,
                cWeights,
+               0 != (CreateBoosterFlags_FeatureStorage & flags),
+               cFeatures,
                cTerms,
                pBoosterCore->m_apTerms,
                aiTermFeatures
@@ -706,6 +843,14 @@ ErrorEbm BoosterCore::Create(
                return error;
             }
 
+            if(size_t { 0 } != cBytesQuantized && size_t { 0 } != cTrainingSamples) {
+               error = pBoosterCore->m_trainingSet.InitGradHessQuantized(bHessian, cScores, cBytesQuantized);
+               if(Error_None != error) {
+                  return error;
+               }
+               pBoosterCore->m_cBytesQuantized = cBytesQuantized;
+            }
+
             error = pBoosterCore->m_validationSet.InitDataSetBoosting(
                pBoosterCore->IsRmse(),
                false,
@@ -719,11 +864,13 @@ ErrorEbm BoosterCore::Create(
                pDataSetShared,
                BagEbm { -1 },
                cSamples,
-               aBag,
+               bag,
                aInitScores,
                cValidationSamples,
                0,
                cWeights,
+               0 != (CreateBoosterFlags_FeatureStorage & flags),
+               cFeatures,
                cTerms,
                pBoosterCore->m_apTerms,
                aiTermFeatures
@@ -732,132 +879,428 @@ ErrorEbm BoosterCore::Create(
                return error;
             }
 
-            size_t cBytesPerFastBinMax = 0;
-
-            if(0 != cTrainingSamples) {
-               DataSubsetBoosting * pSubset = pBoosterCore->GetTrainingSet()->GetSubsets();
-               const DataSubsetBoosting * const pSubsetsEnd = pSubset + pBoosterCore->GetTrainingSet()->GetCountSubsets();
-               do {
-                  size_t cBytesPerFastBin;
-                  if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(bHessian, cScores);
-                     }
-                  } else {
-                     EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(bHessian, cScores);
-                     }
-                  }
-                  cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, cBytesPerFastBin);
-                  ++pSubset;
-               } while(pSubsetsEnd != pSubset);
+            error = pBoosterCore->InitializeBinBytes(cTensorBinsMax, cMainBinsMax, cSingleDimensionBinsMax);
+            if(Error_None != error) {
+               // already logged
+               return error;
             }
+         }
+         error = InitializeTensors(cTerms, pBoosterCore->m_apTerms, cScores, &pBoosterCore->m_apCurrentTermTensors);
+         if(Error_None != error) {
+            return error;
+         }
+         error = InitializeTensors(cTerms, pBoosterCore->m_apTerms, cScores, &pBoosterCore->m_apBestTermTensors);
+         if(Error_None != error) {
+            return error;
+         }
+      }
+   }
 
-            if(0 != cValidationSamples) {
-               DataSubsetBoosting * pSubset = pBoosterCore->GetValidationSet()->GetSubsets();
-               const DataSubsetBoosting * const pSubsetsEnd = pSubset + pBoosterCore->GetValidationSet()->GetCountSubsets();
-               do {
-                  size_t cBytesPerFastBin;
-                  if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(bHessian, cScores);
-                     }
-                  } else {
-                     EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(bHessian, cScores);
-                     }
-                  }
-                  cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, cBytesPerFastBin);
-                  ++pSubset;
-               } while(pSubsetsEnd != pSubset);
-            }
+   LOG_0(Trace_Info, "Exited BoosterCore::Create");
+   return Error_None;
+}
 
-            if(IsMultiplyError(cBytesPerFastBinMax, cTensorBinsMax)) {
-               LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(cBytesPerFastBinMax, cTensorBinsMax)");
-               return Error_OutOfMemory;
-            }
-            pBoosterCore->m_cBytesFastBins = cBytesPerFastBinMax * cTensorBinsMax;
+static ErrorEbm GrowTensors(const size_t cTermsBefore, const size_t cTermsAfter, Tensor *** const papTensors) {
+   EBM_ASSERT(1 <= cTermsBefore);
+   EBM_ASSERT(cTermsBefore < cTermsAfter);
+   EBM_ASSERT(nullptr != papTensors);
+   EBM_ASSERT(nullptr != *papTensors);
+   EBM_ASSERT(!IsMultiplyError(sizeof(Tensor *), cTermsAfter)); // we already allocated the Term pointers
 
-            if(IsOverflowBinSize<FloatMain, UIntMain>(bHessian, cScores)) {
-               LOG_0(Trace_Warning, "WARNING BoosterCore::Create bin size overflow");
-               return Error_OutOfMemory;
-            }
+   Tensor ** const apTensors = static_cast<Tensor **>(realloc(*papTensors, sizeof(Tensor *) * cTermsAfter));
+   if(UNLIKELY(nullptr == apTensors)) {
+      LOG_0(Trace_Warning, "WARNING GrowTensors nullptr == apTensors");
+      return Error_OutOfMemory;
+   }
+   for(size_t iTerm = cTermsBefore; iTerm < cTermsAfter; ++iTerm) {
+      apTensors[iTerm] = nullptr;
+   }
+   *papTensors = apTensors;
+   return Error_None;
+}
 
-            const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(bHessian, cScores);
-            if(IsMultiplyError(cBytesPerMainBin, cMainBinsMax)) {
-               LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(cBytesPerMainBin, cMainBinsMax)");
-               return Error_OutOfMemory;
-            }
-            pBoosterCore->m_cBytesMainBins = cBytesPerMainBin * cMainBinsMax;
+ErrorEbm BoosterCore::AddTerms(
+   const unsigned char * const pDataSetShared,
+   const BagEbm * const aBag,
+   const size_t cTerms,
+   const IntEbm * const acTermDimensions,
+   const IntEbm * const aiTermFeatures
+) {
+   LOG_0(Trace_Info, "Entered BoosterCore::AddTerms");
 
-            if(0 != cSingleDimensionBinsMax) {
-               if(IsOverflowTreeNodeSize(bHessian, cScores) || IsOverflowSplitPositionSize(bHessian, cScores)) {
-                  LOG_0(Trace_Warning, "WARNING BoosterCore::Create bin tracking size overflow");
-                  return Error_OutOfMemory;
-               }
+   EBM_ASSERT(nullptr != pDataSetShared);
+   EBM_ASSERT(1 <= cTerms);
+   EBM_ASSERT(nullptr != acTermDimensions);
 
-               const size_t cSingleDimensionSplitsMax = cSingleDimensionBinsMax - 1;
-               const size_t cBytesPerSplitPosition = GetSplitPositionSize(bHessian, cScores);
-               if(IsMultiplyError(cBytesPerSplitPosition, cSingleDimensionSplitsMax)) {
-                  LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(cBytesPerSplitPosition, cSingleDimensionSplitsMax)");
-                  return Error_OutOfMemory;
-               }
-               // TODO : someday add equal gain multidimensional randomized picking.  I think for that we should generate
-               //        random numbers as we find equal gains, so we won't need this memory if we do that
-               pBoosterCore->m_cBytesSplitPositions = cBytesPerSplitPosition * cSingleDimensionSplitsMax;
+   ErrorEbm error;
+
+   if(size_t { 0 } == m_cTerms) {
+      // BoosterCore::Create does not build the datasets when there are no terms, so there is nothing to extend
+      LOG_0(Trace_Error, "ERROR BoosterCore::AddTerms the booster needs to have been created with at least one term");
+      return Error_IllegalParamVal;
+   }
+   if(m_bFeatureStorage) {
+      LOG_0(Trace_Error, "ERROR BoosterCore::AddTerms boosters created with CreateBoosterFlags_FeatureStorage cannot be extended");
+      return Error_IllegalParamVal;
+   }
 
+   UIntShared countSamples;
+   size_t cFeatures;
+   size_t cWeights;
+   size_t cTargets;
+   error = GetDataSetSharedHeader(pDataSetShared, &countSamples, &cFeatures, &cWeights, &cTargets);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+   if(IsConvertError<size_t>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR BoosterCore::AddTerms IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
 
-               // If we have N bins, then we can have at most N - 1 splits.
-               // At maximum if all splits are made, then we'll have a tree with N - 1 nodes.
-               // Each node will contain a the total gradient sums of their left and right sides
-               // Each of the N bins will also have a leaf in the tree, which will also consume a TreeNode structure
-               // because each split needs to preserve the gradient sums of its left and right sides, which in this
-               // case are individual bins.
-               // So, in total we consume N + N - 1 TreeNodes
+   const OuterBag bag = OuterBag::Make(aBag, m_bBagBits);
+   size_t cTrainingSamples;
+   size_t cValidationSamples;
+   error = Unbag(cSamples, bag, &cTrainingSamples, &cValidationSamples);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+   if(size_t { 0 } != m_cScores) {
+      // we can't check that the samples are the same ones, but we can catch the most likely mistakes
+      if(m_trainingSet.GetCountSamples() != cTrainingSamples || m_validationSet.GetCountSamples() != cValidationSamples) {
+         LOG_0(Trace_Error, "ERROR BoosterCore::AddTerms the dataSet and bag do not select the samples of the booster");
+         return Error_IllegalParamVal;
+      }
+   }
 
-               if(IsAddError(cSingleDimensionSplitsMax, cSingleDimensionBinsMax)) {
-                  LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsAddError(cSingleDimensionSplitsMax, cSingleDimensionBinsMax)");
-                  return Error_OutOfMemory;
-               }
-               const size_t cTreeNodes = cSingleDimensionSplitsMax + cSingleDimensionBinsMax;
+   LOG_0(Trace_Info, "BoosterCore::AddTerms starting feature processing");
+   const size_t iFeatureFirst = m_cFeatures;
+   if(size_t { 0 } != cFeatures) {
+      if(IsAddError(iFeatureFirst, cFeatures)) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::AddTerms IsAddError(iFeatureFirst, cFeatures)");
+         return Error_OutOfMemory;
+      }
+      const size_t cFeaturesAfter = iFeatureFirst + cFeatures;
+      if(IsMultiplyError(sizeof(FeatureBoosting), cFeaturesAfter)) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::AddTerms IsMultiplyError(sizeof(FeatureBoosting), cFeaturesAfter)");
+         return Error_OutOfMemory;
+      }
+      FeatureBoosting * const aFeatures = 
+         static_cast<FeatureBoosting *>(realloc(m_aFeatures, sizeof(FeatureBoosting) * cFeaturesAfter));
+      if(nullptr == aFeatures) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::AddTerms nullptr == aFeatures");
+         return Error_OutOfMemory;
+      }
+      m_aFeatures = aFeatures;
 
-               const size_t cBytesPerTreeNode = GetTreeNodeSize(bHessian, cScores);
-               if(IsMultiplyError(cBytesPerTreeNode, cTreeNodes)) {
-                  LOG_0(Trace_Warning, "WARNING BoosterCore::Create IsMultiplyError(cBytesPerTreeNode, cTreeNodes)");
-                  return Error_OutOfMemory;
-               }
-               pBoosterCore->m_cBytesTreeNodes = cTreeNodes * cBytesPerTreeNode;
-            } else {
-               EBM_ASSERT(0 == pBoosterCore->m_cBytesSplitPositions);
-               EBM_ASSERT(0 == pBoosterCore->m_cBytesTreeNodes);
+      // the existing terms point into the features, which may have moved
+      size_t iTerm = 0;
+      do {
+         Term * const pTerm = m_apTerms[iTerm];
+         TermFeature * pTermFeature = pTerm->GetTermFeatures();
+         const TermFeature * const pTermFeaturesEnd = &pTermFeature[pTerm->GetCountDimensions()];
+         while(pTermFeaturesEnd != pTermFeature) {
+            EBM_ASSERT(pTermFeature->m_iFeature < iFeatureFirst);
+            pTermFeature->m_pFeature = &aFeatures[pTermFeature->m_iFeature];
+            ++pTermFeature;
+         }
+         ++iTerm;
+      } while(m_cTerms != iTerm);
+
+      error = InitializeFeatures(pDataSetShared, cSamples, cFeatures, &aFeatures[iFeatureFirst]);
+      if(Error_None != error) {
+         // already logged
+         return error;
+      }
+      m_cFeatures = cFeaturesAfter;
+   }
+   LOG_0(Trace_Info, "BoosterCore::AddTerms done feature processing");
+
+   const size_t cTermsBefore = m_cTerms;
+   if(IsAddError(cTermsBefore, cTerms)) {
+      LOG_0(Trace_Warning, "WARNING BoosterCore::AddTerms IsAddError(cTermsBefore, cTerms)");
+      return Error_OutOfMemory;
+   }
+   const size_t cTermsAfter = cTermsBefore + cTerms;
+   if(IsMultiplyError(sizeof(Term *), cTermsAfter)) {
+      LOG_0(Trace_Warning, "WARNING BoosterCore::AddTerms IsMultiplyError(sizeof(Term *), cTermsAfter)");
+      return Error_OutOfMemory;
+   }
+
+   // every array indexed by term is grown before we change m_cTerms, which the destructor relies on
+   Term ** const apTerms = static_cast<Term **>(realloc(m_apTerms, sizeof(Term *) * cTermsAfter));
+   if(UNLIKELY(nullptr == apTerms)) {
+      LOG_0(Trace_Warning, "WARNING BoosterCore::AddTerms nullptr == apTerms");
+      return Error_OutOfMemory;
+   }
+   for(size_t iTerm = cTermsBefore; iTerm < cTermsAfter; ++iTerm) {
+      apTerms[iTerm] = nullptr;
+   }
+   m_apTerms = apTerms;
+
+   if(nullptr != m_apCurrentTermTensors) {
+      error = GrowTensors(cTermsBefore, cTermsAfter, &m_apCurrentTermTensors);
+      if(Error_None != error) {
+         return error;
+      }
+      error = GrowTensors(cTermsBefore, cTermsAfter, &m_apBestTermTensors);
+      if(Error_None != error) {
+         return error;
+      }
+   }
+
+   error = m_trainingSet.GrowTermData(cTermsBefore, cTermsAfter);
+   if(Error_None != error) {
+      return error;
+   }
+   error = m_validationSet.GrowTermData(cTermsBefore, cTermsAfter);
+   if(Error_None != error) {
+      return error;
+   }
+
+   m_cTerms = cTermsAfter;
+
+   size_t cTensorBinsMax = 0;
+   size_t cMainBinsMax = 0;
+   size_t cSingleDimensionBinsMax = 0;
+
+   // recover the maximums that BoosterCore::Create found for the existing terms
+   size_t iTermBefore = 0;
+   do {
+      const Term * const pTerm = apTerms[iTermBefore];
+      const size_t cTensorBins = pTerm->GetCountTensorBins();
+      cTensorBinsMax = EbmMax(cTensorBinsMax, cTensorBins);
+      // this addition was checked when the term was created
+      cMainBinsMax = EbmMax(cMainBinsMax, cTensorBins + pTerm->GetCountAuxillaryBins());
+      if(size_t { 1 } == pTerm->GetCountRealDimensions()) {
+         // the other dimensions have 1 bin, so the tensor has as many bins as the real dimension
+         cSingleDimensionBinsMax = EbmMax(cSingleDimensionBinsMax, cTensorBins);
+      }
+      ++iTermBefore;
+   } while(cTermsBefore != iTermBefore);
+
+   LOG_0(Trace_Info, "BoosterCore::AddTerms starting term processing");
+   error = InitializeTerms(
+      cFeatures,
+      m_aFeatures + iFeatureFirst,
+      iFeatureFirst,
+      cTerms,
+      acTermDimensions,
+      aiTermFeatures,
+      &apTerms[cTermsBefore],
+      &cTensorBinsMax,
+      &cMainBinsMax,
+      &cSingleDimensionBinsMax
+   );
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+   LOG_0(Trace_Info, "BoosterCore::AddTerms finished term processing");
+
+   if(size_t { 0 } != m_cScores) {
+      if(size_t { 0 } != cSamples) {
+         if(CheckBoosterRestrictions(this, &m_objectiveCpu, cTensorBinsMax)) {
+            LOG_0(Trace_Warning, "WARNING BoosterCore::AddTerms cannot fit indexes in the cpu zone");
+            return Error_IllegalParamVal;
+         }
+         if(0 != m_objectiveSIMD.m_cUIntBytes) {
+            if(CheckBoosterRestrictions(this, &m_objectiveSIMD, cTensorBinsMax)) {
+               // BoosterCore::Create would fall back to the cpu zone, but our subsets are already in the SIMD zone
+               LOG_0(Trace_Warning, "WARNING BoosterCore::AddTerms cannot fit indexes in the SIMD zone");
+               return Error_IllegalParamVal;
             }
          }
-         error = InitializeTensors(cTerms, pBoosterCore->m_apTerms, cScores, &pBoosterCore->m_apCurrentTermTensors);
+
+         error = m_trainingSet.AddTermData(
+            pDataSetShared,
+            BagEbm { 1 },
+            cSamples,
+            bag,
+            iFeatureFirst,
+            cTermsBefore,
+            cTerms,
+            &apTerms[cTermsBefore],
+            aiTermFeatures
+         );
          if(Error_None != error) {
             return error;
          }
-         error = InitializeTensors(cTerms, pBoosterCore->m_apTerms, cScores, &pBoosterCore->m_apBestTermTensors);
+         error = m_validationSet.AddTermData(
+            pDataSetShared,
+            BagEbm { -1 },
+            cSamples,
+            bag,
+            iFeatureFirst,
+            cTermsBefore,
+            cTerms,
+            &apTerms[cTermsBefore],
+            aiTermFeatures
+         );
+         if(Error_None != error) {
+            return error;
+         }
+
+         error = InitializeBinBytes(cTensorBinsMax, cMainBinsMax, cSingleDimensionBinsMax);
          if(Error_None != error) {
             return error;
          }
       }
+
+      error = FillTensors(cTerms, &apTerms[cTermsBefore], m_cScores, &m_apCurrentTermTensors[cTermsBefore]);
+      if(Error_None != error) {
+         return error;
+      }
+      error = FillTensors(cTerms, &apTerms[cTermsBefore], m_cScores, &m_apBestTermTensors[cTermsBefore]);
+      if(Error_None != error) {
+         return error;
+      }
+
+      // the current model has not been measured against the best one since the terms changed, so the next 
+      // ApplyTermUpdate starts the search for the best model over, the same as a new booster would
+      m_bestModelMetric = std::numeric_limits<double>::infinity();
+   }
+
+   LOG_0(Trace_Info, "Exited BoosterCore::AddTerms");
+   return Error_None;
+}
+
+ErrorEbm BoosterCore::InitializeBinBytes(
+   const size_t cTensorBinsMax,
+   const size_t cMainBinsMax,
+   const size_t cSingleDimensionBinsMax
+) {
+   const bool bHessian = IsHessian();
+   const size_t cScores = m_cScores;
+
+   size_t cBytesPerFastBinMax = 0;
+
+   if(0 != m_trainingSet.GetCountSamples()) {
+      DataSubsetBoosting * pSubset = GetTrainingSet()->GetSubsets();
+      const DataSubsetBoosting * const pSubsetsEnd = pSubset + GetTrainingSet()->GetCountSubsets();
+      do {
+         size_t cBytesPerFastBin;
+         if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
+            if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+               cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(bHessian, cScores);
+            } else {
+               EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+               cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(bHessian, cScores);
+            }
+         } else {
+            EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+            if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+               cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(bHessian, cScores);
+            } else {
+               EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+               cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(bHessian, cScores);
+            }
+         }
+         cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, cBytesPerFastBin);
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+   }
+
+   if(0 != m_validationSet.GetCountSamples()) {
+      DataSubsetBoosting * pSubset = GetValidationSet()->GetSubsets();
+      const DataSubsetBoosting * const pSubsetsEnd = pSubset + GetValidationSet()->GetCountSubsets();
+      do {
+         size_t cBytesPerFastBin;
+         if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
+            if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+               cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(bHessian, cScores);
+            } else {
+               EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+               cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(bHessian, cScores);
+            }
+         } else {
+            EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+            if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+               cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(bHessian, cScores);
+            } else {
+               EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+               cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(bHessian, cScores);
+            }
+         }
+         cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, cBytesPerFastBin);
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+   }
+
+   if(size_t { 0 } != m_cBytesQuantized) {
+      // the quantized bin sums reuse the fast bins to hold 64 bit words for the count, the weight, and the sum of 
+      // each gradient and hessian
+      static_assert(sizeof(int64_t) == sizeof(double), "the quantized bin words are either int64_t or double");
+      const size_t cWords = (bHessian ? cScores << 1 : cScores) + k_cQuantizedBinHeaderWords;
+      if(IsMultiplyError(sizeof(int64_t), cWords)) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::InitializeBinBytes IsMultiplyError(sizeof(int64_t), cWords)");
+         return Error_OutOfMemory;
+      }
+      cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, sizeof(int64_t) * cWords);
+   }
+
+   if(IsMultiplyError(cBytesPerFastBinMax, cTensorBinsMax)) {
+      LOG_0(Trace_Warning, "WARNING BoosterCore::InitializeBinBytes IsMultiplyError(cBytesPerFastBinMax, cTensorBinsMax)");
+      return Error_OutOfMemory;
+   }
+   m_cBytesFastBins = cBytesPerFastBinMax * cTensorBinsMax;
+
+   if(IsOverflowBinSize<FloatMain, UIntMain>(bHessian, cScores)) {
+      LOG_0(Trace_Warning, "WARNING BoosterCore::InitializeBinBytes bin size overflow");
+      return Error_OutOfMemory;
+   }
+
+   const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(bHessian, cScores);
+   if(IsMultiplyError(cBytesPerMainBin, cMainBinsMax)) {
+      LOG_0(Trace_Warning, "WARNING BoosterCore::InitializeBinBytes IsMultiplyError(cBytesPerMainBin, cMainBinsMax)");
+      return Error_OutOfMemory;
+   }
+   m_cBytesMainBins = cBytesPerMainBin * cMainBinsMax;
+
+   if(0 != cSingleDimensionBinsMax) {
+      if(IsOverflowTreeNodeSize(bHessian, cScores) || IsOverflowSplitPositionSize(bHessian, cScores)) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::InitializeBinBytes bin tracking size overflow");
+         return Error_OutOfMemory;
+      }
+
+      const size_t cSingleDimensionSplitsMax = cSingleDimensionBinsMax - 1;
+      const size_t cBytesPerSplitPosition = GetSplitPositionSize(bHessian, cScores);
+      if(IsMultiplyError(cBytesPerSplitPosition, cSingleDimensionSplitsMax)) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::InitializeBinBytes IsMultiplyError(cBytesPerSplitPosition, cSingleDimensionSplitsMax)");
+         return Error_OutOfMemory;
+      }
+      // TODO : someday add equal gain multidimensional randomized picking.  I think for that we should generate
+      //        random numbers as we find equal gains, so we won't need this memory if we do that
+      m_cBytesSplitPositions = cBytesPerSplitPosition * cSingleDimensionSplitsMax;
+
+
+      // If we have N bins, then we can have at most N - 1 splits.
+      // At maximum if all splits are made, then we'll have a tree with N - 1 nodes.
+      // Each node will contain a the total gradient sums of their left and right sides
+      // Each of the N bins will also have a leaf in the tree, which will also consume a TreeNode structure
+      // because each split needs to preserve the gradient sums of its left and right sides, which in this
+      // case are individual bins.
+      // So, in total we consume N + N - 1 TreeNodes
+
+      if(IsAddError(cSingleDimensionSplitsMax, cSingleDimensionBinsMax)) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::InitializeBinBytes IsAddError(cSingleDimensionSplitsMax, cSingleDimensionBinsMax)");
+         return Error_OutOfMemory;
+      }
+      const size_t cTreeNodes = cSingleDimensionSplitsMax + cSingleDimensionBinsMax;
+
+      const size_t cBytesPerTreeNode = GetTreeNodeSize(bHessian, cScores);
+      if(IsMultiplyError(cBytesPerTreeNode, cTreeNodes)) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::InitializeBinBytes IsMultiplyError(cBytesPerTreeNode, cTreeNodes)");
+         return Error_OutOfMemory;
+      }
+      m_cBytesTreeNodes = cTreeNodes * cBytesPerTreeNode;
+   } else {
+      EBM_ASSERT(0 == m_cBytesSplitPositions);
+      EBM_ASSERT(0 == m_cBytesTreeNodes);
    }
 
-   LOG_0(Trace_Info, "Exited BoosterCore::Create");
    return Error_None;
 }
 
@@ -903,7 +1346,14 @@ ErrorEbm BoosterCore::InitializeBoosterGradientsAndHessians(
          data.m_aWeights = nullptr;
          data.m_aSampleScores = pSubset->GetSampleScores();
          data.m_aGradientsAndHessians = pSubset->GetGradHess();
-         const ErrorEbm error = pSubset->ObjectiveApplyUpdate(&data);
+         data.m_cMetricBins = 0;
+         data.m_aMetricBins = nullptr;
+         ErrorEbm error;
+         if(size_t { 0 } != m_cBytesQuantized) {
+            error = pDataSet->ApplyUpdateQuantized(pSubset, &data, m_cBytesQuantized);
+         } else {
+            error = pSubset->ObjectiveApplyUpdate(&data);
+         }
          if(Error_None != error) {
             return error;
          }
@@ -914,4 +1364,159 @@ ErrorEbm BoosterCore::InitializeBoosterGradientsAndHessians(
    return Error_None;
 }
 
+ErrorEbm BoosterCore::SetMetric(const char * sMetric) {
+   LOG_0(Trace_Info, "Entered BoosterCore::SetMetric");
+
+   FreeMetricWrapperInternals(&m_metricCpu);
+   InitializeMetricWrapperUnfailing(&m_metricCpu);
+   free(m_aMetricBins);
+   m_aMetricBins = nullptr;
+   m_bMetricScoreRange = false;
+
+   // the best model was chosen by the previous metric, which can't be compared to the new one
+   m_bestModelMetric = std::numeric_limits<double>::infinity();
+
+   if(nullptr == sMetric || '\0' == *SkipWhitespace(sMetric)) {
+      LOG_0(Trace_Info, "Exited BoosterCore::SetMetric using the objective's metric");
+      return Error_None;
+   }
+
+   if(size_t { 0 } == m_cScores) {
+      // with zero or one classes there is no objective and ApplyTermUpdate never computes a metric
+      LOG_0(Trace_Info, "Exited BoosterCore::SetMetric no scores");
+      return Error_None;
+   }
+
+   if(EBM_FALSE == m_objectiveCpu.m_bMetricBins) {
+      // the objective's validation kernel needs to fill the score histogram
+      LOG_0(Trace_Warning, "WARNING BoosterCore::SetMetric EBM_FALSE == m_objectiveCpu.m_bMetricBins");
+      return Error_MetricMismatchWithObjective;
+   }
+
+   Config config;
+   config.cOutputs = m_cScores;
+   config.isDifferentialPrivacy = EBM_FALSE;
+   ErrorEbm error = GetMetric(&config, sMetric, &m_metricCpu);
+   if(Error_None != error) {
+      LOG_0(Trace_Warning, "WARNING BoosterCore::SetMetric GetMetric failed");
+      FreeMetricWrapperInternals(&m_metricCpu);
+      InitializeMetricWrapperUnfailing(&m_metricCpu);
+      return error;
+   }
+
+   EBM_ASSERT(1 <= m_metricCpu.m_cMetricBins);
+   if(IsMultiplyError(sizeof(*m_aMetricBins), m_metricCpu.m_cMetricBins)) {
+      LOG_0(Trace_Warning, "WARNING BoosterCore::SetMetric IsMultiplyError(sizeof(*m_aMetricBins), m_metricCpu.m_cMetricBins)");
+      FreeMetricWrapperInternals(&m_metricCpu);
+      InitializeMetricWrapperUnfailing(&m_metricCpu);
+      return Error_OutOfMemory;
+   }
+   m_aMetricBins = static_cast<double *>(malloc(sizeof(*m_aMetricBins) * m_metricCpu.m_cMetricBins));
+   if(nullptr == m_aMetricBins) {
+      LOG_0(Trace_Warning, "WARNING BoosterCore::SetMetric nullptr == m_aMetricBins");
+      FreeMetricWrapperInternals(&m_metricCpu);
+      InitializeMetricWrapperUnfailing(&m_metricCpu);
+      return Error_OutOfMemory;
+   }
+
+   LOG_0(Trace_Info, "Exited BoosterCore::SetMetric");
+   return Error_None;
+}
+
+void BoosterCore::PrepareMetricScoreRange(const FloatScore * const aUpdateScores, const size_t cTensorBins) {
+   EBM_ASSERT(nullptr != m_aMetricBins);
+   EBM_ASSERT(nullptr != aUpdateScores);
+   EBM_ASSERT(1 <= cTensorBins);
+
+   double low = m_metricScoreLow;
+   double high = m_metricScoreHigh;
+   if(!m_bMetricScoreRange) {
+      // the first pass after SetMetric has no histogram to bound the scores, so look at the scores themselves.
+      // NaN scores fail both comparisons and are left out
+      low = std::numeric_limits<double>::infinity();
+      high = -std::numeric_limits<double>::infinity();
+      DataSubsetBoosting * pSubset = m_validationSet.GetSubsets();
+      const DataSubsetBoosting * const pSubsetsEnd = pSubset + m_validationSet.GetCountSubsets();
+      do {
+         const size_t cFloatBytes = pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+         const void * pSampleScore = pSubset->GetSampleScores();
+         EBM_ASSERT(nullptr != pSampleScore);
+         const void * const pSampleScoresEnd =
+            IndexByte(pSampleScore, cFloatBytes * m_cScores * pSubset->GetCountSamples());
+         do {
+            double score;
+            if(sizeof(FloatBig) == cFloatBytes) {
+               score = static_cast<double>(*reinterpret_cast<const FloatBig *>(pSampleScore));
+            } else {
+               EBM_ASSERT(sizeof(FloatSmall) == cFloatBytes);
+               score = static_cast<double>(*reinterpret_cast<const FloatSmall *>(pSampleScore));
+            }
+            low = score < low ? score : low;
+            high = high < score ? score : high;
+            pSampleScore = IndexByte(pSampleScore, cFloatBytes);
+         } while(pSampleScoresEnd != pSampleScore);
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+   }
+
+   // every sample moves by one of the update scores, so the new scores stay within the old range widened by them
+   double updateLow = std::numeric_limits<double>::infinity();
+   double updateHigh = -std::numeric_limits<double>::infinity();
+   const FloatScore * pUpdateScore = aUpdateScores;
+   const FloatScore * const pUpdateScoresEnd = aUpdateScores + m_cScores * cTensorBins;
+   do {
+      const double update = static_cast<double>(*pUpdateScore);
+      updateLow = update < updateLow ? update : updateLow;
+      updateHigh = updateHigh < update ? update : updateHigh;
+      ++pUpdateScore;
+   } while(pUpdateScoresEnd != pUpdateScore);
+   low += updateLow;
+   high += updateHigh;
+
+   if(!(std::isfinite(low) && std::isfinite(high))) {
+      // boosting diverged or every score is NaN. The histogram clamps what falls outside, so any range works
+      low = k_metricScoreLowDiverged;
+      high = k_metricScoreHighDiverged;
+   }
+   // keep the bins wide enough that the scale stays finite when all the scores are equal
+   const double widthMin = k_metricScoreWidthMin * (std::abs(low) + std::abs(high) + 1.0);
+   if(!(widthMin <= high - low)) {
+      high = low + widthMin;
+   }
+
+   m_metricScoreLow = low;
+   m_metricScoreHigh = high;
+   m_bMetricScoreRange = true;
+}
+
+void BoosterCore::ShrinkMetricScoreRange() {
+   EBM_ASSERT(nullptr != m_aMetricBins);
+   EBM_ASSERT(m_bMetricScoreRange);
+
+   const size_t cScoreBins = m_metricCpu.m_cMetricBins >> 1;
+   EBM_ASSERT(1 <= cScoreBins);
+   const double * const aMetricBins = m_aMetricBins;
+
+   // samples with zero weight cannot change the metric, so bins that only hold them count as empty
+   size_t iBinFirst = 0;
+   while(0.0 == aMetricBins[iBinFirst << 1] && 0.0 == aMetricBins[(iBinFirst << 1) + 1]) {
+      ++iBinFirst;
+      if(cScoreBins == iBinFirst) {
+         // nothing was binned, so look at the scores again next time
+         m_bMetricScoreRange = false;
+         return;
+      }
+   }
+   size_t iBinLast = cScoreBins - size_t { 1 };
+   while(0.0 == aMetricBins[iBinLast << 1] && 0.0 == aMetricBins[(iBinLast << 1) + 1]) {
+      --iBinLast;
+   }
+   EBM_ASSERT(iBinFirst <= iBinLast);
+
+   const double width = (m_metricScoreHigh - m_metricScoreLow) / static_cast<double>(cScoreBins);
+   const double low = m_metricScoreLow;
+   m_metricScoreLow = low + width * static_cast<double>(iBinFirst);
+   m_metricScoreHigh = low + width * static_cast<double>(iBinLast + size_t { 1 });
+}
+
 } // DEFINED_ZONE_NAME
@@ -7,8 +7,11 @@
 
 #include <stdlib.h> // free
 #include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memset
 #include <limits> // numeric_limits
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 #include "libebm.h" // ErrorEbm
 #include "unzoned.h"
@@ -28,6 +31,7 @@ class FeatureBoosting;
 class Term;
 struct InnerBag;
 class Tensor;
+class OffloadQueue;
 
 class BoosterCore final {
 
@@ -40,6 +44,10 @@ class BoosterCore final {
 
    size_t m_cScores;
    BoolEbm m_bDisableApprox;
+   bool m_bCollectStats;
+   bool m_bFeatureStorage;
+   bool m_bBagBits;
+   size_t m_cBytesQuantized;
 
    size_t m_cFeatures;
    FeatureBoosting * m_aFeatures;
@@ -66,6 +74,36 @@ class BoosterCore final {
    ObjectiveWrapper m_objectiveCpu;
    ObjectiveWrapper m_objectiveSIMD;
 
+   // set by SetMetric. When m_aMetricBins is not nullptr the validation pass fills it and the metric replaces the
+   // objective's own metric for ApplyTermUpdate and for choosing the best model
+   MetricWrapper m_metricCpu;
+   double * m_aMetricBins;
+
+   // the validation score range that the metric histogram covers. When m_bMetricScoreRange is false the range is
+   // unknown and is found by scanning the validation scores
+   bool m_bMetricScoreRange;
+   double m_metricScoreLow;
+   double m_metricScoreHigh;
+
+   // non-null if CreateBoosterFlags_HostOffload was requested. Both objective wrappers point to it
+   OffloadQueue * m_pOffloadQueue;
+
+   // Views created by CreateBoosterView share this BoosterCore and may be called from different threads. Calls that
+   // only read the shared state (GenerateTermUpdate, GetBestTermScores, GetCurrentTermScores) hold the gate shared
+   // and run in parallel. Calls that modify it (ApplyTermUpdate, ApplyTermUpdateFused) hold it exclusively, as does
+   // any GenerateTermUpdate that needs to fill one of the lazily filled caches in the training set. Waiting
+   // exclusive callers block new shared callers so that a steady stream of GenerateTermUpdate calls can't starve
+   // ApplyTermUpdate.
+   std::mutex m_mutexGate;
+   std::condition_variable m_conditionGate;
+   size_t m_cGateShared;
+   size_t m_cGateExclusiveWaiting;
+   bool m_bGateExclusive;
+
+   // incremented by every ApplyTermUpdate. A histogram that ApplyTermUpdateFused left in a BoosterShell is only
+   // valid while this has not changed, since an update applied through another view changes the gradients
+   size_t m_iGradientVersion;
+
    static void DeleteTensors(const size_t cTerms, Tensor ** const apTensors);
 
    static ErrorEbm InitializeTensors(
@@ -75,12 +113,22 @@ class BoosterCore final {
       Tensor *** papTensorsOut
    );
 
+   ErrorEbm InitializeBinBytes(
+      const size_t cTensorBinsMax,
+      const size_t cMainBinsMax,
+      const size_t cSingleDimensionBinsMax
+   );
+
    ~BoosterCore();
 
    inline BoosterCore() noexcept :
       m_REFERENCE_COUNT(1), // we're not visible on any other thread yet, so no synchronization required
       m_cScores(0),
       m_bDisableApprox(EBM_FALSE),
+      m_bCollectStats(false),
+      m_bFeatureStorage(false),
+      m_bBagBits(false),
+      m_cBytesQuantized(0),
       m_cFeatures(0),
       m_aFeatures(nullptr),
       m_cTerms(0),
@@ -92,12 +140,22 @@ class BoosterCore final {
       m_cBytesFastBins(0),
       m_cBytesMainBins(0),
       m_cBytesSplitPositions(0),
-      m_cBytesTreeNodes(0)
+      m_cBytesTreeNodes(0),
+      m_aMetricBins(nullptr),
+      m_bMetricScoreRange(false),
+      m_metricScoreLow(0.0),
+      m_metricScoreHigh(0.0),
+      m_pOffloadQueue(nullptr),
+      m_cGateShared(0),
+      m_cGateExclusiveWaiting(0),
+      m_bGateExclusive(false),
+      m_iGradientVersion(0)
    {
       m_trainingSet.SafeInitDataSetBoosting();
       m_validationSet.SafeInitDataSetBoosting();
       InitializeObjectiveWrapperUnfailing(&m_objectiveCpu);
       InitializeObjectiveWrapperUnfailing(&m_objectiveSIMD);
+      InitializeMetricWrapperUnfailing(&m_metricCpu);
    }
 
 public:
@@ -133,6 +191,10 @@ public:
       return m_cTerms;
    }
 
+   inline OffloadQueue * GetOffloadQueue() const {
+      return m_pOffloadQueue;
+   }
+
    inline Term * const * GetTerms() const {
       return m_apTerms;
    }
@@ -183,6 +245,23 @@ public:
       BoosterCore ** const ppBoosterCoreOut
    );
 
+   // Appends terms to a booster that has already been boosted. The new features come from pDataSetShared, which 
+   // needs to hold the same samples in the same order as the dataset the booster was created on, but can be 
+   // binned differently. The scores, gradients and bags are kept. Only call while holding the gate exclusively 
+   // and without any views. On failure the BoosterCore is left freeable, but should not be boosted on.
+   ErrorEbm AddTerms(
+      const unsigned char * const pDataSetShared,
+      const BagEbm * const aBag,
+      const size_t cTerms,
+      const IntEbm * const acTermDimensions,
+      const IntEbm * const aiTermFeatures
+   );
+
+   inline bool IsViewed() const {
+      // true if CreateBoosterView shares us with another BoosterShell
+      return size_t { 1 } != m_REFERENCE_COUNT.load(std::memory_order_acquire);
+   }
+
    ErrorEbm InitializeBoosterGradientsAndHessians(
       void * const aMulticlassMidwayTemp,
       FloatScore * const aUpdateScores
@@ -193,6 +272,49 @@ public:
       return FinishMetricC(&m_objectiveCpu, metricSum);
    }
 
+   // a nullptr or empty sMetric returns to the objective's own metric
+   ErrorEbm SetMetric(const char * sMetric);
+
+   inline double * GetMetricBins() {
+      return m_aMetricBins;
+   }
+
+   inline size_t GetCountMetricBins() const noexcept {
+      return nullptr == m_aMetricBins ? size_t { 0 } : m_metricCpu.m_cMetricBins;
+   }
+
+   inline void ZeroMetricBins() {
+      if(nullptr != m_aMetricBins) {
+         memset(m_aMetricBins, 0, sizeof(*m_aMetricBins) * m_metricCpu.m_cMetricBins);
+      }
+   }
+
+   // bounds the validation scores that ApplyTermUpdate will bin once aUpdateScores is applied to them
+   void PrepareMetricScoreRange(const FloatScore * const aUpdateScores, const size_t cTensorBins);
+
+   // narrows the range to the bins that the last validation pass filled
+   void ShrinkMetricScoreRange();
+
+   inline double GetMetricScoreLow() const noexcept {
+      return m_metricScoreLow;
+   }
+
+   inline double GetMetricScoreScale() const noexcept {
+      EBM_ASSERT(m_metricScoreLow < m_metricScoreHigh);
+      return static_cast<double>(m_metricCpu.m_cMetricBins >> 1) / (m_metricScoreHigh - m_metricScoreLow);
+   }
+
+   inline double FinishMetricBins() {
+      EBM_ASSERT(nullptr != m_metricCpu.m_pMetric);
+      EBM_ASSERT(nullptr != m_aMetricBins);
+      return FinishMetricBinsC(&m_metricCpu, m_aMetricBins);
+   }
+
+   inline BoolEbm MaximizeMetricBins() const noexcept {
+      EBM_ASSERT(nullptr != m_metricCpu.m_pMetric);
+      return m_metricCpu.m_bMaximizeMetric;
+   }
+
    inline BoolEbm CheckTargets(const size_t c, const void * const aTargets) const noexcept {
       EBM_ASSERT(nullptr != aTargets);
       EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
@@ -213,6 +335,94 @@ public:
       return m_bDisableApprox;
    }
 
+   inline bool IsCollectStats() const {
+      // each BoosterShell, including views, allocates its own BoosterStats if this is set
+      return m_bCollectStats;
+   }
+
+   inline bool IsBagBits() const {
+      // the bag passed to CreateBooster, GetSampleScores, and AddTerms holds bag bits instead of BagEbm items
+      return m_bBagBits;
+   }
+
+   inline size_t GetCountBytesQuantized() const {
+      // zero if the gradients are not quantized, otherwise the size of the integers holding the gradients
+      return m_cBytesQuantized;
+   }
+
+   inline void LockShared() {
+      std::unique_lock<std::mutex> lock(m_mutexGate);
+      while(m_bGateExclusive || size_t { 0 } != m_cGateExclusiveWaiting) {
+         m_conditionGate.wait(lock);
+      }
+      ++m_cGateShared;
+   }
+
+   inline void UnlockShared() {
+      std::lock_guard<std::mutex> lock(m_mutexGate);
+      EBM_ASSERT(size_t { 1 } <= m_cGateShared);
+      --m_cGateShared;
+      if(size_t { 0 } == m_cGateShared) {
+         m_conditionGate.notify_all();
+      }
+   }
+
+   inline void LockExclusive() {
+      std::unique_lock<std::mutex> lock(m_mutexGate);
+      ++m_cGateExclusiveWaiting;
+      while(m_bGateExclusive || size_t { 0 } != m_cGateShared) {
+         m_conditionGate.wait(lock);
+      }
+      --m_cGateExclusiveWaiting;
+      m_bGateExclusive = true;
+   }
+
+   inline void UnlockExclusive() {
+      std::lock_guard<std::mutex> lock(m_mutexGate);
+      EBM_ASSERT(m_bGateExclusive);
+      m_bGateExclusive = false;
+      m_conditionGate.notify_all();
+   }
+
+   inline bool IsGenerateShared(const size_t iTerm) {
+      // GenerateTermUpdate only reads the shared state unless it needs to fill a lazily filled cache. The offload
+      // queue is also excluded since Synchronize waits on the commands of every caller and returns the first error
+      // of any of them. The queue already spreads each command over its own threads.
+      if(nullptr != m_pOffloadQueue) {
+         return false;
+      }
+      if(size_t { 0 } == m_trainingSet.GetCountSamples()) {
+         return true;
+      }
+      const DataSubsetBoosting * pSubset = m_trainingSet.GetSubsets();
+      const DataSubsetBoosting * const pSubsetsEnd = pSubset + m_trainingSet.GetCountSubsets();
+      do {
+         if(!pSubset->IsTermDataResident(iTerm)) {
+            return false;
+         }
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+      return true;
+   }
+
+   inline size_t GetGradientVersion() const {
+      return m_iGradientVersion;
+   }
+
+   inline void IncrementGradientVersion() {
+      // only called while holding the gate exclusively
+      ++m_iGradientVersion;
+   }
+
+   inline ErrorEbm QuantizeRmseResiduals() {
+      // every other objective quantizes its gradients as ApplyUpdateQuantized calculates them
+      EBM_ASSERT(IsRmse());
+      if(size_t { 0 } != m_cBytesQuantized) {
+         return m_trainingSet.QuantizeGradHess(IsHessian(), m_cScores, m_cBytesQuantized);
+      }
+      return Error_None;
+   }
+
    inline double LearningRateAdjustmentDifferentialPrivacy() const noexcept {
       EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
       return m_objectiveCpu.m_learningRateAdjustmentDifferentialPrivacy;
@@ -254,6 +464,36 @@ public:
    }
 };
 
+// Holds one side of the BoosterCore gate for the lifetime of an API call
+class BoosterCoreGate final {
+   BoosterCore * const m_pBoosterCore;
+   const bool m_bShared;
+
+public:
+
+   inline BoosterCoreGate(BoosterCore * const pBoosterCore, const bool bShared) :
+      m_pBoosterCore(pBoosterCore),
+      m_bShared(bShared) {
+      EBM_ASSERT(nullptr != pBoosterCore);
+      if(bShared) {
+         pBoosterCore->LockShared();
+      } else {
+         pBoosterCore->LockExclusive();
+      }
+   }
+
+   inline ~BoosterCoreGate() {
+      if(m_bShared) {
+         m_pBoosterCore->UnlockShared();
+      } else {
+         m_pBoosterCore->UnlockExclusive();
+      }
+   }
+
+   BoosterCoreGate(const BoosterCoreGate &) = delete;
+   BoosterCoreGate & operator=(const BoosterCoreGate &) = delete;
+};
+
 } // DEFINED_ZONE_NAME
 
 #endif // BOOSTER_CORE_HPP
@@ -17,9 +17,11 @@
 #include "Term.hpp" // Term
 #include "Transpose.hpp"
 #include "Tensor.hpp" // Tensor
+#include "dataset_shared.hpp" // GetDataSetSharedTarget
 
 #include "BoosterCore.hpp" // BoosterCore
 #include "BoosterShell.hpp"
+#include "BoosterStats.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -31,7 +33,7 @@ struct BinBase;
 extern void InitializeRmseGradientsAndHessiansBoosting(
    const unsigned char * const pDataSetShared,
    const BagEbm direction,
-   const BagEbm * const aBag,
+   const OuterBag & bag,
    const double * const aInitScores,
    DataSetBoosting * const pDataSet
 );
@@ -47,6 +49,7 @@ void BoosterShell::Free(BoosterShell * const pBoosterShell) {
       AlignedFree(pBoosterShell->m_aMulticlassMidwayTemp);
       AlignedFree(pBoosterShell->m_aSplitPositionsTemp);
       AlignedFree(pBoosterShell->m_aTreeNodesTemp);
+      BoosterStats::Free(pBoosterShell->m_pStats);
       BoosterCore::Free(pBoosterShell->m_pBoosterCore);
 
       // before we free our memory, indicate it was freed so if our higher level language attempts to use it we have
@@ -165,6 +168,13 @@ ErrorEbm BoosterShell::FillAllocations() {
       }
    }
 
+   if(m_pBoosterCore->IsCollectStats()) {
+      m_pStats = BoosterStats::Allocate(m_pBoosterCore->GetCountTerms());
+      if(nullptr == m_pStats) {
+         goto failed_allocation;
+      }
+   }
+
    LOG_0(Trace_Info, "Exited BoosterShell::FillAllocations");
    return Error_None;
 
@@ -173,6 +183,45 @@ failed_allocation:;
    return Error_OutOfMemory;
 }
 
+ErrorEbm BoosterShell::RefillAllocations() {
+   // AddTerms can increase the sizes that FillAllocations reads from the BoosterCore
+   LOG_0(Trace_Info, "Entered BoosterShell::RefillAllocations");
+
+   Tensor::Free(m_pTermUpdate);
+   m_pTermUpdate = nullptr;
+   Tensor::Free(m_pInnerTermUpdate);
+   m_pInnerTermUpdate = nullptr;
+   AlignedFree(m_aBoostingFastBinsTemp);
+   m_aBoostingFastBinsTemp = nullptr;
+   AlignedFree(m_aBoostingMainBins);
+   m_aBoostingMainBins = nullptr;
+   AlignedFree(m_aMulticlassMidwayTemp);
+   m_aMulticlassMidwayTemp = nullptr;
+   AlignedFree(m_aSplitPositionsTemp);
+   m_aSplitPositionsTemp = nullptr;
+   AlignedFree(m_aTreeNodesTemp);
+   m_aTreeNodesTemp = nullptr;
+
+   // any update or fused histogram we were holding was for the old allocations
+   m_iTerm = k_illegalTermIndex;
+   m_iTermFused = k_illegalTermIndex;
+
+   BoosterStats * const pStatsOld = m_pStats;
+   m_pStats = nullptr;
+
+   const ErrorEbm error = FillAllocations();
+   if(nullptr != m_pStats) {
+      m_pStats->CopyFrom(pStatsOld);
+      BoosterStats::Free(pStatsOld);
+   } else {
+      // keep the stats we had if we could not allocate new ones
+      m_pStats = pStatsOld;
+   }
+
+   LOG_0(Trace_Info, "Exited BoosterShell::RefillAllocations");
+   return error;
+}
+
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(
    void * rng,
    const void * dataSet,
@@ -231,7 +280,14 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(
    if(0 != (static_cast<UCreateBoosterFlags>(flags) & static_cast<UCreateBoosterFlags>(~(
       static_cast<UCreateBoosterFlags>(CreateBoosterFlags_DifferentialPrivacy) | 
       static_cast<UCreateBoosterFlags>(CreateBoosterFlags_DisableApprox) |
-      static_cast<UCreateBoosterFlags>(CreateBoosterFlags_BinaryAsMulticlass)
+      static_cast<UCreateBoosterFlags>(CreateBoosterFlags_BinaryAsMulticlass) |
+      static_cast<UCreateBoosterFlags>(CreateBoosterFlags_QuantizeGradients8) |
+      static_cast<UCreateBoosterFlags>(CreateBoosterFlags_QuantizeGradients16) |
+      static_cast<UCreateBoosterFlags>(CreateBoosterFlags_HostOffload) |
+      static_cast<UCreateBoosterFlags>(CreateBoosterFlags_FeatureStorage) |
+      static_cast<UCreateBoosterFlags>(CreateBoosterFlags_CollectStats) |
+      static_cast<UCreateBoosterFlags>(CreateBoosterFlags_BagBits) |
+      static_cast<UCreateBoosterFlags>(CreateBoosterFlags_PinThreads)
    )))) {
       LOG_0(Trace_Error, "ERROR CreateBooster flags contains unknown flags. Ignoring extras.");
    }
@@ -313,17 +369,22 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(
          InitializeRmseGradientsAndHessiansBoosting(
             static_cast<const unsigned char *>(dataSet),
             BagEbm { 1 },
-            bag,
+            OuterBag::Make(bag, pBoosterCore->IsBagBits()),
             initScores,
             pBoosterCore->GetTrainingSet()
          );
          InitializeRmseGradientsAndHessiansBoosting(
             static_cast<const unsigned char *>(dataSet),
             BagEbm { -1 },
-            bag,
+            OuterBag::Make(bag, pBoosterCore->IsBagBits()),
             initScores,
             pBoosterCore->GetValidationSet()
          );
+         error = pBoosterCore->QuantizeRmseResiduals();
+         if(UNLIKELY(Error_None != error)) {
+            BoosterShell::Free(pBoosterShell);
+            return error;
+         }
       }
    }
 
@@ -420,6 +481,9 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetBestTermScores(
       return Error_IllegalParamVal;
    }
 
+   // ApplyTermUpdate on another view can be writing the models
+   const BoosterCoreGate gate(pBoosterCore, true);
+
    if(size_t { 0 } == pBoosterCore->GetCountScores()) {
       // for classification, if there is only 1 possible target class, then the probability of that class is 100%.  
       // If there were logits in this model, they'd all be infinity, but you could alternatively think of this 
@@ -500,6 +564,9 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetCurrentTermScores(
       return Error_IllegalParamVal;
    }
 
+   // ApplyTermUpdate on another view can be writing the models
+   const BoosterCoreGate gate(pBoosterCore, true);
+
    if(size_t { 0 } == pBoosterCore->GetCountScores()) {
       // for classification, if there is only 1 possible target class, then the probability of that class is 100%.  
       // If there were logits in this model, they'd all be infinity, but you could alternatively think of this 
@@ -544,6 +611,277 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetCurrentTermScores(
    return Error_None;
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetSampleScores(
+   BoosterHandle boosterHandle,
+   BagEbm direction,
+   const void * dataSet,
+   const BagEbm * bag,
+   double * sampleScoresOut
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered GetSampleScores: "
+      "boosterHandle=%p, "
+      "direction=%" BagEbmPrintf ", "
+      "dataSet=%p, "
+      "bag=%p, "
+      "sampleScoresOut=%p"
+      ,
+      static_cast<void *>(boosterHandle),
+      direction,
+      dataSet,
+      static_cast<const void *>(bag),
+      static_cast<void *>(sampleScoresOut)
+   );
+
+   BoosterShell * const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(BagEbm { 1 } != direction && BagEbm { -1 } != direction) {
+      LOG_0(Trace_Error, "ERROR GetSampleScores direction must be 1 for training or -1 for validation");
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore * const pBoosterCore = pBoosterShell->GetBoosterCore();
+
+   // ApplyTermUpdate on another view can be writing the sample scores
+   const BoosterCoreGate gate(pBoosterCore, true);
+
+   const size_t cScores = pBoosterCore->GetCountScores();
+   if(size_t { 0 } == cScores) {
+      LOG_0(Trace_Info, "Exited GetSampleScores no scores");
+      return Error_None;
+   }
+
+   const DataSetBoosting * const pDataSet = BagEbm { 1 } == direction ?
+      pBoosterCore->GetTrainingSet() : pBoosterCore->GetValidationSet();
+   if(size_t { 0 } == pDataSet->GetCountSamples()) {
+      LOG_0(Trace_Info, "Exited GetSampleScores no samples");
+      return Error_None;
+   }
+
+   if(nullptr == sampleScoresOut) {
+      LOG_0(Trace_Error, "ERROR GetSampleScores sampleScoresOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   const FloatShared * aTargets = nullptr;
+   if(pBoosterCore->IsRmse()) {
+      // RMSE only keeps the residuals, so we need the targets to recover the scores
+      if(nullptr == dataSet) {
+         LOG_0(Trace_Error, "ERROR GetSampleScores dataSet cannot be nullptr for RMSE");
+         return Error_IllegalParamVal;
+      }
+      ptrdiff_t cClasses;
+      aTargets = static_cast<const FloatShared *>(
+         GetDataSetSharedTarget(static_cast<const unsigned char *>(dataSet), 0, &cClasses));
+      if(nullptr == aTargets || ptrdiff_t { Task_Regression } != cClasses) {
+         LOG_0(Trace_Error, "ERROR GetSampleScores dataSet does not have a regression target");
+         return Error_IllegalParamVal;
+      }
+   }
+
+   pDataSet->ExportSampleScores(
+      cScores,
+      direction,
+      OuterBag::Make(bag, pBoosterCore->IsBagBits()),
+      aTargets,
+      sampleScoresOut
+   );
+
+   LOG_0(Trace_Info, "Exited GetSampleScores");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION AddTerms(
+   BoosterHandle boosterHandle,
+   const void * dataSet,
+   const BagEbm * bag,
+   IntEbm countTerms,
+   const IntEbm * dimensionCounts,
+   const IntEbm * featureIndexes
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered AddTerms: "
+      "boosterHandle=%p, "
+      "dataSet=%p, "
+      "bag=%p, "
+      "countTerms=%" IntEbmPrintf ", "
+      "dimensionCounts=%p, "
+      "featureIndexes=%p"
+      ,
+      static_cast<void *>(boosterHandle),
+      dataSet,
+      static_cast<const void *>(bag),
+      countTerms,
+      static_cast<const void *>(dimensionCounts),
+      static_cast<const void *>(featureIndexes)
+   );
+
+   ErrorEbm error;
+
+   BoosterShell * const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == dataSet) {
+      LOG_0(Trace_Error, "ERROR AddTerms nullptr == dataSet");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countTerms)) {
+      LOG_0(Trace_Error, "ERROR AddTerms IsConvertError<size_t>(countTerms)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTerms = static_cast<size_t>(countTerms);
+   if(size_t { 0 } == cTerms) {
+      LOG_0(Trace_Info, "Exited AddTerms no terms");
+      return Error_None;
+   }
+
+   if(nullptr == dimensionCounts) {
+      LOG_0(Trace_Error, "ERROR AddTerms dimensionCounts cannot be null if 0 < countTerms");
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore * const pBoosterCore = pBoosterShell->GetBoosterCore();
+
+   const BoosterCoreGate gate(pBoosterCore, false);
+
+   if(pBoosterCore->IsViewed()) {
+      // the other views would keep bins sized for the old terms
+      LOG_0(Trace_Error, "ERROR AddTerms cannot add terms to a booster that has views");
+      return Error_IllegalParamVal;
+   }
+
+   error = pBoosterCore->AddTerms(
+      static_cast<const unsigned char *>(dataSet),
+      bag,
+      cTerms,
+      dimensionCounts,
+      featureIndexes
+   );
+   if(Error_None != error) {
+      return error;
+   }
+
+   error = pBoosterShell->RefillAllocations();
+   if(Error_None != error) {
+      return error;
+   }
+
+   LOG_0(Trace_Info, "Exited AddTerms");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SetValidationMetric(
+   BoosterHandle boosterHandle,
+   const char * metric
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered SetValidationMetric: "
+      "boosterHandle=%p, "
+      "metric=%p"
+      ,
+      static_cast<void *>(boosterHandle),
+      static_cast<const void *>(metric) // do not print the string for security reasons
+   );
+
+   BoosterShell * const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore * const pBoosterCore = pBoosterShell->GetBoosterCore();
+
+   const BoosterCoreGate gate(pBoosterCore, false);
+
+   const ErrorEbm error = pBoosterCore->SetMetric(metric);
+   if(Error_None != error) {
+      return error;
+   }
+
+   LOG_0(Trace_Info, "Exited SetValidationMetric");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetBoosterStats(
+   BoosterHandle boosterHandle,
+   IntEbm countPhaseStats,
+   IntEbm * phaseStatsOut,
+   IntEbm countTermStats,
+   IntEbm * termStatsOut
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered GetBoosterStats: "
+      "boosterHandle=%p, "
+      "countPhaseStats=%" IntEbmPrintf ", "
+      "phaseStatsOut=%p, "
+      "countTermStats=%" IntEbmPrintf ", "
+      "termStatsOut=%p"
+      ,
+      static_cast<void *>(boosterHandle),
+      countPhaseStats,
+      static_cast<void *>(phaseStatsOut),
+      countTermStats,
+      static_cast<void *>(termStatsOut)
+   );
+
+   BoosterShell * const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   const BoosterStats * const pStats = pBoosterShell->GetStats();
+   if(nullptr == pStats) {
+      LOG_0(Trace_Error, "ERROR GetBoosterStats the booster was not created with CreateBoosterFlags_CollectStats");
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr != phaseStatsOut) {
+      if(BoosterPhase_Count * BoosterStat_Count != countPhaseStats) {
+         LOG_0(Trace_Error, "ERROR GetBoosterStats countPhaseStats must be BoosterPhase_Count * BoosterStat_Count");
+         return Error_IllegalParamVal;
+      }
+      const uint64_t * pStat = pStats->GetPhaseStats();
+      const IntEbm * const pPhaseStatsEnd = &phaseStatsOut[countPhaseStats];
+      IntEbm * pPhaseStat = phaseStatsOut;
+      do {
+         EBM_ASSERT(static_cast<uint64_t>(std::numeric_limits<IntEbm>::max()) >= *pStat);
+         *pPhaseStat = static_cast<IntEbm>(*pStat);
+         ++pStat;
+         ++pPhaseStat;
+      } while(pPhaseStatsEnd != pPhaseStat);
+   }
+
+   if(nullptr != termStatsOut) {
+      EBM_ASSERT(!IsMultiplyError(pStats->GetCountTerms(), static_cast<size_t>(TermStat_Count)));
+      const size_t cTermStats = pStats->GetCountTerms() * static_cast<size_t>(TermStat_Count);
+      if(IsConvertError<size_t>(countTermStats) || cTermStats != static_cast<size_t>(countTermStats)) {
+         LOG_0(Trace_Error, "ERROR GetBoosterStats countTermStats must be countTerms * TermStat_Count");
+         return Error_IllegalParamVal;
+      }
+      const uint64_t * pStat = pStats->GetTermStats();
+      for(size_t iStat = 0; iStat < cTermStats; ++iStat) {
+         EBM_ASSERT(static_cast<uint64_t>(std::numeric_limits<IntEbm>::max()) >= pStat[iStat]);
+         termStatsOut[iStat] = static_cast<IntEbm>(pStat[iStat]);
+      }
+   }
+
+   LOG_0(Trace_Info, "Exited GetBoosterStats");
+   return Error_None;
+}
+
 EBM_API_BODY void EBM_CALLING_CONVENTION FreeBooster(
    BoosterHandle boosterHandle
 ) {
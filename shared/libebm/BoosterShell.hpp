@@ -21,6 +21,7 @@ class Tensor;
 
 struct BinBase;
 class BoosterCore;
+struct BoosterStats;
 
 template<bool bHessian, size_t cCompilerScores>
 struct SplitPosition;
@@ -36,6 +37,11 @@ class BoosterShell final {
    BoosterCore * m_pBoosterCore;
    size_t m_iTerm;
 
+   // term whose histogram ApplyTermUpdateFused already summed into m_aBoostingMainBins, or k_illegalTermIndex
+   size_t m_iTermFused;
+   // the BoosterCore gradient version that the fused histogram was summed from
+   size_t m_iGradientVersionFused;
+
    Tensor * m_pTermUpdate;
    Tensor * m_pInnerTermUpdate;
 
@@ -49,6 +55,9 @@ class BoosterShell final {
    void * m_aTreeNodesTemp;
    void * m_aSplitPositionsTemp;
 
+   // nullptr unless CreateBoosterFlags_CollectStats was specified
+   BoosterStats * m_pStats;
+
 #ifndef NDEBUG
    const BinBase * m_pDebugMainBinsEnd;
 #endif // NDEBUG
@@ -66,6 +75,8 @@ public:
       m_handleVerification = k_handleVerificationOk;
       m_pBoosterCore = pBoosterCore;
       m_iTerm = k_illegalTermIndex;
+      m_iTermFused = k_illegalTermIndex;
+      m_iGradientVersionFused = 0;
       m_pTermUpdate = nullptr;
       m_pInnerTermUpdate = nullptr;
       m_aBoostingFastBinsTemp = nullptr;
@@ -73,11 +84,13 @@ public:
       m_aMulticlassMidwayTemp = nullptr;
       m_aTreeNodesTemp = nullptr;
       m_aSplitPositionsTemp = nullptr;
+      m_pStats = nullptr;
    }
 
    static void Free(BoosterShell * const pBoosterShell);
    static BoosterShell * Create(BoosterCore * const pBoosterCore);
    ErrorEbm FillAllocations();
+   ErrorEbm RefillAllocations();
 
    INLINE_ALWAYS static BoosterShell * GetBoosterShellFromHandle(const BoosterHandle boosterHandle) {
       if(nullptr == boosterHandle) {
@@ -112,6 +125,22 @@ public:
       m_iTerm = iTerm;
    }
 
+   INLINE_ALWAYS size_t GetFusedTermIndex() {
+      return m_iTermFused;
+   }
+
+   INLINE_ALWAYS void SetFusedTermIndex(const size_t iTermFused) {
+      m_iTermFused = iTermFused;
+   }
+
+   INLINE_ALWAYS size_t GetFusedGradientVersion() {
+      return m_iGradientVersionFused;
+   }
+
+   INLINE_ALWAYS void SetFusedGradientVersion(const size_t iGradientVersion) {
+      m_iGradientVersionFused = iGradientVersion;
+   }
+
    INLINE_ALWAYS Tensor * GetTermUpdate() {
       return m_pTermUpdate;
    }
@@ -134,6 +163,10 @@ public:
       return m_aMulticlassMidwayTemp;
    }
 
+   INLINE_ALWAYS BoosterStats * GetStats() {
+      return m_pStats;
+   }
+
    template<bool bHessian, size_t cCompilerScores = 1>
    INLINE_ALWAYS TreeNode<bHessian, cCompilerScores> * GetTreeNodesTemp() {
       return static_cast<TreeNode<bHessian, cCompilerScores> *>(m_aTreeNodesTemp);
@@ -0,0 +1,155 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef BOOSTER_STATS_HPP
+#define BOOSTER_STATS_HPP
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memset
+#include <chrono>
+
+#include "libebm.h" // BoosterPhase_Count
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h"
+
+#include "common.hpp" // IsMultiplyError, IsAddError
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// BoosterStats accumulates the time and memory traffic of the boosting phases for a single BoosterShell. It only
+// exists if CreateBoosterFlags_CollectStats was given, and every instrumentation point goes through the static
+// Start/Stop functions below which do nothing but check for nullptr otherwise. Each BoosterShell owns its own
+// stats so that views boosting on different threads never write to the same counters.
+struct BoosterStats final {
+   BoosterStats() = default; // preserve our POD status
+   ~BoosterStats() = default; // preserve our POD status
+   void * operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete (void *) = delete; // we only use malloc/free in this library
+
+   static BoosterStats * Allocate(const size_t cTerms);
+
+   INLINE_ALWAYS static void Free(BoosterStats * const pStats) {
+      free(pStats);
+   }
+
+   INLINE_ALWAYS static uint64_t Start(const BoosterStats * const pStats) {
+      return nullptr == pStats ? uint64_t { 0 } : Now();
+   }
+
+   INLINE_ALWAYS static void Stop(
+      BoosterStats * const pStats,
+      const size_t iPhase,
+      const uint64_t tStart,
+      const size_t cBytes
+   ) {
+      if(nullptr != pStats) {
+         EBM_ASSERT(iPhase < static_cast<size_t>(BoosterPhase_Count));
+         uint64_t * const aStats = pStats->m_aaPhaseStats[iPhase];
+         aStats[BoosterStat_Nanoseconds] += Now() - tStart;
+         ++aStats[BoosterStat_Calls];
+         aStats[BoosterStat_Bytes] += static_cast<uint64_t>(cBytes);
+      }
+   }
+
+   INLINE_ALWAYS static void AddTime(BoosterStats * const pStats, const size_t iPhase, const uint64_t tStart) {
+      // for work that was counted when it was submitted but which we wait on later, like offloaded commands
+      if(nullptr != pStats) {
+         EBM_ASSERT(iPhase < static_cast<size_t>(BoosterPhase_Count));
+         pStats->m_aaPhaseStats[iPhase][BoosterStat_Nanoseconds] += Now() - tStart;
+      }
+   }
+
+   INLINE_ALWAYS static void StopTerm(
+      BoosterStats * const pStats,
+      const size_t iTerm,
+      const size_t iTermStatCalls,
+      const uint64_t tStart
+   ) {
+      if(nullptr != pStats) {
+         EBM_ASSERT(iTerm < pStats->m_cTerms);
+         EBM_ASSERT(iTermStatCalls + size_t { 1 } < static_cast<size_t>(TermStat_Count));
+         uint64_t * const aStats = &pStats->m_aTermStats[iTerm * static_cast<size_t>(TermStat_Count)];
+         ++aStats[iTermStatCalls];
+         aStats[iTermStatCalls + size_t { 1 }] += Now() - tStart;
+      }
+   }
+
+   INLINE_ALWAYS void CopyFrom(const BoosterStats * const pStats) {
+      // carries the stats over when AddTerms gives the BoosterShell new stats with room for more terms
+      EBM_ASSERT(nullptr != pStats);
+      EBM_ASSERT(pStats->m_cTerms <= m_cTerms);
+      memcpy(m_aaPhaseStats, pStats->m_aaPhaseStats, sizeof(m_aaPhaseStats));
+      memcpy(m_aTermStats, pStats->m_aTermStats, sizeof(uint64_t) * static_cast<size_t>(TermStat_Count) * pStats->m_cTerms);
+   }
+
+   INLINE_ALWAYS size_t GetCountTerms() const {
+      return m_cTerms;
+   }
+
+   INLINE_ALWAYS const uint64_t * GetPhaseStats() const {
+      return &m_aaPhaseStats[0][0];
+   }
+
+   INLINE_ALWAYS const uint64_t * GetTermStats() const {
+      return m_aTermStats;
+   }
+
+private:
+
+   INLINE_ALWAYS static uint64_t Now() {
+      // steady_clock is monotonic on every platform we build for, unlike the raw cycle counters which drift
+      // between cores and change rate with the CPU frequency
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+         std::chrono::steady_clock::now().time_since_epoch()).count());
+   }
+
+   size_t m_cTerms;
+   uint64_t m_aaPhaseStats[BoosterPhase_Count][BoosterStat_Count];
+
+   // struct hack: TermStat_Count entries per term
+   uint64_t m_aTermStats[1];
+};
+static_assert(std::is_standard_layout<BoosterStats>::value,
+   "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<BoosterStats>::value,
+   "We use memcpy in several places, so disallow non-trivial types in general");
+static_assert(std::is_pod<BoosterStats>::value,
+   "We use a lot of C constructs, so disallow non-POD types in general");
+
+inline BoosterStats * BoosterStats::Allocate(const size_t cTerms) {
+   const size_t cTermStats = size_t { 0 } == cTerms ? size_t { 1 } : cTerms;
+   if(IsMultiplyError(static_cast<size_t>(TermStat_Count), cTermStats)) {
+      LOG_0(Trace_Warning, "WARNING BoosterStats::Allocate IsMultiplyError(TermStat_Count, cTermStats)");
+      return nullptr;
+   }
+   const size_t cTermItems = static_cast<size_t>(TermStat_Count) * cTermStats;
+   if(IsMultiplyError(sizeof(uint64_t), cTermItems)) {
+      LOG_0(Trace_Warning, "WARNING BoosterStats::Allocate IsMultiplyError(sizeof(uint64_t), cTermItems)");
+      return nullptr;
+   }
+   const size_t cBytesTermStats = sizeof(uint64_t) * cTermItems;
+   const size_t cBytesHeader = offsetof(BoosterStats, m_aTermStats);
+   if(IsAddError(cBytesHeader, cBytesTermStats)) {
+      LOG_0(Trace_Warning, "WARNING BoosterStats::Allocate IsAddError(cBytesHeader, cBytesTermStats)");
+      return nullptr;
+   }
+   const size_t cBytes = cBytesHeader + cBytesTermStats;
+
+   BoosterStats * const pStats = static_cast<BoosterStats *>(malloc(cBytes));
+   if(UNLIKELY(nullptr == pStats)) {
+      LOG_0(Trace_Warning, "WARNING BoosterStats::Allocate nullptr == pStats");
+      return nullptr;
+   }
+   memset(pStats, 0, cBytes);
+   pStats->m_cTerms = cTerms;
+   return pStats;
+}
+
+} // DEFINED_ZONE_NAME
+
+#endif // BOOSTER_STATS_HPP
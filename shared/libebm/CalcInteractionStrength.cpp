@@ -197,9 +197,10 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(
       return Error_None;
    }
 
-   // TODO : we NEVER use the hessian term (currently) in GradientPair when calculating interaction scores, but we're spending time calculating 
-   // it, and it's taking up precious memory.  We should eliminate the hessian term HERE in our datastructures OR we should think whether we can 
-   // use the hessian as part of the gain function!!!
+   // The gain function does not use the hessian term unless k_bUseLogitboost is enabled, so by default the
+   // InteractionCore is created without hessians (see CreateInteractionFlags_EnableNewton) and everything below
+   // uses the gradient-only GradientPair layout. CalcInteractionFlags_EnableNewton only changes the gain scaling
+   // and is therefore still honored exactly when the detector holds no hessians.
 
    BinSumsInteractionBridge binSums;
 
@@ -384,7 +385,16 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(
       ++pSubset;
    } while(pSubsetsEnd != pSubset);
 
-
+   if(nullptr == pInteractionCore->GetDataSetInteraction()->GetSubsets()->GetWeights()) {
+      // BinSumsInteraction does not accumulate unit weights since they are identical to the sample counts
+      // only the count and weight are touched, and those precede the gradient pairs in both bin layouts
+      auto * pMainBin = aMainBins->Specialize<FloatMain, UIntMain, false>();
+      const auto * const pMainBinsEnd = IndexBin(pMainBin, cBytesPerMainBin * cTensorBins);
+      do {
+         pMainBin->SetWeight(static_cast<FloatMain>(pMainBin->GetCountSamples()));
+         pMainBin = IndexBin(pMainBin, cBytesPerMainBin);
+      } while(pMainBinsEnd != pMainBin);
+   }
 
    // TODO: we can exit here back to python to allow caller modification to our bins
 
@@ -2472,6 +2472,83 @@ INLINE_RELEASE_UNTEMPLATED static size_t GetUncuttableRangeLengthMin(
    return cUncuttableRangeLengthMin;
 }
 
+// Moves the outermost cuts inwards when they are far beyond the scale of the interior cuts so that the tail bins
+// do not dilute the graph.  See the comments where CutQuantile calls this for the full reasoning.
+static void TightenOuterCuts(
+   const size_t cCuts,
+   double * const aCuts,
+   const double scaleLowHigh,
+   const double scaleHighLow
+) noexcept {
+   EBM_ASSERT(size_t { 3 } <= cCuts);
+   EBM_ASSERT(nullptr != aCuts);
+   EBM_ASSERT(scaleLowHigh < scaleHighLow);
+
+   const double scaleMin = scaleHighLow - scaleLowHigh;
+   // scaleMin can be +infinity if scaleHighLow is max and scaleLowHigh is lowest.  We can handle it.
+   EBM_ASSERT(!std::isnan(scaleMin));
+   // IEEE 754 (which we static_assert) won't allow the subtraction of two unequal numbers to be non-zero
+   EBM_ASSERT(double { 0 } < scaleMin);
+
+   // limit the amount of dillution allowed for the tails by capping the relevant cCutPointRet value
+   // to 1/32, which means we leave about 3% of the visible area to tail bounds (1.5% on the left and
+   // 1.5% on the right)
+
+   const size_t cCutsLimited = size_t { 32 } < cCuts ? size_t { 32 } : cCuts;
+
+   // the leftmost and rightmost cuts can legally be right outside of the bounds between scaleHighLow and
+   // scaleLowHigh, so we subtract these two cuts, leaving us the number of ranges between the two end
+   // points.  Half a range on the bottom, N - 1 ranges in the middle, and half a range on the top
+   // Dividing by that number of ranges gives us the average range width.  We don't want to get the final
+   // cut though from the previous inner cut.  We want to move outwards from the scaleHighLow and
+   // scaleLowHigh values, which should be half a cut inwards (not exactly but in spirit), so we
+   // divide by two, which is the same as multiplying the divisor by 2, which is the right shift below
+   const size_t denominator = (cCutsLimited - size_t { 2 }) << 1;
+   EBM_ASSERT(size_t { 0 } < denominator);
+   const double movementFromEnds = scaleMin / static_cast<double>(denominator);
+   // movementFromEnds can be +infinity if scaleMin is infinity. We can handle it.
+   EBM_ASSERT(!std::isnan(movementFromEnds));
+   EBM_ASSERT(double { 0 } <= movementFromEnds); // underflow is possible
+
+   const double lowCutFullPrecisionMin = scaleLowHigh - movementFromEnds;
+   // lowCutFullPrecisionMin can be -infinity if movementFromEnds is +infinity.  We can handle it.
+   EBM_ASSERT(!std::isnan(lowCutFullPrecisionMin));
+   EBM_ASSERT(lowCutFullPrecisionMin < std::numeric_limits<double>::max());
+   // GetInterpretableEndpoint can accept -infinity, but it'll return -infinity in that case
+   const double lowCutMin = GetInterpretableEndpoint(lowCutFullPrecisionMin, movementFromEnds);
+   // lowCutMin can legally be -infinity and we handle this scenario below
+
+   const double lowCutExisting = *aCuts;
+   EBM_ASSERT(!std::isnan(lowCutExisting));
+   EBM_ASSERT(!std::isinf(lowCutExisting));
+
+   if(lowCutExisting < lowCutMin) {
+      // lowCutMin can legally be -infinity, but then we wouldn't get here then
+      EBM_ASSERT(!std::isnan(lowCutMin));
+      EBM_ASSERT(!std::isinf(lowCutMin));
+      *aCuts = lowCutMin;
+   }
+
+   const double highCutFullPrecisionMax = scaleHighLow + movementFromEnds;
+   // highCutFullPrecisionMax can be +infinity if movementFromEnds is +infinity.  We can handle it.
+   EBM_ASSERT(!std::isnan(highCutFullPrecisionMax));
+   EBM_ASSERT(std::numeric_limits<double>::lowest() < highCutFullPrecisionMax);
+   // GetInterpretableEndpoint can accept infinity, but it'll return infinity in that case
+   const double highCutMax = GetInterpretableEndpoint(highCutFullPrecisionMax, movementFromEnds);
+   // highCutMax can legally be +infinity and we handle this scenario below
+
+   const double highCutExisting = aCuts[cCuts - size_t { 1 }];
+   EBM_ASSERT(!std::isnan(highCutExisting));
+   EBM_ASSERT(!std::isinf(highCutExisting));
+
+   if(highCutMax < highCutExisting) {
+      // highCutMax can legally be +infinity, but then we wouldn't get here then
+      EBM_ASSERT(!std::isnan(highCutMax));
+      EBM_ASSERT(!std::isinf(highCutMax));
+      aCuts[cCuts - size_t { 1 }] = highCutMax;
+   }
+}
+
 // we don't care if an extra log message is outputted due to the non-atomic nature of the decrement to this value
 static int g_cLogEnterCutQuantile = 25;
 static int g_cLogExitCutQuantile = 25;
@@ -3176,71 +3253,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(
                   EBM_ASSERT(scaleLowHigh < scaleHighLow);
                   // this is the inescapable scale of our graph, from the value right above the lowest cut to the value 
                   // right below the highest cut
-
-                  const double scaleMin = scaleHighLow - scaleLowHigh;
-                  // scaleMin can be +infinity if scaleHighLow is max and scaleLowHigh is lowest.  We can handle it.
-                  EBM_ASSERT(!std::isnan(scaleMin));
-                  // IEEE 754 (which we static_assert) won't allow the subtraction of two unequal numbers to be non-zero
-                  EBM_ASSERT(double { 0 } < scaleMin);
-
-                  // limit the amount of dillution allowed for the tails by capping the relevant cCutPointRet value
-                  // to 1/32, which means we leave about 3% of the visible area to tail bounds (1.5% on the left and
-                  // 1.5% on the right)
-
-                  const size_t cCutsLimited = size_t { 32 } < cCutsRet ? size_t { 32 } : cCutsRet;
-
-                  // the leftmost and rightmost cuts can legally be right outside of the bounds between scaleHighLow and
-                  // scaleLowHigh, so we subtract these two cuts, leaving us the number of ranges between the two end
-                  // points.  Half a range on the bottom, N - 1 ranges in the middle, and half a range on the top
-                  // Dividing by that number of ranges gives us the average range width.  We don't want to get the final
-                  // cut though from the previous inner cut.  We want to move outwards from the scaleHighLow and
-                  // scaleLowHigh values, which should be half a cut inwards (not exactly but in spirit), so we
-                  // divide by two, which is the same as multiplying the divisor by 2, which is the right shift below
-                  EBM_ASSERT(IntEbm { 3 } <= countCuts);
-                  const size_t denominator = (cCutsLimited - size_t { 2 }) << 1;
-                  EBM_ASSERT(size_t { 0 } < denominator);
-                  const double movementFromEnds = scaleMin / static_cast<double>(denominator);
-                  // movementFromEnds can be +infinity if scaleMin is infinity. We can handle it.
-                  EBM_ASSERT(!std::isnan(movementFromEnds));
-                  EBM_ASSERT(double { 0 } <= movementFromEnds); // underflow is possible
-
-                  const double lowCutFullPrecisionMin = scaleLowHigh - movementFromEnds;
-                  // lowCutFullPrecisionMin can be -infinity if movementFromEnds is +infinity.  We can handle it.
-                  EBM_ASSERT(!std::isnan(lowCutFullPrecisionMin));
-                  EBM_ASSERT(lowCutFullPrecisionMin < std::numeric_limits<double>::max());
-                  // GetInterpretableEndpoint can accept -infinity, but it'll return -infinity in that case
-                  const double lowCutMin = GetInterpretableEndpoint(lowCutFullPrecisionMin, movementFromEnds);
-                  // lowCutMin can legally be -infinity and we handle this scenario below
-
-                  const double lowCutExisting = *cutsLowerBoundInclusiveOut;
-                  EBM_ASSERT(!std::isnan(lowCutExisting));
-                  EBM_ASSERT(!std::isinf(lowCutExisting));
-
-                  if(lowCutExisting < lowCutMin) {
-                     // lowCutMin can legally be -infinity, but then we wouldn't get here then
-                     EBM_ASSERT(!std::isnan(lowCutMin));
-                     EBM_ASSERT(!std::isinf(lowCutMin));
-                     *cutsLowerBoundInclusiveOut = lowCutMin;
-                  }
-
-                  const double highCutFullPrecisionMax = scaleHighLow + movementFromEnds;
-                  // highCutFullPrecisionMax can be +infinity if movementFromEnds is +infinity.  We can handle it.
-                  EBM_ASSERT(!std::isnan(highCutFullPrecisionMax));
-                  EBM_ASSERT(std::numeric_limits<double>::lowest() < highCutFullPrecisionMax);
-                  // GetInterpretableEndpoint can accept infinity, but it'll return infinity in that case
-                  const double highCutMax = GetInterpretableEndpoint(highCutFullPrecisionMax, movementFromEnds);
-                  // highCutMax can legally be +infinity and we handle this scenario below
-
-                  const double highCutExisting = *(pCutsLowerBoundInclusive - size_t { 1 });
-                  EBM_ASSERT(!std::isnan(highCutExisting));
-                  EBM_ASSERT(!std::isinf(highCutExisting));
-
-                  if(highCutMax < highCutExisting) {
-                     // highCutMax can legally be +infinity, but then we wouldn't get here then
-                     EBM_ASSERT(!std::isnan(highCutMax));
-                     EBM_ASSERT(!std::isinf(highCutMax));
-                     *(pCutsLowerBoundInclusive - size_t { 1 }) = highCutMax;
-                  }
+                  TightenOuterCuts(cCutsRet, cutsLowerBoundInclusiveOut, scaleLowHigh, scaleHighLow);
                }
             }
          }
@@ -3277,4 +3290,699 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(
    return error;
 }
 
+
+struct WeightedVal final {
+   WeightedVal() = default; // preserve our POD status
+   ~WeightedVal() = default; // preserve our POD status
+   void * operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete (void *) = delete; // we only use malloc/free in this library
+
+   double m_val;
+   double m_weight;
+   // the number of samples merged into this entry. CutQuantileWeighted has one sample per entry, while a
+   // QuantileSketch merges samples once it holds too many distinct values
+   size_t m_cSamples;
+};
+static_assert(std::is_standard_layout<WeightedVal>::value,
+   "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<WeightedVal>::value,
+   "We use memcpy in several places, so disallow non-trivial types in general");
+static_assert(std::is_pod<WeightedVal>::value,
+   "We use a lot of C constructs, so disallow non-POD types in general");
+
+class CompareWeightedVal final {
+public:
+   INLINE_ALWAYS bool operator() (const WeightedVal & lhs, const WeightedVal & rhs) const noexcept {
+      return lhs.m_val < rhs.m_val;
+   }
+};
+
+// Places up to cCutsMax cuts on the weighted quantiles of the entries, which must be sorted by value. cSamples is
+// the total of the m_cSamples counts, and weightTotal is the total of the weights. Returns the number of cuts.
+static size_t CutSortedWeightedVals(
+   const WeightedVal * const aWeightedVals,
+   const WeightedVal * const pWeightedValsEnd,
+   const size_t cSamples,
+   const double weightTotal,
+   const size_t cSamplesBinMin,
+   const size_t cCutsMax,
+   const BoolEbm isRounded,
+   double * const cutsLowerBoundInclusiveOut
+) noexcept {
+   EBM_ASSERT(nullptr != aWeightedVals);
+   EBM_ASSERT(aWeightedVals < pWeightedValsEnd);
+   EBM_ASSERT(double { 0 } < weightTotal);
+   EBM_ASSERT(size_t { 1 } <= cSamplesBinMin);
+   EBM_ASSERT(size_t { 1 } <= cCutsMax);
+   EBM_ASSERT(nullptr != cutsLowerBoundInclusiveOut);
+
+   // Walk the ranges of identical values in order and place each cut on the boundary closest to the point
+   // where the accumulated weight reaches the next quantile. The quantile targets are recalculated after each
+   // cut by dividing the remaining weight evenly between the remaining cuts, so when one value holds more
+   // weight than a bin should we don't waste the cuts that it jumps over and instead spread them over the rest.
+   // Like CutQuantile, minSamplesBin counts samples and not weight.
+   size_t cCutsRemaining = cCutsMax;
+   size_t cSamplesBin = 0;
+   size_t cSamplesSeen = 0;
+   double weightBinStart = double { 0 };
+   double weightSeen = double { 0 };
+   double scaleLowHigh = double { 0 };
+   double scaleHighLow = double { 0 };
+   double * pCut = cutsLowerBoundInclusiveOut;
+   const WeightedVal * pRun = aWeightedVals;
+   do {
+      const double val = pRun->m_val;
+      double weightRun = pRun->m_weight;
+      size_t cSamplesRun = pRun->m_cSamples;
+      const WeightedVal * pRunEnd = pRun + size_t { 1 };
+      while(pWeightedValsEnd != pRunEnd && val == pRunEnd->m_val) {
+         weightRun += pRunEnd->m_weight;
+         cSamplesRun += pRunEnd->m_cSamples;
+         ++pRunEnd;
+      }
+
+      if(size_t { 0 } != cSamplesBin && size_t { 0 } != cCutsRemaining) {
+         const double weightTarget = 
+            weightBinStart + (weightTotal - weightBinStart) / static_cast<double>(cCutsRemaining + size_t { 1 });
+         const double weightWithRun = weightSeen + weightRun;
+         // cut in front of this run if it passes the target and that boundary is no farther from the target
+         // than the boundary after the run. If the later boundary is closer, we cut there on the next run.
+         if(weightTarget <= weightWithRun && weightTarget - weightSeen <= weightWithRun - weightTarget) {
+            if(cSamplesBinMin <= cSamplesBin && cSamplesBinMin <= cSamples - cSamplesSeen) {
+               const double valLow = (pRun - size_t { 1 })->m_val;
+               EBM_ASSERT(valLow < val);
+               const double cut = EBM_FALSE == isRounded ? 
+                  ArithmeticMean(valLow, val) : GetInterpretableCutPointFloat(valLow, val);
+               EBM_ASSERT(cutsLowerBoundInclusiveOut == pCut || *(pCut - size_t { 1 }) < cut);
+               if(cutsLowerBoundInclusiveOut == pCut) {
+                  scaleLowHigh = val;
+               }
+               scaleHighLow = valLow;
+               *pCut = cut;
+               ++pCut;
+
+               --cCutsRemaining;
+               cSamplesBin = 0;
+               weightBinStart = weightSeen;
+            }
+         }
+      }
+
+      cSamplesBin += cSamplesRun;
+      cSamplesSeen += cSamplesRun;
+      weightSeen += weightRun;
+      pRun = pRunEnd;
+   } while(pWeightedValsEnd != pRun);
+   EBM_ASSERT(cSamples == cSamplesSeen);
+
+   const size_t cCutsRet = pCut - cutsLowerBoundInclusiveOut;
+   EBM_ASSERT(cCutsRet <= cCutsMax);
+
+   if(EBM_FALSE != isRounded && size_t { 3 } <= cCutsRet) {
+      // see the comments in CutQuantile for why we pull the outer cuts in
+      TightenOuterCuts(cCutsRet, cutsLowerBoundInclusiveOut, scaleLowHigh, scaleHighLow);
+   }
+
+   return cCutsRet;
+}
+
+// we don't care if an extra log message is outputted due to the non-atomic nature of the decrement to this value
+static int g_cLogEnterCutQuantileWeighted = 25;
+static int g_cLogExitCutQuantileWeighted = 25;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantileWeighted(
+   IntEbm countSamples,
+   const double * featureVals,
+   const double * weights,
+   IntEbm minSamplesBin,
+   BoolEbm isRounded,
+   IntEbm * countCutsInOut,
+   double * cutsLowerBoundInclusiveOut
+) {
+   LOG_COUNTED_N(
+      &g_cLogEnterCutQuantileWeighted,
+      Trace_Info,
+      Trace_Verbose,
+      "Entered CutQuantileWeighted: "
+      "countSamples=%" IntEbmPrintf ", "
+      "featureVals=%p, "
+      "weights=%p, "
+      "minSamplesBin=%" IntEbmPrintf ", "
+      "isRounded=%s, "
+      "countCutsInOut=%p, "
+      "cutsLowerBoundInclusiveOut=%p"
+      ,
+      countSamples,
+      static_cast<const void *>(featureVals),
+      static_cast<const void *>(weights),
+      minSamplesBin,
+      ObtainTruth(isRounded),
+      static_cast<void *>(countCutsInOut),
+      static_cast<void *>(cutsLowerBoundInclusiveOut)
+   );
+
+   ErrorEbm error;
+
+   IntEbm countCutsRet;
+
+   if(UNLIKELY(nullptr == countCutsInOut)) {
+      LOG_0(Trace_Error, "ERROR CutQuantileWeighted nullptr == countCutsInOut");
+      countCutsRet = IntEbm { 0 };
+      error = Error_IllegalParamVal;
+   } else {
+      if(UNLIKELY(countSamples <= IntEbm { 1 })) {
+         // can't cut 1 sample
+         countCutsRet = IntEbm { 0 };
+         error = Error_None;
+         if(UNLIKELY(countSamples < IntEbm { 0 })) {
+            LOG_0(Trace_Error, "ERROR CutQuantileWeighted countSamples < IntEbm { 0 }");
+            error = Error_IllegalParamVal;
+         }
+      } else {
+         if(UNLIKELY(nullptr == featureVals)) {
+            LOG_0(Trace_Error, "ERROR CutQuantileWeighted nullptr == featureVals");
+
+            countCutsRet = IntEbm { 0 };
+            error = Error_IllegalParamVal;
+            goto exit_with_log;
+         }
+
+         if(UNLIKELY(IsConvertError<size_t>(countSamples))) {
+            LOG_0(Trace_Warning, "WARNING CutQuantileWeighted IsConvertError<size_t>(countSamples)");
+
+            countCutsRet = IntEbm { 0 };
+            error = Error_IllegalParamVal;
+            goto exit_with_log;
+         }
+
+         const size_t cSamplesIncludingMissingVals = static_cast<size_t>(countSamples);
+
+         bool bUniformWeights = true;
+         if(nullptr != weights) {
+            const double weightFirst = weights[0];
+            const double * pWeight = weights;
+            const double * const pWeightsEnd = weights + cSamplesIncludingMissingVals;
+            do {
+               const double weight = *pWeight;
+               if(UNLIKELY(std::isnan(weight) || std::isinf(weight) || weight < double { 0 })) {
+                  LOG_0(Trace_Error, "ERROR CutQuantileWeighted weights must be finite and non-negative");
+
+                  countCutsRet = IntEbm { 0 };
+                  error = Error_IllegalParamVal;
+                  goto exit_with_log;
+               }
+               bUniformWeights &= weightFirst == weight;
+               ++pWeight;
+            } while(pWeightsEnd != pWeight);
+         }
+
+         if(bUniformWeights) {
+            // equal weights don't change the quantiles, so use the unweighted algorithm which has more freedom to
+            // trade cuts between ranges of identical values.  This also guarantees identical results to CutQuantile
+            countCutsRet = *countCutsInOut;
+            error = CutQuantile(
+               countSamples,
+               featureVals,
+               minSamplesBin,
+               isRounded,
+               &countCutsRet,
+               cutsLowerBoundInclusiveOut
+            );
+            goto exit_with_log;
+         }
+
+         if(IsMultiplyError(sizeof(WeightedVal), cSamplesIncludingMissingVals)) {
+            LOG_0(Trace_Error, "ERROR CutQuantileWeighted IsMultiplyError(sizeof(WeightedVal), cSamplesIncludingMissingVals)");
+
+            countCutsRet = IntEbm { 0 };
+            error = Error_OutOfMemory;
+            goto exit_with_log;
+         }
+         WeightedVal * const aWeightedVals = 
+            static_cast<WeightedVal *>(malloc(sizeof(WeightedVal) * cSamplesIncludingMissingVals));
+         if(UNLIKELY(nullptr == aWeightedVals)) {
+            LOG_0(Trace_Error, "ERROR CutQuantileWeighted nullptr == aWeightedVals");
+
+            countCutsRet = IntEbm { 0 };
+            error = Error_OutOfMemory;
+            goto exit_with_log;
+         }
+
+         // drop the missing values and turn the infinities into max/lowest like RemoveMissingValsAndReplaceInfinities
+         // does, but keep each value paired with its weight
+         double weightTotal = double { 0 };
+         WeightedVal * pWeightedVal = aWeightedVals;
+         for(size_t iSample = 0; iSample < cSamplesIncludingMissingVals; ++iSample) {
+            double val = featureVals[iSample];
+            if(!std::isnan(val)) {
+               if(UNLIKELY(std::isinf(val))) {
+                  val = double { 0 } < val ? std::numeric_limits<double>::max() : std::numeric_limits<double>::lowest();
+               }
+               const double weight = weights[iSample];
+               pWeightedVal->m_val = val;
+               pWeightedVal->m_weight = weight;
+               pWeightedVal->m_cSamples = 1;
+               weightTotal += weight;
+               ++pWeightedVal;
+            }
+         }
+         const size_t cSamples = pWeightedVal - aWeightedVals;
+         EBM_ASSERT(cSamples <= cSamplesIncludingMissingVals);
+
+         EBM_ASSERT(nullptr != countCutsInOut);
+         const IntEbm countCuts = *countCutsInOut;
+
+         if(UNLIKELY(countCuts <= IntEbm { 0 })) {
+            free(aWeightedVals);
+            countCutsRet = IntEbm { 0 };
+            error = Error_None;
+            if(UNLIKELY(countCuts < IntEbm { 0 })) {
+               LOG_0(Trace_Error, "ERROR CutQuantileWeighted countCuts can't be negative.");
+               error = Error_IllegalParamVal;
+            }
+            goto exit_with_log;
+         }
+
+         if(UNLIKELY(nullptr == cutsLowerBoundInclusiveOut)) {
+            // if we have a potential bin cut, then cutsLowerBoundInclusiveOut shouldn't be nullptr
+            LOG_0(Trace_Error, "ERROR CutQuantileWeighted nullptr == cutsLowerBoundInclusiveOut");
+
+            free(aWeightedVals);
+            countCutsRet = IntEbm { 0 };
+            error = Error_IllegalParamVal;
+            goto exit_with_log;
+         }
+
+         if(UNLIKELY(minSamplesBin <= IntEbm { 0 })) {
+            LOG_0(Trace_Warning,
+               "WARNING CutQuantileWeighted minSamplesBin shouldn't be zero or negative.  Setting to 1");
+
+            minSamplesBin = IntEbm { 1 };
+         }
+
+         EBM_ASSERT(!IsConvertError<IntEbm>(cSamples)); // since it came from an IntEbm originally
+         if(UNLIKELY(static_cast<IntEbm>(cSamples >> 1) < minSamplesBin || !(double { 0 } < weightTotal))) {
+            // each bin needs at least minSamplesBin samples, so we need two sets of minSamplesBin
+            // in order to make any cuts. Without any weight there is no mass to divide between the bins.
+            free(aWeightedVals);
+            countCutsRet = IntEbm { 0 };
+            error = Error_None;
+            goto exit_with_log;
+         }
+
+         // minSamplesBin is convertible to size_t since minSamplesBin <= (cSamples >> 1)
+         EBM_ASSERT(!IsConvertError<size_t>(minSamplesBin));
+         const size_t cSamplesBinMin = static_cast<size_t>(minSamplesBin);
+
+         const size_t cCutsMaxInitial = cSamples / cSamplesBinMin - size_t { 1 };
+         EBM_ASSERT(size_t { 1 } <= cCutsMaxInitial);
+         EBM_ASSERT(!IsConvertError<IntEbm>(cCutsMaxInitial));
+         const size_t cCutsMax = static_cast<IntEbm>(cCutsMaxInitial) < countCuts ?
+            cCutsMaxInitial : static_cast<size_t>(countCuts);
+
+         std::sort(aWeightedVals, aWeightedVals + cSamples, CompareWeightedVal());
+
+         const size_t cCutsRet = CutSortedWeightedVals(
+            aWeightedVals,
+            aWeightedVals + cSamples,
+            cSamples,
+            weightTotal,
+            cSamplesBinMin,
+            cCutsMax,
+            isRounded,
+            cutsLowerBoundInclusiveOut
+         );
+
+         free(aWeightedVals);
+
+         countCutsRet = static_cast<IntEbm>(cCutsRet);
+         error = Error_None;
+      }
+
+   exit_with_log:;
+
+      EBM_ASSERT(nullptr != countCutsInOut);
+      *countCutsInOut = countCutsRet;
+   }
+
+   LOG_COUNTED_N(
+      &g_cLogExitCutQuantileWeighted,
+      Trace_Info,
+      Trace_Verbose,
+      "Exited CutQuantileWeighted: "
+      "countCuts=%" IntEbmPrintf ", "
+      "return=%" ErrorEbmPrintf
+      ,
+      countCutsRet,
+      error
+   );
+
+   return error;
+}
+
+// a QuantileSketch holds up to m_cEntriesMax sorted entries, plus room for as many unsorted entries that were added
+// since the last compression
+struct QuantileSketch final {
+   static constexpr size_t k_handleVerificationOk = 14087; // random 15 bit number
+   static constexpr size_t k_handleVerificationFreed = 23117; // random 15 bit number
+   size_t m_handleVerification; // this needs to be at the top and make it pointer sized to keep best alignment
+
+   size_t m_cEntriesMax;
+   size_t m_cEntries;
+   size_t m_cSamples;
+   double m_weightTotal;
+   WeightedVal * m_aEntries;
+
+   QuantileSketch() = default; // preserve our POD status
+   ~QuantileSketch() = default; // preserve our POD status
+   void * operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete (void *) = delete; // we only use malloc/free in this library
+
+   inline static QuantileSketch * GetQuantileSketchFromHandle(const QuantileSketchHandle quantileSketchHandle) {
+      if(nullptr == quantileSketchHandle) {
+         LOG_0(Trace_Error, "ERROR GetQuantileSketchFromHandle null quantileSketchHandle");
+         return nullptr;
+      }
+      QuantileSketch * const pQuantileSketch = reinterpret_cast<QuantileSketch *>(quantileSketchHandle);
+      if(k_handleVerificationOk == pQuantileSketch->m_handleVerification) {
+         return pQuantileSketch;
+      }
+      if(k_handleVerificationFreed == pQuantileSketch->m_handleVerification) {
+         LOG_0(Trace_Error, "ERROR GetQuantileSketchFromHandle attempt to use freed QuantileSketchHandle");
+      } else {
+         LOG_0(Trace_Error, "ERROR GetQuantileSketchFromHandle attempt to use invalid QuantileSketchHandle");
+      }
+      return nullptr;
+   }
+
+   static void Free(QuantileSketch * const pQuantileSketch) {
+      if(nullptr != pQuantileSketch) {
+         free(pQuantileSketch->m_aEntries);
+         pQuantileSketch->m_handleVerification = k_handleVerificationFreed;
+         free(pQuantileSketch);
+      }
+   }
+
+   // sorts the entries and merges the ones with identical values, which is exact. If more than m_cEntriesMax
+   // entries remain, neighbouring entries are merged into groups that each hold at most 2 / (m_cEntriesMax - 1) of
+   // the total weight, unless a single value is heavier than that. A group keeps the value of its heaviest entry, so
+   // a cut placed by CutQuantileSketch can be off by the weight of the groups next to it.
+   void Compress() {
+      if(size_t { 0 } == m_cEntries) {
+         return;
+      }
+      std::sort(m_aEntries, m_aEntries + m_cEntries, CompareWeightedVal());
+
+      WeightedVal * pTo = m_aEntries;
+      const WeightedVal * pFrom = m_aEntries + size_t { 1 };
+      const WeightedVal * const pEntriesEnd = m_aEntries + m_cEntries;
+      while(pEntriesEnd != pFrom) {
+         if(pTo->m_val == pFrom->m_val) {
+            pTo->m_weight += pFrom->m_weight;
+            pTo->m_cSamples += pFrom->m_cSamples;
+         } else {
+            ++pTo;
+            *pTo = *pFrom;
+         }
+         ++pFrom;
+      }
+      m_cEntries = pTo - m_aEntries + size_t { 1 };
+
+      if(m_cEntries <= m_cEntriesMax) {
+         return;
+      }
+
+      // any two neighbouring groups together weigh more than weightGroupMax, which bounds the groups to m_cEntriesMax
+      EBM_ASSERT(size_t { 2 } <= m_cEntriesMax);
+      const double weightGroupMax = m_weightTotal * double { 2 } / static_cast<double>(m_cEntriesMax - size_t { 1 });
+
+      pTo = m_aEntries;
+      pFrom = m_aEntries + size_t { 1 };
+      const WeightedVal * const pMergedEnd = m_aEntries + m_cEntries;
+      double weightHeaviest = pTo->m_weight;
+      while(pMergedEnd != pFrom) {
+         if(pTo->m_weight + pFrom->m_weight <= weightGroupMax) {
+            if(weightHeaviest < pFrom->m_weight) {
+               weightHeaviest = pFrom->m_weight;
+               pTo->m_val = pFrom->m_val;
+            }
+            pTo->m_weight += pFrom->m_weight;
+            pTo->m_cSamples += pFrom->m_cSamples;
+         } else {
+            ++pTo;
+            *pTo = *pFrom;
+            weightHeaviest = pFrom->m_weight;
+         }
+         ++pFrom;
+      }
+      m_cEntries = pTo - m_aEntries + size_t { 1 };
+      // rounding in weightGroupMax can leave one extra group, which still leaves room to add more entries
+      EBM_ASSERT(m_cEntries <= m_cEntriesMax + size_t { 1 });
+   }
+};
+static_assert(std::is_standard_layout<QuantileSketch>::value,
+   "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<QuantileSketch>::value,
+   "We use memcpy in several places, so disallow non-trivial types in general");
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateQuantileSketch(
+   IntEbm countEntriesMax,
+   QuantileSketchHandle * quantileSketchHandleOut
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered CreateQuantileSketch: "
+      "countEntriesMax=%" IntEbmPrintf ", "
+      "quantileSketchHandleOut=%p"
+      ,
+      countEntriesMax,
+      static_cast<void *>(quantileSketchHandleOut)
+   );
+
+   if(nullptr == quantileSketchHandleOut) {
+      LOG_0(Trace_Error, "ERROR CreateQuantileSketch nullptr == quantileSketchHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *quantileSketchHandleOut = nullptr; // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+
+   if(countEntriesMax < IntEbm { 2 }) {
+      LOG_0(Trace_Error, "ERROR CreateQuantileSketch countEntriesMax < IntEbm { 2 }");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countEntriesMax)) {
+      LOG_0(Trace_Warning, "WARNING CreateQuantileSketch IsConvertError<size_t>(countEntriesMax)");
+      return Error_OutOfMemory;
+   }
+   const size_t cEntriesMax = static_cast<size_t>(countEntriesMax);
+   if(IsMultiplyError(sizeof(WeightedVal), cEntriesMax, size_t { 2 })) {
+      LOG_0(Trace_Warning, "WARNING CreateQuantileSketch IsMultiplyError(sizeof(WeightedVal), cEntriesMax, size_t { 2 })");
+      return Error_OutOfMemory;
+   }
+
+   QuantileSketch * const pQuantileSketch = static_cast<QuantileSketch *>(malloc(sizeof(QuantileSketch)));
+   if(nullptr == pQuantileSketch) {
+      LOG_0(Trace_Warning, "WARNING CreateQuantileSketch nullptr == pQuantileSketch");
+      return Error_OutOfMemory;
+   }
+   pQuantileSketch->m_handleVerification = QuantileSketch::k_handleVerificationOk;
+   pQuantileSketch->m_cEntriesMax = cEntriesMax;
+   pQuantileSketch->m_cEntries = 0;
+   pQuantileSketch->m_cSamples = 0;
+   pQuantileSketch->m_weightTotal = double { 0 };
+   pQuantileSketch->m_aEntries = static_cast<WeightedVal *>(malloc(sizeof(WeightedVal) * cEntriesMax * size_t { 2 }));
+   if(nullptr == pQuantileSketch->m_aEntries) {
+      LOG_0(Trace_Warning, "WARNING CreateQuantileSketch nullptr == pQuantileSketch->m_aEntries");
+      QuantileSketch::Free(pQuantileSketch);
+      return Error_OutOfMemory;
+   }
+
+   *quantileSketchHandleOut = reinterpret_cast<QuantileSketchHandle>(pQuantileSketch);
+
+   LOG_0(Trace_Info, "Exited CreateQuantileSketch");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION QuantileSketchAddSamples(
+   QuantileSketchHandle quantileSketchHandle,
+   IntEbm countSamples,
+   const double * featureVals,
+   const double * weights
+) {
+   QuantileSketch * const pQuantileSketch = QuantileSketch::GetQuantileSketchFromHandle(quantileSketchHandle);
+   if(nullptr == pQuantileSketch) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(countSamples <= IntEbm { 0 }) {
+      if(countSamples < IntEbm { 0 }) {
+         LOG_0(Trace_Error, "ERROR QuantileSketchAddSamples countSamples < IntEbm { 0 }");
+         return Error_IllegalParamVal;
+      }
+      return Error_None;
+   }
+   if(nullptr == featureVals) {
+      LOG_0(Trace_Error, "ERROR QuantileSketchAddSamples nullptr == featureVals");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR QuantileSketchAddSamples IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   if(nullptr != weights) {
+      const double * pWeight = weights;
+      const double * const pWeightsEnd = weights + cSamples;
+      do {
+         const double weight = *pWeight;
+         if(UNLIKELY(std::isnan(weight) || std::isinf(weight) || weight < double { 0 })) {
+            LOG_0(Trace_Error, "ERROR QuantileSketchAddSamples weights must be finite and non-negative");
+            return Error_IllegalParamVal;
+         }
+         ++pWeight;
+      } while(pWeightsEnd != pWeight);
+   }
+
+   const size_t cEntriesCapacity = pQuantileSketch->m_cEntriesMax << 1;
+   for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+      double val = featureVals[iSample];
+      if(!std::isnan(val)) {
+         // missing values are not cut, and infinities become max/lowest like in CutQuantileWeighted
+         if(UNLIKELY(std::isinf(val))) {
+            val = double { 0 } < val ? std::numeric_limits<double>::max() : std::numeric_limits<double>::lowest();
+         }
+         if(cEntriesCapacity == pQuantileSketch->m_cEntries) {
+            pQuantileSketch->Compress();
+         }
+         EBM_ASSERT(pQuantileSketch->m_cEntries < cEntriesCapacity);
+         const double weight = nullptr == weights ? double { 1 } : weights[iSample];
+         WeightedVal * const pEntry = &pQuantileSketch->m_aEntries[pQuantileSketch->m_cEntries];
+         pEntry->m_val = val;
+         pEntry->m_weight = weight;
+         pEntry->m_cSamples = 1;
+         ++pQuantileSketch->m_cEntries;
+         ++pQuantileSketch->m_cSamples;
+         pQuantileSketch->m_weightTotal += weight;
+      }
+   }
+
+   return Error_None;
+}
+
+// we don't care if an extra log message is outputted due to the non-atomic nature of the decrement to this value
+static int g_cLogEnterCutQuantileSketch = 25;
+static int g_cLogExitCutQuantileSketch = 25;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantileSketch(
+   QuantileSketchHandle quantileSketchHandle,
+   IntEbm minSamplesBin,
+   BoolEbm isRounded,
+   IntEbm * countCutsInOut,
+   double * cutsLowerBoundInclusiveOut
+) {
+   LOG_COUNTED_N(
+      &g_cLogEnterCutQuantileSketch,
+      Trace_Info,
+      Trace_Verbose,
+      "Entered CutQuantileSketch: "
+      "quantileSketchHandle=%p, "
+      "minSamplesBin=%" IntEbmPrintf ", "
+      "isRounded=%s, "
+      "countCutsInOut=%p, "
+      "cutsLowerBoundInclusiveOut=%p"
+      ,
+      static_cast<void *>(quantileSketchHandle),
+      minSamplesBin,
+      ObtainTruth(isRounded),
+      static_cast<void *>(countCutsInOut),
+      static_cast<void *>(cutsLowerBoundInclusiveOut)
+   );
+
+   if(UNLIKELY(nullptr == countCutsInOut)) {
+      LOG_0(Trace_Error, "ERROR CutQuantileSketch nullptr == countCutsInOut");
+      return Error_IllegalParamVal;
+   }
+   const IntEbm countCuts = *countCutsInOut;
+   *countCutsInOut = IntEbm { 0 };
+
+   QuantileSketch * const pQuantileSketch = QuantileSketch::GetQuantileSketchFromHandle(quantileSketchHandle);
+   if(nullptr == pQuantileSketch) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(countCuts <= IntEbm { 0 })) {
+      if(UNLIKELY(countCuts < IntEbm { 0 })) {
+         LOG_0(Trace_Error, "ERROR CutQuantileSketch countCuts can't be negative.");
+         return Error_IllegalParamVal;
+      }
+      return Error_None;
+   }
+
+   if(UNLIKELY(nullptr == cutsLowerBoundInclusiveOut)) {
+      LOG_0(Trace_Error, "ERROR CutQuantileSketch nullptr == cutsLowerBoundInclusiveOut");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(minSamplesBin <= IntEbm { 0 })) {
+      LOG_0(Trace_Warning, "WARNING CutQuantileSketch minSamplesBin shouldn't be zero or negative.  Setting to 1");
+      minSamplesBin = IntEbm { 1 };
+   }
+
+   const size_t cSamples = pQuantileSketch->m_cSamples;
+   if(IsConvertError<IntEbm>(cSamples >> 1) || static_cast<IntEbm>(cSamples >> 1) < minSamplesBin ||
+      !(double { 0 } < pQuantileSketch->m_weightTotal)) {
+      // each bin needs at least minSamplesBin samples, so we need two sets of minSamplesBin
+      // in order to make any cuts. Without any weight there is no mass to divide between the bins.
+      return Error_None;
+   }
+   const size_t cSamplesBinMin = static_cast<size_t>(minSamplesBin);
+
+   const size_t cCutsMaxInitial = cSamples / cSamplesBinMin - size_t { 1 };
+   EBM_ASSERT(size_t { 1 } <= cCutsMaxInitial);
+   const size_t cCutsMax = !IsConvertError<IntEbm>(cCutsMaxInitial) &&
+      static_cast<IntEbm>(cCutsMaxInitial) < countCuts ? cCutsMaxInitial : static_cast<size_t>(countCuts);
+
+   // sorting and merging identical values leaves the sketch valid, so more samples can be added afterwards
+   pQuantileSketch->Compress();
+   EBM_ASSERT(size_t { 1 } <= pQuantileSketch->m_cEntries);
+
+   const size_t cCutsRet = CutSortedWeightedVals(
+      pQuantileSketch->m_aEntries,
+      pQuantileSketch->m_aEntries + pQuantileSketch->m_cEntries,
+      cSamples,
+      pQuantileSketch->m_weightTotal,
+      cSamplesBinMin,
+      cCutsMax,
+      isRounded,
+      cutsLowerBoundInclusiveOut
+   );
+   const IntEbm countCutsRet = static_cast<IntEbm>(cCutsRet);
+   *countCutsInOut = countCutsRet;
+
+   LOG_COUNTED_N(
+      &g_cLogExitCutQuantileSketch,
+      Trace_Info,
+      Trace_Verbose,
+      "Exited CutQuantileSketch: "
+      "countCuts=%" IntEbmPrintf
+      ,
+      countCutsRet
+   );
+
+   return Error_None;
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION FreeQuantileSketch(
+   QuantileSketchHandle quantileSketchHandle
+) {
+   LOG_N(Trace_Info, "Entered FreeQuantileSketch: quantileSketchHandle=%p", static_cast<void *>(quantileSketchHandle));
+
+   // if the conversion doesn't work, it'll return null, and we'll leak memory, but at least we'll log that
+   QuantileSketch::Free(QuantileSketch::GetQuantileSketchFromHandle(quantileSketchHandle));
+
+   LOG_0(Trace_Info, "Exited FreeQuantileSketch");
+}
+
 } // DEFINED_ZONE_NAME
@@ -6,6 +6,8 @@
 
 #include <stdlib.h> // free
 #include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memcpy, memset
+#include <cmath> // std::abs, std::floor
 
 #define ZONE_main
 #include "zones.h"
@@ -23,7 +25,36 @@ namespace DEFINED_ZONE_NAME {
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
-void DataSubsetBoosting::DestructDataSubsetBoosting(const size_t cTerms, const size_t cInnerBags) {
+// the gradients/hessians and the sample scores stay resident on the compute device when our objective is offloaded
+static void * AllocateResident(const DataSubsetBoosting * const pSubset, const size_t cBytes) {
+   OffloadQueue * const pOffloadQueue = pSubset->GetOffloadQueue();
+   if(nullptr == pOffloadQueue) {
+      return AlignedAlloc(cBytes);
+   }
+   const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+   return pOffloadQueue->AllocateDevice(cBytes, pSubset->GetCountSamples() / cSIMDPack, cSIMDPack);
+}
+
+// host memory that the offloaded commands read on every round, which is placed near the workers that read it
+static void * AllocatePlaced(const DataSubsetBoosting * const pSubset, const size_t cBytes) {
+   void * const p = AlignedAlloc(cBytes);
+   OffloadQueue * const pOffloadQueue = pSubset->GetOffloadQueue();
+   if(nullptr != p && nullptr != pOffloadQueue) {
+      const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+      pOffloadQueue->FirstTouch(p, cBytes, pSubset->GetCountSamples() / cSIMDPack, cSIMDPack);
+   }
+   return p;
+}
+
+void DataSubsetBoosting::FreeResident(void * const p) const {
+   if(nullptr != m_pObjective && nullptr != m_pObjective->m_pOffloadQueue) {
+      static_cast<OffloadQueue *>(m_pObjective->m_pOffloadQueue)->FreeDevice(p);
+   } else {
+      AlignedFree(p);
+   }
+}
+
+void DataSubsetBoosting::DestructDataSubsetBoosting(const size_t cTerms, const size_t cFeatures, const size_t cInnerBags) {
    LOG_0(Trace_Info, "Entered DataSubsetBoosting::DestructDataSubsetBoosting");
 
    InnerBag::FreeInnerBags(cInnerBags, m_aInnerBags);
@@ -31,17 +62,37 @@ void DataSubsetBoosting::DestructDataSubsetBoosting(const size_t cTerms, const s
    void ** paTermData = m_aaTermData;
    if(nullptr != paTermData) {
       EBM_ASSERT(1 <= cTerms);
-      const void * const * const paTermDataEnd = paTermData + cTerms;
-      do {
-         AlignedFree(*paTermData);
-         ++paTermData;
-      } while(paTermDataEnd != paTermData);
+      if(nullptr == m_aaFeatureData) {
+         const void * const * const paTermDataEnd = paTermData + cTerms;
+         do {
+            AlignedFree(*paTermData);
+            ++paTermData;
+         } while(paTermDataEnd != paTermData);
+      }
+      // otherwise the term data points into m_aaFeatureData
       free(m_aaTermData);
    }
 
+   void ** paFeatureData = m_aaFeatureData;
+   if(nullptr != paFeatureData) {
+      EBM_ASSERT(1 <= cFeatures);
+      const void * const * const paFeatureDataEnd = paFeatureData + cFeatures;
+      do {
+         AlignedFree(*paFeatureData);
+         ++paFeatureData;
+      } while(paFeatureDataEnd != paFeatureData);
+      free(m_aaFeatureData);
+   }
+
+   for(size_t iSlot = 0; iSlot < k_cCombinedTermSlots; ++iSlot) {
+      AlignedFree(m_aaCombinedTermData[iSlot]);
+   }
+
    AlignedFree(m_aTargetData);
-   AlignedFree(m_aSampleScores);
-   AlignedFree(m_aGradHess);
+   FreeResident(m_aSampleScores);
+   free(m_aQuantizeScales);
+   AlignedFree(m_aGradHessQuantized);
+   FreeResident(m_aGradHess);
 
    LOG_0(Trace_Info, "Exited DataSubsetBoosting::DestructDataSubsetBoosting");
 }
@@ -78,7 +129,7 @@ ErrorEbm DataSetBoosting::InitGradHess(
       const size_t cBytesGradHess = pSubset->m_pObjective->m_cFloatBytes * cTotalScores * cSubsetSamples;
       ANALYSIS_ASSERT(0 != cBytesGradHess);
 
-      void * const aGradHess = AlignedAlloc(cBytesGradHess);
+      void * const aGradHess = AllocateResident(pSubset, cBytesGradHess);
       if(nullptr == aGradHess) {
          LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHess nullptr == aGradHess");
          return Error_OutOfMemory;
@@ -92,20 +143,727 @@ ErrorEbm DataSetBoosting::InitGradHess(
    return Error_None;
 }
 
+// ApplyUpdateQuantized writes the float gradients and hessians of this many bytes at a time into the chunk of its
+// worker where they are still in the CPU cache when we quantize them
+static constexpr size_t k_cBytesQuantizeChunk = size_t { 1 } << 16;
+
+// the scale of each update is set from the largest magnitudes of the previous update with this much room to grow.
+// If a gradient or hessian outgrows it, or the magnitudes shrink below half of it, the subset is recalculated
+static constexpr double k_quantizeHeadroom = 1.25;
+
+// QuantizeChunk visits the chunk in blocks of at least this many values so that the compiler can vectorize it
+static constexpr size_t k_cQuantizePatternMin = 256;
+// each block starts reading the dither table at a random offset below this
+static constexpr size_t k_cQuantizeDitherShifts = 1024;
+
+static size_t GetCountQuantizePattern(const size_t cGroupItems) {
+   // the pattern holds a whole number of sample groups, so position k always holds slot (k / cSIMDPack) % cTotalScores
+   EBM_ASSERT(1 <= cGroupItems);
+   return cGroupItems * EbmMax(k_cQuantizePatternMin / cGroupItems, size_t { 1 });
+}
+
+static size_t GetCountGroupsQuantizeChunk(const size_t cBytesPerGroup, const int cPack) {
+   EBM_ASSERT(1 <= cBytesPerGroup);
+   size_t cGroupsChunk = EbmMax(k_cBytesQuantizeChunk / cBytesPerGroup, size_t { 1 });
+   if(k_cItemsPerBitPackNone != cPack) {
+      // ApplyUpdate puts the leftover items in the first packed word, so after the first chunk every chunk needs 
+      // to start on a packed word boundary
+      EBM_ASSERT(1 <= cPack);
+      const size_t cPackAlign = static_cast<size_t>(cPack);
+      cGroupsChunk = (cGroupsChunk + cPackAlign - size_t { 1 }) / cPackAlign * cPackAlign;
+   }
+   return cGroupsChunk;
+}
+
+static size_t AlignScratch(const size_t cBytes) {
+   return (cBytes + size_t { SIMD_BYTE_ALIGNMENT } - size_t { 1 }) / size_t { SIMD_BYTE_ALIGNMENT } * 
+      size_t { SIMD_BYTE_ALIGNMENT };
+}
+
+ErrorEbm DataSetBoosting::InitGradHessQuantized(
+   const bool bHessian,
+   const size_t cScores,
+   const size_t cBytesQuantized
+) {
+   LOG_0(Trace_Info, "Entered DataSetBoosting::InitGradHessQuantized");
+
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(sizeof(int8_t) == cBytesQuantized || sizeof(int16_t) == cBytesQuantized);
+
+   size_t cTotalScores = cScores;
+   if(bHessian) {
+      if(IsMultiplyError(size_t { 2 }, cTotalScores)) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHessQuantized IsMultiplyError(size_t { 2 }, cTotalScores)");
+         return Error_OutOfMemory;
+      }
+      cTotalScores = cTotalScores << 1;
+   }
+
+   if(IsMultiplyError(sizeof(double) * size_t { 2 }, cTotalScores)) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHessQuantized IsMultiplyError(sizeof(double) * size_t { 2 }, cTotalScores)");
+      return Error_OutOfMemory;
+   }
+
+   size_t cBytesChunkMax = 0;
+   size_t cSIMDPackMax = 0;
+   size_t cPatternMax = 0;
+
+   DataSubsetBoosting * pSubset = m_aSubsets;
+   const DataSubsetBoosting * const pSubsetsEnd = pSubset + m_cSubsets;
+   do {
+      const size_t cSubsetSamples = pSubset->m_cSamples;
+      EBM_ASSERT(1 <= cSubsetSamples);
+
+      if(IsMultiplyError(cBytesQuantized, cTotalScores, cSubsetSamples)) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHessQuantized IsMultiplyError(cBytesQuantized, cTotalScores, cSubsetSamples)");
+         return Error_OutOfMemory;
+      }
+      const size_t cBytesGradHess = cBytesQuantized * cTotalScores * cSubsetSamples;
+      ANALYSIS_ASSERT(0 != cBytesGradHess);
+
+      // the offloaded slices quantize into this, and the bin sums read it on every round
+      void * const aGradHessQuantized = AllocatePlaced(pSubset, cBytesGradHess);
+      if(nullptr == aGradHessQuantized) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHessQuantized nullptr == aGradHessQuantized");
+         return Error_OutOfMemory;
+      }
+      pSubset->m_aGradHessQuantized = aGradHessQuantized;
+
+      double * const aQuantizeScales = static_cast<double *>(malloc(sizeof(double) * size_t { 2 } * cTotalScores));
+      if(nullptr == aQuantizeScales) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHessQuantized nullptr == aQuantizeScales");
+         return Error_OutOfMemory;
+      }
+      pSubset->m_aQuantizeScales = aQuantizeScales;
+      for(size_t iSlot = 0; iSlot < cTotalScores; ++iSlot) {
+         aQuantizeScales[iSlot] = 0.0;
+         // the first update has no previous magnitudes, so it always calculates the subset twice
+         aQuantizeScales[cTotalScores + iSlot] = std::numeric_limits<double>::quiet_NaN();
+      }
+
+      // the chunk is widened to a multiple of the items in a packed word, which is at most the bits in a UIntBig
+      const size_t cSIMDPack = pSubset->m_pObjective->m_cSIMDPack;
+      if(IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, cTotalScores, cSIMDPack)) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHessQuantized IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, cTotalScores, cSIMDPack)");
+         return Error_OutOfMemory;
+      }
+      const size_t cBytesPerGroup = pSubset->m_pObjective->m_cFloatBytes * cTotalScores * cSIMDPack;
+      const size_t cGroupsChunkMax = GetCountGroupsQuantizeChunk(cBytesPerGroup, k_cItemsPerBitPackNone) + 
+         size_t { COUNT_BITS(UIntBig) };
+      if(IsMultiplyError(cBytesPerGroup, cGroupsChunkMax)) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHessQuantized IsMultiplyError(cBytesPerGroup, cGroupsChunkMax)");
+         return Error_OutOfMemory;
+      }
+      cBytesChunkMax = EbmMax(cBytesChunkMax, cBytesPerGroup * cGroupsChunkMax);
+      cSIMDPackMax = EbmMax(cSIMDPackMax, cSIMDPack);
+      // cTotalScores * cSIMDPack cannot overflow since it is a factor of cBytesPerGroup
+      cPatternMax = EbmMax(cPatternMax, GetCountQuantizePattern(cTotalScores * cSIMDPack));
+
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+
+   // Each worker of the offload queue, or just the one thread without it, gets its own chunk, multiclass temporary
+   // memory, pattern, and running maximums. The pattern holds the multiples, the maximums of each position, and the
+   // dither table. The zero update that comes before the workers is shared since it is only read
+   OffloadQueue * const pOffloadQueue = m_aSubsets->GetOffloadQueue();
+   const size_t cWorkers = nullptr == pOffloadQueue ? size_t { 1 } : EbmMax(pOffloadQueue->GetCountThreads(), size_t { 1 });
+
+   if(IsMultiplyError(sizeof(FloatBig), cScores, cSIMDPackMax) || IsMultiplyError(size_t { 3 }, cPatternMax) || 
+      IsAddError(cPatternMax * size_t { 3 }, k_cQuantizeDitherShifts) ||
+      IsMultiplyError(sizeof(FloatSmall), cPatternMax * size_t { 3 } + k_cQuantizeDitherShifts)) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHessQuantized IsMultiplyError(sizeof(FloatSmall), cPatternMax * size_t { 3 } + k_cQuantizeDitherShifts)");
+      return Error_OutOfMemory;
+   }
+   const size_t cBytesZeroUpdate = AlignScratch(sizeof(FloatBig) * cScores);
+   const size_t cBytesChunk = AlignScratch(cBytesChunkMax);
+   const size_t cBytesTemp = AlignScratch(sizeof(FloatBig) * cScores * cSIMDPackMax);
+   const size_t cBytesPattern = AlignScratch(sizeof(FloatSmall) * (cPatternMax * size_t { 3 } + k_cQuantizeDitherShifts));
+   const size_t cBytesMaxAbs = AlignScratch(sizeof(double) * cTotalScores);
+   if(IsAddError(cBytesChunk, cBytesTemp, cBytesPattern, cBytesMaxAbs)) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHessQuantized IsAddError(cBytesChunk, cBytesTemp, cBytesPattern, cBytesMaxAbs)");
+      return Error_OutOfMemory;
+   }
+   const size_t cBytesWorker = cBytesChunk + cBytesTemp + cBytesPattern + cBytesMaxAbs;
+   if(IsMultiplyError(cBytesWorker, cWorkers) || IsAddError(cBytesZeroUpdate, cBytesWorker * cWorkers)) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHessQuantized IsAddError(cBytesZeroUpdate, cBytesWorker * cWorkers)");
+      return Error_OutOfMemory;
+   }
+
+   void * const aQuantizeScratch = AlignedAlloc(cBytesZeroUpdate + cBytesWorker * cWorkers);
+   if(nullptr == aQuantizeScratch) {
+      LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHessQuantized nullptr == aQuantizeScratch");
+      return Error_OutOfMemory;
+   }
+   m_aQuantizeScratch = aQuantizeScratch;
+   static_assert(std::numeric_limits<FloatBig>::is_iec559, "memset of floats requires IEEE 754 to guarantee zeros");
+   memset(aQuantizeScratch, 0, sizeof(FloatBig) * cScores);
+   m_cQuantizeWorkers = cWorkers;
+   m_iQuantizeWorkers = cBytesZeroUpdate;
+   m_cBytesQuantizeWorker = cBytesWorker;
+   m_iQuantizeTemp = cBytesChunk;
+   m_iQuantizePattern = cBytesChunk + cBytesTemp;
+   m_iQuantizeMaxAbs = cBytesChunk + cBytesTemp + cBytesPattern;
+
+   LOG_0(Trace_Info, "Exited DataSetBoosting::InitGradHessQuantized");
+   return Error_None;
+}
+
+static double MaxAbsKeepNaN(const double maxAbs, const double valAbs) {
+   // once a NaN gets into the max it stays there, so that a NaN gradient always gets a new scale
+   return maxAbs < valAbs || valAbs != valAbs ? valAbs : maxAbs;
+}
+
+static void StartQuantizePattern(
+   RandomDeterministic & rng,
+   const size_t cTotalScores,
+   const size_t cSIMDPack,
+   const size_t cPattern,
+   const double * const aQuantizeScales,
+   FloatSmall * const aPattern
+) {
+   // The gradient array is layed out in SIMD packs of cSIMDPack samples where each gradient and each hessian
+   // occupy a contiguous block of cSIMDPack values, so slot iSlot of sample group iGroup is located at
+   // (iGroup * cTotalScores + iSlot) * cSIMDPack. Instead of visiting the chunk once per slot with a stride,
+   // QuantizeChunk walks it contiguously and takes the multiple of each position from this pattern, which repeats 
+   // every cPattern values. The pattern is followed by the running maximums of each position and the dither table.
+   // Everything is in FloatSmall even for the FloatBig zones since halving the width doubles the values per SIMD 
+   // instruction, and a float holds many more bits than we keep after quantizing.
+
+   EBM_ASSERT(1 <= cTotalScores);
+   EBM_ASSERT(1 <= cSIMDPack);
+   EBM_ASSERT(0 == cPattern % (cTotalScores * cSIMDPack));
+
+   static constexpr int k_cBitsDither = 16;
+   static constexpr double k_ditherMultiple = 1.0 / static_cast<double>(uint64_t { 1 } << k_cBitsDither);
+
+   FloatSmall * const aMultiples = aPattern;
+   FloatSmall * const aMaxAbs = aPattern + cPattern;
+   FloatSmall * const aDither = aPattern + cPattern * size_t { 2 };
+
+   size_t iPattern = 0;
+   do {
+      size_t iSlot = 0;
+      do {
+         const double scale = aQuantizeScales[iSlot];
+         // a scale so small that its multiple overflows a float only happens when every value of the slot is 
+         // negligible, so those are quantized to zero like the values of a NaN or infinite scale
+         const double multiple = 1.0 / scale;
+         const FloatSmall multipleSmall = static_cast<FloatSmall>(std::numeric_limits<double>::min() <= scale && 
+            multiple <= static_cast<double>(std::numeric_limits<FloatSmall>::max()) ? multiple : 0.0);
+         size_t iPartition = 0;
+         do {
+            aMultiples[iPattern] = multipleSmall;
+            aMaxAbs[iPattern] = 0;
+            ++iPattern;
+            ++iPartition;
+         } while(cSIMDPack != iPartition);
+         ++iSlot;
+      } while(cTotalScores != iSlot);
+   } while(cPattern != iPattern);
+
+   // stochastic rounding keeps the quantized sums unbiased, which matters for int8 where the rounding errors would
+   // otherwise accumulate in the bins. QuantizeChunk rounds to nearest, so the dither is centered on zero. 16 bits 
+   // of dither is plenty, so each random number serves 4 values, and the values are exact in float
+   RandomDeterministic rngLocal = rng;
+   const size_t cDither = cPattern + k_cQuantizeDitherShifts;
+   size_t iDither = 0;
+   do {
+      uint64_t bitsDither = rngLocal.Next<uint64_t>();
+      int cBitsDither = COUNT_BITS(uint64_t);
+      do {
+         aDither[iDither] = static_cast<FloatSmall>(
+            (static_cast<double>(bitsDither & ((uint64_t { 1 } << k_cBitsDither) - uint64_t { 1 })) + 0.5) * 
+            k_ditherMultiple - 0.5);
+         bitsDither >>= k_cBitsDither;
+         cBitsDither -= k_cBitsDither;
+         ++iDither;
+      } while(0 != cBitsDither && cDither != iDither);
+   } while(cDither != iDither);
+   rng = rngLocal;
+}
+
+static void FinishQuantizePattern(
+   const size_t cTotalScores,
+   const size_t cSIMDPack,
+   const size_t cPattern,
+   const FloatSmall * const aPattern,
+   double * const aMaxAbs
+) {
+   const FloatSmall * pPatternMaxAbs = aPattern + cPattern;
+   const FloatSmall * const pPatternMaxAbsEnd = pPatternMaxAbs + cPattern;
+   do {
+      size_t iSlot = 0;
+      do {
+         double maxAbs = aMaxAbs[iSlot];
+         size_t iPartition = 0;
+         do {
+            maxAbs = MaxAbsKeepNaN(maxAbs, static_cast<double>(pPatternMaxAbs[iPartition]));
+            ++iPartition;
+         } while(cSIMDPack != iPartition);
+         aMaxAbs[iSlot] = maxAbs;
+         pPatternMaxAbs += cSIMDPack;
+         ++iSlot;
+      } while(cTotalScores != iSlot);
+   } while(pPatternMaxAbsEnd != pPatternMaxAbs);
+}
+
+template<typename TFloatIn, typename TQuant>
+static void QuantizeChunk(
+   RandomDeterministic & rng,
+   const size_t cPattern,
+   FloatSmall * const aPattern,
+   size_t cValues,
+   const TFloatIn * pGradHess,
+   TQuant * pGradHessQuantized
+) {
+   typedef FloatSmall TFloat;
+   static_assert(std::numeric_limits<TFloat>::is_iec559, "rounding with k_roundOffset requires IEEE 754");
+   static_assert(sizeof(uint32_t) == sizeof(TFloat), "uint32_t must hold the bits of TFloat");
+
+   // Adding this leaves no bits for the fraction, so any value below 2^(digits-2) is rounded to the nearest integer,
+   // and that integer is in the low bits of the sum in two's complement. Reading it from there instead of converting
+   // and clamping halves the cost of the loop below. Our scales leave a step of room for the dither, so only values
+   // that outgrew their scale can wrap, and those are recalculated by our caller
+   static constexpr TFloat k_roundOffset = 
+      static_cast<TFloat>(uint64_t { 3 } << (std::numeric_limits<TFloat>::digits - 2));
+   static_assert(static_cast<TFloat>(std::numeric_limits<TQuant>::max()) < k_roundOffset / TFloat { 3 }, 
+      "the quantized values need to be within the rounding range");
+
+   EBM_ASSERT(1 <= cPattern);
+   EBM_ASSERT(1 <= cValues);
+
+   const TFloat * const aMultiples = aPattern;
+   TFloat * const aMaxAbs = aPattern + cPattern;
+   const TFloat * const aDither = aPattern + cPattern * size_t { 2 };
+
+   RandomDeterministic rngLocal = rng;
+   do {
+      const size_t cBlock = EbmMin(cValues, cPattern);
+      // reusing the table from a random offset decorrelates the noise of neighbouring blocks
+      const TFloat * const pDither = aDither + rngLocal.NextFast(k_cQuantizeDitherShifts);
+
+      // this loop has no branches so that the compiler can vectorize it
+      size_t i = 0;
+      do {
+         const TFloat val = static_cast<TFloat>(pGradHess[i]);
+         const TFloat valAbs = std::abs(val);
+         const TFloat maxAbs = aMaxAbs[i];
+         // the comparison keeps a NaN that is already in the max, and val - val is zero unless val is NaN or 
+         // infinite, which includes FloatBig values beyond the range of a float, in which case it makes the max NaN.
+         // Either way the caller recalculates with a NaN scale
+         aMaxAbs[i] = (valAbs > maxAbs ? valAbs : maxAbs) + (val - val);
+
+         const TFloat rounded = val * aMultiples[i] + pDither[i] + k_roundOffset;
+         uint32_t bits;
+         memcpy(&bits, &rounded, sizeof(bits));
+         pGradHessQuantized[i] = static_cast<TQuant>(bits);
+         ++i;
+      } while(cBlock != i);
+
+      pGradHess += cBlock;
+      pGradHessQuantized += cBlock;
+      cValues -= cBlock;
+   } while(size_t { 0 } != cValues);
+   rng = rngLocal;
+}
+
+template<typename TQuant>
+static void QuantizeChunkFloat(
+   RandomDeterministic & rng,
+   const size_t cPattern,
+   FloatSmall * const aPattern,
+   const size_t cFloatBytes,
+   const size_t cValues,
+   const void * const aGradHess,
+   void * const aGradHessQuantized
+) {
+   if(sizeof(FloatBig) == cFloatBytes) {
+      QuantizeChunk<FloatBig, TQuant>(
+         rng,
+         cPattern,
+         aPattern,
+         cValues,
+         static_cast<const FloatBig *>(aGradHess),
+         static_cast<TQuant *>(aGradHessQuantized)
+      );
+   } else {
+      EBM_ASSERT(sizeof(FloatSmall) == cFloatBytes);
+      QuantizeChunk<FloatSmall, TQuant>(
+         rng,
+         cPattern,
+         aPattern,
+         cValues,
+         static_cast<const FloatSmall *>(aGradHess),
+         static_cast<TQuant *>(aGradHessQuantized)
+      );
+   }
+}
+
+static void QuantizeChunkTypes(
+   RandomDeterministic & rng,
+   const size_t cPattern,
+   FloatSmall * const aPattern,
+   const size_t cFloatBytes,
+   const size_t cBytesQuantized,
+   const size_t cValues,
+   const void * const aGradHess,
+   void * const aGradHessQuantized
+) {
+   if(sizeof(int8_t) == cBytesQuantized) {
+      QuantizeChunkFloat<int8_t>(rng, cPattern, aPattern, cFloatBytes, cValues, aGradHess, aGradHessQuantized);
+   } else {
+      EBM_ASSERT(sizeof(int16_t) == cBytesQuantized);
+      QuantizeChunkFloat<int16_t>(rng, cPattern, aPattern, cFloatBytes, cValues, aGradHess, aGradHessQuantized);
+   }
+}
+
+static double GetQuantizeMax(const size_t cBytesQuantized) {
+   // one below the largest integer, so that the dither and the rounding of the multiply cannot round past it
+   return sizeof(int8_t) == cBytesQuantized ? static_cast<double>(std::numeric_limits<int8_t>::max() - 1) :
+      static_cast<double>(std::numeric_limits<int16_t>::max() - 1);
+}
+
+static void SetExactQuantizeScales(const size_t cTotalScores, const size_t cBytesQuantized, double * const aQuantizeScales) {
+   // the magnitudes were measured on the update that is being recalculated, so nothing can exceed these scales
+   const double quantizeMax = GetQuantizeMax(cBytesQuantized);
+   double * const aMaxAbs = aQuantizeScales + cTotalScores;
+   size_t iSlot = 0;
+   do {
+      const double maxAbs = aMaxAbs[iSlot];
+      // an overflowing or NaN gradient would poison every quantized value, so QuantizeChunk multiplies by zero and
+      // the bad value goes into the scale instead where it will propagate into the bin sums like the float version would
+      aQuantizeScales[iSlot] = LIKELY(maxAbs <= std::numeric_limits<double>::max()) ? maxAbs / quantizeMax : maxAbs;
+      aMaxAbs[iSlot] = 0.0;
+      ++iSlot;
+   } while(cTotalScores != iSlot);
+}
+
+struct QuantizeSlices final {
+   const DataSetBoosting * m_pDataSet;
+   DataSubsetBoosting * m_pSubset;
+   // nullptr when the float gradients already exist in m_aGradHess and only need to be quantized
+   const ApplyUpdateBridge * m_pData;
+   size_t m_cTotalScores;
+   size_t m_cBytesQuantized;
+   uint64_t m_seed;
+};
+
+ErrorEbm DataSetBoosting::QuantizeSlice(
+   void * const pContext,
+   const size_t iWorker,
+   const size_t iSlice,
+   const size_t iGroupFirst,
+   const size_t cGroupsSlice
+) {
+   const QuantizeSlices * const pSlices = static_cast<const QuantizeSlices *>(pContext);
+   EBM_ASSERT(nullptr != pSlices);
+   EBM_ASSERT(1 <= cGroupsSlice);
+
+   const DataSetBoosting * const pDataSet = pSlices->m_pDataSet;
+   EBM_ASSERT(iWorker < pDataSet->m_cQuantizeWorkers);
+   DataSubsetBoosting * const pSubset = pSlices->m_pSubset;
+   const size_t cTotalScores = pSlices->m_cTotalScores;
+   const size_t cBytesQuantized = pSlices->m_cBytesQuantized;
+
+   const ObjectiveWrapper * const pObjective = pSubset->m_pObjective;
+   const size_t cSIMDPack = pObjective->m_cSIMDPack;
+   const size_t cFloatBytes = pObjective->m_cFloatBytes;
+   const size_t cBytesPerGroup = cFloatBytes * cTotalScores * cSIMDPack;
+
+   void * const pWorker = IndexByte(pDataSet->m_aQuantizeScratch, 
+      pDataSet->m_iQuantizeWorkers + pDataSet->m_cBytesQuantizeWorker * iWorker);
+   FloatSmall * const aPattern = static_cast<FloatSmall *>(IndexByte(pWorker, pDataSet->m_iQuantizePattern));
+
+   // every slice has its own random numbers, so the dither does not depend on the worker that runs the slice
+   RandomDeterministic rng;
+   rng.Initialize(pSlices->m_seed + static_cast<uint64_t>(iSlice));
+
+   const size_t cPattern = GetCountQuantizePattern(cTotalScores * cSIMDPack);
+   StartQuantizePattern(rng, cTotalScores, cSIMDPack, cPattern, pSubset->m_aQuantizeScales, aPattern);
+
+   // RMSE updates its residuals in place, and everything else writes each chunk over the same scratch memory
+   void * pGradHess = nullptr == pSubset->m_aGradHess ? nullptr : IndexByte(pSubset->m_aGradHess, cBytesPerGroup * iGroupFirst);
+   void * pGradHessQuantized = IndexByte(pSubset->m_aGradHessQuantized, 
+      cTotalScores * cSIMDPack * cBytesQuantized * iGroupFirst);
+
+   if(nullptr == pSlices->m_pData) {
+      EBM_ASSERT(nullptr != pGradHess);
+      QuantizeChunkTypes(rng, cPattern, aPattern, cFloatBytes, cBytesQuantized, cGroupsSlice * cSIMDPack * cTotalScores,
+         pGradHess, pGradHessQuantized);
+   } else {
+      ApplyUpdateBridge data = *pSlices->m_pData;
+      if(nullptr != data.m_aMulticlassMidwayTemp) {
+         data.m_aMulticlassMidwayTemp = IndexByte(pWorker, pDataSet->m_iQuantizeTemp);
+      }
+      const size_t cSamplesBefore = cSIMDPack * iGroupFirst;
+      if(k_cItemsPerBitPackNone != data.m_cPack && size_t { 0 } != iGroupFirst) {
+         // the first slice holds the partially filled first packed word, and every other slice starts on a word
+         const size_t cWords = (iGroupFirst - size_t { 1 }) / static_cast<size_t>(data.m_cPack) + size_t { 1 };
+         data.m_aPacked = IndexByte(data.m_aPacked, cWords * cSIMDPack * pObjective->m_cUIntBytes);
+      }
+      if(nullptr != data.m_aTargets) {
+         data.m_aTargets = IndexByte(data.m_aTargets, cSamplesBefore * pSubset->m_cTargetBytes);
+      }
+      if(nullptr != data.m_aSampleScores) {
+         data.m_aSampleScores = IndexByte(data.m_aSampleScores, cSamplesBefore * data.m_cScores * cFloatBytes);
+      }
+
+      const size_t cGroupsChunk = GetCountGroupsQuantizeChunk(cBytesPerGroup, data.m_cPack);
+      size_t cGroupsRemaining = cGroupsSlice;
+
+      // the first chunk takes the remainder so that it contains the partially filled first packed word
+      size_t cGroups = cGroupsRemaining % cGroupsChunk;
+      cGroups = size_t { 0 } == cGroups ? cGroupsChunk : cGroups;
+      do {
+         const size_t cSamples = cGroups * cSIMDPack;
+
+         data.m_cSamples = cSamples;
+         data.m_aGradientsAndHessians = nullptr != pGradHess ? pGradHess : pWorker;
+         const ErrorEbm error = (*pObjective->m_pApplyUpdateC)(pObjective, &data);
+         if(Error_None != error) {
+            return error;
+         }
+
+         QuantizeChunkTypes(rng, cPattern, aPattern, cFloatBytes, cBytesQuantized, cGroups * cSIMDPack * cTotalScores,
+            data.m_aGradientsAndHessians, pGradHessQuantized);
+
+         if(k_cItemsPerBitPackNone != data.m_cPack) {
+            const size_t cWords = (cGroups - size_t { 1 }) / static_cast<size_t>(data.m_cPack) + size_t { 1 };
+            data.m_aPacked = IndexByte(data.m_aPacked, cWords * cSIMDPack * pObjective->m_cUIntBytes);
+         }
+         if(nullptr != data.m_aTargets) {
+            data.m_aTargets = IndexByte(data.m_aTargets, cSamples * pSubset->m_cTargetBytes);
+         }
+         if(nullptr != data.m_aSampleScores) {
+            data.m_aSampleScores = IndexByte(data.m_aSampleScores, cSamples * data.m_cScores * cFloatBytes);
+         }
+         if(nullptr != pGradHess) {
+            pGradHess = IndexByte(pGradHess, cGroups * cBytesPerGroup);
+         }
+         pGradHessQuantized = IndexByte(pGradHessQuantized, cGroups * cTotalScores * cSIMDPack * cBytesQuantized);
+
+         cGroupsRemaining -= cGroups;
+         cGroups = cGroupsChunk;
+      } while(size_t { 0 } != cGroupsRemaining);
+   }
+
+   FinishQuantizePattern(cTotalScores, cSIMDPack, cPattern, aPattern, 
+      static_cast<double *>(IndexByte(pWorker, pDataSet->m_iQuantizeMaxAbs)));
+
+   return Error_None;
+}
+
+ErrorEbm DataSetBoosting::QuantizeSubset(
+   DataSubsetBoosting * const pSubset,
+   const ApplyUpdateBridge * const pData,
+   const size_t cTotalScores,
+   const size_t cBytesQuantized,
+   const uint64_t seed
+) {
+   EBM_ASSERT(nullptr != pSubset);
+   EBM_ASSERT(nullptr == pData || EBM_FALSE == pData->m_bValidation);
+   EBM_ASSERT(nullptr != m_aQuantizeScratch);
+   EBM_ASSERT(nullptr != pSubset->m_aQuantizeScales);
+
+   size_t iWorker = 0;
+   do {
+      double * const aWorkerMaxAbs = static_cast<double *>(
+         IndexByte(m_aQuantizeScratch, m_iQuantizeWorkers + m_cBytesQuantizeWorker * iWorker + m_iQuantizeMaxAbs));
+      size_t iSlot = 0;
+      do {
+         aWorkerMaxAbs[iSlot] = 0.0;
+         ++iSlot;
+      } while(cTotalScores != iSlot);
+      ++iWorker;
+   } while(m_cQuantizeWorkers != iWorker);
+
+   QuantizeSlices slices;
+   slices.m_pDataSet = this;
+   slices.m_pSubset = pSubset;
+   slices.m_pData = pData;
+   slices.m_cTotalScores = cTotalScores;
+   slices.m_cBytesQuantized = cBytesQuantized;
+   slices.m_seed = seed;
+
+   const size_t cSIMDPack = pSubset->m_pObjective->m_cSIMDPack;
+   EBM_ASSERT(0 == pSubset->m_cSamples % cSIMDPack);
+   const size_t cGroups = pSubset->m_cSamples / cSIMDPack;
+   EBM_ASSERT(1 <= cGroups);
+
+   ErrorEbm error;
+   OffloadQueue * const pOffloadQueue = pSubset->GetOffloadQueue();
+   if(nullptr == pOffloadQueue) {
+      error = QuantizeSlice(&slices, 0, 0, 0, cGroups);
+   } else {
+      // the slices share our stack variables, so we wait for them here. The ApplyUpdate of each slice runs in 
+      // chunks on its worker, and the slices do not depend on the number of workers, so neither does the model
+      error = pOffloadQueue->EnqueueHostSlices(&QuantizeSlice, &slices, cGroups, cSIMDPack,
+         nullptr == pData ? k_cItemsPerBitPackNone : pData->m_cPack);
+      if(Error_None == error) {
+         error = pOffloadQueue->Synchronize();
+      }
+   }
+   if(Error_None != error) {
+      return error;
+   }
+
+   double * const aMaxAbs = pSubset->m_aQuantizeScales + cTotalScores;
+   iWorker = 0;
+   do {
+      const double * const aWorkerMaxAbs = static_cast<const double *>(
+         IndexByte(m_aQuantizeScratch, m_iQuantizeWorkers + m_cBytesQuantizeWorker * iWorker + m_iQuantizeMaxAbs));
+      size_t iSlot = 0;
+      do {
+         aMaxAbs[iSlot] = MaxAbsKeepNaN(aMaxAbs[iSlot], aWorkerMaxAbs[iSlot]);
+         ++iSlot;
+      } while(cTotalScores != iSlot);
+      ++iWorker;
+   } while(m_cQuantizeWorkers != iWorker);
+
+   return Error_None;
+}
+
+ErrorEbm DataSetBoosting::QuantizeGradHess(
+   const bool bHessian,
+   const size_t cScores,
+   const size_t cBytesQuantized
+) {
+   LOG_0(Trace_Verbose, "Entered DataSetBoosting::QuantizeGradHess");
+
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(sizeof(int8_t) == cBytesQuantized || sizeof(int16_t) == cBytesQuantized);
+
+   if(size_t { 0 } == m_cSamples) {
+      return Error_None;
+   }
+
+   const size_t cTotalScores = bHessian ? cScores << 1 : cScores;
+
+   // the rounding noise only needs to be decorrelated between updates, and it is more useful for it to be
+   // reproducible than random, so derive it from the number of times we have quantized
+   RandomDeterministic rng;
+   rng.Initialize(m_cQuantizations);
+   ++m_cQuantizations;
+
+   DataSubsetBoosting * pSubset = m_aSubsets;
+   const DataSubsetBoosting * const pSubsetsEnd = pSubset + m_cSubsets;
+   do {
+      EBM_ASSERT(nullptr != pSubset->m_aGradHess);
+      EBM_ASSERT(nullptr != pSubset->m_aGradHessQuantized);
+      EBM_ASSERT(nullptr != pSubset->m_aQuantizeScales);
+
+      double * const aQuantizeScales = pSubset->m_aQuantizeScales;
+
+      // the residuals already exist in full, so the first pass only measures them. This happens once at startup
+      for(size_t iSlot = 0; iSlot < cTotalScores; ++iSlot) {
+         aQuantizeScales[iSlot] = 0.0;
+         aQuantizeScales[cTotalScores + iSlot] = 0.0;
+      }
+      ErrorEbm error = QuantizeSubset(pSubset, nullptr, cTotalScores, cBytesQuantized, rng.Next<uint64_t>());
+      if(Error_None != error) {
+         return error;
+      }
+      SetExactQuantizeScales(cTotalScores, cBytesQuantized, aQuantizeScales);
+      error = QuantizeSubset(pSubset, nullptr, cTotalScores, cBytesQuantized, rng.Next<uint64_t>());
+      if(Error_None != error) {
+         return error;
+      }
+
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+
+   LOG_0(Trace_Verbose, "Exited DataSetBoosting::QuantizeGradHess");
+   return Error_None;
+}
+
+ErrorEbm DataSetBoosting::ApplyUpdateQuantized(
+   DataSubsetBoosting * const pSubset,
+   const ApplyUpdateBridge * const pData,
+   const size_t cBytesQuantized
+) {
+   LOG_0(Trace_Verbose, "Entered DataSetBoosting::ApplyUpdateQuantized");
+
+   EBM_ASSERT(nullptr != pSubset);
+   EBM_ASSERT(nullptr != pData);
+   EBM_ASSERT(sizeof(int8_t) == cBytesQuantized || sizeof(int16_t) == cBytesQuantized);
+
+   ErrorEbm error;
+
+   const size_t cScores = pData->m_cScores;
+   const size_t cTotalScores = EBM_FALSE != pData->m_bHessianNeeded ? cScores << 1 : cScores;
+   const double quantizeMax = GetQuantizeMax(cBytesQuantized);
+
+   // the rounding noise only needs to be decorrelated between updates, and it is more useful for it to be
+   // reproducible than random, so derive it from the number of times we have quantized
+   RandomDeterministic rng;
+   rng.Initialize(m_cQuantizations);
+   ++m_cQuantizations;
+
+   // The values are quantized as soon as they are calculated, so the scale needs to be chosen before we see
+   // them. The magnitudes of the gradients change slowly between updates, so the last update is a good guide
+   double * const aQuantizeScales = pSubset->m_aQuantizeScales;
+   double * const aMaxAbs = aQuantizeScales + cTotalScores;
+   size_t iSlot = 0;
+   do {
+      // NaN on the first update, which gives a scale that forces the recalculation below
+      aQuantizeScales[iSlot] = aMaxAbs[iSlot] * k_quantizeHeadroom / quantizeMax;
+      aMaxAbs[iSlot] = 0.0;
+      ++iSlot;
+   } while(cTotalScores != iSlot);
+
+   error = QuantizeSubset(pSubset, pData, cTotalScores, cBytesQuantized, rng.Next<uint64_t>());
+   if(Error_None != error) {
+      return error;
+   }
+
+   bool bRecalculate = false;
+   iSlot = 0;
+   do {
+      const double limit = aQuantizeScales[iSlot] * quantizeMax;
+      const double maxAbs = aMaxAbs[iSlot];
+      // written this way so that NaN values in either one recalculate
+      if(!(maxAbs <= limit) || maxAbs * 2.0 < limit) {
+         bRecalculate = true;
+      }
+      ++iSlot;
+   } while(cTotalScores != iSlot);
+
+   if(bRecalculate) {
+      SetExactQuantizeScales(cTotalScores, cBytesQuantized, aQuantizeScales);
+      if(nullptr != pSubset->m_aGradHess) {
+         // the RMSE residuals were kept, so only the quantization is redone
+         error = QuantizeSubset(pSubset, nullptr, cTotalScores, cBytesQuantized, rng.Next<uint64_t>());
+      } else {
+         // the sample scores were already updated, so a zero update calculates the same gradients again
+         ApplyUpdateBridge data = *pData;
+         data.m_cPack = k_cItemsPerBitPackNone;
+         data.m_aPacked = nullptr;
+         data.m_aUpdateTensorScores = IndexByte(m_aQuantizeScratch, 0);
+         error = QuantizeSubset(pSubset, &data, cTotalScores, cBytesQuantized, rng.Next<uint64_t>());
+      }
+      if(Error_None != error) {
+         return error;
+      }
+   }
+
+   LOG_0(Trace_Verbose, "Exited DataSetBoosting::ApplyUpdateQuantized");
+   return Error_None;
+}
+
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
 WARNING_DISABLE_UNINITIALIZED_LOCAL_POINTER
 ErrorEbm DataSetBoosting::InitSampleScores(
    const size_t cScores,
    const BagEbm direction,
-   const BagEbm * const aBag,
+   const OuterBag & bag,
    const double * const aInitScores
 ) {
    LOG_0(Trace_Info, "Entered DataSetBoosting::InitSampleScores");
 
    EBM_ASSERT(1 <= cScores);
    EBM_ASSERT(BagEbm { -1 } == direction || BagEbm { 1 } == direction);
-   EBM_ASSERT(nullptr != aBag || BagEbm { 1 } == direction);  // if aBag is nullptr then we have no validation samples
+   EBM_ASSERT(!bag.IsEmpty() || BagEbm { 1 } == direction);  // if bag is empty then we have no validation samples
 
    DataSubsetBoosting * pSubset = m_aSubsets;
    EBM_ASSERT(nullptr != pSubset);
@@ -124,7 +882,7 @@ ErrorEbm DataSetBoosting::InitSampleScores(
          }
          const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cScores * cSubsetSamples;
          ANALYSIS_ASSERT(0 != cBytes);
-         void * pSampleScore = AlignedAlloc(cBytes);
+         void * pSampleScore = AllocateResident(pSubset, cBytes);
          if(nullptr == pSampleScore) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSampleScores nullptr == pSampleScore");
             return Error_OutOfMemory;
@@ -136,11 +894,10 @@ ErrorEbm DataSetBoosting::InitSampleScores(
          ++pSubset;
       } while(pSubsetsEnd != pSubset);
    } else {
-      const BagEbm * pSampleReplication = aBag;
+      OuterBagWalker walker(bag, direction);
       const double * pInitScore;
-      const double * pFromEnd = aInitScores;
-      const bool isLoopValidation = direction < BagEbm { 0 };
-      BagEbm replication = 0;
+      const double * pFromEnd;
+      size_t cReplication = 0;
       do {
          const size_t cSubsetSamples = pSubset->m_cSamples;
          EBM_ASSERT(1 <= cSubsetSamples);
@@ -155,7 +912,7 @@ ErrorEbm DataSetBoosting::InitSampleScores(
          }
          const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cScores * cSubsetSamples;
          ANALYSIS_ASSERT(0 != cBytes);
-         void * pSampleScore = AlignedAlloc(cBytes);
+         void * pSampleScore = AllocateResident(pSubset, cBytes);
          if(nullptr == pSampleScore) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSampleScores nullptr == pSampleScore");
             return Error_OutOfMemory;
@@ -166,21 +923,9 @@ ErrorEbm DataSetBoosting::InitSampleScores(
          do {
             size_t iPartition = 0;
             do {
-               if(BagEbm { 0 } == replication) {
-                  pInitScore = pFromEnd;
-                  replication = 1;
-                  if(nullptr != pSampleReplication) {
-                     bool isItemValidation;
-                     do {
-                        do {
-                           replication = *pSampleReplication;
-                           ++pSampleReplication;
-                        } while(BagEbm { 0 } == replication);
-                        isItemValidation = replication < BagEbm { 0 };
-                        pInitScore += cScores;
-                     } while(isLoopValidation != isItemValidation);
-                     pInitScore -= cScores;
-                  }
+               if(size_t { 0 } == cReplication) {
+                  cReplication = walker.Next();
+                  pInitScore = &aInitScores[walker.GetIncluded() * cScores];
                   pFromEnd = &pInitScore[cScores];
                }
 
@@ -198,7 +943,7 @@ ErrorEbm DataSetBoosting::InitSampleScores(
                   ++pFrom;
                } while(pFromEnd != pFrom);
 
-               replication -= direction;
+               --cReplication;
 
                ++iPartition;
             } while(cSIMDPack != iPartition);
@@ -207,20 +952,103 @@ ErrorEbm DataSetBoosting::InitSampleScores(
 
          ++pSubset;
       } while(pSubsetsEnd != pSubset);
-      EBM_ASSERT(0 == replication);
+      EBM_ASSERT(0 == cReplication);
    }
    LOG_0(Trace_Info, "Exited DataSetBoosting::InitSampleScores");
    return Error_None;
 }
 WARNING_POP
 
+void DataSetBoosting::ExportSampleScores(
+   const size_t cScores,
+   const BagEbm direction,
+   const OuterBag & bag,
+   const FloatShared * const aTargets,
+   double * const aSampleScoresOut
+) const {
+   LOG_0(Trace_Info, "Entered DataSetBoosting::ExportSampleScores");
+
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(BagEbm { -1 } == direction || BagEbm { 1 } == direction);
+   EBM_ASSERT(!bag.IsEmpty() || BagEbm { 1 } == direction);
+   EBM_ASSERT(nullptr != aSampleScoresOut);
+   EBM_ASSERT(1 <= m_cSubsets);
+
+   const DataSubsetBoosting * pSubset = m_aSubsets;
+   EBM_ASSERT(nullptr != pSubset);
+   const DataSubsetBoosting * const pSubsetsEnd = pSubset + m_cSubsets;
+
+   // RMSE keeps only the residuals (see InitializeRmseGradientsAndHessiansBoosting), so there we add the targets back
+   EBM_ASSERT(nullptr == pSubset->m_aSampleScores || nullptr == aTargets);
+   EBM_ASSERT(nullptr != pSubset->m_aSampleScores || nullptr != aTargets && size_t { 1 } == cScores);
+
+   // this walks the bag exactly like InitSampleScores. Replicated samples were expanded into consecutive copies
+   // that all hold the same score, so writing each copy over the same row is harmless
+   OuterBagWalker walker(bag, direction);
+   double * pScoresOut;
+   double * pToEnd;
+   size_t cReplication = 0;
+   do {
+      const size_t cSubsetSamples = pSubset->m_cSamples;
+      EBM_ASSERT(1 <= cSubsetSamples);
+
+      const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+      EBM_ASSERT(1 <= cSIMDPack);
+      EBM_ASSERT(0 == cSubsetSamples % cSIMDPack);
+
+      const size_t cFloatBytes = pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+      const void * pSampleScore = nullptr == aTargets ? pSubset->m_aSampleScores : pSubset->m_aGradHess;
+      EBM_ASSERT(nullptr != pSampleScore);
+      const void * const pSampleScoresEnd = IndexByte(pSampleScore, cFloatBytes * cScores * cSubsetSamples);
+
+      do {
+         size_t iPartition = 0;
+         do {
+            if(size_t { 0 } == cReplication) {
+               cReplication = walker.Next();
+               pScoresOut = &aSampleScoresOut[walker.GetIncluded() * cScores];
+               pToEnd = &pScoresOut[cScores];
+            }
+
+            double * pTo = pScoresOut;
+            size_t iScore = 0;
+            do {
+               if(sizeof(FloatBig) == cFloatBytes) {
+                  *pTo = static_cast<double>(reinterpret_cast<const FloatBig *>(pSampleScore)[iScore * cSIMDPack + iPartition]);
+               } else {
+                  EBM_ASSERT(sizeof(FloatSmall) == cFloatBytes);
+                  *pTo = static_cast<double>(reinterpret_cast<const FloatSmall *>(pSampleScore)[iScore * cSIMDPack + iPartition]);
+               }
+               if(nullptr != aTargets) {
+                  // the residual is the score minus the target
+                  *pTo += static_cast<double>(aTargets[walker.GetSample()]);
+               }
+
+               ++iScore;
+               ++pTo;
+            } while(pToEnd != pTo);
+
+            --cReplication;
+
+            ++iPartition;
+         } while(cSIMDPack != iPartition);
+         pSampleScore = IndexByte(pSampleScore, cScores * cFloatBytes * cSIMDPack);
+      } while(pSampleScoresEnd != pSampleScore);
+
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+   EBM_ASSERT(0 == cReplication);
+
+   LOG_0(Trace_Info, "Exited DataSetBoosting::ExportSampleScores");
+}
+
 
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
 ErrorEbm DataSetBoosting::InitTargetData(
    const unsigned char * const pDataSetShared,
    const BagEbm direction,
-   const BagEbm * const aBag
+   const OuterBag & bag
 ) {
    LOG_0(Trace_Info, "Entered DataSetBoosting::InitTargetData");
 
@@ -236,13 +1064,10 @@ ErrorEbm DataSetBoosting::InitTargetData(
    DataSubsetBoosting * pSubset = m_aSubsets;
    const DataSubsetBoosting * const pSubsetsEnd = pSubset + m_cSubsets;
 
-   const BagEbm * pSampleReplication = aBag;
-   const bool isLoopValidation = direction < BagEbm { 0 };
-   EBM_ASSERT(nullptr != aBag || !isLoopValidation); // if aBag is nullptr then we have no validation samples
-
-   BagEbm replication = 0;
+   OuterBagWalker walker(bag, direction);
+   size_t cReplication = 0;
    if(ptrdiff_t { Task_GeneralClassification } <= cClasses) {
-      const UIntShared * pTargetFrom = static_cast<const UIntShared *>(aTargets);
+      const UIntShared * const aTargetsFrom = static_cast<const UIntShared *>(aTargets);
       UIntShared iData;
       do {
          const size_t cSubsetSamples = pSubset->m_cSamples;
@@ -253,30 +1078,18 @@ ErrorEbm DataSetBoosting::InitTargetData(
             return Error_OutOfMemory;
          }
          const size_t cBytes = pSubset->m_pObjective->m_cUIntBytes * cSubsetSamples;
-         void * pTargetTo = AlignedAlloc(cBytes);
+         void * pTargetTo = AllocatePlaced(pSubset, cBytes);
          if(nullptr == pTargetTo) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTargetData nullptr == pTargetTo");
             return Error_OutOfMemory;
          }
          pSubset->m_aTargetData = pTargetTo;
+         pSubset->m_cTargetBytes = pSubset->m_pObjective->m_cUIntBytes;
          const void * const pTargetToEnd = IndexByte(pTargetTo, cBytes);
          do {
-            if(BagEbm { 0 } == replication) {
-               replication = 1;
-               if(nullptr != pSampleReplication) {
-                  bool isItemValidation;
-                  do {
-                     do {
-                        replication = *pSampleReplication;
-                        ++pSampleReplication;
-                        ++pTargetFrom;
-                     } while(BagEbm { 0 } == replication);
-                     isItemValidation = replication < BagEbm { 0 };
-                  } while(isLoopValidation != isItemValidation);
-                  --pTargetFrom;
-               }
-               iData = *pTargetFrom;
-               ++pTargetFrom;
+            if(size_t { 0 } == cReplication) {
+               cReplication = walker.Next();
+               iData = aTargetsFrom[walker.GetSample()];
 
 #ifndef NDEBUG
                // this was checked when creating the shared dataset
@@ -300,13 +1113,13 @@ ErrorEbm DataSetBoosting::InitTargetData(
             }
             pTargetTo = IndexByte(pTargetTo, pSubset->m_pObjective->m_cUIntBytes);
 
-            replication -= direction;
+            --cReplication;
          } while(pTargetToEnd != pTargetTo);
          
          ++pSubset;
       } while(pSubsetsEnd != pSubset);
    } else {
-      const FloatShared * pTargetFrom = static_cast<const FloatShared *>(aTargets);
+      const FloatShared * const aTargetsFrom = static_cast<const FloatShared *>(aTargets);
       FloatShared data;
       do {
          const size_t cSubsetSamples = pSubset->m_cSamples;
@@ -317,30 +1130,18 @@ ErrorEbm DataSetBoosting::InitTargetData(
             return Error_OutOfMemory;
          }
          const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cSubsetSamples;
-         void * pTargetTo = AlignedAlloc(cBytes);
+         void * pTargetTo = AllocatePlaced(pSubset, cBytes);
          if(nullptr == pTargetTo) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTargetData nullptr == pTargetTo");
             return Error_OutOfMemory;
          }
          pSubset->m_aTargetData = pTargetTo;
+         pSubset->m_cTargetBytes = pSubset->m_pObjective->m_cFloatBytes;
          const void * const pTargetToEnd = IndexByte(pTargetTo, cBytes);
          do {
-            if(BagEbm { 0 } == replication) {
-               replication = 1;
-               if(nullptr != pSampleReplication) {
-                  bool isItemValidation;
-                  do {
-                     do {
-                        replication = *pSampleReplication;
-                        ++pSampleReplication;
-                        ++pTargetFrom;
-                     } while(BagEbm { 0 } == replication);
-                     isItemValidation = replication < BagEbm { 0 };
-                  } while(isLoopValidation != isItemValidation);
-                  --pTargetFrom;
-               }
-               data = *pTargetFrom;
-               ++pTargetFrom;
+            if(size_t { 0 } == cReplication) {
+               cReplication = walker.Next();
+               data = aTargetsFrom[walker.GetSample()];
             }
             if(sizeof(FloatBig) == pSubset->m_pObjective->m_cFloatBytes) {
                *reinterpret_cast<FloatBig *>(pTargetTo) = static_cast<FloatBig>(data);
@@ -350,13 +1151,13 @@ ErrorEbm DataSetBoosting::InitTargetData(
             }
             pTargetTo = IndexByte(pTargetTo, pSubset->m_pObjective->m_cFloatBytes);
 
-            replication -= direction;
+            --cReplication;
          } while(pTargetToEnd != pTargetTo);
 
          ++pSubset;
       } while(pSubsetsEnd != pSubset);
    }
-   EBM_ASSERT(0 == replication);
+   EBM_ASSERT(0 == cReplication);
    LOG_0(Trace_Info, "Exited DataSetBoosting::InitTargetData");
    return Error_None;
 }
@@ -380,30 +1181,288 @@ static_assert(std::is_standard_layout<FeatureDimension>::value,
 static_assert(std::is_trivial<FeatureDimension>::value,
    "We use memcpy in several places, so disallow non-trivial types in general");
 
+static void InitFeatureDimension(
+   const unsigned char * const pDataSetShared,
+   const size_t iFeature,
+   const size_t cBins,
+   const size_t cSharedSamples,
+   FeatureDimension * const pDimensionInfo
+) {
+   bool bMissing;
+   bool bUnknown;
+   bool bNominal;
+   bool bSparse;
+   UIntShared cBinsUnused;
+   UIntShared defaultValSparse;
+   size_t cNonDefaultsSparse;
+   const void * pFeatureDataFrom = GetDataSetSharedFeature(
+      pDataSetShared,
+      iFeature,
+      &bMissing,
+      &bUnknown,
+      &bNominal,
+      &bSparse,
+      &cBinsUnused,
+      &defaultValSparse,
+      &cNonDefaultsSparse
+   );
+   EBM_ASSERT(nullptr != pFeatureDataFrom);
+   EBM_ASSERT(!bSparse); // we don't support sparse yet
+
+   EBM_ASSERT(!IsConvertError<size_t>(cBinsUnused)); // since we previously extracted cBins and checked
+   EBM_ASSERT(static_cast<size_t>(cBinsUnused) == cBins);
+
+   pDimensionInfo->m_pFeatureDataFrom = static_cast<const UIntShared *>(pFeatureDataFrom);
+   pDimensionInfo->m_cBins = cBins;
+
+   const int cBitsRequiredMin = CountBitsRequired(cBins - size_t { 1 });
+   EBM_ASSERT(1 <= cBitsRequiredMin);
+   EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(UIntShared)); // comes from shared data set
+   EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(size_t)); // since cBins fits into size_t (previous call to GetDataSetSharedFeature)
+
+   const int cItemsPerBitPackFrom = GetCountItemsBitPacked<UIntShared>(cBitsRequiredMin);
+   EBM_ASSERT(1 <= cItemsPerBitPackFrom);
+   EBM_ASSERT(cItemsPerBitPackFrom <= COUNT_BITS(UIntShared));
+
+   const int cBitsPerItemMaxFrom = GetCountBits<UIntShared>(cItemsPerBitPackFrom);
+   EBM_ASSERT(1 <= cBitsPerItemMaxFrom);
+   EBM_ASSERT(cBitsPerItemMaxFrom <= COUNT_BITS(UIntShared));
+
+   // we can only guarantee that cBitsPerItemMaxFrom is less than or equal to COUNT_BITS(UIntShared)
+   // so we need to construct our mask in that type, but afterwards we can convert it to a 
+   // size_t since we know the ultimate answer must fit into that since cBins fits into a size_t. If in theory 
+   // UIntShared were allowed to be a billion bits, then the mask could be 65 bits while the end
+   // result would be forced to be 64 bits or less since we use the maximum number of bits per item possible
+   const size_t maskBitsFrom = static_cast<size_t>(MakeLowMask<UIntShared>(cBitsPerItemMaxFrom));
+
+   pDimensionInfo->m_cItemsPerBitPackFrom = cItemsPerBitPackFrom;
+   pDimensionInfo->m_cBitsPerItemMaxFrom = cBitsPerItemMaxFrom;
+   pDimensionInfo->m_maskBitsFrom = maskBitsFrom;
+   pDimensionInfo->m_iShiftFrom = static_cast<int>((cSharedSamples - size_t { 1 }) % static_cast<size_t>(cItemsPerBitPackFrom));
+}
+
+static size_t GetCountTermDataBytes(const DataSubsetBoosting * const pSubset, const int cBitsRequiredMin) {
+   // returns 0 on overflow
+   const int cItemsPerBitPackTo =
+      GetCountItemsBitPacked(cBitsRequiredMin, pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+   EBM_ASSERT(1 <= cItemsPerBitPackTo);
+   ANALYSIS_ASSERT(0 != cItemsPerBitPackTo);
+
+   const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+   EBM_ASSERT(1 <= cSIMDPack);
+
+   const size_t cSubsetSamples = pSubset->GetCountSamples();
+   EBM_ASSERT(1 <= cSubsetSamples);
+   EBM_ASSERT(0 == cSubsetSamples % cSIMDPack);
+
+   const size_t cParallelSamples = cSubsetSamples / cSIMDPack;
+   EBM_ASSERT(1 <= cParallelSamples);
+
+   // this can't overflow or underflow
+   const size_t cParallelDataUnitsTo = (cParallelSamples - size_t { 1 }) / static_cast<size_t>(cItemsPerBitPackTo) + size_t { 1 };
+   const size_t cDataUnitsTo = cParallelDataUnitsTo * cSIMDPack;
+
+   if(IsMultiplyError(pSubset->GetObjectiveWrapper()->m_cUIntBytes, cDataUnitsTo)) {
+      return 0;
+   }
+   return pSubset->GetObjectiveWrapper()->m_cUIntBytes * cDataUnitsTo;
+}
+
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
+ErrorEbm DataSetBoosting::PackTermData(
+   const BagEbm direction,
+   const OuterBag & bag,
+   const int cBitsRequiredMin,
+   const size_t cTensorBins,
+   const size_t cRealDimensions,
+   FeatureDimension * const aDimensionInfo,
+   const bool bFeature,
+   const size_t iData
+) {
+   UNUSED(cTensorBins); // only used in asserts
+
+   EBM_ASSERT(1 <= cBitsRequiredMin);
+   EBM_ASSERT(1 <= cRealDimensions);
+   EBM_ASSERT(nullptr != aDimensionInfo);
+
+   const FeatureDimension * const pDimensionInfoInit = &aDimensionInfo[cRealDimensions];
+
+   const DataSubsetBoosting * const pSubsetsEnd = m_aSubsets + m_cSubsets;
+
+   OuterBagWalker walker(bag, direction);
+   size_t iSampleNext = 0;
+   size_t cReplication = 0;
+   size_t iTensor;
+
+   DataSubsetBoosting * pSubset = m_aSubsets;
+   do {
+      const int cItemsPerBitPackTo =
+         GetCountItemsBitPacked(cBitsRequiredMin, pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+      EBM_ASSERT(1 <= cItemsPerBitPackTo);
+      ANALYSIS_ASSERT(0 != cItemsPerBitPackTo);
+
+      const int cBitsPerItemMaxTo = GetCountBits(cItemsPerBitPackTo, pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+      EBM_ASSERT(1 <= cBitsPerItemMaxTo);
+
+      const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+      EBM_ASSERT(1 <= cSIMDPack);
+
+      const size_t cParallelSamples = pSubset->GetCountSamples() / cSIMDPack;
+      EBM_ASSERT(1 <= cParallelSamples);
+
+      const size_t cBytes = GetCountTermDataBytes(pSubset, cBitsRequiredMin);
+      if(size_t { 0 } == cBytes) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::PackTermData IsMultiplyError(pSubset->GetObjectiveWrapper()->m_cUIntBytes, cDataUnitsTo)");
+         return Error_OutOfMemory;
+      }
+      void * pTermDataTo = AllocatePlaced(pSubset, cBytes);
+      if(nullptr == pTermDataTo) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::PackTermData nullptr == pTermDataTo");
+         return Error_OutOfMemory;
+      }
+      if(bFeature) {
+         pSubset->m_aaFeatureData[iData] = pTermDataTo;
+      } else {
+         pSubset->m_aaTermData[iData] = pTermDataTo;
+      }
+      const void * const pTermDataToEnd = IndexByte(pTermDataTo, cBytes);
+
+      memset(pTermDataTo, 0, cBytes);
+
+      int cShiftTo = static_cast<int>((cParallelSamples - size_t { 1 }) % static_cast<size_t>(cItemsPerBitPackTo)) * cBitsPerItemMaxTo;
+      const int cShiftResetTo = (cItemsPerBitPackTo - 1) * cBitsPerItemMaxTo;
+      do {
+         do {
+            size_t iPartition = 0;
+            do {
+               if(size_t { 0 } == cReplication) {
+                  cReplication = walker.Next();
+                  const size_t iSample = walker.GetSample();
+                  EBM_ASSERT(iSampleNext <= iSample);
+                  const size_t cAdvances = iSample - iSampleNext;
+                  iSampleNext = iSample + size_t { 1 };
+                  if(0 != cAdvances) {
+                     FeatureDimension * pDimensionInfo = aDimensionInfo;
+                     do {
+                        const int cItemsPerBitPackFrom = pDimensionInfo->m_cItemsPerBitPackFrom;
+                        size_t cCompleteAdvanced = cAdvances / static_cast<size_t>(cItemsPerBitPackFrom);
+                        int iShiftFrom = pDimensionInfo->m_iShiftFrom;
+                        EBM_ASSERT(0 <= iShiftFrom);
+                        iShiftFrom -= static_cast<int>(cAdvances % static_cast<size_t>(cItemsPerBitPackFrom));
+                        pDimensionInfo->m_iShiftFrom = iShiftFrom;
+                        if(iShiftFrom < 0) {
+                           pDimensionInfo->m_iShiftFrom = iShiftFrom + cItemsPerBitPackFrom;
+                           EBM_ASSERT(0 <= pDimensionInfo->m_iShiftFrom);
+                           ++cCompleteAdvanced;
+                        }
+                        pDimensionInfo->m_pFeatureDataFrom += cCompleteAdvanced;
+
+                        ++pDimensionInfo;
+                     } while(pDimensionInfoInit != pDimensionInfo);
+                  }
+
+                  iTensor = 0;
+                  size_t tensorMultiple = 1;
+                  FeatureDimension * pDimensionInfo = aDimensionInfo;
+                  do {
+                     const UIntShared * const pFeatureDataFrom = pDimensionInfo->m_pFeatureDataFrom;
+                     const UIntShared bitsFrom = *pFeatureDataFrom;
+
+                     int iShiftFrom = pDimensionInfo->m_iShiftFrom;
+                     EBM_ASSERT(0 <= iShiftFrom);
+                     EBM_ASSERT(iShiftFrom * pDimensionInfo->m_cBitsPerItemMaxFrom < COUNT_BITS(UIntShared));
+                     const size_t iFeatureBin = static_cast<size_t>(bitsFrom >>
+                        (iShiftFrom * pDimensionInfo->m_cBitsPerItemMaxFrom)) &
+                        pDimensionInfo->m_maskBitsFrom;
+
+                     // we check our dataSet when we get the header, and cBins has been checked to fit into size_t
+                     EBM_ASSERT(iFeatureBin < pDimensionInfo->m_cBins);
+
+                     --iShiftFrom;
+                     pDimensionInfo->m_iShiftFrom = iShiftFrom;
+                     if(iShiftFrom < 0) {
+                        EBM_ASSERT(-1 == iShiftFrom);
+                        pDimensionInfo->m_iShiftFrom = iShiftFrom + pDimensionInfo->m_cItemsPerBitPackFrom;
+                        pDimensionInfo->m_pFeatureDataFrom = pFeatureDataFrom + 1;
+                     }
+
+                     // we check for overflows during Term construction, but let's check here again
+                     EBM_ASSERT(!IsMultiplyError(tensorMultiple, pDimensionInfo->m_cBins));
+
+                     // this can't overflow if the multiplication below doesn't overflow, and we checked for that above
+                     iTensor += tensorMultiple * iFeatureBin;
+                     tensorMultiple *= pDimensionInfo->m_cBins;
+
+                     ++pDimensionInfo;
+                  } while(pDimensionInfoInit != pDimensionInfo);
+
+                  EBM_ASSERT(iTensor < cTensorBins);
+               }
+
+               EBM_ASSERT(size_t { 0 } != cReplication);
+               --cReplication;
+
+               EBM_ASSERT(0 <= cShiftTo);
+               if(sizeof(UIntBig) == pSubset->m_pObjective->m_cUIntBytes) {
+                  *(reinterpret_cast<UIntBig *>(pTermDataTo) + iPartition) |= static_cast<UIntBig>(iTensor) << cShiftTo;
+               } else {
+                  EBM_ASSERT(sizeof(UIntSmall) == pSubset->m_pObjective->m_cUIntBytes);
+                  *(reinterpret_cast<UIntSmall *>(pTermDataTo) + iPartition) |= static_cast<UIntSmall>(iTensor) << cShiftTo;
+               }
+
+               ++iPartition;
+            } while(cSIMDPack != iPartition);
+            cShiftTo -= cBitsPerItemMaxTo;
+         } while(0 <= cShiftTo);
+         cShiftTo = cShiftResetTo;
+
+         pTermDataTo = IndexByte(pTermDataTo, pSubset->m_pObjective->m_cUIntBytes * cSIMDPack);
+      } while(pTermDataToEnd != pTermDataTo);
+
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+   EBM_ASSERT(0 == cReplication);
+
+   return Error_None;
+}
+WARNING_POP
+
 ErrorEbm DataSetBoosting::InitTermData(
    const unsigned char * const pDataSetShared,
    const BagEbm direction,
    const size_t cSharedSamples,
-   const BagEbm * const aBag,
+   const OuterBag & bag,
+   const bool bFeatureStorage,
+   const size_t cFeatures,
+   const size_t iFeatureFirst,
+   const size_t iTermFirst,
    const size_t cTerms,
    const Term * const * const apTerms,
    const IntEbm * const aiTermFeatures
 ) {
+   // apTerms holds the cTerms terms starting at iTermFirst, and aiTermFeatures indexes the features of 
+   // pDataSetShared, which start at feature iFeatureFirst of the BoosterCore
    LOG_0(Trace_Info, "Entered DataSetBoosting::InitTermData");
 
+   UNUSED(cFeatures); // only used in asserts
+   UNUSED(iFeatureFirst); // only used in asserts
+
+   ErrorEbm error;
+
    EBM_ASSERT(nullptr != pDataSetShared);
    EBM_ASSERT(BagEbm { -1 } == direction || BagEbm { 1 } == direction);
    EBM_ASSERT(1 <= cSharedSamples);
    EBM_ASSERT(1 <= cTerms);
    EBM_ASSERT(nullptr != apTerms);
+   // the per-feature data and the combined term slots are only sized when the dataset is created
+   EBM_ASSERT(!bFeatureStorage || size_t { 0 } == iFeatureFirst && size_t { 0 } == iTermFirst);
 
    EBM_ASSERT(nullptr != m_aSubsets);
    EBM_ASSERT(1 <= m_cSubsets);
    const DataSubsetBoosting * const pSubsetsEnd = m_aSubsets + m_cSubsets;
 
-   const bool isLoopValidation = direction < BagEbm { 0 };
+   int cBitsCombinedMax = 0;
    const IntEbm * piTermFeature = aiTermFeatures;
    size_t iTerm = 0;
    do {
@@ -422,6 +1481,7 @@ ErrorEbm DataSetBoosting::InitTermData(
 
          FeatureDimension dimensionInfo[k_cDimensionsMax];
          FeatureDimension * pDimensionInfoInit = dimensionInfo;
+         size_t iFeatureReal = 0;
          do {
             const FeatureBoosting * const pFeature = pTermFeature->m_pFeature;
             const size_t cBins = pFeature->GetCountBins();
@@ -430,221 +1490,313 @@ ErrorEbm DataSetBoosting::InitTermData(
                const IntEbm indexFeature = *piTermFeature;
                EBM_ASSERT(!IsConvertError<size_t>(indexFeature)); // we converted it previously
                const size_t iFeature = static_cast<size_t>(indexFeature);
-
-               bool bMissing;
-               bool bUnknown;
-               bool bNominal;
-               bool bSparse;
-               UIntShared cBinsUnused;
-               UIntShared defaultValSparse;
-               size_t cNonDefaultsSparse;
-               const void * pFeatureDataFrom = GetDataSetSharedFeature(
-                  pDataSetShared,
-                  iFeature,
-                  &bMissing,
-                  &bUnknown,
-                  &bNominal,
-                  &bSparse,
-                  &cBinsUnused,
-                  &defaultValSparse,
-                  &cNonDefaultsSparse
-               );
-               EBM_ASSERT(nullptr != pFeatureDataFrom);
-               EBM_ASSERT(!bSparse); // we don't support sparse yet
-
-               EBM_ASSERT(!IsConvertError<size_t>(cBinsUnused)); // since we previously extracted cBins and checked
-               EBM_ASSERT(static_cast<size_t>(cBinsUnused) == cBins);
-
-               pDimensionInfoInit->m_pFeatureDataFrom = static_cast<const UIntShared *>(pFeatureDataFrom);
-               pDimensionInfoInit->m_cBins = cBins;
-
-               const int cBitsRequiredMin = CountBitsRequired(cBins - size_t { 1 });
-               EBM_ASSERT(1 <= cBitsRequiredMin);
-               EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(UIntShared)); // comes from shared data set
-               EBM_ASSERT(cBitsRequiredMin <= COUNT_BITS(size_t)); // since cBins fits into size_t (previous call to GetDataSetSharedFeature)
-
-               const int cItemsPerBitPackFrom = GetCountItemsBitPacked<UIntShared>(cBitsRequiredMin);
-               EBM_ASSERT(1 <= cItemsPerBitPackFrom);
-               EBM_ASSERT(cItemsPerBitPackFrom <= COUNT_BITS(UIntShared));
-
-               const int cBitsPerItemMaxFrom = GetCountBits<UIntShared>(cItemsPerBitPackFrom);
-               EBM_ASSERT(1 <= cBitsPerItemMaxFrom);
-               EBM_ASSERT(cBitsPerItemMaxFrom <= COUNT_BITS(UIntShared));
-
-               // we can only guarantee that cBitsPerItemMaxFrom is less than or equal to COUNT_BITS(UIntShared)
-               // so we need to construct our mask in that type, but afterwards we can convert it to a 
-               // size_t since we know the ultimate answer must fit into that since cBins fits into a size_t. If in theory 
-               // UIntShared were allowed to be a billion bits, then the mask could be 65 bits while the end
-               // result would be forced to be 64 bits or less since we use the maximum number of bits per item possible
-               const size_t maskBitsFrom = static_cast<size_t>(MakeLowMask<UIntShared>(cBitsPerItemMaxFrom));
-
-               pDimensionInfoInit->m_cItemsPerBitPackFrom = cItemsPerBitPackFrom;
-               pDimensionInfoInit->m_cBitsPerItemMaxFrom = cBitsPerItemMaxFrom;
-               pDimensionInfoInit->m_maskBitsFrom = maskBitsFrom;
-               pDimensionInfoInit->m_iShiftFrom = static_cast<int>((cSharedSamples - size_t { 1 }) % static_cast<size_t>(cItemsPerBitPackFrom));
-
-               ++pDimensionInfoInit;
+               EBM_ASSERT(iFeatureFirst + iFeature == pTermFeature->m_iFeature);
+
+               if(bFeatureStorage) {
+                  EBM_ASSERT(iFeature < cFeatures);
+                  // each feature is packed once no matter how many terms include it
+                  if(nullptr == m_aSubsets->m_aaFeatureData[iFeature]) {
+                     FeatureDimension featureInfo;
+                     InitFeatureDimension(pDataSetShared, iFeature, cBins, cSharedSamples, &featureInfo);
+                     error = PackTermData(
+                        direction,
+                        bag,
+                        CountBitsRequired(cBins - size_t { 1 }),
+                        cBins,
+                        1,
+                        &featureInfo,
+                        true,
+                        iFeature
+                     );
+                     if(Error_None != error) {
+                        return error;
+                     }
+                  }
+                  iFeatureReal = iFeature;
+               } else {
+                  InitFeatureDimension(pDataSetShared, iFeature, cBins, cSharedSamples, pDimensionInfoInit);
+                  ++pDimensionInfoInit;
+               }
             }
             ++piTermFeature;
             ++pTermFeature;
          } while(pTermFeaturesEnd != pTermFeature);
-         EBM_ASSERT(pDimensionInfoInit == &dimensionInfo[pTerm->GetCountRealDimensions()]);
 
-         EBM_ASSERT(nullptr != aBag || !isLoopValidation); // if aBag is nullptr then we have no validation samples
-         const BagEbm * pSampleReplication = aBag;
-         BagEbm replication = 0;
-         size_t iTensor;
+         if(bFeatureStorage) {
+            if(size_t { 1 } == pTerm->GetCountRealDimensions()) {
+               // with only 1 real dimension the tensor index is the feature bin, so the feature data is the term data
+               EBM_ASSERT(CountBitsRequired(pTerm->GetCountTensorBins() - size_t { 1 }) == pTerm->GetBitsRequiredMin());
+               DataSubsetBoosting * pSubset = m_aSubsets;
+               do {
+                  pSubset->m_aaTermData[iTermFirst + iTerm] = pSubset->m_aaFeatureData[iFeatureReal];
+                  ++pSubset;
+               } while(pSubsetsEnd != pSubset);
+            } else {
+               cBitsCombinedMax = EbmMax(cBitsCombinedMax, pTerm->GetBitsRequiredMin());
+            }
+         } else {
+            EBM_ASSERT(pDimensionInfoInit == &dimensionInfo[pTerm->GetCountRealDimensions()]);
+            error = PackTermData(
+               direction,
+               bag,
+               pTerm->GetBitsRequiredMin(),
+               pTerm->GetCountTensorBins(),
+               pTerm->GetCountRealDimensions(),
+               dimensionInfo,
+               false,
+               iTermFirst + iTerm
+            );
+            if(Error_None != error) {
+               return error;
+            }
+         }
+      }
+      ++iTerm;
+   } while(cTerms != iTerm);
 
-         DataSubsetBoosting * pSubset = m_aSubsets;
-         do {
-            EBM_ASSERT(1 <= pTerm->GetBitsRequiredMin());
-            const int cItemsPerBitPackTo =
-               GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-            EBM_ASSERT(1 <= cItemsPerBitPackTo);
-            ANALYSIS_ASSERT(0 != cItemsPerBitPackTo);
+   if(0 != cBitsCombinedMax) {
+      // the combined terms are built on demand into these, and more bits means fewer items per packed word
+      DataSubsetBoosting * pSubset = m_aSubsets;
+      do {
+         const size_t cBytes = GetCountTermDataBytes(pSubset, cBitsCombinedMax);
+         if(size_t { 0 } == cBytes) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTermData IsMultiplyError(pSubset->GetObjectiveWrapper()->m_cUIntBytes, cDataUnitsTo)");
+            return Error_OutOfMemory;
+         }
+         for(size_t iSlot = 0; iSlot < DataSubsetBoosting::k_cCombinedTermSlots; ++iSlot) {
+            void * const aCombinedTermData = AlignedAlloc(cBytes);
+            if(nullptr == aCombinedTermData) {
+               LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTermData nullptr == aCombinedTermData");
+               return Error_OutOfMemory;
+            }
+            pSubset->m_aaCombinedTermData[iSlot] = aCombinedTermData;
+         }
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+   }
 
-            const int cBitsPerItemMaxTo = GetCountBits(cItemsPerBitPackTo, pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-            EBM_ASSERT(1 <= cBitsPerItemMaxTo);
+   LOG_0(Trace_Info, "Exited DataSetBoosting::InitTermData");
+   return Error_None;
+}
 
-            const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
-            EBM_ASSERT(1 <= cSIMDPack);
+ErrorEbm DataSetBoosting::GrowTermData(const size_t cTermsBefore, const size_t cTermsAfter) {
+   LOG_0(Trace_Info, "Entered DataSetBoosting::GrowTermData");
 
-            const size_t cSubsetSamples = pSubset->GetCountSamples();
-            EBM_ASSERT(1 <= cSubsetSamples);
-            EBM_ASSERT(0 == cSubsetSamples % cSIMDPack);
+   EBM_ASSERT(1 <= cTermsBefore);
+   EBM_ASSERT(cTermsBefore < cTermsAfter);
 
-            const size_t cParallelSamples = cSubsetSamples / cSIMDPack;
-            EBM_ASSERT(1 <= cParallelSamples);
+   if(size_t { 0 } != m_cSamples) {
+      EBM_ASSERT(nullptr != m_aSubsets);
+      EBM_ASSERT(1 <= m_cSubsets);
 
-            // this can't overflow or underflow
-            const size_t cParallelDataUnitsTo = (cParallelSamples - size_t { 1 }) / static_cast<size_t>(cItemsPerBitPackTo) + size_t { 1 };
-            const size_t cDataUnitsTo = cParallelDataUnitsTo * cSIMDPack;
+      if(IsMultiplyError(sizeof(void *), cTermsAfter)) {
+         LOG_0(Trace_Warning, "WARNING DataSetBoosting::GrowTermData IsMultiplyError(sizeof(void *), cTermsAfter)");
+         return Error_OutOfMemory;
+      }
 
-            if(IsMultiplyError(pSubset->GetObjectiveWrapper()->m_cUIntBytes, cDataUnitsTo)) {
-               LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTermData IsMultiplyError(pSubset->GetObjectiveWrapper()->m_cUIntBytes, cDataUnitsTo)");
-               return Error_OutOfMemory;
-            }
-            const size_t cBytes = pSubset->GetObjectiveWrapper()->m_cUIntBytes * cDataUnitsTo;
-            void * pTermDataTo = AlignedAlloc(cBytes);
-            if(nullptr == pTermDataTo) {
-               LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTermData nullptr == pTermDataTo");
-               return Error_OutOfMemory;
-            }
-            pSubset->m_aaTermData[iTerm] = pTermDataTo;
-            const void * const pTermDataToEnd = IndexByte(pTermDataTo, cBytes);
+      DataSubsetBoosting * pSubset = m_aSubsets;
+      const DataSubsetBoosting * const pSubsetsEnd = m_aSubsets + m_cSubsets;
+      do {
+         // per-feature storage keeps pointers into m_aaFeatureData that AddTermData does not know how to extend
+         EBM_ASSERT(nullptr == pSubset->m_aaFeatureData);
+         EBM_ASSERT(nullptr != pSubset->m_aaTermData);
+         void ** const paTermData = static_cast<void **>(realloc(pSubset->m_aaTermData, sizeof(void *) * cTermsAfter));
+         if(nullptr == paTermData) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::GrowTermData nullptr == paTermData");
+            return Error_OutOfMemory;
+         }
+         pSubset->m_aaTermData = paTermData;
 
-            memset(pTermDataTo, 0, cBytes);
+         for(size_t iTerm = cTermsBefore; iTerm < cTermsAfter; ++iTerm) {
+            paTermData[iTerm] = nullptr;
+         }
 
-            int cShiftTo = static_cast<int>((cParallelSamples - size_t { 1 }) % static_cast<size_t>(cItemsPerBitPackTo)) * cBitsPerItemMaxTo;
-            const int cShiftResetTo = (cItemsPerBitPackTo - 1) * cBitsPerItemMaxTo;
-            do {
-               do {
-                  size_t iPartition = 0;
-                  do {
-                     if(BagEbm { 0 } == replication) {
-                        replication = 1;
-                        if(nullptr != pSampleReplication) {
-                           const BagEbm * pSampleReplicationOriginal = pSampleReplication;
-                           bool isItemValidation;
-                           do {
-                              do {
-                                 replication = *pSampleReplication;
-                                 ++pSampleReplication;
-                              } while(BagEbm { 0 } == replication);
-                              isItemValidation = replication < BagEbm { 0 };
-                           } while(isLoopValidation != isItemValidation);
-                           const size_t cAdvances = pSampleReplication - pSampleReplicationOriginal - 1;
-                           if(0 != cAdvances) {
-                              FeatureDimension * pDimensionInfo = dimensionInfo;
-                              do {
-                                 const int cItemsPerBitPackFrom = pDimensionInfo->m_cItemsPerBitPackFrom;
-                                 size_t cCompleteAdvanced = cAdvances / static_cast<size_t>(cItemsPerBitPackFrom);
-                                 int iShiftFrom = pDimensionInfo->m_iShiftFrom;
-                                 EBM_ASSERT(0 <= iShiftFrom);
-                                 iShiftFrom -= static_cast<int>(cAdvances % static_cast<size_t>(cItemsPerBitPackFrom));
-                                 pDimensionInfo->m_iShiftFrom = iShiftFrom;
-                                 if(iShiftFrom < 0) {
-                                    pDimensionInfo->m_iShiftFrom = iShiftFrom + cItemsPerBitPackFrom;
-                                    EBM_ASSERT(0 <= pDimensionInfo->m_iShiftFrom);
-                                    ++cCompleteAdvanced;
-                                 }
-                                 pDimensionInfo->m_pFeatureDataFrom += cCompleteAdvanced;
-
-                                 ++pDimensionInfo;
-                              } while(pDimensionInfoInit != pDimensionInfo);
-                           }
-                        }
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+   }
 
-                        iTensor = 0;
-                        size_t tensorMultiple = 1;
-                        FeatureDimension * pDimensionInfo = dimensionInfo;
-                        do {
-                           const UIntShared * const pFeatureDataFrom = pDimensionInfo->m_pFeatureDataFrom;
-                           const UIntShared bitsFrom = *pFeatureDataFrom;
-
-                           int iShiftFrom = pDimensionInfo->m_iShiftFrom;
-                           EBM_ASSERT(0 <= iShiftFrom);
-                           EBM_ASSERT(iShiftFrom * pDimensionInfo->m_cBitsPerItemMaxFrom < COUNT_BITS(UIntShared));
-                           const size_t iFeatureBin = static_cast<size_t>(bitsFrom >>
-                              (iShiftFrom * pDimensionInfo->m_cBitsPerItemMaxFrom)) &
-                              pDimensionInfo->m_maskBitsFrom;
-
-                           // we check our dataSet when we get the header, and cBins has been checked to fit into size_t
-                           EBM_ASSERT(iFeatureBin < pDimensionInfo->m_cBins);
-
-                           --iShiftFrom;
-                           pDimensionInfo->m_iShiftFrom = iShiftFrom;
-                           if(iShiftFrom < 0) {
-                              EBM_ASSERT(-1 == iShiftFrom);
-                              pDimensionInfo->m_iShiftFrom = iShiftFrom + pDimensionInfo->m_cItemsPerBitPackFrom;
-                              pDimensionInfo->m_pFeatureDataFrom = pFeatureDataFrom + 1;
-                           }
-
-                           // we check for overflows during Term construction, but let's check here again
-                           EBM_ASSERT(!IsMultiplyError(tensorMultiple, pDimensionInfo->m_cBins));
-
-                           // this can't overflow if the multiplication below doesn't overflow, and we checked for that above
-                           iTensor += tensorMultiple * iFeatureBin;
-                           tensorMultiple *= pDimensionInfo->m_cBins;
-
-                           ++pDimensionInfo;
-                        } while(pDimensionInfoInit != pDimensionInfo);
-
-                        EBM_ASSERT(iTensor < pTerm->GetCountTensorBins());
-                     }
+   LOG_0(Trace_Info, "Exited DataSetBoosting::GrowTermData");
+   return Error_None;
+}
 
-                     EBM_ASSERT(0 != replication);
-                     EBM_ASSERT(0 < replication && 0 < direction || replication < 0 && direction < 0);
-                     replication -= direction;
+ErrorEbm DataSetBoosting::AddTermData(
+   const unsigned char * const pDataSetShared,
+   const BagEbm direction,
+   const size_t cSharedSamples,
+   const OuterBag & bag,
+   const size_t iFeatureFirst,
+   const size_t iTermFirst,
+   const size_t cTerms,
+   const Term * const * const apTerms,
+   const IntEbm * const aiTermFeatures
+) {
+   if(size_t { 0 } == m_cSamples) {
+      return Error_None;
+   }
+   return InitTermData(
+      pDataSetShared,
+      direction,
+      cSharedSamples,
+      bag,
+      false,
+      0,
+      iFeatureFirst,
+      iTermFirst,
+      cTerms,
+      apTerms,
+      aiTermFeatures
+   );
+}
 
-                     EBM_ASSERT(0 <= cShiftTo);
-                     if(sizeof(UIntBig) == pSubset->m_pObjective->m_cUIntBytes) {
-                        *(reinterpret_cast<UIntBig *>(pTermDataTo) + iPartition) |= static_cast<UIntBig>(iTensor) << cShiftTo;
-                     } else {
-                        EBM_ASSERT(sizeof(UIntSmall) == pSubset->m_pObjective->m_cUIntBytes);
-                        *(reinterpret_cast<UIntSmall *>(pTermDataTo) + iPartition) |= static_cast<UIntSmall>(iTensor) << cShiftTo;
-                     }
+template<typename TUInt>
+struct CombineStream final {
+   CombineStream() = default; // preserve our POD status
+   ~CombineStream() = default; // preserve our POD status
+   void * operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete (void *) = delete; // we only use malloc/free in this library
 
-                     ++iPartition;
-                  } while(cSIMDPack != iPartition);
-                  cShiftTo -= cBitsPerItemMaxTo;
-               } while(0 <= cShiftTo);
-               cShiftTo = cShiftResetTo;
+   const TUInt * m_pData;
+   size_t m_cTensorMultiple;
+   TUInt m_maskBits;
+   int m_cItemsPerBitPack;
+   int m_cBitsPerItemMax;
+   int m_iShift;
+};
 
-               pTermDataTo = IndexByte(pTermDataTo, pSubset->m_pObjective->m_cUIntBytes * cSIMDPack);
-            } while(pTermDataToEnd != pTermDataTo);
+template<typename TUInt>
+static void CombineStreams(
+   const size_t cSIMDPack,
+   const size_t cParallelSamples,
+   const size_t cStreams,
+   CombineStream<TUInt> * const aStreams,
+   const int cItemsPerBitPackTo,
+   void * const aTermDataTo
+) {
+   // the packed streams are all in the same sample order, so we walk them together and compute the tensor 
+   // index of each sample the same way PackTermData does from the shared dataset
+   const int cBitsPerItemMaxTo = GetCountBits<TUInt>(cItemsPerBitPackTo);
+   const size_t cDataUnitsTo = ((cParallelSamples - size_t { 1 }) / static_cast<size_t>(cItemsPerBitPackTo) + size_t { 1 }) * cSIMDPack;
 
-            ++pSubset;
-         } while(pSubsetsEnd != pSubset);
-         EBM_ASSERT(0 == replication);
+   TUInt * pTermDataTo = static_cast<TUInt *>(aTermDataTo);
+   const TUInt * const pTermDataToEnd = pTermDataTo + cDataUnitsTo;
+   memset(aTermDataTo, 0, sizeof(TUInt) * cDataUnitsTo);
+
+   const CombineStream<TUInt> * const pStreamsEnd = &aStreams[cStreams];
+
+   int iShiftTo = static_cast<int>((cParallelSamples - size_t { 1 }) % static_cast<size_t>(cItemsPerBitPackTo));
+   do {
+      do {
+         size_t iPartition = 0;
+         do {
+            size_t iTensor = 0;
+            const CombineStream<TUInt> * pStream = aStreams;
+            do {
+               const size_t iFeatureBin = static_cast<size_t>(
+                  (pStream->m_pData[iPartition] >> (pStream->m_iShift * pStream->m_cBitsPerItemMax)) & pStream->m_maskBits);
+               iTensor += pStream->m_cTensorMultiple * iFeatureBin;
+               ++pStream;
+            } while(pStreamsEnd != pStream);
+            pTermDataTo[iPartition] |= static_cast<TUInt>(iTensor) << (iShiftTo * cBitsPerItemMaxTo);
+            ++iPartition;
+         } while(cSIMDPack != iPartition);
+
+         CombineStream<TUInt> * pStreamAdvance = aStreams;
+         do {
+            --pStreamAdvance->m_iShift;
+            if(pStreamAdvance->m_iShift < 0) {
+               pStreamAdvance->m_iShift = pStreamAdvance->m_cItemsPerBitPack - 1;
+               pStreamAdvance->m_pData += cSIMDPack;
+            }
+            ++pStreamAdvance;
+         } while(pStreamsEnd != pStreamAdvance);
+
+         --iShiftTo;
+      } while(0 <= iShiftTo);
+      iShiftTo = cItemsPerBitPackTo - 1;
+      pTermDataTo += cSIMDPack;
+   } while(pTermDataToEnd != pTermDataTo);
+}
+
+template<typename TUInt>
+static void CombineTermDataInternal(
+   const size_t cSIMDPack,
+   const size_t cParallelSamples,
+   void * const * const aaFeatureData,
+   const Term * const pTerm,
+   void * const aTermDataTo
+) {
+   CombineStream<TUInt> aStreams[k_cDimensionsMax];
+   CombineStream<TUInt> * pStream = aStreams;
+   size_t tensorMultiple = 1;
+
+   const TermFeature * pTermFeature = pTerm->GetTermFeatures();
+   const TermFeature * const pTermFeaturesEnd = &pTermFeature[pTerm->GetCountDimensions()];
+   do {
+      const size_t cBins = pTermFeature->m_pFeature->GetCountBins();
+      if(size_t { 1 } < cBins) {
+         const int cItemsPerBitPack = GetCountItemsBitPacked<TUInt>(CountBitsRequired(cBins - size_t { 1 }));
+         const int cBitsPerItemMax = GetCountBits<TUInt>(cItemsPerBitPack);
+
+         EBM_ASSERT(nullptr != aaFeatureData[pTermFeature->m_iFeature]);
+         pStream->m_pData = static_cast<const TUInt *>(aaFeatureData[pTermFeature->m_iFeature]);
+         pStream->m_cTensorMultiple = tensorMultiple;
+         pStream->m_maskBits = MakeLowMask<TUInt>(cBitsPerItemMax);
+         pStream->m_cItemsPerBitPack = cItemsPerBitPack;
+         pStream->m_cBitsPerItemMax = cBitsPerItemMax;
+         pStream->m_iShift = static_cast<int>((cParallelSamples - size_t { 1 }) % static_cast<size_t>(cItemsPerBitPack));
+
+         tensorMultiple *= cBins;
+         ++pStream;
       }
-      ++iTerm;
-   } while(cTerms != iTerm);
+      ++pTermFeature;
+   } while(pTermFeaturesEnd != pTermFeature);
+   EBM_ASSERT(pStream == &aStreams[pTerm->GetCountRealDimensions()]);
+   EBM_ASSERT(tensorMultiple == pTerm->GetCountTensorBins());
+
+   CombineStreams<TUInt>(
+      cSIMDPack,
+      cParallelSamples,
+      pTerm->GetCountRealDimensions(),
+      aStreams,
+      GetCountItemsBitPacked<TUInt>(pTerm->GetBitsRequiredMin()),
+      aTermDataTo
+   );
+}
 
-   LOG_0(Trace_Info, "Exited DataSetBoosting::InitTermData");
-   return Error_None;
+const void * DataSubsetBoosting::CombineTermData(const size_t iTerm, const Term * const pTerm) {
+   EBM_ASSERT(nullptr != pTerm);
+   if(0 == pTerm->GetCountRealDimensions()) {
+      // terms without real dimensions have no data, regardless of how the dataset is stored
+      return nullptr;
+   }
+   EBM_ASSERT(2 <= pTerm->GetCountRealDimensions());
+   EBM_ASSERT(nullptr != m_aaFeatureData);
+
+   static_assert(2 == k_cCombinedTermSlots, "the eviction below assumes 2 slots");
+   size_t iSlot = m_iCombinedSlotRecent;
+   if(iTerm != m_aiCombinedTerm[iSlot]) {
+      // evict the least recently used slot
+      iSlot ^= size_t { 1 };
+      if(iTerm != m_aiCombinedTerm[iSlot]) {
+         EBM_ASSERT(nullptr != m_aaCombinedTermData[iSlot]);
+
+         const size_t cSIMDPack = m_pObjective->m_cSIMDPack;
+         EBM_ASSERT(1 <= cSIMDPack);
+         EBM_ASSERT(0 == m_cSamples % cSIMDPack);
+         const size_t cParallelSamples = m_cSamples / cSIMDPack;
+
+         if(sizeof(UIntBig) == m_pObjective->m_cUIntBytes) {
+            CombineTermDataInternal<UIntBig>(cSIMDPack, cParallelSamples, m_aaFeatureData, pTerm, m_aaCombinedTermData[iSlot]);
+         } else {
+            EBM_ASSERT(sizeof(UIntSmall) == m_pObjective->m_cUIntBytes);
+            CombineTermDataInternal<UIntSmall>(cSIMDPack, cParallelSamples, m_aaFeatureData, pTerm, m_aaCombinedTermData[iSlot]);
+         }
+         m_aiCombinedTerm[iSlot] = iTerm;
+      }
+   }
+   m_iCombinedSlotRecent = iSlot;
+   return m_aaCombinedTermData[iSlot];
 }
-WARNING_POP
 
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
@@ -653,7 +1805,7 @@ ErrorEbm DataSetBoosting::InitBags(
    void * const rng,
    const unsigned char * const pDataSetShared,
    const BagEbm direction,
-   const BagEbm * const aBag,
+   const OuterBag & bag,
    const size_t cInnerBags,
    const size_t cWeights
 ) {
@@ -719,8 +1871,7 @@ ErrorEbm DataSetBoosting::InitBags(
       EBM_ASSERT(nullptr != aWeightsFrom);
    }
 
-   const bool isLoopValidation = direction < BagEbm { 0 };
-   EBM_ASSERT(nullptr != aBag || !isLoopValidation); // if aBag is nullptr then we have no validation samples
+   EBM_ASSERT(!bag.IsEmpty() || direction > BagEbm { 0 }); // without a bag we have no validation samples
 
    EBM_ASSERT(nullptr != m_aSubsets);
    EBM_ASSERT(1 <= m_cSubsets);
@@ -764,7 +1915,7 @@ ErrorEbm DataSetBoosting::InitBags(
                   return Error_OutOfMemory;
                }
                const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cSubsetSamples;
-               void * pWeightTo = AlignedAlloc(cBytes);
+               void * pWeightTo = AllocatePlaced(pSubset, cBytes);
                if(nullptr == pWeightTo) {
                   LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBags nullptr == pWeightsInternal");
                   free(aOccurrencesFrom);
@@ -805,12 +1956,11 @@ ErrorEbm DataSetBoosting::InitBags(
          }
       } else {
          const uint8_t * pOccurrencesFrom = aOccurrencesFrom;
-         const BagEbm * pSampleReplication = aBag;
-         const FloatShared * pWeightFrom = aWeightsFrom;
+         OuterBagWalker walker(bag, direction);
          DataSubsetBoosting * pSubset = m_aSubsets;
          totalWeight = 0.0;
 
-         BagEbm replication = 0;
+         size_t cReplication = 0;
          double weight;
          do {
             const size_t cSubsetSamples = pSubset->GetCountSamples();
@@ -822,7 +1972,7 @@ ErrorEbm DataSetBoosting::InitBags(
                return Error_OutOfMemory;
             }
             const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cSubsetSamples;
-            void * pWeightTo = AlignedAlloc(cBytes);
+            void * pWeightTo = AllocatePlaced(pSubset, cBytes);
             if(nullptr == pWeightTo) {
                LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBags nullptr == pWeightTo");
                free(aOccurrencesFrom);
@@ -850,23 +2000,9 @@ ErrorEbm DataSetBoosting::InitBags(
             // add the weights in 2 stages to preserve precision
             double subsetWeight = 0.0;
             do {
-               if(BagEbm { 0 } == replication) {
-                  replication = 1;
-                  if(nullptr != pSampleReplication) {
-                     bool isItemValidation;
-                     do {
-                        do {
-                           replication = *pSampleReplication;
-                           ++pSampleReplication;
-                           ++pWeightFrom;
-                        } while(BagEbm { 0 } == replication);
-                        isItemValidation = replication < BagEbm { 0 };
-                     } while(isLoopValidation != isItemValidation);
-                     --pWeightFrom;
-                  }
-
-                  weight = static_cast<double>(*pWeightFrom);
-                  ++pWeightFrom;
+               if(size_t { 0 } == cReplication) {
+                  cReplication = walker.Next();
+                  weight = static_cast<double>(aWeightsFrom[walker.GetSample()]);
 
                   // these were checked when creating the shared dataset
                   EBM_ASSERT(!std::isnan(weight));
@@ -897,14 +2033,14 @@ ErrorEbm DataSetBoosting::InitBags(
                }
                pWeightTo = IndexByte(pWeightTo, pSubset->m_pObjective->m_cFloatBytes);
 
-               replication -= direction;
+               --cReplication;
             } while(pWeightsToEnd != pWeightTo);
 
             totalWeight += subsetWeight;
 
             ++pSubset;
          } while(pSubsetsEnd != pSubset);
-         EBM_ASSERT(0 == replication);
+         EBM_ASSERT(0 == cReplication);
 
          EBM_ASSERT(!std::isnan(totalWeight));
          EBM_ASSERT(std::numeric_limits<double>::min() <= totalWeight);
@@ -949,11 +2085,13 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(
    const unsigned char * const pDataSetShared,
    const BagEbm direction,
    const size_t cSharedSamples,
-   const BagEbm * const aBag,
+   const OuterBag & bag,
    const double * const aInitScores,
    const size_t cIncludedSamples,
    const size_t cInnerBags,
    const size_t cWeights,
+   const bool bFeatureStorage,
+   const size_t cFeatures,
    const size_t cTerms,
    const Term * const * const apTerms,
    const IntEbm * const aiTermFeatures
@@ -1064,6 +2202,25 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(
             ++paTermData;
          } while(paTermDataEnd != paTermData);
 
+         if(bFeatureStorage && size_t { 0 } != cFeatures) {
+            if(IsMultiplyError(sizeof(void *), cFeatures)) {
+               LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitDataSetBoosting IsMultiplyError(sizeof(void *), cFeatures)");
+               return Error_OutOfMemory;
+            }
+            void ** paFeatureData = static_cast<void **>(malloc(sizeof(void *) * cFeatures));
+            if(nullptr == paFeatureData) {
+               LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitDataSetBoosting nullptr == paFeatureData");
+               return Error_OutOfMemory;
+            }
+            pSubset->m_aaFeatureData = paFeatureData;
+
+            const void * const * const paFeatureDataEnd = paFeatureData + cFeatures;
+            do {
+               *paFeatureData = nullptr;
+               ++paFeatureData;
+            } while(paFeatureDataEnd != paFeatureData);
+         }
+
          InnerBag * const aInnerBags = InnerBag::AllocateInnerBags(cInnerBags);
          if(nullptr == aInnerBags) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitDataSetBoosting nullptr == aInnerBags");
@@ -1088,7 +2245,7 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(
          error = InitSampleScores(
             cScores,
             direction,
-            aBag,
+            bag,
             aInitScores
          );
          if(Error_None != error) {
@@ -1100,7 +2257,7 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(
          error = InitTargetData(
             pDataSetShared,
             direction,
-            aBag
+            bag
          );
          if(Error_None != error) {
             return error;
@@ -1111,7 +2268,11 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(
          pDataSetShared,
          direction,
          cSharedSamples,
-         aBag,
+         bag,
+         bFeatureStorage,
+         cFeatures,
+         0,
+         0,
          cTerms,
          apTerms,
          aiTermFeatures
@@ -1124,7 +2285,7 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(
          rng,
          pDataSetShared,
          direction,
-         aBag,
+         bag,
          cInnerBags,
          cWeights
       );
@@ -1137,17 +2298,18 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(
    return Error_None;
 }
 
-void DataSetBoosting::DestructDataSetBoosting(const size_t cTerms, const size_t cInnerBags) {
+void DataSetBoosting::DestructDataSetBoosting(const size_t cTerms, const size_t cFeatures, const size_t cInnerBags) {
    LOG_0(Trace_Info, "Entered DataSetBoosting::DestructDataSetBoosting");
 
    free(m_aBagWeightTotals);
+   AlignedFree(m_aQuantizeScratch);
 
    DataSubsetBoosting * pSubset = m_aSubsets;
    if(nullptr != pSubset) {
       EBM_ASSERT(1 <= m_cSubsets);
       const DataSubsetBoosting * const pSubsetsEnd = pSubset + m_cSubsets;
       do {
-         pSubset->DestructDataSubsetBoosting(cTerms, cInnerBags);
+         pSubset->DestructDataSubsetBoosting(cTerms, cFeatures, cInnerBags);
          ++pSubset;
       } while(pSubsetsEnd != pSubset);
       free(m_aSubsets);
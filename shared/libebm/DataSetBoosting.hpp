@@ -6,6 +6,7 @@
 #define DATA_SET_BOOSTING_HPP
 
 #include <stddef.h> // size_t, ptrdiff_t
+#include <limits> // numeric_limits
 
 #include "libebm.h" // ErrorEbm
 #include "logging.h" // EBM_ASSERT
@@ -14,18 +15,26 @@
 #include "bridge.h" // UIntMain
 
 #include "InnerBag.hpp" // InnerBag
+#include "OuterBag.hpp" // OuterBag
+#include "Offload.hpp" // OffloadQueue
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
+class RandomDeterministic;
 class Term;
+struct FeatureDimension;
 struct DataSetBoosting;
 
 struct DataSubsetBoosting final {
    friend DataSetBoosting;
 
+   // terms with 2 or more real dimensions are combined on demand from the per-feature data when the dataset is
+   // stored per-feature. Keeping 2 of them allows ApplyTermUpdateFused to hold the current and the next term
+   static constexpr size_t k_cCombinedTermSlots = 2;
+
    DataSubsetBoosting() = default; // preserve our POD status
    ~DataSubsetBoosting() = default; // preserve our POD status
    void * operator new(std::size_t) = delete; // we only use malloc/free in this library
@@ -35,13 +44,23 @@ struct DataSubsetBoosting final {
       m_cSamples = 0;
       m_pObjective = nullptr;
       m_aGradHess = nullptr;
+      m_aGradHessQuantized = nullptr;
+      m_aQuantizeScales = nullptr;
       m_aSampleScores = nullptr;
       m_aTargetData = nullptr;
+      m_cTargetBytes = 0;
       m_aaTermData = nullptr;
+      m_aaFeatureData = nullptr;
+      for(size_t iSlot = 0; iSlot < k_cCombinedTermSlots; ++iSlot) {
+         m_aaCombinedTermData[iSlot] = nullptr;
+         m_aiCombinedTerm[iSlot] = k_illegalCombinedTerm;
+      }
+      m_iCombinedSlotRecent = 0;
       m_aInnerBags = nullptr;
    }
 
-   void DestructDataSubsetBoosting(const size_t cTerms, const size_t cInnerBags);
+   void DestructDataSubsetBoosting(const size_t cTerms, const size_t cFeatures, const size_t cInnerBags);
+   void FreeResident(void * const p) const;
 
    inline size_t GetCountSamples() const {
       return m_cSamples;
@@ -52,11 +71,26 @@ struct DataSubsetBoosting final {
       return m_pObjective;
    }
 
+   inline OffloadQueue * GetOffloadQueue() const {
+      EBM_ASSERT(nullptr != m_pObjective);
+      return static_cast<OffloadQueue *>(m_pObjective->m_pOffloadQueue);
+   }
+
    inline ErrorEbm ObjectiveApplyUpdate(ApplyUpdateBridge * const pData) {
       EBM_ASSERT(nullptr != pData);
       EBM_ASSERT(nullptr != m_pObjective);
       EBM_ASSERT(nullptr != m_pObjective->m_pApplyUpdateC);
       EBM_ASSERT(0 == m_cSamples % m_pObjective->m_cSIMDPack);
+      OffloadQueue * const pOffloadQueue = GetOffloadQueue();
+      if(nullptr != pOffloadQueue) {
+         // callers that can overlap their work use EnqueueApplyUpdate directly. Here we wait for the result
+         pData->m_metricOut = 0.0;
+         const ErrorEbm error = pOffloadQueue->EnqueueApplyUpdate(m_pObjective, pData, m_cTargetBytes, &pData->m_metricOut);
+         if(Error_None != error) {
+            return error;
+         }
+         return pOffloadQueue->Synchronize();
+      }
       return (*m_pObjective->m_pApplyUpdateC)(m_pObjective, pData);
    }
 
@@ -65,13 +99,31 @@ struct DataSubsetBoosting final {
       EBM_ASSERT(nullptr != m_pObjective);
       EBM_ASSERT(nullptr != m_pObjective->m_pBinSumsBoostingC);
       EBM_ASSERT(0 == m_cSamples % m_pObjective->m_cSIMDPack);
+      // offloaded bin sums are reduced into the main bins by OffloadQueue::EnqueueBinSumsBoosting
+      EBM_ASSERT(nullptr == GetOffloadQueue());
       return (*m_pObjective->m_pBinSumsBoostingC)(m_pObjective, pParams);
    }
 
+   inline ErrorEbm BinSumsBoostingQuantized(BinSumsBoostingBridge * const pParams) {
+      EBM_ASSERT(nullptr != pParams);
+      EBM_ASSERT(nullptr != m_pObjective);
+      EBM_ASSERT(nullptr != m_pObjective->m_pBinSumsBoostingQuantizedC);
+      EBM_ASSERT(0 == m_cSamples % m_pObjective->m_cSIMDPack);
+      return (*m_pObjective->m_pBinSumsBoostingQuantizedC)(m_pObjective, pParams);
+   }
+
    inline void * GetGradHess() {
       return m_aGradHess;
    }
 
+   inline const void * GetGradHessQuantized() const {
+      return m_aGradHessQuantized;
+   }
+
+   inline const double * GetQuantizeScales() const {
+      return m_aQuantizeScales;
+   }
+
    inline void * GetSampleScores() {
       return m_aSampleScores;
    }
@@ -80,9 +132,23 @@ struct DataSubsetBoosting final {
       return m_aTargetData;
    }
 
-   inline const void * GetTermData(const size_t iTerm) const {
+   inline size_t GetCountTargetBytes() const {
+      return m_cTargetBytes;
+   }
+
+   inline bool IsTermDataResident(const size_t iTerm) const {
+      // false if GetTermData needs to combine the term into the shared combined term slots
+      EBM_ASSERT(nullptr != m_aaTermData);
+      return nullptr != m_aaTermData[iTerm];
+   }
+
+   inline const void * GetTermData(const size_t iTerm, const Term * const pTerm) {
       EBM_ASSERT(nullptr != m_aaTermData);
-      return m_aaTermData[iTerm];
+      const void * const aTermData = m_aaTermData[iTerm];
+      if(nullptr != aTermData) {
+         return aTermData;
+      }
+      return CombineTermData(iTerm, pTerm);
    }
 
    inline const InnerBag * GetInnerBag(const size_t iBag) const {
@@ -92,12 +158,28 @@ struct DataSubsetBoosting final {
 
 private:
 
+   static constexpr size_t k_illegalCombinedTerm = std::numeric_limits<size_t>::max();
+
+   const void * CombineTermData(const size_t iTerm, const Term * const pTerm);
+
    size_t m_cSamples;
    const ObjectiveWrapper * m_pObjective;
+   // nullptr in the training set when the gradients are quantized, except for RMSE which keeps its residuals here
    void * m_aGradHess;
+   // optional int8/int16 gradients and hessians with the same SIMD layout as m_aGradHess. The first cSlots values 
+   // of m_aQuantizeScales convert each gradient or hessian slot back into floats, and the next cSlots hold the 
+   // largest magnitude seen in each slot during the last update, which sets the scale of the next update
+   void * m_aGradHessQuantized;
+   double * m_aQuantizeScales;
    void * m_aSampleScores;
    void * m_aTargetData;
+   size_t m_cTargetBytes; // UInt bytes for classification targets, Float bytes for regression targets
+   // when stored per-feature, the single feature terms point into m_aaFeatureData and the other terms are nullptr
    void ** m_aaTermData;
+   void ** m_aaFeatureData;
+   void * m_aaCombinedTermData[k_cCombinedTermSlots];
+   size_t m_aiCombinedTerm[k_cCombinedTermSlots];
+   size_t m_iCombinedSlotRecent;
    InnerBag * m_aInnerBags;
 };
 static_assert(std::is_standard_layout<DataSubsetBoosting>::value,
@@ -116,6 +198,14 @@ struct DataSetBoosting final {
       m_cSubsets = 0;
       m_aSubsets = nullptr;
       m_aBagWeightTotals = nullptr;
+      m_cQuantizations = 0;
+      m_aQuantizeScratch = nullptr;
+      m_cQuantizeWorkers = 0;
+      m_iQuantizeWorkers = 0;
+      m_cBytesQuantizeWorker = 0;
+      m_iQuantizeTemp = 0;
+      m_iQuantizePattern = 0;
+      m_iQuantizeMaxAbs = 0;
    }
 
    ErrorEbm InitDataSetBoosting(
@@ -131,17 +221,41 @@ struct DataSetBoosting final {
       const unsigned char * const pDataSetShared,
       const BagEbm direction,
       const size_t cSharedSamples,
-      const BagEbm * const aBag,
+      const OuterBag & bag,
       const double * const aInitScores,
       const size_t cIncludedSamples,
       const size_t cInnerBags,
       const size_t cWeights,
+      const bool bFeatureStorage,
+      const size_t cFeatures,
       const size_t cTerms,
       const Term * const * const apTerms,
       const IntEbm * const aiTermFeatures
    );
 
-   void DestructDataSetBoosting(const size_t cTerms, const size_t cInnerBags);
+   void DestructDataSetBoosting(const size_t cTerms, const size_t cFeatures, const size_t cInnerBags);
+
+   ErrorEbm InitGradHessQuantized(
+      const bool bHessian,
+      const size_t cScores,
+      const size_t cBytesQuantized
+   );
+
+   // RMSE computes its initial residuals directly into m_aGradHess, so they are quantized separately
+   ErrorEbm QuantizeGradHess(
+      const bool bHessian,
+      const size_t cScores,
+      const size_t cBytesQuantized
+   );
+
+   // runs the ApplyUpdate of pData over the subset in cache sized chunks and quantizes each chunk as soon as it is 
+   // written, so that the float gradients and hessians never exist for the whole subset. With an offload queue the 
+   // subset is split into slices that run on its workers
+   ErrorEbm ApplyUpdateQuantized(
+      DataSubsetBoosting * const pSubset,
+      const ApplyUpdateBridge * const pData,
+      const size_t cBytesQuantized
+   );
 
    inline size_t GetCountSamples() const {
       return m_cSamples;
@@ -158,6 +272,32 @@ struct DataSetBoosting final {
       return m_aBagWeightTotals[iBag];
    }
 
+   // BoosterCore::AddTerms first grows the term data of every subset to cTermsAfter with GrowTermData, and only 
+   // then packs the new terms with AddTermData, so that DestructDataSetBoosting never sees a partial array
+   ErrorEbm GrowTermData(const size_t cTermsBefore, const size_t cTermsAfter);
+
+   ErrorEbm AddTermData(
+      const unsigned char * const pDataSetShared,
+      const BagEbm direction,
+      const size_t cSharedSamples,
+      const OuterBag & bag,
+      const size_t iFeatureFirst,
+      const size_t iTermFirst,
+      const size_t cTerms,
+      const Term * const * const apTerms,
+      const IntEbm * const aiTermFeatures
+   );
+
+   // the inverse of InitSampleScores. aSampleScoresOut has the layout of aInitScores, and only the rows of samples
+   // in our direction are written. aTargets is required for RMSE, which keeps residuals instead of scores
+   void ExportSampleScores(
+      const size_t cScores,
+      const BagEbm direction,
+      const OuterBag & bag,
+      const FloatShared * const aTargets,
+      double * const aSampleScoresOut
+   ) const;
+
 private:
 
    ErrorEbm InitGradHess(
@@ -165,24 +305,58 @@ private:
       const size_t cScores
    );
 
+   // a HostSliceFunction that quantizes the sample groups of one slice on the scratch memory of iWorker
+   static ErrorEbm QuantizeSlice(
+      void * const pContext,
+      const size_t iWorker,
+      const size_t iSlice,
+      const size_t iGroupFirst,
+      const size_t cGroupsSlice
+   );
+
+   // quantizes the whole subset and adds its magnitudes into the maximums that follow the scales. Without pData the 
+   // float gradients and hessians are read from m_aGradHess instead of being calculated
+   ErrorEbm QuantizeSubset(
+      DataSubsetBoosting * const pSubset,
+      const ApplyUpdateBridge * const pData,
+      const size_t cTotalScores,
+      const size_t cBytesQuantized,
+      const uint64_t seed
+   );
+
    ErrorEbm InitSampleScores(
       const size_t cScores,
       const BagEbm direction,
-      const BagEbm * const aBag,
+      const OuterBag & bag,
       const double * const aInitScores
    );
 
    ErrorEbm InitTargetData(
       const unsigned char * const pDataSetShared,
       const BagEbm direction,
-      const BagEbm * const aBag
+      const OuterBag & bag
+   );
+
+   ErrorEbm PackTermData(
+      const BagEbm direction,
+      const OuterBag & bag,
+      const int cBitsRequiredMin,
+      const size_t cTensorBins,
+      const size_t cRealDimensions,
+      FeatureDimension * const aDimensionInfo,
+      const bool bFeature,
+      const size_t iData
    );
 
    ErrorEbm InitTermData(
       const unsigned char * const pDataSetShared,
       const BagEbm direction,
       const size_t cSharedSamples,
-      const BagEbm * const aBag,
+      const OuterBag & bag,
+      const bool bFeatureStorage,
+      const size_t cFeatures,
+      const size_t iFeatureFirst,
+      const size_t iTermFirst,
       const size_t cTerms,
       const Term * const * const apTerms,
       const IntEbm * const aiTermFeatures
@@ -192,7 +366,7 @@ private:
       void * const rng,
       const unsigned char * const pDataSetShared,
       const BagEbm direction,
-      const BagEbm * const aBag,
+      const OuterBag & bag,
       const size_t cInnerBags,
       const size_t cWeights
    );
@@ -201,6 +375,19 @@ private:
    size_t m_cSubsets;
    DataSubsetBoosting * m_aSubsets;
    double * m_aBagWeightTotals;
+   uint64_t m_cQuantizations;
+   // starts with the zeros that serve as the update when a subset is recalculated with a new scale. At 
+   // m_iQuantizeWorkers follow m_cQuantizeWorkers blocks of m_cBytesQuantizeWorker bytes, one per offload worker, 
+   // which hold the float chunk at the start, the multiclass temporary memory at m_iQuantizeTemp, the repeating per 
+   // position multiples, maximums and dither that QuantizeChunk reads at m_iQuantizePattern, and the maximum 
+   // magnitude of each slot at m_iQuantizeMaxAbs
+   void * m_aQuantizeScratch;
+   size_t m_cQuantizeWorkers;
+   size_t m_iQuantizeWorkers;
+   size_t m_cBytesQuantizeWorker;
+   size_t m_iQuantizeTemp;
+   size_t m_iQuantizePattern;
+   size_t m_iQuantizeMaxAbs;
 };
 static_assert(std::is_standard_layout<DataSetBoosting>::value,
    "We use the struct hack in several places, so disallow non-standard_layout types in general");
@@ -8,6 +8,7 @@
 #include <stddef.h> // size_t, ptrdiff_t
 #include <limits> // numeric_limits
 #include <string.h> // memcpy
+#include <thread>
 
 #include "libebm.h" // EBM_API_BODY
 #include "logging.h" // EBM_ASSERT
@@ -28,6 +29,7 @@
 #include "Tensor.hpp"
 #include "BoosterCore.hpp"
 #include "BoosterShell.hpp"
+#include "BoosterStats.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -46,6 +48,19 @@ extern void ConvertAddBin(
    void * const aAddDest
 );
 
+extern ErrorEbm BinSumsBoostingQuantized(
+   const bool bHessian,
+   const size_t cScores,
+   const size_t cBytesQuantized,
+   const int cPack,
+   DataSubsetBoosting * const pSubset,
+   const InnerBag * const pInnerBag,
+   const void * const aPacked,
+   const size_t cTensorBins,
+   void * const aFastBins,
+   BinBase * const aMainBins
+);
+
 extern void TensorTotalsBuild(
    const bool bHessian,
    const size_t cScores,
@@ -167,6 +182,9 @@ static ErrorEbm BoostSingleDimensional(
 
    EBM_ASSERT(1 <= pBoosterCore->GetTrainingSet()->GetCountSamples());
 
+   BoosterStats * const pStats = pBoosterShell->GetStats();
+   const uint64_t tStart = BoosterStats::Start(pStats);
+
    error = PartitionOneDimensionalBoosting(
       pRng,
       pBoosterShell,
@@ -179,6 +197,9 @@ static ErrorEbm BoostSingleDimensional(
       pTotalGain
    );
 
+   BoosterStats::Stop(pStats, BoosterPhase_PartitionOneDimensional, tStart, cBins * GetBinSize<FloatMain, UIntMain>(
+      pBoosterShell->GetBoosterCore()->IsHessian(), pBoosterShell->GetBoosterCore()->GetCountScores()));
+
    LOG_0(Trace_Verbose, "Exited BoostSingleDimensional");
    return error;
 }
@@ -251,6 +272,9 @@ static ErrorEbm BoostMultiDimensional(
 
    BinBase * aAuxiliaryBins = IndexBin(aMainBins, cBytesPerMainBin * cTensorBins);
 
+   BoosterStats * const pStats = pBoosterShell->GetStats();
+   uint64_t tStart = BoosterStats::Start(pStats);
+
    TensorTotalsBuild(
       pBoosterCore->IsHessian(),
       cScores,
@@ -264,6 +288,8 @@ static ErrorEbm BoostMultiDimensional(
 #endif // NDEBUG
    );
 
+   BoosterStats::Stop(pStats, BoosterPhase_TensorTotalsBuild, tStart, cBytesPerMainBin * (cTensorBins + cAuxillaryBins));
+
    //permutation0
    //gain_permute0
    //  divs0
@@ -361,6 +387,8 @@ static ErrorEbm BoostMultiDimensional(
    //} while(std::next_permutation(aiDimensionPermutation, &aiDimensionPermutation[cDimensions]));
 
    if(2 == pTerm->GetCountRealDimensions()) {
+      tStart = BoosterStats::Start(pStats);
+
       error = PartitionTwoDimensionalBoosting(
          pBoosterShell,
          pTerm,
@@ -382,6 +410,8 @@ static ErrorEbm BoostMultiDimensional(
          return error;
       }
 
+      BoosterStats::Stop(pStats, BoosterPhase_PartitionTwoDimensional, tStart, cBytesPerMainBin * cTensorBins);
+
       EBM_ASSERT(!std::isnan(*pTotalGain));
       EBM_ASSERT(0 <= *pTotalGain);
    } else {
@@ -497,6 +527,10 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(
    // set this to illegal so if we exit with an error we have an invalid index
    pBoosterShell->SetTermIndex(BoosterShell::k_illegalTermIndex);
 
+   // we overwrite the main bins below, so a histogram left by ApplyTermUpdateFused can only be used once
+   size_t iTermFused = pBoosterShell->GetFusedTermIndex();
+   pBoosterShell->SetFusedTermIndex(BoosterShell::k_illegalTermIndex);
+
    if(indexTerm < 0) {
       LOG_0(Trace_Error, "ERROR GenerateTermUpdate indexTerm must be positive");
       return Error_IllegalParamVal;
@@ -511,6 +545,17 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(
    }
    size_t iTerm = static_cast<size_t>(indexTerm);
 
+   // views of the same BoosterCore can generate updates in parallel since they only read the gradients and write
+   // into their own BoosterShell, but ApplyTermUpdate on any view needs to wait until we are done
+   const BoosterCoreGate gate(pBoosterCore, pBoosterCore->IsGenerateShared(iTerm));
+   if(pBoosterShell->GetFusedGradientVersion() != pBoosterCore->GetGradientVersion()) {
+      // another view applied an update after our fused histogram was summed
+      iTermFused = BoosterShell::k_illegalTermIndex;
+   }
+
+   BoosterStats * const pStats = pBoosterShell->GetStats();
+   const uint64_t tStartTerm = BoosterStats::Start(pStats);
+
    // this is true because 0 < pBoosterCore->m_cTerms since our caller needs to pass in a valid indexTerm to this function
    EBM_ASSERT(nullptr != pBoosterCore->GetTerms());
    Term * const pTerm = pBoosterCore->GetTerms()[iTerm];
@@ -727,75 +772,139 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(
       size_t iBag = 0;
       EBM_ASSERT(1 <= cInnerBagsAfterZero);
       do {
-         memset(aMainBins, 0, cBytesMainBins);
+         if(iTermFused == iTerm && IntEbm { 0 } != lastDimensionLeavesMax) {
+            // ApplyTermUpdateFused already summed the gradients of the single bag into the main bins
+            EBM_ASSERT(size_t { 1 } == cInnerBagsAfterZero);
+            EBM_ASSERT(size_t { 0 } == pBoosterCore->GetCountBytesQuantized());
+         } else {
+            memset(aMainBins, 0, cBytesMainBins);
+
+            EBM_ASSERT(1 <= pBoosterCore->GetTrainingSet()->GetCountSubsets());
+            DataSubsetBoosting * pSubset = pBoosterCore->GetTrainingSet()->GetSubsets();
+            const DataSubsetBoosting * const pSubsetsEnd = pSubset + pBoosterCore->GetTrainingSet()->GetCountSubsets();
+            do {
+               int cPack;
+               if(UNLIKELY(IntEbm { 0 } == lastDimensionLeavesMax)) {
+                  // this is kind of hacky where if any one of a number of things occurs (like we have only 1 leaf)
+                  // we sum everything into a single bin. The alternative would be to always sum into the tensor bins
+                  // but then collapse them afterwards into a single bin, but that's more work.
+                  cPack = k_cItemsPerBitPackNone;
+               } else {
+                  EBM_ASSERT(1 <= pTerm->GetBitsRequiredMin());
+                  cPack = GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+               }
 
-         EBM_ASSERT(1 <= pBoosterCore->GetTrainingSet()->GetCountSubsets());
-         DataSubsetBoosting * pSubset = pBoosterCore->GetTrainingSet()->GetSubsets();
-         const DataSubsetBoosting * const pSubsetsEnd = pSubset + pBoosterCore->GetTrainingSet()->GetCountSubsets();
-         do {
-            int cPack;
-            if(UNLIKELY(IntEbm { 0 } == lastDimensionLeavesMax)) {
-               // this is kind of hacky where if any one of a number of things occurs (like we have only 1 leaf)
-               // we sum everything into a single bin. The alternative would be to always sum into the tensor bins
-               // but then collapse them afterwards into a single bin, but that's more work.
-               cPack = k_cItemsPerBitPackNone;
-            } else {
-               EBM_ASSERT(1 <= pTerm->GetBitsRequiredMin());
-               cPack = GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-            }
+               const size_t cBytesPacked = k_cItemsPerBitPackNone == cPack ? size_t { 0 } :
+                  pSubset->GetCountSamples() / static_cast<size_t>(cPack) * pSubset->GetObjectiveWrapper()->m_cUIntBytes;
+
+               uint64_t tStart = BoosterStats::Start(pStats);
+               if(size_t { 0 } != pBoosterCore->GetCountBytesQuantized()) {
+                  // the quantized bin sums are scaled into the main bins, so no ConvertAddBin is needed
+                  error = BinSumsBoostingQuantized(
+                     pBoosterCore->IsHessian(),
+                     cScores,
+                     pBoosterCore->GetCountBytesQuantized(),
+                     cPack,
+                     pSubset,
+                     pSubset->GetInnerBag(iBag),
+                     pSubset->GetTermData(iTerm, pTerm),
+                     cTensorBins,
+                     aFastBins,
+                     aMainBins
+                  );
+                  if(Error_None != error) {
+                     return error;
+                  }
+                  BoosterStats::Stop(pStats, BoosterPhase_BinSumsBoosting, tStart, cBytesPacked + 
+                     pSubset->GetCountSamples() * cScores * pBoosterCore->GetCountBytesQuantized() * 
+                     (pBoosterCore->IsHessian() ? size_t { 2 } : size_t { 1 }));
+                  ++pSubset;
+                  continue;
+               }
 
-            size_t cBytesPerFastBin;
-            if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
-               if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                  cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(pBoosterCore->IsHessian(), cScores);
+               size_t cBytesPerFastBin;
+               if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
+                  if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+                     cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(pBoosterCore->IsHessian(), cScores);
+                  } else {
+                     EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+                     cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(pBoosterCore->IsHessian(), cScores);
+                  }
                } else {
-                  EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                  cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(pBoosterCore->IsHessian(), cScores);
+                  EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+                  if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+                     cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(pBoosterCore->IsHessian(), cScores);
+                  } else {
+                     EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+                     cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(pBoosterCore->IsHessian(), cScores);
+                  }
                }
-            } else {
-               EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-               if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                  cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(pBoosterCore->IsHessian(), cScores);
-               } else {
-                  EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                  cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(pBoosterCore->IsHessian(), cScores);
+               EBM_ASSERT(!IsMultiplyError(cBytesPerFastBin, cTensorBins));
+
+               const size_t cBytesBinSums = cBytesPacked + pSubset->GetCountSamples() * cScores *
+                  pSubset->GetObjectiveWrapper()->m_cFloatBytes * (pBoosterCore->IsHessian() ? size_t { 2 } : size_t { 1 });
+
+               BinSumsBoostingBridge params;
+               params.m_bHessian = pBoosterCore->IsHessian() ? EBM_TRUE : EBM_FALSE;
+               params.m_cScores = cScores;
+               params.m_cPack = cPack;
+               params.m_cSamples = pSubset->GetCountSamples();
+               params.m_aGradientsAndHessians = pSubset->GetGradHess();
+               params.m_aWeights = pSubset->GetInnerBag(iBag)->GetWeights();
+               params.m_pCountOccurrences = pSubset->GetInnerBag(iBag)->GetCountOccurrences();
+               params.m_aPacked = pSubset->GetTermData(iTerm, pTerm);
+               params.m_aFastBins = aFastBins;
+      #ifndef NDEBUG
+               params.m_pDebugFastBinsEnd = IndexBin(aFastBins, cBytesPerFastBin * cTensorBins);
+      #endif // NDEBUG
+
+               OffloadQueue * const pOffloadQueue = pSubset->GetOffloadQueue();
+               if(nullptr != pOffloadQueue) {
+                  // the queue sums into its own fast bins and adds them into the main bins when each command completes
+                  error = pOffloadQueue->EnqueueBinSumsBoosting(
+                     pSubset->GetObjectiveWrapper(), &params, cTensorBins, aMainBins);
+                  if(Error_None != error) {
+                     return error;
+                  }
+                  // the time spent waiting on the queue is added to this phase when we synchronize below
+                  BoosterStats::Stop(pStats, BoosterPhase_BinSumsBoosting, tStart, cBytesBinSums);
+                  ++pSubset;
+                  continue;
                }
-            }
-            EBM_ASSERT(!IsMultiplyError(cBytesPerFastBin, cTensorBins));
-
-            aFastBins->ZeroMem(cBytesPerFastBin, cTensorBins);
-
-            BinSumsBoostingBridge params;
-            params.m_bHessian = pBoosterCore->IsHessian() ? EBM_TRUE : EBM_FALSE;
-            params.m_cScores = cScores;
-            params.m_cPack = cPack;
-            params.m_cSamples = pSubset->GetCountSamples();
-            params.m_aGradientsAndHessians = pSubset->GetGradHess();
-            params.m_aWeights = pSubset->GetInnerBag(iBag)->GetWeights();
-            params.m_pCountOccurrences = pSubset->GetInnerBag(iBag)->GetCountOccurrences();
-            params.m_aPacked = pSubset->GetTermData(iTerm);
-            params.m_aFastBins = aFastBins;
-   #ifndef NDEBUG
-            params.m_pDebugFastBinsEnd = IndexBin(aFastBins, cBytesPerFastBin * cTensorBins);
-   #endif // NDEBUG
-            error = pSubset->BinSumsBoosting(&params);
-            if(Error_None != error) {
-               return error;
-            }
 
-            ConvertAddBin(
-               cScores,
-               pBoosterCore->IsHessian(),
-               cTensorBins,
-               sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes,
-               sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes,
-               aFastBins,
-               std::is_same<UIntMain, uint64_t>::value,
-               std::is_same<FloatMain, double>::value,
-               aMainBins
-            );
-            ++pSubset;
-         } while(pSubsetsEnd != pSubset);
+               aFastBins->ZeroMem(cBytesPerFastBin, cTensorBins);
+
+               error = pSubset->BinSumsBoosting(&params);
+               if(Error_None != error) {
+                  return error;
+               }
+               BoosterStats::Stop(pStats, BoosterPhase_BinSumsBoosting, tStart, cBytesBinSums);
+
+               tStart = BoosterStats::Start(pStats);
+               ConvertAddBin(
+                  cScores,
+                  pBoosterCore->IsHessian(),
+                  cTensorBins,
+                  sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes,
+                  sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes,
+                  aFastBins,
+                  std::is_same<UIntMain, uint64_t>::value,
+                  std::is_same<FloatMain, double>::value,
+                  aMainBins
+               );
+               BoosterStats::Stop(pStats, BoosterPhase_ConvertAddBin, tStart, cBytesPerFastBin * cTensorBins + cBytesMainBins);
+               ++pSubset;
+            } while(pSubsetsEnd != pSubset);
+
+            if(nullptr != pBoosterCore->GetOffloadQueue()) {
+               const uint64_t tStart = BoosterStats::Start(pStats);
+               error = pBoosterCore->GetOffloadQueue()->Synchronize();
+               if(Error_None != error) {
+                  return error;
+               }
+               BoosterStats::AddTime(pStats, BoosterPhase_BinSumsBoosting, tStart);
+            }
+         }
 
          // TODO: we can exit here back to python to allow caller modification to our histograms
          //       although having inner bags makes this complicated since each inner bag has it's own
@@ -976,6 +1085,325 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(
       gainAvg
    );
 
+   BoosterStats::StopTerm(pStats, iTerm, TermStat_GenerateCalls, tStartTerm);
+
+   return Error_None;
+}
+
+struct TermGainsJob final {
+   const IntEbm * m_aIndexTerms;
+   size_t m_cTerms;
+   size_t m_cThreads;
+   uint64_t m_seedBase;
+   TermBoostFlags m_flags;
+   double m_learningRate;
+   IntEbm m_minSamplesLeaf;
+   const IntEbm * m_aLeavesMax;
+   double * m_aGains;
+};
+
+struct TermGainsWorker final {
+   BoosterHandle m_boosterHandle;
+   size_t m_iFirst;
+   ErrorEbm m_error;
+};
+
+static INLINE_ALWAYS void InitializeTermGainsRng(
+   const TermGainsJob * const pJob,
+   const size_t iPosition,
+   RandomDeterministic & rng
+) {
+   // each position gets its own stream so that the gains do not depend on which thread evaluated them, and so that
+   // regenerating the best update afterwards reproduces it exactly
+   rng.Initialize(pJob->m_seedBase + static_cast<uint64_t>(iPosition));
+}
+
+static void ComputeTermGainsWorker(const TermGainsJob * const pJob, TermGainsWorker * const pWorker) {
+   RandomDeterministic rng;
+   for(size_t iPosition = pWorker->m_iFirst; iPosition < pJob->m_cTerms; iPosition += pJob->m_cThreads) {
+      InitializeTermGainsRng(pJob, iPosition, rng);
+      const ErrorEbm error = GenerateTermUpdate(
+         &rng,
+         pWorker->m_boosterHandle,
+         pJob->m_aIndexTerms[iPosition],
+         pJob->m_flags,
+         pJob->m_learningRate,
+         pJob->m_minSamplesLeaf,
+         pJob->m_aLeavesMax,
+         &pJob->m_aGains[iPosition]
+      );
+      if(Error_None != error) {
+         pWorker->m_error = error;
+         return;
+      }
+   }
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ComputeTermGains(
+   void * rng,
+   BoosterHandle boosterHandle,
+   IntEbm countTerms,
+   const IntEbm * indexTerms,
+   TermBoostFlags flags,
+   double learningRate,
+   IntEbm minSamplesLeaf,
+   const IntEbm * leavesMax,
+   IntEbm countThreads,
+   double * avgGainsOut,
+   IntEbm * indexTermBestOut
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered ComputeTermGains: "
+      "rng=%p, "
+      "boosterHandle=%p, "
+      "countTerms=%" IntEbmPrintf ", "
+      "indexTerms=%p, "
+      "flags=0x%" UTermBoostFlagsPrintf ", "
+      "learningRate=%le, "
+      "minSamplesLeaf=%" IntEbmPrintf ", "
+      "leavesMax=%p, "
+      "countThreads=%" IntEbmPrintf ", "
+      "avgGainsOut=%p, "
+      "indexTermBestOut=%p"
+      ,
+      rng,
+      static_cast<void *>(boosterHandle),
+      countTerms,
+      static_cast<const void *>(indexTerms),
+      static_cast<UTermBoostFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+      learningRate,
+      minSamplesLeaf,
+      static_cast<const void *>(leavesMax),
+      countThreads,
+      static_cast<void *>(avgGainsOut),
+      static_cast<void *>(indexTermBestOut)
+   );
+
+   ErrorEbm error;
+
+   if(nullptr != indexTermBestOut) {
+      *indexTermBestOut = IntEbm { -1 };
+   }
+
+   BoosterShell * const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+   BoosterCore * const pBoosterCore = pBoosterShell->GetBoosterCore();
+   EBM_ASSERT(nullptr != pBoosterCore);
+
+   // the caller's shell is used as one of the workers, so it is left without an update unless we regenerate the best
+   pBoosterShell->SetTermIndex(BoosterShell::k_illegalTermIndex);
+
+   if(countTerms <= IntEbm { 0 }) {
+      if(IntEbm { 0 } == countTerms) {
+         LOG_0(Trace_Info, "INFO ComputeTermGains countTerms == 0");
+         return Error_None;
+      }
+      LOG_0(Trace_Error, "ERROR ComputeTermGains countTerms must be positive");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countTerms)) {
+      LOG_0(Trace_Error, "ERROR ComputeTermGains IsConvertError<size_t>(countTerms)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTerms = static_cast<size_t>(countTerms);
+
+   if(nullptr == indexTerms) {
+      LOG_0(Trace_Error, "ERROR ComputeTermGains indexTerms cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+   if(nullptr == avgGainsOut) {
+      LOG_0(Trace_Error, "ERROR ComputeTermGains avgGainsOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   size_t iPosition = 0;
+   do {
+      avgGainsOut[iPosition] = k_illegalGainDouble;
+      if(indexTerms[iPosition] < IntEbm { 0 } ||
+         static_cast<IntEbm>(pBoosterCore->GetCountTerms()) <= indexTerms[iPosition]) {
+         LOG_0(Trace_Error, "ERROR ComputeTermGains indexTerms contains an invalid term index");
+         return Error_IllegalParamVal;
+      }
+      ++iPosition;
+   } while(cTerms != iPosition);
+
+   size_t cThreads;
+   if(countThreads <= IntEbm { 0 }) {
+      // hardware_concurrency is allowed to return 0 if the value is not computable
+      cThreads = EbmMax(static_cast<size_t>(std::thread::hardware_concurrency()), size_t { 1 });
+   } else {
+      cThreads = IsConvertError<size_t>(countThreads) ? cTerms : static_cast<size_t>(countThreads);
+   }
+   // terms that cannot share the booster run one at a time (see CreateBoosterView), so extra threads only wait
+   cThreads = EbmMin(cThreads, cTerms);
+
+   uint64_t seedBase;
+   if(nullptr != rng) {
+      RandomDeterministic * const pRng = reinterpret_cast<RandomDeterministic *>(rng);
+      RandomDeterministic cpuRng;
+      cpuRng.Initialize(*pRng); // move it into a local variable so the compiler can use registers
+      seedBase = cpuRng.Next<uint64_t>();
+      pRng->Initialize(cpuRng);
+   } else {
+      try {
+         RandomNondeterministic<uint64_t> randomGenerator;
+         seedBase = randomGenerator.Next(std::numeric_limits<uint64_t>::max());
+      } catch(const std::bad_alloc &) {
+         LOG_0(Trace_Warning, "WARNING ComputeTermGains Out of memory in std::random_device");
+         return Error_OutOfMemory;
+      } catch(...) {
+         LOG_0(Trace_Warning, "WARNING ComputeTermGains Unknown error in std::random_device");
+         return Error_UnexpectedInternal;
+      }
+   }
+
+   TermGainsJob job;
+   job.m_aIndexTerms = indexTerms;
+   job.m_cTerms = cTerms;
+   job.m_cThreads = cThreads;
+   job.m_seedBase = seedBase;
+   job.m_flags = flags;
+   job.m_learningRate = learningRate;
+   job.m_minSamplesLeaf = minSamplesLeaf;
+   job.m_aLeavesMax = leavesMax;
+   job.m_aGains = avgGainsOut;
+
+   if(size_t { 1 } == cThreads) {
+      TermGainsWorker worker;
+      worker.m_boosterHandle = boosterHandle;
+      worker.m_iFirst = 0;
+      worker.m_error = Error_None;
+      ComputeTermGainsWorker(&job, &worker);
+      error = worker.m_error;
+   } else {
+      // worker 0 is the calling thread on the caller's shell. The others each get their own view and thread
+      TermGainsWorker * const aWorkers = static_cast<TermGainsWorker *>(malloc(sizeof(TermGainsWorker) * cThreads));
+      if(nullptr == aWorkers) {
+         LOG_0(Trace_Warning, "WARNING ComputeTermGains nullptr == aWorkers");
+         return Error_OutOfMemory;
+      }
+      std::thread * const aThreads = static_cast<std::thread *>(malloc(sizeof(std::thread) * cThreads));
+      if(nullptr == aThreads) {
+         LOG_0(Trace_Warning, "WARNING ComputeTermGains nullptr == aThreads");
+         free(aWorkers);
+         return Error_OutOfMemory;
+      }
+
+      error = Error_None;
+      size_t cViews = 1;
+      aWorkers[0].m_boosterHandle = boosterHandle;
+      aWorkers[0].m_iFirst = 0;
+      aWorkers[0].m_error = Error_None;
+      do {
+         BoosterShell * const pBoosterShellView = BoosterShell::Create(pBoosterCore);
+         if(nullptr == pBoosterShellView) {
+            LOG_0(Trace_Warning, "WARNING ComputeTermGains nullptr == pBoosterShellView");
+            error = Error_OutOfMemory;
+            break;
+         }
+         pBoosterCore->AddReferenceCount();
+         error = pBoosterShellView->FillAllocations();
+         if(Error_None != error) {
+            BoosterShell::Free(pBoosterShellView);
+            break;
+         }
+         aWorkers[cViews].m_boosterHandle = pBoosterShellView->GetHandle();
+         aWorkers[cViews].m_iFirst = cViews;
+         aWorkers[cViews].m_error = Error_None;
+         ++cViews;
+      } while(cThreads != cViews);
+
+      size_t cThreadsStarted = 1;
+      if(Error_None == error) {
+         do {
+            try {
+               new(&aThreads[cThreadsStarted]) std::thread(ComputeTermGainsWorker, &job, &aWorkers[cThreadsStarted]);
+            } catch(const std::bad_alloc &) {
+               LOG_0(Trace_Warning, "WARNING ComputeTermGains thread start out of memory");
+               error = Error_OutOfMemory;
+               break;
+            } catch(...) {
+               // the C++ standard doesn't really seem to say what kind of exceptions we'd get for various errors, so
+               // about the best we can do is catch(...) since the exact exceptions seem to be implementation specific
+               LOG_0(Trace_Warning, "WARNING ComputeTermGains thread start failed");
+               error = Error_ThreadStartFailed;
+               break;
+            }
+            ++cThreadsStarted;
+         } while(cThreads != cThreadsStarted);
+
+         if(Error_None == error) {
+            ComputeTermGainsWorker(&job, &aWorkers[0]);
+         }
+      }
+
+      for(size_t iThread = 1; iThread < cThreadsStarted; ++iThread) {
+         std::thread * const pThread = &aThreads[iThread];
+         pThread->join();
+         pThread->~thread();
+      }
+      for(size_t iView = 1; iView < cViews; ++iView) {
+         BoosterShell::Free(BoosterShell::GetBoosterShellFromHandle(aWorkers[iView].m_boosterHandle));
+      }
+      if(Error_None == error) {
+         for(size_t iWorker = 0; iWorker < cThreads; ++iWorker) {
+            if(Error_None != aWorkers[iWorker].m_error) {
+               error = aWorkers[iWorker].m_error;
+               break;
+            }
+         }
+      }
+
+      free(aThreads);
+      free(aWorkers);
+   }
+
+   // the caller's shell holds whichever update it generated last, which is not necessarily the best one
+   pBoosterShell->SetTermIndex(BoosterShell::k_illegalTermIndex);
+
+   if(Error_None != error) {
+      return error;
+   }
+
+   if(nullptr != indexTermBestOut) {
+      // ties go to the earliest position, and terms that overflowed (k_illegalGainDouble) are never chosen
+      size_t iBest = 0;
+      iPosition = 1;
+      while(cTerms != iPosition) {
+         if(avgGainsOut[iBest] < avgGainsOut[iPosition]) {
+            iBest = iPosition;
+         }
+         ++iPosition;
+      }
+      if(k_illegalGainDouble != avgGainsOut[iBest]) {
+         // regenerating on the caller's shell is cheaper than keeping a copy of every worker's best update, and
+         // reusing the position's rng stream reproduces the exact update so that ApplyTermUpdate can commit it
+         RandomDeterministic rngBest;
+         InitializeTermGainsRng(&job, iBest, rngBest);
+         double gain;
+         error = GenerateTermUpdate(
+            &rngBest,
+            boosterHandle,
+            indexTerms[iBest],
+            flags,
+            learningRate,
+            minSamplesLeaf,
+            leavesMax,
+            &gain
+         );
+         if(Error_None != error) {
+            return error;
+         }
+         EBM_ASSERT(gain == avgGainsOut[iBest]);
+         *indexTermBestOut = indexTerms[iBest];
+      }
+   }
+
+   LOG_0(Trace_Info, "Exited ComputeTermGains");
    return Error_None;
 }
 
@@ -30,7 +30,7 @@ WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
 extern void InitializeRmseGradientsAndHessiansBoosting(
    const unsigned char * const pDataSetShared,
    const BagEbm direction,
-   const BagEbm * const aBag,
+   const OuterBag & bag,
    const double * const aInitScores,
    DataSetBoosting * const pDataSet
 ) {
@@ -44,16 +44,12 @@ extern void InitializeRmseGradientsAndHessiansBoosting(
 
    if(size_t { 0 } != pDataSet->GetCountSamples()) {
       ptrdiff_t cRuntimeClasses;
-      const FloatShared * pTargetData =
+      const FloatShared * const aTargetData =
          static_cast<const FloatShared *>(GetDataSetSharedTarget(pDataSetShared, 0, &cRuntimeClasses));
-      EBM_ASSERT(nullptr != pTargetData); // we previously called GetDataSetSharedTarget and got back non-null result
+      EBM_ASSERT(nullptr != aTargetData); // we previously called GetDataSetSharedTarget and got back non-null result
       EBM_ASSERT(ptrdiff_t { Task_Regression } == cRuntimeClasses);
 
-      const BagEbm * pSampleReplication = aBag;
-      const double * pInitScore = aInitScores;
-
-      const bool isLoopValidation = direction < BagEbm { 0 };
-      EBM_ASSERT(nullptr != aBag || !isLoopValidation); // if pSampleReplication is nullptr then we have no validation samples
+      OuterBagWalker walker(bag, direction);
 
       EBM_ASSERT(1 <= pDataSet->GetCountSamples());
       EBM_ASSERT(1 <= pDataSet->GetCountSubsets());
@@ -62,7 +58,7 @@ extern void InitializeRmseGradientsAndHessiansBoosting(
       const DataSubsetBoosting * const pSubsetsEnd = pSubset + pDataSet->GetCountSubsets();
 
       double initScore = 0;
-      BagEbm replication = 0;
+      size_t cReplication = 0;
       double gradient;
       do {
          EBM_ASSERT(1 <= pSubset->GetCountSamples());
@@ -71,29 +67,12 @@ extern void InitializeRmseGradientsAndHessiansBoosting(
          const void * const pGradHessEnd = IndexByte(pGradHess, pSubset->GetObjectiveWrapper()->m_cFloatBytes * pSubset->GetCountSamples());
 
          do {
-            if(BagEbm { 0 } == replication) {
-               replication = 1;
-               size_t cInitAdvances = 1;
-               if(nullptr != pSampleReplication) {
-                  cInitAdvances = 0;
-                  bool isItemValidation;
-                  do {
-                     do {
-                        replication = *pSampleReplication;
-                        ++pSampleReplication;
-                        ++pTargetData;
-                     } while(BagEbm { 0 } == replication);
-                     isItemValidation = replication < BagEbm { 0 };
-                     ++cInitAdvances;
-                  } while(isLoopValidation != isItemValidation);
-                  --pTargetData;
-               }
-               const FloatShared data = *pTargetData;
-               ++pTargetData;
+            if(size_t { 0 } == cReplication) {
+               cReplication = walker.Next();
+               const FloatShared data = aTargetData[walker.GetSample()];
 
-               if(nullptr != pInitScore) {
-                  pInitScore += cInitAdvances;
-                  initScore = pInitScore[-1];
+               if(nullptr != aInitScores) {
+                  initScore = aInitScores[walker.GetIncluded()];
                }
 
                // TODO : our caller should handle NaN *pTargetData values, which means that the target is missing, which means we should delete that sample 
@@ -120,17 +99,57 @@ extern void InitializeRmseGradientsAndHessiansBoosting(
             }
             pGradHess = IndexByte(pGradHess, pSubset->GetObjectiveWrapper()->m_cFloatBytes);
 
-            replication -= direction;
+            --cReplication;
          } while(pGradHessEnd != pGradHess);
 
          ++pSubset;
       } while(pSubsetsEnd != pSubset);
-      EBM_ASSERT(0 == replication);
+      EBM_ASSERT(0 == cReplication);
    }
    LOG_0(Trace_Info, "Exited InitializeRmseGradientsAndHessiansBoosting");
 }
 WARNING_POP
 
+template<typename TFloat>
+static void FillRmseResiduals(
+   const size_t cSamples,
+   const FloatShared * const aTargets,
+   const double * const aInitScores,
+   const FloatShared * const aWeights,
+   TFloat * const aGradients
+) {
+   // the init scores and weights are loop invariant choices, so keep each loop simple enough to vectorize.
+   // We subtract from zero rather than negating so that the results are identical to the general path
+   size_t i = 0;
+   if(nullptr == aInitScores) {
+      if(nullptr == aWeights) {
+         do {
+            aGradients[i] = static_cast<TFloat>(double { 0 } - static_cast<double>(aTargets[i]));
+            ++i;
+         } while(cSamples != i);
+      } else {
+         do {
+            aGradients[i] = static_cast<TFloat>(
+               (double { 0 } - static_cast<double>(aTargets[i])) * static_cast<double>(aWeights[i]));
+            ++i;
+         } while(cSamples != i);
+      }
+   } else {
+      if(nullptr == aWeights) {
+         do {
+            aGradients[i] = static_cast<TFloat>(aInitScores[i] - static_cast<double>(aTargets[i]));
+            ++i;
+         } while(cSamples != i);
+      } else {
+         do {
+            aGradients[i] = static_cast<TFloat>(
+               (aInitScores[i] - static_cast<double>(aTargets[i])) * static_cast<double>(aWeights[i]));
+            ++i;
+         } while(cSamples != i);
+      }
+   }
+}
+
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
 extern void InitializeRmseGradientsAndHessiansInteraction(
@@ -166,85 +185,111 @@ extern void InitializeRmseGradientsAndHessiansInteraction(
       EBM_ASSERT(1 <= pDataSet->GetCountSubsets());
       const DataSubsetInteraction * const pSubsetsEnd = pSubset + pDataSet->GetCountSubsets();
 
-      const BagEbm * pSampleReplication = aBag;
-      const double * pInitScore = aInitScores;
-
-      double initScore = 0;
-      BagEbm replication = 0;
-      double gradient;
-      do {
-         EBM_ASSERT(1 <= pSubset->GetCountSamples());
-         void * pGradHess = pSubset->GetGradHess();
-         EBM_ASSERT(nullptr != pGradHess);
-         const void * const pGradHessEnd = IndexByte(pGradHess, pSubset->GetObjectiveWrapper()->m_cFloatBytes * pSubset->GetCountSamples());
-
-         EBM_ASSERT(nullptr == pWeight && nullptr == pSubset->GetWeights() ||
-            nullptr != pWeight && nullptr != pSubset->GetWeights());
+      if(nullptr == aBag) {
+         // without a bag every shared sample appears exactly once and in order, so the residuals can be
+         // computed in a single branch free pass over the targets instead of walking the replication counts
+         const double * pInitScore = aInitScores;
          do {
-            if(BagEbm { 0 } == replication) {
-               replication = 1;
-               size_t cInitAdvances = 1;
-               size_t cSharedAdvances = 1;
-               if(nullptr != pSampleReplication) {
-                  cInitAdvances = 0;
-                  cSharedAdvances = 0;
-                  do {
-                     do {
-                        replication = pSampleReplication[cSharedAdvances];
-                        ++cSharedAdvances;
-                     } while(BagEbm { 0 } == replication);
-                     ++cInitAdvances;
-                  } while(replication < BagEbm { 0 });
-                  pSampleReplication += cSharedAdvances;
-               }
-               pTargetData += cSharedAdvances;
-               const FloatShared data = pTargetData[-1];
-
-               if(nullptr != pInitScore) {
-                  pInitScore += cInitAdvances;
-                  initScore = pInitScore[-1];
-               }
-
-               // TODO : our caller should handle NaN *pTargetData values, which means that the target is missing, which means we should delete that sample 
-               //   from the input data
-
-               // if data is NaN, we pass this along and NaN propagation will ensure that we stop boosting immediately.
-               // There is no need to check it here since we already have graceful detection later for other reasons.
-
-               // TODO: NaN target values essentially mean missing, so we should be filtering those samples out, but our caller should do that so 
-               //   that we don't need to do the work here per outer bag.  Our job in C++ is just not to crash or return inexplicable values.
-
-
-               // for RMSE regression, the gradient is the residual, and we can calculate it once at init and we don't need
-               // to keep the original scores when computing the gradient updates.
-
-               gradient = initScore - static_cast<double>(data);
-
-               if(nullptr != pWeight) {
-                  // This is only used during the initialization of interaction detection. For boosting
-                  // we currently multiply by the weight during bin summation instead since we use the weight
-                  // there to include the inner bagging counts of occurences.
-                  // Whether this multiplication happens or not is controlled by the caller by passing in the
-                  // weight array or not.
-                  pWeight += cSharedAdvances;
-                  gradient *= static_cast<double>(pWeight[-1]);
-               }
-            }
-
+            const size_t cSubsetSamples = pSubset->GetCountSamples();
+            EBM_ASSERT(1 <= cSubsetSamples);
             if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-               *reinterpret_cast<FloatBig *>(pGradHess) = static_cast<FloatBig>(gradient);
+               FillRmseResiduals(cSubsetSamples, pTargetData, pInitScore, pWeight,
+                  static_cast<FloatBig *>(pSubset->GetGradHess()));
             } else {
                EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-               *reinterpret_cast<FloatSmall *>(pGradHess) = static_cast<FloatSmall>(gradient);
+               FillRmseResiduals(cSubsetSamples, pTargetData, pInitScore, pWeight,
+                  static_cast<FloatSmall *>(pSubset->GetGradHess()));
             }
-            pGradHess = IndexByte(pGradHess, pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+            pTargetData += cSubsetSamples;
+            if(nullptr != pInitScore) {
+               pInitScore += cSubsetSamples;
+            }
+            if(nullptr != pWeight) {
+               pWeight += cSubsetSamples;
+            }
+            ++pSubset;
+         } while(pSubsetsEnd != pSubset);
+      } else {
+         const BagEbm * pSampleReplication = aBag;
+         const double * pInitScore = aInitScores;
+
+         double initScore = 0;
+         BagEbm replication = 0;
+         double gradient;
+         do {
+            EBM_ASSERT(1 <= pSubset->GetCountSamples());
+            void * pGradHess = pSubset->GetGradHess();
+            EBM_ASSERT(nullptr != pGradHess);
+            const void * const pGradHessEnd = IndexByte(pGradHess, pSubset->GetObjectiveWrapper()->m_cFloatBytes * pSubset->GetCountSamples());
+
+            EBM_ASSERT(nullptr == pWeight && nullptr == pSubset->GetWeights() ||
+               nullptr != pWeight && nullptr != pSubset->GetWeights());
+            do {
+               if(BagEbm { 0 } == replication) {
+                  replication = 1;
+                  size_t cInitAdvances = 1;
+                  size_t cSharedAdvances = 1;
+                  if(nullptr != pSampleReplication) {
+                     cInitAdvances = 0;
+                     cSharedAdvances = 0;
+                     do {
+                        do {
+                           replication = pSampleReplication[cSharedAdvances];
+                           ++cSharedAdvances;
+                        } while(BagEbm { 0 } == replication);
+                        ++cInitAdvances;
+                     } while(replication < BagEbm { 0 });
+                     pSampleReplication += cSharedAdvances;
+                  }
+                  pTargetData += cSharedAdvances;
+                  const FloatShared data = pTargetData[-1];
+
+                  if(nullptr != pInitScore) {
+                     pInitScore += cInitAdvances;
+                     initScore = pInitScore[-1];
+                  }
+
+                  // TODO : our caller should handle NaN *pTargetData values, which means that the target is missing, which means we should delete that sample 
+                  //   from the input data
+
+                  // if data is NaN, we pass this along and NaN propagation will ensure that we stop boosting immediately.
+                  // There is no need to check it here since we already have graceful detection later for other reasons.
+
+                  // TODO: NaN target values essentially mean missing, so we should be filtering those samples out, but our caller should do that so 
+                  //   that we don't need to do the work here per outer bag.  Our job in C++ is just not to crash or return inexplicable values.
+
+
+                  // for RMSE regression, the gradient is the residual, and we can calculate it once at init and we don't need
+                  // to keep the original scores when computing the gradient updates.
+
+                  gradient = initScore - static_cast<double>(data);
+
+                  if(nullptr != pWeight) {
+                     // This is only used during the initialization of interaction detection. For boosting
+                     // we currently multiply by the weight during bin summation instead since we use the weight
+                     // there to include the inner bagging counts of occurences.
+                     // Whether this multiplication happens or not is controlled by the caller by passing in the
+                     // weight array or not.
+                     pWeight += cSharedAdvances;
+                     gradient *= static_cast<double>(pWeight[-1]);
+                  }
+               }
 
-            --replication;
-         } while(pGradHessEnd != pGradHess);
+               if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+                  *reinterpret_cast<FloatBig *>(pGradHess) = static_cast<FloatBig>(gradient);
+               } else {
+                  EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+                  *reinterpret_cast<FloatSmall *>(pGradHess) = static_cast<FloatSmall>(gradient);
+               }
+               pGradHess = IndexByte(pGradHess, pSubset->GetObjectiveWrapper()->m_cFloatBytes);
 
-         ++pSubset;
-      } while(pSubsetsEnd != pSubset);
-      EBM_ASSERT(0 == replication);
+               --replication;
+            } while(pGradHessEnd != pGradHess);
+
+            ++pSubset;
+         } while(pSubsetsEnd != pSubset);
+         EBM_ASSERT(0 == replication);
+      }
    }
    LOG_0(Trace_Info, "Exited InitializeRmseGradientsAndHessiansInteraction");
 }
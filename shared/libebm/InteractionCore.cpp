@@ -293,6 +293,11 @@ ErrorEbm InteractionCore::Create(
       }
       LOG_0(Trace_Info, "INFO InteractionCore::Create Objective determined");
 
+      // The default interaction gain only consumes gradient sums and sample weights, so unless Newton was
+      // requested we never generate or store hessians. This halves the gradient memory and the bin scatter.
+      pInteractionCore->m_bHessian = EBM_FALSE != pInteractionCore->m_objectiveCpu.m_bObjectiveHasHessian &&
+         0 != (CreateInteractionFlags_EnableNewton & flags) ? EBM_TRUE : EBM_FALSE;
+
       const TaskEbm task = IdentifyTask(pInteractionCore->m_objectiveCpu.m_linkFunction);
       if(ptrdiff_t { Task_GeneralClassification } <= cClasses) {
          if(task < Task_GeneralClassification) {
@@ -562,6 +567,8 @@ ErrorEbm InteractionCore::InitializeInteractionGradientsAndHessians(
             data.m_aPacked = nullptr;
             data.m_aWeights = nullptr;
             data.m_aGradientsAndHessians = pSubset->GetGradHess();
+            data.m_cMetricBins = 0;
+            data.m_aMetricBins = nullptr;
             // this is a kind of hack (a good one) where we are sending in an update of all zeros in order to 
             // reuse the same code that we use for boosting in order to generate our gradients and hessians
             error = pSubset->ObjectiveApplyUpdate(&data);
@@ -648,6 +655,8 @@ ErrorEbm InteractionCore::InitializeInteractionGradientsAndHessians(
             data.m_aPacked = nullptr;
             data.m_aWeights = nullptr;
             data.m_aGradientsAndHessians = pSubset->GetGradHess();
+            data.m_cMetricBins = 0;
+            data.m_aMetricBins = nullptr;
             // this is a kind of hack (a good one) where we are sending in an update of all zeros in order to 
             // reuse the same code that we use for boosting in order to generate our gradients and hessians
             error = pSubset->ObjectiveApplyUpdate(&data);
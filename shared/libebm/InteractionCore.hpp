@@ -32,6 +32,7 @@ class InteractionCore final {
 
    size_t m_cScores;
    BoolEbm m_bDisableApprox;
+   BoolEbm m_bHessian;
 
    size_t m_cFeatures;
    FeatureInteraction * m_aFeatures;
@@ -54,6 +55,7 @@ class InteractionCore final {
       m_REFERENCE_COUNT(1), // we're not visible on any other thread yet, so no synchronization required
       m_cScores(0),
       m_bDisableApprox(EBM_FALSE),
+      m_bHessian(EBM_FALSE),
       m_cFeatures(0),
       m_aFeatures(nullptr)
    {
@@ -122,9 +124,10 @@ public:
       return EBM_FALSE != m_objectiveCpu.m_bRmse;
    }
 
-   inline bool IsHessian() {
-      EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
-      return EBM_FALSE != m_objectiveCpu.m_bObjectiveHasHessian;
+   inline bool IsHessian() const {
+      // hessians are only materialized in the gradient array and bins if the objective has them AND the
+      // caller asked for them via CreateInteractionFlags_EnableNewton.  Otherwise we use the gradient-only layout.
+      return EBM_FALSE != m_bHessian;
    }
 
    inline BoolEbm IsDisableApprox() const {
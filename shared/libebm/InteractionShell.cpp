@@ -163,7 +163,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(
    if(0 != (static_cast<UCreateInteractionFlags>(flags) & static_cast<UCreateInteractionFlags>(~(
       static_cast<UCreateInteractionFlags>(CreateInteractionFlags_DifferentialPrivacy) |
       static_cast<UCreateInteractionFlags>(CreateInteractionFlags_DisableApprox) |
-      static_cast<UCreateInteractionFlags>(CreateInteractionFlags_BinaryAsMulticlass)
+      static_cast<UCreateInteractionFlags>(CreateInteractionFlags_BinaryAsMulticlass) |
+      static_cast<UCreateInteractionFlags>(CreateInteractionFlags_EnableNewton)
    )))) {
       LOG_0(Trace_Error, "ERROR CreateInteractionDetector flags contains unknown flags. Ignoring extras.");
    }
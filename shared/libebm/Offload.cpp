@@ -0,0 +1,1033 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc, free, strtoul
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdio.h> // fopen, fgets, snprintf
+#include <string.h> // memset
+#include <new> // placement new
+
+#if defined(__linux__)
+#include <sched.h> // sched_getaffinity, sched_setaffinity
+#endif // __linux__
+
+#include "logging.h" // EBM_ASSERT
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IndexByte, IsMultiplyError
+#include "bridge.hpp" // k_cItemsPerBitPackNone
+#include "GradientPair.hpp"
+#include "Bin.hpp" // GetBinSize
+
+#include "ebm_internal.hpp"
+#include "Offload.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+extern void ConvertAddBin(
+   const size_t cScores,
+   const bool bHessian,
+   const size_t cBins,
+   const bool bUInt64Src,
+   const bool bDoubleSrc,
+   const void * const aSrc,
+   const bool bUInt64Dest,
+   const bool bDoubleDest,
+   void * const aAddDest
+);
+
+// splitting a command has some overhead (an extra reduction for bin sums), so don't split below this many samples
+static constexpr size_t k_cSamplesSliceMin = 4096;
+
+// there is little point in having more threads than this since the kernels are memory bound
+static constexpr size_t k_cThreadsMax = 64;
+
+// Commands are split into at most this many slices no matter how many threads we have, so that the sums are
+// added in the same order everywhere. Each bin sums slice needs its own fast bins, which is what limits this.
+static constexpr size_t k_cSlicesMax = 64;
+
+// bin sums are reduced in blocks of this many neighbouring slices before the blocks are added together
+static constexpr size_t k_cSlicesPerBlock = 8;
+
+#if defined(__linux__)
+static constexpr size_t k_cCpusMax = static_cast<size_t>(CPU_SETSIZE);
+// node ids above this are ignored, and their CPUs are treated as being on node 0
+static constexpr size_t k_cNodeIdsMax = 256;
+#else // __linux__
+static constexpr size_t k_cCpusMax = 1;
+#endif // __linux__
+
+struct OffloadCommand final {
+   OffloadCommand() = default; // preserve our POD status
+   ~OffloadCommand() = default; // preserve our POD status
+   void * operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete (void *) = delete; // we only use malloc/free in this library
+
+   OffloadCommand * m_pNext;
+   const ObjectiveWrapper * m_pObjective;
+
+   size_t m_iCommand; // numbered from 1 in submission order so that each worker knows which commands it has seen
+   bool m_bBinSums;
+   size_t m_cSlices;
+   size_t m_cSlicesDone;
+
+   // either ApplyUpdateBridge[m_cSlices] or BinSumsBoostingBridge[m_cSlices], already offset to the start of each slice
+   void * m_aSlices;
+
+   // per-slice multiclass temp memory for ApplyUpdate, or per-slice fast bins for BinSumsBoosting
+   size_t m_cBytesTempPerSlice;
+   void * m_aTemp;
+
+   double * m_pMetricAddOut;
+
+   // per-slice score histograms for a registered metric, which are added into m_aMetricBinsAddOut
+   size_t m_cMetricBins;
+   double * m_aMetricBins;
+   double * m_aMetricBinsAddOut;
+
+   size_t m_cBins;
+   void * m_aMainBinsAddOut;
+
+   // the words in each bin of quantized bin sums, which are added without conversion. Zero for float bins
+   size_t m_cQuantizedWords;
+   bool m_bQuantizedDouble;
+
+   // with bin sums of more than one block, the last worker to finish a block adds its slices into the block's
+   // m_aBlockBins, and FinishCommand then adds the blocks into m_aMainBinsAddOut. m_cBlocks is zero otherwise
+   size_t m_cBlocks;
+   size_t m_cBlocksDone;
+   size_t * m_acBlockSlicesDone;
+   size_t m_cBytesBlockBins;
+   void * m_aBlockBins;
+
+   // for FirstTouch commands, the buffer to fault in. m_aSlices then holds the byte offset where each slice starts
+   void * m_pTouch;
+   size_t m_cBytesTouch;
+
+   // for EnqueueHostSlices commands. m_aSlices then holds the first group of each slice
+   HostSliceFunction m_pHostSlice;
+   void * m_pHostContext;
+   size_t m_cHostGroups;
+};
+static_assert(std::is_standard_layout<OffloadCommand>::value,
+   "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<OffloadCommand>::value,
+   "We use memcpy in several places, so disallow non-trivial types in general");
+
+static void FreeCommand(OffloadCommand * const pCommand) {
+   if(nullptr != pCommand) {
+      AlignedFree(pCommand->m_aBlockBins);
+      free(pCommand->m_acBlockSlicesDone);
+      AlignedFree(pCommand->m_aTemp);
+      free(pCommand->m_aMetricBins);
+      free(pCommand->m_aSlices);
+      free(pCommand);
+   }
+}
+
+static OffloadCommand * AllocateCommand(
+   const bool bBinSums,
+   const size_t cSlices,
+   const size_t cBytesSlice,
+   const size_t cBytesTempPerSlice
+) {
+   EBM_ASSERT(1 <= cSlices);
+
+   OffloadCommand * const pCommand = static_cast<OffloadCommand *>(malloc(sizeof(OffloadCommand)));
+   if(nullptr == pCommand) {
+      LOG_0(Trace_Warning, "WARNING AllocateCommand nullptr == pCommand");
+      return nullptr;
+   }
+   pCommand->m_pNext = nullptr;
+   pCommand->m_pObjective = nullptr;
+   pCommand->m_iCommand = 0;
+   pCommand->m_bBinSums = bBinSums;
+   pCommand->m_cSlices = cSlices;
+   pCommand->m_cSlicesDone = 0;
+   pCommand->m_aSlices = nullptr;
+   pCommand->m_cBytesTempPerSlice = cBytesTempPerSlice;
+   pCommand->m_aTemp = nullptr;
+   pCommand->m_pMetricAddOut = nullptr;
+   pCommand->m_cMetricBins = 0;
+   pCommand->m_aMetricBins = nullptr;
+   pCommand->m_aMetricBinsAddOut = nullptr;
+   pCommand->m_cBins = 0;
+   pCommand->m_aMainBinsAddOut = nullptr;
+   pCommand->m_cQuantizedWords = 0;
+   pCommand->m_bQuantizedDouble = false;
+   pCommand->m_cBlocks = 0;
+   pCommand->m_cBlocksDone = 0;
+   pCommand->m_acBlockSlicesDone = nullptr;
+   pCommand->m_cBytesBlockBins = 0;
+   pCommand->m_aBlockBins = nullptr;
+   pCommand->m_pTouch = nullptr;
+   pCommand->m_cBytesTouch = 0;
+   pCommand->m_pHostSlice = nullptr;
+   pCommand->m_pHostContext = nullptr;
+   pCommand->m_cHostGroups = 0;
+
+   EBM_ASSERT(!IsMultiplyError(cBytesSlice, cSlices));
+   pCommand->m_aSlices = malloc(cBytesSlice * cSlices);
+   if(nullptr == pCommand->m_aSlices) {
+      LOG_0(Trace_Warning, "WARNING AllocateCommand nullptr == pCommand->m_aSlices");
+      FreeCommand(pCommand);
+      return nullptr;
+   }
+
+   if(size_t { 0 } != cBytesTempPerSlice) {
+      if(IsMultiplyError(cBytesTempPerSlice, cSlices)) {
+         LOG_0(Trace_Warning, "WARNING AllocateCommand IsMultiplyError(cBytesTempPerSlice, cSlices)");
+         FreeCommand(pCommand);
+         return nullptr;
+      }
+      pCommand->m_aTemp = AlignedAlloc(cBytesTempPerSlice * cSlices);
+      if(nullptr == pCommand->m_aTemp) {
+         LOG_0(Trace_Warning, "WARNING AllocateCommand nullptr == pCommand->m_aTemp");
+         FreeCommand(pCommand);
+         return nullptr;
+      }
+   }
+
+   return pCommand;
+}
+
+// Every slice after the first is a whole number of packed words, and the first slice takes the remainder so that it
+// contains the partially filled first packed word. This is the same layout that the kernels use for a whole subset.
+static size_t GetSliceGroups(
+   const size_t cGroups,
+   const size_t cSIMDPack,
+   const int cPack,
+   size_t * const pcGroupsFirstOut
+) {
+   EBM_ASSERT(1 <= cGroups);
+   EBM_ASSERT(1 <= cSIMDPack);
+
+   const size_t cGroupsAlign = k_cItemsPerBitPackNone == cPack ? size_t { 1 } : static_cast<size_t>(cPack);
+   const size_t cGroupsSliceMin = EbmMax(k_cSamplesSliceMin / cSIMDPack, size_t { 1 });
+
+   const size_t cSlicesMax = EbmMax(EbmMin(k_cSlicesMax, cGroups / cGroupsSliceMin), size_t { 1 });
+
+   size_t cGroupsPerSlice = (cGroups + cSlicesMax - size_t { 1 }) / cSlicesMax;
+   cGroupsPerSlice = (cGroupsPerSlice + cGroupsAlign - size_t { 1 }) / cGroupsAlign * cGroupsAlign;
+
+   const size_t cSlices = (cGroups + cGroupsPerSlice - size_t { 1 }) / cGroupsPerSlice;
+   EBM_ASSERT(1 <= cSlices);
+   EBM_ASSERT(cSlices <= cSlicesMax);
+
+   *pcGroupsFirstOut = cGroups - cGroupsPerSlice * (cSlices - size_t { 1 });
+   EBM_ASSERT(1 <= *pcGroupsFirstOut);
+   EBM_ASSERT(*pcGroupsFirstOut <= cGroupsPerSlice);
+
+   return cGroupsPerSlice;
+}
+
+static size_t GetCountPackedBytes(const size_t cGroups, const size_t cSIMDPack, const int cPack, const size_t cUIntBytes) {
+   EBM_ASSERT(k_cItemsPerBitPackNone != cPack);
+   EBM_ASSERT(1 <= cPack);
+   const size_t cWords = (cGroups - size_t { 1 }) / static_cast<size_t>(cPack) + size_t { 1 };
+   return cWords * cSIMDPack * cUIntBytes;
+}
+
+static size_t GetFastBinSize(const ObjectiveWrapper * const pObjective, const bool bHessian, const size_t cScores) {
+   if(sizeof(UIntBig) == pObjective->m_cUIntBytes) {
+      if(sizeof(FloatBig) == pObjective->m_cFloatBytes) {
+         return GetBinSize<FloatBig, UIntBig>(bHessian, cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pObjective->m_cFloatBytes);
+         return GetBinSize<FloatSmall, UIntBig>(bHessian, cScores);
+      }
+   } else {
+      EBM_ASSERT(sizeof(UIntSmall) == pObjective->m_cUIntBytes);
+      if(sizeof(FloatBig) == pObjective->m_cFloatBytes) {
+         return GetBinSize<FloatBig, UIntSmall>(bHessian, cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pObjective->m_cFloatBytes);
+         return GetBinSize<FloatSmall, UIntSmall>(bHessian, cScores);
+      }
+   }
+}
+
+static ErrorEbm ExecuteSlice(OffloadCommand * const pCommand, const size_t iWorker, const size_t iSlice) {
+   if(nullptr != pCommand->m_pHostSlice) {
+      const size_t * const aiGroups = static_cast<const size_t *>(pCommand->m_aSlices);
+      const size_t iGroupEnd = pCommand->m_cSlices == iSlice + size_t { 1 } ? pCommand->m_cHostGroups : aiGroups[iSlice + 1];
+      return (*pCommand->m_pHostSlice)(pCommand->m_pHostContext, iWorker, iSlice, aiGroups[iSlice], 
+         iGroupEnd - aiGroups[iSlice]);
+   }
+   if(nullptr != pCommand->m_pTouch) {
+      const size_t * const aiBytes = static_cast<const size_t *>(pCommand->m_aSlices);
+      const size_t iByteEnd = pCommand->m_cSlices == iSlice + size_t { 1 } ? pCommand->m_cBytesTouch : aiBytes[iSlice + 1];
+      memset(IndexByte(pCommand->m_pTouch, aiBytes[iSlice]), 0, iByteEnd - aiBytes[iSlice]);
+      return Error_None;
+   }
+
+   const ObjectiveWrapper * const pObjective = pCommand->m_pObjective;
+   if(pCommand->m_bBinSums) {
+      BinSumsBoostingBridge * const pParams = &static_cast<BinSumsBoostingBridge *>(pCommand->m_aSlices)[iSlice];
+      memset(pParams->m_aFastBins, 0, pCommand->m_cBytesTempPerSlice);
+      if(size_t { 0 } != pCommand->m_cQuantizedWords) {
+         return (*pObjective->m_pBinSumsBoostingQuantizedC)(pObjective, pParams);
+      }
+      return (*pObjective->m_pBinSumsBoostingC)(pObjective, pParams);
+   } else {
+      ApplyUpdateBridge * const pData = &static_cast<ApplyUpdateBridge *>(pCommand->m_aSlices)[iSlice];
+      return (*pObjective->m_pApplyUpdateC)(pObjective, pData);
+   }
+}
+
+// quantized bins hold int64_t words, or doubles when there are weights, which are added as they are
+static void AddQuantizedWords(const bool bDouble, const size_t cWords, const void * const aSrc, void * const aAddDest) {
+   EBM_ASSERT(1 <= cWords);
+   if(bDouble) {
+      const double * pSrc = static_cast<const double *>(aSrc);
+      double * pDest = static_cast<double *>(aAddDest);
+      const double * const pDestEnd = pDest + cWords;
+      do {
+         *pDest += *pSrc;
+         ++pSrc;
+         ++pDest;
+      } while(pDestEnd != pDest);
+   } else {
+      const int64_t * pSrc = static_cast<const int64_t *>(aSrc);
+      int64_t * pDest = static_cast<int64_t *>(aAddDest);
+      const int64_t * const pDestEnd = pDest + cWords;
+      do {
+         *pDest += *pSrc;
+         ++pSrc;
+         ++pDest;
+      } while(pDestEnd != pDest);
+   }
+}
+
+static void AddSliceBins(const OffloadCommand * const pCommand, const size_t iSliceBegin, const size_t iSliceEnd, void * const aAddDest) {
+   EBM_ASSERT(iSliceBegin < iSliceEnd);
+   const BinSumsBoostingBridge * const aParams = static_cast<const BinSumsBoostingBridge *>(pCommand->m_aSlices);
+   const ObjectiveWrapper * const pObjective = pCommand->m_pObjective;
+   size_t iSlice = iSliceBegin;
+   do {
+      if(size_t { 0 } != pCommand->m_cQuantizedWords) {
+         AddQuantizedWords(pCommand->m_bQuantizedDouble, pCommand->m_cQuantizedWords * pCommand->m_cBins,
+            aParams[iSlice].m_aFastBins, aAddDest);
+         ++iSlice;
+         continue;
+      }
+      ConvertAddBin(
+         aParams[iSlice].m_cScores,
+         EBM_FALSE != aParams[iSlice].m_bHessian,
+         pCommand->m_cBins,
+         sizeof(UIntBig) == pObjective->m_cUIntBytes,
+         sizeof(FloatBig) == pObjective->m_cFloatBytes,
+         aParams[iSlice].m_aFastBins,
+         std::is_same<UIntMain, uint64_t>::value,
+         std::is_same<FloatMain, double>::value,
+         aAddDest
+      );
+      ++iSlice;
+   } while(iSliceEnd != iSlice);
+}
+
+static size_t GetBlockSlices(const OffloadCommand * const pCommand, const size_t iBlock) {
+   return EbmMin(k_cSlicesPerBlock, pCommand->m_cSlices - iBlock * k_cSlicesPerBlock);
+}
+
+static void ReduceBlock(const OffloadCommand * const pCommand, const size_t iBlock) {
+   void * const aBlockBins = IndexByte(pCommand->m_aBlockBins, pCommand->m_cBytesBlockBins * iBlock);
+   memset(aBlockBins, 0, pCommand->m_cBytesBlockBins);
+   const size_t iSliceBegin = iBlock * k_cSlicesPerBlock;
+   AddSliceBins(pCommand, iSliceBegin, iSliceBegin + GetBlockSlices(pCommand, iBlock), aBlockBins);
+}
+
+static void FinishCommand(const OffloadCommand * const pCommand) {
+   // we reduce in slice order, which keeps our results deterministic no matter which thread finished first
+   if(pCommand->m_bBinSums) {
+      if(size_t { 0 } == pCommand->m_cBlocks) {
+         AddSliceBins(pCommand, 0, pCommand->m_cSlices, pCommand->m_aMainBinsAddOut);
+      } else {
+         const BinSumsBoostingBridge * const aParams = static_cast<const BinSumsBoostingBridge *>(pCommand->m_aSlices);
+         size_t iBlock = 0;
+         do {
+            if(size_t { 0 } != pCommand->m_cQuantizedWords) {
+               AddQuantizedWords(pCommand->m_bQuantizedDouble, pCommand->m_cQuantizedWords * pCommand->m_cBins,
+                  IndexByte(pCommand->m_aBlockBins, pCommand->m_cBytesBlockBins * iBlock), pCommand->m_aMainBinsAddOut);
+               ++iBlock;
+               continue;
+            }
+            ConvertAddBin(
+               aParams[0].m_cScores,
+               EBM_FALSE != aParams[0].m_bHessian,
+               pCommand->m_cBins,
+               std::is_same<UIntMain, uint64_t>::value,
+               std::is_same<FloatMain, double>::value,
+               IndexByte(pCommand->m_aBlockBins, pCommand->m_cBytesBlockBins * iBlock),
+               std::is_same<UIntMain, uint64_t>::value,
+               std::is_same<FloatMain, double>::value,
+               pCommand->m_aMainBinsAddOut
+            );
+            ++iBlock;
+         } while(pCommand->m_cBlocks != iBlock);
+      }
+   } else if(nullptr != pCommand->m_pMetricAddOut) {
+      const ApplyUpdateBridge * const aData = static_cast<const ApplyUpdateBridge *>(pCommand->m_aSlices);
+      double metricSum = 0.0;
+      size_t iSlice = 0;
+      do {
+         metricSum += aData[iSlice].m_metricOut;
+         ++iSlice;
+      } while(pCommand->m_cSlices != iSlice);
+      *pCommand->m_pMetricAddOut += metricSum;
+
+      if(nullptr != pCommand->m_aMetricBins) {
+         EBM_ASSERT(nullptr != pCommand->m_aMetricBinsAddOut);
+         const double * pMetricBin = pCommand->m_aMetricBins;
+         iSlice = 0;
+         do {
+            size_t iMetricBin = 0;
+            do {
+               pCommand->m_aMetricBinsAddOut[iMetricBin] += pMetricBin[iMetricBin];
+               ++iMetricBin;
+            } while(pCommand->m_cMetricBins != iMetricBin);
+            pMetricBin += pCommand->m_cMetricBins;
+            ++iSlice;
+         } while(pCommand->m_cSlices != iSlice);
+      }
+   }
+}
+
+void OffloadQueue::WorkerThread(const size_t iWorker) {
+#if defined(__linux__)
+   if(m_bPinThreads && 0 <= m_aWorkerCpus[iWorker]) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(m_aWorkerCpus[iWorker], &cpus);
+      if(0 != sched_setaffinity(0, sizeof(cpus), &cpus)) {
+         // we still work unpinned, but the OS might move us away from the memory of our slices
+         LOG_0(Trace_Warning, "WARNING OffloadQueue::WorkerThread 0 != sched_setaffinity(0, sizeof(cpus), &cpus)");
+      }
+   }
+#endif // __linux__
+
+   size_t iCommandSeen = 0;
+   std::unique_lock<std::mutex> lock(m_mutex);
+   while(true) {
+      // commands execute in submission order, so only the slices of the head command are ever available
+      OffloadCommand * const pCommand = m_pHead;
+      if(nullptr == pCommand || iCommandSeen == pCommand->m_iCommand) {
+         if(m_bStop) {
+            return;
+         }
+         m_conditionWork.wait(lock);
+         continue;
+      }
+      iCommandSeen = pCommand->m_iCommand;
+
+      // our slices are a contiguous run, which is empty if the command has fewer slices than we have workers.
+      // Until every slice is done nobody frees the command, so it stays valid while we work through our run
+      const size_t cSlices = pCommand->m_cSlices;
+      const size_t iSliceEnd = GetWorkerSliceFirst(iWorker + size_t { 1 }, cSlices);
+      bool bFinish = false;
+      for(size_t iSlice = GetWorkerSliceFirst(iWorker, cSlices); iSliceEnd != iSlice; ++iSlice) {
+         lock.unlock();
+         const ErrorEbm error = ExecuteSlice(pCommand, iWorker, iSlice);
+         lock.lock();
+
+         if(Error_None != error && Error_None == m_error) {
+            m_error = error;
+         }
+
+         ++pCommand->m_cSlicesDone;
+         bFinish = cSlices == pCommand->m_cSlicesDone;
+         if(size_t { 0 } != pCommand->m_cBlocks) {
+            bFinish = false;
+            const size_t iBlock = iSlice / k_cSlicesPerBlock;
+            ++pCommand->m_acBlockSlicesDone[iBlock];
+            if(GetBlockSlices(pCommand, iBlock) == pCommand->m_acBlockSlicesDone[iBlock]) {
+               // the last worker of the block to finish reduces it. The workers are ordered by node, so the
+               // other slices of the block were usually also written on our node
+               lock.unlock();
+               ReduceBlock(pCommand, iBlock);
+               lock.lock();
+
+               ++pCommand->m_cBlocksDone;
+               bFinish = pCommand->m_cBlocks == pCommand->m_cBlocksDone;
+            }
+         }
+      }
+      if(bFinish) {
+         // all the other slices have finished, so nobody else is referencing this command. The next command
+         // cannot start until we remove this one from the head, which keeps the reductions in submission order
+         lock.unlock();
+         FinishCommand(pCommand);
+         lock.lock();
+
+         EBM_ASSERT(pCommand == m_pHead);
+         m_pHead = pCommand->m_pNext;
+         if(nullptr == m_pHead) {
+            m_pTail = nullptr;
+            m_conditionIdle.notify_all();
+         }
+         FreeCommand(pCommand);
+         m_conditionWork.notify_all();
+      }
+   }
+}
+
+void OffloadQueue::Enqueue(OffloadCommand * const pCommand) {
+   EBM_ASSERT(nullptr != pCommand);
+   EBM_ASSERT(nullptr == pCommand->m_pNext);
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      ++m_iCommandPrev;
+      pCommand->m_iCommand = m_iCommandPrev;
+      if(nullptr == m_pTail) {
+         EBM_ASSERT(nullptr == m_pHead);
+         m_pHead = pCommand;
+      } else {
+         m_pTail->m_pNext = pCommand;
+      }
+      m_pTail = pCommand;
+   }
+   m_conditionWork.notify_all();
+}
+
+#if defined(__linux__)
+// sets aCpuNodes[iCpu] to iNode for the CPUs in a list like "0-7,16-23"
+static void ParseNodeCpuList(const char * s, const size_t iNode, size_t * const aCpuNodes) {
+   while('0' <= *s && *s <= '9') {
+      char * sEnd;
+      const unsigned long iCpuFirst = strtoul(s, &sEnd, 10);
+      unsigned long iCpuLast = iCpuFirst;
+      s = sEnd;
+      if('-' == *s) {
+         ++s;
+         iCpuLast = strtoul(s, &sEnd, 10);
+         s = sEnd;
+      }
+      for(unsigned long iCpu = iCpuFirst; iCpu <= iCpuLast && iCpu < static_cast<unsigned long>(k_cCpusMax); ++iCpu) {
+         aCpuNodes[iCpu] = iNode;
+      }
+      if(',' != *s) {
+         break;
+      }
+      ++s;
+   }
+}
+#endif // __linux__
+
+// Fills aCpusOut with the CPUs that we are allowed to run on, ordered by NUMA node id, and aNodeIdsOut with the node
+// id of every CPU, indexed by CPU. Both must hold k_cCpusMax items. Returns the number of CPUs, or 0 if we cannot tell, in which case
+// the OS decides where our threads run.
+static size_t GetCpuTopology(int * const aCpusOut, size_t * const aNodeIdsOut) {
+#if defined(__linux__)
+   cpu_set_t allowed;
+   CPU_ZERO(&allowed);
+   if(0 != sched_getaffinity(0, sizeof(allowed), &allowed)) {
+      LOG_0(Trace_Warning, "WARNING GetCpuTopology 0 != sched_getaffinity(0, sizeof(allowed), &allowed)");
+      return 0;
+   }
+
+   // CPUs that no node lists stay on node 0, which is also what we get when the kernel has no NUMA support
+   for(size_t iCpu = 0; iCpu < k_cCpusMax; ++iCpu) {
+      aNodeIdsOut[iCpu] = 0;
+   }
+   size_t cNodeIds = 1;
+   for(size_t iNode = 0; iNode < k_cNodeIdsMax; ++iNode) {
+      char sPath[64];
+      snprintf(sPath, sizeof(sPath) / sizeof(sPath[0]), "/sys/devices/system/node/node%zu/cpulist", iNode);
+      FILE * const pFile = fopen(sPath, "r");
+      if(nullptr == pFile) {
+         // node ids can have gaps, so keep looking
+         continue;
+      }
+      char sCpus[4096];
+      if(nullptr != fgets(sCpus, sizeof(sCpus) / sizeof(sCpus[0]), pFile)) {
+         ParseNodeCpuList(sCpus, iNode, aNodeIdsOut);
+         cNodeIds = iNode + size_t { 1 };
+      }
+      fclose(pFile);
+   }
+
+   // a stable sort by node through one pass per node id, which is cheap for the few nodes that exist
+   int * pCpu = aCpusOut;
+   for(size_t iNode = 0; iNode < cNodeIds; ++iNode) {
+      for(size_t iCpu = 0; iCpu < k_cCpusMax; ++iCpu) {
+         if(CPU_ISSET(iCpu, &allowed) && iNode == aNodeIdsOut[iCpu]) {
+            *pCpu = static_cast<int>(iCpu);
+            ++pCpu;
+         }
+      }
+   }
+   return static_cast<size_t>(pCpu - aCpusOut);
+#else // __linux__
+   UNUSED(aCpusOut);
+   UNUSED(aNodeIdsOut);
+   return 0;
+#endif // __linux__
+}
+
+ErrorEbm OffloadQueue::Create(const bool bPinThreads, OffloadQueue ** const ppOffloadQueueOut) {
+   LOG_0(Trace_Info, "Entered OffloadQueue::Create");
+
+   EBM_ASSERT(nullptr != ppOffloadQueueOut);
+   EBM_ASSERT(nullptr == *ppOffloadQueueOut);
+
+   OffloadQueue * pOffloadQueue;
+   try {
+      pOffloadQueue = new OffloadQueue();
+   } catch(const std::bad_alloc &) {
+      LOG_0(Trace_Warning, "WARNING OffloadQueue::Create Out of memory allocating OffloadQueue");
+      return Error_OutOfMemory;
+   } catch(...) {
+      LOG_0(Trace_Warning, "WARNING OffloadQueue::Create Unknown error");
+      return Error_UnexpectedInternal;
+   }
+   if(nullptr == pOffloadQueue) {
+      // this should be impossible since bad_alloc should have been thrown, but let's be untrusting
+      LOG_0(Trace_Warning, "WARNING OffloadQueue::Create nullptr == pOffloadQueue");
+      return Error_OutOfMemory;
+   }
+   // give ownership of our object back to the caller, even if there is a failure
+   *ppOffloadQueueOut = pOffloadQueue;
+
+   int * const aCpus = static_cast<int *>(malloc(sizeof(int) * k_cCpusMax));
+   size_t * const aNodeIds = static_cast<size_t *>(malloc(sizeof(size_t) * k_cCpusMax));
+   if(nullptr == aCpus || nullptr == aNodeIds) {
+      LOG_0(Trace_Warning, "WARNING OffloadQueue::Create nullptr == aCpus || nullptr == aNodeIds");
+      free(aNodeIds);
+      free(aCpus);
+      return Error_OutOfMemory;
+   }
+   const size_t cCpus = GetCpuTopology(aCpus, aNodeIds);
+
+   size_t cThreads;
+   if(size_t { 0 } == cCpus) {
+      // hardware_concurrency is allowed to return 0 if the value is not computable
+      cThreads = EbmMin(EbmMax(static_cast<size_t>(std::thread::hardware_concurrency()), size_t { 1 }), k_cThreadsMax);
+   } else {
+      // use the CPUs we were given (by numactl or taskset for instance) rather than all of the machine's
+      cThreads = EbmMin(cCpus, k_cThreadsMax);
+   }
+
+   pOffloadQueue->m_bPinThreads = bPinThreads;
+   pOffloadQueue->m_aWorkerCpus = static_cast<int *>(malloc(sizeof(int) * cThreads));
+   if(nullptr == pOffloadQueue->m_aWorkerCpus) {
+      LOG_0(Trace_Warning, "WARNING OffloadQueue::Create nullptr == pOffloadQueue->m_aWorkerCpus");
+      free(aNodeIds);
+      free(aCpus);
+      return Error_OutOfMemory;
+   }
+
+   // with more CPUs than threads, take evenly spaced CPUs so that each node gets its share of the threads
+   size_t cNodes = 1;
+   for(size_t iWorker = 0; iWorker < cThreads; ++iWorker) {
+      int iCpu = -1;
+      if(size_t { 0 } != cCpus) {
+         iCpu = aCpus[iWorker * cCpus / cThreads];
+         if(size_t { 0 } != iWorker && aNodeIds[iCpu] != aNodeIds[pOffloadQueue->m_aWorkerCpus[iWorker - 1]]) {
+            ++cNodes;
+         }
+      }
+      pOffloadQueue->m_aWorkerCpus[iWorker] = iCpu;
+   }
+
+   free(aNodeIds);
+   free(aCpus);
+
+   pOffloadQueue->m_aThreads = static_cast<std::thread *>(malloc(sizeof(std::thread) * cThreads));
+   if(nullptr == pOffloadQueue->m_aThreads) {
+      LOG_0(Trace_Warning, "WARNING OffloadQueue::Create nullptr == pOffloadQueue->m_aThreads");
+      return Error_OutOfMemory;
+   }
+
+   do {
+      try {
+         new(&pOffloadQueue->m_aThreads[pOffloadQueue->m_cThreads]) std::thread(&OffloadQueue::WorkerThread, pOffloadQueue, pOffloadQueue->m_cThreads);
+      } catch(const std::bad_alloc &) {
+         LOG_0(Trace_Warning, "WARNING OffloadQueue::Create thread start out of memory");
+         return Error_OutOfMemory;
+      } catch(...) {
+         // the C++ standard doesn't really seem to say what kind of exceptions we'd get for various errors, so
+         // about the best we can do is catch(...) since the exact exceptions seem to be implementation specific
+         LOG_0(Trace_Warning, "WARNING OffloadQueue::Create thread start failed");
+         return Error_ThreadStartFailed;
+      }
+      ++pOffloadQueue->m_cThreads;
+   } while(cThreads != pOffloadQueue->m_cThreads);
+
+   LOG_N(Trace_Info, "Exited OffloadQueue::Create with %zu threads on %zu nodes", cThreads, cNodes);
+
+   return Error_None;
+}
+
+void OffloadQueue::Free(OffloadQueue * const pOffloadQueue) {
+   if(nullptr != pOffloadQueue) {
+      // any errors have already been returned to whoever submitted the commands, so ignore them here
+      pOffloadQueue->Synchronize();
+      {
+         std::lock_guard<std::mutex> lock(pOffloadQueue->m_mutex);
+         pOffloadQueue->m_bStop = true;
+      }
+      pOffloadQueue->m_conditionWork.notify_all();
+
+      for(size_t iThread = 0; iThread < pOffloadQueue->m_cThreads; ++iThread) {
+         std::thread * const pThread = &pOffloadQueue->m_aThreads[iThread];
+         pThread->join();
+         pThread->~thread();
+      }
+      delete pOffloadQueue;
+   }
+}
+
+void * OffloadQueue::AllocateDevice(const size_t cBytes, const size_t cGroups, const size_t cSIMDPack) {
+   // the host backend shares memory with the host, so device memory is just aligned host memory
+   void * const pDevice = AlignedAlloc(cBytes);
+   if(nullptr != pDevice) {
+      FirstTouch(pDevice, cBytes, cGroups, cSIMDPack);
+   }
+   return pDevice;
+}
+
+void OffloadQueue::FreeDevice(void * const pDevice) {
+   AlignedFree(pDevice);
+}
+
+void OffloadQueue::FirstTouch(void * const p, const size_t cBytes, const size_t cGroups, const size_t cSIMDPack) {
+   EBM_ASSERT(nullptr != p);
+   EBM_ASSERT(1 <= cBytes);
+   EBM_ASSERT(1 <= cGroups);
+
+   // The commands align their slices to the packing of each term, which moves the slice boundaries by less than
+   // a packed word, so the unpacked layout is close enough for every buffer of the subset. The buffer is split in
+   // proportion to the groups since the packed term data is not an exact multiple of them.
+   size_t cGroupsFirst;
+   const size_t cGroupsPerSlice = GetSliceGroups(cGroups, cSIMDPack, k_cItemsPerBitPackNone, &cGroupsFirst);
+   const size_t cSlices = (cGroups - cGroupsFirst) / cGroupsPerSlice + size_t { 1 };
+
+   OffloadCommand * const pCommand = AllocateCommand(false, cSlices, sizeof(size_t), 0);
+   if(nullptr == pCommand) {
+      // the placement is only an optimization, so leave the pages to be faulted in by whoever writes them first
+      return;
+   }
+   pCommand->m_pTouch = p;
+   pCommand->m_cBytesTouch = cBytes;
+
+   const size_t cBytesPerGroup = cBytes / cGroups;
+   const size_t cBytesRemainder = cBytes % cGroups;
+   size_t * const aiBytes = static_cast<size_t *>(pCommand->m_aSlices);
+   size_t iGroup = 0;
+   size_t iSlice = 0;
+   do {
+      aiBytes[iSlice] = cBytesPerGroup * iGroup + cBytesRemainder * iGroup / cGroups;
+      iGroup += size_t { 0 } == iSlice ? cGroupsFirst : cGroupsPerSlice;
+      ++iSlice;
+   } while(cSlices != iSlice);
+
+   Enqueue(pCommand);
+
+   // the caller writes the buffer next, so the pages need to be placed before we return. Touching cannot fail, so
+   // leave any error from earlier commands for Synchronize to return
+   std::unique_lock<std::mutex> lock(m_mutex);
+   WaitIdle(lock);
+}
+
+ErrorEbm OffloadQueue::EnqueueApplyUpdate(
+   const ObjectiveWrapper * const pObjective,
+   const ApplyUpdateBridge * const pData,
+   const size_t cTargetBytes,
+   double * const pMetricAddOut
+) {
+   EBM_ASSERT(nullptr != pObjective);
+   EBM_ASSERT(nullptr != pData);
+   EBM_ASSERT(1 <= pData->m_cSamples);
+   EBM_ASSERT(EBM_FALSE == pData->m_bValidation || nullptr != pMetricAddOut);
+
+   const size_t cSIMDPack = pObjective->m_cSIMDPack;
+   const size_t cFloatBytes = pObjective->m_cFloatBytes;
+   const size_t cScores = pData->m_cScores;
+
+   EBM_ASSERT(0 == pData->m_cSamples % cSIMDPack);
+
+   size_t cGroupsFirst;
+   const size_t cGroupsPerSlice = GetSliceGroups(pData->m_cSamples / cSIMDPack, cSIMDPack, pData->m_cPack, &cGroupsFirst);
+   const size_t cSlices = (pData->m_cSamples / cSIMDPack - cGroupsFirst) / cGroupsPerSlice + size_t { 1 };
+
+   // the multiclass kernels share a temporary buffer, so give each slice its own
+   size_t cBytesTempPerSlice = 0;
+   if(nullptr != pData->m_aMulticlassMidwayTemp) {
+      cBytesTempPerSlice = cFloatBytes * cScores * cSIMDPack;
+      cBytesTempPerSlice = (cBytesTempPerSlice + SIMD_BYTE_ALIGNMENT - size_t { 1 }) / SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+   }
+
+   OffloadCommand * const pCommand = AllocateCommand(false, cSlices, sizeof(ApplyUpdateBridge), cBytesTempPerSlice);
+   if(nullptr == pCommand) {
+      return Error_OutOfMemory;
+   }
+   pCommand->m_pObjective = pObjective;
+   pCommand->m_pMetricAddOut = EBM_FALSE != pData->m_bValidation ? pMetricAddOut : nullptr;
+
+   if(nullptr != pData->m_aMetricBins) {
+      // the slices run in parallel, so each fills its own histogram
+      EBM_ASSERT(EBM_FALSE != pData->m_bValidation);
+      EBM_ASSERT(1 <= pData->m_cMetricBins);
+      if(IsMultiplyError(sizeof(double), pData->m_cMetricBins, cSlices)) {
+         LOG_0(Trace_Warning, "WARNING OffloadQueue::EnqueueApplyUpdate IsMultiplyError(sizeof(double), pData->m_cMetricBins, cSlices)");
+         FreeCommand(pCommand);
+         return Error_OutOfMemory;
+      }
+      const size_t cBytesMetricBins = sizeof(double) * pData->m_cMetricBins * cSlices;
+      pCommand->m_aMetricBins = static_cast<double *>(malloc(cBytesMetricBins));
+      if(nullptr == pCommand->m_aMetricBins) {
+         LOG_0(Trace_Warning, "WARNING OffloadQueue::EnqueueApplyUpdate nullptr == pCommand->m_aMetricBins");
+         FreeCommand(pCommand);
+         return Error_OutOfMemory;
+      }
+      memset(pCommand->m_aMetricBins, 0, cBytesMetricBins);
+      pCommand->m_cMetricBins = pData->m_cMetricBins;
+      pCommand->m_aMetricBinsAddOut = pData->m_aMetricBins;
+   }
+
+   const size_t cBytesGradHessPerSample = cFloatBytes * cScores * (EBM_FALSE != pData->m_bHessianNeeded ? size_t { 2 } : size_t { 1 });
+
+   ApplyUpdateBridge data = *pData;
+   ApplyUpdateBridge * pSlice = static_cast<ApplyUpdateBridge *>(pCommand->m_aSlices);
+   size_t cGroups = cGroupsFirst;
+   size_t iSlice = 0;
+   do {
+      const size_t cSamples = cGroups * cSIMDPack;
+
+      *pSlice = data;
+      pSlice->m_cSamples = cSamples;
+      pSlice->m_metricOut = 0.0;
+      if(nullptr != pCommand->m_aTemp) {
+         pSlice->m_aMulticlassMidwayTemp = IndexByte(pCommand->m_aTemp, cBytesTempPerSlice * iSlice);
+      }
+      if(nullptr != pCommand->m_aMetricBins) {
+         pSlice->m_aMetricBins = pCommand->m_aMetricBins + pCommand->m_cMetricBins * iSlice;
+      }
+
+      if(k_cItemsPerBitPackNone != data.m_cPack) {
+         data.m_aPacked = IndexByte(data.m_aPacked, GetCountPackedBytes(cGroups, cSIMDPack, data.m_cPack, pObjective->m_cUIntBytes));
+      }
+      if(nullptr != data.m_aTargets) {
+         data.m_aTargets = IndexByte(data.m_aTargets, cSamples * cTargetBytes);
+      }
+      if(nullptr != data.m_aWeights) {
+         data.m_aWeights = IndexByte(data.m_aWeights, cSamples * cFloatBytes);
+      }
+      if(nullptr != data.m_aSampleScores) {
+         data.m_aSampleScores = IndexByte(data.m_aSampleScores, cSamples * cScores * cFloatBytes);
+      }
+      if(nullptr != data.m_aGradientsAndHessians) {
+         data.m_aGradientsAndHessians = IndexByte(data.m_aGradientsAndHessians, cSamples * cBytesGradHessPerSample);
+      }
+
+      cGroups = cGroupsPerSlice;
+      ++pSlice;
+      ++iSlice;
+   } while(cSlices != iSlice);
+
+   Enqueue(pCommand);
+   return Error_None;
+}
+
+// cBytesBin is the size of the bins that the blocks are reduced into, which are the main bins or the quantized words
+static ErrorEbm InitBlockReduction(OffloadCommand * const pCommand, const size_t cBytesBin) {
+   const size_t cBlocks = (pCommand->m_cSlices + k_cSlicesPerBlock - size_t { 1 }) / k_cSlicesPerBlock;
+   if(size_t { 1 } == cBlocks) {
+      // a single block is the same as adding the slices straight into the main bins
+      return Error_None;
+   }
+
+   if(IsMultiplyError(cBytesBin, pCommand->m_cBins, cBlocks)) {
+      LOG_0(Trace_Warning, "WARNING InitBlockReduction IsMultiplyError(cBytesBin, pCommand->m_cBins, cBlocks)");
+      return Error_OutOfMemory;
+   }
+   size_t cBytesBlockBins = cBytesBin * pCommand->m_cBins;
+   // keep each block's bins on their own cache lines so that the blocks do not share lines while they reduce
+   cBytesBlockBins = (cBytesBlockBins + SIMD_BYTE_ALIGNMENT - size_t { 1 }) / SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+
+   pCommand->m_acBlockSlicesDone = static_cast<size_t *>(malloc(sizeof(size_t) * cBlocks));
+   if(nullptr == pCommand->m_acBlockSlicesDone) {
+      LOG_0(Trace_Warning, "WARNING InitBlockReduction nullptr == pCommand->m_acBlockSlicesDone");
+      return Error_OutOfMemory;
+   }
+   memset(pCommand->m_acBlockSlicesDone, 0, sizeof(size_t) * cBlocks);
+
+   pCommand->m_aBlockBins = AlignedAlloc(cBytesBlockBins * cBlocks);
+   if(nullptr == pCommand->m_aBlockBins) {
+      LOG_0(Trace_Warning, "WARNING InitBlockReduction nullptr == pCommand->m_aBlockBins");
+      return Error_OutOfMemory;
+   }
+   pCommand->m_cBytesBlockBins = cBytesBlockBins;
+   pCommand->m_cBlocks = cBlocks;
+
+   return Error_None;
+}
+
+ErrorEbm OffloadQueue::EnqueueBinSumsBoosting(
+   const ObjectiveWrapper * const pObjective,
+   const BinSumsBoostingBridge * const pParams,
+   const size_t cBins,
+   void * const aMainBinsAddOut
+) {
+   return EnqueueBinSums(false, pObjective, pParams, cBins, aMainBinsAddOut);
+}
+
+ErrorEbm OffloadQueue::EnqueueBinSumsBoostingQuantized(
+   const ObjectiveWrapper * const pObjective,
+   const BinSumsBoostingBridge * const pParams,
+   const size_t cBins,
+   void * const aQuantizedBinsAddOut
+) {
+   return EnqueueBinSums(true, pObjective, pParams, cBins, aQuantizedBinsAddOut);
+}
+
+ErrorEbm OffloadQueue::EnqueueBinSums(
+   const bool bQuantized,
+   const ObjectiveWrapper * const pObjective,
+   const BinSumsBoostingBridge * const pParams,
+   const size_t cBins,
+   void * const aMainBinsAddOut
+) {
+   EBM_ASSERT(nullptr != pObjective);
+   EBM_ASSERT(nullptr != pParams);
+   EBM_ASSERT(1 <= pParams->m_cSamples);
+   EBM_ASSERT(1 <= cBins);
+   EBM_ASSERT(nullptr != aMainBinsAddOut);
+
+   const size_t cSIMDPack = pObjective->m_cSIMDPack;
+   const size_t cFloatBytes = pObjective->m_cFloatBytes;
+   const size_t cScores = pParams->m_cScores;
+   const bool bHessian = EBM_FALSE != pParams->m_bHessian;
+
+   EBM_ASSERT(0 == pParams->m_cSamples % cSIMDPack);
+
+   size_t cGroupsFirst;
+   const size_t cGroupsPerSlice = GetSliceGroups(pParams->m_cSamples / cSIMDPack, cSIMDPack, pParams->m_cPack, &cGroupsFirst);
+   const size_t cSlices = (pParams->m_cSamples / cSIMDPack - cGroupsFirst) / cGroupsPerSlice + size_t { 1 };
+
+   // the quantized kernels sum into 64 bit words, and those words are what the slices and the blocks add together
+   const size_t cQuantizedWords = bQuantized ? k_cQuantizedBinHeaderWords + (bHessian ? cScores << 1 : cScores) :
+      size_t { 0 };
+   static_assert(sizeof(int64_t) == sizeof(double), "the quantized bin words are either int64_t or double");
+   const size_t cBytesPerFastBin = bQuantized ? sizeof(int64_t) * cQuantizedWords : 
+      GetFastBinSize(pObjective, bHessian, cScores);
+   if(IsMultiplyError(cBytesPerFastBin, cBins)) {
+      LOG_0(Trace_Warning, "WARNING OffloadQueue::EnqueueBinSumsBoosting IsMultiplyError(cBytesPerFastBin, cBins)");
+      return Error_OutOfMemory;
+   }
+   size_t cBytesTempPerSlice = cBytesPerFastBin * cBins;
+   cBytesTempPerSlice = (cBytesTempPerSlice + SIMD_BYTE_ALIGNMENT - size_t { 1 }) / SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+
+   OffloadCommand * const pCommand = AllocateCommand(true, cSlices, sizeof(BinSumsBoostingBridge), cBytesTempPerSlice);
+   if(nullptr == pCommand) {
+      return Error_OutOfMemory;
+   }
+   pCommand->m_pObjective = pObjective;
+   pCommand->m_cBins = cBins;
+   pCommand->m_aMainBinsAddOut = aMainBinsAddOut;
+   pCommand->m_cQuantizedWords = cQuantizedWords;
+   pCommand->m_bQuantizedDouble = nullptr != pParams->m_aWeights;
+
+   const ErrorEbm error = InitBlockReduction(pCommand, 
+      bQuantized ? cBytesPerFastBin : GetBinSize<FloatMain, UIntMain>(bHessian, cScores));
+   if(Error_None != error) {
+      FreeCommand(pCommand);
+      return error;
+   }
+
+   const size_t cBytesGradHessPerSample = (bQuantized ? pParams->m_cBytesQuantized : cFloatBytes) * cScores * 
+      (bHessian ? size_t { 2 } : size_t { 1 });
+
+   BinSumsBoostingBridge params = *pParams;
+   BinSumsBoostingBridge * pSlice = static_cast<BinSumsBoostingBridge *>(pCommand->m_aSlices);
+   size_t cGroups = cGroupsFirst;
+   size_t iSlice = 0;
+   do {
+      const size_t cSamples = cGroups * cSIMDPack;
+
+      *pSlice = params;
+      pSlice->m_cSamples = cSamples;
+      pSlice->m_aFastBins = IndexByte(pCommand->m_aTemp, cBytesTempPerSlice * iSlice);
+#ifndef NDEBUG
+      pSlice->m_pDebugFastBinsEnd = IndexByte(pSlice->m_aFastBins, cBytesPerFastBin * cBins);
+#endif // NDEBUG
+
+      if(k_cItemsPerBitPackNone != params.m_cPack) {
+         params.m_aPacked = IndexByte(params.m_aPacked, GetCountPackedBytes(cGroups, cSIMDPack, params.m_cPack, pObjective->m_cUIntBytes));
+      }
+      params.m_aGradientsAndHessians = IndexByte(params.m_aGradientsAndHessians, cSamples * cBytesGradHessPerSample);
+      if(nullptr != params.m_aWeights) {
+         params.m_aWeights = IndexByte(params.m_aWeights, cSamples * cFloatBytes);
+      }
+      if(nullptr != params.m_pCountOccurrences) {
+         params.m_pCountOccurrences += cSamples;
+      }
+
+      cGroups = cGroupsPerSlice;
+      ++pSlice;
+      ++iSlice;
+   } while(cSlices != iSlice);
+
+   Enqueue(pCommand);
+   return Error_None;
+}
+
+ErrorEbm OffloadQueue::EnqueueHostSlices(
+   const HostSliceFunction pFunction,
+   void * const pContext,
+   const size_t cGroups,
+   const size_t cSIMDPack,
+   const int cPack
+) {
+   EBM_ASSERT(nullptr != pFunction);
+   EBM_ASSERT(1 <= cGroups);
+
+   size_t cGroupsFirst;
+   const size_t cGroupsPerSlice = GetSliceGroups(cGroups, cSIMDPack, cPack, &cGroupsFirst);
+   const size_t cSlices = (cGroups - cGroupsFirst) / cGroupsPerSlice + size_t { 1 };
+
+   OffloadCommand * const pCommand = AllocateCommand(false, cSlices, sizeof(size_t), 0);
+   if(nullptr == pCommand) {
+      return Error_OutOfMemory;
+   }
+   pCommand->m_pHostSlice = pFunction;
+   pCommand->m_pHostContext = pContext;
+   pCommand->m_cHostGroups = cGroups;
+
+   size_t * const aiGroups = static_cast<size_t *>(pCommand->m_aSlices);
+   size_t iGroup = 0;
+   size_t iSlice = 0;
+   do {
+      aiGroups[iSlice] = iGroup;
+      iGroup += size_t { 0 } == iSlice ? cGroupsFirst : cGroupsPerSlice;
+      ++iSlice;
+   } while(cSlices != iSlice);
+   EBM_ASSERT(cGroups == iGroup);
+
+   Enqueue(pCommand);
+   return Error_None;
+}
+
+void OffloadQueue::WaitIdle(std::unique_lock<std::mutex> & lock) {
+   while(nullptr != m_pHead) {
+      m_conditionIdle.wait(lock);
+   }
+}
+
+ErrorEbm OffloadQueue::Synchronize() {
+   std::unique_lock<std::mutex> lock(m_mutex);
+   WaitIdle(lock);
+   const ErrorEbm error = m_error;
+   m_error = Error_None;
+   return error;
+}
+
+} // DEFINED_ZONE_NAME
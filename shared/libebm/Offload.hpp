@@ -0,0 +1,172 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef OFFLOAD_HPP
+#define OFFLOAD_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h"
+
+#include "bridge.h" // ObjectiveWrapper, ApplyUpdateBridge, BinSumsBoostingBridge
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+struct OffloadCommand;
+
+// the work of one slice of an EnqueueHostSlices command, which covers cGroups SIMD packs of samples starting at 
+// iGroupFirst. No other slice runs with the same iWorker at the same time, so it can index scratch memory
+typedef ErrorEbm (*HostSliceFunction)(
+   void * const pContext,
+   const size_t iWorker,
+   const size_t iSlice,
+   const size_t iGroupFirst,
+   const size_t cGroups
+);
+
+// OffloadQueue is the seam between the boosting code and a compute device that owns its own memory. Buffers that
+// stay on the device for the lifetime of the booster (the gradients/hessians and the sample scores) are allocated
+// through AllocateDevice, and work is submitted as commands that execute asynchronously, in submission order,
+// until Synchronize is called. The host must not touch device buffers or command outputs before Synchronize.
+//
+// The only backend today is a host backend where "device" memory is ordinary aligned host memory and the commands
+// are executed by a pool of worker threads. Each command is split into slices that start on packed word boundaries
+// so that the compute zone kernels can process them independently. The slices depend only on the number of samples
+// and the packing, never on the number of threads, and commands that produce sums (the validation metric and the
+// bin sums) always add their slices in the same order. Models are therefore identical on any machine and under any
+// CPU restriction for a given seed and compute zone.
+//
+// On Linux the workers are ordered by the NUMA node of the CPU that each one is assigned, and each worker processes
+// a fixed contiguous run of every command's slices, so the slices of a subset are always processed by the same
+// worker. The device buffers, and the host buffers placed with FirstTouch, have each slice's pages faulted in by its
+// worker so that they land on that worker's node. Bin sums are first reduced in fixed blocks of neighbouring slices
+// by the worker that finishes the block, which is usually on the node that produced them, and then the blocks are
+// added together.
+class OffloadQueue final {
+
+   size_t m_cThreads;
+   std::thread * m_aThreads;
+
+   // the CPU that each worker is pinned to (or -1 if unknown). The CPUs are ordered by NUMA node
+   int * m_aWorkerCpus;
+   bool m_bPinThreads;
+
+   std::mutex m_mutex;
+   std::condition_variable m_conditionWork;
+   std::condition_variable m_conditionIdle;
+
+   OffloadCommand * m_pHead;
+   OffloadCommand * m_pTail;
+   size_t m_iCommandPrev;
+   ErrorEbm m_error;
+   bool m_bStop;
+
+   inline OffloadQueue() noexcept :
+      m_cThreads(0),
+      m_aThreads(nullptr),
+      m_aWorkerCpus(nullptr),
+      m_bPinThreads(false),
+      m_pHead(nullptr),
+      m_pTail(nullptr),
+      m_iCommandPrev(0),
+      m_error(Error_None),
+      m_bStop(false) {
+   }
+
+   inline ~OffloadQueue() {
+      // only Free calls us, after our threads have been joined
+      EBM_ASSERT(nullptr == m_pHead);
+      free(m_aWorkerCpus);
+      free(m_aThreads);
+   }
+
+   // each worker gets the contiguous run of slices [iWorker * cSlices / m_cThreads, (iWorker + 1) * cSlices / m_cThreads)
+   // rounded up, which spreads the slices evenly over the workers and so over the nodes
+   inline size_t GetWorkerSliceFirst(const size_t iWorker, const size_t cSlices) const noexcept {
+      EBM_ASSERT(iWorker <= m_cThreads);
+      return (iWorker * cSlices + m_cThreads - size_t { 1 }) / m_cThreads;
+   }
+
+   void WorkerThread(const size_t iWorker);
+   void Enqueue(OffloadCommand * const pCommand);
+   ErrorEbm EnqueueBinSums(
+      const bool bQuantized,
+      const ObjectiveWrapper * const pObjective,
+      const BinSumsBoostingBridge * const pParams,
+      const size_t cBins,
+      void * const aMainBinsAddOut
+   );
+   void WaitIdle(std::unique_lock<std::mutex> & lock);
+
+public:
+
+   // bPinThreads pins each worker to its CPU, which keeps it on the node where its slices' memory was placed
+   static ErrorEbm Create(const bool bPinThreads, OffloadQueue ** const ppOffloadQueueOut);
+   static void Free(OffloadQueue * const pOffloadQueue);
+
+   inline size_t GetCountThreads() const noexcept {
+      return m_cThreads;
+   }
+
+   // cGroups is the number of SIMD packs of samples that the buffer holds, which decides its slices
+   void * AllocateDevice(const size_t cBytes, const size_t cGroups, const size_t cSIMDPack);
+   void FreeDevice(void * const pDevice);
+
+   // faults in the pages of a host buffer that has not been written yet from the workers that will process each of
+   // its slices. Buffers that the commands read on every round, like the targets and the packed bins, go through
+   // this so that they are local to their workers instead of to the thread that built the dataset
+   void FirstTouch(void * const p, const size_t cBytes, const size_t cGroups, const size_t cSIMDPack);
+
+   // the update is applied to all pData->m_cSamples samples, which must be a multiple of the zone SIMD pack.
+   // For validation the metric sum is added to *pMetricAddOut once the command completes
+   ErrorEbm EnqueueApplyUpdate(
+      const ObjectiveWrapper * const pObjective,
+      const ApplyUpdateBridge * const pData,
+      const size_t cTargetBytes,
+      double * const pMetricAddOut
+   );
+
+   // the bins for all pParams->m_cSamples samples are added into aMainBinsAddOut, which use the main zone types.
+   // pParams->m_aFastBins is ignored since each slice sums into its own temporary bins
+   ErrorEbm EnqueueBinSumsBoosting(
+      const ObjectiveWrapper * const pObjective,
+      const BinSumsBoostingBridge * const pParams,
+      const size_t cBins,
+      void * const aMainBinsAddOut
+   );
+
+   // the same as EnqueueBinSumsBoosting for the quantized kernels. Their words are added without conversion into
+   // aQuantizedBinsAddOut, which the caller scales into the main bins after Synchronize
+   ErrorEbm EnqueueBinSumsBoostingQuantized(
+      const ObjectiveWrapper * const pObjective,
+      const BinSumsBoostingBridge * const pParams,
+      const size_t cBins,
+      void * const aQuantizedBinsAddOut
+   );
+
+   // runs pFunction on the slices of cGroups SIMD packs of samples, which are aligned to cPack like those of the
+   // kernel commands. This is for main zone work that has to run next to the kernels, like quantizing gradients
+   ErrorEbm EnqueueHostSlices(
+      const HostSliceFunction pFunction,
+      void * const pContext,
+      const size_t cGroups,
+      const size_t cSIMDPack,
+      const int cPack
+   );
+
+   // waits for all the submitted commands to finish and returns the first error that any of them encountered
+   ErrorEbm Synchronize();
+};
+
+} // DEFINED_ZONE_NAME
+
+#endif // OFFLOAD_HPP
@@ -0,0 +1,161 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef OUTER_BAG_HPP
+#define OUTER_BAG_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+
+#include "libebm.h" // BagEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // INLINE_ALWAYS
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+static constexpr size_t k_cBagBitsPerWord = size_t { 64 };
+
+INLINE_ALWAYS static size_t GetCountBagBitsWords(const size_t cSamples) {
+   return (cSamples + (k_cBagBitsPerWord - size_t { 1 })) / k_cBagBitsPerWord;
+}
+
+INLINE_ALWAYS static size_t CountBitsSet(uint64_t bits) {
+#if defined(__clang__) || defined(__GNUC__)
+   return static_cast<size_t>(__builtin_popcountll(static_cast<unsigned long long>(bits)));
+#else // compiler
+   bits = bits - ((bits >> 1) & uint64_t { 0x5555555555555555 });
+   bits = (bits & uint64_t { 0x3333333333333333 }) + ((bits >> 2) & uint64_t { 0x3333333333333333 });
+   bits = (bits + (bits >> 4)) & uint64_t { 0x0f0f0f0f0f0f0f0f };
+   return static_cast<size_t>((bits * uint64_t { 0x0101010101010101 }) >> 56);
+#endif // compiler
+}
+
+INLINE_ALWAYS static size_t CountTrailingZeros(const uint64_t bits) {
+   EBM_ASSERT(uint64_t { 0 } != bits);
+#if defined(__clang__) || defined(__GNUC__)
+   return static_cast<size_t>(__builtin_ctzll(static_cast<unsigned long long>(bits)));
+#else // compiler
+   // the bits below the lowest set bit become the only set bits
+   return CountBitsSet((bits & (uint64_t { 0 } - bits)) - uint64_t { 1 });
+#endif // compiler
+}
+
+// The outer bag splits the samples of the shared dataset into training and validation. It is either a BagEbm
+// replication count for each sample, or with CreateBoosterFlags_BagBits one bit per sample that is set for training
+// and clear for validation. Without either, every sample is used once for training.
+struct OuterBag final {
+   OuterBag() = default; // preserve our POD status
+   ~OuterBag() = default; // preserve our POD status
+   void * operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete (void *) = delete; // we only use malloc/free in this library
+
+   INLINE_ALWAYS static OuterBag Make(const BagEbm * const aBag, const bool bBits) {
+      OuterBag bag;
+      bag.m_aReplications = bBits ? nullptr : aBag;
+      bag.m_aBits = bBits ? reinterpret_cast<const uint64_t *>(aBag) : nullptr;
+      return bag;
+   }
+
+   INLINE_ALWAYS bool IsEmpty() const {
+      return nullptr == m_aReplications && nullptr == m_aBits;
+   }
+
+   const BagEbm * m_aReplications;
+   const uint64_t * m_aBits;
+};
+static_assert(std::is_standard_layout<OuterBag>::value,
+   "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<OuterBag>::value,
+   "We use memcpy in several places, so disallow non-trivial types in general");
+static_assert(std::is_pod<OuterBag>::value,
+   "We use a lot of C constructs, so disallow non-POD types in general");
+
+// Visits the samples of one direction in order. Next moves to the following sample of the direction and returns how
+// many times it is replicated. Then GetSample is its index in the shared dataset and GetIncluded is its index
+// among the samples that are in the bag, which is how the init scores are indexed. With bag bits we jump straight to
+// the next set (or clear) bit instead of reading the skipped samples one at a time.
+class OuterBagWalker final {
+   const BagEbm * m_pReplication;
+   const uint64_t * m_pBits;
+   uint64_t m_bitsRemaining;
+   uint64_t m_flip;
+   size_t m_iSampleNext;
+   size_t m_iIncludedNext;
+   size_t m_iSample;
+   size_t m_iIncluded;
+   bool m_bValidation;
+
+public:
+
+   INLINE_ALWAYS OuterBagWalker(const OuterBag & bag, const BagEbm direction) :
+      m_pReplication(bag.m_aReplications),
+      m_pBits(bag.m_aBits),
+      m_bitsRemaining(0),
+      m_flip(direction < BagEbm { 0 } ? ~uint64_t { 0 } : uint64_t { 0 }),
+      m_iSampleNext(0),
+      m_iIncludedNext(0),
+      m_iSample(0),
+      m_iIncluded(0),
+      m_bValidation(direction < BagEbm { 0 }) {
+      EBM_ASSERT(BagEbm { -1 } == direction || BagEbm { 1 } == direction);
+      EBM_ASSERT(!bag.IsEmpty() || !m_bValidation); // without a bag we have no validation samples
+      if(nullptr != m_pBits) {
+         m_bitsRemaining = *m_pBits ^ m_flip;
+      }
+   }
+
+   INLINE_ALWAYS size_t Next() {
+      size_t cReplication = 1;
+      if(nullptr != m_pBits) {
+         // the caller only asks for as many samples as the bits hold, so we never run past the last word
+         uint64_t bits = m_bitsRemaining;
+         while(uint64_t { 0 } == bits) {
+            m_iSampleNext += k_cBagBitsPerWord;
+            ++m_pBits;
+            bits = *m_pBits ^ m_flip;
+         }
+         m_iSample = m_iSampleNext + CountTrailingZeros(bits);
+         m_iIncluded = m_iSample;
+         m_bitsRemaining = bits & (bits - uint64_t { 1 });
+      } else if(nullptr != m_pReplication) {
+         size_t iSample = m_iSampleNext;
+         size_t iIncluded = m_iIncludedNext;
+         BagEbm replication;
+         bool isItemValidation;
+         do {
+            do {
+               replication = m_pReplication[iSample];
+               ++iSample;
+            } while(BagEbm { 0 } == replication);
+            isItemValidation = replication < BagEbm { 0 };
+            ++iIncluded;
+         } while(m_bValidation != isItemValidation);
+         m_iSampleNext = iSample;
+         m_iIncludedNext = iIncluded;
+         m_iSample = iSample - size_t { 1 };
+         m_iIncluded = iIncluded - size_t { 1 };
+         cReplication = static_cast<size_t>(isItemValidation ? -static_cast<int>(replication) : static_cast<int>(replication));
+      } else {
+         m_iSample = m_iSampleNext;
+         m_iIncluded = m_iSample;
+         ++m_iSampleNext;
+      }
+      return cReplication;
+   }
+
+   INLINE_ALWAYS size_t GetSample() const {
+      return m_iSample;
+   }
+
+   INLINE_ALWAYS size_t GetIncluded() const {
+      return m_iIncluded;
+   }
+};
+
+} // DEFINED_ZONE_NAME
+
+#endif // OUTER_BAG_HPP
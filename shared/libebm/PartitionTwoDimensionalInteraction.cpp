@@ -508,8 +508,8 @@ extern double PartitionTwoDimensionalInteraction(
       }
    } else {
       if(size_t { 1 } != cRuntimeScores) {
-         // Odd: gradient multiclass. Allow it, but do not optimize for it
-         return PartitionTwoDimensionalInteractionInternal<false, k_dynamicScores>::Func(
+         // gradient-only muticlass is the default for interaction detection when Newton is not requested
+         return PartitionTwoDimensionalInteractionTarget<false, k_cCompilerScoresStart>::Func(
             pInteractionCore,
             cRealDimensions,
             acBins,
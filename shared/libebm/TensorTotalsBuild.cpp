@@ -541,8 +541,8 @@ extern void TensorTotalsBuild(
       }
    } else {
       if(size_t { 1 } != cScores) {
-         // Odd: gradient multiclass. Allow it, but do not optimize for it
-         TensorTotalsBuildInternal<false, k_dynamicScores, k_dynamicDimensions>::Func(
+         // gradient-only muticlass is the default for interaction detection when Newton is not requested
+         TensorTotalsBuildTarget<false, k_cCompilerScoresStart>::Func(
             cScores,
             cRealDimensions,
             acBins,
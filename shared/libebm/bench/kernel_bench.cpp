@@ -0,0 +1,437 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// Kernel benchmarks. The boosting kernels are not exported, so we time them inside a real booster using the phase
+// counters that CreateBoosterFlags_CollectStats enables. This times exactly the code that training runs, with the
+// same memory layout, and excludes the split search and everything else around the kernel.
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "libebm.h"
+#include "libebm_bench.hpp"
+
+static constexpr uint64_t k_seedDataSets = 20230901;
+static constexpr SeedEbm k_seedBoosting = 42;
+
+static std::string Params(const char * const sFormat, const long long val0, const long long val1 = 0) {
+   char sBuffer[128];
+   snprintf(sBuffer, sizeof(sBuffer), sFormat, val0, val1);
+   return std::string(sBuffer);
+}
+
+static void ReportFailure(const char * const sName, const char * const sZone, const ErrorEbm error) {
+   fprintf(stderr, "%s %s failed with error %d\n", sName, sZone, static_cast<int>(error));
+}
+
+static ErrorEbm GetPhaseStats(const BoosterHandle boosterHandle, std::vector<IntEbm> & phaseStatsOut) {
+   phaseStatsOut.resize(static_cast<size_t>(BoosterPhase_Count * BoosterStat_Count));
+   return GetBoosterStats(boosterHandle,
+      static_cast<IntEbm>(phaseStatsOut.size()),
+      &phaseStatsOut[0],
+      0,
+      nullptr
+   );
+}
+
+struct PhaseMeasurement final {
+   size_t m_cCalls;
+   double m_seconds;
+   double m_bytes;
+};
+
+// Boosts iTerm for the given number of rounds context.m_cRepeats times and returns the counters of phase iPhase
+// for the fastest repeat. Between repeats the booster keeps its state, which is fine since the kernels we measure
+// do the same amount of work on every round regardless of the current model.
+static ErrorEbm MeasurePhase(
+   const BenchContext & context,
+   void * const rng,
+   const BoosterHandle boosterHandle,
+   const size_t iTerm,
+   const IntEbm iPhase,
+   PhaseMeasurement & measurementOut
+) {
+   measurementOut.m_cCalls = 0;
+   measurementOut.m_seconds = 0.0;
+   measurementOut.m_bytes = 0.0;
+
+   // without a leaf limit GenerateTermUpdate sums every sample into a single bin and skips the bit packs, so give
+   // it the same limit that the python package uses by default
+   const IntEbm leavesMax[] { 3 };
+
+   std::vector<IntEbm> before;
+   std::vector<IntEbm> after;
+   bool bFirst = true;
+   for(size_t iRepeat = 0; iRepeat < context.m_cRepeats; ++iRepeat) {
+      ErrorEbm error = GetPhaseStats(boosterHandle, before);
+      if(Error_None != error) {
+         return error;
+      }
+      for(size_t iRound = 0; iRound < context.m_cRounds; ++iRound) {
+         double gain;
+         error = GenerateTermUpdate(
+            rng,
+            boosterHandle,
+            static_cast<IntEbm>(iTerm),
+            TermBoostFlags_Default,
+            0.01,
+            1,
+            leavesMax,
+            &gain
+         );
+         if(Error_None != error) {
+            return error;
+         }
+         double metric;
+         error = ApplyTermUpdate(boosterHandle, &metric);
+         if(Error_None != error) {
+            return error;
+         }
+      }
+      error = GetPhaseStats(boosterHandle, after);
+      if(Error_None != error) {
+         return error;
+      }
+
+      const size_t iBase = static_cast<size_t>(iPhase * BoosterStat_Count);
+      const double seconds = 1e-9 *
+         static_cast<double>(after[iBase + BoosterStat_Nanoseconds] - before[iBase + BoosterStat_Nanoseconds]);
+      if(bFirst || seconds < measurementOut.m_seconds) {
+         bFirst = false;
+         measurementOut.m_cCalls = static_cast<size_t>(after[iBase + BoosterStat_Calls] - before[iBase + BoosterStat_Calls]);
+         measurementOut.m_seconds = seconds;
+         measurementOut.m_bytes =
+            static_cast<double>(after[iBase + BoosterStat_Bytes] - before[iBase + BoosterStat_Bytes]);
+      }
+   }
+   return Error_None;
+}
+
+static ErrorEbm CreateBenchBooster(
+   void * const rng,
+   const BenchDataSet & dataSet,
+   const AccelerationFlags acceleration,
+   const char * const sObjective,
+   const CreateBoosterFlags flags,
+   BoosterHandle & boosterHandleOut
+) {
+   // one single-feature term per feature so that each feature's bit pack can be measured in isolation
+   std::vector<IntEbm> dimensionCounts(dataSet.m_cFeatures, 1);
+   std::vector<IntEbm> featureIndexes(dataSet.m_cFeatures);
+   for(size_t iFeature = 0; iFeature < dataSet.m_cFeatures; ++iFeature) {
+      featureIndexes[iFeature] = static_cast<IntEbm>(iFeature);
+   }
+   return CreateBooster(
+      rng,
+      &dataSet.m_data[0],
+      nullptr,
+      nullptr,
+      static_cast<IntEbm>(dataSet.m_cFeatures),
+      &dimensionCounts[0],
+      &featureIndexes[0],
+      0,
+      CreateBoosterFlags_CollectStats | flags,
+      acceleration,
+      sObjective,
+      nullptr,
+      &boosterHandleOut
+   );
+}
+
+static void BenchDiscretize(BenchContext & context) {
+   static const char k_sName[] = "Discretize";
+   static const char k_sCutName[] = "CutQuantile";
+   const bool bDiscretize = context.IsSelected(k_sName);
+   const bool bCut = context.IsSelected(k_sCutName);
+   if(!bDiscretize && !bCut) {
+      return;
+   }
+
+   BenchRng rng(k_seedDataSets);
+   const size_t cSamples = context.m_cSamples;
+   std::vector<double> featureVals(cSamples);
+   for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+      // a skewed continuous distribution with some exact duplicates, like real data
+      const double unit = rng.NextUnit();
+      featureVals[iSample] = 0 == rng.NextIndex(8) ? 1.0 : unit * unit * 1000.0;
+   }
+
+   IntEbm countCuts = 255;
+   std::vector<double> cuts(static_cast<size_t>(countCuts));
+
+   double best = 0.0;
+   for(size_t iRepeat = 0; iRepeat < context.m_cRepeats; ++iRepeat) {
+      countCuts = static_cast<IntEbm>(cuts.size());
+      const double tStart = BenchSeconds();
+      const ErrorEbm error = CutQuantile(
+         static_cast<IntEbm>(cSamples),
+         &featureVals[0],
+         1,
+         EBM_FALSE,
+         &countCuts,
+         &cuts[0]
+      );
+      const double seconds = BenchSeconds() - tStart;
+      if(Error_None != error) {
+         ReportFailure(k_sCutName, "cpu_64", error);
+         return;
+      }
+      best = 0 == iRepeat || seconds < best ? seconds : best;
+   }
+   if(bCut) {
+      // CutQuantile copies and sorts the values, so it touches each value several times. We don't estimate the bytes
+      context.Report(BenchResult { k_sCutName, "cpu_64", Params("cuts=%lld", 255), cSamples, best, 0.0 });
+   }
+
+   if(bDiscretize) {
+      std::vector<IntEbm> binIndexes(cSamples);
+      for(size_t iRepeat = 0; iRepeat < context.m_cRepeats; ++iRepeat) {
+         const double tStart = BenchSeconds();
+         const ErrorEbm error = Discretize(
+            static_cast<IntEbm>(cSamples),
+            &featureVals[0],
+            countCuts,
+            0 == countCuts ? nullptr : &cuts[0],
+            &binIndexes[0]
+         );
+         const double seconds = BenchSeconds() - tStart;
+         if(Error_None != error) {
+            ReportFailure(k_sName, "cpu_64", error);
+            return;
+         }
+         best = 0 == iRepeat || seconds < best ? seconds : best;
+      }
+      const double cBytes = static_cast<double>(cSamples) * static_cast<double>(sizeof(double) + sizeof(IntEbm));
+      context.Report(BenchResult { k_sName, "cpu_64", Params("cuts=%lld", static_cast<long long>(countCuts)), cSamples,
+         best, cBytes });
+   }
+}
+
+struct BenchTask final {
+   const char * m_sLabel;
+   TaskEbm m_cClasses;
+   const char * m_sObjective;
+   CreateBoosterFlags m_flags;
+};
+
+static void BenchBinSums(BenchContext & context, const std::vector<BenchZone> & zones) {
+   static const char k_sName[] = "BinSumsBoosting";
+   if(!context.IsSelected(k_sName)) {
+      return;
+   }
+
+   // the number of scores changes the bin layout and the gradient/hessian stride, and the bin counts select
+   // different bit packs: 2 bins packs the most items per word and 4096 bins the fewest
+   static const BenchTask k_tasks[] = {
+      { "scores=1 rmse", Task_Regression, "rmse", CreateBoosterFlags_Default },
+      { "scores=1 binary", 2, "log_loss", CreateBoosterFlags_Default },
+      { "scores=3", 3, "log_loss", CreateBoosterFlags_Default },
+      { "scores=8", 8, "log_loss", CreateBoosterFlags_Default },
+      { "scores=1 rmse int16", Task_Regression, "rmse", CreateBoosterFlags_QuantizeGradients16 },
+      { "scores=1 binary int16", 2, "log_loss", CreateBoosterFlags_QuantizeGradients16 },
+      { "scores=1 binary int8", 2, "log_loss", CreateBoosterFlags_QuantizeGradients8 },
+      { "scores=3 int16", 3, "log_loss", CreateBoosterFlags_QuantizeGradients16 },
+   };
+   const std::vector<IntEbm> binCounts { 2, 16, 256, 4096 };
+
+   std::vector<unsigned char> rngBoosting(static_cast<size_t>(MeasureRNG()));
+   for(const BenchTask & task : k_tasks) {
+      BenchRng rng(k_seedDataSets);
+      BenchDataSet dataSet;
+      ErrorEbm error = MakeBenchDataSet(rng, context.m_cSamples, binCounts, task.m_cClasses, dataSet);
+      if(Error_None != error) {
+         ReportFailure(k_sName, task.m_sLabel, error);
+         return;
+      }
+
+      for(const BenchZone & zone : zones) {
+         InitRNG(k_seedBoosting, &rngBoosting[0]);
+         BoosterHandle boosterHandle = nullptr;
+         error = CreateBenchBooster(&rngBoosting[0], dataSet, zone.m_acceleration, task.m_sObjective, task.m_flags,
+            boosterHandle);
+         if(Error_None != error) {
+            ReportFailure(k_sName, zone.m_sName, error);
+            continue;
+         }
+         for(size_t iTerm = 0; iTerm < binCounts.size(); ++iTerm) {
+            PhaseMeasurement measurement;
+            error = MeasurePhase(context, &rngBoosting[0], boosterHandle, iTerm, BoosterPhase_BinSumsBoosting,
+               measurement);
+            if(Error_None != error) {
+               ReportFailure(k_sName, zone.m_sName, error);
+               break;
+            }
+            context.Report(BenchResult {
+               k_sName,
+               zone.m_sName,
+               std::string(task.m_sLabel) + Params(" bins=%lld", static_cast<long long>(binCounts[iTerm])),
+               context.m_cSamples * measurement.m_cCalls,
+               measurement.m_seconds,
+               measurement.m_bytes
+            });
+         }
+         FreeBooster(boosterHandle);
+      }
+   }
+}
+
+static void BenchApplyUpdate(BenchContext & context, const std::vector<BenchZone> & zones) {
+   static const char k_sName[] = "ApplyUpdate";
+   if(!context.IsSelected(k_sName)) {
+      return;
+   }
+
+   static const BenchTask k_tasks[] = {
+      { "rmse", Task_Regression, "rmse", CreateBoosterFlags_Default },
+      { "rmse_log", Task_Regression, "rmse_log", CreateBoosterFlags_Default },
+      { "poisson_deviance", Task_Regression, "poisson_deviance", CreateBoosterFlags_Default },
+      { "tweedie_deviance", Task_Regression, "tweedie_deviance", CreateBoosterFlags_Default },
+      { "gamma_deviance", Task_Regression, "gamma_deviance", CreateBoosterFlags_Default },
+      { "pseudo_huber", Task_Regression, "pseudo_huber", CreateBoosterFlags_Default },
+      { "log_loss binary", 2, "log_loss", CreateBoosterFlags_Default },
+      { "log_loss classes=3", 3, "log_loss", CreateBoosterFlags_Default },
+      { "rmse int16", Task_Regression, "rmse", CreateBoosterFlags_QuantizeGradients16 },
+      { "log_loss binary int16", 2, "log_loss", CreateBoosterFlags_QuantizeGradients16 },
+      { "log_loss binary int8", 2, "log_loss", CreateBoosterFlags_QuantizeGradients8 },
+      { "log_loss classes=3 int16", 3, "log_loss", CreateBoosterFlags_QuantizeGradients16 },
+   };
+   const std::vector<IntEbm> binCounts { 256 };
+
+   BenchDataSet regressionDataSet;
+   BenchDataSet binaryDataSet;
+   BenchDataSet multiclassDataSet;
+   {
+      BenchRng rng(k_seedDataSets);
+      ErrorEbm error = MakeBenchDataSet(rng, context.m_cSamples, binCounts, Task_Regression, regressionDataSet);
+      if(Error_None == error) {
+         error = MakeBenchDataSet(rng, context.m_cSamples, binCounts, 2, binaryDataSet);
+      }
+      if(Error_None == error) {
+         error = MakeBenchDataSet(rng, context.m_cSamples, binCounts, 3, multiclassDataSet);
+      }
+      if(Error_None != error) {
+         ReportFailure(k_sName, "-", error);
+         return;
+      }
+   }
+
+   std::vector<unsigned char> rngBoosting(static_cast<size_t>(MeasureRNG()));
+   for(const BenchTask & task : k_tasks) {
+      const BenchDataSet & dataSet = Task_Regression == task.m_cClasses ? regressionDataSet :
+         2 == task.m_cClasses ? binaryDataSet : multiclassDataSet;
+      for(const BenchZone & zone : zones) {
+         InitRNG(k_seedBoosting, &rngBoosting[0]);
+         BoosterHandle boosterHandle = nullptr;
+         ErrorEbm error = CreateBenchBooster(&rngBoosting[0], dataSet, zone.m_acceleration, task.m_sObjective,
+            task.m_flags, boosterHandle);
+         if(Error_None != error) {
+            ReportFailure(k_sName, zone.m_sName, error);
+            continue;
+         }
+         PhaseMeasurement measurement;
+         error = MeasurePhase(context, &rngBoosting[0], boosterHandle, 0, BoosterPhase_ApplyUpdate, measurement);
+         FreeBooster(boosterHandle);
+         if(Error_None != error) {
+            ReportFailure(k_sName, zone.m_sName, error);
+            continue;
+         }
+         context.Report(BenchResult {
+            k_sName,
+            zone.m_sName,
+            task.m_sLabel,
+            context.m_cSamples * measurement.m_cCalls,
+            measurement.m_seconds,
+            measurement.m_bytes
+         });
+      }
+   }
+}
+
+static void BenchInteraction(BenchContext & context, const std::vector<BenchZone> & zones) {
+   static const char k_sName[] = "CalcInteractionStrength";
+   if(!context.IsSelected(k_sName)) {
+      return;
+   }
+
+   static constexpr size_t k_cFeatures = 8;
+   const std::vector<IntEbm> binCounts(k_cFeatures, 32);
+
+   BenchRng rng(k_seedDataSets);
+   BenchDataSet dataSet;
+   ErrorEbm error = MakeBenchDataSet(rng, context.m_cSamples, binCounts, 2, dataSet);
+   if(Error_None != error) {
+      ReportFailure(k_sName, "-", error);
+      return;
+   }
+
+   for(const BenchZone & zone : zones) {
+      InteractionHandle interactionHandle = nullptr;
+      error = CreateInteractionDetector(
+         &dataSet.m_data[0],
+         nullptr,
+         nullptr,
+         CreateInteractionFlags_Default,
+         zone.m_acceleration,
+         "log_loss",
+         nullptr,
+         &interactionHandle
+      );
+      if(Error_None != error) {
+         ReportFailure(k_sName, zone.m_sName, error);
+         continue;
+      }
+
+      size_t cPairs = 0;
+      double best = 0.0;
+      for(size_t iRepeat = 0; iRepeat < context.m_cRepeats && Error_None == error; ++iRepeat) {
+         cPairs = 0;
+         const double tStart = BenchSeconds();
+         for(size_t iFeature1 = 0; iFeature1 < k_cFeatures && Error_None == error; ++iFeature1) {
+            for(size_t iFeature2 = iFeature1 + 1; iFeature2 < k_cFeatures; ++iFeature2) {
+               const IntEbm featureIndexes[] { static_cast<IntEbm>(iFeature1), static_cast<IntEbm>(iFeature2) };
+               double strength;
+               error = CalcInteractionStrength(
+                  interactionHandle,
+                  2,
+                  featureIndexes,
+                  CalcInteractionFlags_Default,
+                  0,
+                  1,
+                  &strength
+               );
+               if(Error_None != error) {
+                  break;
+               }
+               ++cPairs;
+            }
+         }
+         const double seconds = BenchSeconds() - tStart;
+         best = 0 == iRepeat || seconds < best ? seconds : best;
+      }
+      FreeInteractionDetector(interactionHandle);
+      if(Error_None != error) {
+         ReportFailure(k_sName, zone.m_sName, error);
+         continue;
+      }
+      context.Report(BenchResult {
+         k_sName,
+         zone.m_sName,
+         Params("pairs=%lld bins=%lld", static_cast<long long>(cPairs), 32),
+         context.m_cSamples * cPairs,
+         best,
+         0.0
+      });
+   }
+}
+
+void RunKernelBenchmarks(BenchContext & context) {
+   const std::vector<BenchZone> zones = GetBenchZones();
+
+   BenchDiscretize(context);
+   BenchBinSums(context, zones);
+   BenchApplyUpdate(context, zones);
+   BenchInteraction(context, zones);
+}
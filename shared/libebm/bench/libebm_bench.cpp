@@ -0,0 +1,539 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// libebm_bench measures the throughput of the libebm kernels on reproducible synthetic data.
+//
+// usage: libebm_bench [--suite kernels|training|all] [--samples N] [--repeats N] [--rounds N] [--filter SUBSTRING]
+//                     [--features N] [--bins N] [--classes N] [--pairs N]
+//                     [--json PATH] [--baseline PATH] [--tolerance FRACTION]
+//
+// Each benchmark is run --repeats times and the fastest run is reported, which is the least noisy estimate of what
+// the code can do on an idle machine. With --json the results are also written out in a stable format that can be
+// checked into a regression tracking system and compared across commits. With --baseline the results are compared
+// against such a file and the process exits with a non-zero code if anything regressed by more than --tolerance.
+//
+// --features, --bins, --classes (0 for regression) and --pairs (0 for all) set the shape of the training suite.
+//
+// TrainOffload shows how boosting scales across NUMA nodes. Run it once restricted to one node and once on the whole
+// machine, eg:
+//   numactl --cpunodebind=0 --membind=0 ./libebm_bench --suite training --filter TrainOffload
+//   ./libebm_bench --suite training --filter TrainOffload
+// A single node machine can emulate several nodes by booting Linux with numa=fake=N.
+//
+// TrainQuantized fits with float, int16 and int8 gradients and also reports the best validation metric of each, eg:
+//   ./libebm_bench --suite training --filter TrainQuantized --samples 1000000 --classes 2
+//
+// TrainInnerBags fits with 50 inner bags and reports the time and peak RSS that the bags cost, eg:
+//   ./libebm_bench --suite training --filter TrainInnerBags --samples 100000 --rounds 10
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h> // getrusage
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h> // malloc_trim
+#endif
+
+#include "libebm.h"
+#include "libebm_bench.hpp"
+
+BenchContext::BenchContext() :
+   m_cSamples(1000000),
+   m_cRepeats(3),
+   m_cRounds(20),
+   m_cFeatures(10),
+   m_cBins(256),
+   m_cClasses(2),
+   m_cPairs(0) {
+}
+
+bool BenchContext::IsSelected(const std::string & name) const {
+   return m_filter.empty() || std::string::npos != name.find(m_filter);
+}
+
+void BenchContext::Report(const BenchResult & result) {
+   m_results.push_back(result);
+
+   const double samplesPerSecond = 0.0 < result.m_seconds ? static_cast<double>(result.m_cSamples) / result.m_seconds : 0.0;
+   printf("%-26s %-8s %-32s %12.6f %16.0f", result.m_name.c_str(), result.m_zone.c_str(), result.m_params.c_str(),
+      result.m_seconds, samplesPerSecond);
+   if(0.0 < result.m_bytes && 0.0 < result.m_seconds) {
+      printf(" %10.3f\n", result.m_bytes / result.m_seconds * 1e-9);
+   } else {
+      printf(" %10s\n", "-");
+   }
+   if(0 != result.m_cPeakRssBytes || 0.0 < result.m_latencyP50) {
+      printf("%-26s peak_rss=%.1fMB latency p50=%.6fs p90=%.6fs p99=%.6fs", "",
+         static_cast<double>(result.m_cPeakRssBytes) / (1024.0 * 1024.0),
+         result.m_latencyP50,
+         result.m_latencyP90,
+         result.m_latencyP99
+      );
+      if(!std::isnan(result.m_metric)) {
+         printf(" metric=%.6f", result.m_metric);
+      }
+      printf("\n");
+   }
+   fflush(stdout);
+}
+
+bool BenchContext::WriteJson(const char * const sPath) const {
+   FILE * const pFile = fopen(sPath, "w");
+   if(nullptr == pFile) {
+      fprintf(stderr, "could not open %s for writing\n", sPath);
+      return false;
+   }
+
+   fprintf(pFile, "{\n");
+   fprintf(pFile, "  \"samples\": %zu,\n", m_cSamples);
+   fprintf(pFile, "  \"repeats\": %zu,\n", m_cRepeats);
+   fprintf(pFile, "  \"rounds\": %zu,\n", m_cRounds);
+   fprintf(pFile, "  \"benchmarks\": [");
+   for(size_t iResult = 0; iResult < m_results.size(); ++iResult) {
+      const BenchResult & result = m_results[iResult];
+      // names, zones and params are generated by us and never contain characters that need JSON escaping
+      fprintf(pFile, "%s\n    {", 0 == iResult ? "" : ",");
+      fprintf(pFile, "\"name\": \"%s\", ", result.m_name.c_str());
+      fprintf(pFile, "\"zone\": \"%s\", ", result.m_zone.c_str());
+      fprintf(pFile, "\"params\": \"%s\", ", result.m_params.c_str());
+      fprintf(pFile, "\"samples\": %zu, ", result.m_cSamples);
+      fprintf(pFile, "\"seconds\": %.9g, ", result.m_seconds);
+      if(0.0 < result.m_seconds) {
+         fprintf(pFile, "\"samples_per_sec\": %.9g, ", static_cast<double>(result.m_cSamples) / result.m_seconds);
+      } else {
+         fprintf(pFile, "\"samples_per_sec\": null, ");
+      }
+      if(0.0 < result.m_bytes && 0.0 < result.m_seconds) {
+         fprintf(pFile, "\"gb_per_sec\": %.9g, ", result.m_bytes / result.m_seconds * 1e-9);
+      } else {
+         fprintf(pFile, "\"gb_per_sec\": null, ");
+      }
+      if(0 != result.m_cPeakRssBytes) {
+         fprintf(pFile, "\"peak_rss_bytes\": %zu, ", result.m_cPeakRssBytes);
+      } else {
+         fprintf(pFile, "\"peak_rss_bytes\": null, ");
+      }
+      if(!std::isnan(result.m_metric)) {
+         fprintf(pFile, "\"metric\": %.9g, ", result.m_metric);
+      }
+      if(0.0 < result.m_latencyP50) {
+         fprintf(pFile, "\"latency_p50\": %.9g, \"latency_p90\": %.9g, \"latency_p99\": %.9g}",
+            result.m_latencyP50, result.m_latencyP90, result.m_latencyP99);
+      } else {
+         fprintf(pFile, "\"latency_p50\": null, \"latency_p90\": null, \"latency_p99\": null}");
+      }
+   }
+   fprintf(pFile, "\n  ]\n}\n");
+
+   const bool bFailed = 0 != ferror(pFile);
+   fclose(pFile);
+   return !bFailed;
+}
+
+// WriteJson puts each result on its own line, so a baseline can be read back one line at a time without a JSON parser.
+// These return false if the key is missing or null.
+static bool FindJsonString(const std::string & line, const char * const sKey, std::string & valOut) {
+   const std::string key = std::string("\"") + sKey + "\": \"";
+   const size_t iStart = line.find(key);
+   if(std::string::npos == iStart) {
+      return false;
+   }
+   const size_t iVal = iStart + key.size();
+   const size_t iEnd = line.find('"', iVal);
+   if(std::string::npos == iEnd) {
+      return false;
+   }
+   valOut = line.substr(iVal, iEnd - iVal);
+   return true;
+}
+
+static bool FindJsonNumber(const std::string & line, const char * const sKey, double & valOut) {
+   const std::string key = std::string("\"") + sKey + "\": ";
+   const size_t iStart = line.find(key);
+   if(std::string::npos == iStart) {
+      return false;
+   }
+   const char * const sVal = line.c_str() + iStart + key.size();
+   char * sEnd = nullptr;
+   valOut = strtod(sVal, &sEnd);
+   return sEnd != sVal;
+}
+
+int BenchContext::CompareBaseline(const char * const sPath, const double tolerance) const {
+   FILE * const pFile = fopen(sPath, "r");
+   if(nullptr == pFile) {
+      fprintf(stderr, "could not open baseline %s\n", sPath);
+      return -1;
+   }
+
+   struct BaselineEntry final {
+      std::string m_key;
+      double m_cSamples;
+      double m_seconds;
+      double m_peakRssBytes;
+   };
+   std::vector<BaselineEntry> baseline;
+
+   std::string line;
+   char sBuffer[1024];
+   while(nullptr != fgets(sBuffer, sizeof(sBuffer), pFile)) {
+      line += sBuffer;
+      if(line.empty() || '\n' != line.back()) {
+         // a line longer than our buffer, keep reading until we have all of it
+         if(!feof(pFile)) {
+            continue;
+         }
+      }
+      std::string name;
+      std::string zone;
+      std::string params;
+      BaselineEntry entry;
+      if(FindJsonString(line, "name", name) && FindJsonString(line, "zone", zone) &&
+         FindJsonString(line, "params", params) && FindJsonNumber(line, "samples", entry.m_cSamples) &&
+         FindJsonNumber(line, "seconds", entry.m_seconds))
+      {
+         entry.m_key = name + "|" + zone + "|" + params;
+         if(!FindJsonNumber(line, "peak_rss_bytes", entry.m_peakRssBytes)) {
+            entry.m_peakRssBytes = 0.0;
+         }
+         baseline.push_back(entry);
+      }
+      line.clear();
+   }
+   const bool bFailed = 0 != ferror(pFile);
+   fclose(pFile);
+   if(bFailed) {
+      fprintf(stderr, "could not read baseline %s\n", sPath);
+      return -1;
+   }
+
+   printf("\ncomparing against baseline %s with tolerance %.1f%%\n", sPath, tolerance * 100.0);
+   int cRegressions = 0;
+   for(const BenchResult & result : m_results) {
+      const std::string key = result.m_name + "|" + result.m_zone + "|" + result.m_params;
+      const BaselineEntry * pMatch = nullptr;
+      for(const BaselineEntry & entry : baseline) {
+         if(entry.m_key == key && static_cast<double>(result.m_cSamples) == entry.m_cSamples) {
+            pMatch = &entry;
+            break;
+         }
+      }
+      if(nullptr == pMatch) {
+         printf("  NO BASELINE  %s %s %s\n", result.m_name.c_str(), result.m_zone.c_str(), result.m_params.c_str());
+         continue;
+      }
+
+      const double ratio = 0.0 < pMatch->m_seconds ? result.m_seconds / pMatch->m_seconds : 1.0;
+      const bool bSlower = 1.0 + tolerance < ratio;
+      const double ratioRss = 0 != result.m_cPeakRssBytes && 0.0 < pMatch->m_peakRssBytes ?
+         static_cast<double>(result.m_cPeakRssBytes) / pMatch->m_peakRssBytes : 1.0;
+      const bool bBigger = 1.0 + tolerance < ratioRss;
+      if(bSlower || bBigger) {
+         ++cRegressions;
+      }
+      printf("  %-11s  %s %s %s  time x%.3f  rss x%.3f\n",
+         bSlower || bBigger ? "REGRESSION" : "ok",
+         result.m_name.c_str(),
+         result.m_zone.c_str(),
+         result.m_params.c_str(),
+         ratio,
+         ratioRss
+      );
+   }
+   printf("%d regression%s\n", cRegressions, 1 == cRegressions ? "" : "s");
+   return cRegressions;
+}
+
+void ResetPeakRss() {
+#if defined(__GLIBC__)
+   // glibc keeps freed blocks in its heap, so without this the peak would start from whatever the previous
+   // benchmark left allocated
+   malloc_trim(0);
+#endif
+#if defined(__linux__)
+   // writing 5 to clear_refs resets the VmHWM high water mark (Linux 4.0 and later). Ignore failures since the
+   // peak then simply includes what ran earlier
+   FILE * const pFile = fopen("/proc/self/clear_refs", "w");
+   if(nullptr != pFile) {
+      fputs("5", pFile);
+      fclose(pFile);
+   }
+#endif
+}
+
+size_t GetPeakRssBytes() {
+#if defined(__linux__)
+   FILE * const pFile = fopen("/proc/self/status", "r");
+   if(nullptr != pFile) {
+      char sLine[256];
+      while(nullptr != fgets(sLine, sizeof(sLine), pFile)) {
+         unsigned long long cKilobytes;
+         if(1 == sscanf(sLine, "VmHWM: %llu kB", &cKilobytes)) {
+            fclose(pFile);
+            return static_cast<size_t>(cKilobytes) * size_t { 1024 };
+         }
+      }
+      fclose(pFile);
+   }
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+   struct rusage usage;
+   if(0 == getrusage(RUSAGE_SELF, &usage)) {
+#if defined(__APPLE__)
+      return static_cast<size_t>(usage.ru_maxrss); // bytes on macOS
+#else
+      return static_cast<size_t>(usage.ru_maxrss) * size_t { 1024 }; // kilobytes on Linux
+#endif
+   }
+#endif
+   return 0;
+}
+
+double Percentile(std::vector<double> & values, const double fraction) {
+   if(values.empty()) {
+      return 0.0;
+   }
+   std::sort(values.begin(), values.end());
+   // nearest rank
+   size_t iVal = static_cast<size_t>(std::ceil(fraction * static_cast<double>(values.size())));
+   iVal = 0 == iVal ? 0 : iVal - 1;
+   iVal = values.size() <= iVal ? values.size() - 1 : iVal;
+   return values[iVal];
+}
+
+std::vector<BenchZone> GetBenchZones() {
+   std::vector<BenchZone> zones;
+   zones.push_back(BenchZone { "cpu_64", AccelerationFlags_NONE });
+
+   // libebm silently falls back to the CPU zone when the requested SIMD zone isn't available, so only list the
+   // zones that the processor supports to avoid reporting CPU numbers under a SIMD name
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+   __builtin_cpu_init();
+   if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      zones.push_back(BenchZone { "avx2", AccelerationFlags_AVX2 });
+   }
+   if(__builtin_cpu_supports("avx512f")) {
+      zones.push_back(BenchZone { "avx512f", AccelerationFlags_AVX512F });
+   }
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+   // MSVC has no equivalent of __builtin_cpu_supports, so trust the caller's hardware
+   zones.push_back(BenchZone { "avx2", AccelerationFlags_AVX2 });
+   zones.push_back(BenchZone { "avx512f", AccelerationFlags_AVX512F });
+#endif
+
+   return zones;
+}
+
+ErrorEbm MakeBenchDataSet(
+   BenchRng & rng,
+   const size_t cSamples,
+   const std::vector<IntEbm> & binCounts,
+   const TaskEbm cClasses,
+   BenchDataSet & dataSetOut
+) {
+   const size_t cFeatures = binCounts.size();
+
+   std::vector<IntEbm> binIndexes(cSamples * cFeatures);
+   std::vector<double> scores(cSamples, 0.0);
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const size_t cBins = static_cast<size_t>(binCounts[iFeature]);
+      // each feature gets its own random shape so that the target depends on all of them
+      std::vector<double> shape(cBins);
+      for(size_t iBin = 0; iBin < cBins; ++iBin) {
+         shape[iBin] = rng.NextUnit() - 0.5;
+      }
+      IntEbm * const aFeatureBins = &binIndexes[iFeature * cSamples];
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         const size_t iBin = rng.NextIndex(cBins);
+         aFeatureBins[iSample] = static_cast<IntEbm>(iBin);
+         scores[iSample] += shape[iBin];
+      }
+   }
+
+   std::vector<double> regressionTargets;
+   std::vector<IntEbm> classificationTargets;
+   const void * aTargets;
+   if(Task_Regression == cClasses) {
+      regressionTargets.resize(cSamples);
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         // strictly positive so that the gamma, poisson and tweedie objectives accept it
+         regressionTargets[iSample] = 0.25 + 2.0 * rng.NextUnit() + (scores[iSample] < 0.0 ? 0.0 : scores[iSample]);
+      }
+      aTargets = &regressionTargets[0];
+   } else {
+      classificationTargets.resize(cSamples);
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         // the classes are ordered by score with some label noise
+         const double score = scores[iSample] + rng.NextUnit() - 0.5;
+         const double unit = 1.0 / (1.0 + std::exp(-score));
+         size_t iClass = static_cast<size_t>(unit * static_cast<double>(cClasses));
+         iClass = static_cast<size_t>(cClasses) <= iClass ? static_cast<size_t>(cClasses) - 1 : iClass;
+         classificationTargets[iSample] = static_cast<IntEbm>(iClass);
+      }
+      aTargets = &classificationTargets[0];
+   }
+
+   // every bin index is legal when the missing and unknown bins are part of the feature, as in the python package
+   const std::vector<BoolEbm> isMissing(cFeatures, EBM_TRUE);
+   const std::vector<BoolEbm> isUnknown(cFeatures, EBM_TRUE);
+   const std::vector<BoolEbm> isNominal(cFeatures, EBM_FALSE);
+
+   DataSetBuilderHandle dataSetBuilderHandle = nullptr;
+   ErrorEbm error = CreateDataSetBuilderChunked(
+      static_cast<IntEbm>(cSamples),
+      static_cast<IntEbm>(cFeatures),
+      0 == cFeatures ? nullptr : &binCounts[0],
+      0 == cFeatures ? nullptr : &isMissing[0],
+      0 == cFeatures ? nullptr : &isUnknown[0],
+      0 == cFeatures ? nullptr : &isNominal[0],
+      0,
+      1,
+      Task_Regression == cClasses ? EBM_FALSE : EBM_TRUE,
+      Task_Regression == cClasses ? 0 : static_cast<IntEbm>(cClasses),
+      nullptr,
+      &dataSetBuilderHandle
+   );
+   if(Error_None != error) {
+      return error;
+   }
+
+   error = DataSetBuilderAppendRows(
+      dataSetBuilderHandle,
+      static_cast<IntEbm>(cSamples),
+      binIndexes.empty() ? nullptr : &binIndexes[0],
+      nullptr,
+      aTargets
+   );
+   if(Error_None == error) {
+      IntEbm countBytes = 0;
+      error = FinalizeDataSetBuilder(dataSetBuilderHandle, &countBytes);
+      if(Error_None == error) {
+         dataSetOut.m_data.resize(static_cast<size_t>(countBytes));
+         error = CopyDataSetBuilder(dataSetBuilderHandle, countBytes, &dataSetOut.m_data[0]);
+      }
+   }
+   FreeDataSetBuilder(dataSetBuilderHandle);
+
+   dataSetOut.m_cSamples = cSamples;
+   dataSetOut.m_cFeatures = cFeatures;
+   return error;
+}
+
+static bool ParseCount(
+   const char * const sArg,
+   const char * const sVal,
+   const bool bAllowZero,
+   size_t * const pCountOut
+) {
+   if(nullptr == sVal) {
+      fprintf(stderr, "%s requires a value\n", sArg);
+      return false;
+   }
+   char * sEnd = nullptr;
+   const unsigned long long val = strtoull(sVal, &sEnd, 10);
+   if(sEnd == sVal || '\0' != *sEnd || '-' == *sVal || !bAllowZero && 0 == val) {
+      fprintf(stderr, "%s requires a %s integer, not \"%s\"\n", sArg, bAllowZero ? "non-negative" : "positive", sVal);
+      return false;
+   }
+   *pCountOut = static_cast<size_t>(val);
+   return true;
+}
+
+static void PrintUsage() {
+   fprintf(stderr,
+      "usage: libebm_bench [--suite kernels|training|all] [--samples N] [--repeats N] [--rounds N] "
+      "[--filter SUBSTRING]\n"
+      "                    [--features N] [--bins N] [--classes N] [--pairs N]\n"
+      "                    [--json PATH] [--baseline PATH] [--tolerance FRACTION]\n");
+}
+
+int main(int argc, char * argv[]) {
+   BenchContext context;
+   const char * sSuite = "all";
+   const char * sJsonPath = nullptr;
+   const char * sBaselinePath = nullptr;
+   double tolerance = 0.10;
+
+   for(int iArg = 1; iArg < argc; ++iArg) {
+      const char * const sArg = argv[iArg];
+      const char * const sVal = iArg + 1 < argc ? argv[iArg + 1] : nullptr;
+      bool bGood = nullptr != sVal;
+      if(0 == strcmp(sArg, "--samples")) {
+         bGood = ParseCount(sArg, sVal, false, &context.m_cSamples);
+      } else if(0 == strcmp(sArg, "--repeats")) {
+         bGood = ParseCount(sArg, sVal, false, &context.m_cRepeats);
+      } else if(0 == strcmp(sArg, "--rounds")) {
+         bGood = ParseCount(sArg, sVal, false, &context.m_cRounds);
+      } else if(0 == strcmp(sArg, "--features")) {
+         bGood = ParseCount(sArg, sVal, false, &context.m_cFeatures);
+      } else if(0 == strcmp(sArg, "--bins")) {
+         bGood = ParseCount(sArg, sVal, false, &context.m_cBins);
+         if(bGood && context.m_cBins < 2) {
+            fprintf(stderr, "--bins must be 2 or more\n");
+            bGood = false;
+         }
+      } else if(0 == strcmp(sArg, "--classes")) {
+         size_t cClasses = 0;
+         bGood = ParseCount(sArg, sVal, true, &cClasses);
+         if(bGood && 1 == cClasses) {
+            fprintf(stderr, "--classes must be 0 for regression or 2 or more for classification\n");
+            bGood = false;
+         }
+         context.m_cClasses = 0 == cClasses ? Task_Regression : static_cast<TaskEbm>(cClasses);
+      } else if(0 == strcmp(sArg, "--pairs")) {
+         bGood = ParseCount(sArg, sVal, true, &context.m_cPairs);
+      } else if(0 == strcmp(sArg, "--suite") && bGood) {
+         sSuite = sVal;
+         bGood = 0 == strcmp(sSuite, "all") || 0 == strcmp(sSuite, "kernels") || 0 == strcmp(sSuite, "training");
+      } else if(0 == strcmp(sArg, "--filter") && bGood) {
+         context.m_filter = sVal;
+      } else if(0 == strcmp(sArg, "--json") && bGood) {
+         sJsonPath = sVal;
+      } else if(0 == strcmp(sArg, "--baseline") && bGood) {
+         sBaselinePath = sVal;
+      } else if(0 == strcmp(sArg, "--tolerance") && bGood) {
+         char * sEnd = nullptr;
+         tolerance = strtod(sVal, &sEnd);
+         bGood = sEnd != sVal && '\0' == *sEnd && 0.0 <= tolerance;
+      } else {
+         bGood = false;
+      }
+      if(!bGood) {
+         PrintUsage();
+         return 2;
+      }
+      ++iArg;
+   }
+
+   printf("%-26s %-8s %-32s %12s %16s %10s\n", "benchmark", "zone", "params", "seconds", "samples/s", "GB/s");
+
+   if(0 != strcmp(sSuite, "training")) {
+      RunKernelBenchmarks(context);
+   }
+   if(0 != strcmp(sSuite, "kernels")) {
+      RunTrainingBenchmarks(context);
+   }
+
+   if(nullptr != sJsonPath) {
+      if(!context.WriteJson(sJsonPath)) {
+         return 1;
+      }
+   }
+   if(nullptr != sBaselinePath) {
+      const int cRegressions = context.CompareBaseline(sBaselinePath, tolerance);
+      if(0 != cRegressions) {
+         // -1 for an unreadable baseline is also a failure, otherwise a typo in the path would pass silently
+         return 3;
+      }
+   }
+   return 0;
+}
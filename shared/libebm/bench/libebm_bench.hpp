@@ -0,0 +1,157 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef LIBEBM_BENCH_HPP
+#define LIBEBM_BENCH_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+#include <string>
+#include <vector>
+#include <chrono>
+#include <limits>
+
+#include "libebm.h"
+
+// The benchmarks only use the public C interface, so they measure libebm exactly as the python and R packages
+// call it. Every dataset is synthesized from a fixed seed so that runs on different machines see identical inputs.
+
+class BenchRng final {
+   uint64_t m_state;
+
+public:
+
+   inline explicit BenchRng(const uint64_t seed) : m_state(seed) {
+   }
+
+   inline uint64_t Next() {
+      // splitmix64 is tiny and has no dependence on the standard library's implementation defined distributions
+      m_state += uint64_t { 0x9e3779b97f4a7c15 };
+      uint64_t z = m_state;
+      z = (z ^ (z >> 30)) * uint64_t { 0xbf58476d1ce4e5b9 };
+      z = (z ^ (z >> 27)) * uint64_t { 0x94d049bb133111eb };
+      return z ^ (z >> 31);
+   }
+
+   inline size_t NextIndex(const size_t cItems) {
+      return static_cast<size_t>(Next() % static_cast<uint64_t>(cItems));
+   }
+
+   inline double NextUnit() {
+      // 53 random bits in [0, 1)
+      return static_cast<double>(Next() >> 11) * (1.0 / 9007199254740992.0);
+   }
+};
+
+inline double BenchSeconds() {
+   return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct BenchZone final {
+   const char * m_sName;
+   AccelerationFlags m_acceleration;
+};
+
+// the compute zones that the CPU running the benchmark supports
+std::vector<BenchZone> GetBenchZones();
+
+struct BenchResult final {
+   std::string m_name;
+   std::string m_zone;
+   std::string m_params;
+   size_t m_cSamples; // samples processed in total across all the timed calls
+   double m_seconds; // the fastest of the repeats
+   double m_bytes; // estimated bytes moved through memory by the timed calls, or zero if not estimated
+
+   // the end-to-end benchmarks also fill these in. Zero means not measured
+   size_t m_cPeakRssBytes;
+   double m_latencyP50;
+   double m_latencyP90;
+   double m_latencyP99;
+   double m_metric; // the best validation metric of a fit, or NaN if not measured
+
+   inline BenchResult(
+      const std::string & name,
+      const std::string & zone,
+      const std::string & params,
+      const size_t cSamples,
+      const double seconds,
+      const double bytes
+   ) :
+      m_name(name),
+      m_zone(zone),
+      m_params(params),
+      m_cSamples(cSamples),
+      m_seconds(seconds),
+      m_bytes(bytes),
+      m_cPeakRssBytes(0),
+      m_latencyP50(0.0),
+      m_latencyP90(0.0),
+      m_latencyP99(0.0),
+      m_metric(std::numeric_limits<double>::quiet_NaN()) {
+   }
+};
+
+class BenchContext final {
+   std::vector<BenchResult> m_results;
+
+public:
+
+   size_t m_cSamples;
+   size_t m_cRepeats;
+   size_t m_cRounds;
+   std::string m_filter;
+
+   // shape of the end-to-end training datasets. m_cClasses is Task_Regression for regression
+   size_t m_cFeatures;
+   size_t m_cBins;
+   TaskEbm m_cClasses;
+   size_t m_cPairs; // zero for all pairs
+
+   BenchContext();
+
+   bool IsSelected(const std::string & name) const;
+   void Report(const BenchResult & result);
+   bool WriteJson(const char * const sPath) const;
+
+   // Compares our results against a file previously written by WriteJson. A result regresses if it is slower, or
+   // uses more peak memory, than its baseline by more than the given fraction. Results are matched on their name,
+   // zone, params and sample count, and results without a match are listed but never fail. Returns the number of
+   // regressions, or -1 if the baseline could not be read.
+   int CompareBaseline(const char * const sPath, const double tolerance) const;
+
+   inline const std::vector<BenchResult> & GetResults() const {
+      return m_results;
+   }
+};
+
+struct BenchDataSet final {
+   std::vector<unsigned char> m_data;
+   size_t m_cSamples;
+   size_t m_cFeatures;
+};
+
+// Builds a dataset of features with the given bin counts. The target depends on every feature so that boosting
+// finds real splits. cClasses is Task_Regression for positive regression targets (usable by every regression
+// objective including the log link ones), or the number of classes for classification.
+ErrorEbm MakeBenchDataSet(
+   BenchRng & rng,
+   const size_t cSamples,
+   const std::vector<IntEbm> & binCounts,
+   const TaskEbm cClasses,
+   BenchDataSet & dataSetOut
+);
+
+// the process high water mark of resident memory. ResetPeakRss lowers it to the current resident memory where the
+// OS allows that (Linux), otherwise the peak covers everything that ran before
+void ResetPeakRss();
+size_t GetPeakRssBytes();
+
+// the value below which the given fraction of the values lie. Sorts the values
+double Percentile(std::vector<double> & values, const double fraction);
+
+void RunKernelBenchmarks(BenchContext & context);
+void RunTrainingBenchmarks(BenchContext & context);
+
+#endif // LIBEBM_BENCH_HPP
@@ -0,0 +1,194 @@
+#!/bin/sh
+
+# This script is written as Bourne shell and is POSIX compliant to have less interoperability issues between distros and MacOS.
+# It follows the same structure as tests/libebm_test.sh, which documents why we handle filenames the way we do.
+#
+# Builds the release libebm shared library (unless -existing_release_64 is given), compiles the benchmark harness
+# against it and runs it. All other arguments are passed through to libebm_bench, eg:
+#   ./libebm_bench.sh --samples 1000000 --repeats 5 --json bench.json
+#   ./libebm_bench.sh -existing_release_64 --filter BinSums
+#   ./libebm_bench.sh --suite training --features 20 --classes 3 --baseline bench.json --tolerance 0.05
+#   numactl --cpunodebind=0 --membind=0 ./libebm_bench.sh -existing_release_64 --suite training --filter TrainOffload
+
+sanitize() {
+   printf "%s" "$1" | sed "s/'/'\\\\''/g; 1s/^/'/; \$s/\$/'/"
+}
+
+get_file_body() {
+   printf "%s" "$1" | sed 's/\(.*\)\/\(.*\)\.\(.*\)$/\2/'
+}
+
+make_paths() {
+   l2_obj_path_unsanitized="$1"
+   l2_bin_path_unsanitized="$2"
+
+   [ -d "$l2_obj_path_unsanitized" ] || mkdir -p "$l2_obj_path_unsanitized"
+   l2_ret_code=$?
+   if [ $l2_ret_code -ne 0 ]; then
+      exit $l2_ret_code
+   fi
+   [ -d "$l2_bin_path_unsanitized" ] || mkdir -p "$l2_bin_path_unsanitized"
+   l2_ret_code=$?
+   if [ $l2_ret_code -ne 0 ]; then
+      exit $l2_ret_code
+   fi
+}
+
+compile_file() {
+   l3_compiler="$1"
+   l3_compiler_args_sanitized="$2"
+   l3_file_unsanitized="$3"
+   l3_obj_path_unsanitized="$4"
+
+   l3_file_sanitized=`sanitize "$l3_file_unsanitized"`
+   l3_file_body_unsanitized=`get_file_body "$l3_file_unsanitized"`
+   l3_object_full_file_unsanitized="$l3_obj_path_unsanitized/${l3_file_body_unsanitized}.o"
+   l3_object_full_file_sanitized=`sanitize "$l3_object_full_file_unsanitized"`
+   g_all_object_files_sanitized="$g_all_object_files_sanitized $l3_object_full_file_sanitized"
+   l3_compile_specific="$l3_compiler $l3_compiler_args_sanitized -c $l3_file_sanitized -o $l3_object_full_file_sanitized 2>&1"
+   l3_compile_out=`eval "$l3_compile_specific"`
+   l3_ret_code=$?
+   g_compile_out_full="$g_compile_out_full$l3_compile_out"
+   if [ $l3_ret_code -ne 0 ]; then
+      printf "%s\n" "$g_compile_out_full"
+      exit $l3_ret_code
+   fi
+}
+
+compile_directory() {
+   l4_compiler="$1"
+   l4_compiler_args_sanitized="$2"
+   l4_src_path_unsanitized="$3"
+   l4_obj_path_unsanitized="$4"
+
+   # zsh (default shell in macs) terminates if you try to glob expand zero results, so check first
+   find "$l4_src_path_unsanitized" -maxdepth 1 -type f -name '*.cpp' 2>/dev/null | grep -q .
+   l4_ret_code=$?
+   if [ $l4_ret_code -eq 0 ]; then
+      for l4_file_unsanitized in "$l4_src_path_unsanitized"/*.cpp ; do
+         if [ -f "$l4_file_unsanitized" ] ; then
+            compile_file "$l4_compiler" "$l4_compiler_args_sanitized" "$l4_file_unsanitized" "$l4_obj_path_unsanitized"
+         fi
+      done
+   fi
+}
+
+link_file() {
+   l5_linker="$1"
+   l5_linker_args_sanitized="$2"
+   l5_bin_path_unsanitized="$3"
+   l5_bin_file="$4"
+
+   l5_bin_path_sanitized=`sanitize "$l5_bin_path_unsanitized"`
+   l5_compile_specific="$l5_linker $g_all_object_files_sanitized $l5_linker_args_sanitized -o $l5_bin_path_sanitized/$l5_bin_file 2>&1"
+   l5_compile_out=`eval "$l5_compile_specific"`
+   l5_ret_code=$?
+   g_compile_out_full="$g_compile_out_full$l5_compile_out"
+   if [ $l5_ret_code -ne 0 ]; then
+      printf "%s\n" "$g_compile_out_full"
+      exit $l5_ret_code
+   fi
+}
+
+
+existing_release_64=0
+bench_args_sanitized=""
+
+for arg in "$@"; do
+   if [ "$arg" = "-existing_release_64" ]; then
+      existing_release_64=1
+   else
+      arg_sanitized=`sanitize "$arg"`
+      bench_args_sanitized="$bench_args_sanitized $arg_sanitized"
+   fi
+done
+
+script_path_initial=`dirname -- "$0"`
+# the space after the '= ' character is required
+script_path_unsanitized=`CDPATH= cd -- "$script_path_initial" && pwd -P`
+if [ ! -f "$script_path_unsanitized/libebm_bench.sh" ] ; then
+   printf "Could not find script file root directory for building InterpretML.  Exiting."
+   exit 1
+fi
+
+root_path_unsanitized="$script_path_unsanitized/../../.."
+bld_path_unsanitized="$root_path_unsanitized/bld"
+tmp_path_unsanitized="$bld_path_unsanitized/tmp"
+staging_path_unsanitized="$bld_path_unsanitized/lib"
+staging_path_sanitized=`sanitize "$staging_path_unsanitized"`
+src_path_unsanitized="$script_path_unsanitized"
+src_path_sanitized=`sanitize "$src_path_unsanitized"`
+
+bin_file="libebm_bench"
+
+all_args="-std=c++11"
+all_args="$all_args -Wall -Wextra"
+all_args="$all_args -Wunused-result"
+all_args="$all_args -Wdouble-promotion"
+all_args="$all_args -Wold-style-cast"
+all_args="$all_args -Wshadow"
+all_args="$all_args -Wformat=2"
+all_args="$all_args -Wno-format-nonliteral"
+all_args="$all_args -Wno-parentheses"
+all_args="$all_args -fvisibility=hidden -fvisibility-inlines-hidden"
+all_args="$all_args -fno-math-errno -fno-trapping-math"
+all_args="$all_args -I$src_path_sanitized/../inc"
+all_args="$all_args -I$src_path_sanitized"
+# the harness itself isn't what we measure, but keep it from adding noise to the numbers
+all_args="$all_args -m64 -DNDEBUG -O2"
+
+link_args="-L$staging_path_sanitized"
+
+os_type=`uname`
+
+if [ "$os_type" = "Linux" ]; then
+   cpp_compiler=g++
+   all_args="$all_args -Wlogical-op"
+   link_args="$link_args -Wl,-rpath-link,$staging_path_sanitized"
+   link_args="$link_args -Wl,-rpath,'\$ORIGIN/'"
+   link_args="$link_args -static-libgcc"
+   link_args="$link_args -static-libstdc++"
+   os_name="linux"
+   lib_file_body="ebm_linux_x64"
+   lib_file_extension="so"
+elif [ "$os_type" = "Darwin" ]; then
+   cpp_compiler=clang++
+   link_args="$link_args -Wl,-rpath,@loader_path"
+   os_name="mac"
+   lib_file_body="ebm_mac_x64"
+   lib_file_extension="dylib"
+else
+   printf "%s\n" "OS $os_type not recognized.  We support clang/clang++ on macOS and gcc/g++ on Linux"
+   exit 1
+fi
+
+if [ $existing_release_64 -eq 0 ]; then
+   /bin/sh "$root_path_unsanitized/build.sh" -release_64
+   ret_code=$?
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+   printf "Done building lib%s.%s\n" "$lib_file_body" "$lib_file_extension"
+fi
+
+printf "%s\n" "Compiling libebm_bench with $cpp_compiler for $os_name release|x64"
+obj_path_unsanitized="$tmp_path_unsanitized/gcc/obj/release/$os_name/x64/libebm_bench"
+bin_path_unsanitized="$tmp_path_unsanitized/gcc/bin/release/$os_name/x64/libebm_bench"
+
+g_all_object_files_sanitized=""
+g_compile_out_full=""
+
+make_paths "$obj_path_unsanitized" "$bin_path_unsanitized"
+compile_directory "$cpp_compiler" "$all_args" "$src_path_unsanitized" "$obj_path_unsanitized"
+link_file "$cpp_compiler" "-l$lib_file_body $link_args $all_args" "$bin_path_unsanitized" "$bin_file"
+printf "%s\n" "$g_compile_out_full"
+
+cp "$staging_path_unsanitized/lib$lib_file_body.$lib_file_extension" "$bin_path_unsanitized/"
+ret_code=$?
+if [ $ret_code -ne 0 ]; then
+   exit $ret_code
+fi
+
+bin_path_sanitized=`sanitize "$bin_path_unsanitized"`
+eval "$bin_path_sanitized/$bin_file $bench_args_sanitized"
+exit $?
@@ -0,0 +1,537 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// End-to-end benchmarks. These drive the public interface the same way the python package does for a fit, so they
+// catch regressions that fall between the kernels: allocation, the split search, the validation metric, copying
+// the best model, and the interaction detection setup.
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <limits>
+
+#if defined(__linux__)
+#include <sched.h> // sched_getaffinity
+#endif
+
+#include "libebm.h"
+#include "libebm_bench.hpp"
+
+static constexpr uint64_t k_seedDataSets = 20230902;
+static constexpr SeedEbm k_seedBoosting = 42;
+
+// the python package holds out 15% of the samples for early stopping by default
+static constexpr double k_validationFraction = 0.15;
+
+static std::string ShapeParams(const BenchContext & context) {
+   char sBuffer[128];
+   snprintf(sBuffer, sizeof(sBuffer), "features=%zu bins=%zu classes=%lld",
+      context.m_cFeatures,
+      context.m_cBins,
+      static_cast<long long>(Task_Regression == context.m_cClasses ? 0 : context.m_cClasses)
+   );
+   return std::string(sBuffer);
+}
+
+static void ReportFailure(const char * const sName, const char * const sZone, const ErrorEbm error) {
+   fprintf(stderr, "%s %s failed with error %d\n", sName, sZone, static_cast<int>(error));
+}
+
+// One fit: create the booster, boost every term once per round, then read back the best model. Returns the
+// latency of each round in roundSecondsOut, and the best validation metric in *pMetricOut if it is not nullptr.
+static ErrorEbm Fit(
+   const BenchContext & context,
+   const BenchDataSet & dataSet,
+   const std::vector<BagEbm> & bag,
+   const CreateBoosterFlags flags,
+   const AccelerationFlags acceleration,
+   const char * const sObjective,
+   std::vector<double> & roundSecondsOut,
+   double * const pMetricOut = nullptr,
+   const IntEbm cInnerBags = 0,
+   const char * const sValidationMetric = nullptr
+) {
+   roundSecondsOut.clear();
+   double metricBest = std::numeric_limits<double>::infinity();
+
+   std::vector<unsigned char> rng(static_cast<size_t>(MeasureRNG()));
+   InitRNG(k_seedBoosting, &rng[0]);
+
+   const size_t cTerms = dataSet.m_cFeatures;
+   std::vector<IntEbm> dimensionCounts(cTerms, 1);
+   std::vector<IntEbm> featureIndexes(cTerms);
+   for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+      featureIndexes[iTerm] = static_cast<IntEbm>(iTerm);
+   }
+
+   BoosterHandle boosterHandle = nullptr;
+   ErrorEbm error = CreateBooster(
+      &rng[0],
+      &dataSet.m_data[0],
+      &bag[0],
+      nullptr,
+      static_cast<IntEbm>(cTerms),
+      &dimensionCounts[0],
+      &featureIndexes[0],
+      cInnerBags,
+      flags,
+      acceleration,
+      sObjective,
+      nullptr,
+      &boosterHandle
+   );
+   if(Error_None != error) {
+      return error;
+   }
+
+   if(nullptr != sValidationMetric) {
+      error = SetValidationMetric(boosterHandle, sValidationMetric);
+      if(Error_None != error) {
+         FreeBooster(boosterHandle);
+         return error;
+      }
+   }
+
+   static const IntEbm k_leavesMax[] { 3 };
+   for(size_t iRound = 0; iRound < context.m_cRounds && Error_None == error; ++iRound) {
+      const double tStart = BenchSeconds();
+      for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+         double gain;
+         error = GenerateTermUpdate(
+            &rng[0],
+            boosterHandle,
+            static_cast<IntEbm>(iTerm),
+            TermBoostFlags_Default,
+            0.01,
+            2,
+            k_leavesMax,
+            &gain
+         );
+         if(Error_None != error) {
+            break;
+         }
+         double metric;
+         error = ApplyTermUpdate(boosterHandle, &metric);
+         if(Error_None != error) {
+            break;
+         }
+         metricBest = std::min(metricBest, metric);
+      }
+      roundSecondsOut.push_back(BenchSeconds() - tStart);
+   }
+
+   if(Error_None == error) {
+      const size_t cScores = Task_Regression == context.m_cClasses || 2 == context.m_cClasses ? size_t { 1 } :
+         static_cast<size_t>(context.m_cClasses);
+      std::vector<double> termScores(context.m_cBins * cScores);
+      for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+         error = GetBestTermScores(boosterHandle, static_cast<IntEbm>(iTerm), &termScores[0]);
+         if(Error_None != error) {
+            break;
+         }
+      }
+   }
+
+   FreeBooster(boosterHandle);
+   if(nullptr != pMetricOut) {
+      *pMetricOut = metricBest;
+   }
+   return error;
+}
+
+static void BenchTrainBoosting(
+   BenchContext & context,
+   const std::vector<BenchZone> & zones,
+   const BenchDataSet & dataSet,
+   const std::vector<BagEbm> & bag
+) {
+   static const char k_sName[] = "TrainBoosting";
+   if(!context.IsSelected(k_sName)) {
+      return;
+   }
+
+   const char * const sObjective = Task_Regression == context.m_cClasses ? "rmse" : "log_loss";
+   char sRounds[32];
+   snprintf(sRounds, sizeof(sRounds), " rounds=%zu", context.m_cRounds);
+   const std::string params = ShapeParams(context) + sRounds;
+
+   std::vector<double> roundSeconds;
+   std::vector<double> bestRoundSeconds;
+   for(const BenchZone & zone : zones) {
+      double best = 0.0;
+      size_t cPeakRssBytes = 0;
+      ErrorEbm error = Error_None;
+      for(size_t iRepeat = 0; iRepeat < context.m_cRepeats; ++iRepeat) {
+         ResetPeakRss();
+         const double tStart = BenchSeconds();
+         error = Fit(context, dataSet, bag, CreateBoosterFlags_Default, zone.m_acceleration, sObjective, roundSeconds);
+         const double seconds = BenchSeconds() - tStart;
+         if(Error_None != error) {
+            break;
+         }
+         cPeakRssBytes = std::max(cPeakRssBytes, GetPeakRssBytes());
+         if(0 == iRepeat || seconds < best) {
+            best = seconds;
+            bestRoundSeconds.swap(roundSeconds);
+         }
+      }
+      if(Error_None != error) {
+         ReportFailure(k_sName, zone.m_sName, error);
+         continue;
+      }
+
+      // samples are counted once per term update, which is the unit of work that boosting repeats
+      BenchResult result(k_sName, zone.m_sName, params, dataSet.m_cSamples * dataSet.m_cFeatures * context.m_cRounds,
+         best, 0.0);
+      result.m_cPeakRssBytes = cPeakRssBytes;
+      result.m_latencyP50 = Percentile(bestRoundSeconds, 0.50);
+      result.m_latencyP90 = Percentile(bestRoundSeconds, 0.90);
+      result.m_latencyP99 = Percentile(bestRoundSeconds, 0.99);
+      context.Report(result);
+   }
+}
+
+// the number of CPUs that we are allowed to run on, which is how many workers CreateBoosterFlags_HostOffload starts
+static size_t GetCountCpus() {
+#if defined(__linux__)
+   cpu_set_t allowed;
+   CPU_ZERO(&allowed);
+   if(0 == sched_getaffinity(0, sizeof(allowed), &allowed)) {
+      return static_cast<size_t>(CPU_COUNT(&allowed));
+   }
+#endif
+   return static_cast<size_t>(std::thread::hardware_concurrency());
+}
+
+// Boosting with the subsets split across the offload workers, unpinned and pinned. Run it once per NUMA layout to
+// see the scaling, eg under "numactl --cpunodebind=0 --membind=0" for a single node and then unrestricted for all of
+// them. The cpus param keeps the layouts apart when comparing against a baseline.
+static void BenchTrainOffload(
+   BenchContext & context,
+   const std::vector<BenchZone> & zones,
+   const BenchDataSet & dataSet,
+   const std::vector<BagEbm> & bag
+) {
+   static const char k_sName[] = "TrainOffload";
+   if(!context.IsSelected(k_sName)) {
+      return;
+   }
+
+   struct OffloadMode final {
+      const char * m_sName;
+      CreateBoosterFlags m_flags;
+   };
+   static const OffloadMode k_modes[] {
+      { "unpinned", CreateBoosterFlags_HostOffload },
+      { "pinned", CreateBoosterFlags_HostOffload | CreateBoosterFlags_PinThreads },
+   };
+
+   const char * const sObjective = Task_Regression == context.m_cClasses ? "rmse" : "log_loss";
+
+   std::vector<double> roundSeconds;
+   std::vector<double> bestRoundSeconds;
+   for(const BenchZone & zone : zones) {
+      for(const OffloadMode & mode : k_modes) {
+         char sMode[96];
+         snprintf(sMode, sizeof(sMode), " rounds=%zu cpus=%zu %s", context.m_cRounds, GetCountCpus(), mode.m_sName);
+         const std::string params = ShapeParams(context) + sMode;
+
+         double best = 0.0;
+         size_t cPeakRssBytes = 0;
+         ErrorEbm error = Error_None;
+         for(size_t iRepeat = 0; iRepeat < context.m_cRepeats; ++iRepeat) {
+            ResetPeakRss();
+            const double tStart = BenchSeconds();
+            error = Fit(context, dataSet, bag, mode.m_flags, zone.m_acceleration, sObjective, roundSeconds);
+            const double seconds = BenchSeconds() - tStart;
+            if(Error_None != error) {
+               break;
+            }
+            cPeakRssBytes = std::max(cPeakRssBytes, GetPeakRssBytes());
+            if(0 == iRepeat || seconds < best) {
+               best = seconds;
+               bestRoundSeconds.swap(roundSeconds);
+            }
+         }
+         if(Error_None != error) {
+            ReportFailure(k_sName, zone.m_sName, error);
+            continue;
+         }
+
+         BenchResult result(k_sName, zone.m_sName, params, dataSet.m_cSamples * dataSet.m_cFeatures * context.m_cRounds,
+            best, 0.0);
+         result.m_cPeakRssBytes = cPeakRssBytes;
+         result.m_latencyP50 = Percentile(bestRoundSeconds, 0.50);
+         result.m_latencyP90 = Percentile(bestRoundSeconds, 0.90);
+         result.m_latencyP99 = Percentile(bestRoundSeconds, 0.99);
+         context.Report(result);
+      }
+   }
+}
+
+// Boosting with float gradients against int16 and int8 quantized gradients. The quantized fits stream a half or a
+// quarter of the gradient bytes through BinSums and never hold the float gradients of the training set, which shows
+// up in peak_rss, and the best validation metric shows what the rounding costs in accuracy.
+static void BenchTrainQuantized(
+   BenchContext & context,
+   const std::vector<BenchZone> & zones,
+   const BenchDataSet & dataSet,
+   const std::vector<BagEbm> & bag
+) {
+   static const char k_sName[] = "TrainQuantized";
+   if(!context.IsSelected(k_sName)) {
+      return;
+   }
+
+   struct QuantizeMode final {
+      const char * m_sName;
+      CreateBoosterFlags m_flags;
+   };
+   static const QuantizeMode k_modes[] {
+      { "float", CreateBoosterFlags_Default },
+      { "int16", CreateBoosterFlags_QuantizeGradients16 },
+      { "int8", CreateBoosterFlags_QuantizeGradients8 },
+      { "float_offload", CreateBoosterFlags_HostOffload },
+      { "int16_offload", CreateBoosterFlags_QuantizeGradients16 | CreateBoosterFlags_HostOffload },
+   };
+
+   const char * const sObjective = Task_Regression == context.m_cClasses ? "rmse" : "log_loss";
+   // binary fits report the validation auc, which only moves if the rounding noise reorders the validation samples
+   const char * const sValidationMetric = 2 == context.m_cClasses ? "auc" : nullptr;
+
+   std::vector<double> roundSeconds;
+   std::vector<double> bestRoundSeconds;
+   for(const BenchZone & zone : zones) {
+      for(const QuantizeMode & mode : k_modes) {
+         char sMode[64];
+         snprintf(sMode, sizeof(sMode), " rounds=%zu %s%s", context.m_cRounds, mode.m_sName,
+            nullptr != sValidationMetric ? " metric=auc" : "");
+         const std::string params = ShapeParams(context) + sMode;
+
+         double best = 0.0;
+         double metric = 0.0;
+         size_t cPeakRssBytes = 0;
+         ErrorEbm error = Error_None;
+         for(size_t iRepeat = 0; iRepeat < context.m_cRepeats; ++iRepeat) {
+            ResetPeakRss();
+            const double tStart = BenchSeconds();
+            error = Fit(context, dataSet, bag, mode.m_flags, zone.m_acceleration, sObjective, roundSeconds, &metric, 0,
+               sValidationMetric);
+            const double seconds = BenchSeconds() - tStart;
+            if(Error_None != error) {
+               break;
+            }
+            cPeakRssBytes = std::max(cPeakRssBytes, GetPeakRssBytes());
+            if(0 == iRepeat || seconds < best) {
+               best = seconds;
+               bestRoundSeconds.swap(roundSeconds);
+            }
+         }
+         if(Error_None != error) {
+            ReportFailure(k_sName, zone.m_sName, error);
+            continue;
+         }
+
+         BenchResult result(k_sName, zone.m_sName, params, dataSet.m_cSamples * dataSet.m_cFeatures * context.m_cRounds,
+            best, 0.0);
+         result.m_cPeakRssBytes = cPeakRssBytes;
+         result.m_latencyP50 = Percentile(bestRoundSeconds, 0.50);
+         result.m_latencyP90 = Percentile(bestRoundSeconds, 0.90);
+         result.m_latencyP99 = Percentile(bestRoundSeconds, 0.99);
+         // the fits are deterministic, so every repeat reaches the same metric. auc comes back negated
+         result.m_metric = nullptr != sValidationMetric ? -metric : metric;
+         context.Report(result);
+      }
+   }
+}
+
+// Boosting with 50 inner bags. Each bag holds a weight and an occurrence count per training sample, which shows up
+// in peak_rss, and each term update sums every bag, which shows up in the time.
+static void BenchTrainInnerBags(
+   BenchContext & context,
+   const std::vector<BenchZone> & zones,
+   const BenchDataSet & dataSet,
+   const std::vector<BagEbm> & bag
+) {
+   static const char k_sName[] = "TrainInnerBags";
+   if(!context.IsSelected(k_sName)) {
+      return;
+   }
+
+   static constexpr IntEbm k_cInnerBags = 50;
+
+   const char * const sObjective = Task_Regression == context.m_cClasses ? "rmse" : "log_loss";
+
+   std::vector<double> roundSeconds;
+   std::vector<double> bestRoundSeconds;
+   for(const BenchZone & zone : zones) {
+      char sMode[64];
+      snprintf(sMode, sizeof(sMode), " rounds=%zu inner_bags=%lld", context.m_cRounds,
+         static_cast<long long>(k_cInnerBags));
+      const std::string params = ShapeParams(context) + sMode;
+
+      double best = 0.0;
+      double metric = 0.0;
+      size_t cPeakRssBytes = 0;
+      ErrorEbm error = Error_None;
+      for(size_t iRepeat = 0; iRepeat < context.m_cRepeats; ++iRepeat) {
+         ResetPeakRss();
+         const double tStart = BenchSeconds();
+         error = Fit(context, dataSet, bag, CreateBoosterFlags_Default, zone.m_acceleration, sObjective, roundSeconds,
+            &metric, k_cInnerBags);
+         const double seconds = BenchSeconds() - tStart;
+         if(Error_None != error) {
+            break;
+         }
+         cPeakRssBytes = std::max(cPeakRssBytes, GetPeakRssBytes());
+         if(0 == iRepeat || seconds < best) {
+            best = seconds;
+            bestRoundSeconds.swap(roundSeconds);
+         }
+      }
+      if(Error_None != error) {
+         ReportFailure(k_sName, zone.m_sName, error);
+         continue;
+      }
+
+      // each term update sums every inner bag, so the samples are counted once per bag
+      BenchResult result(k_sName, zone.m_sName, params,
+         dataSet.m_cSamples * dataSet.m_cFeatures * context.m_cRounds * static_cast<size_t>(k_cInnerBags), best, 0.0);
+      result.m_cPeakRssBytes = cPeakRssBytes;
+      result.m_latencyP50 = Percentile(bestRoundSeconds, 0.50);
+      result.m_latencyP90 = Percentile(bestRoundSeconds, 0.90);
+      result.m_latencyP99 = Percentile(bestRoundSeconds, 0.99);
+      result.m_metric = metric;
+      context.Report(result);
+   }
+}
+
+static void BenchTrainInteractions(
+   BenchContext & context,
+   const std::vector<BenchZone> & zones,
+   const BenchDataSet & dataSet,
+   const std::vector<BagEbm> & bag
+) {
+   static const char k_sName[] = "TrainInteractions";
+   if(!context.IsSelected(k_sName)) {
+      return;
+   }
+
+   std::vector<IntEbm> pairs;
+   for(size_t iFeature1 = 0; iFeature1 < dataSet.m_cFeatures; ++iFeature1) {
+      for(size_t iFeature2 = iFeature1 + 1; iFeature2 < dataSet.m_cFeatures; ++iFeature2) {
+         if(0 != context.m_cPairs && context.m_cPairs * 2 <= pairs.size()) {
+            break;
+         }
+         pairs.push_back(static_cast<IntEbm>(iFeature1));
+         pairs.push_back(static_cast<IntEbm>(iFeature2));
+      }
+   }
+   const size_t cPairs = pairs.size() / 2;
+   if(0 == cPairs) {
+      return;
+   }
+
+   const char * const sObjective = Task_Regression == context.m_cClasses ? "rmse" : "log_loss";
+   char sPairs[32];
+   snprintf(sPairs, sizeof(sPairs), " pairs=%zu", cPairs);
+   const std::string params = ShapeParams(context) + sPairs;
+
+   std::vector<double> pairSeconds;
+   std::vector<double> bestPairSeconds;
+   for(const BenchZone & zone : zones) {
+      double best = 0.0;
+      size_t cPeakRssBytes = 0;
+      ErrorEbm error = Error_None;
+      for(size_t iRepeat = 0; iRepeat < context.m_cRepeats && Error_None == error; ++iRepeat) {
+         ResetPeakRss();
+         pairSeconds.clear();
+         const double tStart = BenchSeconds();
+         InteractionHandle interactionHandle = nullptr;
+         error = CreateInteractionDetector(
+            &dataSet.m_data[0],
+            &bag[0],
+            nullptr,
+            CreateInteractionFlags_Default,
+            zone.m_acceleration,
+            sObjective,
+            nullptr,
+            &interactionHandle
+         );
+         if(Error_None != error) {
+            break;
+         }
+         for(size_t iPair = 0; iPair < cPairs; ++iPair) {
+            const double tPair = BenchSeconds();
+            double strength;
+            error = CalcInteractionStrength(
+               interactionHandle,
+               2,
+               &pairs[iPair * 2],
+               CalcInteractionFlags_Default,
+               0,
+               2,
+               &strength
+            );
+            if(Error_None != error) {
+               break;
+            }
+            pairSeconds.push_back(BenchSeconds() - tPair);
+         }
+         FreeInteractionDetector(interactionHandle);
+         const double seconds = BenchSeconds() - tStart;
+         if(Error_None != error) {
+            break;
+         }
+         cPeakRssBytes = std::max(cPeakRssBytes, GetPeakRssBytes());
+         if(0 == iRepeat || seconds < best) {
+            best = seconds;
+            bestPairSeconds.swap(pairSeconds);
+         }
+      }
+      if(Error_None != error) {
+         ReportFailure(k_sName, zone.m_sName, error);
+         continue;
+      }
+
+      BenchResult result(k_sName, zone.m_sName, params, dataSet.m_cSamples * cPairs, best, 0.0);
+      result.m_cPeakRssBytes = cPeakRssBytes;
+      result.m_latencyP50 = Percentile(bestPairSeconds, 0.50);
+      result.m_latencyP90 = Percentile(bestPairSeconds, 0.90);
+      result.m_latencyP99 = Percentile(bestPairSeconds, 0.99);
+      context.Report(result);
+   }
+}
+
+void RunTrainingBenchmarks(BenchContext & context) {
+   if(!context.IsSelected("TrainBoosting") && !context.IsSelected("TrainOffload") && 
+      !context.IsSelected("TrainQuantized") && !context.IsSelected("TrainInnerBags") &&
+      !context.IsSelected("TrainInteractions")) {
+      return;
+   }
+
+   const std::vector<BenchZone> zones = GetBenchZones();
+
+   BenchRng rng(k_seedDataSets);
+   BenchDataSet dataSet;
+   const std::vector<IntEbm> binCounts(context.m_cFeatures, static_cast<IntEbm>(context.m_cBins));
+   const ErrorEbm error = MakeBenchDataSet(rng, context.m_cSamples, binCounts, context.m_cClasses, dataSet);
+   if(Error_None != error) {
+      ReportFailure("Train", "-", error);
+      return;
+   }
+
+   std::vector<BagEbm> bag(dataSet.m_cSamples);
+   for(BagEbm & replication : bag) {
+      replication = rng.NextUnit() < k_validationFraction ? BagEbm { -1 } : BagEbm { 1 };
+   }
+
+   BenchTrainBoosting(context, zones, dataSet, bag);
+   BenchTrainOffload(context, zones, dataSet, bag);
+   BenchTrainQuantized(context, zones, dataSet, bag);
+   BenchTrainInnerBags(context, zones, dataSet, bag);
+   BenchTrainInteractions(context, zones, dataSet, bag);
+}
@@ -42,9 +42,20 @@ struct ApplyUpdateBridge {
    void * m_aSampleScores; // float or double
    void * m_aGradientsAndHessians; // float or double
 
+   // when not NULL the validation pass adds the samples into this score histogram (see MetricWrapper) instead
+   // of summing the objective's own metric into m_metricOut
+   size_t m_cMetricBins;
+   double * m_aMetricBins;
+   // a score lands in bin (score - m_metricScoreLow) * m_metricScoreScale, clamped to the histogram
+   double m_metricScoreLow;
+   double m_metricScoreScale;
+
    double m_metricOut;
 };
 
+// the count and weight words that come before the gradient and hessian sums of each quantized bin
+#define k_cQuantizedBinHeaderWords (STATIC_CAST(size_t, 2))
+
 struct BinSumsBoostingBridge {
    BoolEbm m_bHessian;
    size_t m_cScores;
@@ -52,12 +63,18 @@ struct BinSumsBoostingBridge {
    int m_cPack;
 
    size_t m_cSamples;
-   const void * m_aGradientsAndHessians; // float or double
+   const void * m_aGradientsAndHessians; // float or double, or int8_t or int16_t for m_pBinSumsBoostingQuantizedC
    const void * m_aWeights; // float or double
    const uint8_t * m_pCountOccurrences;
    const void * m_aPacked; // uint64_t or uint32_t
 
-   void * m_aFastBins; // Bin<...> (can't use BinBase * since this is only C here)
+   // only read by m_pBinSumsBoostingQuantizedC, where it is sizeof(int8_t) or sizeof(int16_t)
+   size_t m_cBytesQuantized;
+
+   // Bin<...> (can't use BinBase * since this is only C here). The quantized bin sums instead use
+   // k_cQuantizedBinHeaderWords + cScores * (m_bHessian ? 2 : 1) words per bin, holding the count, the weight, and
+   // the sum of each gradient and hessian. The words are int64_t, or double if there are weights
+   void * m_aFastBins;
 
 #ifndef NDEBUG
    const void * m_pDebugFastBinsEnd;
@@ -70,7 +87,7 @@ struct BinSumsInteractionBridge {
 
    size_t m_cSamples;
    const void * m_aGradientsAndHessians; // float or double
-   const void * m_aWeights; // float or double
+   const void * m_aWeights; // float or double. If nullptr the bin weights are left untouched since they equal the counts
 
    size_t m_cRuntimeRealDimensions;
    size_t m_acBins[k_cDimensionsMax];
@@ -97,6 +114,7 @@ typedef ErrorEbm (* BIN_SUMS_INTERACTION_C)(const ObjectiveWrapper * const pObje
 struct ObjectiveWrapper {
    APPLY_UPDATE_C m_pApplyUpdateC;
    BIN_SUMS_BOOSTING_C m_pBinSumsBoostingC;
+   BIN_SUMS_BOOSTING_C m_pBinSumsBoostingQuantizedC; // NULL if the zone cannot sum quantized gradients
    BIN_SUMS_INTERACTION_C m_pBinSumsInteractionC;
    // everything below here the C++ *Objective specific class needs to fill out
 
@@ -121,6 +139,7 @@ struct ObjectiveWrapper {
    double m_hessianConstant;
    BoolEbm m_bObjectiveHasHessian;
    BoolEbm m_bRmse;
+   BoolEbm m_bMetricBins; // the validation kernel can fill ApplyUpdateBridge::m_aMetricBins
 
    size_t m_cSIMDPack;
 
@@ -131,6 +150,10 @@ struct ObjectiveWrapper {
 
    // these are C++ function pointer definitions that exist per-zone, and must remain hidden in the C interface
    void * m_pFunctionPointersCpp;
+
+   // OffloadQueue * owned by the main zone. When set, the function pointers above are called from the 
+   // queue's threads instead of directly, and the memory they stream over is allocated through the queue
+   void * m_pOffloadQueue;
 };
 
 inline static void InitializeObjectiveWrapperUnfailing(ObjectiveWrapper * const pObjectiveWrapper) {
@@ -147,10 +170,12 @@ inline static void InitializeObjectiveWrapperUnfailing(ObjectiveWrapper * const
    pObjectiveWrapper->m_hessianConstant = 0.0;
    pObjectiveWrapper->m_bObjectiveHasHessian = EBM_FALSE;
    pObjectiveWrapper->m_bRmse = EBM_FALSE;
+   pObjectiveWrapper->m_bMetricBins = EBM_FALSE;
    pObjectiveWrapper->m_cSIMDPack = 0;
    pObjectiveWrapper->m_cFloatBytes = 0;
    pObjectiveWrapper->m_cUIntBytes = 0;
    pObjectiveWrapper->m_pFunctionPointersCpp = NULL;
+   pObjectiveWrapper->m_pOffloadQueue = NULL;
 }
 
 inline static void FreeObjectiveWrapperInternals(ObjectiveWrapper * const pObjectiveWrapper) {
@@ -158,6 +183,32 @@ inline static void FreeObjectiveWrapperInternals(ObjectiveWrapper * const pObjec
    free(pObjectiveWrapper->m_pFunctionPointersCpp);
 }
 
+// Metrics are computed on the CPU from a histogram of the validation sample scores that the objective's validation
+// kernel builds while it updates the scores, so choosing a metric does not add a pass over the validation set.
+// The histogram holds m_cMetricBins doubles, which are the summed weights of the samples in each score bin,
+// interleaved by target class.
+struct MetricWrapper {
+   void * m_pMetric;
+
+   BoolEbm m_bMaximizeMetric;
+   size_t m_cMetricBins;
+
+   // these are C++ function pointer definitions that exist per-zone, and must remain hidden in the C interface
+   void * m_pFunctionPointersCpp;
+};
+
+inline static void InitializeMetricWrapperUnfailing(MetricWrapper * const pMetricWrapper) {
+   pMetricWrapper->m_pMetric = NULL;
+   pMetricWrapper->m_bMaximizeMetric = EBM_FALSE;
+   pMetricWrapper->m_cMetricBins = 0;
+   pMetricWrapper->m_pFunctionPointersCpp = NULL;
+}
+
+inline static void FreeMetricWrapperInternals(MetricWrapper * const pMetricWrapper) {
+   AlignedFree(pMetricWrapper->m_pMetric);
+   free(pMetricWrapper->m_pFunctionPointersCpp);
+}
+
 struct Config {
    // don't use m_ notation here, mostly to make it cleaner for people writing *Objective classes
    size_t cOutputs;
@@ -195,14 +246,18 @@ INTERNAL_IMPORT_EXPORT_INCLUDE ErrorEbm CreateObjective_Cuda_32(
 INTERNAL_IMPORT_EXPORT_INCLUDE ErrorEbm CreateMetric_Cpu_64(
    const Config * const pConfig,
    const char * const sMetric,
-   const char * const sMetricEnd
-   //   MetricWrapper * const pMetricWrapperOut,
+   const char * const sMetricEnd,
+   MetricWrapper * const pMetricWrapperOut
 );
 
 INTERNAL_IMPORT_EXPORT_INCLUDE double FinishMetricC(
    const ObjectiveWrapper * const pObjectiveWrapper,
    const double metricSum
 );
+INTERNAL_IMPORT_EXPORT_INCLUDE double FinishMetricBinsC(
+   const MetricWrapper * const pMetricWrapper,
+   const double * const aMetricBins
+);
 INTERNAL_IMPORT_EXPORT_INCLUDE BoolEbm CheckTargetsC(
    const ObjectiveWrapper * const pObjectiveWrapper,
    const size_t c, 
@@ -19,3 +19,9 @@
 #else
 #error ZONE not recognized
 #endif
+
+#if defined(LOG_ELIDE_COMPUTE) && !defined(ZONE_main)
+// the compute zones run the per-sample loops, so LOG_ELIDE_COMPUTE keeps only their errors and warnings
+#undef LOG_TRACE_LEVEL_COMPILED
+#define LOG_TRACE_LEVEL_COMPILED Trace_Warning
+#endif // LOG_ELIDE_COMPUTE
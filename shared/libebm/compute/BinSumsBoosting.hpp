@@ -649,11 +649,12 @@ template<typename TFloat>
 INLINE_RELEASE_TEMPLATED static ErrorEbm BinSumsBoosting(BinSumsBoostingBridge * const pParams) {
    LOG_0(Trace_Verbose, "Entered BinSumsBoosting");
 
-   // all our memory should be aligned. It is required by SIMD for correctness or performance
-   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians));
-   EBM_ASSERT(IsAligned(pParams->m_aWeights));
-   EBM_ASSERT(IsAligned(pParams->m_pCountOccurrences));
-   EBM_ASSERT(IsAligned(pParams->m_aPacked));
+   // all our memory should be aligned. It is required by SIMD for correctness or performance.
+   // ApplyTermUpdateFused starts the per-sample streams at SIMD pack boundaries, so those only have SIMD alignment
+   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians, sizeof(typename TFloat::T) * size_t { TFloat::k_cSIMDPack }));
+   EBM_ASSERT(IsAligned(pParams->m_aWeights, sizeof(typename TFloat::T) * size_t { TFloat::k_cSIMDPack }));
+   EBM_ASSERT(IsAligned(pParams->m_pCountOccurrences, sizeof(uint8_t) * size_t { TFloat::k_cSIMDPack }));
+   EBM_ASSERT(IsAligned(pParams->m_aPacked, sizeof(typename TFloat::TInt::T) * size_t { TFloat::k_cSIMDPack }));
    EBM_ASSERT(IsAligned(pParams->m_aFastBins));
 
    ErrorEbm error;
@@ -736,6 +737,186 @@ INLINE_RELEASE_TEMPLATED static ErrorEbm BinSumsBoosting(BinSumsBoostingBridge *
    return error;
 }
 
+
+// The quantized gradients and hessians are int8_t or int16_t with the same SIMD layout as the float ones. We pull the
+// bin indexes out of the packed data in SIMD registers like BinSumsBoostingInternal, and then add the narrow integers
+// into 64 bit sums. Without weights the sums are exact integers, and the main zone applies the scale of each gradient
+// and hessian once per bin when it converts them into the main bins.
+template<typename TFloat, typename TQuant, bool bHessian, bool bWeight, bool bReplication, size_t cCompilerScores>
+NEVER_INLINE static void BinSumsBoostingQuantizedInternal(BinSumsBoostingBridge * const pParams) {
+   static_assert(bWeight || !bReplication, "bReplication cannot be true if bWeight is false");
+   static_assert(std::is_signed<TQuant>::value, "TQuant must be a signed integer type");
+
+   typedef typename std::conditional<bWeight, double, int64_t>::type TSum;
+
+   EBM_ASSERT(nullptr != pParams);
+   EBM_ASSERT(1 <= pParams->m_cSamples);
+   EBM_ASSERT(0 == pParams->m_cSamples % size_t { TFloat::k_cSIMDPack });
+   EBM_ASSERT(nullptr != pParams->m_aGradientsAndHessians);
+   EBM_ASSERT(nullptr != pParams->m_aFastBins);
+   EBM_ASSERT(1 <= pParams->m_cScores);
+   EBM_ASSERT(k_dynamicScores == cCompilerScores || cCompilerScores == pParams->m_cScores);
+
+   // with a single score the slot loops below have a fixed length that the compiler unrolls
+   const size_t cScores = GET_COUNT_SCORES(cCompilerScores, pParams->m_cScores);
+   const size_t cSlots = bHessian ? cScores << 1 : cScores;
+   const size_t cWordsPerBin = k_cQuantizedBinHeaderWords + cSlots;
+   const size_t cSlotItems = cSlots << TFloat::k_cSIMDShift;
+
+   TSum * const aBins = reinterpret_cast<TSum *>(pParams->m_aFastBins);
+
+   const TQuant * pGradientAndHessian = reinterpret_cast<const TQuant *>(pParams->m_aGradientsAndHessians);
+   const TQuant * const pGradientsAndHessiansEnd = pGradientAndHessian + cSlots * pParams->m_cSamples;
+
+   const typename TFloat::T * pWeight = nullptr;
+   const uint8_t * pCountOccurrences = nullptr;
+   if(bWeight) {
+      pWeight = reinterpret_cast<const typename TFloat::T *>(pParams->m_aWeights);
+      EBM_ASSERT(nullptr != pWeight);
+      if(bReplication) {
+         pCountOccurrences = pParams->m_pCountOccurrences;
+         EBM_ASSERT(nullptr != pCountOccurrences);
+      }
+   }
+
+   const auto addSample = [aBins, cWordsPerBin, cSlots](
+      const size_t iTensorBin,
+      const TQuant * const pGradHess,
+      const typename TFloat::T * const pWeightSample,
+      const uint8_t * const pCountOccurrencesSample
+   ) {
+      TSum * const pBin = &aBins[iTensorBin * cWordsPerBin];
+      TSum * const aSums = pBin + k_cQuantizedBinHeaderWords;
+      if(bWeight) {
+         const double weight = static_cast<double>(*pWeightSample);
+         pBin[0] += bReplication ? static_cast<double>(*pCountOccurrencesSample) : 1.0;
+         pBin[1] += weight;
+         size_t iSlot = 0;
+         do {
+            aSums[iSlot] += static_cast<double>(pGradHess[iSlot << TFloat::k_cSIMDShift]) * weight;
+            ++iSlot;
+         } while(cSlots != iSlot);
+      } else {
+         ++pBin[0];
+         size_t iSlot = 0;
+         do {
+            aSums[iSlot] += static_cast<int64_t>(pGradHess[iSlot << TFloat::k_cSIMDShift]);
+            ++iSlot;
+         } while(cSlots != iSlot);
+      }
+   };
+
+   const int cItemsPerBitPack = pParams->m_cPack;
+   if(k_cItemsPerBitPackNone == cItemsPerBitPack) {
+      do {
+         for(int iPartition = 0; iPartition < TFloat::k_cSIMDPack; ++iPartition) {
+            addSample(0, pGradientAndHessian + iPartition, pWeight + iPartition, pCountOccurrences + iPartition);
+         }
+         pGradientAndHessian += cSlotItems;
+         if(bWeight) {
+            pWeight += TFloat::k_cSIMDPack;
+            if(bReplication) {
+               pCountOccurrences += TFloat::k_cSIMDPack;
+            }
+         }
+      } while(pGradientsAndHessiansEnd != pGradientAndHessian);
+      return;
+   }
+
+   EBM_ASSERT(1 <= cItemsPerBitPack);
+   EBM_ASSERT(cItemsPerBitPack <= COUNT_BITS(typename TFloat::TInt::T));
+
+   const int cBitsPerItemMax = GetCountBits<typename TFloat::TInt::T>(cItemsPerBitPack);
+   EBM_ASSERT(1 <= cBitsPerItemMax);
+   EBM_ASSERT(cBitsPerItemMax <= COUNT_BITS(typename TFloat::TInt::T));
+
+   int cShift = static_cast<int>(((pParams->m_cSamples >> TFloat::k_cSIMDShift) - size_t { 1 }) % 
+      static_cast<size_t>(cItemsPerBitPack)) * cBitsPerItemMax;
+   const int cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
+
+   const typename TFloat::TInt maskBits = MakeLowMask<typename TFloat::TInt::T>(cBitsPerItemMax);
+
+   const typename TFloat::TInt::T * pInputData = reinterpret_cast<const typename TFloat::TInt::T *>(pParams->m_aPacked);
+   EBM_ASSERT(nullptr != pInputData);
+
+   do {
+      const typename TFloat::TInt iTensorBinCombined = TFloat::TInt::Load(pInputData);
+      pInputData += TFloat::TInt::k_cSIMDPack;
+      do {
+         const typename TFloat::TInt iTensorBin = (iTensorBinCombined >> cShift) & maskBits;
+
+         // several samples in the pack can land in the same bin, so the adds are serialized like the float version
+         TFloat::TInt::Execute([&addSample, pGradientAndHessian, pWeight, pCountOccurrences](
+            const int iPartition, 
+            const typename TFloat::TInt::T i
+         ) {
+            addSample(static_cast<size_t>(i), pGradientAndHessian + iPartition, 
+               pWeight + iPartition, pCountOccurrences + iPartition);
+         }, iTensorBin);
+
+         pGradientAndHessian += cSlotItems;
+         if(bWeight) {
+            pWeight += TFloat::k_cSIMDPack;
+            if(bReplication) {
+               pCountOccurrences += TFloat::k_cSIMDPack;
+            }
+         }
+
+         cShift -= cBitsPerItemMax;
+      } while(0 <= cShift);
+      cShift = cShiftReset;
+   } while(pGradientsAndHessiansEnd != pGradientAndHessian);
+}
+
+template<typename TFloat, typename TQuant, bool bHessian, bool bWeight, bool bReplication>
+INLINE_RELEASE_TEMPLATED static void BinSumsBoostingQuantizedScores(BinSumsBoostingBridge * const pParams) {
+   if(size_t { 1 } == pParams->m_cScores) {
+      BinSumsBoostingQuantizedInternal<TFloat, TQuant, bHessian, bWeight, bReplication, k_oneScore>(pParams);
+   } else {
+      BinSumsBoostingQuantizedInternal<TFloat, TQuant, bHessian, bWeight, bReplication, k_dynamicScores>(pParams);
+   }
+}
+
+template<typename TFloat, typename TQuant, bool bHessian>
+INLINE_RELEASE_TEMPLATED static void BinSumsBoostingQuantizedWeight(BinSumsBoostingBridge * const pParams) {
+   if(nullptr != pParams->m_aWeights) {
+      if(nullptr != pParams->m_pCountOccurrences) {
+         BinSumsBoostingQuantizedScores<TFloat, TQuant, bHessian, true, true>(pParams);
+      } else {
+         BinSumsBoostingQuantizedScores<TFloat, TQuant, bHessian, true, false>(pParams);
+      }
+   } else {
+      // we use the weights to hold both the weights and the inner bag counts if there are inner bags
+      EBM_ASSERT(nullptr == pParams->m_pCountOccurrences);
+      BinSumsBoostingQuantizedScores<TFloat, TQuant, bHessian, false, false>(pParams);
+   }
+}
+
+template<typename TFloat, typename TQuant>
+INLINE_RELEASE_TEMPLATED static void BinSumsBoostingQuantizedHessian(BinSumsBoostingBridge * const pParams) {
+   if(EBM_FALSE != pParams->m_bHessian) {
+      BinSumsBoostingQuantizedWeight<TFloat, TQuant, true>(pParams);
+   } else {
+      BinSumsBoostingQuantizedWeight<TFloat, TQuant, false>(pParams);
+   }
+}
+
+template<typename TFloat>
+INLINE_RELEASE_TEMPLATED static ErrorEbm BinSumsBoostingQuantized(BinSumsBoostingBridge * const pParams) {
+   LOG_0(Trace_Verbose, "Entered BinSumsBoostingQuantized");
+
+   if(sizeof(int8_t) == pParams->m_cBytesQuantized) {
+      BinSumsBoostingQuantizedHessian<TFloat, int8_t>(pParams);
+   } else {
+      EBM_ASSERT(sizeof(int16_t) == pParams->m_cBytesQuantized);
+      BinSumsBoostingQuantizedHessian<TFloat, int16_t>(pParams);
+   }
+
+   LOG_0(Trace_Verbose, "Exited BinSumsBoostingQuantized");
+
+   return Error_None;
+}
+
 } // DEFINED_ZONE_NAME
 
 #endif // BIN_SUMS_BOOSTING_HPP
\ No newline at end of file
@@ -221,14 +221,9 @@ GPU_DEVICE NEVER_INLINE static void BinSumsInteractionInternal(BinSumsInteractio
             //       such that we can remove that field optionally
             pBin->SetWeight(pBin->GetWeight() + x);
          }, weight);
-      } else {
-         TFloat::Execute([apBins](const int i) {
-            auto * const pBin = apBins[i];
-            // TODO: In the future we'd like to eliminate this but we need the ability to change the Bin class
-            //       such that we can remove that field optionally
-            pBin->SetWeight(pBin->GetWeight() + typename TFloat::T { 1.0 });
-         });
       }
+      // without weights every sample weighs 1.0, so the bin weights are the bin counts and our caller fills them in
+      // after summing instead of us paying for a second serialized read-modify-write per sample here
 
       size_t iScore = 0;
       do {
@@ -355,25 +350,17 @@ INLINE_RELEASE_TEMPLATED static ErrorEbm BinSumsInteraction(BinSumsInteractionBr
          static constexpr bool bWeights = true;
          if(size_t { 1 } == pParams->m_cScores) {
             error = CountDimensionsInteraction<TFloat, bHessian, bWeights, k_oneScore, 1>::Func(pParams);
-         } else if(size_t { 1 } == pParams->m_cRuntimeRealDimensions) {
-            // Odd: gradient multiclass. Allow it, but do not optimize for it
-            // we need to special case 1 dimension
-            error = OperatorBinSumsInteraction<TFloat, bHessian, bWeights, k_dynamicScores, 1>(pParams);
          } else {
-            // Odd: gradient multiclass. Allow it, but do not optimize for it
-            error = OperatorBinSumsInteraction<TFloat, bHessian, bWeights, k_dynamicScores, k_dynamicDimensions>(pParams);
+            // gradient-only muticlass is the default for interaction detection when Newton is not requested
+            error = CountClassesInteraction<TFloat, bHessian, bWeights, k_cCompilerScoresStart>::Func(pParams);
          }
       } else {
          static constexpr bool bWeights = false;
          if(size_t { 1 } == pParams->m_cScores) {
             error = CountDimensionsInteraction<TFloat, bHessian, bWeights, k_oneScore, 1>::Func(pParams);
-         } else if(size_t { 1 } == pParams->m_cRuntimeRealDimensions) {
-            // Odd: gradient multiclass. Allow it, but do not optimize for it
-            // we need to special case 1 dimension
-            error = OperatorBinSumsInteraction<TFloat, bHessian, bWeights, k_dynamicScores, 1>(pParams);
          } else {
-            // Odd: gradient multiclass. Allow it, but do not optimize for it
-            error = OperatorBinSumsInteraction<TFloat, bHessian, bWeights, k_dynamicScores, k_dynamicDimensions>(pParams);
+            // gradient-only muticlass is the default for interaction detection when Newton is not requested
+            error = CountClassesInteraction<TFloat, bHessian, bWeights, k_cCompilerScoresStart>::Func(pParams);
          }
       }
    }
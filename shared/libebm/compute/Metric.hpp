@@ -0,0 +1,196 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// !!! NOTE: To add a new metric in C++, follow the steps listed at the top of the "metric_registrations.hpp" file !!!
+
+#ifndef METRIC_HPP
+#define METRIC_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <memory> // shared_ptr, unique_ptr
+#include <type_traits> // is_same
+#include <vector>
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // INLINE_ALWAYS
+
+#include "bridge.h" // MetricWrapper
+
+#include "zoned_bridge_cpp_functions.hpp" // MetricFunctionPointersCpp
+#include "compute.hpp" // GPU_DEVICE
+#include "registration_exceptions.hpp"
+#include "Registration.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+template<typename TFloat>
+static const std::vector<std::shared_ptr<const Registration>> RegisterMetrics();
+
+// The validation score histogram has k_cMetricScoreBins bins that evenly cover the score range that the main zone
+// passes in ApplyUpdateBridge::m_metricScoreLow and m_metricScoreScale. That range is bounded from the bins that
+// the previous validation pass filled plus the lowest and highest score in the update being applied, so it follows
+// the validation scores as boosting spreads them out instead of being fixed. Scores outside of the range, which only
+// happen through rounding or NaN, go into the first or last bin. Samples whose scores fall into the same bin are
+// not ordered by the histogram, so metrics treat them as ties. Each bin holds two doubles: the weight of the
+// samples with target 0 followed by target 1.
+static constexpr size_t k_cMetricScoreBins = 4096;
+static constexpr size_t k_cMetricBins = k_cMetricScoreBins * size_t { 2 };
+
+template<typename TFloat>
+GPU_DEVICE INLINE_ALWAYS static TFloat GetMetricScoreBin(
+   const TFloat & score,
+   const TFloat & scoreLow,
+   const TFloat & scale
+) noexcept {
+   static constexpr double k_binLast = static_cast<double>(k_cMetricScoreBins - size_t { 1 });
+
+   TFloat position = (score - scoreLow) * scale;
+   // NaN scores can happen if boosting diverges, and we put them into the first bin along with the lowest scores
+   position = IfNaN(position, 0.0, position);
+   position = IfLess(position, 0.0, 0.0, position);
+   position = IfLess(k_binLast, position, k_binLast, position);
+   return position;
+}
+
+// called from the validation kernels of the binary objectives that set k_bMetricBins, once per SIMD pack of samples
+template<typename TFloat, bool bWeight>
+GPU_DEVICE INLINE_ALWAYS static void AddMetricBins(
+   double * const aMetricBins,
+   const TFloat & score,
+   const typename TFloat::TInt & target,
+   const TFloat & weight,
+   const TFloat & scoreLow,
+   const TFloat & scale
+) noexcept {
+   const TFloat position = GetMetricScoreBin(score, scoreLow, scale);
+   if(bWeight) {
+      TFloat::Execute([aMetricBins](int, const typename TFloat::TInt::T t, const typename TFloat::T bin, const typename TFloat::T w) {
+         aMetricBins[(static_cast<size_t>(bin) << 1) + static_cast<size_t>(t)] += static_cast<double>(w);
+      }, target, position, weight);
+   } else {
+      TFloat::Execute([aMetricBins](int, const typename TFloat::TInt::T t, const typename TFloat::T bin) {
+         aMetricBins[(static_cast<size_t>(bin) << 1) + static_cast<size_t>(t)] += 1.0;
+      }, target, position);
+   }
+}
+
+struct Metric : public Registrable {
+protected:
+
+   template<typename TMetric>
+   INLINE_RELEASE_TEMPLATED void FillMetricWrapper(const AccelerationFlags zones, void * const pWrapperOut) noexcept {
+      UNUSED(zones);
+
+      EBM_ASSERT(nullptr != pWrapperOut);
+      MetricWrapper * const pMetricWrapperOut = static_cast<MetricWrapper *>(pWrapperOut);
+      MetricFunctionPointersCpp * const pFunctionPointers =
+         static_cast<MetricFunctionPointersCpp *>(pMetricWrapperOut->m_pFunctionPointersCpp);
+      EBM_ASSERT(nullptr != pFunctionPointers);
+
+      pFunctionPointers->m_pFinishMetricBinsCpp = &TMetric::StaticFinishMetricBins;
+
+      const auto bMaximizeMetric = TMetric::k_bMaximizeMetric;
+      constexpr bool bMaximizeMetricGood = std::is_same<decltype(bMaximizeMetric), const BoolEbm>::value;
+      static_assert(bMaximizeMetricGood, "TMetric::k_bMaximizeMetric should be a BoolEbm");
+      pMetricWrapperOut->m_bMaximizeMetric = bMaximizeMetric;
+
+      pMetricWrapperOut->m_cMetricBins = k_cMetricBins;
+
+      pMetricWrapperOut->m_pMetric = this;
+   }
+
+   Metric() = default;
+   ~Metric() = default;
+
+public:
+
+   template<typename TFloat>
+   static ErrorEbm CreateMetric(
+      const Config * const pConfig,
+      const char * const sMetric,
+      const char * const sMetricEnd,
+      MetricWrapper * const pMetricWrapperOut
+   ) noexcept {
+      static_assert(AccelerationFlags_NONE == TFloat::k_zone, "metrics are only finished on the CPU");
+
+      EBM_ASSERT(nullptr != pConfig);
+      EBM_ASSERT(1 <= pConfig->cOutputs);
+      EBM_ASSERT(nullptr != sMetric);
+      EBM_ASSERT(nullptr != sMetricEnd);
+      EBM_ASSERT(sMetric < sMetricEnd); // empty string not allowed
+      EBM_ASSERT('\0' != *sMetric);
+      EBM_ASSERT(!(0x20 == *sMetric || (0x9 <= *sMetric && *sMetric <= 0xd)));
+      EBM_ASSERT('\0' == *sMetricEnd);
+      EBM_ASSERT(nullptr != pMetricWrapperOut);
+      EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+      EBM_ASSERT(nullptr != pMetricWrapperOut->m_pFunctionPointersCpp);
+
+      LOG_0(Trace_Info, "Entered Metric::CreateMetric");
+
+      ErrorEbm error;
+
+      try {
+         const std::vector<std::shared_ptr<const Registration>> registrations = RegisterMetrics<TFloat>();
+         const bool bFailed = Registration::CreateRegistrable(pConfig, sMetric, sMetricEnd, pMetricWrapperOut, registrations);
+         if(!bFailed) {
+            EBM_ASSERT(nullptr != pMetricWrapperOut->m_pMetric);
+
+            LOG_0(Trace_Info, "Exited Metric::CreateMetric");
+            return Error_None;
+         }
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Info, "Exited Metric::CreateMetric unknown metric");
+         error = Error_MetricUnknown;
+      } catch(const ParamValMalformedException &) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric ParamValMalformedException");
+         error = Error_MetricParamValMalformed;
+      } catch(const ParamUnknownException &) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric ParamUnknownException");
+         error = Error_MetricParamUnknown;
+      } catch(const ParamValOutOfRangeException &) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric ParamValOutOfRangeException");
+         error = Error_MetricParamValOutOfRange;
+      } catch(const ParamMismatchWithConfigException &) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric ParamMismatchWithConfigException");
+         error = Error_MetricMismatchWithObjective;
+      } catch(const std::bad_alloc &) {
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric Out of Memory");
+         error = Error_OutOfMemory;
+      } catch(...) {
+         // the remaining registration exceptions are for illegal names in metric_registrations.hpp, which are our bugs
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric internal error, unknown exception");
+         error = Error_UnexpectedInternal;
+      }
+
+      return error;
+   }
+};
+static_assert(std::is_standard_layout<Metric>::value && std::is_trivially_copyable<Metric>::value,
+   "This allows offsetof, memcpy, memset, inter-language, GPU and cross-machine use where needed");
+
+#define METRIC_BOILERPLATE(__EBM_TYPE, __MAXIMIZE_METRIC) \
+   public: \
+      using TFloatInternal = TFloat; \
+      static constexpr BoolEbm k_bMaximizeMetric = (__MAXIMIZE_METRIC); \
+      static double StaticFinishMetricBins(const Metric * const pThis, const double * const aMetricBins) { \
+         return (static_cast<const __EBM_TYPE<TFloat> *>(pThis))->FinishMetricBins(aMetricBins); \
+      } \
+      void FillWrapper(const AccelerationFlags zones, void * const pWrapperOut) noexcept { \
+         static_assert( \
+            std::is_same<__EBM_TYPE<TFloat>, typename std::remove_pointer<decltype(this)>::type>::value, \
+            "*Metric types mismatch"); \
+         FillMetricWrapper<typename std::remove_pointer<decltype(this)>::type>(zones, pWrapperOut); \
+      }
+
+} // DEFINED_ZONE_NAME
+
+#endif // METRIC_HPP
@@ -84,13 +84,6 @@ GPU_GLOBAL static void RemoteApplyUpdate(const Objective * const pObjective, App
 }
 
 
-struct Registrable {
-   // TODO: move this into its own file once we create Metric classes that are also Registrable
-protected:
-   Registrable() = default;
-   ~Registrable() = default;
-};
-
 struct Objective : public Registrable {
 private:
 
@@ -229,7 +222,7 @@ private:
    INLINE_RELEASE_TEMPLATED ErrorEbm CountApplyUpdate(ApplyUpdateBridge * const pData) const {
       return PackApplyUpdate<TObjective, bValidation, bWeight, bHessian, bDisableApprox, k_oneScore>(pData);
    }
-   template<typename TObjective, bool bValidation, bool bWeight, bool bHessian, bool bDisableApprox, typename std::enable_if<TObjective::IsMultiScore && (std::is_base_of<MulticlassMultitaskObjective, TObjective>::value || !bHessian || bDisableApprox), int>::type = 0>
+   template<typename TObjective, bool bValidation, bool bWeight, bool bHessian, bool bDisableApprox, typename std::enable_if<TObjective::IsMultiScore && std::is_base_of<MulticlassMultitaskObjective, TObjective>::value, int>::type = 0>
    INLINE_RELEASE_TEMPLATED ErrorEbm CountApplyUpdate(ApplyUpdateBridge * const pData) const {
       // multiclass multitask is going to need some really special handling, so use dynamic scores, and skip the bit packing too
       if(k_cItemsPerBitPackNone == pData->m_cPack) {
@@ -239,8 +232,10 @@ private:
          return OperatorApplyUpdate<TObjective, bValidation, bWeight, bHessian, bDisableApprox, k_dynamicScores, k_cItemsPerBitPackDynamic>(pData);
       }
    }
-   template<typename TObjective, bool bValidation, bool bWeight, bool bHessian, bool bDisableApprox, typename std::enable_if<TObjective::IsMultiScore && !(std::is_base_of<MulticlassMultitaskObjective, TObjective>::value || !bHessian || bDisableApprox), int>::type = 0>
+   template<typename TObjective, bool bValidation, bool bWeight, bool bHessian, bool bDisableApprox, typename std::enable_if<TObjective::IsMultiScore && !std::is_base_of<MulticlassMultitaskObjective, TObjective>::value, int>::type = 0>
    INLINE_RELEASE_TEMPLATED ErrorEbm CountApplyUpdate(ApplyUpdateBridge * const pData) const {
+      // the multiclass kernel keeps all the scores of a SIMD pack in registers when the count of scores is known at
+      // compile time, so we specialize for validation and gradient-only boosting too, not just for hessian boosting
       if(k_cItemsPerBitPackNone == pData->m_cPack) {
          // don't blow up our complexity if we have only 1 bin or during init. Just use dynamic for the count of scores
          return OperatorApplyUpdate<TObjective, bValidation, bWeight, bHessian, bDisableApprox, k_dynamicScores, k_cItemsPerBitPackNone>(pData);
@@ -563,6 +558,9 @@ protected:
 
    template<typename TObjective>
    INLINE_RELEASE_TEMPLATED void FillObjectiveWrapper(const AccelerationFlags zones, void * const pWrapperOut) noexcept {
+      static_assert(1 <= TObjective::k_cItemsPerBitPackMin || (k_cItemsPerBitPackDynamic == TObjective::k_cItemsPerBitPackMin && k_cItemsPerBitPackDynamic == TObjective::k_cItemsPerBitPackMax), "k_cItemsPerBitPackMin must be positive and can only be zero if both min and max are zero (which means we only use dynamic)");
+      static_assert(TObjective::k_cItemsPerBitPackMin <= TObjective::k_cItemsPerBitPackMax, "bit pack max less than min");
+
       EBM_ASSERT(nullptr != pWrapperOut);
       ObjectiveWrapper * const pObjectiveWrapperOut = static_cast<ObjectiveWrapper *>(pWrapperOut);
       FunctionPointersCpp * const pFunctionPointers =
@@ -625,6 +623,7 @@ protected:
 
       pObjectiveWrapperOut->m_bObjectiveHasHessian = HasHessian<TObjective>() ? EBM_TRUE : EBM_FALSE;
       pObjectiveWrapperOut->m_bRmse = TObjective::k_bRmse ? EBM_TRUE : EBM_FALSE;
+      pObjectiveWrapperOut->m_bMetricBins = TObjective::k_bMetricBins ? EBM_TRUE : EBM_FALSE;
 
       pObjectiveWrapperOut->m_pObjective = this;
 
@@ -638,6 +637,10 @@ protected:
 
 public:
 
+   // objectives that can build the validation score histogram used by the registered metrics set this to true
+   // in their class, which hides this default
+   static constexpr bool k_bMetricBins = false;
+
    template<typename TFloat>
    static ErrorEbm CreateObjective(
       const Config * const pConfig,
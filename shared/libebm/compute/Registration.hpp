@@ -24,6 +24,13 @@ namespace DEFINED_ZONE_NAME {
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
+struct Registrable {
+   // the base of the Objective and Metric classes, which are created from registration strings
+protected:
+   Registrable() = default;
+   ~Registrable() = default;
+};
+
 class ParamBase {
    const char * const m_sParamName;
 
@@ -299,9 +306,6 @@ class RegistrationPack final : public Registration {
             static_assert(std::is_trivially_copyable<TRegistrable<TFloat>>::value,
                "This allows us to memcpy the struct to a GPU or the network.");
 
-            static_assert(1 <= TRegistrable<TFloat>::k_cItemsPerBitPackMin || (k_cItemsPerBitPackDynamic == TRegistrable<TFloat>::k_cItemsPerBitPackMin && k_cItemsPerBitPackDynamic == TRegistrable<TFloat>::k_cItemsPerBitPackMax), "k_cItemsPerBitPackMin must be positive and can only be zero if both min and max are zero (which means we only use dynamic)");
-            static_assert(TRegistrable<TFloat>::k_cItemsPerBitPackMin <= TRegistrable<TFloat>::k_cItemsPerBitPackMax, "bit pack max less than min");
-
             // use the in-place constructor to constrct our specialized Objective/Metric in our pre-reserved memory
             // this works because the *Objective/Metric classes need to be standard layout and trivially copyable anyways
             TRegistrable<TFloat> * const pRegistrable = new (pRegistrableMemory) TRegistrable<TFloat>(*pConfig, args...);
@@ -425,7 +425,59 @@ GPU_DEVICE INLINE_ALWAYS static T ExpForMulticlass(const T val) {
 }
 #endif // NEVER
 
+// Objectives like Tweedie need both e^(multiple1 * val) and e^(multiple2 * val) for the same val. When both multiples 
+// are integer multiples of a common factor (cMultiple1 / cDivisor and cMultiple2 / cDivisor), both exponentials are 
+// small integer powers of a single e^(common * val), so we only pay for one Exp and the range reduction inside it. 
+// Exp is the most expensive thing we do per sample, especially in the SIMD zones that evaluate it per lane.
 
+GPU_DEVICE constexpr static int ExpPairGcd(const int a, const int b) {
+   return 0 == b ? a : ExpPairGcd(b, a % b);
+}
+
+GPU_DEVICE constexpr static int ExpPairAbs(const int a) {
+   return a < 0 ? -a : a;
+}
+
+template<int cPower, typename TFloat>
+GPU_DEVICE INLINE_ALWAYS static TFloat ExpPairPower(const TFloat & base) {
+   static constexpr int cPowerAbs = ExpPairAbs(cPower);
+   static_assert(cPowerAbs <= 4, "larger powers lose too much precision and are no cheaper than calling Exp");
+   if(0 == cPowerAbs) {
+      return TFloat(1.0);
+   }
+   TFloat ret = base;
+   for(int i = 1; i < cPowerAbs; ++i) {
+      ret *= base;
+   }
+   return cPower < 0 ? 1.0 / ret : ret;
+}
+
+template<int cMultiple1, int cMultiple2, int cDivisor, typename TFloat>
+GPU_DEVICE INLINE_ALWAYS static void ExpPair(const TFloat & val, TFloat & exp1Out, TFloat & exp2Out) {
+   static_assert(0 < cDivisor, "cDivisor must be positive");
+   static_assert(0 != cMultiple1 || 0 != cMultiple2, "at least one exponential must depend on val");
+
+   // make the common factor negative when that avoids dividing for both, and otherwise keep it positive
+   static constexpr int cCommonAbs = ExpPairGcd(ExpPairAbs(cMultiple1), ExpPairAbs(cMultiple2));
+   static constexpr int cCommon = cMultiple1 + cMultiple2 < 0 ? -cCommonAbs : cCommonAbs;
+
+   const TFloat base = Exp(val * (static_cast<double>(cCommon) / static_cast<double>(cDivisor)));
+   exp1Out = ExpPairPower<cMultiple1 / cCommon>(base);
+   exp2Out = ExpPairPower<cMultiple2 / cCommon>(base);
+}
+
+template<typename TFloat>
+GPU_DEVICE INLINE_ALWAYS static void ExpPair(
+   const TFloat & val, 
+   const TFloat & multiple1, 
+   const TFloat & multiple2, 
+   TFloat & exp1Out, 
+   TFloat & exp2Out
+) {
+   // for multiples that are only known at runtime there is nothing to share
+   exp1Out = Exp(multiple1 * val);
+   exp2Out = Exp(multiple2 * val);
+}
 
 
 ///////////////////////////////////////////// LOG SECTION
@@ -24,6 +24,7 @@
 
 #include "Registration.hpp"
 #include "Objective.hpp"
+#include "Metric.hpp"
 
 #include "approximate_math.hpp"
 #include "compute_wrapper.hpp"
@@ -709,6 +710,12 @@ private:
 static_assert(std::is_standard_layout<Avx512f_32_Float>::value && std::is_trivially_copyable<Avx512f_32_Float>::value,
    "This allows offsetof, memcpy, memset, inter-language, GPU and cross-machine use where needed");
 
+#ifndef NDEBUG
+// ApplyTermUpdateFused starts the per-sample streams at SIMD pack boundaries inside a subset, so those only 
+// have the alignment that the SIMD loads require
+static constexpr size_t k_cAlignmentSamples = sizeof(Avx512f_32_Float::T) * size_t { Avx512f_32_Float::k_cSIMDPack };
+#endif // NDEBUG
+
 INTERNAL_IMPORT_EXPORT_BODY ErrorEbm ApplyUpdate_Avx512f_32(
    const ObjectiveWrapper * const pObjectiveWrapper,
    ApplyUpdateBridge * const pData
@@ -720,11 +727,11 @@ INTERNAL_IMPORT_EXPORT_BODY ErrorEbm ApplyUpdate_Avx512f_32(
    // all our memory should be aligned. It is required by SIMD for correctness or performance
    EBM_ASSERT(IsAligned(pData->m_aMulticlassMidwayTemp));
    EBM_ASSERT(IsAligned(pData->m_aUpdateTensorScores));
-   EBM_ASSERT(IsAligned(pData->m_aPacked));
-   EBM_ASSERT(IsAligned(pData->m_aTargets));
-   EBM_ASSERT(IsAligned(pData->m_aWeights));
-   EBM_ASSERT(IsAligned(pData->m_aSampleScores));
-   EBM_ASSERT(IsAligned(pData->m_aGradientsAndHessians));
+   EBM_ASSERT(IsAligned(pData->m_aPacked, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pData->m_aTargets, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pData->m_aWeights, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pData->m_aSampleScores, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pData->m_aGradientsAndHessians, k_cAlignmentSamples));
 
    return (*pApplyUpdateCpp)(pObjective, pData);
 }
@@ -737,15 +744,32 @@ INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsBoosting_Avx512f_32(
       (static_cast<FunctionPointersCpp *>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pBinSumsBoostingCpp;
 
    // all our memory should be aligned. It is required by SIMD for correctness or performance
-   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians));
-   EBM_ASSERT(IsAligned(pParams->m_aWeights));
-   EBM_ASSERT(IsAligned(pParams->m_pCountOccurrences));
-   EBM_ASSERT(IsAligned(pParams->m_aPacked));
+   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pParams->m_aWeights, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pParams->m_pCountOccurrences, sizeof(uint8_t) * size_t { Avx512f_32_Float::k_cSIMDPack }));
+   EBM_ASSERT(IsAligned(pParams->m_aPacked, k_cAlignmentSamples));
    EBM_ASSERT(IsAligned(pParams->m_aFastBins));
 
    return (*pBinSumsBoostingCpp)(pParams);
 }
 
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsBoostingQuantized_Avx512f_32(
+   const ObjectiveWrapper * const pObjectiveWrapper,
+   BinSumsBoostingBridge * const pParams
+) {
+   const BIN_SUMS_BOOSTING_CPP pBinSumsBoostingQuantizedCpp =
+      (static_cast<FunctionPointersCpp *>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pBinSumsBoostingQuantizedCpp;
+
+   // the quantized gradients are narrower than a SIMD register, so they are only aligned to the start of each pack
+   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians, pParams->m_cBytesQuantized * size_t { Avx512f_32_Float::k_cSIMDPack }));
+   EBM_ASSERT(IsAligned(pParams->m_aWeights, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pParams->m_pCountOccurrences, sizeof(uint8_t) * size_t { Avx512f_32_Float::k_cSIMDPack }));
+   EBM_ASSERT(IsAligned(pParams->m_aPacked, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pParams->m_aFastBins));
+
+   return (*pBinSumsBoostingQuantizedCpp)(pParams);
+}
+
 INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsInteraction_Avx512f_32(
    const ObjectiveWrapper * const pObjectiveWrapper,
    BinSumsInteractionBridge * const pParams
@@ -774,6 +798,7 @@ INTERNAL_IMPORT_EXPORT_BODY ErrorEbm CreateObjective_Avx512f_32(
 ) {
    pObjectiveWrapperOut->m_pApplyUpdateC = ApplyUpdate_Avx512f_32;
    pObjectiveWrapperOut->m_pBinSumsBoostingC = BinSumsBoosting_Avx512f_32;
+   pObjectiveWrapperOut->m_pBinSumsBoostingQuantizedC = BinSumsBoostingQuantized_Avx512f_32;
    pObjectiveWrapperOut->m_pBinSumsInteractionC = BinSumsInteraction_Avx512f_32;
    ErrorEbm error = ComputeWrapper<Avx512f_32_Float>::FillWrapper(pObjectiveWrapperOut);
    if(Error_None != error) {
@@ -21,6 +21,10 @@ struct ComputeWrapper final {
       return BinSumsBoosting<TFloat>(pParams);
    }
 
+   static ErrorEbm StaticBinSumsBoostingQuantized(BinSumsBoostingBridge * const pParams) {
+      return BinSumsBoostingQuantized<TFloat>(pParams);
+   }
+
    static ErrorEbm StaticBinSumsInteraction(BinSumsInteractionBridge * const pParams) {
       return BinSumsInteraction<TFloat>(pParams);
    }
@@ -36,6 +40,7 @@ struct ComputeWrapper final {
       pObjectiveWrapperOut->m_pFunctionPointersCpp = pFunctionPointersCpp;
 
       pFunctionPointersCpp->m_pBinSumsBoostingCpp = StaticBinSumsBoosting;
+      pFunctionPointersCpp->m_pBinSumsBoostingQuantizedCpp = StaticBinSumsBoostingQuantized;
       pFunctionPointersCpp->m_pBinSumsInteractionCpp = StaticBinSumsInteraction;
 
       pObjectiveWrapperOut->m_cSIMDPack = static_cast<size_t>(TFloat::k_cSIMDPack);
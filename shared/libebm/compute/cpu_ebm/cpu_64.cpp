@@ -21,6 +21,7 @@
 
 #include "Registration.hpp"
 #include "Objective.hpp"
+#include "Metric.hpp"
 
 #include "approximate_math.hpp"
 #include "compute_wrapper.hpp"
@@ -32,6 +33,7 @@ namespace DEFINED_ZONE_NAME {
 
 // this is super-special and included inside the zone namespace
 #include "objective_registrations.hpp"
+#include "metric_registrations.hpp"
 
 struct Cpu_64_Float;
 
@@ -389,6 +391,12 @@ private:
 static_assert(std::is_standard_layout<Cpu_64_Float>::value && std::is_trivially_copyable<Cpu_64_Float>::value,
    "This allows offsetof, memcpy, memset, inter-language, GPU and cross-machine use where needed");
 
+#ifndef NDEBUG
+// ApplyTermUpdateFused starts the per-sample streams at SIMD pack boundaries inside a subset, so those only 
+// have the alignment that the SIMD loads require
+static constexpr size_t k_cAlignmentSamples = sizeof(Cpu_64_Float::T) * size_t { Cpu_64_Float::k_cSIMDPack };
+#endif // NDEBUG
+
 INTERNAL_IMPORT_EXPORT_BODY ErrorEbm ApplyUpdate_Cpu_64(
    const ObjectiveWrapper * const pObjectiveWrapper,
    ApplyUpdateBridge * const pData
@@ -400,11 +408,11 @@ INTERNAL_IMPORT_EXPORT_BODY ErrorEbm ApplyUpdate_Cpu_64(
    // all our memory should be aligned. It is required by SIMD for correctness or performance
    EBM_ASSERT(IsAligned(pData->m_aMulticlassMidwayTemp));
    EBM_ASSERT(IsAligned(pData->m_aUpdateTensorScores));
-   EBM_ASSERT(IsAligned(pData->m_aPacked));
-   EBM_ASSERT(IsAligned(pData->m_aTargets));
-   EBM_ASSERT(IsAligned(pData->m_aWeights));
-   EBM_ASSERT(IsAligned(pData->m_aSampleScores));
-   EBM_ASSERT(IsAligned(pData->m_aGradientsAndHessians));
+   EBM_ASSERT(IsAligned(pData->m_aPacked, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pData->m_aTargets, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pData->m_aWeights, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pData->m_aSampleScores, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pData->m_aGradientsAndHessians, k_cAlignmentSamples));
 
    return (*pApplyUpdateCpp)(pObjective, pData);
 }
@@ -417,15 +425,32 @@ INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsBoosting_Cpu_64(
       (static_cast<FunctionPointersCpp *>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pBinSumsBoostingCpp;
 
    // all our memory should be aligned. It is required by SIMD for correctness or performance
-   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians));
-   EBM_ASSERT(IsAligned(pParams->m_aWeights));
-   EBM_ASSERT(IsAligned(pParams->m_pCountOccurrences));
-   EBM_ASSERT(IsAligned(pParams->m_aPacked));
+   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pParams->m_aWeights, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pParams->m_pCountOccurrences, sizeof(uint8_t) * size_t { Cpu_64_Float::k_cSIMDPack }));
+   EBM_ASSERT(IsAligned(pParams->m_aPacked, k_cAlignmentSamples));
    EBM_ASSERT(IsAligned(pParams->m_aFastBins));
 
    return (*pBinSumsBoostingCpp)(pParams);
 }
 
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsBoostingQuantized_Cpu_64(
+   const ObjectiveWrapper * const pObjectiveWrapper,
+   BinSumsBoostingBridge * const pParams
+) {
+   const BIN_SUMS_BOOSTING_CPP pBinSumsBoostingQuantizedCpp =
+      (static_cast<FunctionPointersCpp *>(pObjectiveWrapper->m_pFunctionPointersCpp))->m_pBinSumsBoostingQuantizedCpp;
+
+   // the quantized gradients are narrower than a SIMD register, so they are only aligned to the start of each pack
+   EBM_ASSERT(IsAligned(pParams->m_aGradientsAndHessians, pParams->m_cBytesQuantized * size_t { Cpu_64_Float::k_cSIMDPack }));
+   EBM_ASSERT(IsAligned(pParams->m_aWeights, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pParams->m_pCountOccurrences, sizeof(uint8_t) * size_t { Cpu_64_Float::k_cSIMDPack }));
+   EBM_ASSERT(IsAligned(pParams->m_aPacked, k_cAlignmentSamples));
+   EBM_ASSERT(IsAligned(pParams->m_aFastBins));
+
+   return (*pBinSumsBoostingQuantizedCpp)(pParams);
+}
+
 INTERNAL_IMPORT_EXPORT_BODY ErrorEbm BinSumsInteraction_Cpu_64(
    const ObjectiveWrapper * const pObjectiveWrapper,
    BinSumsInteractionBridge * const pParams
@@ -479,6 +504,7 @@ INTERNAL_IMPORT_EXPORT_BODY ErrorEbm CreateObjective_Cpu_64(
 ) {
    pObjectiveWrapperOut->m_pApplyUpdateC = ApplyUpdate_Cpu_64;
    pObjectiveWrapperOut->m_pBinSumsBoostingC = BinSumsBoosting_Cpu_64;
+   pObjectiveWrapperOut->m_pBinSumsBoostingQuantizedC = BinSumsBoostingQuantized_Cpu_64;
    pObjectiveWrapperOut->m_pBinSumsInteractionC = BinSumsInteraction_Cpu_64;
    ErrorEbm error = ComputeWrapper<Cpu_64_Float>::FillWrapper(pObjectiveWrapperOut);
    if(Error_None != error) {
@@ -490,14 +516,31 @@ INTERNAL_IMPORT_EXPORT_BODY ErrorEbm CreateObjective_Cpu_64(
 INTERNAL_IMPORT_EXPORT_BODY ErrorEbm CreateMetric_Cpu_64(
    const Config * const pConfig,
    const char * const sMetric,
-   const char * const sMetricEnd
-//   MetricWrapper * const pMetricWrapperOut,
+   const char * const sMetricEnd,
+   MetricWrapper * const pMetricWrapperOut
 ) {
-   UNUSED(pConfig);
-   UNUSED(sMetric);
-   UNUSED(sMetricEnd);
+   MetricFunctionPointersCpp * const pFunctionPointersCpp =
+      reinterpret_cast<MetricFunctionPointersCpp *>(malloc(sizeof(MetricFunctionPointersCpp)));
+   if(nullptr == pFunctionPointersCpp) {
+      return Error_OutOfMemory;
+   }
+   pMetricWrapperOut->m_pFunctionPointersCpp = pFunctionPointersCpp;
+
+   return Metric::CreateMetric<Cpu_64_Float>(pConfig, sMetric, sMetricEnd, pMetricWrapperOut);
+}
 
-   return Error_UnexpectedInternal;
+INTERNAL_IMPORT_EXPORT_BODY double FinishMetricBinsC(
+   const MetricWrapper * const pMetricWrapper,
+   const double * const aMetricBins
+) {
+   EBM_ASSERT(nullptr != pMetricWrapper);
+   EBM_ASSERT(nullptr != aMetricBins);
+   const Metric * const pMetric = static_cast<const Metric *>(pMetricWrapper->m_pMetric);
+   EBM_ASSERT(nullptr != pMetric);
+   const FINISH_METRIC_BINS_CPP pFinishMetricBinsCpp =
+      (static_cast<const MetricFunctionPointersCpp *>(pMetricWrapper->m_pFunctionPointersCpp))->m_pFinishMetricBinsCpp;
+   EBM_ASSERT(nullptr != pFinishMetricBinsCpp);
+   return (*pFinishMetricBinsCpp)(pMetric, aMetricBins);
 }
 
 
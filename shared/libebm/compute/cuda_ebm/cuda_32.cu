@@ -23,6 +23,7 @@
 
 #include "Registration.hpp"
 #include "Objective.hpp"
+#include "Metric.hpp"
 
 #include "approximate_math.hpp"
 #include "compute_wrapper.hpp"
@@ -506,6 +507,8 @@ INTERNAL_IMPORT_EXPORT_BODY ErrorEbm CreateObjective_Cuda_32(
 ) {
    pObjectiveWrapperOut->m_pApplyUpdateC = ApplyUpdate_Cuda_32;
    pObjectiveWrapperOut->m_pBinSumsBoostingC = BinSumsBoosting_Cuda_32;
+   // TODO: sum quantized gradients on the GPU. Until then boosters on this zone keep float gradients
+   pObjectiveWrapperOut->m_pBinSumsBoostingQuantizedC = nullptr;
    pObjectiveWrapperOut->m_pBinSumsInteractionC = BinSumsInteraction_Cuda_32;
    ErrorEbm error = ComputeWrapper<Cuda_32_Float>::FillWrapper(pObjectiveWrapperOut);
    if(Error_None != error) {
@@ -2,4 +2,45 @@
 // Licensed under the MIT license.
 // Author: Paul Koch <code@koch.ninja>
 
-// mirror the format of the Objective classes here
+// !! To add a new metric in C++ follow the steps at the top of the "metric_registrations.hpp" file !!
+
+// Area under the ROC curve for binary classification. We compute it from the validation score histogram instead
+// of sorting the scores. Positive and negative samples whose scores share one of the histogram bins count as ties,
+// so the result can differ from the sorted AUC by at most the fraction of positive/negative pairs that share a bin.
+template<typename TFloat>
+struct AucMetric : Metric {
+   METRIC_BOILERPLATE(AucMetric, MAXIMIZE_METRIC)
+
+   // The constructor parameters following config must match the RegisterMetric parameters in metric_registrations.hpp
+   inline AucMetric(const Config & config) {
+      if(1 != config.cOutputs) {
+         // for multiclass we would need one-vs-rest histograms for each class
+         throw ParamMismatchWithConfigException();
+      }
+   }
+
+   inline double FinishMetricBins(const double * const aMetricBins) const noexcept {
+      // every positive sample beats the negative samples in lower bins and ties with the ones in its own bin
+      double weightNegativeBelow = 0.0;
+      double weightPositive = 0.0;
+      double area = 0.0;
+      const double * pBin = aMetricBins;
+      const double * const pBinsEnd = aMetricBins + k_cMetricBins;
+      do {
+         const double weightNegativeBin = pBin[0];
+         const double weightPositiveBin = pBin[1];
+         area += weightPositiveBin * (weightNegativeBelow + 0.5 * weightNegativeBin);
+         weightNegativeBelow += weightNegativeBin;
+         weightPositive += weightPositiveBin;
+         pBin += 2;
+      } while(pBinsEnd != pBin);
+
+      const double denominator = weightPositive * weightNegativeBelow;
+      if(denominator <= 0.0) {
+         // with only one class in the validation set no ordering is better than another, so return what a random
+         // model would score
+         return 0.5;
+      }
+      return area / denominator;
+   }
+};
@@ -0,0 +1,31 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+
+// Steps for adding a new metric in C++:
+//   1) Copy one of the existing "*Metric.hpp" include files into a newly renamed "*Metric.hpp" file.
+//   2) Change the name of the class and the constructor name to fit the new metric.
+//   3) Update the parameters to the METRIC_BOILERPLATE macro for the new metric.
+//   4) Modify FinishMetricBins to compute the new metric from the validation score histogram that is described
+//      at the top of Metric.hpp.
+//   5) Add [#include "*Metric.hpp"] to the list of other include files right below this guide.
+//   6) Add the new Metric type to the list of metric registrations in the RegisterMetrics() function below.
+//   7) Verify that the constructor arguments on the new Metric class match the parameters in the metric
+//      registration below.
+//   8) Recompile the C++ with either build.sh or build.bat depending on the operating system.
+//
+// Metrics are finished on the CPU, so they are only registered in the CPU zone. The SIMD zones build the histogram
+// inside the validation kernels of the objectives that set k_bMetricBins.
+
+// Add new "*Metric.hpp" include files here:
+#include "AucMetric.hpp"
+
+// Add new *Metric type registrations to this list:
+template<typename TFloat>
+static const std::vector<std::shared_ptr<const Registration>> RegisterMetrics() {
+   // IMPORTANT: the parameter types listed here must match the parameters types in the Metric class constructor
+   return {
+      Register<TFloat, AucMetric, AccelerationFlags_NONE>("auc"),
+   };
+}
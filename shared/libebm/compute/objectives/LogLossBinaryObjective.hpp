@@ -10,6 +10,8 @@ template<typename TFloat>
 struct LogLossBinaryObjective : BinaryObjective {
    OBJECTIVE_CONSTANTS_BOILERPLATE(LogLossBinaryObjective, MINIMIZE_METRIC, Link_logit, true, 64, 1)
 
+   static constexpr bool k_bMetricBins = true;
+
    inline LogLossBinaryObjective(const Config & config) {
       if(1 != config.cOutputs) {
          // we share the tag "log_loss" with multiclass classification
@@ -73,7 +75,18 @@ struct LogLossBinaryObjective : BinaryObjective {
 
    template<bool bValidation, bool bWeight, bool bHessian, bool bDisableApprox, size_t cCompilerScores, int cCompilerPack>
    GPU_DEVICE NEVER_INLINE void InjectedApplyUpdate(ApplyUpdateBridge * const pData) const {
+      if(bValidation && nullptr != pData->m_aMetricBins) {
+         // a registered metric was chosen, so fill its score histogram instead of calculating the log loss
+         FusedApplyUpdate<bValidation, bWeight, bHessian, bDisableApprox, cCompilerScores, cCompilerPack, bValidation>(pData);
+      } else {
+         FusedApplyUpdate<bValidation, bWeight, bHessian, bDisableApprox, cCompilerScores, cCompilerPack, false>(pData);
+      }
+   }
+
+   template<bool bValidation, bool bWeight, bool bHessian, bool bDisableApprox, size_t cCompilerScores, int cCompilerPack, bool bMetricBins>
+   GPU_DEVICE INLINE_ALWAYS void FusedApplyUpdate(ApplyUpdateBridge * const pData) const {
       static_assert(k_oneScore == cCompilerScores, "We special case the classifiers so do not need to handle them");
+      static_assert(bValidation || !bMetricBins, "bMetricBins can only be true if bValidation is true");
       static_assert(!bValidation || !bHessian, "bHessian can only be true if bValidation is false");
       static_assert(bValidation || !bWeight, "bWeight can only be true if bValidation is true");
 
@@ -135,6 +148,9 @@ struct LogLossBinaryObjective : BinaryObjective {
 
       const typename TFloat::T * pWeight;
       TFloat metricSum;
+      double * aMetricBins;
+      TFloat metricScoreLow;
+      TFloat metricScoreScale;
       typename TFloat::T * pGradientAndHessian;
       if(bValidation) {
          if(bWeight) {
@@ -143,6 +159,15 @@ struct LogLossBinaryObjective : BinaryObjective {
             EBM_ASSERT(nullptr != pWeight);
 #endif // GPU_COMPILE
          }
+         if(bMetricBins) {
+            aMetricBins = pData->m_aMetricBins;
+#ifndef GPU_COMPILE
+            EBM_ASSERT(nullptr != aMetricBins);
+            EBM_ASSERT(k_cMetricBins == pData->m_cMetricBins);
+#endif // GPU_COMPILE
+            metricScoreLow = pData->m_metricScoreLow;
+            metricScoreScale = pData->m_metricScoreScale;
+         }
          metricSum = 0.0;
       } else {
          pGradientAndHessian = reinterpret_cast<typename TFloat::T *>(pData->m_aGradientsAndHessians);
@@ -180,7 +205,15 @@ struct LogLossBinaryObjective : BinaryObjective {
             sampleScore.Store(pSampleScore);
             pSampleScore += TFloat::k_cSIMDPack;
 
-            if(bValidation) {
+            if(bMetricBins) {
+               if(bWeight) {
+                  const TFloat weight = TFloat::Load(pWeight);
+                  pWeight += TFloat::k_cSIMDPack;
+                  AddMetricBins<TFloat, true>(aMetricBins, sampleScore, target, weight, metricScoreLow, metricScoreScale);
+               } else {
+                  AddMetricBins<TFloat, false>(aMetricBins, sampleScore, target, 1.0, metricScoreLow, metricScoreScale);
+               }
+            } else if(bValidation) {
                // TODO: similar to the gradient calculation above, once we sort our data by the target values we
                //       will be able to pass all the targets==0 and target==1 in to a single call to this function
                //       and we can therefore template the target value.  We can then call ExpForBinaryClassification
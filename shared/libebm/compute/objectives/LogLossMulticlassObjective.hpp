@@ -100,10 +100,8 @@ struct LogLossMulticlassObjective : MulticlassObjective {
       EBM_ASSERT(nullptr != pData->m_aTargets);
 #endif // GPU_COMPILE
 
-      alignas(alignof(TFloat)) typename TFloat::T
-         aLocalExpVector[bDynamic ? size_t { 1 } : (cCompilerScores * size_t { TFloat::k_cSIMDPack })];
-      typename TFloat::T * const aExps = bDynamic ? 
-         reinterpret_cast<typename TFloat::T *>(pData->m_aMulticlassMidwayTemp) : aLocalExpVector;
+      // only used when the count of scores is dynamic. With a compile time count of scores we keep the exps in registers
+      typename TFloat::T * const aExps = reinterpret_cast<typename TFloat::T *>(pData->m_aMulticlassMidwayTemp);
 
       const size_t cScores = GET_COUNT_SCORES(cCompilerScores, pData->m_cScores);
 
@@ -206,99 +204,202 @@ struct LogLossMulticlassObjective : MulticlassObjective {
                iTensorBin = Multiply<typename TFloat::TInt, typename TFloat::TInt::T, k_dynamicScores != cCompilerScores && 1 != TFloat::k_cSIMDPack, static_cast<typename TFloat::TInt::T>(cCompilerScores)>(iTensorBin, cCastScores);
             }
 
-            TFloat sumExp = 0.0;
-            size_t iScore1 = 0;
-            do {
-               TFloat updateScore;
-               if(!bCompilerZeroDimensional) {
-                  updateScore = TFloat::Load(aUpdateTensorScores, iTensorBin);
-                  iTensorBin = iTensorBin + 1;
-               } else {
-                  updateScore = aUpdateTensorScores[iScore1];
-               }
+            if(!bDynamic) {
+               // With a compile time count of scores the loops below are fully unrolled, so we can keep the scores
+               // and their exps for the whole SIMD pack in registers. The target class is then selected with IfEqual
+               // instead of going through memory with a gathering load (validation) or a scattered load/store (training).
+               TFloat aScoreExps[bDynamic ? size_t { 1 } : cCompilerScores];
 
-               TFloat sampleScore = TFloat::Load(pSampleScore);
-               sampleScore += updateScore;
-               sampleScore.Store(pSampleScore);
-               pSampleScore += TFloat::k_cSIMDPack;
+               size_t iScore1 = 0;
+               do {
+                  TFloat updateScore;
+                  if(!bCompilerZeroDimensional) {
+                     updateScore = TFloat::Load(aUpdateTensorScores, iTensorBin);
+                     iTensorBin = iTensorBin + 1;
+                  } else {
+                     updateScore = aUpdateTensorScores[iScore1];
+                  }
+
+                  TFloat sampleScore = TFloat::Load(pSampleScore);
+                  sampleScore += updateScore;
+                  sampleScore.Store(pSampleScore);
+                  pSampleScore += TFloat::k_cSIMDPack;
+
+                  aScoreExps[iScore1] = sampleScore;
+
+                  ++iScore1;
+               } while(cScores != iScore1);
+
+               if(bDisableApprox) {
+                  // The exact exp overflows to +inf above ~88 in float32, which would turn every probability in the
+                  // pack into NaN. Softmax is shift invariant, so subtract the max score first. We do not shift when
+                  // using the approximate exp since it skews the Schraudolph error (see the comment on the reciprocal below).
+                  TFloat maxScore = aScoreExps[0];
+                  size_t iScoreMax = 1;
+                  do {
+                     maxScore = IfLess(maxScore, aScoreExps[iScoreMax], aScoreExps[iScoreMax], maxScore);
+                     ++iScoreMax;
+                  } while(cScores != iScoreMax);
+
+                  size_t iScoreShift = 0;
+                  do {
+                     aScoreExps[iScoreShift] -= maxScore;
+                     ++iScoreShift;
+                  } while(cScores != iScoreShift);
+               }
 
-               const TFloat oneExp = TFloat::template ApproxExp<bDisableApprox, false>(sampleScore);
-               oneExp.Store(&aExps[iScore1 << TFloat::k_cSIMDShift]);
-               sumExp += oneExp;
+               TFloat sumExp = 0.0;
+               size_t iScoreExp = 0;
+               do {
+                  const TFloat oneExp = TFloat::template ApproxExp<bDisableApprox, false>(aScoreExps[iScoreExp]);
+                  aScoreExps[iScoreExp] = oneExp;
+                  sumExp += oneExp;
+                  ++iScoreExp;
+               } while(cScores != iScoreExp);
+
+               const typename TFloat::TInt target = TFloat::TInt::Load(pTargetData);
+               pTargetData += TFloat::TInt::k_cSIMDPack;
+
+               if(bValidation) {
+                  TFloat itemExp = 0.0;
+                  size_t iScoreTarget = 0;
+                  do {
+                     const typename TFloat::TInt iClass = static_cast<typename TFloat::TInt::T>(iScoreTarget);
+                     itemExp = IfEqual(iClass, target, aScoreExps[iScoreTarget], itemExp);
+                     ++iScoreTarget;
+                  } while(cScores != iScoreTarget);
+
+                  const TFloat invertedProbability = FastApproxDivide(sumExp, itemExp);
+                  TFloat metric = TFloat::template ApproxLog<bDisableApprox, false>(invertedProbability);
+
+                  if(bWeight) {
+                     const TFloat weight = TFloat::Load(pWeight);
+                     pWeight += TFloat::k_cSIMDPack;
+                     metricSum = FusedMultiplyAdd(metric, weight, metricSum);
+                  } else {
+                     metricSum += metric;
+                  }
+               } else {
+                  const TFloat sumExpInverted = FastApproxReciprocal(sumExp);
 
-               ++iScore1;
-            } while(cScores != iScore1);
+                  size_t iScore2 = 0;
+                  do {
+                     TFloat gradient = aScoreExps[iScore2] * sumExpInverted;
 
-            typename TFloat::TInt target = TFloat::TInt::Load(pTargetData);
-            pTargetData += TFloat::TInt::k_cSIMDPack;
+                     if(bHessian) {
+                        const TFloat hessian = FusedNegateMultiplyAdd(gradient, gradient, gradient);
+                        hessian.Store(&pGradientAndHessian[(iScore2 << (TFloat::k_cSIMDShift + 1)) + TFloat::k_cSIMDPack]);
+                     }
 
-            if(bValidation) {
-               // TODO: instead of writing the exp values to memory, since we just need 1 and the sum, 
-               // we could use an if selector to keep only the one that matches our target and we don't need
-               // to store (or re-load) from memory.  This also saves us a gathering load, which will be expensive
-               // in latency
+                     const typename TFloat::TInt iClass = static_cast<typename TFloat::TInt::T>(iScore2);
+                     gradient = IfEqual(iClass, target, gradient - 1.0, gradient);
 
-               target = target << TFloat::k_cSIMDShift;
-               target = target + TFloat::TInt::MakeIndexes();
+                     if(bHessian) {
+                        gradient.Store(&pGradientAndHessian[iScore2 << (TFloat::k_cSIMDShift + 1)]);
+                     } else {
+                        gradient.Store(&pGradientAndHessian[iScore2 << TFloat::k_cSIMDShift]);
+                     }
 
-               // TODO: after we finish sorting our dataset, all the target values in this datasubset will be
-               // identical, so instead of calling LoadScattered we'll be able to call LoadAligned
-               const TFloat itemExp = TFloat::Load(aExps, target);
-               const TFloat invertedProbability = FastApproxDivide(sumExp, itemExp);
-               TFloat metric = TFloat::template ApproxLog<bDisableApprox, false>(invertedProbability);
+                     ++iScore2;
+                  } while(cScores != iScore2);
 
-               if(bWeight) {
-                  const TFloat weight = TFloat::Load(pWeight);
-                  pWeight += TFloat::k_cSIMDPack;
-                  metricSum = FusedMultiplyAdd(metric, weight, metricSum);
-               } else {
-                  metricSum += metric;
+                  pGradientAndHessian += cScores << (bHessian ? (TFloat::k_cSIMDShift + 1) : TFloat::k_cSIMDShift);
                }
             } else {
-               // this Reciprocal is fast and is more SIMD-able, but it does create some complications.
-               // When sumExp gets somewhat large, arround +4.5 or above, then the sumExp can get to be something
-               // in the order of +100.  The inverse of that is around 0.01. We can then later multiply a number
-               // close to 100 (if one of the classes dominate a bin) by 0.01 and we can sometimes get a number just
-               // slightly above 1.0.  It might just be 1.000001, but then to calculate the hessian we subtract from
-               // 1.0, leaving us with a small negative number. We could potentially shift the scores of the classes
-               // to make the dominant class have a score of 0, but that gives our approximate exp a skew that I
-               // this is better left more randomized. I tink as long as we tollerate negative hessians by excluding
-               // hessians below a certain value we're ok, since we probably want to ignore these low hessians anyways
-               // and even if we wanted to continue boosting, the other classes will continue to be boosted on
-               // and our main class will stop growing more positive around +5, which is a fairly big value anyways
-               const TFloat sumExpInverted = FastApproxReciprocal(sumExp);
-
-               size_t iScore2 = 0;
+               TFloat sumExp = 0.0;
+               size_t iScore1 = 0;
                do {
-                  const TFloat itemExp = TFloat::Load(&aExps[iScore2 << TFloat::k_cSIMDShift]);
-                  const TFloat gradient = itemExp * sumExpInverted;
-
-                  if(bHessian) {
-                     const TFloat hessian = FusedNegateMultiplyAdd(gradient, gradient, gradient);
-                     gradient.Store(&pGradientAndHessian[iScore2 << (TFloat::k_cSIMDShift + 1)]);
-                     hessian.Store(&pGradientAndHessian[(iScore2 << (TFloat::k_cSIMDShift + 1)) + TFloat::k_cSIMDPack]);
+                  TFloat updateScore;
+                  if(!bCompilerZeroDimensional) {
+                     updateScore = TFloat::Load(aUpdateTensorScores, iTensorBin);
+                     iTensorBin = iTensorBin + 1;
                   } else {
-                     gradient.Store(&pGradientAndHessian[iScore2 << TFloat::k_cSIMDShift]);
+                     updateScore = aUpdateTensorScores[iScore1];
                   }
 
-                  ++iScore2;
-               } while(cScores != iScore2);
+                  TFloat sampleScore = TFloat::Load(pSampleScore);
+                  sampleScore += updateScore;
+                  sampleScore.Store(pSampleScore);
+                  pSampleScore += TFloat::k_cSIMDPack;
+
+                  const TFloat oneExp = TFloat::template ApproxExp<bDisableApprox, false>(sampleScore);
+                  oneExp.Store(&aExps[iScore1 << TFloat::k_cSIMDShift]);
+                  sumExp += oneExp;
+
+                  ++iScore1;
+               } while(cScores != iScore1);
+
+               typename TFloat::TInt target = TFloat::TInt::Load(pTargetData);
+               pTargetData += TFloat::TInt::k_cSIMDPack;
+
+               if(bValidation) {
+                  // TODO: instead of writing the exp values to memory, since we just need 1 and the sum, 
+                  // we could use an if selector to keep only the one that matches our target and we don't need
+                  // to store (or re-load) from memory.  This also saves us a gathering load, which will be expensive
+                  // in latency
 
-               if(bHessian) {
-                  target = target << (TFloat::k_cSIMDShift + 1);
-               } else {
                   target = target << TFloat::k_cSIMDShift;
-               }
-               target = target + TFloat::TInt::MakeIndexes();
+                  target = target + TFloat::TInt::MakeIndexes();
+
+                  // TODO: after we finish sorting our dataset, all the target values in this datasubset will be
+                  // identical, so instead of calling LoadScattered we'll be able to call LoadAligned
+                  const TFloat itemExp = TFloat::Load(aExps, target);
+                  const TFloat invertedProbability = FastApproxDivide(sumExp, itemExp);
+                  TFloat metric = TFloat::template ApproxLog<bDisableApprox, false>(invertedProbability);
+
+                  if(bWeight) {
+                     const TFloat weight = TFloat::Load(pWeight);
+                     pWeight += TFloat::k_cSIMDPack;
+                     metricSum = FusedMultiplyAdd(metric, weight, metricSum);
+                  } else {
+                     metricSum += metric;
+                  }
+               } else {
+                  // this Reciprocal is fast and is more SIMD-able, but it does create some complications.
+                  // When sumExp gets somewhat large, arround +4.5 or above, then the sumExp can get to be something
+                  // in the order of +100.  The inverse of that is around 0.01. We can then later multiply a number
+                  // close to 100 (if one of the classes dominate a bin) by 0.01 and we can sometimes get a number just
+                  // slightly above 1.0.  It might just be 1.000001, but then to calculate the hessian we subtract from
+                  // 1.0, leaving us with a small negative number. We could potentially shift the scores of the classes
+                  // to make the dominant class have a score of 0, but that gives our approximate exp a skew that I
+                  // this is better left more randomized. I tink as long as we tollerate negative hessians by excluding
+                  // hessians below a certain value we're ok, since we probably want to ignore these low hessians anyways
+                  // and even if we wanted to continue boosting, the other classes will continue to be boosted on
+                  // and our main class will stop growing more positive around +5, which is a fairly big value anyways
+                  const TFloat sumExpInverted = FastApproxReciprocal(sumExp);
+
+                  size_t iScore2 = 0;
+                  do {
+                     const TFloat itemExp = TFloat::Load(&aExps[iScore2 << TFloat::k_cSIMDShift]);
+                     const TFloat gradient = itemExp * sumExpInverted;
+
+                     if(bHessian) {
+                        const TFloat hessian = FusedNegateMultiplyAdd(gradient, gradient, gradient);
+                        gradient.Store(&pGradientAndHessian[iScore2 << (TFloat::k_cSIMDShift + 1)]);
+                        hessian.Store(&pGradientAndHessian[(iScore2 << (TFloat::k_cSIMDShift + 1)) + TFloat::k_cSIMDPack]);
+                     } else {
+                        gradient.Store(&pGradientAndHessian[iScore2 << TFloat::k_cSIMDShift]);
+                     }
+
+                     ++iScore2;
+                  } while(cScores != iScore2);
 
-               // TODO: after we finish sorting our dataset, all the target values in this datasubset will be
-               // identical, so instead of calling LoadScattered and SaveScattered we'll be able to call
-               // LoadAligned and SaveAligned
-               TFloat adjust = TFloat::Load(pGradientAndHessian, target);
-               adjust -= 1.0;
-               adjust.Store(pGradientAndHessian, target);
+                  if(bHessian) {
+                     target = target << (TFloat::k_cSIMDShift + 1);
+                  } else {
+                     target = target << TFloat::k_cSIMDShift;
+                  }
+                  target = target + TFloat::TInt::MakeIndexes();
+
+                  // TODO: after we finish sorting our dataset, all the target values in this datasubset will be
+                  // identical, so instead of calling LoadScattered and SaveScattered we'll be able to call
+                  // LoadAligned and SaveAligned
+                  TFloat adjust = TFloat::Load(pGradientAndHessian, target);
+                  adjust -= 1.0;
+                  adjust.Store(pGradientAndHessian, target);
 
-               pGradientAndHessian += cScores << (bHessian ? (TFloat::k_cSIMDShift + 1) : TFloat::k_cSIMDShift);
+                  pGradientAndHessian += cScores << (bHessian ? (TFloat::k_cSIMDShift + 1) : TFloat::k_cSIMDShift);
+               }
             }
 
             if(bCompilerZeroDimensional) {
@@ -4,28 +4,52 @@
 
 // !! To add a new objective in C++ follow the steps at the top of the "objective_registrations.hpp" file !!
 
+// Tweedie variance powers that we specialize at compile time are encoded as twice the variance power so that the
+// common powers (1, 1.5, 2, and 3) are integers. Any other variance power is handled at runtime.
+static constexpr int k_dynamicVariancePowerHalves = std::numeric_limits<int>::min();
+
 // TFloat is a datatype that could hold inside a double, float, or some SIMD intrinsic type.
 // See cpu_64.cpp, avx2_32.cpp, and cuda_32.cu as examples where TFloat operators are defined.
-template<typename TFloat>
-struct TweedieDevianceRegressionObjective : RegressionObjective {
-   OBJECTIVE_BOILERPLATE(TweedieDevianceRegressionObjective, MINIMIZE_METRIC, Link_log)
+template<typename TFloat, int cCompilerVariancePowerHalves>
+struct TweedieDevianceRegressionObjectivePower : RegressionObjective {
+   template<typename T>
+   using TweedieDevianceRegressionObjectiveSelf = TweedieDevianceRegressionObjectivePower<T, cCompilerVariancePowerHalves>;
+   OBJECTIVE_BOILERPLATE(TweedieDevianceRegressionObjectiveSelf, MINIMIZE_METRIC, Link_log)
 
+   static constexpr bool k_bDynamic = k_dynamicVariancePowerHalves == cCompilerVariancePowerHalves;
+
+   double m_variancePower;
    TFloat m_variancePowerParamSub1;
    TFloat m_variancePowerParamSub2;
    TFloat m_inverseVariancePowerParamSub1;
    TFloat m_inverseVariancePowerParamSub2;
+   TFloat m_hessianMultiple1;
+   TFloat m_hessianMultiple2;
 
    // The constructor parameters following config must match the RegisterObjective parameters in objective_registrations.hpp
-   inline TweedieDevianceRegressionObjective(const Config & config, double variancePower) {
+   inline TweedieDevianceRegressionObjectivePower(const Config & config, double variancePower) {
       if(config.cOutputs != 1) {
          throw ParamMismatchWithConfigException();
       }
       if(config.isDifferentialPrivacy) {
          throw NonPrivateRegistrationException();
       }
-      if(variancePower <= 1.0 || 2.0 <= variancePower) {
-         // TODO: Implement Tweedie for other Powers
-         throw ParamValOutOfRangeException();
+      if(k_bDynamic) {
+         if(std::isnan(variancePower) || std::isinf(variancePower)) {
+            throw ParamValOutOfRangeException();
+         }
+         if(0.0 < variancePower && variancePower < 1.0) {
+            // there is no Tweedie distribution with a variance power between 0 and 1
+            throw ParamValOutOfRangeException();
+         }
+         if(1.0 == variancePower || 2.0 == variancePower) {
+            // these are handled by specializations that are registered ahead of us, and they need a different metric
+            throw ParamValOutOfRangeException();
+         }
+      } else {
+         if(static_cast<double>(cCompilerVariancePowerHalves) * 0.5 != variancePower) {
+            throw SkipRegistrationException();
+         }
       }
 
       // for a discussion on variance_power and link_power, see:
@@ -38,13 +62,30 @@ struct TweedieDevianceRegressionObjective : RegressionObjective {
       const double variancePowerParamSub1 = 1.0 - variancePower;
       const double variancePowerParamSub2 = 2.0 - variancePower;
 
+      m_variancePower = variancePower;
       m_variancePowerParamSub1 = variancePowerParamSub1;
       m_variancePowerParamSub2 = variancePowerParamSub2;
-      m_inverseVariancePowerParamSub1 = 1.0 / variancePowerParamSub1;
-      m_inverseVariancePowerParamSub2 = 1.0 / variancePowerParamSub2;
+      // for variance powers 1 and 2 one of these is unused since CalcMetric has a special form for them
+      m_inverseVariancePowerParamSub1 = 0.0 == variancePowerParamSub1 ? 0.0 : 1.0 / variancePowerParamSub1;
+      m_inverseVariancePowerParamSub2 = 0.0 == variancePowerParamSub2 ? 0.0 : 1.0 / variancePowerParamSub2;
+
+      if(variancePower < 1.0 || 2.0 < variancePower) {
+         // Outside of [1, 2] the deviance is not convex in the score, so the hessian goes negative when the
+         // prediction is far enough above the target (above 2 * target for variance power 3). Use the expected
+         // hessian instead, which is the prediction to the power of (2 - variancePower) and always positive.
+         m_hessianMultiple1 = 0.0;
+         m_hessianMultiple2 = 1.0;
+      } else {
+         m_hessianMultiple1 = variancePowerParamSub1;
+         m_hessianMultiple2 = variancePowerParamSub2;
+      }
    }
 
    inline bool CheckRegressionTarget(const double target) const noexcept {
+      if(2.0 <= m_variancePower) {
+         // like gamma, the variance powers of 2 and above have no probability mass at zero
+         return std::isnan(target) || std::isinf(target) || target <= 0.0;
+      }
       return std::isnan(target) || std::isinf(target) || target < 0.0;
    }
 
@@ -84,33 +125,65 @@ struct TweedieDevianceRegressionObjective : RegressionObjective {
       return 2.0 * metricSum;
    }
 
+   // exp1Score is e^((1 - variancePower) * score) and exp2Score is e^((2 - variancePower) * score)
+   template<bool bDynamic = k_bDynamic, typename std::enable_if<bDynamic, int>::type = 0>
+   GPU_DEVICE INLINE_ALWAYS void CalcExpPair(const TFloat & score, TFloat & exp1Score, TFloat & exp2Score) const noexcept {
+      ExpPair(score, m_variancePowerParamSub1, m_variancePowerParamSub2, exp1Score, exp2Score);
+   }
+   template<bool bDynamic = k_bDynamic, typename std::enable_if<!bDynamic, int>::type = 0>
+   GPU_DEVICE INLINE_ALWAYS void CalcExpPair(const TFloat & score, TFloat & exp1Score, TFloat & exp2Score) const noexcept {
+      ExpPair<2 - cCompilerVariancePowerHalves, 4 - cCompilerVariancePowerHalves, 2>(score, exp1Score, exp2Score);
+   }
+
    GPU_DEVICE inline TFloat CalcMetric(const TFloat & score, const TFloat & target) const noexcept {
-      const TFloat exp1Score = Exp(m_variancePowerParamSub1 * score);
-      const TFloat exp2Score = Exp(m_variancePowerParamSub2 * score);
+      TFloat exp1Score;
+      TFloat exp2Score;
+      CalcExpPair(score, exp1Score, exp2Score);
+      // the terms that only depend on the target are dropped, so for variance powers 1 and 2 the limits of
+      // the general form reduce to these
+      if(2 == cCompilerVariancePowerHalves) {
+         return FusedNegateMultiplyAdd(target, score, exp2Score);
+      }
+      if(4 == cCompilerVariancePowerHalves) {
+         return FusedMultiplyAdd(target, exp1Score, score);
+      }
       const TFloat metric = FusedNegateMultiplyAdd(
-         target * m_inverseVariancePowerParamSub1, 
-         exp1Score, 
+         target * m_inverseVariancePowerParamSub1,
+         exp1Score,
          exp2Score * m_inverseVariancePowerParamSub2
       );
       return metric;
    }
 
    GPU_DEVICE inline TFloat CalcGradient(const TFloat & score, const TFloat & target) const noexcept {
-      const TFloat exp1Score = Exp(m_variancePowerParamSub1 * score);
-      const TFloat exp2Score = Exp(m_variancePowerParamSub2 * score);
+      TFloat exp1Score;
+      TFloat exp2Score;
+      CalcExpPair(score, exp1Score, exp2Score);
       const TFloat gradient = FusedNegateMultiplyAdd(target, exp1Score, exp2Score);
       return gradient;
    }
 
    GPU_DEVICE inline GradientHessian<TFloat> CalcGradientHessian(const TFloat & score, const TFloat & target) const noexcept {
-      const TFloat exp1Score = Exp(m_variancePowerParamSub1 * score);
-      const TFloat exp2Score = Exp(m_variancePowerParamSub2 * score);
+      TFloat exp1Score;
+      TFloat exp2Score;
+      CalcExpPair(score, exp1Score, exp2Score);
       const TFloat gradient = FusedNegateMultiplyAdd(target, exp1Score, exp2Score);
       const TFloat hessian = FusedNegateMultiplyAdd(
-         m_variancePowerParamSub1 * target, 
-         exp1Score, 
-         m_variancePowerParamSub2 * exp2Score
+         m_hessianMultiple1 * target,
+         exp1Score,
+         m_hessianMultiple2 * exp2Score
       );
       return MakeGradientHessian(gradient, hessian);
    }
 };
+
+template<typename TFloat>
+using TweedieDevianceRegressionObjective = TweedieDevianceRegressionObjectivePower<TFloat, k_dynamicVariancePowerHalves>;
+template<typename TFloat>
+using TweedieDevianceRegressionObjectivePower2Halves = TweedieDevianceRegressionObjectivePower<TFloat, 2>;
+template<typename TFloat>
+using TweedieDevianceRegressionObjectivePower3Halves = TweedieDevianceRegressionObjectivePower<TFloat, 3>;
+template<typename TFloat>
+using TweedieDevianceRegressionObjectivePower4Halves = TweedieDevianceRegressionObjectivePower<TFloat, 4>;
+template<typename TFloat>
+using TweedieDevianceRegressionObjectivePower6Halves = TweedieDevianceRegressionObjectivePower<TFloat, 6>;
@@ -43,6 +43,12 @@ static const std::vector<std::shared_ptr<const Registration>> RegisterObjectives
       Register<TFloat, RmseRegressionObjective, AccelerationFlags_ALL>("rmse"),
       Register<TFloat, RmseLogLinkRegressionObjective, AccelerationFlags_ALL>("rmse_log"),
       Register<TFloat, PoissonDevianceRegressionObjective, AccelerationFlags_ALL>("poisson_deviance"),
+      // the common Tweedie variance powers are specialized so that they only need one Exp per sample. They skip 
+      // registration for other variance powers, which fall through to the general TweedieDevianceRegressionObjective
+      Register<TFloat, TweedieDevianceRegressionObjectivePower3Halves, AccelerationFlags_ALL>("tweedie_deviance", FloatParam("variance_power", 1.5)),
+      Register<TFloat, TweedieDevianceRegressionObjectivePower2Halves, AccelerationFlags_ALL>("tweedie_deviance", FloatParam("variance_power", 1.5)),
+      Register<TFloat, TweedieDevianceRegressionObjectivePower4Halves, AccelerationFlags_ALL>("tweedie_deviance", FloatParam("variance_power", 1.5)),
+      Register<TFloat, TweedieDevianceRegressionObjectivePower6Halves, AccelerationFlags_ALL>("tweedie_deviance", FloatParam("variance_power", 1.5)),
       Register<TFloat, TweedieDevianceRegressionObjective, AccelerationFlags_ALL>("tweedie_deviance", FloatParam("variance_power", 1.5)),
       Register<TFloat, GammaDevianceRegressionObjective, AccelerationFlags_ALL>("gamma_deviance"),
       Register<TFloat, PseudoHuberRegressionObjective, AccelerationFlags_ALL>("pseudo_huber", FloatParam("delta", 1.0)),
@@ -17,6 +17,7 @@ namespace DEFINED_ZONE_NAME {
 #endif // DEFINED_ZONE_NAME
 
 struct Objective;
+struct Metric;
 
 // these are going to be extern "C++", which we require to call our static member functions per:
 // https://www.drdobbs.com/c-theory-and-practice/184403437
@@ -25,6 +26,7 @@ typedef double (* FINISH_METRIC_CPP)(const Objective * const pObjective, const d
 typedef BoolEbm (* CHECK_TARGETS_CPP)(const Objective * const pObjective, const size_t c, const void * const aTargets);
 typedef ErrorEbm (* BIN_SUMS_BOOSTING_CPP)(BinSumsBoostingBridge * const pParams);
 typedef ErrorEbm (* BIN_SUMS_INTERACTION_CPP)(BinSumsInteractionBridge * const pParams);
+typedef double (* FINISH_METRIC_BINS_CPP)(const Metric * const pMetric, const double * const aMetricBins);
 
 struct FunctionPointersCpp {
    // unfortunately, function pointers are not interchangable with data pointers since in some architectures
@@ -36,9 +38,14 @@ struct FunctionPointersCpp {
    CHECK_TARGETS_CPP m_pCheckTargetsCpp;
 
    BIN_SUMS_BOOSTING_CPP m_pBinSumsBoostingCpp;
+   BIN_SUMS_BOOSTING_CPP m_pBinSumsBoostingQuantizedCpp;
    BIN_SUMS_INTERACTION_CPP m_pBinSumsInteractionCpp;
 };
 
+struct MetricFunctionPointersCpp {
+   FINISH_METRIC_BINS_CPP m_pFinishMetricBinsCpp;
+};
+
 } // DEFINED_ZONE_NAME
 
 #endif // ZONED_BRIDGE_CPP_FUNCTIONS_HPP
@@ -7,6 +7,7 @@
 #include <stdlib.h> // free
 #include <stddef.h> // size_t, ptrdiff_t
 #include <string.h> // memcpy
+#include <stdio.h> // FILE, fopen, fwrite
 
 #include "logging.h" // EBM_ASSERT
 #include "unzoned.h"
@@ -1983,6 +1984,1315 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillRegressionTarget(
    return static_cast<ErrorEbm>(ret);
 }
 
+// DataSetBuilder accumulates the sections of a shared dataset into a buffer that grows as each section is added, so
+// that callers do not need to measure every section before they can fill any of them. Each section is sized with
+// the same Append functions that the Measure functions use and then filled in place with the Fill path. The
+// Fill path keeps its internal state in the last UIntShared of the allocated memory, so we present the Append
+// functions with an allocation that ends just after the section being added. Once the last section is added the
+// dataset is locked exactly as it would have been if the caller had measured it up front.
+//
+// A chunked DataSetBuilder is instead told the number of samples and the shape of every feature when it is created,
+// which fixes the final layout. Rows are then appended in chunks and packed immediately into their final location,
+// either in memory or in a file, so the caller never needs to hold more than one chunk of bin indexes. Each feature
+// keeps the partially packed word that straddles the chunk boundary until the next chunk completes it.
+struct ChunkedFeature final {
+   size_t m_iByteNext;
+   IntEbm m_indexBinIllegal;
+   IntEbm m_indexBinLegal;
+   bool m_bMissing;
+   bool m_bStored;
+   int m_cItemsPerBitPack;
+   int m_cBitsPerItemMax;
+   int m_cShiftReset;
+   int m_cShift;
+   UIntShared m_bitsPending;
+
+   ChunkedFeature() = default; // preserve our POD status
+   ~ChunkedFeature() = default; // preserve our POD status
+   void * operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete (void *) = delete; // we only use malloc/free in this library
+};
+static_assert(std::is_standard_layout<ChunkedFeature>::value,
+   "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<ChunkedFeature>::value,
+   "We use memcpy in several places, so disallow non-trivial types in general");
+
+static bool SeekFile(FILE * const pFile, const size_t iByte) {
+#ifdef _MSC_VER
+   if(IsConvertError<__int64>(iByte)) {
+      return true;
+   }
+   return 0 != _fseeki64(pFile, static_cast<__int64>(iByte), SEEK_SET);
+#else // _MSC_VER
+   if(IsConvertError<off_t>(iByte)) {
+      return true;
+   }
+   return 0 != fseeko(pFile, static_cast<off_t>(iByte), SEEK_SET);
+#endif // _MSC_VER
+}
+
+struct DataSetBuilder final {
+   static constexpr size_t k_handleVerificationOk = 18443; // random 15 bit number
+   static constexpr size_t k_handleVerificationFreed = 30259; // random 15 bit number
+   size_t m_handleVerification; // this needs to be at the top and make it pointer sized to keep best alignment
+
+   size_t m_cOffsets;
+   size_t m_iOffset;
+   size_t m_cBytesUsed;
+   size_t m_cBytesCapacity;
+   unsigned char * m_pBuffer;
+
+   bool m_bChunked;
+   bool m_bChunkFailed;
+   bool m_bClassification;
+   IntEbm m_countClasses;
+   size_t m_cSamples;
+   size_t m_iSample;
+   size_t m_cFeatures;
+   size_t m_cWeights;
+   size_t m_cTargets;
+   size_t m_iByteWeights;
+   size_t m_iByteTargets;
+   ChunkedFeature * m_aChunkedFeatures;
+   FILE * m_pFile;
+   unsigned char * m_aScratch;
+   size_t m_cBytesScratch;
+
+   DataSetBuilder() = default; // preserve our POD status
+   ~DataSetBuilder() = default; // preserve our POD status
+   void * operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete (void *) = delete; // we only use malloc/free in this library
+
+   inline static DataSetBuilder * GetDataSetBuilderFromHandle(const DataSetBuilderHandle dataSetBuilderHandle) {
+      if(nullptr == dataSetBuilderHandle) {
+         LOG_0(Trace_Error, "ERROR GetDataSetBuilderFromHandle null dataSetBuilderHandle");
+         return nullptr;
+      }
+      DataSetBuilder * const pDataSetBuilder = reinterpret_cast<DataSetBuilder *>(dataSetBuilderHandle);
+      if(k_handleVerificationOk == pDataSetBuilder->m_handleVerification) {
+         return pDataSetBuilder;
+      }
+      if(k_handleVerificationFreed == pDataSetBuilder->m_handleVerification) {
+         LOG_0(Trace_Error, "ERROR GetDataSetBuilderFromHandle attempt to use freed DataSetBuilderHandle");
+      } else {
+         LOG_0(Trace_Error, "ERROR GetDataSetBuilderFromHandle attempt to use invalid DataSetBuilderHandle");
+      }
+      return nullptr;
+   }
+
+   inline void InitializeUnfailing() {
+      m_handleVerification = k_handleVerificationOk;
+      m_cOffsets = 0;
+      m_iOffset = 0;
+      m_cBytesUsed = 0;
+      m_cBytesCapacity = 0;
+      m_pBuffer = nullptr;
+      m_bChunked = false;
+      m_bChunkFailed = false;
+      m_bClassification = false;
+      m_countClasses = 0;
+      m_cSamples = 0;
+      m_iSample = 0;
+      m_cFeatures = 0;
+      m_cWeights = 0;
+      m_cTargets = 0;
+      m_iByteWeights = 0;
+      m_iByteTargets = 0;
+      m_aChunkedFeatures = nullptr;
+      m_pFile = nullptr;
+      m_aScratch = nullptr;
+      m_cBytesScratch = 0;
+   }
+
+   static void Free(DataSetBuilder * const pDataSetBuilder) {
+      if(nullptr != pDataSetBuilder) {
+         if(nullptr != pDataSetBuilder->m_pFile) {
+            fclose(pDataSetBuilder->m_pFile);
+         }
+         free(pDataSetBuilder->m_aScratch);
+         free(pDataSetBuilder->m_aChunkedFeatures);
+         free(pDataSetBuilder->m_pBuffer);
+         pDataSetBuilder->m_handleVerification = k_handleVerificationFreed;
+         free(pDataSetBuilder);
+      }
+   }
+
+   // grows the buffer to hold at least cBytes.  We grow by half rather than doubling so that the unused tail, which
+   // is only trimmed in FinalizeDataSetBuilder, and the transient old+new copy inside realloc stay smaller
+   ErrorEbm Reserve(const size_t cBytes) {
+      if(m_cBytesCapacity < cBytes) {
+         size_t cBytesCapacity = m_cBytesCapacity + (m_cBytesCapacity >> 1);
+         if(cBytesCapacity < cBytes || IsAddError(m_cBytesCapacity, m_cBytesCapacity >> 1)) {
+            cBytesCapacity = cBytes;
+         }
+         unsigned char * const pBuffer = static_cast<unsigned char *>(realloc(m_pBuffer, cBytesCapacity));
+         if(nullptr == pBuffer) {
+            LOG_0(Trace_Warning, "WARNING DataSetBuilder::Reserve nullptr == pBuffer");
+            return Error_OutOfMemory;
+         }
+         m_pBuffer = pBuffer;
+         m_cBytesCapacity = cBytesCapacity;
+      }
+      return Error_None;
+   }
+
+   // makes room for the next section, whose size came from the Append function in measure mode, and returns the
+   // number of bytes that the Append function should consider allocated when filling it
+   ErrorEbm PrepareSection(const IntEbm countBytesSection, size_t * const pcBytesAllocatedOut) {
+      EBM_ASSERT(nullptr != pcBytesAllocatedOut);
+
+      if(countBytesSection < IntEbm { 0 }) {
+         // the measurement failed and returned an error code instead of a size
+         return static_cast<ErrorEbm>(countBytesSection);
+      }
+      if(IsConvertError<size_t>(countBytesSection)) {
+         LOG_0(Trace_Error, "ERROR DataSetBuilder::PrepareSection IsConvertError<size_t>(countBytesSection)");
+         return Error_OutOfMemory;
+      }
+      const size_t cBytesSection = static_cast<size_t>(countBytesSection);
+
+      if(m_bChunked) {
+         LOG_0(Trace_Error, "ERROR DataSetBuilder::PrepareSection chunked builders only accept DataSetBuilderAppendRows");
+         return Error_IllegalParamVal;
+      }
+
+      if(m_cOffsets <= m_iOffset) {
+         LOG_0(Trace_Error, "ERROR DataSetBuilder::PrepareSection all the sections have already been added");
+         return Error_IllegalParamVal;
+      }
+
+      const HeaderDataSetShared * const pHeaderDataSetShared = reinterpret_cast<const HeaderDataSetShared *>(m_pBuffer);
+      if(k_sharedDataSetWorkingId != pHeaderDataSetShared->m_id) {
+         LOG_0(Trace_Error, "ERROR DataSetBuilder::PrepareSection a previous section failed");
+         return Error_IllegalParamVal;
+      }
+
+      // all but the last section need room after them for the internal state of the Fill path
+      const size_t cBytesState = m_iOffset + size_t { 1 } == m_cOffsets ? size_t { 0 } : sizeof(UIntShared);
+      if(IsAddError(m_cBytesUsed, cBytesSection, cBytesState)) {
+         LOG_0(Trace_Error, "ERROR DataSetBuilder::PrepareSection IsAddError(m_cBytesUsed, cBytesSection, cBytesState)");
+         return Error_OutOfMemory;
+      }
+      const size_t cBytesAllocated = m_cBytesUsed + cBytesSection + cBytesState;
+      if(IsConvertError<UIntShared>(cBytesAllocated)) {
+         LOG_0(Trace_Error, "ERROR DataSetBuilder::PrepareSection IsConvertError<UIntShared>(cBytesAllocated)");
+         return Error_OutOfMemory;
+      }
+
+      const ErrorEbm error = Reserve(cBytesAllocated);
+      if(Error_None != error) {
+         return error;
+      }
+
+      // for the last section this is overwritten by the section itself after the state has been read
+      UIntShared * const pInternalState = reinterpret_cast<UIntShared *>(m_pBuffer + cBytesAllocated - sizeof(UIntShared));
+      *pInternalState = static_cast<UIntShared>(m_iOffset);
+
+      *pcBytesAllocatedOut = cBytesAllocated;
+      return Error_None;
+   }
+
+   inline void CommitSection(const IntEbm countBytesSection) {
+      EBM_ASSERT(IntEbm { 0 } <= countBytesSection);
+      m_cBytesUsed += static_cast<size_t>(countBytesSection);
+      ++m_iOffset;
+   }
+
+   // returns where cBytes destined for iByte should be packed. In memory that is their final location, and for
+   // files it is scratch memory that WriteChunk then writes out
+   unsigned char * GetChunkMem(const size_t iByte, const size_t cBytes) {
+      if(nullptr == m_pFile) {
+         // cBytes can be an upper bound that extends past the end of the buffer, but we never write past the end
+         EBM_ASSERT(nullptr != m_pBuffer);
+         EBM_ASSERT(iByte <= m_cBytesUsed);
+         return m_pBuffer + iByte;
+      }
+      if(m_cBytesScratch < cBytes) {
+         unsigned char * const aScratch = static_cast<unsigned char *>(realloc(m_aScratch, cBytes));
+         if(nullptr == aScratch) {
+            LOG_0(Trace_Warning, "WARNING DataSetBuilder::GetChunkMem nullptr == aScratch");
+            return nullptr;
+         }
+         m_aScratch = aScratch;
+         m_cBytesScratch = cBytes;
+      }
+      return m_aScratch;
+   }
+
+   ErrorEbm WriteChunk(const size_t iByte, const void * const pMem, const size_t cBytes) {
+      if(nullptr == m_pFile || size_t { 0 } == cBytes) {
+         // in memory the data was already packed into its final location
+         return Error_None;
+      }
+      if(SeekFile(m_pFile, iByte)) {
+         LOG_0(Trace_Warning, "WARNING DataSetBuilder::WriteChunk SeekFile failed");
+         return Error_UnexpectedInternal;
+      }
+      if(cBytes != fwrite(pMem, 1, cBytes, m_pFile)) {
+         LOG_0(Trace_Warning, "WARNING DataSetBuilder::WriteChunk fwrite failed");
+         return Error_UnexpectedInternal;
+      }
+      return Error_None;
+   }
+
+   ErrorEbm AppendChunkFeature(ChunkedFeature * const pFeature, const size_t cRows, const IntEbm * pBinIndex);
+   ErrorEbm AppendChunkWeights(const size_t cRows, const double * pWeight);
+   ErrorEbm AppendChunkTargets(const size_t cRows, const void * const aTargets);
+};
+static_assert(std::is_standard_layout<DataSetBuilder>::value,
+   "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<DataSetBuilder>::value,
+   "We use memcpy in several places, so disallow non-trivial types in general");
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateDataSetBuilder(
+   IntEbm countFeatures,
+   IntEbm countWeights,
+   IntEbm countTargets,
+   DataSetBuilderHandle * dataSetBuilderHandleOut
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered CreateDataSetBuilder: "
+      "countFeatures=%" IntEbmPrintf ", "
+      "countWeights=%" IntEbmPrintf ", "
+      "countTargets=%" IntEbmPrintf ", "
+      "dataSetBuilderHandleOut=%p"
+      ,
+      countFeatures,
+      countWeights,
+      countTargets,
+      static_cast<void *>(dataSetBuilderHandleOut)
+   );
+
+   if(nullptr == dataSetBuilderHandleOut) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilder nullptr == dataSetBuilderHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *dataSetBuilderHandleOut = nullptr; // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+
+   // AppendHeader checks that these are valid and convertible before measuring
+   const IntEbm countBytesHeader = AppendHeader(countFeatures, countWeights, countTargets, 0, nullptr);
+   if(countBytesHeader < IntEbm { 0 }) {
+      return static_cast<ErrorEbm>(countBytesHeader);
+   }
+   const size_t cBytesHeader = static_cast<size_t>(countBytesHeader);
+   const size_t cOffsets = static_cast<size_t>(countFeatures) + static_cast<size_t>(countWeights) +
+      static_cast<size_t>(countTargets);
+
+   DataSetBuilder * const pDataSetBuilder = static_cast<DataSetBuilder *>(malloc(sizeof(DataSetBuilder)));
+   if(nullptr == pDataSetBuilder) {
+      LOG_0(Trace_Warning, "WARNING CreateDataSetBuilder nullptr == pDataSetBuilder");
+      return Error_OutOfMemory;
+   }
+   pDataSetBuilder->InitializeUnfailing();
+   pDataSetBuilder->m_cOffsets = cOffsets;
+   pDataSetBuilder->m_cBytesUsed = cBytesHeader;
+
+   // AppendHeader verified that we can add the state after the header
+   const size_t cBytesAllocated = size_t { 0 } == cOffsets ? cBytesHeader : cBytesHeader + sizeof(UIntShared);
+   ErrorEbm error = pDataSetBuilder->Reserve(cBytesAllocated);
+   if(Error_None != error) {
+      DataSetBuilder::Free(pDataSetBuilder);
+      return error;
+   }
+
+   error = static_cast<ErrorEbm>(AppendHeader(countFeatures, countWeights, countTargets, cBytesAllocated, pDataSetBuilder->m_pBuffer));
+   if(Error_None != error) {
+      DataSetBuilder::Free(pDataSetBuilder);
+      return error;
+   }
+
+   *dataSetBuilderHandleOut = reinterpret_cast<DataSetBuilderHandle>(pDataSetBuilder);
+
+   LOG_0(Trace_Info, "Exited CreateDataSetBuilder");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION DataSetBuilderAddFeature(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countBins,
+   BoolEbm isMissing,
+   BoolEbm isUnknown,
+   BoolEbm isNominal,
+   IntEbm countSamples,
+   const IntEbm * binIndexes
+) {
+   DataSetBuilder * const pDataSetBuilder = DataSetBuilder::GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   const IntEbm countBytesSection =
+      AppendFeature(countBins, isMissing, isUnknown, isNominal, countSamples, binIndexes, 0, nullptr);
+
+   size_t cBytesAllocated;
+   ErrorEbm error = pDataSetBuilder->PrepareSection(countBytesSection, &cBytesAllocated);
+   if(Error_None != error) {
+      return error;
+   }
+
+   error = static_cast<ErrorEbm>(AppendFeature(
+      countBins,
+      isMissing,
+      isUnknown,
+      isNominal,
+      countSamples,
+      binIndexes,
+      cBytesAllocated,
+      pDataSetBuilder->m_pBuffer
+   ));
+   if(Error_None != error) {
+      return error;
+   }
+
+   pDataSetBuilder->CommitSection(countBytesSection);
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION DataSetBuilderAddWeight(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countSamples,
+   const double * weights
+) {
+   DataSetBuilder * const pDataSetBuilder = DataSetBuilder::GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   const IntEbm countBytesSection = AppendWeight(countSamples, weights, 0, nullptr);
+
+   size_t cBytesAllocated;
+   ErrorEbm error = pDataSetBuilder->PrepareSection(countBytesSection, &cBytesAllocated);
+   if(Error_None != error) {
+      return error;
+   }
+
+   error = static_cast<ErrorEbm>(AppendWeight(countSamples, weights, cBytesAllocated, pDataSetBuilder->m_pBuffer));
+   if(Error_None != error) {
+      return error;
+   }
+
+   pDataSetBuilder->CommitSection(countBytesSection);
+   return Error_None;
+}
+
+static ErrorEbm DataSetBuilderAddTarget(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   const bool bClassification,
+   const IntEbm countClasses,
+   const IntEbm countSamples,
+   const void * const aTargets
+) {
+   DataSetBuilder * const pDataSetBuilder = DataSetBuilder::GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   const IntEbm countBytesSection = AppendTarget(bClassification, countClasses, countSamples, aTargets, 0, nullptr);
+
+   size_t cBytesAllocated;
+   ErrorEbm error = pDataSetBuilder->PrepareSection(countBytesSection, &cBytesAllocated);
+   if(Error_None != error) {
+      return error;
+   }
+
+   error = static_cast<ErrorEbm>(AppendTarget(
+      bClassification,
+      countClasses,
+      countSamples,
+      aTargets,
+      cBytesAllocated,
+      pDataSetBuilder->m_pBuffer
+   ));
+   if(Error_None != error) {
+      return error;
+   }
+
+   pDataSetBuilder->CommitSection(countBytesSection);
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION DataSetBuilderAddClassificationTarget(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countClasses,
+   IntEbm countSamples,
+   const IntEbm * targets
+) {
+   return DataSetBuilderAddTarget(dataSetBuilderHandle, true, countClasses, countSamples, targets);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION DataSetBuilderAddRegressionTarget(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countSamples,
+   const double * targets
+) {
+   return DataSetBuilderAddTarget(dataSetBuilderHandle, false, 0, countSamples, targets);
+}
+
+ErrorEbm DataSetBuilder::AppendChunkFeature(ChunkedFeature * const pFeature, const size_t cRows, const IntEbm * pBinIndex) {
+   EBM_ASSERT(nullptr != pFeature);
+   EBM_ASSERT(size_t { 1 } <= cRows);
+   EBM_ASSERT(nullptr != pBinIndex);
+
+   const IntEbm * const pBinIndexsEnd = pBinIndex + cRows;
+   if(!pFeature->m_bStored) {
+      // if there is only 1 bin we always know what it will be and we do not need to store anything
+      const IntEbm indexBinLegal = pFeature->m_indexBinLegal;
+      do {
+         if(indexBinLegal != *pBinIndex) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilder::AppendChunkFeature indexBinLegal != indexBin");
+            return Error_IllegalParamVal;
+         }
+         ++pBinIndex;
+      } while(pBinIndexsEnd != pBinIndex);
+      return Error_None;
+   }
+
+   // each chunk completes at most one word per cItemsPerBitPack rows plus the word left pending by the last chunk
+   const size_t cWordsMax = cRows / static_cast<size_t>(pFeature->m_cItemsPerBitPack) + size_t { 1 };
+   if(IsMultiplyError(sizeof(UIntShared), cWordsMax)) {
+      LOG_0(Trace_Error, "ERROR DataSetBuilder::AppendChunkFeature IsMultiplyError(sizeof(UIntShared), cWordsMax)");
+      return Error_IllegalParamVal;
+   }
+   UIntShared * const aFillData = reinterpret_cast<UIntShared *>(
+      GetChunkMem(pFeature->m_iByteNext, sizeof(UIntShared) * cWordsMax));
+   if(nullptr == aFillData) {
+      // already logged
+      return Error_OutOfMemory;
+   }
+
+   const IntEbm indexBinIllegal = pFeature->m_indexBinIllegal;
+   const bool bMissing = pFeature->m_bMissing;
+   const int cBitsPerItemMax = pFeature->m_cBitsPerItemMax;
+   const int cShiftReset = pFeature->m_cShiftReset;
+   int cShift = pFeature->m_cShift;
+   UIntShared bits = pFeature->m_bitsPending;
+   UIntShared * pFillData = aFillData;
+   do {
+      IntEbm indexBin = *pBinIndex;
+      if(indexBinIllegal <= indexBin) {
+         LOG_0(Trace_Error, "ERROR DataSetBuilder::AppendChunkFeature indexBinIllegal <= indexBin");
+         return Error_IllegalParamVal;
+      }
+      if(bMissing) {
+         if(indexBin < IntEbm { 0 }) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilder::AppendChunkFeature indexBin can't be negative");
+            return Error_IllegalParamVal;
+         }
+      } else {
+         if(indexBin <= IntEbm { 0 }) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilder::AppendChunkFeature indexBin <= IntEbm { 0 }");
+            return Error_IllegalParamVal;
+         }
+         --indexBin;
+      }
+      ++pBinIndex;
+
+      EBM_ASSERT(!IsConvertError<UIntShared>(indexBin));
+      EBM_ASSERT(0 <= cShift);
+      EBM_ASSERT(cShift < COUNT_BITS(UIntShared));
+      bits |= static_cast<UIntShared>(indexBin) << cShift;
+      cShift -= cBitsPerItemMax;
+      if(cShift < 0) {
+         *pFillData = bits;
+         ++pFillData;
+         bits = 0;
+         cShift = cShiftReset;
+      }
+   } while(pBinIndexsEnd != pBinIndex);
+   EBM_ASSERT(static_cast<size_t>(pFillData - aFillData) <= cWordsMax);
+
+   pFeature->m_cShift = cShift;
+   pFeature->m_bitsPending = bits;
+
+   const size_t cBytesFilled = sizeof(UIntShared) * static_cast<size_t>(pFillData - aFillData);
+   const ErrorEbm error = WriteChunk(pFeature->m_iByteNext, aFillData, cBytesFilled);
+   if(Error_None != error) {
+      return error;
+   }
+   pFeature->m_iByteNext += cBytesFilled;
+   return Error_None;
+}
+
+ErrorEbm DataSetBuilder::AppendChunkWeights(const size_t cRows, const double * pWeight) {
+   EBM_ASSERT(size_t { 1 } <= cRows);
+   EBM_ASSERT(nullptr != pWeight);
+
+   // AppendRows checked that cRows fits within the sample count, which we checked could be multiplied
+   const size_t iByte = m_iByteWeights + sizeof(FloatShared) * m_iSample;
+   const size_t cBytes = sizeof(FloatShared) * cRows;
+   FloatShared * const aFill = reinterpret_cast<FloatShared *>(GetChunkMem(iByte, cBytes));
+   if(nullptr == aFill) {
+      // already logged
+      return Error_OutOfMemory;
+   }
+
+   FloatShared * pFill = aFill;
+   const double * const pWeightsEnd = pWeight + cRows;
+   do {
+      const double weight = *pWeight;
+      if(std::isnan(weight)) {
+         LOG_0(Trace_Warning, "WARNING DataSetBuilder::AppendChunkWeights std::isnan(weight)");
+         return Error_IllegalParamVal;
+      }
+      if(std::isinf(weight)) {
+         LOG_0(Trace_Warning, "WARNING DataSetBuilder::AppendChunkWeights std::isinf(weight)");
+         return Error_IllegalParamVal;
+      }
+      if(weight < static_cast<double>(std::numeric_limits<float>::min())) {
+         LOG_0(Trace_Warning, "WARNING DataSetBuilder::AppendChunkWeights weight < static_cast<double>(std::numeric_limits<float>::min())");
+         return Error_IllegalParamVal;
+      }
+      if(static_cast<double>(std::numeric_limits<float>::max()) < weight) {
+         LOG_0(Trace_Warning, "WARNING DataSetBuilder::AppendChunkWeights static_cast<double>(std::numeric_limits<float>::max()) < weight");
+         return Error_IllegalParamVal;
+      }
+      *pFill = static_cast<FloatShared>(weight);
+      ++pFill;
+      ++pWeight;
+   } while(pWeightsEnd != pWeight);
+
+   return WriteChunk(iByte, aFill, cBytes);
+}
+
+ErrorEbm DataSetBuilder::AppendChunkTargets(const size_t cRows, const void * const aTargets) {
+   EBM_ASSERT(size_t { 1 } <= cRows);
+   EBM_ASSERT(nullptr != aTargets);
+
+   static_assert(sizeof(UIntShared) == sizeof(FloatShared), "targets use the same stride for both tasks");
+   const size_t iByte = m_iByteTargets + sizeof(UIntShared) * m_iSample;
+   const size_t cBytes = sizeof(UIntShared) * cRows;
+   unsigned char * const pMem = GetChunkMem(iByte, cBytes);
+   if(nullptr == pMem) {
+      // already logged
+      return Error_OutOfMemory;
+   }
+
+   if(m_bClassification) {
+      const IntEbm countClasses = m_countClasses;
+      const IntEbm * pTarget = reinterpret_cast<const IntEbm *>(aTargets);
+      const IntEbm * const pTargetsEnd = pTarget + cRows;
+      UIntShared * pFill = reinterpret_cast<UIntShared *>(pMem);
+      do {
+         const IntEbm target = *pTarget;
+         if(target < IntEbm { 0 }) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilder::AppendChunkTargets classification target can't be negative");
+            return Error_IllegalParamVal;
+         }
+         if(countClasses <= target) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilder::AppendChunkTargets countClasses <= target");
+            return Error_IllegalParamVal;
+         }
+         // since countClasses can be converted to UIntShared, so now can target
+         EBM_ASSERT(!IsConvertError<UIntShared>(target));
+         *pFill = static_cast<UIntShared>(target);
+         ++pFill;
+         ++pTarget;
+      } while(pTargetsEnd != pTarget);
+   } else {
+      const double * pTarget = reinterpret_cast<const double *>(aTargets);
+      const double * const pTargetsEnd = pTarget + cRows;
+      FloatShared * pFill = reinterpret_cast<FloatShared *>(pMem);
+      do {
+         const double cleaned = CleanFloat(*pTarget);
+         if(std::isnan(cleaned)) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilder::AppendChunkTargets target is NaN");
+            return Error_IllegalParamVal;
+         }
+         if(std::isinf(cleaned)) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilder::AppendChunkTargets target is infinity");
+            return Error_IllegalParamVal;
+         }
+         const FloatShared converted = static_cast<FloatShared>(cleaned);
+         if(std::isnan(converted)) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilder::AppendChunkTargets target is NaN after conversion");
+            return Error_IllegalParamVal;
+         }
+         if(std::isinf(converted)) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilder::AppendChunkTargets target is infinity after conversion");
+            return Error_IllegalParamVal;
+         }
+         *pFill = converted;
+         ++pFill;
+         ++pTarget;
+      } while(pTargetsEnd != pTarget);
+   }
+
+   return WriteChunk(iByte, pMem, cBytes);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateDataSetBuilderChunked(
+   IntEbm countSamples,
+   IntEbm countFeatures,
+   const IntEbm * binCounts,
+   const BoolEbm * isMissing,
+   const BoolEbm * isUnknown,
+   const BoolEbm * isNominal,
+   IntEbm countWeights,
+   IntEbm countTargets,
+   BoolEbm isClassification,
+   IntEbm countClasses,
+   const char * filePath,
+   DataSetBuilderHandle * dataSetBuilderHandleOut
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered CreateDataSetBuilderChunked: "
+      "countSamples=%" IntEbmPrintf ", "
+      "countFeatures=%" IntEbmPrintf ", "
+      "binCounts=%p, "
+      "isMissing=%p, "
+      "isUnknown=%p, "
+      "isNominal=%p, "
+      "countWeights=%" IntEbmPrintf ", "
+      "countTargets=%" IntEbmPrintf ", "
+      "isClassification=%s, "
+      "countClasses=%" IntEbmPrintf ", "
+      "filePath=%p, "
+      "dataSetBuilderHandleOut=%p"
+      ,
+      countSamples,
+      countFeatures,
+      static_cast<const void *>(binCounts),
+      static_cast<const void *>(isMissing),
+      static_cast<const void *>(isUnknown),
+      static_cast<const void *>(isNominal),
+      countWeights,
+      countTargets,
+      ObtainTruth(isClassification),
+      countClasses,
+      static_cast<const void *>(filePath),
+      static_cast<void *>(dataSetBuilderHandleOut)
+   );
+
+   if(nullptr == dataSetBuilderHandleOut) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked nullptr == dataSetBuilderHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *dataSetBuilderHandleOut = nullptr; // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+
+   if(IsConvertError<size_t>(countSamples) || IsConvertError<UIntShared>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked countSamples is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   // rows are appended to every section at once, so there can be at most one weight and one target
+   if(IntEbm { 0 } != countWeights && IntEbm { 1 } != countWeights) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked countWeights must be 0 or 1");
+      return Error_IllegalParamVal;
+   }
+   if(IntEbm { 0 } != countTargets && IntEbm { 1 } != countTargets) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked countTargets must be 0 or 1");
+      return Error_IllegalParamVal;
+   }
+   if(EBM_FALSE != isClassification && EBM_TRUE != isClassification) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked isClassification is not EBM_FALSE or EBM_TRUE");
+      return Error_IllegalParamVal;
+   }
+   const bool bClassification = EBM_FALSE != isClassification;
+   if(bClassification && IsConvertError<UIntShared>(countClasses)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked countClasses is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+
+   // AppendHeader checks that these are valid and convertible before measuring
+   const IntEbm countBytesHeader = AppendHeader(countFeatures, countWeights, countTargets, 0, nullptr);
+   if(countBytesHeader < IntEbm { 0 }) {
+      return static_cast<ErrorEbm>(countBytesHeader);
+   }
+   const size_t cBytesHeader = static_cast<size_t>(countBytesHeader);
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cWeights = static_cast<size_t>(countWeights);
+   const size_t cTargets = static_cast<size_t>(countTargets);
+   const size_t cOffsets = cFeatures + cWeights + cTargets;
+
+   if(size_t { 0 } == cOffsets && size_t { 0 } != cSamples) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked samples require at least one section");
+      return Error_IllegalParamVal;
+   }
+
+   if(size_t { 0 } != cFeatures) {
+      if(nullptr == binCounts || nullptr == isMissing || nullptr == isUnknown || nullptr == isNominal) {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked the feature descriptions cannot be nullptr");
+         return Error_IllegalParamVal;
+      }
+   }
+
+   // one UIntShared per sample is the widest of the weight and target sections
+   if(IsMultiplyError(sizeof(UIntShared), cSamples)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked IsMultiplyError(sizeof(UIntShared), cSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesPerSection = sizeof(UIntShared) * cSamples;
+
+   if(IsMultiplyError(sizeof(ChunkedFeature), cFeatures)) {
+      LOG_0(Trace_Warning, "WARNING CreateDataSetBuilderChunked IsMultiplyError(sizeof(ChunkedFeature), cFeatures)");
+      return Error_OutOfMemory;
+   }
+
+   DataSetBuilder * const pDataSetBuilder = static_cast<DataSetBuilder *>(malloc(sizeof(DataSetBuilder)));
+   if(nullptr == pDataSetBuilder) {
+      LOG_0(Trace_Warning, "WARNING CreateDataSetBuilderChunked nullptr == pDataSetBuilder");
+      return Error_OutOfMemory;
+   }
+   pDataSetBuilder->InitializeUnfailing();
+   pDataSetBuilder->m_bChunked = true;
+   pDataSetBuilder->m_bClassification = bClassification;
+   pDataSetBuilder->m_countClasses = countClasses;
+   pDataSetBuilder->m_cSamples = cSamples;
+   pDataSetBuilder->m_cFeatures = cFeatures;
+   pDataSetBuilder->m_cWeights = cWeights;
+   pDataSetBuilder->m_cTargets = cTargets;
+   pDataSetBuilder->m_cOffsets = cOffsets;
+
+   ErrorEbm error;
+   if(size_t { 0 } != cFeatures) {
+      ChunkedFeature * const aChunkedFeatures =
+         static_cast<ChunkedFeature *>(malloc(sizeof(ChunkedFeature) * cFeatures));
+      if(nullptr == aChunkedFeatures) {
+         LOG_0(Trace_Warning, "WARNING CreateDataSetBuilderChunked nullptr == aChunkedFeatures");
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_OutOfMemory;
+      }
+      pDataSetBuilder->m_aChunkedFeatures = aChunkedFeatures;
+   }
+
+   // lay out every section now since the number of samples fixes the size of each of them
+   size_t iByteCur = cBytesHeader;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const IntEbm countBins = binCounts[iFeature];
+      if(countBins <= IntEbm { 1 }) {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked countBins must be 2 or larger");
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_IllegalParamVal;
+      }
+      if(IsConvertError<UIntShared>(countBins)) {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked countBins is outside the range of a valid index");
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_IllegalParamVal;
+      }
+      if(EBM_FALSE != isMissing[iFeature] && EBM_TRUE != isMissing[iFeature] ||
+         EBM_FALSE != isUnknown[iFeature] && EBM_TRUE != isUnknown[iFeature] ||
+         EBM_FALSE != isNominal[iFeature] && EBM_TRUE != isNominal[iFeature])
+      {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked feature flags must be EBM_FALSE or EBM_TRUE");
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_IllegalParamVal;
+      }
+      const bool bMissing = EBM_FALSE != isMissing[iFeature];
+      const bool bUnknown = EBM_FALSE != isUnknown[iFeature];
+
+      UIntShared cBins = static_cast<UIntShared>(countBins);
+      cBins -= bMissing ? UIntShared { 0 } : UIntShared { 1 };
+      cBins -= bUnknown ? UIntShared { 0 } : UIntShared { 1 };
+      if(size_t { 0 } != cSamples && UIntShared { 0 } == cBins) {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked UIntShared { 0 } == cBins");
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_IllegalParamVal;
+      }
+
+      ChunkedFeature * const pFeature = &pDataSetBuilder->m_aChunkedFeatures[iFeature];
+      pFeature->m_indexBinIllegal = countBins - (bUnknown ? IntEbm { 0 } : IntEbm { 1 });
+      pFeature->m_indexBinLegal = bMissing ? IntEbm { 0 } : IntEbm { 1 };
+      pFeature->m_bMissing = bMissing;
+      pFeature->m_bStored = size_t { 0 } != cSamples && UIntShared { 1 } < cBins;
+      pFeature->m_cItemsPerBitPack = 1;
+      pFeature->m_cBitsPerItemMax = 0;
+      pFeature->m_cShiftReset = 0;
+      pFeature->m_cShift = 0;
+      pFeature->m_bitsPending = 0;
+
+      // each section is at least as large as its own header so these additions cannot overflow before the checks below
+      size_t cBytesSection = sizeof(FeatureDataSetShared);
+      if(pFeature->m_bStored) {
+         const int cBitsRequiredMin = CountBitsRequired(cBins - UIntShared { 1 });
+         const int cItemsPerBitPack = GetCountItemsBitPacked<UIntShared>(cBitsRequiredMin);
+         const int cBitsPerItemMax = GetCountBits<UIntShared>(cItemsPerBitPack);
+         const size_t cDataUnits = (cSamples - size_t { 1 }) / static_cast<size_t>(cItemsPerBitPack) + size_t { 1 };
+
+         pFeature->m_cItemsPerBitPack = cItemsPerBitPack;
+         pFeature->m_cBitsPerItemMax = cBitsPerItemMax;
+         pFeature->m_cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
+         // the first word is the partial one, so the last sample always completes a word
+         pFeature->m_cShift = static_cast<int>((cSamples - size_t { 1 }) % static_cast<size_t>(cItemsPerBitPack)) * 
+            cBitsPerItemMax;
+
+         // cDataUnits <= cSamples so this cannot overflow given the check on cBytesPerSection
+         cBytesSection += sizeof(UIntShared) * cDataUnits;
+      }
+      if(IsAddError(iByteCur, cBytesSection)) {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked IsAddError(iByteCur, cBytesSection)");
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_IllegalParamVal;
+      }
+      pFeature->m_iByteNext = iByteCur + sizeof(FeatureDataSetShared);
+      iByteCur += cBytesSection;
+   }
+
+   const size_t iByteWeightsSection = iByteCur;
+   if(size_t { 0 } != cWeights) {
+      if(IsAddError(iByteCur, sizeof(WeightDataSetShared), cBytesPerSection)) {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked IsAddError(iByteCur, sizeof(WeightDataSetShared), cBytesPerSection)");
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_IllegalParamVal;
+      }
+      pDataSetBuilder->m_iByteWeights = iByteCur + sizeof(WeightDataSetShared);
+      iByteCur += sizeof(WeightDataSetShared) + cBytesPerSection;
+   }
+
+   const size_t iByteTargetsSection = iByteCur;
+   if(size_t { 0 } != cTargets) {
+      const size_t cBytesTargetHeader = bClassification ?
+         sizeof(TargetDataSetShared) + sizeof(ClassificationTargetDataSetShared) : sizeof(TargetDataSetShared);
+      if(IsAddError(iByteCur, cBytesTargetHeader, cBytesPerSection)) {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked IsAddError(iByteCur, cBytesTargetHeader, cBytesPerSection)");
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_IllegalParamVal;
+      }
+      pDataSetBuilder->m_iByteTargets = iByteCur + cBytesTargetHeader;
+      iByteCur += cBytesTargetHeader + cBytesPerSection;
+   }
+
+   if(IsConvertError<UIntShared>(iByteCur) || IsConvertError<IntEbm>(iByteCur)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilderChunked the dataset is too large");
+      DataSetBuilder::Free(pDataSetBuilder);
+      return Error_IllegalParamVal;
+   }
+   pDataSetBuilder->m_cBytesUsed = iByteCur;
+
+   if(nullptr == filePath) {
+      error = pDataSetBuilder->Reserve(iByteCur);
+      if(Error_None != error) {
+         DataSetBuilder::Free(pDataSetBuilder);
+         return error;
+      }
+   } else {
+      FILE * const pFile = fopen(filePath, "wb");
+      if(nullptr == pFile) {
+         LOG_0(Trace_Warning, "WARNING CreateDataSetBuilderChunked fopen failed");
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_IllegalParamVal;
+      }
+      pDataSetBuilder->m_pFile = pFile;
+   }
+
+   // write the header and the section headers.  The header stays in the working state until we are finalized
+   HeaderDataSetShared * const pHeaderDataSetShared =
+      reinterpret_cast<HeaderDataSetShared *>(pDataSetBuilder->GetChunkMem(0, cBytesHeader));
+   if(nullptr == pHeaderDataSetShared) {
+      DataSetBuilder::Free(pDataSetBuilder);
+      return Error_OutOfMemory;
+   }
+   pHeaderDataSetShared->m_id = k_sharedDataSetWorkingId;
+   pHeaderDataSetShared->m_cSamples = static_cast<UIntShared>(cSamples);
+   pHeaderDataSetShared->m_cFeatures = static_cast<UIntShared>(cFeatures);
+   pHeaderDataSetShared->m_cWeights = static_cast<UIntShared>(cWeights);
+   pHeaderDataSetShared->m_cTargets = static_cast<UIntShared>(cTargets);
+   UIntShared * const aOffsets = ArrayToPointer(pHeaderDataSetShared->m_offsets);
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      aOffsets[iFeature] = static_cast<UIntShared>(
+         pDataSetBuilder->m_aChunkedFeatures[iFeature].m_iByteNext - sizeof(FeatureDataSetShared));
+   }
+   if(size_t { 0 } != cWeights) {
+      aOffsets[cFeatures] = static_cast<UIntShared>(iByteWeightsSection);
+   }
+   if(size_t { 0 } != cTargets) {
+      aOffsets[cFeatures + cWeights] = static_cast<UIntShared>(iByteTargetsSection);
+   }
+   error = pDataSetBuilder->WriteChunk(0, pHeaderDataSetShared, cBytesHeader);
+   if(Error_None != error) {
+      DataSetBuilder::Free(pDataSetBuilder);
+      return error;
+   }
+
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      // in file mode the header was written from the scratch memory that we reuse here, so avoid aOffsets
+      const size_t iByteSection = pDataSetBuilder->m_aChunkedFeatures[iFeature].m_iByteNext - sizeof(FeatureDataSetShared);
+      FeatureDataSetShared * const pFeatureDataSetShared = reinterpret_cast<FeatureDataSetShared *>(
+         pDataSetBuilder->GetChunkMem(iByteSection, sizeof(FeatureDataSetShared)));
+      if(nullptr == pFeatureDataSetShared) {
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_OutOfMemory;
+      }
+      UIntShared cBins = static_cast<UIntShared>(binCounts[iFeature]);
+      cBins -= EBM_FALSE != isMissing[iFeature] ? UIntShared { 0 } : UIntShared { 1 };
+      cBins -= EBM_FALSE != isUnknown[iFeature] ? UIntShared { 0 } : UIntShared { 1 };
+      pFeatureDataSetShared->m_id = GetFeatureId(
+         EBM_FALSE != isMissing[iFeature],
+         EBM_FALSE != isUnknown[iFeature],
+         EBM_FALSE != isNominal[iFeature],
+         false
+      );
+      pFeatureDataSetShared->m_cBins = cBins;
+      error = pDataSetBuilder->WriteChunk(iByteSection, pFeatureDataSetShared, sizeof(FeatureDataSetShared));
+      if(Error_None != error) {
+         DataSetBuilder::Free(pDataSetBuilder);
+         return error;
+      }
+   }
+
+   if(size_t { 0 } != cWeights) {
+      WeightDataSetShared * const pWeightDataSetShared = reinterpret_cast<WeightDataSetShared *>(
+         pDataSetBuilder->GetChunkMem(iByteWeightsSection, sizeof(WeightDataSetShared)));
+      if(nullptr == pWeightDataSetShared) {
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_OutOfMemory;
+      }
+      pWeightDataSetShared->m_id = k_weightId;
+      error = pDataSetBuilder->WriteChunk(iByteWeightsSection, pWeightDataSetShared, sizeof(WeightDataSetShared));
+      if(Error_None != error) {
+         DataSetBuilder::Free(pDataSetBuilder);
+         return error;
+      }
+   }
+
+   if(size_t { 0 } != cTargets) {
+      const size_t cBytesTargetHeader = pDataSetBuilder->m_iByteTargets - iByteTargetsSection;
+      unsigned char * const pTargetMem = pDataSetBuilder->GetChunkMem(iByteTargetsSection, cBytesTargetHeader);
+      if(nullptr == pTargetMem) {
+         DataSetBuilder::Free(pDataSetBuilder);
+         return Error_OutOfMemory;
+      }
+      TargetDataSetShared * const pTargetDataSetShared = reinterpret_cast<TargetDataSetShared *>(pTargetMem);
+      pTargetDataSetShared->m_id = GetTargetId(bClassification);
+      if(bClassification) {
+         ClassificationTargetDataSetShared * const pClassificationTargetDataSetShared =
+            reinterpret_cast<ClassificationTargetDataSetShared *>(pTargetMem + sizeof(TargetDataSetShared));
+         pClassificationTargetDataSetShared->m_cClasses = static_cast<UIntShared>(countClasses);
+      }
+      error = pDataSetBuilder->WriteChunk(iByteTargetsSection, pTargetMem, cBytesTargetHeader);
+      if(Error_None != error) {
+         DataSetBuilder::Free(pDataSetBuilder);
+         return error;
+      }
+   }
+
+   *dataSetBuilderHandleOut = reinterpret_cast<DataSetBuilderHandle>(pDataSetBuilder);
+
+   LOG_0(Trace_Info, "Exited CreateDataSetBuilderChunked");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION DataSetBuilderAppendRows(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countRows,
+   const IntEbm * binIndexes,
+   const double * weights,
+   const void * targets
+) {
+   DataSetBuilder * const pDataSetBuilder = DataSetBuilder::GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(!pDataSetBuilder->m_bChunked) {
+      LOG_0(Trace_Error, "ERROR DataSetBuilderAppendRows the builder was not created by CreateDataSetBuilderChunked");
+      return Error_IllegalParamVal;
+   }
+   if(pDataSetBuilder->m_bChunkFailed) {
+      LOG_0(Trace_Error, "ERROR DataSetBuilderAppendRows a previous chunk failed");
+      return Error_IllegalParamVal;
+   }
+
+   ErrorEbm error;
+   {
+      if(IsConvertError<size_t>(countRows)) {
+         LOG_0(Trace_Error, "ERROR DataSetBuilderAppendRows countRows is outside the range of a valid index");
+         error = Error_IllegalParamVal;
+         goto return_bad;
+      }
+      const size_t cRows = static_cast<size_t>(countRows);
+      if(pDataSetBuilder->m_cSamples - pDataSetBuilder->m_iSample < cRows) {
+         LOG_0(Trace_Error, "ERROR DataSetBuilderAppendRows more rows were appended than the dataset has samples");
+         error = Error_IllegalParamVal;
+         goto return_bad;
+      }
+      if(size_t { 0 } == cRows) {
+         return Error_None;
+      }
+
+      const size_t cFeatures = pDataSetBuilder->m_cFeatures;
+      if(size_t { 0 } != cFeatures) {
+         if(nullptr == binIndexes) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilderAppendRows nullptr == binIndexes");
+            error = Error_IllegalParamVal;
+            goto return_bad;
+         }
+         if(IsMultiplyError(sizeof(*binIndexes), cFeatures, cRows)) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilderAppendRows IsMultiplyError(sizeof(*binIndexes), cFeatures, cRows)");
+            error = Error_IllegalParamVal;
+            goto return_bad;
+         }
+         // binIndexes holds cRows bin indexes for the first feature followed by cRows for the next feature, etc.
+         const IntEbm * pBinIndexes = binIndexes;
+         ChunkedFeature * pFeature = pDataSetBuilder->m_aChunkedFeatures;
+         const ChunkedFeature * const pFeaturesEnd = pFeature + cFeatures;
+         do {
+            error = pDataSetBuilder->AppendChunkFeature(pFeature, cRows, pBinIndexes);
+            if(Error_None != error) {
+               goto return_bad;
+            }
+            pBinIndexes += cRows;
+            ++pFeature;
+         } while(pFeaturesEnd != pFeature);
+      }
+
+      if(size_t { 0 } != pDataSetBuilder->m_cWeights) {
+         if(nullptr == weights) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilderAppendRows nullptr == weights");
+            error = Error_IllegalParamVal;
+            goto return_bad;
+         }
+         error = pDataSetBuilder->AppendChunkWeights(cRows, weights);
+         if(Error_None != error) {
+            goto return_bad;
+         }
+      }
+
+      if(size_t { 0 } != pDataSetBuilder->m_cTargets) {
+         if(nullptr == targets) {
+            LOG_0(Trace_Error, "ERROR DataSetBuilderAppendRows nullptr == targets");
+            error = Error_IllegalParamVal;
+            goto return_bad;
+         }
+         error = pDataSetBuilder->AppendChunkTargets(cRows, targets);
+         if(Error_None != error) {
+            goto return_bad;
+         }
+      }
+
+      pDataSetBuilder->m_iSample += cRows;
+      return Error_None;
+   }
+
+return_bad:;
+
+   // a chunk can be partly written when it fails, so the builder cannot be used afterwards
+   pDataSetBuilder->m_bChunkFailed = true;
+   if(nullptr != pDataSetBuilder->m_pBuffer) {
+      reinterpret_cast<HeaderDataSetShared *>(pDataSetBuilder->m_pBuffer)->m_id = k_sharedDataSetErrorId;
+   }
+   return error;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FinalizeDataSetBuilder(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm * countBytesOut
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered FinalizeDataSetBuilder: "
+      "dataSetBuilderHandle=%p, "
+      "countBytesOut=%p"
+      ,
+      static_cast<void *>(dataSetBuilderHandle),
+      static_cast<void *>(countBytesOut)
+   );
+
+   if(nullptr == countBytesOut) {
+      LOG_0(Trace_Error, "ERROR FinalizeDataSetBuilder nullptr == countBytesOut");
+      return Error_IllegalParamVal;
+   }
+   *countBytesOut = 0;
+
+   DataSetBuilder * const pDataSetBuilder = DataSetBuilder::GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(pDataSetBuilder->m_bChunked) {
+      if(pDataSetBuilder->m_bChunkFailed || pDataSetBuilder->m_iSample != pDataSetBuilder->m_cSamples) {
+         LOG_0(Trace_Error, "ERROR FinalizeDataSetBuilder the dataset is incomplete or a chunk failed");
+         return Error_IllegalParamVal;
+      }
+
+      // the size was checked for conversion to IntEbm when the builder was created
+      const size_t cBytesTotal = pDataSetBuilder->m_cBytesUsed;
+      if(nullptr != pDataSetBuilder->m_pFile) {
+         // we validated every row as it was appended, so all that remains is to mark the file as complete
+         static constexpr UIntShared idDone = k_sharedDataSetDoneId;
+         ErrorEbm error = pDataSetBuilder->WriteChunk(0, &idDone, sizeof(idDone));
+         const int retClose = fclose(pDataSetBuilder->m_pFile);
+         pDataSetBuilder->m_pFile = nullptr;
+         if(Error_None == error && 0 != retClose) {
+            LOG_0(Trace_Warning, "WARNING FinalizeDataSetBuilder fclose failed");
+            error = Error_UnexpectedInternal;
+         }
+         pDataSetBuilder->m_bChunkFailed = true; // the file is closed, so nothing else can be done with this builder
+         if(Error_None != error) {
+            return error;
+         }
+      } else {
+         if(nullptr == pDataSetBuilder->m_pBuffer || 
+            k_sharedDataSetWorkingId != reinterpret_cast<const HeaderDataSetShared *>(pDataSetBuilder->m_pBuffer)->m_id)
+         {
+            LOG_0(Trace_Error, "ERROR FinalizeDataSetBuilder the dataset was already finalized");
+            return Error_IllegalParamVal;
+         }
+         const ErrorEbm error = LockDataSetShared(cBytesTotal, pDataSetBuilder->m_pBuffer);
+         if(Error_None != error) {
+            pDataSetBuilder->m_bChunkFailed = true;
+            return error;
+         }
+      }
+
+      *countBytesOut = static_cast<IntEbm>(cBytesTotal);
+
+      LOG_0(Trace_Info, "Exited FinalizeDataSetBuilder");
+      return Error_None;
+   }
+
+   const HeaderDataSetShared * const pHeaderDataSetShared =
+      reinterpret_cast<const HeaderDataSetShared *>(pDataSetBuilder->m_pBuffer);
+   if(pDataSetBuilder->m_iOffset != pDataSetBuilder->m_cOffsets || 
+      k_sharedDataSetDoneId != pHeaderDataSetShared->m_id) 
+   {
+      LOG_0(Trace_Error, "ERROR FinalizeDataSetBuilder the dataset is incomplete or a section failed");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cBytesUsed = pDataSetBuilder->m_cBytesUsed;
+   if(IsConvertError<IntEbm>(cBytesUsed)) {
+      LOG_0(Trace_Error, "ERROR FinalizeDataSetBuilder IsConvertError<IntEbm>(cBytesUsed)");
+      return Error_OutOfMemory;
+   }
+
+   if(cBytesUsed != pDataSetBuilder->m_cBytesCapacity) {
+      // compact the buffer down to the finished dataset.  If realloc fails we keep the larger buffer
+      unsigned char * const pBuffer = static_cast<unsigned char *>(realloc(pDataSetBuilder->m_pBuffer, cBytesUsed));
+      if(nullptr != pBuffer) {
+         pDataSetBuilder->m_pBuffer = pBuffer;
+         pDataSetBuilder->m_cBytesCapacity = cBytesUsed;
+      }
+   }
+
+   *countBytesOut = static_cast<IntEbm>(cBytesUsed);
+
+   LOG_0(Trace_Info, "Exited FinalizeDataSetBuilder");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CopyDataSetBuilder(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countBytesAllocated,
+   void * dataSetOut
+) {
+   DataSetBuilder * const pDataSetBuilder = DataSetBuilder::GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == dataSetOut) {
+      LOG_0(Trace_Error, "ERROR CopyDataSetBuilder nullptr == dataSetOut");
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == pDataSetBuilder->m_pBuffer) {
+      LOG_0(Trace_Error, "ERROR CopyDataSetBuilder the dataset was written to a file");
+      return Error_IllegalParamVal;
+   }
+
+   const HeaderDataSetShared * const pHeaderDataSetShared =
+      reinterpret_cast<const HeaderDataSetShared *>(pDataSetBuilder->m_pBuffer);
+   if(k_sharedDataSetDoneId != pHeaderDataSetShared->m_id) {
+      LOG_0(Trace_Error, "ERROR CopyDataSetBuilder the dataset is not complete");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated) || 
+      static_cast<size_t>(countBytesAllocated) != pDataSetBuilder->m_cBytesUsed) 
+   {
+      LOG_0(Trace_Error, "ERROR CopyDataSetBuilder countBytesAllocated does not match the finalized size");
+      return Error_IllegalParamVal;
+   }
+
+   memcpy(dataSetOut, pDataSetBuilder->m_pBuffer, pDataSetBuilder->m_cBytesUsed);
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION DetachDataSetBuilder(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countBytesAllocated,
+   void ** dataSetOut
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered DetachDataSetBuilder: "
+      "dataSetBuilderHandle=%p, "
+      "countBytesAllocated=%" IntEbmPrintf ", "
+      "dataSetOut=%p"
+      ,
+      static_cast<void *>(dataSetBuilderHandle),
+      countBytesAllocated,
+      static_cast<void *>(dataSetOut)
+   );
+
+   if(nullptr == dataSetOut) {
+      LOG_0(Trace_Error, "ERROR DetachDataSetBuilder nullptr == dataSetOut");
+      return Error_IllegalParamVal;
+   }
+   *dataSetOut = nullptr;
+
+   DataSetBuilder * const pDataSetBuilder = DataSetBuilder::GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == pDataSetBuilder->m_pBuffer) {
+      LOG_0(Trace_Error, "ERROR DetachDataSetBuilder the dataset was written to a file or was already detached");
+      return Error_IllegalParamVal;
+   }
+
+   const HeaderDataSetShared * const pHeaderDataSetShared =
+      reinterpret_cast<const HeaderDataSetShared *>(pDataSetBuilder->m_pBuffer);
+   if(k_sharedDataSetDoneId != pHeaderDataSetShared->m_id) {
+      LOG_0(Trace_Error, "ERROR DetachDataSetBuilder the dataset is not complete");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated) || 
+      static_cast<size_t>(countBytesAllocated) != pDataSetBuilder->m_cBytesUsed) 
+   {
+      LOG_0(Trace_Error, "ERROR DetachDataSetBuilder countBytesAllocated does not match the finalized size");
+      return Error_IllegalParamVal;
+   }
+
+   // ownership moves to the caller, who releases it with FreeDataSet
+   *dataSetOut = pDataSetBuilder->m_pBuffer;
+   pDataSetBuilder->m_pBuffer = nullptr;
+   pDataSetBuilder->m_cBytesCapacity = 0;
+
+   LOG_0(Trace_Info, "Exited DetachDataSetBuilder");
+   return Error_None;
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION FreeDataSet(void * dataSet) {
+   LOG_N(Trace_Info, "Entered FreeDataSet: dataSet=%p", dataSet);
+
+   free(dataSet);
+
+   LOG_0(Trace_Info, "Exited FreeDataSet");
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION FreeDataSetBuilder(
+   DataSetBuilderHandle dataSetBuilderHandle
+) {
+   LOG_N(Trace_Info, "Entered FreeDataSetBuilder: dataSetBuilderHandle=%p", static_cast<void *>(dataSetBuilderHandle));
+
+   // if the conversion doesn't work, it'll return null, and we'll leak memory, but at least we'll log that
+   DataSetBuilder::Free(DataSetBuilder::GetDataSetBuilderFromHandle(dataSetBuilderHandle));
+
+   LOG_0(Trace_Info, "Exited FreeDataSetBuilder");
+}
+
 extern ErrorEbm GetDataSetSharedHeader(
    const unsigned char * const pDataSetShared,
    UIntShared * const pcSamplesOut,
@@ -2386,4 +3696,257 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ExtractTargetClasses(
    return Error_None;
 }
 
+struct ScoreDimension {
+   const UIntShared * m_pData;
+   size_t m_mask;
+   size_t m_cBins;
+   size_t m_iBinOffset;
+   int m_cItemsPerBitPack;
+   int m_cBitsPerItemMax;
+   int m_iShift;
+};
+static_assert(std::is_standard_layout<ScoreDimension>::value,
+   "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<ScoreDimension>::value,
+   "We use memcpy in several places, so disallow non-trivial types in general");
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcSampleScores(
+   const void * dataSet,
+   const BagEbm * bag,
+   const double * initScores,
+   IntEbm countScores,
+   IntEbm countTerms,
+   const IntEbm * dimensionCounts,
+   const IntEbm * featureIndexes,
+   const double * termScores,
+   double * sampleScoresOut
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered CalcSampleScores: "
+      "dataSet=%p, "
+      "bag=%p, "
+      "initScores=%p, "
+      "countScores=%" IntEbmPrintf ", "
+      "countTerms=%" IntEbmPrintf ", "
+      "dimensionCounts=%p, "
+      "featureIndexes=%p, "
+      "termScores=%p, "
+      "sampleScoresOut=%p"
+      ,
+      dataSet,
+      static_cast<const void *>(bag),
+      static_cast<const void *>(initScores),
+      countScores,
+      countTerms,
+      static_cast<const void *>(dimensionCounts),
+      static_cast<const void *>(featureIndexes),
+      static_cast<const void *>(termScores),
+      static_cast<void *>(sampleScoresOut)
+   );
+
+   if(nullptr == dataSet) {
+      LOG_0(Trace_Error, "ERROR CalcSampleScores nullptr == dataSet");
+      return Error_IllegalParamVal;
+   }
+
+   const HeaderDataSetShared * const pHeaderDataSetShared = reinterpret_cast<const HeaderDataSetShared *>(dataSet);
+   if(k_sharedDataSetDoneId != pHeaderDataSetShared->m_id) {
+      LOG_0(Trace_Error, "ERROR CalcSampleScores k_sharedDataSetDoneId != pHeaderDataSetShared->m_id");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countScores)) {
+      LOG_0(Trace_Error, "ERROR CalcSampleScores IsConvertError<size_t>(countScores)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cScores = static_cast<size_t>(countScores);
+
+   if(IsConvertError<size_t>(countTerms)) {
+      LOG_0(Trace_Error, "ERROR CalcSampleScores IsConvertError<size_t>(countTerms)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTerms = static_cast<size_t>(countTerms);
+
+   EBM_ASSERT(!IsConvertError<size_t>(pHeaderDataSetShared->m_cSamples)); // it's allocated so must fit into size_t
+   const size_t cSamples = static_cast<size_t>(pHeaderDataSetShared->m_cSamples);
+   EBM_ASSERT(!IsConvertError<size_t>(pHeaderDataSetShared->m_cFeatures));
+   const size_t cFeatures = static_cast<size_t>(pHeaderDataSetShared->m_cFeatures);
+
+   if(size_t { 0 } == cSamples || size_t { 0 } == cScores) {
+      LOG_0(Trace_Info, "Exited CalcSampleScores no scores");
+      return Error_None;
+   }
+
+   size_t cIncluded = cSamples;
+   if(nullptr != bag) {
+      cIncluded = 0;
+      const BagEbm * pBag = bag;
+      const BagEbm * const pBagEnd = bag + cSamples;
+      do {
+         if(BagEbm { 0 } != *pBag) {
+            ++cIncluded;
+         }
+         ++pBag;
+      } while(pBagEnd != pBag);
+   }
+   if(size_t { 0 } == cIncluded) {
+      LOG_0(Trace_Info, "Exited CalcSampleScores no samples in the bag");
+      return Error_None;
+   }
+
+   if(nullptr == sampleScoresOut) {
+      LOG_0(Trace_Error, "ERROR CalcSampleScores nullptr == sampleScoresOut");
+      return Error_IllegalParamVal;
+   }
+   if(IsMultiplyError(sizeof(double), cScores, cIncluded)) {
+      LOG_0(Trace_Error, "ERROR CalcSampleScores IsMultiplyError(sizeof(double), cScores, cIncluded)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesScores = sizeof(double) * cScores * cIncluded;
+   if(nullptr == initScores) {
+      memset(sampleScoresOut, 0, cBytesScores);
+   } else {
+      memcpy(sampleScoresOut, initScores, cBytesScores);
+   }
+
+   if(size_t { 0 } == cTerms) {
+      LOG_0(Trace_Info, "Exited CalcSampleScores no terms");
+      return Error_None;
+   }
+   if(nullptr == dimensionCounts) {
+      LOG_0(Trace_Error, "ERROR CalcSampleScores dimensionCounts cannot be null if 0 < countTerms");
+      return Error_IllegalParamVal;
+   }
+   if(nullptr == termScores) {
+      LOG_0(Trace_Error, "ERROR CalcSampleScores termScores cannot be null if 0 < countTerms");
+      return Error_IllegalParamVal;
+   }
+
+   const double * pTermScores = termScores;
+   const IntEbm * piFeature = featureIndexes;
+   size_t iTerm = 0;
+   do {
+      const IntEbm countDimensions = dimensionCounts[iTerm];
+      if(countDimensions < IntEbm { 0 } || IntEbm { k_cDimensionsMax } < countDimensions) {
+         LOG_0(Trace_Error, "ERROR CalcSampleScores countDimensions must be between 0 and k_cDimensionsMax");
+         return Error_IllegalParamVal;
+      }
+      const size_t cDimensions = static_cast<size_t>(countDimensions);
+      if(size_t { 0 } != cDimensions && nullptr == piFeature) {
+         LOG_0(Trace_Error, "ERROR CalcSampleScores featureIndexes cannot be null if a term has dimensions");
+         return Error_IllegalParamVal;
+      }
+
+      // termScores is in the layout of GetBestTermScores: row major over the public bins of each feature in the
+      // order given, with the scores innermost. The dataset omits the missing bin when a feature has none, so its
+      // bin indexes are one lower than the public ones for those features
+      ScoreDimension aDimensions[k_cDimensionsMax];
+      size_t cTensorCells = 1;
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         const IntEbm indexFeature = piFeature[iDimension];
+         if(IsConvertError<size_t>(indexFeature) || cFeatures <= static_cast<size_t>(indexFeature)) {
+            LOG_0(Trace_Error, "ERROR CalcSampleScores featureIndexes value must index a feature of dataSet");
+            return Error_IllegalParamVal;
+         }
+
+         bool bMissing;
+         bool bUnknown;
+         bool bNominal;
+         bool bSparse;
+         UIntShared countBinsStored;
+         UIntShared defaultValSparse;
+         size_t cNonDefaultsSparse;
+         const void * const pData = GetDataSetSharedFeature(
+            static_cast<const unsigned char *>(dataSet),
+            static_cast<size_t>(indexFeature),
+            &bMissing,
+            &bUnknown,
+            &bNominal,
+            &bSparse,
+            &countBinsStored,
+            &defaultValSparse,
+            &cNonDefaultsSparse
+         );
+         EBM_ASSERT(nullptr != pData);
+         if(bSparse) {
+            // we don't create sparse features yet
+            LOG_0(Trace_Error, "ERROR CalcSampleScores sparse features are not supported");
+            return Error_IllegalParamVal;
+         }
+         EBM_ASSERT(!IsConvertError<size_t>(countBinsStored)); // the data is allocated, so cBins fits
+         const size_t cBinsStored = static_cast<size_t>(countBinsStored);
+         EBM_ASSERT(size_t { 1 } <= cBinsStored); // zero bins requires zero samples
+
+         ScoreDimension * const pDimension = &aDimensions[iDimension];
+         pDimension->m_iBinOffset = bMissing ? size_t { 0 } : size_t { 1 };
+         pDimension->m_cBins = cBinsStored + pDimension->m_iBinOffset + (bUnknown ? size_t { 0 } : size_t { 1 });
+         if(IsMultiplyError(cTensorCells, pDimension->m_cBins)) {
+            LOG_0(Trace_Error, "ERROR CalcSampleScores IsMultiplyError(cTensorCells, pDimension->m_cBins)");
+            return Error_IllegalParamVal;
+         }
+         cTensorCells *= pDimension->m_cBins;
+
+         if(size_t { 1 } == cBinsStored) {
+            // a single bin is not stored since every sample has it
+            pDimension->m_pData = nullptr;
+            pDimension->m_mask = 0;
+            pDimension->m_cItemsPerBitPack = 1;
+            pDimension->m_cBitsPerItemMax = 0;
+            pDimension->m_iShift = 0;
+         } else {
+            const int cItemsPerBitPack = GetCountItemsBitPacked<UIntShared>(CountBitsRequired(cBinsStored - size_t { 1 }));
+            const int cBitsPerItemMax = GetCountBits<UIntShared>(cItemsPerBitPack);
+            pDimension->m_pData = static_cast<const UIntShared *>(pData);
+            pDimension->m_mask = static_cast<size_t>(MakeLowMask<UIntShared>(cBitsPerItemMax));
+            pDimension->m_cItemsPerBitPack = cItemsPerBitPack;
+            pDimension->m_cBitsPerItemMax = cBitsPerItemMax;
+            // the first word holds the remainder, with the first sample in its highest position
+            pDimension->m_iShift = static_cast<int>((cSamples - size_t { 1 }) % static_cast<size_t>(cItemsPerBitPack));
+         }
+      }
+      if(IsMultiplyError(cTensorCells, cScores)) {
+         LOG_0(Trace_Error, "ERROR CalcSampleScores IsMultiplyError(cTensorCells, cScores)");
+         return Error_IllegalParamVal;
+      }
+
+      double * pScores = sampleScoresOut;
+      size_t iSample = 0;
+      do {
+         // every dimension has to be read for every sample to stay in step, including the ones outside the bag
+         size_t iCell = 0;
+         for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+            ScoreDimension * const pDimension = &aDimensions[iDimension];
+            size_t iBin = 0;
+            if(nullptr != pDimension->m_pData) {
+               iBin = static_cast<size_t>(*pDimension->m_pData >> 
+                  (pDimension->m_iShift * pDimension->m_cBitsPerItemMax)) & pDimension->m_mask;
+               --pDimension->m_iShift;
+               if(pDimension->m_iShift < 0) {
+                  pDimension->m_iShift = pDimension->m_cItemsPerBitPack - 1;
+                  ++pDimension->m_pData;
+               }
+            }
+            iCell = iCell * pDimension->m_cBins + iBin + pDimension->m_iBinOffset;
+         }
+
+         if(nullptr == bag || BagEbm { 0 } != bag[iSample]) {
+            const double * const pCell = &pTermScores[iCell * cScores];
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               pScores[iScore] += pCell[iScore];
+            }
+            pScores += cScores;
+         }
+         ++iSample;
+      } while(cSamples != iSample);
+
+      pTermScores += cTensorCells * cScores;
+      piFeature += cDimensions;
+      ++iTerm;
+   } while(cTerms != iTerm);
+
+   LOG_0(Trace_Info, "Exited CalcSampleScores");
+   return Error_None;
+}
+
 } // DEFINED_ZONE_NAME
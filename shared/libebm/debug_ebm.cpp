@@ -78,6 +78,7 @@ static double TestTranspose() {
       for(int iDimension = 0; iDimension < cDimensions; ++iDimension) {
          aTermFeatures[iDimension].m_iTranspose = iDimension;
          aTermFeatures[iDimension].m_pFeature = &features[iDimension];
+         aTermFeatures[iDimension].m_iFeature = static_cast<size_t>(iDimension);
          aTermFeatures[iDimension].m_cStride = cTensorBins;
 
          int cBins;
@@ -131,6 +131,14 @@ typedef struct _InteractionHandle {
    uint32_t handleVerification; // should be 21773 if ok. Do not use size_t since that requires an additional header.
 } * InteractionHandle;
 
+typedef struct _DataSetBuilderHandle {
+   uint32_t handleVerification; // should be 18443 if ok. Do not use size_t since that requires an additional header.
+} * DataSetBuilderHandle;
+
+typedef struct _QuantileSketchHandle {
+   uint32_t handleVerification; // should be 14087 if ok. Do not use size_t since that requires an additional header.
+} * QuantileSketchHandle;
+
 #define BOOL_CAST(val)                             (STATIC_CAST(BoolEbm, (val)))
 #define ERROR_CAST(val)                            (STATIC_CAST(ErrorEbm, (val)))
 #define LINK_FLAGS_CAST(val)                       (STATIC_CAST(LinkFlags, (val)))
@@ -142,6 +150,7 @@ typedef struct _InteractionHandle {
 #define TRACE_CAST(val)                            (STATIC_CAST(TraceEbm, (val)))
 #define LINK_CAST(val)                             (STATIC_CAST(LinkEbm, (val)))
 #define TASK_CAST(val)                             (STATIC_CAST(TaskEbm, (val)))
+#define BOOSTER_STAT_CAST(val)                     (STATIC_CAST(IntEbm, (val)))
 
 // TODO: look through our code for places where SAFE_FLOAT64_AS_INT64_MAX or FLOAT64_TO_INT64_MAX would be useful
 
@@ -198,6 +207,12 @@ typedef struct _InteractionHandle {
 #define Error_ObjectiveParamNonPrivate             (ERROR_CAST(-20))
 #define Error_ObjectiveIllegalTarget               (ERROR_CAST(-21))
 
+#define Error_MetricUnknown                        (ERROR_CAST(-22))
+#define Error_MetricParamUnknown                   (ERROR_CAST(-23))
+#define Error_MetricParamValMalformed              (ERROR_CAST(-24))
+#define Error_MetricParamValOutOfRange             (ERROR_CAST(-25))
+#define Error_MetricMismatchWithObjective          (ERROR_CAST(-26))
+
 #define LinkFlags_Default                          (LINK_FLAGS_CAST(0x00000000))
 #define LinkFlags_DifferentialPrivacy              (LINK_FLAGS_CAST(0x00000001))
 #define LinkFlags_BinaryAsMulticlass               (LINK_FLAGS_CAST(0x00000002))
@@ -206,6 +221,13 @@ typedef struct _InteractionHandle {
 #define CreateBoosterFlags_DifferentialPrivacy     (CREATE_BOOSTER_FLAGS_CAST(0x00000001))
 #define CreateBoosterFlags_DisableApprox           (CREATE_BOOSTER_FLAGS_CAST(0x00000002))
 #define CreateBoosterFlags_BinaryAsMulticlass      (CREATE_BOOSTER_FLAGS_CAST(0x00000004))
+#define CreateBoosterFlags_QuantizeGradients8      (CREATE_BOOSTER_FLAGS_CAST(0x00000008))
+#define CreateBoosterFlags_QuantizeGradients16     (CREATE_BOOSTER_FLAGS_CAST(0x00000010))
+#define CreateBoosterFlags_HostOffload             (CREATE_BOOSTER_FLAGS_CAST(0x00000020))
+#define CreateBoosterFlags_FeatureStorage          (CREATE_BOOSTER_FLAGS_CAST(0x00000040))
+#define CreateBoosterFlags_CollectStats            (CREATE_BOOSTER_FLAGS_CAST(0x00000100))
+#define CreateBoosterFlags_BagBits                 (CREATE_BOOSTER_FLAGS_CAST(0x00000400))
+#define CreateBoosterFlags_PinThreads              (CREATE_BOOSTER_FLAGS_CAST(0x00000800))
 
 #define TermBoostFlags_Default                     (TERM_BOOST_FLAGS_CAST(0x00000000))
 #define TermBoostFlags_DisableNewtonGain           (TERM_BOOST_FLAGS_CAST(0x00000001))
@@ -217,6 +239,7 @@ typedef struct _InteractionHandle {
 #define CreateInteractionFlags_DifferentialPrivacy (CREATE_INTERACTION_FLAGS_CAST(0x00000001))
 #define CreateInteractionFlags_DisableApprox       (CREATE_INTERACTION_FLAGS_CAST(0x00000002))
 #define CreateInteractionFlags_BinaryAsMulticlass  (CREATE_INTERACTION_FLAGS_CAST(0x00000004))
+#define CreateInteractionFlags_EnableNewton        (CREATE_INTERACTION_FLAGS_CAST(0x00000008))
 
 #define CalcInteractionFlags_Default               (CALC_INTERACTION_FLAGS_CAST(0x00000000))
 #define CalcInteractionFlags_Pure                  (CALC_INTERACTION_FLAGS_CAST(0x00000001))
@@ -231,6 +254,30 @@ typedef struct _InteractionHandle {
 #define AccelerationFlags_GPU                      (AccelerationFlags_Nvidia)
 #define AccelerationFlags_ALL                      (ACCELERATION_CAST(~ACCELERATION_CAST(0)))
 
+// GetBoosterStats returns BoosterStat_Count values for each of the BoosterPhase_Count phases (phase major), and
+// TermStat_Count values for each term (term major). Times are in nanoseconds. Bytes are the estimated bytes
+// streamed through memory by the phase.
+#define BoosterPhase_BinSumsBoosting               (BOOSTER_STAT_CAST(0))
+#define BoosterPhase_ConvertAddBin                 (BOOSTER_STAT_CAST(1))
+#define BoosterPhase_TensorTotalsBuild             (BOOSTER_STAT_CAST(2))
+#define BoosterPhase_PartitionOneDimensional       (BOOSTER_STAT_CAST(3))
+#define BoosterPhase_PartitionTwoDimensional       (BOOSTER_STAT_CAST(4))
+#define BoosterPhase_ApplyUpdate                   (BOOSTER_STAT_CAST(5)) // includes fused bin sums for the next term
+#define BoosterPhase_Metric                        (BOOSTER_STAT_CAST(6)) // validation score update and metric
+#define BoosterPhase_BestModelCopy                 (BOOSTER_STAT_CAST(7))
+#define BoosterPhase_Count                         (BOOSTER_STAT_CAST(8))
+
+#define BoosterStat_Nanoseconds                    (BOOSTER_STAT_CAST(0))
+#define BoosterStat_Calls                          (BOOSTER_STAT_CAST(1))
+#define BoosterStat_Bytes                          (BOOSTER_STAT_CAST(2))
+#define BoosterStat_Count                          (BOOSTER_STAT_CAST(3))
+
+#define TermStat_GenerateCalls                     (BOOSTER_STAT_CAST(0))
+#define TermStat_GenerateNanoseconds               (BOOSTER_STAT_CAST(1))
+#define TermStat_ApplyCalls                        (BOOSTER_STAT_CAST(2))
+#define TermStat_ApplyNanoseconds                  (BOOSTER_STAT_CAST(3))
+#define TermStat_Count                             (BOOSTER_STAT_CAST(4))
+
 // No messages will be logged. This is the default.
 #define Trace_Off                                  (TRACE_CAST(0))
 // Invalid inputs to the C interface, internal errors, or assert failures before exiting. Cannot continue afterwards.
@@ -282,6 +329,12 @@ typedef struct _InteractionHandle {
 #define Task_MulticlassPlus                        (TASK_CAST(3))  // 3+ classes (the value is the # of classes)
 
 // All our logging messages are pure ASCII (127 values), and therefore also conform to UTF-8
+// At Trace_Info and Trace_Verbose the callback is also called from a background thread that libebm owns, so it must
+// be safe to call from a thread that the caller did not create, and must not call back into libebm. Only one call is
+// in progress at a time, and each thread's messages arrive in the order that thread logged them. Trace_Error and
+// Trace_Warning messages are delivered synchronously on the thread that logged them. Setting the level below
+// Trace_Info delivers everything buffered and stops the background thread before SetTraceLevel returns, so hosts
+// should do that before their callback becomes unusable, such as at interpreter shutdown.
 typedef void (EBM_CALLING_CONVENTION * LogCallbackFunction)(TraceEbm traceLevel, const char * message);
 
 // SetLogCallback does not need to be called if the level is left at Trace_Off
@@ -323,6 +376,45 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutQuantile(
    IntEbm * countCutsInOut,
    double * cutsLowerBoundInclusiveOut
 );
+// CutQuantileWeighted places the cuts on the weighted quantiles of the feature values, so a reweighted or 
+// downsampled dataset gets the bins of the distribution that it represents. weights can be nullptr. Like
+// CutQuantile, minSamplesBin is the minimum number of samples (not weight) per bin. If all the weights are equal
+// the cuts are identical to CutQuantile.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutQuantileWeighted(
+   IntEbm countSamples,
+   const double * featureVals,
+   const double * weights,
+   IntEbm minSamplesBin,
+   BoolEbm isRounded,
+   IntEbm * countCutsInOut,
+   double * cutsLowerBoundInclusiveOut
+);
+// The QuantileSketch functions compute the cuts of CutQuantileWeighted from samples that arrive in chunks, so the
+// whole feature never needs to be in memory. The sketch keeps at most 2 * countEntriesMax entries. While the feature
+// has no more than countEntriesMax distinct values the cuts equal CutQuantileWeighted with non-uniform weights.
+// Beyond that, neighbouring values are merged into entries holding about 2 / countEntriesMax of the total weight
+// each, and a cut can be off from its weighted quantile by the weight of the entries next to it. minSamplesBin
+// still counts samples. weights can be nullptr. Samples can be added after CutQuantileSketch is called.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateQuantileSketch(
+   IntEbm countEntriesMax,
+   QuantileSketchHandle * quantileSketchHandleOut
+);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION QuantileSketchAddSamples(
+   QuantileSketchHandle quantileSketchHandle,
+   IntEbm countSamples,
+   const double * featureVals,
+   const double * weights
+);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutQuantileSketch(
+   QuantileSketchHandle quantileSketchHandle,
+   IntEbm minSamplesBin,
+   BoolEbm isRounded,
+   IntEbm * countCutsInOut,
+   double * cutsLowerBoundInclusiveOut
+);
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION FreeQuantileSketch(
+   QuantileSketchHandle quantileSketchHandle
+);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
    IntEbm countSamples,
    const double * featureVals,
@@ -412,6 +504,83 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillRegressionTarget(
    void * fillMem
 );
 
+// the DataSetBuilder functions build the same dataset as the Measure/Fill functions in a single pass over the data
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateDataSetBuilder(
+   IntEbm countFeatures,
+   IntEbm countWeights,
+   IntEbm countTargets,
+   DataSetBuilderHandle * dataSetBuilderHandleOut
+);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DataSetBuilderAddFeature(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countBins,
+   BoolEbm isMissing,
+   BoolEbm isUnknown,
+   BoolEbm isNominal,
+   IntEbm countSamples,
+   const IntEbm * binIndexes
+);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DataSetBuilderAddWeight(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countSamples,
+   const double * weights
+);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DataSetBuilderAddClassificationTarget(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countClasses,
+   IntEbm countSamples,
+   const IntEbm * targets
+);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DataSetBuilderAddRegressionTarget(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countSamples,
+   const double * targets
+);
+// the chunked DataSetBuilder is given the shape of the dataset up front and then receives the rows in chunks, which
+// are packed directly into their final location in memory or in the file at filePath (nullptr for memory).
+// binIndexes holds countRows indexes for each feature in turn. A file is complete once FinalizeDataSetBuilder returns
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateDataSetBuilderChunked(
+   IntEbm countSamples,
+   IntEbm countFeatures,
+   const IntEbm * binCounts,
+   const BoolEbm * isMissing,
+   const BoolEbm * isUnknown,
+   const BoolEbm * isNominal,
+   IntEbm countWeights,
+   IntEbm countTargets,
+   BoolEbm isClassification,
+   IntEbm countClasses,
+   const char * filePath,
+   DataSetBuilderHandle * dataSetBuilderHandleOut
+);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DataSetBuilderAppendRows(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countRows,
+   const IntEbm * binIndexes,
+   const double * weights,
+   const void * targets
+);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FinalizeDataSetBuilder(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm * countBytesOut
+);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CopyDataSetBuilder(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countBytesAllocated,
+   void * dataSetOut
+);
+// hands the finalized in-memory dataset to the caller without copying it.  The builder gives up the memory, which
+// the caller then owns independently of the builder and releases with FreeDataSet
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DetachDataSetBuilder(
+   DataSetBuilderHandle dataSetBuilderHandle,
+   IntEbm countBytesAllocated,
+   void ** dataSetOut
+);
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION FreeDataSet(void * dataSet);
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION FreeDataSetBuilder(
+   DataSetBuilderHandle dataSetBuilderHandle
+);
+
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CheckDataSet(IntEbm countBytesAllocated, const void * dataSet);
 
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ExtractDataSetHeader(
@@ -431,6 +600,22 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ExtractTargetClasses(
    IntEbm countTargetsVerify,
    IntEbm * classCountsOut
 );
+// CalcSampleScores writes initScores plus the scores of countTerms terms for every sample of dataSet with a non-zero
+// bag entry, in the layout of the initScores of CreateBooster. dimensionCounts and featureIndexes describe the terms as
+// in CreateBooster, and termScores holds their tensors one after the other in the layout of GetBestTermScores. The
+// scores are summed in double, so unlike GetSampleScores they do not depend on the compute zone that boosted the
+// terms. initScores can be nullptr
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CalcSampleScores(
+   const void * dataSet,
+   const BagEbm * bag,
+   const double * initScores,
+   IntEbm countScores,
+   IntEbm countTerms,
+   const IntEbm * dimensionCounts,
+   const IntEbm * featureIndexes,
+   const double * termScores,
+   double * sampleScoresOut
+);
 
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacement(
    void * rng,
@@ -446,6 +631,35 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratifi
    const IntEbm * targets,
    BagEbm * bagOut
 );
+// SampleWithoutReplacementStratifiedBags writes countBags stratified bags to bagsOut, one after another, each of
+// length countTrainingSamples + countValidationSamples. rngs is either nullptr or an array of countBags RNGs, and each
+// bag is drawn from and advances its own RNG exactly as SampleWithoutReplacementStratified would. The bags are spread
+// over countThreads threads (0 means one per hardware thread), so the result does not depend on the thread count.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratifiedBags(
+   void * rngs,
+   IntEbm countBags,
+   IntEbm countClasses,
+   IntEbm countTrainingSamples,
+   IntEbm countValidationSamples,
+   const IntEbm * targets,
+   IntEbm countThreads,
+   BagEbm * bagsOut
+);
+// SampleWithoutReplacementStratifiedBagBits draws the same bags as SampleWithoutReplacementStratifiedBags, but writes
+// each bag as bag bits: (countTrainingSamples + countValidationSamples + 63) / 64 uint64_t words where bit i of
+// word i / 64 is set if sample i is in the training set and clear if it is in the validation set. The unused bits of
+// the last word are zero. Bag bits are 8 times smaller than BagEbm bags and can be passed as the bag of CreateBooster
+// with CreateBoosterFlags_BagBits once cast to const BagEbm *.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratifiedBagBits(
+   void * rngs,
+   IntEbm countBags,
+   IntEbm countClasses,
+   IntEbm countTrainingSamples,
+   IntEbm countValidationSamples,
+   const IntEbm * targets,
+   IntEbm countThreads,
+   uint64_t * bagBitsOut
+);
 
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DetermineTask(
    const char * objective,
@@ -472,6 +686,17 @@ EBM_API_INCLUDE LinkEbm EBM_CALLING_CONVENTION GetLinkFunctionInt(
    const char * link
 );
 
+// With CreateBoosterFlags_BagBits the bag of CreateBooster, and of GetSampleScores and AddTerms on that booster, is
+// bag bits from SampleWithoutReplacementStratifiedBagBits instead of one BagEbm per sample. Bag bits cannot replicate
+// samples, so every sample is used once for either training or validation.
+// CreateBoosterFlags_HostOffload runs one worker thread per CPU that the process may use, grouped by NUMA node, and
+// places each worker's share of the dataset on its node. CreateBoosterFlags_PinThreads also pins each worker to its
+// CPU on Linux so that it stays next to that memory. It is ignored without CreateBoosterFlags_HostOffload.
+// CreateBoosterFlags_QuantizeGradients8 and CreateBoosterFlags_QuantizeGradients16 store the training gradients and
+// hessians as int8 or int16 with a scale per gradient and hessian and stochastic rounding. With
+// CreateBoosterFlags_HostOffload the quantization is split across the workers too. Quantized boosters never fuse the
+// ApplyTermUpdate of one term with the bin sums of the next, and compute zones that cannot sum quantized gradients,
+// like CUDA, log a warning and train on float gradients instead.
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateBooster(
    void * rng,
    const void * dataSet,
@@ -488,6 +713,13 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateBooster(
    const double * experimentalParams,
    BoosterHandle * boosterHandleOut
 );
+// A view is a separate BoosterHandle on the same booster. Each handle can be used by only one thread at a time, but
+// different views can be called in parallel. GenerateTermUpdate calls on different views run concurrently since they
+// only read the shared gradients, so all the candidate terms of a round can be evaluated at once with one view per
+// term. ApplyTermUpdate and ApplyTermUpdateFused wait for running GenerateTermUpdate calls to finish and apply one at
+// a time. The update that gets applied is the one generated on the same view. GenerateTermUpdate also runs one at a
+// time with CreateBoosterFlags_HostOffload, and on terms that need a shared cache to be filled. That happens with
+// CreateBoosterFlags_FeatureStorage on terms with 2 or more dimensions.
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateBoosterView(
    BoosterHandle boosterHandle,
    BoosterHandle * boosterHandleViewOut
@@ -505,6 +737,25 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(
    const IntEbm * leavesMax, 
    double * avgGainOut
 );
+// ComputeTermGains runs GenerateTermUpdate for each of the terms in indexTerms against the current gradients and
+// writes their gains to avgGainsOut without applying anything. The terms are spread over countThreads threads, each
+// with its own view (0 means one per hardware thread). Each position in indexTerms draws from its own rng stream, so
+// the gains do not depend on the thread count. If indexTermBestOut is not nullptr, the update of the term with the
+// highest gain is left on boosterHandle and its term index is returned, so ApplyTermUpdate commits it. If every term
+// overflowed it returns -1. Either way boosterHandle is left without an update if there is no best term to return.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ComputeTermGains(
+   void * rng,
+   BoosterHandle boosterHandle,
+   IntEbm countTerms,
+   const IntEbm * indexTerms,
+   TermBoostFlags flags,
+   double learningRate,
+   IntEbm minSamplesLeaf,
+   const IntEbm * leavesMax,
+   IntEbm countThreads,
+   double * avgGainsOut,
+   IntEbm * indexTermBestOut
+);
 // GetTermUpdateSplits must be called before calls to GetTermUpdate/SetTermUpdate
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetTermUpdateSplits(
    BoosterHandle boosterHandle,
@@ -525,6 +776,11 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
    BoosterHandle boosterHandle,
    double * avgValidationMetricOut
 );
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdateFused(
+   BoosterHandle boosterHandle,
+   IntEbm indexTermNext,
+   double * avgValidationMetricOut
+);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetBestTermScores(
    BoosterHandle boosterHandle, 
    IntEbm indexTerm,
@@ -536,6 +792,54 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetCurrentTermScores(
    double * termScoresTensorOut
 );
 
+// GetSampleScores writes the booster's current scores, including the initScores it was created with, for either the
+// training (direction 1) or validation (direction -1) samples. dataSet and bag must be the ones given to
+// CreateBooster. dataSet is only read for RMSE, which keeps residuals instead of scores. sampleScoresOut has the same
+// layout as initScores: one row of scores per sample with a non-zero bag entry, in the original sample order. Only
+// the rows of samples in the requested direction are written, so calling it for both directions fills every row.
+// The scores are held in the precision of the compute zone.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetSampleScores(
+   BoosterHandle boosterHandle,
+   BagEbm direction,
+   const void * dataSet,
+   const BagEbm * bag,
+   double * sampleScoresOut
+);
+
+// AddTerms appends countTerms terms to a booster without rebuilding it, so that boosting continues from the current
+// scores, gradients and inner bags. This lets the pair stage start from the state the mains left behind. The
+// featureIndexes of the new terms index the features of dataSet, which get appended to the features of the booster.
+// dataSet must hold the same samples in the same order as the dataSet given to CreateBooster and bag must be the same
+// bag, but its features can be binned differently. The new terms are numbered after the existing ones, and the best
+// model is found again from the next ApplyTermUpdate onwards. AddTerms fails on boosters with views or created with
+// CreateBoosterFlags_FeatureStorage. If it fails for any other reason the booster can only be freed.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION AddTerms(
+   BoosterHandle boosterHandle,
+   const void * dataSet,
+   const BagEbm * bag,
+   IntEbm countTerms,
+   const IntEbm * dimensionCounts,
+   const IntEbm * featureIndexes
+);
+
+// SetValidationMetric replaces the objective's own metric with a registered metric (eg: "auc" for binary log_loss)
+// for the avgValidationMetricOut of ApplyTermUpdate and for choosing the best model. The metric is computed in the
+// same pass over the validation set that updates its scores. Like the objective metrics, metrics that should be
+// maximized are returned negated so that lower is always better. A nullptr or empty metric returns to the objective's
+// metric. The best model is found again from the next ApplyTermUpdate onwards.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SetValidationMetric(
+   BoosterHandle boosterHandle,
+   const char * metric
+);
+
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetBoosterStats(
+   BoosterHandle boosterHandle,
+   IntEbm countPhaseStats, // BoosterPhase_Count * BoosterStat_Count, or 0 if phaseStatsOut is null
+   IntEbm * phaseStatsOut,
+   IntEbm countTermStats, // countTerms * TermStat_Count, or 0 if termStatsOut is null
+   IntEbm * termStatsOut
+);
+
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(
    const void * dataSet,
    const BagEbm * bag,
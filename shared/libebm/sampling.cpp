@@ -4,6 +4,8 @@
 
 #include "pch.hpp"
 
+#include <thread>
+
 #include "libebm.h" // ErrorEbm
 #include "logging.h" // EBM_ASSERT
 #include "unzoned.h" // LIKELY
@@ -16,6 +18,7 @@
 #include "RandomDeterministic.hpp"
 #include "RandomNondeterministic.hpp"
 #include "dataset_shared.hpp" // GetDataSetSharedWeight
+#include "OuterBag.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -115,6 +118,223 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacement(
    return Error_None;
 }
 
+struct TargetClass final {
+   TargetClass() = default; // preserve our POD status
+   ~TargetClass() = default; // preserve our POD status
+   void * operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete (void *) = delete; // we only use malloc/free in this library
+
+   size_t m_cTrainingSamples;
+   size_t m_cSamples;
+};
+static_assert(std::is_standard_layout<TargetClass>::value,
+   "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<TargetClass>::value,
+   "We use memcpy in several places, so disallow non-trivial types in general");
+static_assert(std::is_pod<TargetClass>::value,
+   "We use a lot of C constructs, so disallow non-POD types in general");
+
+// The caller fills m_cSamples with the number of samples of each class and zeros m_cTrainingSamples. On return
+// m_cTrainingSamples holds how many of the samples of each class go to training.
+static void AllocateStratifiedTraining(
+   RandomDeterministic & cpuRng,
+   const size_t cClasses,
+   const size_t cTrainingSamples,
+   const size_t cSamples,
+   TargetClass * const aTargetClasses,
+   TargetClass ** const apMostImprovedClasses
+) {
+   EBM_ASSERT(1 <= cClasses);
+   EBM_ASSERT(cTrainingSamples <= cSamples);
+   EBM_ASSERT(1 <= cSamples);
+   EBM_ASSERT(nullptr != aTargetClasses);
+   EBM_ASSERT(nullptr != apMostImprovedClasses);
+
+   const TargetClass * const pTargetClassesEnd = aTargetClasses + cClasses;
+
+   // This stratified sampling algorithm guarantees:
+   // (1) Either the train/validation counts work out perfectly for each class -or- there is at 
+   //     least one class with a count above the ideal training count and at least one class with
+   //     a training count below the ideal count,
+   // (2) Given a sufficient amount of training samples, if a class has only one sample, it 
+   //     should go to training,
+   // (3) Given a sufficient amount of training samples, if a class only has two samples, one 
+   //     should go to train and one should go to test,
+   // (4) If a class has enough samples to hit the target train/validation count, its actual
+   //     train/validation count should be no more than one away from the ideal count. 
+   // 
+   // Given these guarantees, the sketch of this algorithm is that for the common case where there 
+   // are enough training samples to have more than one sample per class, we initialize the count 
+   // of the training samples per class to be the floor of the ideal training count.  This will 
+   // leave some amount of samples to be "leftover".  We assign leftovers to classes by determining
+   // which class will get closest to its ideal training count by giving it one more training 
+   // sample.  If there is more than one class that gets the same improvement, we'll randomly 
+   // assign the "leftover" to one of the classes.
+   // 
+   // In addition to having leftovers as a result of taking the floor of the ideal training count 
+   // of each class, we decrement the ideal training count of each class by 1 and consider those
+   // samples leftovers as well.  This assures us we have enough leftovers to give 1 to any classes
+   // that have 0 training samples when looking at leftovers.  We use this to achieve the 2nd 
+   // guarantee that any class with at 1 sample will get at least one sample assigned to training.
+   //
+   // For the odd cases where there aren't enough training samples given to give at least one 
+   // sample to each class, we'll let all the training samples be considered leftover and allow our
+   // boosting of improvement for classes with no samples to drive how assignment of training 
+   // samples is done as ideal training counts are impossible to achieve, but we'll try to assign
+   // at least one training sample to each class that has samples.
+
+   const double idealTrainingProportion = static_cast<double>(cTrainingSamples) / cSamples;
+   EBM_ASSERT(!std::isnan(idealTrainingProportion)); // since we checked cSamples not zero above
+   EBM_ASSERT(!std::isinf(idealTrainingProportion)); // since we checked cSamples not zero above
+   EBM_ASSERT(0 <= idealTrainingProportion);
+   EBM_ASSERT(idealTrainingProportion <= 1);
+
+   size_t cLeftoverTrainingSamples = cTrainingSamples;
+   if(cClasses < cTrainingSamples) {
+      TargetClass * pTargetClass = aTargetClasses;
+      do {
+         size_t cClassSamples = pTargetClass->m_cSamples;
+         double trainingPerClass = std::floor(idealTrainingProportion * cClassSamples);
+         size_t cTrainingPerClass = static_cast<size_t>(trainingPerClass);
+         if(0 < cTrainingPerClass) {
+            --cTrainingPerClass;
+         }
+         pTargetClass->m_cTrainingSamples = cTrainingPerClass;
+         EBM_ASSERT(cTrainingPerClass <= cLeftoverTrainingSamples);
+         cLeftoverTrainingSamples -= cTrainingPerClass;
+         ++pTargetClass;
+      } while(pTargetClassesEnd != pTargetClass);
+   }
+   EBM_ASSERT(cLeftoverTrainingSamples <= cSamples);
+
+   while(0 != cLeftoverTrainingSamples) {
+      double bestImprovement = -std::numeric_limits<double>::infinity();
+      TargetClass ** ppMostImprovedClasses = apMostImprovedClasses;
+      TargetClass * pTargetClass = aTargetClasses;
+      do {
+         const size_t cClassTrainingSamples = pTargetClass->m_cTrainingSamples;
+         const size_t cClassSamples = pTargetClass->m_cSamples;
+
+         if(cClassTrainingSamples != cClassSamples) {
+            EBM_ASSERT(0 < cClassSamples); // because cClassTrainingSamples == cClassSamples if cClassSamples is zero
+
+            double idealClassTraining = idealTrainingProportion * static_cast<double>(cClassSamples);
+            double curTrainingDiff = idealClassTraining - cClassTrainingSamples;
+            const size_t cClassTrainingSamplesPlusOne = cClassTrainingSamples + 1;
+            double newTrainingDiff = idealClassTraining - cClassTrainingSamplesPlusOne;
+            double improvement = (curTrainingDiff * curTrainingDiff) - (newTrainingDiff * newTrainingDiff);
+
+            if(0 == cClassTrainingSamples) {
+               // improvement should not be able to be larger than 9
+               improvement += 32;
+            } else if(cClassTrainingSamples + 1 == cClassSamples) {
+               // improvement should not be able to be larger than 9
+               improvement -= 32;
+            }
+
+            if(bestImprovement <= improvement) {
+               ppMostImprovedClasses = 
+                  LIKELY(improvement != bestImprovement) ? apMostImprovedClasses : ppMostImprovedClasses;
+               *ppMostImprovedClasses = pTargetClass;
+               ++ppMostImprovedClasses;
+               bestImprovement = improvement;
+            }
+         }
+         ++pTargetClass;
+      } while(pTargetClassesEnd != pTargetClass);
+      EBM_ASSERT(-std::numeric_limits<double>::infinity() != bestImprovement);
+
+      // If more than one class has the same max improvement, randomly select between the classes
+      // to give the leftover to.
+      const size_t cMostImproved = ppMostImprovedClasses - apMostImprovedClasses;
+      EBM_ASSERT(1 <= cMostImproved);
+      const size_t iRandom = cpuRng.NextFast(cMostImproved);
+      TargetClass * const pMostImprovedClasses = apMostImprovedClasses[iRandom];
+      ++pMostImprovedClasses->m_cTrainingSamples;
+
+      --cLeftoverTrainingSamples;
+   }
+
+#ifndef NDEBUG
+   size_t cTrainingSamplesDebug = 0;
+   size_t cSamplesDebug = 0;
+   for(size_t iClassDebug = 0; iClassDebug < cClasses; ++iClassDebug) {
+      cTrainingSamplesDebug += aTargetClasses[iClassDebug].m_cTrainingSamples;
+      cSamplesDebug += aTargetClasses[iClassDebug].m_cSamples;
+   }
+   EBM_ASSERT(cTrainingSamplesDebug == cTrainingSamples);
+   EBM_ASSERT(cSamplesDebug == cSamples);
+#endif
+}
+
+// draws the samples of each class without replacement so that exactly m_cTrainingSamples of them go to training.
+// This consumes the counts in aTargetClasses, which are all zero on return. With bBits the bag is written as
+// bag bits (see OuterBag.hpp) instead of BagEbm replications.
+template<bool bBits>
+static void AssignStratifiedBag(
+   RandomDeterministic & cpuRng,
+   const size_t cClasses,
+   const size_t cSamples,
+   const IntEbm * const targets,
+   TargetClass * const aTargetClasses,
+   void * const bagOut
+) {
+   UNUSED(cClasses);
+   EBM_ASSERT(1 <= cSamples);
+   EBM_ASSERT(nullptr != targets);
+   EBM_ASSERT(nullptr != aTargetClasses);
+   EBM_ASSERT(nullptr != bagOut);
+
+   const IntEbm * pTarget = targets;
+   const IntEbm * const pTargetsEnd = &targets[cSamples];
+   BagEbm * pSampleReplicationOut = static_cast<BagEbm *>(bagOut);
+   uint64_t * pBitsOut = static_cast<uint64_t *>(bagOut);
+   uint64_t bits = 0;
+   size_t iBit = 0;
+   do {
+      const IntEbm indexClass = *pTarget;
+      EBM_ASSERT(0 <= indexClass);
+      EBM_ASSERT(static_cast<size_t>(indexClass) < cClasses);
+
+      TargetClass * const pTargetClass = &aTargetClasses[static_cast<size_t>(indexClass)];
+      EBM_ASSERT(1 <= pTargetClass->m_cSamples);
+      const size_t iRandom = cpuRng.NextFast(pTargetClass->m_cSamples);
+      const bool bTrainingSample = UNPREDICTABLE(iRandom < pTargetClass->m_cTrainingSamples);
+
+      const size_t cSubtract = UNPREDICTABLE(bTrainingSample) ? size_t { 1 } : size_t { 0 };
+      pTargetClass->m_cTrainingSamples -= cSubtract;
+      --pTargetClass->m_cSamples;
+
+      if(bBits) {
+         bits |= static_cast<uint64_t>(cSubtract) << iBit;
+         ++iBit;
+         if(k_cBagBitsPerWord == iBit) {
+            *pBitsOut = bits;
+            ++pBitsOut;
+            bits = 0;
+            iBit = 0;
+         }
+      } else {
+         *pSampleReplicationOut = UNPREDICTABLE(bTrainingSample) ? BagEbm { 1 } : BagEbm { -1 };
+         ++pSampleReplicationOut;
+      }
+
+      ++pTarget;
+   } while(pTargetsEnd != pTarget);
+
+   if(bBits && size_t { 0 } != iBit) {
+      // the padding bits of the last word are left clear
+      *pBitsOut = bits;
+   }
+
+#ifndef NDEBUG
+   for(size_t iClassDebug = 0; iClassDebug < cClasses; ++iClassDebug) {
+      EBM_ASSERT(0 == aTargetClasses[iClassDebug].m_cTrainingSamples);
+      EBM_ASSERT(0 == aTargetClasses[iClassDebug].m_cSamples);
+   }
+#endif
+}
+
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratified(
    void * rng,
    IntEbm countClasses,
@@ -123,11 +343,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratified(
    const IntEbm * targets,
    BagEbm * bagOut
 ) {
-   struct TargetClass {
-      size_t m_cTrainingSamples;
-      size_t m_cSamples;
-   };
-
    LOG_N(
       Trace_Info,
       "Entered SampleWithoutReplacementStratified: "
@@ -240,9 +455,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratified(
    // the C++ says memset legal to use for setting classes with unsigned integer types
    memset(aTargetClasses, 0, cBytesAllTargetClasses);
 
-   const TargetClass * const pTargetClassesEnd = IndexByte(aTargetClasses, cBytesAllTargetClasses);
-   EBM_ASSERT(pTargetClassesEnd != aTargetClasses);
-
    // determine number of samples per class in the target
    const IntEbm * pTargetInit = targets;
    const IntEbm * const pTargetsEnd = &targets[cSamples];
@@ -263,61 +475,6 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratified(
       ++pTargetInit;
    } while(pTargetsEnd != pTargetInit);
 
-   // This stratified sampling algorithm guarantees:
-   // (1) Either the train/validation counts work out perfectly for each class -or- there is at 
-   //     least one class with a count above the ideal training count and at least one class with
-   //     a training count below the ideal count,
-   // (2) Given a sufficient amount of training samples, if a class has only one sample, it 
-   //     should go to training,
-   // (3) Given a sufficient amount of training samples, if a class only has two samples, one 
-   //     should go to train and one should go to test,
-   // (4) If a class has enough samples to hit the target train/validation count, its actual
-   //     train/validation count should be no more than one away from the ideal count. 
-   // 
-   // Given these guarantees, the sketch of this algorithm is that for the common case where there 
-   // are enough training samples to have more than one sample per class, we initialize the count 
-   // of the training samples per class to be the floor of the ideal training count.  This will 
-   // leave some amount of samples to be "leftover".  We assign leftovers to classes by determining
-   // which class will get closest to its ideal training count by giving it one more training 
-   // sample.  If there is more than one class that gets the same improvement, we'll randomly 
-   // assign the "leftover" to one of the classes.
-   // 
-   // In addition to having leftovers as a result of taking the floor of the ideal training count 
-   // of each class, we decrement the ideal training count of each class by 1 and consider those
-   // samples leftovers as well.  This assures us we have enough leftovers to give 1 to any classes
-   // that have 0 training samples when looking at leftovers.  We use this to achieve the 2nd 
-   // guarantee that any class with at 1 sample will get at least one sample assigned to training.
-   //
-   // For the odd cases where there aren't enough training samples given to give at least one 
-   // sample to each class, we'll let all the training samples be considered leftover and allow our
-   // boosting of improvement for classes with no samples to drive how assignment of training 
-   // samples is done as ideal training counts are impossible to achieve, but we'll try to assign
-   // at least one training sample to each class that has samples.
-
-   const double idealTrainingProportion = static_cast<double>(cTrainingSamples) / cSamples;
-   EBM_ASSERT(!std::isnan(idealTrainingProportion)); // since we checked cSamples not zero above
-   EBM_ASSERT(!std::isinf(idealTrainingProportion)); // since we checked cSamples not zero above
-   EBM_ASSERT(0 <= idealTrainingProportion);
-   EBM_ASSERT(idealTrainingProportion <= 1);
-
-   size_t cLeftoverTrainingSamples = cTrainingSamples;
-   if(cClasses < cTrainingSamples) {
-      TargetClass * pTargetClass = aTargetClasses;
-      do {
-         size_t cClassSamples = pTargetClass->m_cSamples;
-         double trainingPerClass = std::floor(idealTrainingProportion * cClassSamples);
-         size_t cTrainingPerClass = static_cast<size_t>(trainingPerClass);
-         if(0 < cTrainingPerClass) {
-            --cTrainingPerClass;
-         }
-         pTargetClass->m_cTrainingSamples = cTrainingPerClass;
-         EBM_ASSERT(cTrainingPerClass <= cLeftoverTrainingSamples);
-         cLeftoverTrainingSamples -= cTrainingPerClass;
-         ++pTargetClass;
-      } while(pTargetClassesEnd != pTargetClass);
-   }
-   EBM_ASSERT(cLeftoverTrainingSamples <= cSamples);
-
    if(IsMultiplyError(sizeof(TargetClass *), cClasses)) {
       LOG_0(Trace_Warning, "WARNING SampleWithoutReplacementStratified IsMultiplyError(sizeof(TargetClass *), cClasses)");
       free(aTargetClasses);
@@ -330,102 +487,440 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratified(
       return Error_OutOfMemory;
    }
 
-   while(0 != cLeftoverTrainingSamples) {
-      double bestImprovement = -std::numeric_limits<double>::infinity();
-      TargetClass ** ppMostImprovedClasses = apMostImprovedClasses;
-      TargetClass * pTargetClass = aTargetClasses;
-      do {
-         const size_t cClassTrainingSamples = pTargetClass->m_cTrainingSamples;
-         const size_t cClassSamples = pTargetClass->m_cSamples;
+   AllocateStratifiedTraining(cpuRng, cClasses, cTrainingSamples, cSamples, aTargetClasses, apMostImprovedClasses);
+   AssignStratifiedBag<false>(cpuRng, cClasses, cSamples, targets, aTargetClasses, bagOut);
 
-         if(cClassTrainingSamples != cClassSamples) {
-            EBM_ASSERT(0 < cClassSamples); // because cClassTrainingSamples == cClassSamples if cClassSamples is zero
+   if(nullptr != rng) {
+      RandomDeterministic * pRng = reinterpret_cast<RandomDeterministic *>(rng);
+      pRng->Initialize(cpuRng); // move the RNG from memory into CPU registers
+   }
 
-            double idealClassTraining = idealTrainingProportion * static_cast<double>(cClassSamples);
-            double curTrainingDiff = idealClassTraining - cClassTrainingSamples;
-            const size_t cClassTrainingSamplesPlusOne = cClassTrainingSamples + 1;
-            double newTrainingDiff = idealClassTraining - cClassTrainingSamplesPlusOne;
-            double improvement = (curTrainingDiff * curTrainingDiff) - (newTrainingDiff * newTrainingDiff);
+   free(aTargetClasses);
+   free(apMostImprovedClasses);
 
-            if(0 == cClassTrainingSamples) {
-               // improvement should not be able to be larger than 9
-               improvement += 32;
-            } else if(cClassTrainingSamples + 1 == cClassSamples) {
-               // improvement should not be able to be larger than 9
-               improvement -= 32;
-            }
+   LOG_0(Trace_Info, "Exited SampleWithoutReplacementStratified");
 
-            if(bestImprovement <= improvement) {
-               ppMostImprovedClasses = 
-                  LIKELY(improvement != bestImprovement) ? apMostImprovedClasses : ppMostImprovedClasses;
-               *ppMostImprovedClasses = pTargetClass;
-               ++ppMostImprovedClasses;
-               bestImprovement = improvement;
-            }
-         }
-         ++pTargetClass;
-      } while(pTargetClassesEnd != pTargetClass);
-      EBM_ASSERT(-std::numeric_limits<double>::infinity() != bestImprovement);
+   return Error_None;
+}
 
-      // If more than one class has the same max improvement, randomly select between the classes
-      // to give the leftover to.
-      const size_t cMostImproved = ppMostImprovedClasses - apMostImprovedClasses;
-      EBM_ASSERT(1 <= cMostImproved);
-      const size_t iRandom = cpuRng.NextFast(cMostImproved);
-      TargetClass * const pMostImprovedClasses = apMostImprovedClasses[iRandom];
-      ++pMostImprovedClasses->m_cTrainingSamples;
+struct StratifiedBagsJob final {
+   RandomDeterministic * m_aRngs;
+   uint64_t m_seedBase;
+   size_t m_cBags;
+   size_t m_cThreads;
+   size_t m_cClasses;
+   size_t m_cTrainingSamples;
+   size_t m_cSamples;
+   const IntEbm * m_aTargets;
+   const TargetClass * m_aTargetClassesInit;
+   BagEbm * m_aBags;
+   uint64_t * m_aBagBits;
+};
+
+struct StratifiedBagsWorker final {
+   size_t m_iFirst;
+   TargetClass * m_aTargetClasses;
+   TargetClass ** m_apMostImprovedClasses;
+};
+
+static void SampleStratifiedBagsWorker(const StratifiedBagsJob * const pJob, StratifiedBagsWorker * const pWorker) {
+   const size_t cClasses = pJob->m_cClasses;
+   const size_t cSamples = pJob->m_cSamples;
+   RandomDeterministic cpuRng;
+   for(size_t iBag = pWorker->m_iFirst; iBag < pJob->m_cBags; iBag += pJob->m_cThreads) {
+      if(nullptr == pJob->m_aRngs) {
+         cpuRng.Initialize(pJob->m_seedBase + static_cast<uint64_t>(iBag));
+      } else {
+         cpuRng.Initialize(pJob->m_aRngs[iBag]); // move the RNG from memory into CPU registers
+      }
 
-      --cLeftoverTrainingSamples;
+      // every bag has the same class counts, so only the allocation of leftovers and the draws are repeated
+      memcpy(pWorker->m_aTargetClasses, pJob->m_aTargetClassesInit, sizeof(TargetClass) * cClasses);
+      AllocateStratifiedTraining(
+         cpuRng,
+         cClasses,
+         pJob->m_cTrainingSamples,
+         cSamples,
+         pWorker->m_aTargetClasses,
+         pWorker->m_apMostImprovedClasses
+      );
+      if(nullptr != pJob->m_aBagBits) {
+         AssignStratifiedBag<true>(
+            cpuRng,
+            cClasses,
+            cSamples,
+            pJob->m_aTargets,
+            pWorker->m_aTargetClasses,
+            pJob->m_aBagBits + GetCountBagBitsWords(cSamples) * iBag
+         );
+      } else {
+         AssignStratifiedBag<false>(
+            cpuRng,
+            cClasses,
+            cSamples,
+            pJob->m_aTargets,
+            pWorker->m_aTargetClasses,
+            pJob->m_aBags + cSamples * iBag
+         );
+      }
+
+      if(nullptr != pJob->m_aRngs) {
+         pJob->m_aRngs[iBag].Initialize(cpuRng); // move the RNG from the CPU registers back into memory
+      }
+   }
+}
+
+// shared by SampleWithoutReplacementStratifiedBags and SampleWithoutReplacementStratifiedBagBits, which differ only in
+// whether bagsOut or bagBitsOut receives the bags
+static ErrorEbm SampleStratifiedBags(
+   void * const rngs,
+   const IntEbm countBags,
+   const IntEbm countClasses,
+   const IntEbm countTrainingSamples,
+   const IntEbm countValidationSamples,
+   const IntEbm * const targets,
+   const IntEbm countThreads,
+   BagEbm * const bagsOut,
+   uint64_t * const bagBitsOut
+) {
+   EBM_ASSERT(nullptr == bagsOut || nullptr == bagBitsOut);
+
+   if(UNLIKELY(IsConvertError<size_t>(countBags))) {
+      LOG_0(Trace_Error, "ERROR SampleStratifiedBags IsConvertError<size_t>(countBags)");
+      return Error_IllegalParamVal;
    }
+   const size_t cBags = static_cast<size_t>(countBags);
 
-#ifndef NDEBUG
-   size_t cTrainingSamplesDebug = 0;
-   size_t cSamplesDebug = 0;
-   for(size_t iClassDebug = 0; iClassDebug < cClasses; ++iClassDebug) {
-      cTrainingSamplesDebug += aTargetClasses[iClassDebug].m_cTrainingSamples;
-      cSamplesDebug += aTargetClasses[iClassDebug].m_cSamples;
+   if(UNLIKELY(IsConvertError<size_t>(countTrainingSamples))) {
+      LOG_0(Trace_Error, "ERROR SampleStratifiedBags IsConvertError<size_t>(countTrainingSamples)");
+      return Error_IllegalParamVal;
    }
-   EBM_ASSERT(cTrainingSamplesDebug == cTrainingSamples);
-   EBM_ASSERT(cSamplesDebug == cSamples);
-#endif
+   const size_t cTrainingSamples = static_cast<size_t>(countTrainingSamples);
 
-   const IntEbm * pTarget = targets;
-   BagEbm * pSampleReplicationOut = bagOut;
+   if(UNLIKELY(IsConvertError<size_t>(countValidationSamples))) {
+      LOG_0(Trace_Error, "ERROR SampleStratifiedBags IsConvertError<size_t>(countValidationSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cValidationSamples = static_cast<size_t>(countValidationSamples);
+
+   if(UNLIKELY(IsAddError(cTrainingSamples, cValidationSamples))) {
+      LOG_0(Trace_Error, "ERROR SampleStratifiedBags IsAddError(countTrainingSamples, countValidationSamples))");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cSamples = cTrainingSamples + cValidationSamples;
+   if(UNLIKELY(size_t { 0 } == cSamples || size_t { 0 } == cBags)) {
+      LOG_0(Trace_Info, "SampleStratifiedBags zero samples or zero bags");
+      return Error_None;
+   }
+
+   if(UNLIKELY(IsMultiplyError(sizeof(*targets), cSamples))) {
+      LOG_0(Trace_Error, "ERROR SampleStratifiedBags IsMultiplyError(sizeof(*targets), cSamples)");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cBagItems = nullptr != bagBitsOut ? GetCountBagBitsWords(cSamples) : cSamples;
+   const size_t cItemBytes = nullptr != bagBitsOut ? sizeof(*bagBitsOut) : sizeof(*bagsOut);
+   if(UNLIKELY(IsMultiplyError(cItemBytes, cBagItems, cBags))) {
+      LOG_0(Trace_Error, "ERROR SampleStratifiedBags IsMultiplyError(cItemBytes, cBagItems, cBags)");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(nullptr == targets)) {
+      LOG_0(Trace_Error, "ERROR SampleStratifiedBags nullptr == targets");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(nullptr == bagsOut && nullptr == bagBitsOut)) {
+      LOG_0(Trace_Error, "ERROR SampleStratifiedBags nullptr == bagsOut && nullptr == bagBitsOut");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(countClasses <= IntEbm { 0 })) {
+      // countClasses cannot be zero since 1 <= cSamples
+      LOG_0(Trace_Error, "ERROR SampleStratifiedBags countClasses <= IntEbm { 0 }");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countClasses)) {
+      LOG_0(Trace_Error, "ERROR SampleStratifiedBags IsConvertError<size_t>(countClasses)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cClasses = static_cast<size_t>(countClasses);
+   EBM_ASSERT(1 <= cClasses);
+
+   if(UNLIKELY(cTrainingSamples < cClasses)) {
+      LOG_0(Trace_Warning, "WARNING SampleStratifiedBags cTrainingSamples < cClasses");
+   }
+   if(UNLIKELY(cValidationSamples < cClasses)) {
+      LOG_0(Trace_Warning, "WARNING SampleStratifiedBags cValidationSamples < cClasses");
+   }
+
+   size_t cThreads;
+   if(countThreads <= IntEbm { 0 }) {
+      // hardware_concurrency is allowed to return 0 if the value is not computable
+      cThreads = EbmMax(static_cast<size_t>(std::thread::hardware_concurrency()), size_t { 1 });
+   } else {
+      cThreads = IsConvertError<size_t>(countThreads) ? cBags : static_cast<size_t>(countThreads);
+   }
+   cThreads = EbmMin(cThreads, cBags);
+
+   // one set of class counts that every bag starts from, followed by the scratch space of each thread
+   const size_t cClassSets = cThreads + size_t { 1 };
+   if(UNLIKELY(IsMultiplyError(sizeof(TargetClass), cClasses, cClassSets))) {
+      LOG_0(Trace_Warning, "WARNING SampleStratifiedBags IsMultiplyError(sizeof(TargetClass), cClasses, cClassSets)");
+      return Error_OutOfMemory;
+   }
+   if(UNLIKELY(IsMultiplyError(sizeof(TargetClass *), cClasses, cThreads))) {
+      LOG_0(Trace_Warning, "WARNING SampleStratifiedBags IsMultiplyError(sizeof(TargetClass *), cClasses, cThreads)");
+      return Error_OutOfMemory;
+   }
+
+   uint64_t seedBase = 0;
+   if(nullptr == rngs) {
+      // SampleStratifiedBags is not called when building a differentially private model, so
+      // we can use low-quality non-determinism.  Each bag then gets its own stream branched off of this seed
+      try {
+         RandomNondeterministic<uint64_t> randomGenerator;
+         seedBase = randomGenerator.Next(std::numeric_limits<uint64_t>::max());
+      } catch(const std::bad_alloc &) {
+         LOG_0(Trace_Warning, "WARNING SampleStratifiedBags Out of memory in std::random_device");
+         return Error_OutOfMemory;
+      } catch(...) {
+         LOG_0(Trace_Warning, "WARNING SampleStratifiedBags Unknown error in std::random_device");
+         return Error_UnexpectedInternal;
+      }
+   }
+
+   TargetClass * const aTargetClassesInit =
+      static_cast<TargetClass *>(malloc(sizeof(TargetClass) * cClasses * cClassSets));
+   if(UNLIKELY(nullptr == aTargetClassesInit)) {
+      LOG_0(Trace_Warning, "WARNING SampleStratifiedBags out of memory on aTargetClassesInit");
+      return Error_OutOfMemory;
+   }
+   // the C++ says memset legal to use for setting classes with unsigned integer types
+   memset(aTargetClassesInit, 0, sizeof(TargetClass) * cClasses);
+
+   // determine number of samples per class in the target
+   const IntEbm * pTargetInit = targets;
+   const IntEbm * const pTargetsEnd = &targets[cSamples];
    do {
-      const IntEbm indexClass = *pTarget;
-      EBM_ASSERT(0 <= indexClass);
-      EBM_ASSERT(indexClass < countClasses);
+      const IntEbm indexClass = *pTargetInit;
+      if(indexClass < 0) {
+         LOG_0(Trace_Error, "ERROR SampleStratifiedBags indexClass < 0");
+         free(aTargetClassesInit);
+         return Error_IllegalParamVal;
+      }
+      if(UNLIKELY(countClasses <= indexClass)) {
+         LOG_0(Trace_Error, "ERROR SampleStratifiedBags countClasses <= indexClass");
+         free(aTargetClassesInit);
+         return Error_IllegalParamVal;
+      }
+      const size_t iClass = static_cast<size_t>(indexClass);
+      ++aTargetClassesInit[iClass].m_cSamples;
+      ++pTargetInit;
+   } while(pTargetsEnd != pTargetInit);
 
-      TargetClass * const pTargetClass = &aTargetClasses[static_cast<size_t>(indexClass)];
-      EBM_ASSERT(1 <= pTargetClass->m_cSamples);
-      const size_t iRandom = cpuRng.NextFast(pTargetClass->m_cSamples);
-      const bool bTrainingSample = UNPREDICTABLE(iRandom < pTargetClass->m_cTrainingSamples);
+   TargetClass ** const aapMostImprovedClasses =
+      static_cast<TargetClass **>(malloc(sizeof(TargetClass *) * cClasses * cThreads));
+   if(UNLIKELY(nullptr == aapMostImprovedClasses)) {
+      LOG_0(Trace_Warning, "WARNING SampleStratifiedBags out of memory on aapMostImprovedClasses");
+      free(aTargetClassesInit);
+      return Error_OutOfMemory;
+   }
 
-      *pSampleReplicationOut = UNPREDICTABLE(bTrainingSample) ? BagEbm { 1 } : BagEbm { -1 };
-      const size_t cSubtract = UNPREDICTABLE(bTrainingSample) ? size_t { 1 } : size_t { 0 };
-      pTargetClass->m_cTrainingSamples -= cSubtract;
-      --pTargetClass->m_cSamples;
+   StratifiedBagsWorker * const aWorkers =
+      static_cast<StratifiedBagsWorker *>(malloc(sizeof(StratifiedBagsWorker) * cThreads));
+   if(UNLIKELY(nullptr == aWorkers)) {
+      LOG_0(Trace_Warning, "WARNING SampleStratifiedBags nullptr == aWorkers");
+      free(aapMostImprovedClasses);
+      free(aTargetClassesInit);
+      return Error_OutOfMemory;
+   }
 
-      ++pSampleReplicationOut;
-      ++pTarget;
-   } while(pTargetsEnd != pTarget);
+   StratifiedBagsJob job;
+   job.m_aRngs = reinterpret_cast<RandomDeterministic *>(rngs);
+   job.m_seedBase = seedBase;
+   job.m_cBags = cBags;
+   job.m_cThreads = cThreads;
+   job.m_cClasses = cClasses;
+   job.m_cTrainingSamples = cTrainingSamples;
+   job.m_cSamples = cSamples;
+   job.m_aTargets = targets;
+   job.m_aTargetClassesInit = aTargetClassesInit;
+   job.m_aBags = bagsOut;
+   job.m_aBagBits = bagBitsOut;
+
+   size_t iWorker = 0;
+   do {
+      aWorkers[iWorker].m_iFirst = iWorker;
+      aWorkers[iWorker].m_aTargetClasses = aTargetClassesInit + cClasses * (iWorker + size_t { 1 });
+      aWorkers[iWorker].m_apMostImprovedClasses = aapMostImprovedClasses + cClasses * iWorker;
+      ++iWorker;
+   } while(cThreads != iWorker);
+
+   ErrorEbm error = Error_None;
+   if(size_t { 1 } == cThreads) {
+      SampleStratifiedBagsWorker(&job, &aWorkers[0]);
+   } else {
+      // worker 0 is the calling thread. The bags are independent, so the others only share the read-only job
+      std::thread * const aThreads = static_cast<std::thread *>(malloc(sizeof(std::thread) * cThreads));
+      if(nullptr == aThreads) {
+         LOG_0(Trace_Warning, "WARNING SampleStratifiedBags nullptr == aThreads");
+         free(aWorkers);
+         free(aapMostImprovedClasses);
+         free(aTargetClassesInit);
+         return Error_OutOfMemory;
+      }
 
-   if(nullptr != rng) {
-      RandomDeterministic * pRng = reinterpret_cast<RandomDeterministic *>(rng);
-      pRng->Initialize(cpuRng); // move the RNG from memory into CPU registers
+      size_t cThreadsStarted = 1;
+      do {
+         try {
+            new(&aThreads[cThreadsStarted]) std::thread(SampleStratifiedBagsWorker, &job, &aWorkers[cThreadsStarted]);
+         } catch(const std::bad_alloc &) {
+            LOG_0(Trace_Warning, "WARNING SampleStratifiedBags thread start out of memory");
+            error = Error_OutOfMemory;
+            break;
+         } catch(...) {
+            // the C++ standard doesn't really seem to say what kind of exceptions we'd get for various errors, so
+            // about the best we can do is catch(...) since the exact exceptions seem to be implementation specific
+            LOG_0(Trace_Warning, "WARNING SampleStratifiedBags thread start failed");
+            error = Error_ThreadStartFailed;
+            break;
+         }
+         ++cThreadsStarted;
+      } while(cThreads != cThreadsStarted);
+
+      if(Error_None == error) {
+         SampleStratifiedBagsWorker(&job, &aWorkers[0]);
+      }
+
+      for(size_t iThread = 1; iThread < cThreadsStarted; ++iThread) {
+         std::thread * const pThread = &aThreads[iThread];
+         pThread->join();
+         pThread->~thread();
+      }
+
+      free(aThreads);
    }
 
-#ifndef NDEBUG
-   for(size_t iClassDebug = 0; iClassDebug < cClasses; ++iClassDebug) {
-      EBM_ASSERT(0 == aTargetClasses[iClassDebug].m_cTrainingSamples);
-      EBM_ASSERT(0 == aTargetClasses[iClassDebug].m_cSamples);
+   free(aWorkers);
+   free(aapMostImprovedClasses);
+   free(aTargetClassesInit);
+
+   return error;
+}
+
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratifiedBags(
+   void * rngs,
+   IntEbm countBags,
+   IntEbm countClasses,
+   IntEbm countTrainingSamples,
+   IntEbm countValidationSamples,
+   const IntEbm * targets,
+   IntEbm countThreads,
+   BagEbm * bagsOut
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered SampleWithoutReplacementStratifiedBags: "
+      "rngs=%p, "
+      "countBags=%" IntEbmPrintf ", "
+      "countClasses=%" IntEbmPrintf ", "
+      "countTrainingSamples=%" IntEbmPrintf ", "
+      "countValidationSamples=%" IntEbmPrintf ", "
+      "targets=%p, "
+      "countThreads=%" IntEbmPrintf ", "
+      "bagsOut=%p"
+      ,
+      rngs,
+      countBags,
+      countClasses,
+      countTrainingSamples,
+      countValidationSamples,
+      static_cast<const void *>(targets),
+      countThreads,
+      static_cast<void *>(bagsOut)
+   );
+
+   if(UNLIKELY(nullptr == bagsOut)) {
+      LOG_0(Trace_Error, "ERROR SampleWithoutReplacementStratifiedBags nullptr == bagsOut");
+      return Error_IllegalParamVal;
    }
-#endif
 
-   free(aTargetClasses);
-   free(apMostImprovedClasses);
+   const ErrorEbm error = SampleStratifiedBags(
+      rngs,
+      countBags,
+      countClasses,
+      countTrainingSamples,
+      countValidationSamples,
+      targets,
+      countThreads,
+      bagsOut,
+      nullptr
+   );
+   if(Error_None != error) {
+      return error;
+   }
 
-   LOG_0(Trace_Info, "Exited SampleWithoutReplacementStratified");
+   LOG_0(Trace_Info, "Exited SampleWithoutReplacementStratifiedBags");
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratifiedBagBits(
+   void * rngs,
+   IntEbm countBags,
+   IntEbm countClasses,
+   IntEbm countTrainingSamples,
+   IntEbm countValidationSamples,
+   const IntEbm * targets,
+   IntEbm countThreads,
+   uint64_t * bagBitsOut
+) {
+   LOG_N(
+      Trace_Info,
+      "Entered SampleWithoutReplacementStratifiedBagBits: "
+      "rngs=%p, "
+      "countBags=%" IntEbmPrintf ", "
+      "countClasses=%" IntEbmPrintf ", "
+      "countTrainingSamples=%" IntEbmPrintf ", "
+      "countValidationSamples=%" IntEbmPrintf ", "
+      "targets=%p, "
+      "countThreads=%" IntEbmPrintf ", "
+      "bagBitsOut=%p"
+      ,
+      rngs,
+      countBags,
+      countClasses,
+      countTrainingSamples,
+      countValidationSamples,
+      static_cast<const void *>(targets),
+      countThreads,
+      static_cast<void *>(bagBitsOut)
+   );
+
+   if(UNLIKELY(nullptr == bagBitsOut)) {
+      LOG_0(Trace_Error, "ERROR SampleWithoutReplacementStratifiedBagBits nullptr == bagBitsOut");
+      return Error_IllegalParamVal;
+   }
+
+   const ErrorEbm error = SampleStratifiedBags(
+      rngs,
+      countBags,
+      countClasses,
+      countTrainingSamples,
+      countValidationSamples,
+      targets,
+      countThreads,
+      nullptr,
+      bagBitsOut
+   );
+   if(Error_None != error) {
+      return error;
+   }
+
+   LOG_0(Trace_Info, "Exited SampleWithoutReplacementStratifiedBagBits");
 
    return Error_None;
 }
@@ -480,4 +975,36 @@ extern ErrorEbm Unbag(
    return Error_None;
 }
 
+extern ErrorEbm Unbag(
+   const size_t cSamples,
+   const OuterBag & bag,
+   size_t * const pcTrainingSamplesOut,
+   size_t * const pcValidationSamplesOut
+) {
+   EBM_ASSERT(nullptr != pcTrainingSamplesOut);
+   EBM_ASSERT(nullptr != pcValidationSamplesOut);
+
+   if(nullptr == bag.m_aBits) {
+      return Unbag(cSamples, bag.m_aReplications, pcTrainingSamplesOut, pcValidationSamplesOut);
+   }
+
+   // every sample is in either the training or validation set, so we only need to count the set bits
+   size_t cTrainingSamples = 0;
+   const size_t cWords = GetCountBagBitsWords(cSamples);
+   for(size_t iWord = 0; iWord < cWords; ++iWord) {
+      cTrainingSamples += CountBitsSet(bag.m_aBits[iWord]);
+   }
+   const size_t cPaddingBits = cWords * k_cBagBitsPerWord - cSamples;
+   if(size_t { 0 } != cPaddingBits) {
+      const uint64_t bitsLast = bag.m_aBits[cWords - size_t { 1 }];
+      if(uint64_t { 0 } != bitsLast >> (k_cBagBitsPerWord - cPaddingBits)) {
+         LOG_0(Trace_Error, "ERROR Unbag the padding bits of the last bag bits word must be zero");
+         return Error_IllegalParamVal;
+      }
+   }
+   *pcTrainingSamplesOut = cTrainingSamples;
+   *pcValidationSamplesOut = cSamples - cTrainingSamples;
+   return Error_None;
+}
+
 } // DEFINED_ZONE_NAME
@@ -1448,3 +1448,163 @@ TEST_CASE("CutQuantile, chunky randomized check") {
    }
 }
 
+
+TEST_CASE("CutQuantileWeighted, uniform weights match CutQuantile") {
+   std::vector<double> featureVals;
+   for(size_t iSample = 0; iSample < 200; ++iSample) {
+      featureVals.push_back(static_cast<double>((iSample * 37) % 101) * 0.25);
+   }
+   const std::vector<double> weights(featureVals.size(), 2.5);
+
+   for(const BoolEbm isRounded : { EBM_FALSE, EBM_TRUE }) {
+      std::vector<double> cuts(20);
+      IntEbm countCuts = static_cast<IntEbm>(cuts.size());
+      ErrorEbm error = CutQuantile(featureVals.size(), &featureVals[0], 3, isRounded, &countCuts, &cuts[0]);
+      CHECK(Error_None == error);
+
+      std::vector<double> cutsWeighted(20);
+      IntEbm countCutsWeighted = static_cast<IntEbm>(cutsWeighted.size());
+      error = CutQuantileWeighted(
+         featureVals.size(), &featureVals[0], &weights[0], 3, isRounded, &countCutsWeighted, &cutsWeighted[0]);
+      CHECK(Error_None == error);
+
+      CHECK(countCuts == countCutsWeighted);
+      CHECK(cuts == cutsWeighted);
+
+      countCutsWeighted = static_cast<IntEbm>(cutsWeighted.size());
+      error = CutQuantileWeighted(
+         featureVals.size(), &featureVals[0], nullptr, 3, isRounded, &countCutsWeighted, &cutsWeighted[0]);
+      CHECK(Error_None == error);
+      CHECK(countCuts == countCutsWeighted);
+      CHECK(cuts == cutsWeighted);
+   }
+}
+
+TEST_CASE("CutQuantileWeighted, cuts on the weighted quartiles") {
+   // a downsampled dataset where the values 0 to 9 were kept at 1 in 7
+   std::vector<double> featureVals;
+   std::vector<double> weights;
+   for(size_t iVal = 0; iVal < 40; ++iVal) {
+      featureVals.push_back(static_cast<double>(iVal));
+      weights.push_back(iVal < 10 ? 7.0 : 1.0);
+   }
+
+   IntEbm countCuts = 3;
+   std::vector<double> cuts(3);
+   ErrorEbm error = CutQuantileWeighted(featureVals.size(), &featureVals[0], &weights[0], 1, EBM_FALSE, &countCuts, &cuts[0]);
+   CHECK(Error_None == error);
+   CHECK(3 == countCuts);
+   // 100 units of weight with 70 of them in the values 0 to 9, so the cuts go near 25, 50, and 75
+   CHECK(3.5 == cuts[0]);
+   CHECK(6.5 == cuts[1]);
+   CHECK(13.5 == cuts[2]);
+}
+
+TEST_CASE("CutQuantileWeighted, heavy value and minSamplesBin") {
+   // the value 5 holds most of the weight, so the cuts that it jumps over are spread over the rest of the values
+   const std::vector<double> featureVals { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, std::numeric_limits<double>::quiet_NaN() };
+   const std::vector<double> weights { 1, 1, 1, 1, 100, 1, 1, 1, 1, 1, 1000 };
+
+   IntEbm countCuts = 4;
+   std::vector<double> cuts(4);
+   ErrorEbm error = CutQuantileWeighted(featureVals.size(), &featureVals[0], &weights[0], 1, EBM_FALSE, &countCuts, &cuts[0]);
+   CHECK(Error_None == error);
+   CHECK(4 == countCuts);
+   CHECK(4.5 == cuts[0]);
+   CHECK(5.5 == cuts[1]);
+   CHECK(7.5 == cuts[2]);
+   CHECK(8.5 == cuts[3]);
+
+   // every bin needs 3 samples, so the heavy value shares its bin with the two values after it
+   countCuts = 4;
+   error = CutQuantileWeighted(featureVals.size(), &featureVals[0], &weights[0], 3, EBM_FALSE, &countCuts, &cuts[0]);
+   CHECK(Error_None == error);
+   CHECK(2 == countCuts);
+   CHECK(4.5 == cuts[0]);
+   CHECK(7.5 == cuts[1]);
+
+   const std::vector<double> weightsIllegal { 1, 1, 1, 1, -1, 1, 1, 1, 1, 1, 1 };
+   countCuts = 4;
+   error = CutQuantileWeighted(featureVals.size(), &featureVals[0], &weightsIllegal[0], 1, EBM_FALSE, &countCuts, &cuts[0]);
+   CHECK(Error_IllegalParamVal == error);
+   CHECK(0 == countCuts);
+}
+
+TEST_CASE("CutQuantileSketch, chunks match CutQuantileWeighted") {
+   std::vector<double> featureVals;
+   std::vector<double> weights;
+   for(size_t iSample = 0; iSample < 1000; ++iSample) {
+      featureVals.push_back(0 == iSample % 97 ? std::numeric_limits<double>::quiet_NaN() :
+         static_cast<double>((iSample * 37) % 101) * 0.25);
+      weights.push_back(static_cast<double>(1 + iSample % 7));
+   }
+
+   for(const BoolEbm isRounded : { EBM_FALSE, EBM_TRUE }) {
+      std::vector<double> cuts(20);
+      IntEbm countCuts = static_cast<IntEbm>(cuts.size());
+      ErrorEbm error = CutQuantileWeighted(
+         featureVals.size(), &featureVals[0], &weights[0], 3, isRounded, &countCuts, &cuts[0]);
+      CHECK(Error_None == error);
+      CHECK(20 == countCuts);
+
+      // the 101 distinct values fit into the sketch, so nothing is merged
+      QuantileSketchHandle quantileSketchHandle = nullptr;
+      error = CreateQuantileSketch(128, &quantileSketchHandle);
+      CHECK(Error_None == error);
+      for(size_t iChunk = 0; iChunk < featureVals.size(); iChunk += 77) {
+         const size_t cChunk = std::min(size_t { 77 }, featureVals.size() - iChunk);
+         error = QuantileSketchAddSamples(quantileSketchHandle, cChunk, &featureVals[iChunk], &weights[iChunk]);
+         CHECK(Error_None == error);
+      }
+      std::vector<double> cutsSketch(20);
+      IntEbm countCutsSketch = static_cast<IntEbm>(cutsSketch.size());
+      error = CutQuantileSketch(quantileSketchHandle, 3, isRounded, &countCutsSketch, &cutsSketch[0]);
+      CHECK(Error_None == error);
+      FreeQuantileSketch(quantileSketchHandle);
+
+      CHECK(countCuts == countCutsSketch);
+      CHECK(cuts == cutsSketch);
+   }
+}
+
+TEST_CASE("CutQuantileSketch, merged entries stay near the weighted quantiles") {
+   static constexpr size_t k_cSamples = 100000;
+   static constexpr size_t k_cCuts = 15;
+   std::vector<double> featureVals;
+   std::vector<double> weights;
+   for(size_t iSample = 0; iSample < k_cSamples; ++iSample) {
+      featureVals.push_back(static_cast<double>(iSample * 7919 % 100003));
+      // the low values are downsampled, so they carry more weight
+      weights.push_back(featureVals.back() < 20000.0 ? 5.0 : 1.0);
+   }
+
+   QuantileSketchHandle quantileSketchHandle = nullptr;
+   ErrorEbm error = CreateQuantileSketch(256, &quantileSketchHandle);
+   CHECK(Error_None == error);
+   for(size_t iChunk = 0; iChunk < k_cSamples; iChunk += 1000) {
+      error = QuantileSketchAddSamples(quantileSketchHandle, 1000, &featureVals[iChunk], &weights[iChunk]);
+      CHECK(Error_None == error);
+   }
+   std::vector<double> cuts(k_cCuts);
+   IntEbm countCuts = static_cast<IntEbm>(cuts.size());
+   error = CutQuantileSketch(quantileSketchHandle, 1, EBM_FALSE, &countCuts, &cuts[0]);
+   CHECK(Error_None == error);
+   FreeQuantileSketch(quantileSketchHandle);
+   CHECK(static_cast<IntEbm>(k_cCuts) == countCuts);
+
+   double weightTotal = 0.0;
+   for(const double weight : weights) {
+      weightTotal += weight;
+   }
+   for(size_t iCut = 0; iCut < k_cCuts; ++iCut) {
+      double weightBelow = 0.0;
+      for(size_t iSample = 0; iSample < k_cSamples; ++iSample) {
+         if(featureVals[iSample] < cuts[iCut]) {
+            weightBelow += weights[iSample];
+         }
+      }
+      // the entries hold about 2/256 of the weight each, and a cut can be off by the entries next to it
+      const double quantile = static_cast<double>(iCut + 1) / static_cast<double>(k_cCuts + 1);
+      CHECK(std::abs(weightBelow / weightTotal - quantile) < 0.02);
+   }
+}
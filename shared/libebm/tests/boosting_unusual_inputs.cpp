@@ -4,6 +4,12 @@
 
 #include "pch_test.hpp"
 
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h> // sched_getaffinity, sched_setaffinity
+#endif // __linux__
+
 #include "libebm.h"
 #include "libebm_test.hpp"
 
@@ -1913,3 +1919,1219 @@ TEST_CASE("tweedie, boosting") {
    termScore = test.GetCurrentTermScore(0, {0}, 0);
    CHECK_APPROX(termScore, 2.3025076860047466);
 }
+
+TEST_CASE("tweedie, boosting, all variance powers converge to the target") {
+   // 1, 1.5, 2, and 3 use the compile time specializations and the others use the general form. Above 2 and below 1
+   // the hessian is the expected hessian since the deviance is not convex in the score there
+   for(const char * const sObjective : {
+      "tweedie_deviance:variance_power=-1",
+      "tweedie_deviance:variance_power=0",
+      "tweedie_deviance:variance_power=1",
+      "tweedie_deviance:variance_power=1.5",
+      "tweedie_deviance:variance_power=2",
+      "tweedie_deviance:variance_power=2.5",
+      "tweedie_deviance:variance_power=3",
+      "tweedie_deviance:variance_power=4"
+   }) {
+      TestBoost test = TestBoost(
+         Task_Regression,
+         { FeatureTest(2, true, false) },
+         { { 0 } },
+         { TestSample({ 0 }, 10) },
+         { TestSample({ 0 }, 12) },
+         k_countInnerBagsDefault,
+         k_testCreateBoosterFlags_Default,
+         k_testAccelerationFlags_Default,
+         sObjective
+      );
+
+      for(int iEpoch = 0; iEpoch < 1000; ++iEpoch) {
+         test.Boost(0);
+      }
+      CHECK_APPROX_TOLERANCE(test.GetCurrentTermScore(0, { 0 }, 0), std::log(10.0), 1e-3);
+   }
+}
+
+TEST_CASE("tweedie, boosting, variance powers 1 and 2 match poisson and gamma") {
+   const std::vector<TestSample> train = {
+      TestSample({ 0 }, 3.0),
+      TestSample({ 1 }, 0.5),
+      TestSample({ 2 }, 7.0),
+      TestSample({ 1 }, 1.25),
+   };
+   const std::vector<TestSample> validation = { TestSample({ 2 }, 6.0) };
+
+   const std::vector<std::pair<const char *, const char *>> pairs = {
+      { "tweedie_deviance:variance_power=1", "poisson_deviance" },
+      { "tweedie_deviance:variance_power=2", "gamma_deviance" },
+   };
+   for(const std::pair<const char *, const char *> & pair : pairs) {
+      TestBoost tweedie = TestBoost(Task_Regression, { FeatureTest(3) }, { { 0 } }, train, validation,
+         k_countInnerBagsDefault, k_testCreateBoosterFlags_Default, k_testAccelerationFlags_Default, pair.first);
+      TestBoost other = TestBoost(Task_Regression, { FeatureTest(3) }, { { 0 } }, train, validation,
+         k_countInnerBagsDefault, k_testCreateBoosterFlags_Default, k_testAccelerationFlags_Default, pair.second);
+
+      for(int iEpoch = 0; iEpoch < 50; ++iEpoch) {
+         tweedie.Boost(0);
+         other.Boost(0);
+      }
+      for(size_t iBin = 0; iBin < 3; ++iBin) {
+         CHECK_APPROX(tweedie.GetCurrentTermScore(0, { iBin }, 0), other.GetCurrentTermScore(0, { iBin }, 0));
+      }
+   }
+}
+
+TEST_CASE("tweedie, variance power between 0 and 1") {
+   ErrorEbm error = Error_None;
+   try {
+      TestBoost test = TestBoost(Task_Regression, { FeatureTest(2) }, { { 0 } }, { TestSample({ 0 }, 10) }, {},
+         k_countInnerBagsDefault, k_testCreateBoosterFlags_Default, k_testAccelerationFlags_Default,
+         "tweedie_deviance:variance_power=0.5");
+   } catch(const TestException & except) {
+      error = except.GetError();
+   }
+   CHECK(Error_ObjectiveParamValOutOfRange == error);
+}
+
+TEST_CASE("quantized gradients, boosting, matches float gradients") {
+   // quantizing to int16 introduces a relative error of roughly 1/32767 per gradient, so after boosting the
+   // term scores should be close to, but not necessarily identical to, the ones from the float gradients
+   const std::vector<TestSample> train = {
+      TestSample({ 0, 0 }, 0, 1.5),
+      TestSample({ 0, 1 }, 1, 2.25),
+      TestSample({ 1, 0 }, 2, 0.75),
+      TestSample({ 1, 1 }, 1, 3.0),
+      TestSample({ 2, 1 }, 0, 1.0),
+      TestSample({ 2, 0 }, 2, 0.5),
+      TestSample({ 1, 1 }, 2, 1.25),
+   };
+   const std::vector<TestSample> validation = {
+      TestSample({ 0, 1 }, 1),
+      TestSample({ 2, 0 }, 2),
+   };
+
+   for(const IntEbm cInnerBags : { IntEbm { 0 }, IntEbm { 3 } }) {
+      TestBoost test1 = TestBoost(
+         3,
+         { FeatureTest(3), FeatureTest(2) },
+         { { 0 }, { 1 }, { 0, 1 } },
+         train,
+         validation,
+         cInnerBags
+      );
+      TestBoost test2 = TestBoost(
+         3,
+         { FeatureTest(3), FeatureTest(2) },
+         { { 0 }, { 1 }, { 0, 1 } },
+         train,
+         validation,
+         cInnerBags,
+         k_testCreateBoosterFlags_Default | CreateBoosterFlags_QuantizeGradients16
+      );
+
+      double validationMetric1 = 0.0;
+      double validationMetric2 = 0.0;
+      for(int iEpoch = 0; iEpoch < 2; ++iEpoch) {
+         for(size_t iTerm = 0; iTerm < test1.GetCountTerms(); ++iTerm) {
+            validationMetric1 = test1.Boost(iTerm).validationMetric;
+            validationMetric2 = test2.Boost(iTerm).validationMetric;
+         }
+      }
+      CHECK_APPROX_TOLERANCE(validationMetric1, validationMetric2, 1e-3);
+
+      if(IntEbm { 0 } != cInnerBags) {
+         // some of the bags have two cuts with nearly the same gain, and the rounding noise can pick either one,
+         // so the individual term scores are only comparable when the cuts are decided by the whole dataset
+         continue;
+      }
+      for(size_t iScore = 0; iScore < 3; ++iScore) {
+         CHECK_APPROX_TOLERANCE(
+            test1.GetCurrentTermScore(2, { 1, 1 }, iScore), 
+            test2.GetCurrentTermScore(2, { 1, 1 }, iScore), 
+            1e-3
+         );
+      }
+   }
+}
+
+TEST_CASE("quantized gradients int8, boosting, regression") {
+   TestBoost test = TestBoost(
+      Task_Regression,
+      { FeatureTest(2) },
+      { { 0 } },
+      {
+         TestSample({ 0 }, 10.0),
+         TestSample({ 1 }, 20.0),
+      },
+      {
+         TestSample({ 0 }, 10.0),
+         TestSample({ 1 }, 20.0),
+      },
+      k_countInnerBagsDefault,
+      k_testCreateBoosterFlags_Default | CreateBoosterFlags_QuantizeGradients8
+   );
+
+   double validationMetric = 0.0;
+   for(int iEpoch = 0; iEpoch < 1000; ++iEpoch) {
+      validationMetric = test.Boost(0).validationMetric;
+   }
+   // the stochastic rounding is unbiased, so even with 8 bits we converge onto the targets
+   CHECK(validationMetric < 0.01);
+   CHECK_APPROX_TOLERANCE(test.GetCurrentTermScore(0, { 0 }, 0), 10.0, 1e-2);
+   CHECK_APPROX_TOLERANCE(test.GetCurrentTermScore(0, { 1 }, 0), 20.0, 1e-2);
+}
+
+TEST_CASE("quantized gradients, boosting, many chunks matches float gradients") {
+   // enough samples that ApplyUpdateQuantized writes several cache sized chunks, and a count that is not a multiple
+   // of the chunk size or of the packing of either feature. The learning rate is large enough that the gradients
+   // change scale between updates, which recalculates subsets with an exact scale
+   static constexpr size_t cSamples = 20011;
+
+   for(const TaskEbm cClasses : { Task_Regression, TaskEbm { 2 }, TaskEbm { 3 } }) {
+      std::vector<TestSample> train;
+      std::vector<TestSample> validation;
+      uint64_t state = 3;
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         state = state * uint64_t { 6364136223846793005 } + uint64_t { 1442695040888963407 };
+         const IntEbm bin0 = static_cast<IntEbm>((state >> 33) % 5);
+         const IntEbm bin1 = static_cast<IntEbm>((state >> 41) % 17);
+         const double target = Task_Regression == cClasses ? 
+            static_cast<double>(bin0 * 3 - bin1) + static_cast<double>((state >> 50) % 7) : 
+            static_cast<double>((bin0 + bin1 + static_cast<IntEbm>((state >> 55) % 2)) % cClasses);
+         const double weight = 0.5 + static_cast<double>((state >> 20) % 4);
+         train.push_back(TestSample({ bin0, bin1 }, target, weight));
+         if(0 == iSample % 7) {
+            validation.push_back(TestSample({ bin0, bin1 }, target, weight));
+         }
+      }
+
+      for(const IntEbm cInnerBags : { IntEbm { 0 }, IntEbm { 2 } }) {
+         TestBoost test1 = TestBoost(
+            cClasses,
+            { FeatureTest(5), FeatureTest(17) },
+            { { 0 }, { 1 }, { 0, 1 } },
+            train,
+            validation,
+            cInnerBags
+         );
+         TestBoost test2 = TestBoost(
+            cClasses,
+            { FeatureTest(5), FeatureTest(17) },
+            { { 0 }, { 1 }, { 0, 1 } },
+            train,
+            validation,
+            cInnerBags,
+            k_testCreateBoosterFlags_Default | CreateBoosterFlags_QuantizeGradients16
+         );
+
+         double validationMetric1 = 0.0;
+         double validationMetric2 = 0.0;
+         const size_t cTerms = test1.GetCountTerms();
+         for(int iEpoch = 0; iEpoch < 5; ++iEpoch) {
+            for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+               validationMetric1 = test1.Boost(iTerm, TermBoostFlags_Default, 0.5).validationMetric;
+               validationMetric2 = test2.Boost(iTerm, TermBoostFlags_Default, 0.5).validationMetric;
+            }
+         }
+         CHECK_APPROX_TOLERANCE(validationMetric1, validationMetric2, 1e-3);
+
+         const size_t cScores = GetCountScores(cClasses);
+         for(size_t iScore = 0; iScore < cScores; ++iScore) {
+            CHECK_APPROX_TOLERANCE(
+               test1.GetCurrentTermScore(2, { 3, 11 }, iScore), test2.GetCurrentTermScore(2, { 3, 11 }, iScore), 1e-2);
+            CHECK_APPROX_TOLERANCE(
+               test1.GetCurrentTermScore(1, { 16 }, iScore), test2.GetCurrentTermScore(1, { 16 }, iScore), 1e-2);
+         }
+      }
+   }
+}
+
+TEST_CASE("fused apply and bin sums, boosting, identical to unfused") {
+   // enough samples to split the fused ApplyUpdate and BinSums into several cache sized chunks, and a count that
+   // is not a multiple of the chunk size or of the packing of either feature
+   static constexpr size_t cSamples = 20011;
+
+   for(const TaskEbm cClasses : { Task_Regression, TaskEbm { 2 }, TaskEbm { 3 } }) {
+      std::vector<TestSample> train;
+      std::vector<TestSample> validation;
+      uint64_t state = 1;
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         state = state * uint64_t { 6364136223846793005 } + uint64_t { 1442695040888963407 };
+         const IntEbm bin0 = static_cast<IntEbm>((state >> 33) % 5);
+         const IntEbm bin1 = static_cast<IntEbm>((state >> 41) % 17);
+         const double target = Task_Regression == cClasses ? 
+            static_cast<double>(bin0 * 3 - bin1) + static_cast<double>((state >> 50) % 7) : 
+            static_cast<double>((bin0 + bin1 + static_cast<IntEbm>((state >> 55) % 2)) % cClasses);
+         const double weight = 0.5 + static_cast<double>((state >> 20) % 4);
+         train.push_back(TestSample({ bin0, bin1 }, target, weight));
+         if(0 == iSample % 7) {
+            validation.push_back(TestSample({ bin0, bin1 }, target, weight));
+         }
+      }
+
+      TestBoost test1 = TestBoost(
+         cClasses,
+         { FeatureTest(5), FeatureTest(17) },
+         { { 0 }, { 1 }, { 0, 1 } },
+         train,
+         validation
+      );
+      TestBoost test2 = TestBoost(
+         cClasses,
+         { FeatureTest(5), FeatureTest(17) },
+         { { 0 }, { 1 }, { 0, 1 } },
+         train,
+         validation
+      );
+
+      const size_t cTerms = test1.GetCountTerms();
+      for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+         for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+            const BoostRet ret1 = test1.Boost(iTerm);
+            const BoostRet ret2 = test2.Boost(
+               iTerm,
+               TermBoostFlags_Default,
+               k_learningRateDefault,
+               k_minSamplesLeafDefault,
+               k_leavesMaxDefault,
+               static_cast<IntEbm>((iTerm + 1) % cTerms)
+            );
+            CHECK(ret1.gainAvg == ret2.gainAvg);
+            CHECK(ret1.validationMetric == ret2.validationMetric);
+         }
+      }
+
+      const size_t cScores = GetCountScores(cClasses);
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         CHECK(test1.GetCurrentTermScore(2, { 3, 11 }, iScore) == test2.GetCurrentTermScore(2, { 3, 11 }, iScore));
+         CHECK(test1.GetCurrentTermScore(1, { 16 }, iScore) == test2.GetCurrentTermScore(1, { 16 }, iScore));
+      }
+   }
+}
+
+TEST_CASE("exact exp, large scores, boosting, multiclass") {
+   // scores this large overflow the exact exp unless the multiclass kernel shifts them by the max score first
+   TestBoost test = TestBoost(
+      3,
+      { FeatureTest(2) },
+      { { 0 } },
+      {
+         TestSample({ 0 }, 0, { 1000.0, 0.0, 0.0 }),
+         TestSample({ 1 }, 1, { 0.0, 1000.0, 0.0 })
+      },
+      {
+         TestSample({ 0 }, 0, { 1000.0, 0.0, 0.0 }),
+         TestSample({ 1 }, 1, { 0.0, 1000.0, 0.0 })
+      },
+      k_countInnerBagsDefault,
+      k_testCreateBoosterFlags_Default | CreateBoosterFlags_DisableApprox
+   );
+
+   for(int iEpoch = 0; iEpoch < 5; ++iEpoch) {
+      const double validationMetric = test.Boost(0).validationMetric;
+      CHECK(!std::isnan(validationMetric));
+      CHECK(validationMetric < 1e-3);
+      for(size_t iClass = 0; iClass < 3; ++iClass) {
+         CHECK(!std::isnan(test.GetCurrentTermScore(0, { 0 }, iClass)));
+         CHECK(!std::isnan(test.GetCurrentTermScore(0, { 1 }, iClass)));
+      }
+   }
+}
+
+TEST_CASE("host offload, boosting, identical for any number of threads") {
+   // enough samples that the offload queue splits each subset into several slices across its threads. The offload
+   // queue starts one thread per CPU we may run on, so test3 is created while we are restricted to a single CPU.
+   // There are more than 8 slices so that the bin sums are also reduced in more than one block
+   static constexpr size_t k_cSamples = 40009;
+
+   for(const IntEbm cClasses : { IntEbm { Task_Regression }, IntEbm { 3 } }) {
+      std::vector<TestSample> train;
+      std::vector<TestSample> validation;
+      for(size_t iSample = 0; iSample < k_cSamples; ++iSample) {
+         const IntEbm bin0 = static_cast<IntEbm>(iSample % 5);
+         const IntEbm bin1 = static_cast<IntEbm>(iSample * 7 % 3);
+         const double target = Task_Regression == cClasses ? static_cast<double>(bin0 * 2 - bin1) + 0.25 * static_cast<double>(iSample % 11) :
+            static_cast<double>((bin0 + bin1 + iSample % 2) % 3);
+         train.push_back(TestSample({ bin0, bin1 }, target));
+         if(0 == iSample % 4) {
+            validation.push_back(TestSample({ bin1, bin0 % 3 }, target));
+         }
+      }
+
+      for(const IntEbm cInnerBags : { IntEbm { 0 }, IntEbm { 3 } }) {
+         TestBoost test1 = TestBoost(
+            cClasses,
+            { FeatureTest(5), FeatureTest(3) },
+            { { 0 }, { 1 }, { 0, 1 } },
+            train,
+            validation,
+            cInnerBags
+         );
+         TestBoost test2 = TestBoost(
+            cClasses,
+            { FeatureTest(5), FeatureTest(3) },
+            { { 0 }, { 1 }, { 0, 1 } },
+            train,
+            validation,
+            cInnerBags,
+            k_testCreateBoosterFlags_Default | CreateBoosterFlags_HostOffload
+         );
+
+#if defined(__linux__)
+         cpu_set_t cpusAll;
+         CPU_ZERO(&cpusAll);
+         bool bRestricted = false;
+         if(0 == sched_getaffinity(0, sizeof(cpusAll), &cpusAll)) {
+            for(int iCpu = 0; iCpu < CPU_SETSIZE; ++iCpu) {
+               if(CPU_ISSET(iCpu, &cpusAll)) {
+                  cpu_set_t cpusOne;
+                  CPU_ZERO(&cpusOne);
+                  CPU_SET(iCpu, &cpusOne);
+                  bRestricted = 0 == sched_setaffinity(0, sizeof(cpusOne), &cpusOne);
+                  break;
+               }
+            }
+         }
+#endif // __linux__
+         TestBoost test3 = TestBoost(
+            cClasses,
+            { FeatureTest(5), FeatureTest(3) },
+            { { 0 }, { 1 }, { 0, 1 } },
+            train,
+            validation,
+            cInnerBags,
+            k_testCreateBoosterFlags_Default | CreateBoosterFlags_HostOffload
+         );
+#if defined(__linux__)
+         if(bRestricted) {
+            sched_setaffinity(0, sizeof(cpusAll), &cpusAll);
+         }
+#endif // __linux__
+
+         double validationMetric1 = 0.0;
+         double validationMetric2 = 0.0;
+         for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+            for(size_t iTerm = 0; iTerm < test1.GetCountTerms(); ++iTerm) {
+               validationMetric1 = test1.Boost(iTerm).validationMetric;
+               validationMetric2 = test2.Boost(iTerm).validationMetric;
+               const double validationMetric3 = test3.Boost(iTerm).validationMetric;
+               // the slices do not depend on the number of threads, so neither does the order of the sums
+               CHECK(validationMetric2 == validationMetric3);
+            }
+         }
+         // the slices are summed in a different order than the single threaded loop that is used without offloading
+         CHECK_APPROX(validationMetric1, validationMetric2);
+
+         const size_t cScores = Task_Regression == cClasses ? size_t { 1 } : static_cast<size_t>(cClasses);
+         for(size_t iScore = 0; iScore < cScores; ++iScore) {
+            CHECK(test2.GetCurrentTermScore(0, { 3 }, iScore) == test3.GetCurrentTermScore(0, { 3 }, iScore));
+            CHECK(test2.GetCurrentTermScore(2, { 1, 2 }, iScore) == test3.GetCurrentTermScore(2, { 1, 2 }, iScore));
+            CHECK_APPROX(test1.GetCurrentTermScore(2, { 1, 2 }, iScore), test2.GetCurrentTermScore(2, { 1, 2 }, iScore));
+         }
+      }
+   }
+}
+
+TEST_CASE("quantized gradients, host offload, identical for any number of threads") {
+   // the quantization runs in the offload slices, and each slice draws its own dither, so the model depends on the
+   // slices but not on the number of threads that run them. test3 is created while restricted to a single CPU
+   static constexpr size_t k_cSamples = 40009;
+
+   for(const IntEbm cClasses : { IntEbm { Task_Regression }, IntEbm { 3 } }) {
+      std::vector<TestSample> train;
+      std::vector<TestSample> validation;
+      for(size_t iSample = 0; iSample < k_cSamples; ++iSample) {
+         const IntEbm bin0 = static_cast<IntEbm>(iSample % 5);
+         const IntEbm bin1 = static_cast<IntEbm>(iSample * 7 % 3);
+         const double target = Task_Regression == cClasses ? static_cast<double>(bin0 * 2 - bin1) + 0.25 * static_cast<double>(iSample % 11) :
+            static_cast<double>((bin0 + bin1 + iSample % 2) % 3);
+         train.push_back(TestSample({ bin0, bin1 }, target));
+         if(0 == iSample % 4) {
+            validation.push_back(TestSample({ bin1, bin0 % 3 }, target));
+         }
+      }
+
+      for(const IntEbm cInnerBags : { IntEbm { 0 }, IntEbm { 3 } }) {
+         TestBoost test1 = TestBoost(
+            cClasses,
+            { FeatureTest(5), FeatureTest(3) },
+            { { 0 }, { 1 }, { 0, 1 } },
+            train,
+            validation,
+            cInnerBags,
+            k_testCreateBoosterFlags_Default | CreateBoosterFlags_QuantizeGradients16
+         );
+         TestBoost test2 = TestBoost(
+            cClasses,
+            { FeatureTest(5), FeatureTest(3) },
+            { { 0 }, { 1 }, { 0, 1 } },
+            train,
+            validation,
+            cInnerBags,
+            k_testCreateBoosterFlags_Default | CreateBoosterFlags_QuantizeGradients16 | CreateBoosterFlags_HostOffload
+         );
+
+#if defined(__linux__)
+         cpu_set_t cpusAll;
+         CPU_ZERO(&cpusAll);
+         bool bRestricted = false;
+         if(0 == sched_getaffinity(0, sizeof(cpusAll), &cpusAll)) {
+            for(int iCpu = 0; iCpu < CPU_SETSIZE; ++iCpu) {
+               if(CPU_ISSET(iCpu, &cpusAll)) {
+                  cpu_set_t cpusOne;
+                  CPU_ZERO(&cpusOne);
+                  CPU_SET(iCpu, &cpusOne);
+                  bRestricted = 0 == sched_setaffinity(0, sizeof(cpusOne), &cpusOne);
+                  break;
+               }
+            }
+         }
+#endif // __linux__
+         TestBoost test3 = TestBoost(
+            cClasses,
+            { FeatureTest(5), FeatureTest(3) },
+            { { 0 }, { 1 }, { 0, 1 } },
+            train,
+            validation,
+            cInnerBags,
+            k_testCreateBoosterFlags_Default | CreateBoosterFlags_QuantizeGradients16 | CreateBoosterFlags_HostOffload
+         );
+#if defined(__linux__)
+         if(bRestricted) {
+            sched_setaffinity(0, sizeof(cpusAll), &cpusAll);
+         }
+#endif // __linux__
+
+         double validationMetric1 = 0.0;
+         double validationMetric2 = 0.0;
+         for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+            for(size_t iTerm = 0; iTerm < test1.GetCountTerms(); ++iTerm) {
+               validationMetric1 = test1.Boost(iTerm).validationMetric;
+               validationMetric2 = test2.Boost(iTerm).validationMetric;
+               const double validationMetric3 = test3.Boost(iTerm).validationMetric;
+               CHECK(validationMetric2 == validationMetric3);
+            }
+         }
+         // without offloading the whole subset is one slice, so only the rounding noise differs
+         CHECK_APPROX_TOLERANCE(validationMetric1, validationMetric2, 1e-3);
+
+         const size_t cScores = Task_Regression == cClasses ? size_t { 1 } : static_cast<size_t>(cClasses);
+         for(size_t iScore = 0; iScore < cScores; ++iScore) {
+            CHECK(test2.GetCurrentTermScore(0, { 3 }, iScore) == test3.GetCurrentTermScore(0, { 3 }, iScore));
+            CHECK(test2.GetCurrentTermScore(2, { 1, 2 }, iScore) == test3.GetCurrentTermScore(2, { 1, 2 }, iScore));
+         }
+      }
+   }
+}
+
+TEST_CASE("host offload pinned threads, boosting, identical to unpinned") {
+   // pinning only changes where the workers run. Every slice keeps its worker, so the sums are added in the same order
+   static constexpr size_t k_cSamples = 20011;
+
+   std::vector<TestSample> train;
+   std::vector<TestSample> validation;
+   for(size_t iSample = 0; iSample < k_cSamples; ++iSample) {
+      const IntEbm bin0 = static_cast<IntEbm>(iSample % 5);
+      const IntEbm bin1 = static_cast<IntEbm>(iSample * 7 % 3);
+      const double target = static_cast<double>((bin0 + bin1 + iSample % 2) % 3);
+      train.push_back(TestSample({ bin0, bin1 }, target));
+      if(0 == iSample % 4) {
+         validation.push_back(TestSample({ bin1, bin0 % 3 }, target));
+      }
+   }
+
+   TestBoost test1 = TestBoost(
+      3,
+      { FeatureTest(5), FeatureTest(3) },
+      { { 0 }, { 1 }, { 0, 1 } },
+      train,
+      validation,
+      k_countInnerBagsDefault,
+      k_testCreateBoosterFlags_Default | CreateBoosterFlags_HostOffload
+   );
+   TestBoost test2 = TestBoost(
+      3,
+      { FeatureTest(5), FeatureTest(3) },
+      { { 0 }, { 1 }, { 0, 1 } },
+      train,
+      validation,
+      k_countInnerBagsDefault,
+      k_testCreateBoosterFlags_Default | CreateBoosterFlags_HostOffload | CreateBoosterFlags_PinThreads
+   );
+
+   for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+      for(size_t iTerm = 0; iTerm < test1.GetCountTerms(); ++iTerm) {
+         const double validationMetric1 = test1.Boost(iTerm).validationMetric;
+         const double validationMetric2 = test2.Boost(iTerm).validationMetric;
+         CHECK(validationMetric1 == validationMetric2);
+      }
+   }
+   for(size_t iScore = 0; iScore < 3; ++iScore) {
+      CHECK(test1.GetCurrentTermScore(2, { 1, 2 }, iScore) == test2.GetCurrentTermScore(2, { 1, 2 }, iScore));
+   }
+}
+
+TEST_CASE("feature storage, boosting, identical to term storage") {
+   // the pairs and triples are combined from the per-feature data on demand, which must produce the same packed
+   // tensor indexes as packing each term separately. Feature 2 only appears within the larger terms
+   static constexpr size_t cSamples = 3001;
+
+   for(const TaskEbm cClasses : { Task_Regression, TaskEbm { 3 } }) {
+      std::vector<TestSample> train;
+      std::vector<TestSample> validation;
+      uint64_t state = 7;
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         state = state * uint64_t { 6364136223846793005 } + uint64_t { 1442695040888963407 };
+         const IntEbm bin0 = static_cast<IntEbm>((state >> 33) % 5);
+         const IntEbm bin1 = static_cast<IntEbm>((state >> 41) % 17);
+         const IntEbm bin2 = static_cast<IntEbm>((state >> 45) % 2);
+         const IntEbm bin3 = static_cast<IntEbm>((state >> 47) % 3);
+         const double target = Task_Regression == cClasses ?
+            static_cast<double>(bin0 * 3 - bin1 + bin3) + static_cast<double>((state >> 50) % 7) :
+            static_cast<double>((bin0 + bin1 * bin3 + static_cast<IntEbm>((state >> 55) % 2)) % cClasses);
+         train.push_back(TestSample({ bin0, bin1, bin2, bin3 }, target));
+         if(0 == iSample % 5) {
+            validation.push_back(TestSample({ bin0, bin1, bin2, bin3 }, target));
+         }
+      }
+
+      for(const IntEbm cInnerBags : { IntEbm { 0 }, IntEbm { 2 } }) {
+         const std::vector<FeatureTest> features = { FeatureTest(5), FeatureTest(17), FeatureTest(2), FeatureTest(3) };
+         const std::vector<std::vector<IntEbm>> terms = { { 0 }, { 0, 1 }, { 3, 1 }, { 1, 2, 0, 3 }, { 2, 3 } };
+
+         TestBoost test1 = TestBoost(cClasses, features, terms, train, validation, cInnerBags);
+         TestBoost test2 = TestBoost(
+            cClasses,
+            features,
+            terms,
+            train,
+            validation,
+            cInnerBags,
+            k_testCreateBoosterFlags_Default | CreateBoosterFlags_FeatureStorage
+         );
+
+         const size_t cTerms = test1.GetCountTerms();
+         for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+            for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+               const BoostRet ret1 = test1.Boost(iTerm);
+               const BoostRet ret2 = test2.Boost(
+                  iTerm,
+                  TermBoostFlags_Default,
+                  k_learningRateDefault,
+                  k_minSamplesLeafDefault,
+                  k_leavesMaxDefault,
+                  static_cast<IntEbm>((iTerm + 1) % cTerms)
+               );
+               CHECK(ret1.gainAvg == ret2.gainAvg);
+               CHECK(ret1.validationMetric == ret2.validationMetric);
+            }
+         }
+
+         const size_t cScores = GetCountScores(cClasses);
+         for(size_t iScore = 0; iScore < cScores; ++iScore) {
+            CHECK(test1.GetCurrentTermScore(1, { 3, 11 }, iScore) == test2.GetCurrentTermScore(1, { 3, 11 }, iScore));
+            CHECK(test1.GetCurrentTermScore(2, { 2, 16 }, iScore) == test2.GetCurrentTermScore(2, { 2, 16 }, iScore));
+            CHECK(test1.GetCurrentTermScore(3, { 9, 0, 4, 1 }, iScore) == test2.GetCurrentTermScore(3, { 9, 0, 4, 1 }, iScore));
+            CHECK(test1.GetCurrentTermScore(4, { 0, 2 }, iScore) == test2.GetCurrentTermScore(4, { 0, 2 }, iScore));
+         }
+      }
+   }
+}
+
+TEST_CASE("collect stats, boosting, counters filled and model unchanged") {
+   std::vector<TestSample> train;
+   std::vector<TestSample> validation;
+   for(size_t iSample = 0; iSample < 301; ++iSample) {
+      const IntEbm bin0 = static_cast<IntEbm>(iSample % 7);
+      const IntEbm bin1 = static_cast<IntEbm>(iSample * 5 % 4);
+      const double target = static_cast<double>(bin0 - bin1 * 2) + 0.125 * static_cast<double>(iSample % 13);
+      train.push_back(TestSample({ bin0, bin1 }, target));
+      if(0 == iSample % 3) {
+         validation.push_back(TestSample({ bin0, bin1 }, target));
+      }
+   }
+
+   TestBoost test1 = TestBoost(Task_Regression,
+      { FeatureTest(7), FeatureTest(4) },
+      { { 0 }, { 0, 1 } },
+      train,
+      validation,
+      k_countInnerBagsDefault);
+   TestBoost test2 = TestBoost(Task_Regression,
+      { FeatureTest(7), FeatureTest(4) },
+      { { 0 }, { 0, 1 } },
+      train,
+      validation,
+      k_countInnerBagsDefault,
+      k_testCreateBoosterFlags_Default | CreateBoosterFlags_CollectStats);
+
+   static constexpr int k_cEpochs = 5;
+   for(int iEpoch = 0; iEpoch < k_cEpochs; ++iEpoch) {
+      for(size_t iTerm = 0; iTerm < test1.GetCountTerms(); ++iTerm) {
+         const BoostRet ret1 = test1.Boost(iTerm);
+         const BoostRet ret2 = test2.Boost(iTerm);
+         CHECK(ret1.gainAvg == ret2.gainAvg);
+         CHECK(ret1.validationMetric == ret2.validationMetric);
+      }
+   }
+
+   IntEbm aPhaseStats[BoosterPhase_Count * BoosterStat_Count];
+   IntEbm aTermStats[2 * TermStat_Count];
+
+   ErrorEbm error = GetBoosterStats(test1.GetBoosterHandle(), 0, nullptr, 0, nullptr);
+   CHECK(Error_IllegalParamVal == error);
+
+   error = GetBoosterStats(test2.GetBoosterHandle(), BoosterPhase_Count * BoosterStat_Count - 1, aPhaseStats, 0, nullptr);
+   CHECK(Error_IllegalParamVal == error);
+
+   error = GetBoosterStats(
+      test2.GetBoosterHandle(), BoosterPhase_Count * BoosterStat_Count, aPhaseStats, 2 * TermStat_Count, aTermStats);
+   CHECK(Error_None == error);
+
+   const IntEbm * const aBinSums = &aPhaseStats[BoosterPhase_BinSumsBoosting * BoosterStat_Count];
+   CHECK(IntEbm { 0 } < aBinSums[BoosterStat_Calls]);
+   CHECK(IntEbm { 0 } < aBinSums[BoosterStat_Bytes]);
+   CHECK(IntEbm { 0 } < aPhaseStats[BoosterPhase_PartitionOneDimensional * BoosterStat_Count + BoosterStat_Calls]);
+   CHECK(IntEbm { k_cEpochs } == aPhaseStats[BoosterPhase_TensorTotalsBuild * BoosterStat_Count + BoosterStat_Calls]);
+   CHECK(IntEbm { k_cEpochs } == aPhaseStats[BoosterPhase_PartitionTwoDimensional * BoosterStat_Count + BoosterStat_Calls]);
+   CHECK(IntEbm { 0 } < aPhaseStats[BoosterPhase_ApplyUpdate * BoosterStat_Count + BoosterStat_Calls]);
+   CHECK(IntEbm { 0 } < aPhaseStats[BoosterPhase_Metric * BoosterStat_Count + BoosterStat_Calls]);
+   CHECK(IntEbm { 0 } < aPhaseStats[BoosterPhase_BestModelCopy * BoosterStat_Count + BoosterStat_Calls]);
+   for(IntEbm iPhase = 0; iPhase < BoosterPhase_Count; ++iPhase) {
+      CHECK(IntEbm { 0 } <= aPhaseStats[iPhase * BoosterStat_Count + BoosterStat_Nanoseconds]);
+   }
+
+   for(IntEbm iTerm = 0; iTerm < 2; ++iTerm) {
+      CHECK(IntEbm { k_cEpochs } == aTermStats[iTerm * TermStat_Count + TermStat_GenerateCalls]);
+      CHECK(IntEbm { k_cEpochs } == aTermStats[iTerm * TermStat_Count + TermStat_ApplyCalls]);
+      CHECK(IntEbm { 0 } <= aTermStats[iTerm * TermStat_Count + TermStat_GenerateNanoseconds]);
+   }
+}
+
+struct ViewUpdate final {
+   ErrorEbm m_error;
+   double m_gain;
+   std::vector<double> m_update;
+};
+
+static ViewUpdate GenerateViewUpdate(BoosterHandle boosterHandle, const IntEbm indexTerm, const size_t cUpdateScores) {
+   static const IntEbm k_leavesMax[] { 3, 3 };
+
+   std::vector<unsigned char> rng(static_cast<size_t>(MeasureRNG()));
+   InitRNG(12345, &rng[0]);
+
+   ViewUpdate ret;
+   ret.m_gain = std::numeric_limits<double>::quiet_NaN();
+   ret.m_update.resize(cUpdateScores);
+   ret.m_error = GenerateTermUpdate(&rng[0], boosterHandle, indexTerm, TermBoostFlags_Default, 0.1, 1, k_leavesMax, &ret.m_gain);
+   if(Error_None == ret.m_error) {
+      ret.m_error = GetTermUpdate(boosterHandle, &ret.m_update[0]);
+   }
+   return ret;
+}
+
+TEST_CASE("booster views, boosting, concurrent generate matches serial") {
+   std::vector<TestSample> train;
+   std::vector<TestSample> validation;
+   for(size_t iSample = 0; iSample < 503; ++iSample) {
+      const IntEbm bin0 = static_cast<IntEbm>(iSample % 7);
+      const IntEbm bin1 = static_cast<IntEbm>(iSample * 5 % 4);
+      const IntEbm bin2 = static_cast<IntEbm>(iSample * 3 % 5);
+      const double target = static_cast<double>(bin0 - bin1 * 2 + bin2 * bin0) + 0.125 * static_cast<double>(iSample % 13);
+      train.push_back(TestSample({ bin0, bin1, bin2 }, target));
+      if(0 == iSample % 3) {
+         validation.push_back(TestSample({ bin0, bin1, bin2 }, target));
+      }
+   }
+
+   const std::vector<std::vector<IntEbm>> terms { { 0 }, { 1 }, { 2 }, { 0, 2 } };
+   const std::vector<size_t> cUpdateScores { 7, 4, 5, 35 };
+   TestBoost test = TestBoost(Task_Regression,
+      { FeatureTest(7), FeatureTest(4), FeatureTest(5) },
+      terms,
+      train,
+      validation);
+
+   std::vector<BoosterHandle> views(terms.size());
+   for(BoosterHandle & view : views) {
+      const ErrorEbm error = CreateBoosterView(test.GetBoosterHandle(), &view);
+      CHECK(Error_None == error);
+   }
+
+   for(int iRound = 0; iRound < 4; ++iRound) {
+      std::vector<ViewUpdate> serial;
+      for(size_t iTerm = 0; iTerm < terms.size(); ++iTerm) {
+         serial.push_back(GenerateViewUpdate(views[iTerm], static_cast<IntEbm>(iTerm), cUpdateScores[iTerm]));
+      }
+
+      // every candidate term of the greedy round at once, each on its own view
+      std::vector<ViewUpdate> concurrent(terms.size());
+      std::vector<std::thread> threads;
+      for(size_t iTerm = 0; iTerm < terms.size(); ++iTerm) {
+         threads.emplace_back([&views, &concurrent, &cUpdateScores, iTerm]() {
+            concurrent[iTerm] = GenerateViewUpdate(views[iTerm], static_cast<IntEbm>(iTerm), cUpdateScores[iTerm]);
+         });
+      }
+      for(std::thread & thread : threads) {
+         thread.join();
+      }
+
+      size_t iTermBest = 0;
+      for(size_t iTerm = 0; iTerm < terms.size(); ++iTerm) {
+         CHECK(Error_None == serial[iTerm].m_error);
+         CHECK(Error_None == concurrent[iTerm].m_error);
+         CHECK(serial[iTerm].m_gain == concurrent[iTerm].m_gain);
+         CHECK(serial[iTerm].m_update == concurrent[iTerm].m_update);
+         if(concurrent[iTermBest].m_gain < concurrent[iTerm].m_gain) {
+            iTermBest = iTerm;
+         }
+      }
+
+      double validationMetric;
+      const ErrorEbm error = ApplyTermUpdate(views[iTermBest], &validationMetric);
+      CHECK(Error_None == error);
+   }
+
+   // a histogram that ApplyTermUpdateFused leaves in one view is stale once another view applies an update
+   ViewUpdate update = GenerateViewUpdate(views[0], 0, cUpdateScores[0]);
+   CHECK(Error_None == update.m_error);
+   double validationMetric;
+   ErrorEbm error = ApplyTermUpdateFused(views[0], 1, &validationMetric);
+   CHECK(Error_None == error);
+   update = GenerateViewUpdate(views[2], 2, cUpdateScores[2]);
+   CHECK(Error_None == update.m_error);
+   error = ApplyTermUpdate(views[2], &validationMetric);
+   CHECK(Error_None == error);
+   const ViewUpdate fused = GenerateViewUpdate(views[0], 1, cUpdateScores[1]);
+   const ViewUpdate fresh = GenerateViewUpdate(views[1], 1, cUpdateScores[1]);
+   CHECK(Error_None == fused.m_error);
+   CHECK(Error_None == fresh.m_error);
+   CHECK(fresh.m_gain == fused.m_gain);
+   CHECK(fresh.m_update == fused.m_update);
+
+   for(BoosterHandle view : views) {
+      FreeBooster(view);
+   }
+}
+
+TEST_CASE("compute term gains, boosting, thread count does not change the gains") {
+   std::vector<TestSample> train;
+   std::vector<TestSample> validation;
+   for(size_t iSample = 0; iSample < 331; ++iSample) {
+      const IntEbm bin0 = static_cast<IntEbm>(iSample % 6);
+      const IntEbm bin1 = static_cast<IntEbm>(iSample * 7 % 3);
+      const IntEbm bin2 = static_cast<IntEbm>(iSample * 3 % 5);
+      const double target = static_cast<double>(bin0 * bin1 - bin2) + 0.25 * static_cast<double>(iSample % 11);
+      train.push_back(TestSample({ bin0, bin1, bin2 }, target));
+      if(0 == iSample % 4) {
+         validation.push_back(TestSample({ bin0, bin1, bin2 }, target));
+      }
+   }
+
+   static const IntEbm k_leavesMax[] { 3, 3 };
+   const std::vector<std::vector<IntEbm>> terms { { 0 }, { 1 }, { 2 }, { 0, 1 } };
+   const std::vector<IntEbm> indexTerms { 0, 1, 2, 3, 1 };
+   const std::vector<FeatureTest> features { FeatureTest(6), FeatureTest(3), FeatureTest(5) };
+   TestBoost test1 = TestBoost(Task_Regression, features, terms, train, validation);
+   TestBoost test3 = TestBoost(Task_Regression, features, terms, train, validation);
+
+   std::vector<unsigned char> rng1(static_cast<size_t>(MeasureRNG()));
+   std::vector<unsigned char> rng3(static_cast<size_t>(MeasureRNG()));
+   InitRNG(777, &rng1[0]);
+   InitRNG(777, &rng3[0]);
+
+   for(int iRound = 0; iRound < 3; ++iRound) {
+      std::vector<double> gains1(indexTerms.size());
+      std::vector<double> gains3(indexTerms.size());
+      IntEbm indexTermBest1;
+      IntEbm indexTermBest3;
+      ErrorEbm error = ComputeTermGains(&rng1[0], test1.GetBoosterHandle(), static_cast<IntEbm>(indexTerms.size()),
+         &indexTerms[0], TermBoostFlags_Default, 0.1, 1, k_leavesMax, 1, &gains1[0], &indexTermBest1);
+      CHECK(Error_None == error);
+      error = ComputeTermGains(&rng3[0], test3.GetBoosterHandle(), static_cast<IntEbm>(indexTerms.size()),
+         &indexTerms[0], TermBoostFlags_Default, 0.1, 1, k_leavesMax, 3, &gains3[0], &indexTermBest3);
+      CHECK(Error_None == error);
+
+      CHECK(gains1 == gains3);
+      CHECK(gains1[1] == gains1[4]);
+      CHECK(indexTermBest1 == indexTermBest3);
+      size_t iBest = 0;
+      for(size_t iPosition = 1; iPosition < indexTerms.size(); ++iPosition) {
+         if(gains1[iBest] < gains1[iPosition]) {
+            iBest = iPosition;
+         }
+      }
+      CHECK(indexTerms[iBest] == indexTermBest1);
+
+      double validationMetric1;
+      double validationMetric3;
+      error = ApplyTermUpdate(test1.GetBoosterHandle(), &validationMetric1);
+      CHECK(Error_None == error);
+      error = ApplyTermUpdate(test3.GetBoosterHandle(), &validationMetric3);
+      CHECK(Error_None == error);
+      CHECK(validationMetric1 == validationMetric3);
+   }
+
+   // without asking for the best term, nothing is left to apply
+   std::vector<double> gains(indexTerms.size());
+   ErrorEbm error = ComputeTermGains(nullptr, test1.GetBoosterHandle(), static_cast<IntEbm>(indexTerms.size()),
+      &indexTerms[0], TermBoostFlags_Default, 0.1, 1, k_leavesMax, 0, &gains[0], nullptr);
+   CHECK(Error_None == error);
+   double validationMetric;
+   error = ApplyTermUpdate(test1.GetBoosterHandle(), &validationMetric);
+   CHECK(Error_IllegalParamVal == error);
+
+   const IntEbm badIndexTerms[] { 0, 4 };
+   error = ComputeTermGains(nullptr, test1.GetBoosterHandle(), 2, badIndexTerms, TermBoostFlags_Default, 0.1, 1,
+      k_leavesMax, 0, &gains[0], nullptr);
+   CHECK(Error_IllegalParamVal == error);
+}
+
+TEST_CASE("GetSampleScores, boosting, regression and classification") {
+   for(const TaskEbm cClasses : { TaskEbm { Task_Regression }, TaskEbm { Task_BinaryClassification } }) {
+      std::vector<TestSample> train;
+      std::vector<TestSample> validation;
+      for(size_t iSample = 0; iSample < 97; ++iSample) {
+         const IntEbm bin0 = static_cast<IntEbm>(iSample % 5);
+         const IntEbm bin1 = static_cast<IntEbm>(iSample * 3 % 4);
+         const double target = Task_Regression == cClasses ?
+            static_cast<double>(bin0 * 2 - bin1) + 0.5 * static_cast<double>(iSample % 3) :
+            static_cast<double>((bin0 + bin1 + static_cast<IntEbm>(iSample % 3)) % 2);
+         // samples that are excluded or replicated still need to land on their own row
+         const BagEbm replication = 0 == iSample % 7 ? BagEbm { 0 } : 0 == iSample % 5 ? BagEbm { 2 } : BagEbm { 1 };
+         train.push_back(TestSample(replication, { bin0, bin1 }, target));
+      }
+      for(size_t iSample = 0; iSample < 31; ++iSample) {
+         const IntEbm bin0 = static_cast<IntEbm>(iSample * 2 % 5);
+         const IntEbm bin1 = static_cast<IntEbm>(iSample % 4);
+         validation.push_back(TestSample({ bin0, bin1 }, static_cast<double>((bin0 + bin1) % 2)));
+      }
+
+      TestBoost test = TestBoost(cClasses, { FeatureTest(5), FeatureTest(4) }, { { 0 }, { 1 } }, train, validation);
+
+      for(int iEpoch = 0; iEpoch < 5; ++iEpoch) {
+         for(size_t iTerm = 0; iTerm < test.GetCountTerms(); ++iTerm) {
+            test.Boost(iTerm);
+         }
+      }
+
+      const std::vector<double> sampleScores = test.GetSampleScores();
+
+      size_t iRow = 0;
+      for(size_t iSample = 0; iSample < train.size() + validation.size(); ++iSample) {
+         const TestSample & sample = iSample < train.size() ? train[iSample] : validation[iSample - train.size()];
+         if(sample.m_bBag && BagEbm { 0 } == sample.m_bagCount) {
+            continue;
+         }
+         // binary classification reports the logit of class 1 relative to class 0
+         const size_t iScore = Task_BinaryClassification == cClasses ? 1 : 0;
+         const double expected =
+            test.GetCurrentTermScore(0, { static_cast<size_t>(sample.m_sampleBinIndexes[0]) }, iScore) +
+            test.GetCurrentTermScore(1, { static_cast<size_t>(sample.m_sampleBinIndexes[1]) }, iScore);
+         CHECK_APPROX(sampleScores[iRow], expected);
+         ++iRow;
+      }
+      CHECK(sampleScores.size() == iRow);
+
+      double unused;
+      const ErrorEbm error = GetSampleScores(test.GetBoosterHandle(), 0, nullptr, nullptr, &unused);
+      CHECK(Error_IllegalParamVal == error);
+   }
+}
+
+TEST_CASE("CalcSampleScores, boosting, matches the best model in double") {
+   for(const TaskEbm cClasses : { TaskEbm { Task_Regression }, TaskEbm { Task_BinaryClassification } }) {
+      std::vector<TestSample> train;
+      std::vector<TestSample> validation;
+      for(size_t iSample = 0; iSample < 97; ++iSample) {
+         const IntEbm bin0 = static_cast<IntEbm>(iSample % 5);
+         const IntEbm bin1 = static_cast<IntEbm>(iSample * 3 % 4);
+         const double target = Task_Regression == cClasses ?
+            static_cast<double>(bin0 * 2 - bin1) + 0.5 * static_cast<double>(iSample % 3) :
+            static_cast<double>((bin0 + bin1 + static_cast<IntEbm>(iSample % 3)) % 2);
+         const BagEbm replication = 0 == iSample % 7 ? BagEbm { 0 } : 0 == iSample % 5 ? BagEbm { 2 } : BagEbm { 1 };
+         train.push_back(TestSample(replication, { bin0, bin1 }, target));
+      }
+      for(size_t iSample = 0; iSample < 31; ++iSample) {
+         const IntEbm bin0 = static_cast<IntEbm>(iSample * 2 % 5);
+         const IntEbm bin1 = static_cast<IntEbm>(iSample % 4);
+         validation.push_back(TestSample({ bin0, bin1 }, static_cast<double>((bin0 + bin1) % 2)));
+      }
+
+      TestBoost test = TestBoost(cClasses, { FeatureTest(5), FeatureTest(4) }, { { 0 }, { 1 }, { 0, 1 } }, train, validation);
+
+      for(int iEpoch = 0; iEpoch < 5; ++iEpoch) {
+         for(size_t iTerm = 0; iTerm < test.GetCountTerms(); ++iTerm) {
+            test.Boost(iTerm);
+         }
+      }
+
+      const std::vector<double> sampleScores = test.CalcSampleScores();
+
+      // regression and binary classification have one score per cell, and the pair is row major
+      double main0[5];
+      double main1[4];
+      double pair[5 * 4];
+      test.GetBestTermScoresRaw(0, main0);
+      test.GetBestTermScoresRaw(1, main1);
+      test.GetBestTermScoresRaw(2, pair);
+
+      size_t iRow = 0;
+      for(size_t iSample = 0; iSample < train.size() + validation.size(); ++iSample) {
+         const TestSample & sample = iSample < train.size() ? train[iSample] : validation[iSample - train.size()];
+         if(sample.m_bBag && BagEbm { 0 } == sample.m_bagCount) {
+            continue;
+         }
+         const size_t iBin0 = static_cast<size_t>(sample.m_sampleBinIndexes[0]);
+         const size_t iBin1 = static_cast<size_t>(sample.m_sampleBinIndexes[1]);
+         // the best model is summed in double, so the result is exact up to the order of the additions
+         const double expected = main0[iBin0] + main1[iBin1] + pair[iBin0 * 4 + iBin1];
+         CHECK_APPROX_TOLERANCE(sampleScores[iRow], expected, double { 1e-12 });
+         ++iRow;
+      }
+      CHECK(sampleScores.size() == iRow);
+
+      double unused;
+      const IntEbm dimensionCount = 1;
+      const IntEbm featureIndex = 0;
+      const ErrorEbm error = CalcSampleScores(nullptr, nullptr, nullptr, 1, 1, &dimensionCount, &featureIndex, &unused, &unused);
+      CHECK(Error_IllegalParamVal == error);
+   }
+}
+
+TEST_CASE("GetSampleScores, init scores, no boosting") {
+   TestBoost test = TestBoost(Task_Regression,
+      { FeatureTest(2) },
+      { { 0 } },
+      { TestSample({ 0 }, 10.0, std::vector<double> { 1.5 }), TestSample({ 1 }, 20.0, std::vector<double> { -2.25 }) },
+      { TestSample({ 1 }, 12.0, std::vector<double> { 4.0 }) });
+
+   const std::vector<double> sampleScores = test.GetSampleScores();
+   CHECK(3 == sampleScores.size());
+   CHECK(1.5 == sampleScores[0]);
+   CHECK(-2.25 == sampleScores[1]);
+   CHECK(4.0 == sampleScores[2]);
+}
+
+TEST_CASE("AddTerms, boosting, pair added later matches pair from the start") {
+   std::vector<TestSample> train;
+   std::vector<TestSample> validation;
+   for(size_t iSample = 0; iSample < 151; ++iSample) {
+      const IntEbm bin0 = static_cast<IntEbm>(iSample % 5);
+      const IntEbm bin1 = static_cast<IntEbm>(iSample * 3 % 4);
+      const double target = static_cast<double>(bin0 * bin1) - static_cast<double>(bin0) + 0.5 * static_cast<double>(iSample % 3);
+      train.push_back(TestSample({ bin0, bin1 }, target));
+      if(0 == iSample % 3) {
+         validation.push_back(TestSample({ bin0, bin1 }, target));
+      }
+   }
+
+   const std::vector<FeatureTest> features { FeatureTest(5), FeatureTest(4) };
+   TestBoost later = TestBoost(Task_Regression, features, { { 0 }, { 1 } }, train, validation);
+   TestBoost start = TestBoost(Task_Regression, features, { { 0 }, { 1 }, { 0, 1 } }, train, validation);
+
+   for(int iEpoch = 0; iEpoch < 4; ++iEpoch) {
+      for(size_t iTerm = 0; iTerm < 2; ++iTerm) {
+         const double metricLater = later.Boost(iTerm).validationMetric;
+         const double metricStart = start.Boost(iTerm).validationMetric;
+         CHECK(metricStart == metricLater);
+      }
+   }
+
+   later.AddTerms({ { 0, 1 } });
+   CHECK(3 == later.GetCountTerms());
+
+   for(int iEpoch = 0; iEpoch < 4; ++iEpoch) {
+      const double metricLater = later.Boost(2).validationMetric;
+      const double metricStart = start.Boost(2).validationMetric;
+      CHECK(metricStart == metricLater);
+   }
+
+   for(size_t iBin0 = 0; iBin0 < 5; ++iBin0) {
+      for(size_t iBin1 = 0; iBin1 < 4; ++iBin1) {
+         CHECK(start.GetCurrentTermScore(2, { iBin0, iBin1 }, 0) == later.GetCurrentTermScore(2, { iBin0, iBin1 }, 0));
+      }
+   }
+   CHECK(start.GetSampleScores() == later.GetSampleScores());
+
+   // views would keep bins sized for the old terms
+   BoosterHandle view;
+   const ErrorEbm error = CreateBoosterView(later.GetBoosterHandle(), &view);
+   CHECK(Error_None == error);
+   ErrorEbm errorAdd = Error_None;
+   try {
+      later.AddTerms({ { 1 } });
+   } catch(const TestException & except) {
+      errorAdd = except.GetError();
+   }
+   CHECK(Error_IllegalParamVal == errorAdd);
+   CHECK(3 == later.GetCountTerms());
+   FreeBooster(view);
+}
+
+TEST_CASE("CreateBoosterFlags_BagBits, boosting, matches the same bag as BagEbm") {
+   for(const TaskEbm cClasses : { TaskEbm { Task_Regression }, TaskEbm { Task_BinaryClassification }, TaskEbm { 3 } }) {
+      // more than 64 samples in each direction so that the validation walk skips whole words of training bits
+      std::vector<TestSample> train;
+      std::vector<TestSample> validation;
+      for(size_t iSample = 0; iSample < 137; ++iSample) {
+         const IntEbm bin0 = static_cast<IntEbm>(iSample % 5);
+         const IntEbm bin1 = static_cast<IntEbm>(iSample * 3 % 4);
+         const double target = Task_Regression == cClasses ?
+            static_cast<double>(bin0 * bin1) + 0.25 * static_cast<double>(iSample % 3) :
+            static_cast<double>((bin0 + bin1 + static_cast<IntEbm>(iSample % 2)) % cClasses);
+         const double weight = 0.5 + static_cast<double>(iSample % 4);
+         train.push_back(TestSample({ bin0, bin1 }, target, weight));
+         if(0 == iSample % 2) {
+            validation.push_back(TestSample({ bin1 % 5, bin0 % 4 }, target, weight));
+         }
+      }
+
+      const std::vector<FeatureTest> features { FeatureTest(5), FeatureTest(4) };
+      TestBoost replications = TestBoost(cClasses, features, { { 0 }, { 1 } }, train, validation, 3);
+      TestBoost bits = TestBoost(cClasses, features, { { 0 }, { 1 } }, train, validation, 3, k_testCreateBoosterFlags_Default | CreateBoosterFlags_BagBits);
+
+      for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+         for(size_t iTerm = 0; iTerm < 2; ++iTerm) {
+            CHECK(replications.Boost(iTerm).validationMetric == bits.Boost(iTerm).validationMetric);
+         }
+      }
+
+      replications.AddTerms({ { 0, 1 } });
+      bits.AddTerms({ { 0, 1 } });
+      for(int iEpoch = 0; iEpoch < 2; ++iEpoch) {
+         CHECK(replications.Boost(2).validationMetric == bits.Boost(2).validationMetric);
+      }
+      CHECK(replications.GetSampleScores() == bits.GetSampleScores());
+   }
+}
+
+TEST_CASE("SetValidationMetric, auc, binary and regression") {
+   static constexpr size_t k_cBins = 64;
+   static constexpr size_t k_cTrain = 2003;
+   static constexpr size_t k_cValidation = 1009;
+
+   std::vector<TestSample> train;
+   std::vector<TestSample> validation;
+   for(size_t iSample = 0; iSample < k_cTrain + k_cValidation; ++iSample) {
+      const IntEbm bin0 = static_cast<IntEbm>(iSample * 37 % k_cBins);
+      // the noise makes neighbouring bins get similar but different scores, and leaves the auc imperfect
+      const size_t noise = iSample * 7919 % 29;
+      const double target = static_cast<double>(k_cBins / 2 + 14 <= static_cast<size_t>(bin0) + noise ? 1 : 0);
+      if(iSample < k_cTrain) {
+         train.push_back(TestSample({ bin0 }, target));
+      } else {
+         validation.push_back(TestSample({ bin0 }, target));
+      }
+   }
+
+   TestBoost test = TestBoost(Task_BinaryClassification, { FeatureTest(k_cBins) }, { { 0 } }, train, validation);
+
+   ErrorEbm error = SetValidationMetric(test.GetBoosterHandle(), "auc");
+   CHECK(Error_None == error);
+
+   double validationMetric = 0.0;
+   for(int iEpoch = 0; iEpoch < 50; ++iEpoch) {
+      validationMetric = test.Boost(0).validationMetric;
+
+      // the exact auc from sorting the validation scores, where equal scores count as ties
+      const std::vector<double> sampleScores = test.GetSampleScores();
+      CHECK(k_cTrain + k_cValidation == sampleScores.size());
+      std::vector<std::pair<double, double>> scoreTargets;
+      for(size_t iValidation = 0; iValidation < k_cValidation; ++iValidation) {
+         scoreTargets.push_back(std::make_pair(sampleScores[k_cTrain + iValidation], validation[iValidation].m_target));
+      }
+      std::sort(scoreTargets.begin(), scoreTargets.end());
+      double cNegativeBelow = 0.0;
+      double cPositive = 0.0;
+      double area = 0.0;
+      size_t iTieStart = 0;
+      while(iTieStart < scoreTargets.size()) {
+         size_t iTieEnd = iTieStart;
+         double cNegativeTie = 0.0;
+         double cPositiveTie = 0.0;
+         while(iTieEnd < scoreTargets.size() && scoreTargets[iTieStart].first == scoreTargets[iTieEnd].first) {
+            if(0.0 == scoreTargets[iTieEnd].second) {
+               ++cNegativeTie;
+            } else {
+               ++cPositiveTie;
+            }
+            ++iTieEnd;
+         }
+         area += cPositiveTie * (cNegativeBelow + 0.5 * cNegativeTie);
+         cNegativeBelow += cNegativeTie;
+         cPositive += cPositiveTie;
+         iTieStart = iTieEnd;
+      }
+      const double aucExact = area / (cPositive * cNegativeBelow);
+
+      // auc is maximized, so it comes back negated. The histogram only differs from the sorted auc for
+      // positive/negative pairs whose different scores share one of its bins, and the 64 distinct scores here are
+      // far enough apart relative to their range that they never do
+      CHECK_APPROX_TOLERANCE(-validationMetric, aucExact, 1e-9);
+   }
+   CHECK(validationMetric < -0.9);
+
+   error = SetValidationMetric(test.GetBoosterHandle(), nullptr);
+   CHECK(Error_None == error);
+   validationMetric = test.Boost(0).validationMetric;
+   CHECK(0.0 < validationMetric); // log loss again
+
+   error = SetValidationMetric(test.GetBoosterHandle(), "not_a_metric");
+   CHECK(Error_MetricUnknown == error);
+
+   TestBoost regression = TestBoost(Task_Regression, { FeatureTest(k_cBins) }, { { 0 } }, train, validation);
+   error = SetValidationMetric(regression.GetBoosterHandle(), "auc");
+   CHECK(Error_MetricMismatchWithObjective == error);
+}
+
+TEST_CASE("SetValidationMetric, auc, quantized gradients match float gradients") {
+   // the same dataset as the auc test above. Quantizing only adds rounding noise to the gradients, so the ranking of
+   // the validation samples, and with it the auc, should barely move even with 8 bits
+   static constexpr size_t k_cBins = 64;
+   static constexpr size_t k_cTrain = 2003;
+   static constexpr size_t k_cValidation = 1009;
+
+   std::vector<TestSample> train;
+   std::vector<TestSample> validation;
+   for(size_t iSample = 0; iSample < k_cTrain + k_cValidation; ++iSample) {
+      const IntEbm bin0 = static_cast<IntEbm>(iSample * 37 % k_cBins);
+      const size_t noise = iSample * 7919 % 29;
+      const double target = static_cast<double>(k_cBins / 2 + 14 <= static_cast<size_t>(bin0) + noise ? 1 : 0);
+      if(iSample < k_cTrain) {
+         train.push_back(TestSample({ bin0 }, target));
+      } else {
+         validation.push_back(TestSample({ bin0 }, target));
+      }
+   }
+
+   double aucFloat = 0.0;
+   for(const CreateBoosterFlags flags : 
+      { CreateBoosterFlags_Default, CreateBoosterFlags_QuantizeGradients16, CreateBoosterFlags_QuantizeGradients8 }) {
+
+      TestBoost test = TestBoost(
+         Task_BinaryClassification,
+         { FeatureTest(k_cBins) },
+         { { 0 } },
+         train,
+         validation,
+         k_countInnerBagsDefault,
+         k_testCreateBoosterFlags_Default | flags
+      );
+      const ErrorEbm error = SetValidationMetric(test.GetBoosterHandle(), "auc");
+      CHECK(Error_None == error);
+
+      double validationMetric = 0.0;
+      for(int iEpoch = 0; iEpoch < 50; ++iEpoch) {
+         validationMetric = test.Boost(0).validationMetric;
+      }
+      // auc is maximized, so it comes back negated
+      const double auc = -validationMetric;
+      CHECK(0.9 < auc);
+      if(CreateBoosterFlags_Default == flags) {
+         aucFloat = auc;
+      } else {
+         CHECK_APPROX_TOLERANCE(aucFloat, auc, 1e-3);
+      }
+   }
+}
@@ -569,3 +569,338 @@ TEST_CASE("dataset_shared, two features, 3 samples, weights, classification") {
 
    CHECK(99 == buffer[static_cast<size_t>(sum)]);
 }
+
+TEST_CASE("dataset_shared, builder, identical to measure and fill") {
+   IntEbm sum = 0;
+   IntEbm part;
+   ErrorEbm error;
+   static constexpr IntEbm k_cSamples = 5;
+   IntEbm binIndexes0[k_cSamples] { 2, 1, 0, 1, 2 };
+   IntEbm binIndexes1[k_cSamples] { 1, 4, 3, 2, 1 };
+   double weights[k_cSamples] { 0.31, 0.21, 0.11, 0.41, 0.51 };
+   IntEbm targets[k_cSamples] { 2, 1, 0, 0, 1 };
+
+   part = MeasureDataSetHeader(2, 1, 1);
+   CHECK(0 <= part);
+   sum += part;
+   part = MeasureFeature(3, EBM_TRUE, EBM_TRUE, EBM_FALSE, k_cSamples, &binIndexes0[0]);
+   CHECK(0 <= part);
+   sum += part;
+   part = MeasureFeature(5, EBM_FALSE, EBM_TRUE, EBM_TRUE, k_cSamples, &binIndexes1[0]);
+   CHECK(0 <= part);
+   sum += part;
+   part = MeasureWeight(k_cSamples, weights);
+   CHECK(0 <= part);
+   sum += part;
+   part = MeasureClassificationTarget(3, k_cSamples, &targets[0]);
+   CHECK(0 <= part);
+   sum += part;
+
+   std::vector<char> buffer(static_cast<size_t>(sum), 77);
+   error = FillDataSetHeader(2, 1, 1, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillFeature(3, EBM_TRUE, EBM_TRUE, EBM_FALSE, k_cSamples, &binIndexes0[0], sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillFeature(5, EBM_FALSE, EBM_TRUE, EBM_TRUE, k_cSamples, &binIndexes1[0], sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillWeight(k_cSamples, weights, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillClassificationTarget(3, k_cSamples, &targets[0], sum, &buffer[0]);
+   CHECK(Error_None == error);
+
+   DataSetBuilderHandle dataSetBuilderHandle = nullptr;
+   error = CreateDataSetBuilder(2, 1, 1, &dataSetBuilderHandle);
+   CHECK(Error_None == error);
+   error = DataSetBuilderAddFeature(dataSetBuilderHandle, 3, EBM_TRUE, EBM_TRUE, EBM_FALSE, k_cSamples, &binIndexes0[0]);
+   CHECK(Error_None == error);
+
+   IntEbm countBytes = -1;
+   // the dataset cannot be finalized before all the sections have been added
+   error = FinalizeDataSetBuilder(dataSetBuilderHandle, &countBytes);
+   CHECK(Error_None != error);
+
+   error = DataSetBuilderAddFeature(dataSetBuilderHandle, 5, EBM_FALSE, EBM_TRUE, EBM_TRUE, k_cSamples, &binIndexes1[0]);
+   CHECK(Error_None == error);
+   error = DataSetBuilderAddWeight(dataSetBuilderHandle, k_cSamples, weights);
+   CHECK(Error_None == error);
+   error = DataSetBuilderAddClassificationTarget(dataSetBuilderHandle, 3, k_cSamples, &targets[0]);
+   CHECK(Error_None == error);
+
+   // there is no room for another section
+   error = DataSetBuilderAddRegressionTarget(dataSetBuilderHandle, k_cSamples, weights);
+   CHECK(Error_None != error);
+
+   error = FinalizeDataSetBuilder(dataSetBuilderHandle, &countBytes);
+   CHECK(Error_None == error);
+   CHECK(sum == countBytes);
+
+   std::vector<char> built(static_cast<size_t>(countBytes) + 1, 77);
+   built[static_cast<size_t>(countBytes)] = 99;
+   error = CopyDataSetBuilder(dataSetBuilderHandle, countBytes, &built[0]);
+   CHECK(Error_None == error);
+   FreeDataSetBuilder(dataSetBuilderHandle);
+
+   CHECK(99 == built[static_cast<size_t>(countBytes)]);
+   CHECK(0 == memcmp(&buffer[0], &built[0], static_cast<size_t>(sum)));
+   CHECK(Error_None == CheckDataSet(countBytes, &built[0]));
+}
+
+TEST_CASE("dataset_shared, builder, zero features, zero samples, regression") {
+   DataSetBuilderHandle dataSetBuilderHandle = nullptr;
+   ErrorEbm error = CreateDataSetBuilder(0, 0, 1, &dataSetBuilderHandle);
+   CHECK(Error_None == error);
+   error = DataSetBuilderAddRegressionTarget(dataSetBuilderHandle, 0, nullptr);
+   CHECK(Error_None == error);
+
+   IntEbm countBytes = -1;
+   error = FinalizeDataSetBuilder(dataSetBuilderHandle, &countBytes);
+   CHECK(Error_None == error);
+   CHECK(MeasureDataSetHeader(0, 0, 1) + MeasureRegressionTarget(0, nullptr) == countBytes);
+
+   std::vector<char> built(static_cast<size_t>(countBytes), 77);
+   error = CopyDataSetBuilder(dataSetBuilderHandle, countBytes, &built[0]);
+   CHECK(Error_None == error);
+   FreeDataSetBuilder(dataSetBuilderHandle);
+
+   CHECK(Error_None == CheckDataSet(countBytes, &built[0]));
+}
+
+TEST_CASE("dataset_shared, builder, detach keeps the dataset after the builder is freed") {
+   static constexpr IntEbm k_cSamples = 1000;
+   static constexpr IntEbm k_cFeatures = 20;
+   std::vector<IntEbm> binIndexes(static_cast<size_t>(k_cSamples));
+   std::vector<double> targets(static_cast<size_t>(k_cSamples));
+   for(size_t i = 0; i < static_cast<size_t>(k_cSamples); ++i) {
+      binIndexes[i] = static_cast<IntEbm>(i % 7);
+      targets[i] = static_cast<double>(i) * 0.5;
+   }
+
+   DataSetBuilderHandle dataSetBuilderHandle = nullptr;
+   ErrorEbm error = CreateDataSetBuilder(k_cFeatures, 0, 1, &dataSetBuilderHandle);
+   CHECK(Error_None == error);
+   // enough sections that the buffer is grown several times
+   for(IntEbm iFeature = 0; iFeature < k_cFeatures; ++iFeature) {
+      error = DataSetBuilderAddFeature(
+         dataSetBuilderHandle, 7 + iFeature, EBM_TRUE, EBM_TRUE, EBM_FALSE, k_cSamples, &binIndexes[0]);
+      CHECK(Error_None == error);
+   }
+   error = DataSetBuilderAddRegressionTarget(dataSetBuilderHandle, k_cSamples, &targets[0]);
+   CHECK(Error_None == error);
+
+   void * dataSet = nullptr;
+   // the dataset cannot be detached before it is finalized
+   error = DetachDataSetBuilder(dataSetBuilderHandle, 0, &dataSet);
+   CHECK(Error_None != error);
+   CHECK(nullptr == dataSet);
+
+   IntEbm countBytes = -1;
+   error = FinalizeDataSetBuilder(dataSetBuilderHandle, &countBytes);
+   CHECK(Error_None == error);
+
+   std::vector<char> built(static_cast<size_t>(countBytes), 77);
+   error = CopyDataSetBuilder(dataSetBuilderHandle, countBytes, &built[0]);
+   CHECK(Error_None == error);
+
+   error = DetachDataSetBuilder(dataSetBuilderHandle, countBytes + 1, &dataSet);
+   CHECK(Error_None != error);
+   error = DetachDataSetBuilder(dataSetBuilderHandle, countBytes, &dataSet);
+   CHECK(Error_None == error);
+   CHECK(nullptr != dataSet);
+
+   void * dataSetAgain = nullptr;
+   error = DetachDataSetBuilder(dataSetBuilderHandle, countBytes, &dataSetAgain);
+   CHECK(Error_None != error);
+   CHECK(nullptr == dataSetAgain);
+
+   FreeDataSetBuilder(dataSetBuilderHandle);
+
+   if(nullptr != dataSet) {
+      CHECK(0 == memcmp(&built[0], dataSet, static_cast<size_t>(countBytes)));
+      CHECK(Error_None == CheckDataSet(countBytes, dataSet));
+   }
+   FreeDataSet(dataSet);
+}
+
+static std::vector<char> MakeChunkedReference(
+   const size_t cSamples,
+   const std::vector<IntEbm> & binIndexes,
+   const std::vector<double> & weights,
+   const std::vector<IntEbm> & targets
+) {
+   const IntEbm countSamples = static_cast<IntEbm>(cSamples);
+   const IntEbm * const aBinIndexes = &binIndexes[0];
+   IntEbm sum = MeasureDataSetHeader(3, 1, 1);
+   sum += MeasureFeature(3, EBM_TRUE, EBM_TRUE, EBM_FALSE, countSamples, aBinIndexes);
+   sum += MeasureFeature(5, EBM_FALSE, EBM_TRUE, EBM_TRUE, countSamples, aBinIndexes + cSamples);
+   sum += MeasureFeature(2, EBM_TRUE, EBM_FALSE, EBM_FALSE, countSamples, aBinIndexes + 2 * cSamples);
+   sum += MeasureWeight(countSamples, &weights[0]);
+   sum += MeasureClassificationTarget(4, countSamples, &targets[0]);
+
+   // CHECK is only available inside a TEST_CASE, so an empty buffer signals failure to the caller
+   std::vector<char> buffer(static_cast<size_t>(sum), 77);
+   ErrorEbm error = FillDataSetHeader(3, 1, 1, sum, &buffer[0]);
+   error = Error_None != error ? error : 
+      FillFeature(3, EBM_TRUE, EBM_TRUE, EBM_FALSE, countSamples, aBinIndexes, sum, &buffer[0]);
+   error = Error_None != error ? error : 
+      FillFeature(5, EBM_FALSE, EBM_TRUE, EBM_TRUE, countSamples, aBinIndexes + cSamples, sum, &buffer[0]);
+   error = Error_None != error ? error : 
+      FillFeature(2, EBM_TRUE, EBM_FALSE, EBM_FALSE, countSamples, aBinIndexes + 2 * cSamples, sum, &buffer[0]);
+   error = Error_None != error ? error : FillWeight(countSamples, &weights[0], sum, &buffer[0]);
+   error = Error_None != error ? error : FillClassificationTarget(4, countSamples, &targets[0], sum, &buffer[0]);
+   if(Error_None != error) {
+      buffer.clear();
+   }
+   return buffer;
+}
+
+static ErrorEbm AppendChunks(
+   const DataSetBuilderHandle dataSetBuilderHandle,
+   const size_t cSamples,
+   const std::vector<IntEbm> & binIndexes,
+   const std::vector<double> & weights,
+   const std::vector<IntEbm> & targets
+) {
+   // uneven chunks so that the packed words straddle the chunk boundaries
+   static constexpr size_t k_cRowsChunks[] { 7, 30, 1, 33 };
+   size_t iSample = 0;
+   for(const size_t cRowsChunk : k_cRowsChunks) {
+      std::vector<IntEbm> chunk;
+      for(size_t iFeature = 0; iFeature < 3; ++iFeature) {
+         for(size_t iRow = 0; iRow < cRowsChunk; ++iRow) {
+            chunk.push_back(binIndexes[iFeature * cSamples + iSample + iRow]);
+         }
+      }
+      const ErrorEbm error = DataSetBuilderAppendRows(dataSetBuilderHandle, static_cast<IntEbm>(cRowsChunk),
+         &chunk[0], &weights[iSample], &targets[iSample]);
+      if(Error_None != error) {
+         return error;
+      }
+      iSample += cRowsChunk;
+   }
+   return cSamples == iSample ? Error_None : Error_UnexpectedInternal;
+}
+
+TEST_CASE("dataset_shared, chunked builder, identical to measure and fill") {
+   static constexpr size_t k_cSamples = 71;
+   static const IntEbm k_binCounts[] { 3, 5, 2 };
+   static const BoolEbm k_isMissing[] { EBM_TRUE, EBM_FALSE, EBM_TRUE };
+   static const BoolEbm k_isUnknown[] { EBM_TRUE, EBM_TRUE, EBM_FALSE };
+   static const BoolEbm k_isNominal[] { EBM_FALSE, EBM_TRUE, EBM_FALSE };
+
+   std::vector<IntEbm> binIndexes;
+   std::vector<double> weights;
+   std::vector<IntEbm> targets;
+   for(size_t i = 0; i < k_cSamples; ++i) {
+      binIndexes.push_back(static_cast<IntEbm>(i * 7 % 3));
+      weights.push_back(0.5 + static_cast<double>(i));
+      targets.push_back(static_cast<IntEbm>(i % 4));
+   }
+   for(size_t i = 0; i < k_cSamples; ++i) {
+      binIndexes.push_back(static_cast<IntEbm>(1 + i * 5 % 4));
+   }
+   for(size_t i = 0; i < k_cSamples; ++i) {
+      // the only storable bin, so nothing is stored for this feature
+      binIndexes.push_back(0);
+   }
+
+   const std::vector<char> buffer = MakeChunkedReference(k_cSamples, binIndexes, weights, targets);
+   CHECK(!buffer.empty());
+
+   DataSetBuilderHandle dataSetBuilderHandle = nullptr;
+   ErrorEbm error = CreateDataSetBuilderChunked(static_cast<IntEbm>(k_cSamples), 3, k_binCounts, k_isMissing,
+      k_isUnknown, k_isNominal, 1, 1, EBM_TRUE, 4, nullptr, &dataSetBuilderHandle);
+   CHECK(Error_None == error);
+
+   IntEbm countBytes = -1;
+   // the dataset cannot be finalized before all the rows have been appended
+   error = FinalizeDataSetBuilder(dataSetBuilderHandle, &countBytes);
+   CHECK(Error_None != error);
+
+   // the sectioned API cannot be mixed with the chunked API
+   error = DataSetBuilderAddWeight(dataSetBuilderHandle, static_cast<IntEbm>(k_cSamples), &weights[0]);
+   CHECK(Error_None != error);
+
+   error = AppendChunks(dataSetBuilderHandle, k_cSamples, binIndexes, weights, targets);
+   CHECK(Error_None == error);
+
+   // there is no room for more rows
+   error = DataSetBuilderAppendRows(dataSetBuilderHandle, 1, &binIndexes[0], &weights[0], &targets[0]);
+   CHECK(Error_None != error);
+
+   FreeDataSetBuilder(dataSetBuilderHandle);
+
+   // the failed append above poisons the builder, so build it again and this time finalize it
+   dataSetBuilderHandle = nullptr;
+   error = CreateDataSetBuilderChunked(static_cast<IntEbm>(k_cSamples), 3, k_binCounts, k_isMissing,
+      k_isUnknown, k_isNominal, 1, 1, EBM_TRUE, 4, nullptr, &dataSetBuilderHandle);
+   CHECK(Error_None == error);
+   error = AppendChunks(dataSetBuilderHandle, k_cSamples, binIndexes, weights, targets);
+   CHECK(Error_None == error);
+   error = FinalizeDataSetBuilder(dataSetBuilderHandle, &countBytes);
+   CHECK(Error_None == error);
+   CHECK(static_cast<IntEbm>(buffer.size()) == countBytes);
+
+   std::vector<char> built(static_cast<size_t>(countBytes), 77);
+   error = CopyDataSetBuilder(dataSetBuilderHandle, countBytes, &built[0]);
+   CHECK(Error_None == error);
+   FreeDataSetBuilder(dataSetBuilderHandle);
+
+   CHECK(buffer == built);
+   CHECK(Error_None == CheckDataSet(countBytes, &built[0]));
+}
+
+TEST_CASE("dataset_shared, chunked builder, file") {
+   static constexpr size_t k_cSamples = 71;
+   static const IntEbm k_binCounts[] { 3, 5, 2 };
+   static const BoolEbm k_isMissing[] { EBM_TRUE, EBM_FALSE, EBM_TRUE };
+   static const BoolEbm k_isUnknown[] { EBM_TRUE, EBM_TRUE, EBM_FALSE };
+   static const BoolEbm k_isNominal[] { EBM_FALSE, EBM_TRUE, EBM_FALSE };
+   static const char k_filePath[] = "dataset_shared_chunked_test.bin";
+
+   std::vector<IntEbm> binIndexes;
+   std::vector<double> weights;
+   std::vector<IntEbm> targets;
+   for(size_t i = 0; i < k_cSamples; ++i) {
+      binIndexes.push_back(static_cast<IntEbm>(i * 11 % 3));
+      weights.push_back(2.0 + static_cast<double>(i % 5));
+      targets.push_back(static_cast<IntEbm>(i * 3 % 4));
+   }
+   for(size_t i = 0; i < k_cSamples; ++i) {
+      binIndexes.push_back(static_cast<IntEbm>(1 + i % 4));
+   }
+   for(size_t i = 0; i < k_cSamples; ++i) {
+      binIndexes.push_back(0);
+   }
+
+   const std::vector<char> buffer = MakeChunkedReference(k_cSamples, binIndexes, weights, targets);
+   CHECK(!buffer.empty());
+
+   DataSetBuilderHandle dataSetBuilderHandle = nullptr;
+   ErrorEbm error = CreateDataSetBuilderChunked(static_cast<IntEbm>(k_cSamples), 3, k_binCounts, k_isMissing,
+      k_isUnknown, k_isNominal, 1, 1, EBM_TRUE, 4, k_filePath, &dataSetBuilderHandle);
+   CHECK(Error_None == error);
+   error = AppendChunks(dataSetBuilderHandle, k_cSamples, binIndexes, weights, targets);
+   CHECK(Error_None == error);
+   IntEbm countBytes = -1;
+   error = FinalizeDataSetBuilder(dataSetBuilderHandle, &countBytes);
+   CHECK(Error_None == error);
+   CHECK(static_cast<IntEbm>(buffer.size()) == countBytes);
+
+   // a file backed dataset has no memory to copy
+   std::vector<char> built(static_cast<size_t>(countBytes), 77);
+   error = CopyDataSetBuilder(dataSetBuilderHandle, countBytes, &built[0]);
+   CHECK(Error_None != error);
+   FreeDataSetBuilder(dataSetBuilderHandle);
+
+   FILE * const pFile = fopen(k_filePath, "rb");
+   CHECK(nullptr != pFile);
+   if(nullptr != pFile) {
+      CHECK(built.size() == fread(&built[0], 1, built.size(), pFile));
+      CHECK(EOF == fgetc(pFile));
+      fclose(pFile);
+   }
+   remove(k_filePath);
+
+   CHECK(buffer == built);
+   CHECK(Error_None == CheckDataSet(countBytes, &built[0]));
+}
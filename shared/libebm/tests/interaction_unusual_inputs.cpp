@@ -557,3 +557,69 @@ TEST_CASE("tweedie, interaction") {
    CHECK_APPROX(metricReturn, 1.25);
 }
 
+
+TEST_CASE("gradient-only and hessian interaction detectors, classification, identical strengths") {
+   // the default interaction detector does not materialize hessians, but since the gain does not consume them
+   // the results should be identical to a detector created with CreateInteractionFlags_EnableNewton
+   const std::vector<TestSample> samples = {
+      TestSample({ 0, 0 }, 0, 1.5),
+      TestSample({ 0, 1 }, 1, 2.25),
+      TestSample({ 1, 0 }, 2, 0.75),
+      TestSample({ 1, 1 }, 1, 3.0),
+      TestSample({ 1, 1 }, 0, 1.0),
+      TestSample({ 0, 1 }, 2, 0.5),
+   };
+
+   for(const TaskEbm cClasses : { TaskEbm { 2 }, TaskEbm { 3 } }) {
+      std::vector<TestSample> samplesClasses;
+      for(const TestSample & sample : samples) {
+         samplesClasses.push_back(TestSample(
+            sample.m_sampleBinIndexes, 
+            static_cast<double>(static_cast<int>(sample.m_target) % static_cast<int>(cClasses)),
+            sample.m_weight
+         ));
+      }
+
+      TestInteraction test1 = TestInteraction(cClasses, { FeatureTest(2), FeatureTest(2) }, samplesClasses);
+      TestInteraction test2 = TestInteraction(
+         cClasses,
+         { FeatureTest(2), FeatureTest(2) },
+         samplesClasses,
+         k_testCreateInteractionFlags_Default | CreateInteractionFlags_EnableNewton
+      );
+
+      CHECK_APPROX(test1.TestCalcInteractionStrength({ 0, 1 }), test2.TestCalcInteractionStrength({ 0, 1 }));
+      CHECK_APPROX(
+         test1.TestCalcInteractionStrength({ 0, 1 }, CalcInteractionFlags_EnableNewton), 
+         test2.TestCalcInteractionStrength({ 0, 1 }, CalcInteractionFlags_EnableNewton)
+      );
+   }
+}
+
+TEST_CASE("unit weights and no weights, interaction, regression, identical strengths") {
+   // unweighted bins take their weights from the sample counts instead of summing 1.0 per sample
+   const std::vector<TestSample> samplesUnweighted = {
+      TestSample({ 0, 0 }, 10.1),
+      TestSample({ 0, 1 }, 20.2),
+      TestSample({ 0, 1 }, 21.2),
+      TestSample({ 1, 0 }, 30.3),
+      TestSample({ 1, 1 }, 40.4),
+      TestSample({ 1, 1 }, 39.4),
+      TestSample({ 1, 1 }, 41.4),
+   };
+   std::vector<TestSample> samplesWeighted;
+   for(const TestSample & sample : samplesUnweighted) {
+      samplesWeighted.push_back(TestSample(sample.m_sampleBinIndexes, sample.m_target, 1.0));
+   }
+
+   TestInteraction test1 = TestInteraction(Task_Regression, { FeatureTest(2), FeatureTest(2) }, samplesUnweighted);
+   TestInteraction test2 = TestInteraction(Task_Regression, { FeatureTest(2), FeatureTest(2) }, samplesWeighted);
+
+   CHECK_APPROX(test1.TestCalcInteractionStrength({ 0, 1 }), test2.TestCalcInteractionStrength({ 0, 1 }));
+
+   // a minimum leaf size of 2 relies on the counts, which are kept in both cases
+   CHECK_APPROX(
+      test1.TestCalcInteractionStrength({ 0, 1 }, CalcInteractionFlags_Default, 2),
+      test2.TestCalcInteractionStrength({ 0, 1 }, CalcInteractionFlags_Default, 2)
+   );
+}
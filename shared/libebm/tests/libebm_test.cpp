@@ -56,9 +56,15 @@ extern void FAILED(const double val, TestCaseHidden * const pTestCaseHidden, con
 #pragma optimize("", on)
 #endif // _MSC_VER
 
+std::atomic<LogCallbackFunction> g_logCallbackTest(nullptr);
+
 void EBM_CALLING_CONVENTION LogCallback(const TraceEbm traceLevel, const char * const message) {
    const size_t cChars = strlen(message); // test that the string memory is accessible
    UNUSED(cChars);
+   const LogCallbackFunction logCallbackTest = g_logCallbackTest.load();
+   if(nullptr != logCallbackTest) {
+      (*logCallbackTest)(traceLevel, message);
+   }
    if(traceLevel <= Trace_Off) {
       // don't display log messages during tests, but having this code here makes it easy to turn on when needed
       printf("\n%s: %s\n", GetTraceLevelString(traceLevel), message);
@@ -534,10 +540,22 @@ TestBoost::TestBoost(
       }
    }
 
+   std::vector<uint64_t> bagBits;
+   if(0 != (CreateBoosterFlags_BagBits & flags)) {
+      bagBits.resize((bag.size() + 63) / 64, 0);
+      for(size_t iSample = 0; iSample < bag.size(); ++iSample) {
+         if(BagEbm { 1 } == bag[iSample]) {
+            bagBits[iSample / 64] |= uint64_t { 1 } << (iSample % 64);
+         } else if(BagEbm { -1 } != bag[iSample]) {
+            throw TestException("bag bits can only hold samples that are used once");
+         }
+      }
+   }
+
    error = CreateBooster(
       &m_rng[0],
       &dataset[0],
-      0 == bag.size() ? nullptr : &bag[0],
+      0 != bagBits.size() ? reinterpret_cast<const BagEbm *>(&bagBits[0]) : 0 == bag.size() ? nullptr : &bag[0],
       bInitScores ? &initScores[0] : nullptr,
       dimensionCounts.size(),
       0 == dimensionCounts.size() ? nullptr : &dimensionCounts[0],
@@ -555,6 +573,10 @@ TestBoost::TestBoost(
    if(nullptr == m_boosterHandle) {
       throw TestException("Clean exit with nullptr from CreateBooster.");
    }
+
+   m_dataSet.swap(dataset);
+   m_bag.swap(bag);
+   m_bagBits.swap(bagBits);
 }
 
 TestBoost::~TestBoost() {
@@ -568,7 +590,8 @@ BoostRet TestBoost::Boost(
    const TermBoostFlags flags,
    const double learningRate,
    const IntEbm minSamplesLeaf,
-   const std::vector<IntEbm> leavesMax
+   const std::vector<IntEbm> leavesMax,
+   const IntEbm indexTermNext
 ) {
    ErrorEbm error;
 
@@ -612,9 +635,16 @@ BoostRet TestBoost::Boost(
          throw TestException(error, "SetTermUpdate");
       }
    }
-   error = ApplyTermUpdate(m_boosterHandle, &validationMetricAvg);
-   if(Error_None != error) {
-      throw TestException(error, "ApplyTermUpdate");
+   if(IntEbm { 0 } <= indexTermNext) {
+      error = ApplyTermUpdateFused(m_boosterHandle, indexTermNext, &validationMetricAvg);
+      if(Error_None != error) {
+         throw TestException(error, "ApplyTermUpdateFused");
+      }
+   } else {
+      error = ApplyTermUpdate(m_boosterHandle, &validationMetricAvg);
+      if(Error_None != error) {
+         throw TestException(error, "ApplyTermUpdate");
+      }
    }
 
    return BoostRet { gainAvg, validationMetricAvg };
@@ -679,6 +709,93 @@ void TestBoost::GetCurrentTermScoresRaw(const size_t iTerm, double * const aTerm
    }
 }
 
+std::vector<double> TestBoost::GetSampleScores() const {
+   size_t cIncluded = 0;
+   for(const BagEbm replication : m_bag) {
+      if(BagEbm { 0 } != replication) {
+         ++cIncluded;
+      }
+   }
+   std::vector<double> sampleScores(cIncluded * GetCountScores(m_cClasses));
+   if(0 != sampleScores.size()) {
+      ErrorEbm error = ::GetSampleScores(m_boosterHandle, 1, &m_dataSet[0], GetBag(), &sampleScores[0]);
+      if(Error_None != error) {
+         throw TestException(error, "GetSampleScores");
+      }
+      error = ::GetSampleScores(m_boosterHandle, -1, &m_dataSet[0], GetBag(), &sampleScores[0]);
+      if(Error_None != error) {
+         throw TestException(error, "GetSampleScores");
+      }
+   }
+   return sampleScores;
+}
+
+std::vector<double> TestBoost::CalcSampleScores() const {
+   size_t cIncluded = 0;
+   for(const BagEbm replication : m_bag) {
+      if(BagEbm { 0 } != replication) {
+         ++cIncluded;
+      }
+   }
+   const size_t cScores = GetCountScores(m_cClasses);
+
+   std::vector<IntEbm> dimensionCounts;
+   std::vector<IntEbm> featureIndexes;
+   std::vector<double> termScores;
+   for(size_t iTerm = 0; iTerm < m_termFeatures.size(); ++iTerm) {
+      size_t cTensorScores = cScores;
+      for(const IntEbm iFeature : m_termFeatures[iTerm]) {
+         cTensorScores *= static_cast<size_t>(m_features[static_cast<size_t>(iFeature)].m_countBins);
+         featureIndexes.push_back(iFeature);
+      }
+      dimensionCounts.push_back(static_cast<IntEbm>(m_termFeatures[iTerm].size()));
+      const size_t iStart = termScores.size();
+      termScores.resize(iStart + cTensorScores);
+      GetBestTermScoresRaw(iTerm, &termScores[iStart]);
+   }
+
+   std::vector<double> sampleScores(cIncluded * cScores);
+   if(0 != sampleScores.size()) {
+      const ErrorEbm error = ::CalcSampleScores(
+         &m_dataSet[0],
+         &m_bag[0],
+         nullptr,
+         static_cast<IntEbm>(cScores),
+         static_cast<IntEbm>(dimensionCounts.size()),
+         dimensionCounts.empty() ? nullptr : &dimensionCounts[0],
+         featureIndexes.empty() ? nullptr : &featureIndexes[0],
+         termScores.empty() ? nullptr : &termScores[0],
+         &sampleScores[0]
+      );
+      if(Error_None != error) {
+         throw TestException(error, "CalcSampleScores");
+      }
+   }
+   return sampleScores;
+}
+
+void TestBoost::AddTerms(const std::vector<std::vector<IntEbm>> termFeatures) {
+   std::vector<IntEbm> dimensionCounts;
+   std::vector<IntEbm> allFeatureIndexes;
+   for(const std::vector<IntEbm> & featureIndexes : termFeatures) {
+      dimensionCounts.push_back(featureIndexes.size());
+      for(const IntEbm indexFeature : featureIndexes) {
+         allFeatureIndexes.push_back(indexFeature);
+      }
+   }
+   const ErrorEbm error = ::AddTerms(
+      m_boosterHandle,
+      &m_dataSet[0],
+      GetBag(),
+      dimensionCounts.size(),
+      0 == dimensionCounts.size() ? nullptr : &dimensionCounts[0],
+      0 == allFeatureIndexes.size() ? nullptr : &allFeatureIndexes[0]
+   );
+   if(Error_None != error) {
+      throw TestException(error, "AddTerms");
+   }
+   m_termFeatures.insert(m_termFeatures.end(), termFeatures.begin(), termFeatures.end());
+}
 
 TestInteraction::TestInteraction(
    const TaskEbm cClasses,
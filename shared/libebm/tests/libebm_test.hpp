@@ -10,6 +10,7 @@
 #include <cmath> // std::nextafter
 #include <string> // std::string
 #include <vector> // std::vector
+#include <atomic> // std::atomic
 #include <assert.h> // assert
 
 #include "libebm.h" // IntEbm
@@ -28,9 +29,13 @@ enum class TestPriority {
    CutUniform,
    CutWinsorized,
    CutQuantile,
-   Discretize
+   Discretize,
+   Logging
 };
 
+// when set, LogCallback also passes every message here. Tests that set it need to clear it before they finish
+extern std::atomic<LogCallbackFunction> g_logCallbackTest;
+
 class TestException final : public std::exception {
    const ErrorEbm m_error;
    const std::string m_message;
@@ -417,12 +422,23 @@ struct BoostRet {
 class TestBoost {
    const TaskEbm m_cClasses;
    const std::vector<FeatureTest> m_features;
-   const std::vector<std::vector<IntEbm>> m_termFeatures;
+   std::vector<std::vector<IntEbm>> m_termFeatures;
    const ptrdiff_t m_iZeroClassificationLogit;
 
    std::vector<unsigned char> m_rng;
+   std::vector<unsigned char> m_dataSet;
+   std::vector<BagEbm> m_bag;
+   std::vector<uint64_t> m_bagBits;
    BoosterHandle m_boosterHandle;
 
+   inline const BagEbm * GetBag() const {
+      // with CreateBoosterFlags_BagBits the booster reads m_bagBits, but m_bag still counts the included samples
+      if(0 != m_bagBits.size()) {
+         return reinterpret_cast<const BagEbm *>(&m_bagBits[0]);
+      }
+      return 0 == m_bag.size() ? nullptr : &m_bag[0];
+   }
+
    const double * GetTermScores(
       const size_t iTerm,
       const double * const aTermScores,
@@ -465,7 +481,8 @@ public:
       const TermBoostFlags flags = TermBoostFlags_Default,
       const double learningRate = k_learningRateDefault,
       const IntEbm minSamplesLeaf = k_minSamplesLeafDefault,
-      const std::vector<IntEbm> leavesMax = k_leavesMaxDefault
+      const std::vector<IntEbm> leavesMax = k_leavesMaxDefault,
+      const IntEbm indexTermNext = IntEbm { -1 }
    );
 
    double GetBestTermScore(
@@ -483,6 +500,15 @@ public:
    ) const;
 
    void GetCurrentTermScoresRaw(const size_t iTerm, double * const aTermScores) const;
+
+   // the scores of the training and validation samples that are in the bag, in the order they were given
+   std::vector<double> GetSampleScores() const;
+
+   // the same rows as GetSampleScores, but calculated in double from the best model and the binned dataset
+   std::vector<double> CalcSampleScores() const;
+
+   // the new terms index the features of the dataset the booster was created on
+   void AddTerms(const std::vector<std::vector<IntEbm>> termFeatures);
 };
 
 
@@ -0,0 +1,103 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch_test.hpp"
+
+#include <mutex>
+#include <thread>
+
+#include "libebm.h"
+#include "libebm_test.hpp"
+
+static constexpr TestPriority k_filePriority = TestPriority::Logging;
+
+static const char k_sEnteredCreate[] = "Entered CreateQuantileSketch: countEntriesMax=";
+static const char k_sExitedCreate[] = "Exited CreateQuantileSketch";
+static const char k_sEnteredFree[] = "Entered FreeQuantileSketch: ";
+static const char k_sExitedFree[] = "Exited FreeQuantileSketch";
+static const char k_sDropped[] = "Native logging dropped ";
+
+static std::mutex g_mutexCaptured;
+static std::vector<std::string> g_captured;
+static unsigned long long g_cDropped;
+static std::atomic<bool> g_bBlocked;
+static std::atomic<bool> g_bRelease;
+
+static bool IsPrefix(const char * const sPrefix, const char * const message) {
+   return 0 == strncmp(sPrefix, message, strlen(sPrefix));
+}
+
+static void EBM_CALLING_CONVENTION LogCallbackCapture(const TraceEbm traceLevel, const char * const message) {
+   if(IsPrefix(k_sDropped, message)) {
+      std::lock_guard<std::mutex> lock(g_mutexCaptured);
+      g_cDropped += strtoull(message + strlen(k_sDropped), nullptr, 10);
+      return;
+   }
+   if(Trace_Info != traceLevel || (!IsPrefix(k_sEnteredCreate, message) && !IsPrefix(k_sExitedCreate, message) &&
+      !IsPrefix(k_sEnteredFree, message) && !IsPrefix(k_sExitedFree, message))) {
+      return;
+   }
+   if(!g_bBlocked.exchange(true)) {
+      // hold up the background thread on the first message so that the logging thread overruns its buffer
+      while(!g_bRelease.load()) {
+         std::this_thread::yield();
+      }
+   }
+   std::lock_guard<std::mutex> lock(g_mutexCaptured);
+   g_captured.push_back(message);
+}
+
+TEST_CASE("logging, buffered messages keep their order and count what was dropped") {
+   static constexpr IntEbm k_cSketches = 200;
+   static constexpr size_t k_cMessagesPerSketch = 4;
+
+   // deliver anything that earlier tests left buffered, along with their dropped count, before we start counting
+   SetTraceLevel(Trace_Warning);
+   SetTraceLevel(Trace_Verbose);
+
+   g_captured.clear();
+   g_cDropped = 0;
+   g_bBlocked.store(false);
+   g_bRelease.store(false);
+   g_logCallbackTest.store(&LogCallbackCapture);
+
+   for(IntEbm i = 0; i < k_cSketches; ++i) {
+      QuantileSketchHandle quantileSketchHandle = nullptr;
+      // the sketch size numbers the messages
+      const ErrorEbm error = CreateQuantileSketch(IntEbm { 2 } + i, &quantileSketchHandle);
+      CHECK(Error_None == error);
+      FreeQuantileSketch(quantileSketchHandle);
+   }
+
+   g_bRelease.store(true);
+   // lowering the level below Trace_Info delivers everything buffered before returning
+   SetTraceLevel(Trace_Warning);
+   g_logCallbackTest.store(nullptr);
+   SetTraceLevel(Trace_Verbose);
+
+   std::lock_guard<std::mutex> lock(g_mutexCaptured);
+
+   // more messages were logged than fit in a buffer while the callback was held up
+   CHECK(0 < g_cDropped);
+   CHECK(static_cast<size_t>(k_cSketches) * k_cMessagesPerSketch == g_captured.size() + g_cDropped);
+
+   // nothing is dropped until the buffer fills, so the first sketch arrives whole and in order
+   CHECK(k_cMessagesPerSketch <= g_captured.size());
+   if(k_cMessagesPerSketch <= g_captured.size()) {
+      CHECK(std::string(k_sEnteredCreate) + "2, " == g_captured[0].substr(0, strlen(k_sEnteredCreate) + 3));
+      CHECK(k_sExitedCreate == g_captured[1]);
+      CHECK(IsPrefix(k_sEnteredFree, g_captured[2].c_str()));
+      CHECK(k_sExitedFree == g_captured[3]);
+   }
+
+   // whatever was delivered after that arrives in the order it was logged
+   IntEbm iPrev = -1;
+   for(const std::string & message : g_captured) {
+      if(IsPrefix(k_sEnteredCreate, message.c_str())) {
+         const IntEbm i = static_cast<IntEbm>(strtoll(message.c_str() + strlen(k_sEnteredCreate), nullptr, 10)) - 2;
+         CHECK(iPrev < i);
+         iPrev = i;
+      }
+   }
+}
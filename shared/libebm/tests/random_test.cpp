@@ -287,6 +287,143 @@ TEST_CASE("SampleWithoutReplacementStratified, stress test") {
    }
 }
 
+TEST_CASE("SampleWithoutReplacementStratifiedBags, identical to SampleWithoutReplacementStratified") {
+   static constexpr size_t cBags = 5;
+   static constexpr size_t cClasses = 7;
+   static constexpr size_t cTrainingSamples = 150;
+   static constexpr size_t cValidationSamples = 50;
+   static constexpr size_t cSamples = cTrainingSamples + cValidationSamples;
+
+   ErrorEbm error;
+
+   const size_t cRngBytes = static_cast<size_t>(MeasureRNG());
+   std::vector<unsigned char> rngs(cRngBytes * cBags);
+   std::vector<unsigned char> rngsSingle(cRngBytes * cBags);
+   for(size_t iBag = 0; iBag < cBags; ++iBag) {
+      InitRNG(k_seed + static_cast<SeedEbm>(iBag), &rngs[cRngBytes * iBag]);
+      InitRNG(k_seed + static_cast<SeedEbm>(iBag), &rngsSingle[cRngBytes * iBag]);
+   }
+
+   std::vector<IntEbm> targets(cSamples);
+   for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+      targets[iSample] = static_cast<IntEbm>((iSample * iSample) % cClasses);
+   }
+
+   // use more threads than bags to check that the extra threads are not started
+   std::vector<BagEbm> bags(cSamples * cBags);
+   error = SampleWithoutReplacementStratifiedBags(
+      &rngs[0],
+      cBags,
+      cClasses,
+      cTrainingSamples,
+      cValidationSamples,
+      &targets[0],
+      cBags + 3,
+      &bags[0]
+   );
+   CHECK(Error_None == error);
+
+   std::vector<BagEbm> bag(cSamples);
+   for(size_t iBag = 0; iBag < cBags; ++iBag) {
+      error = SampleWithoutReplacementStratified(
+         &rngsSingle[cRngBytes * iBag],
+         cClasses,
+         cTrainingSamples,
+         cValidationSamples,
+         &targets[0],
+         &bag[0]
+      );
+      CHECK(Error_None == error);
+      CHECK(0 == memcmp(&bag[0], &bags[cSamples * iBag], sizeof(BagEbm) * cSamples));
+   }
+   // each rng should be advanced exactly as if the bags were generated one at a time
+   CHECK(rngsSingle == rngs);
+
+   // without rngs the bags are non-deterministic, but they still need the right counts
+   error = SampleWithoutReplacementStratifiedBags(
+      nullptr,
+      cBags,
+      cClasses,
+      cTrainingSamples,
+      cValidationSamples,
+      &targets[0],
+      0,
+      &bags[0]
+   );
+   CHECK(Error_None == error);
+   size_t cTraining = 0;
+   for(const BagEbm val : bags) {
+      CHECK(BagEbm { -1 } == val || BagEbm { 1 } == val);
+      if(BagEbm { 0 } < val) {
+         ++cTraining;
+      }
+   }
+   CHECK(cTrainingSamples * cBags == cTraining);
+}
+
+TEST_CASE("SampleWithoutReplacementStratifiedBagBits, identical to SampleWithoutReplacementStratifiedBags") {
+   static constexpr size_t cBags = 3;
+   static constexpr size_t cClasses = 4;
+   static constexpr size_t cTrainingSamples = 101;
+   static constexpr size_t cValidationSamples = 40;
+   static constexpr size_t cSamples = cTrainingSamples + cValidationSamples;
+   static constexpr size_t cWords = (cSamples + 63) / 64;
+
+   ErrorEbm error;
+
+   const size_t cRngBytes = static_cast<size_t>(MeasureRNG());
+   std::vector<unsigned char> rngs(cRngBytes * cBags);
+   std::vector<unsigned char> rngsBits(cRngBytes * cBags);
+   for(size_t iBag = 0; iBag < cBags; ++iBag) {
+      InitRNG(k_seed + static_cast<SeedEbm>(iBag), &rngs[cRngBytes * iBag]);
+      InitRNG(k_seed + static_cast<SeedEbm>(iBag), &rngsBits[cRngBytes * iBag]);
+   }
+
+   std::vector<IntEbm> targets(cSamples);
+   for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+      targets[iSample] = static_cast<IntEbm>(iSample * 5 % cClasses);
+   }
+
+   std::vector<BagEbm> bags(cSamples * cBags);
+   error = SampleWithoutReplacementStratifiedBags(
+      &rngs[0],
+      cBags,
+      cClasses,
+      cTrainingSamples,
+      cValidationSamples,
+      &targets[0],
+      2,
+      &bags[0]
+   );
+   CHECK(Error_None == error);
+
+   // fill with ones to check that the padding bits are cleared
+   std::vector<uint64_t> bagBits(cWords * cBags, ~uint64_t { 0 });
+   error = SampleWithoutReplacementStratifiedBagBits(
+      &rngsBits[0],
+      cBags,
+      cClasses,
+      cTrainingSamples,
+      cValidationSamples,
+      &targets[0],
+      2,
+      &bagBits[0]
+   );
+   CHECK(Error_None == error);
+   CHECK(rngsBits == rngs);
+
+   for(size_t iBag = 0; iBag < cBags; ++iBag) {
+      for(size_t iSample = 0; iSample < cWords * 64; ++iSample) {
+         const bool bSet = 0 != (bagBits[cWords * iBag + iSample / 64] >> (iSample % 64) & uint64_t { 1 });
+         if(iSample < cSamples) {
+            CHECK(bSet == (BagEbm { 1 } == bags[cSamples * iBag + iSample]));
+         } else {
+            CHECK(!bSet);
+         }
+      }
+   }
+}
+
 TEST_CASE("SampleWithoutReplacement, stress test") {
    ErrorEbm error;
 
@@ -4,6 +4,18 @@
 
 #include <stdio.h> // vsnprintf
 #include <stdarg.h> // va_start
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t
+#include <new> // placement new
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+#if defined(_MSC_VER)
+#include <intrin.h> // _InterlockedCompareExchange
+#endif // _MSC_VER
 
 #include "logging.h"
 
@@ -22,6 +34,337 @@ static LogCallbackFunction g_pLogCallbackFunction = NULL;
 unsigned int g_coverage[TEST_COVERAGE_COUNT] = { 0 };
 #endif // NDEBUG
 
+// Trace_Info and Trace_Verbose are the levels that get logged from inside boosting, where views and worker threads
+// can be logging at the same time. Each thread formats those messages into its own ring without taking a lock, and
+// a background thread hands them to the LogCallbackFunction in the order that each thread wrote them. Trace_Error
+// and Trace_Warning messages still go straight to the callback, after whatever the same thread has buffered. If a
+// thread logs faster than the callback can keep up, the excess messages are counted and dropped instead of making
+// the thread wait. The background thread sleeps until a thread writes into its empty ring, so an idle process
+// has no periodic wakeups.
+static const size_t k_cLogRecords = 64;
+static const size_t k_cLogRecordChars = 1024;
+// how long library unload waits for the flusher to finish, since it might be blocked in the callback or be gone
+static const long long k_logUnloadWaitMilliseconds = 1000;
+
+struct LogRecord final {
+   TraceEbm m_traceLevel;
+   const char * m_sStatic; // LOG_0 messages are static strings, so only their pointer is kept
+   char m_sFormatted[k_cLogRecordChars];
+};
+
+struct LogRing final {
+   // m_iWrite is only written by the owning thread and m_iRead only by whoever holds m_mutexRead
+   std::atomic_size_t m_iWrite;
+   std::atomic_size_t m_iRead;
+   std::atomic_size_t m_cDropped;
+   std::atomic_bool m_bAbandoned;
+   std::mutex m_mutexRead;
+   LogRing * m_pNext;
+   LogRecord m_aRecords[k_cLogRecords];
+};
+
+struct LogBuffering final {
+   std::mutex m_mutex; // guards m_pRings and is held while the flusher drains them
+   LogRing * m_pRings;
+
+   // m_mutexWake is never held while calling the callback, so logging threads only wait on it briefly
+   std::mutex m_mutexWake; // guards the fields below
+   std::condition_variable m_wake;
+   bool m_bWake;
+   bool m_bRunning;
+   bool m_bStop;
+};
+
+// allocated once and never freed, so nothing at process exit waits on the flusher thread, which might itself be
+// waiting on a callback into a runtime that is shutting down
+static LogBuffering * g_pLogBuffering = NULL;
+static std::atomic_bool g_bLogBuffered(false);
+
+class LogRingOwner final {
+   LogRing * m_pRing;
+
+public:
+   LogRingOwner() : m_pRing(NULL) {
+   }
+
+   ~LogRingOwner() {
+      if(NULL != m_pRing) {
+         // the flusher frees the ring once it has delivered what is left in it
+         m_pRing->m_bAbandoned.store(true, std::memory_order_release);
+      }
+   }
+
+   inline LogRing * GetRing() const {
+      return m_pRing;
+   }
+
+   inline void SetRing(LogRing * const pRing) {
+      m_pRing = pRing;
+   }
+};
+static thread_local LogRingOwner t_logRingOwner;
+
+static void DrainLogRing(LogRing * const pRing) {
+   std::lock_guard<std::mutex> lock(pRing->m_mutexRead);
+
+   const size_t cDropped = pRing->m_cDropped.exchange(0, std::memory_order_relaxed);
+   if(0 != cDropped) {
+      char messageSpace[128];
+      // NOLINTNEXTLINE
+      if(0 <= snprintf(messageSpace, sizeof(messageSpace) / sizeof(messageSpace[0]),
+         "Native logging dropped %llu messages that were logged faster than they could be delivered.",
+         static_cast<unsigned long long>(cDropped))) {
+         (*g_pLogCallbackFunction)(Trace_Warning, messageSpace);
+      }
+   }
+
+   size_t iRead = pRing->m_iRead.load(std::memory_order_relaxed);
+   while(true) {
+      size_t iWrite = pRing->m_iWrite.load(std::memory_order_acquire);
+      if(iWrite == iRead) {
+         // EndBufferedLog stores m_iWrite and then reads m_iRead, while we stored m_iRead and now read m_iWrite. With
+         // a full fence on both sides either the writer sees an empty ring and wakes the flusher, or we see its record
+         std::atomic_thread_fence(std::memory_order_seq_cst);
+         iWrite = pRing->m_iWrite.load(std::memory_order_acquire);
+         if(iWrite == iRead) {
+            break;
+         }
+      }
+      do {
+         const LogRecord * const pRecord = &pRing->m_aRecords[iRead % k_cLogRecords];
+         (*g_pLogCallbackFunction)(pRecord->m_traceLevel, NULL != pRecord->m_sStatic ? pRecord->m_sStatic : pRecord->m_sFormatted);
+         ++iRead;
+         // release the slot to the owning thread right away so that it can keep logging while we call the callback
+         pRing->m_iRead.store(iRead, std::memory_order_release);
+      } while(iWrite != iRead);
+   }
+}
+
+static void DrainLogRings(LogBuffering * const pLogBuffering) {
+   // the caller holds pLogBuffering->m_mutex
+   LogRing ** ppRing = &pLogBuffering->m_pRings;
+   while(NULL != *ppRing) {
+      LogRing * const pRing = *ppRing;
+      // read m_bAbandoned first. If it is set, the thread wrote its last message before setting it
+      const bool bAbandoned = pRing->m_bAbandoned.load(std::memory_order_acquire);
+      DrainLogRing(pRing);
+      if(bAbandoned) {
+         *ppRing = pRing->m_pNext;
+         pRing->~LogRing();
+         free(pRing);
+      } else {
+         ppRing = &pRing->m_pNext;
+      }
+   }
+}
+
+static void LogFlusher(LogBuffering * const pLogBuffering) {
+   while(true) {
+      bool bStop;
+      {
+         std::unique_lock<std::mutex> lockWake(pLogBuffering->m_mutexWake);
+         while(!pLogBuffering->m_bWake && !pLogBuffering->m_bStop) {
+            pLogBuffering->m_wake.wait(lockWake);
+         }
+         // anything written after we clear m_bWake sets it again, so we either drain it below or on the next pass
+         pLogBuffering->m_bWake = false;
+         bStop = pLogBuffering->m_bStop;
+      }
+      {
+         std::lock_guard<std::mutex> lock(pLogBuffering->m_mutex);
+         DrainLogRings(pLogBuffering);
+      }
+      if(bStop) {
+         break;
+      }
+   }
+   std::lock_guard<std::mutex> lockWake(pLogBuffering->m_mutexWake);
+   pLogBuffering->m_bRunning = false;
+   pLogBuffering->m_wake.notify_all();
+}
+
+static void WakeLogFlusher(LogBuffering * const pLogBuffering) {
+   {
+      std::lock_guard<std::mutex> lockWake(pLogBuffering->m_mutexWake);
+      pLogBuffering->m_bWake = true;
+   }
+   pLogBuffering->m_wake.notify_one();
+}
+
+static void StartLogBuffering() {
+   if(NULL == g_pLogBuffering) {
+      void * const pMemory = malloc(sizeof(LogBuffering));
+      if(NULL == pMemory) {
+         // without the flusher every message goes straight to the callback as before
+         return;
+      }
+      LogBuffering * const pLogBuffering = new(pMemory) LogBuffering();
+      pLogBuffering->m_pRings = NULL;
+      pLogBuffering->m_bWake = false;
+      pLogBuffering->m_bRunning = false;
+      pLogBuffering->m_bStop = false;
+      g_pLogBuffering = pLogBuffering;
+   }
+
+   LogBuffering * const pLogBuffering = g_pLogBuffering;
+   {
+      std::lock_guard<std::mutex> lockWake(pLogBuffering->m_mutexWake);
+      if(pLogBuffering->m_bRunning) {
+         return;
+      }
+      pLogBuffering->m_bRunning = true;
+      pLogBuffering->m_bStop = false;
+      pLogBuffering->m_bWake = false;
+   }
+   try {
+      // detached for the reason given at g_pLogBuffering. StopLogBuffering waits on m_bRunning instead of joining
+      std::thread(LogFlusher, pLogBuffering).detach();
+   } catch(...) {
+      std::lock_guard<std::mutex> lockWake(pLogBuffering->m_mutexWake);
+      pLogBuffering->m_bRunning = false;
+      return;
+   }
+   g_bLogBuffered.store(true, std::memory_order_release);
+}
+
+static void StopLogBuffering() {
+   LogBuffering * const pLogBuffering = g_pLogBuffering;
+   if(NULL != pLogBuffering) {
+      g_bLogBuffered.store(false, std::memory_order_release);
+
+      std::unique_lock<std::mutex> lockWake(pLogBuffering->m_mutexWake);
+      if(pLogBuffering->m_bRunning) {
+         pLogBuffering->m_bStop = true;
+         pLogBuffering->m_wake.notify_all();
+         // the flusher delivers everything buffered before it stops
+         while(pLogBuffering->m_bRunning) {
+            pLogBuffering->m_wake.wait(lockWake);
+         }
+      }
+   }
+}
+
+// Runs when the library is unloaded or the process exits. Hosts like Python should lower the trace level below
+// Trace_Info before that, while their callback can still run, and then there is nothing left to do here. Otherwise
+// we deliver what is still buffered, but we cannot wait on the flusher without a limit: it might be blocked in the
+// callback, or already be gone since Windows ends the other threads of a process before unloading its libraries.
+static void StopLogBufferingAtUnload() {
+   LogBuffering * const pLogBuffering = g_pLogBuffering;
+   if(NULL == pLogBuffering) {
+      return;
+   }
+   g_bLogBuffered.store(false, std::memory_order_release);
+
+   const std::chrono::steady_clock::time_point timeEnd = 
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(k_logUnloadWaitMilliseconds);
+   {
+      std::unique_lock<std::mutex> lockWake(pLogBuffering->m_mutexWake, std::defer_lock);
+      while(!lockWake.try_lock()) {
+         if(timeEnd <= std::chrono::steady_clock::now()) {
+            return;
+         }
+         std::this_thread::yield();
+      }
+      if(pLogBuffering->m_bRunning) {
+         pLogBuffering->m_bStop = true;
+         pLogBuffering->m_wake.notify_all();
+         while(pLogBuffering->m_bRunning) {
+            if(std::cv_status::timeout == pLogBuffering->m_wake.wait_until(lockWake, timeEnd)) {
+               // the flusher did not finish, so leave the rings to it
+               return;
+            }
+         }
+      }
+   }
+
+   // the flusher is stopped, but logging threads that ended abruptly might still hold their ring, so only drain
+   // what we can get without waiting
+   std::unique_lock<std::mutex> lock(pLogBuffering->m_mutex, std::try_to_lock);
+   if(!lock.owns_lock() || NULL == g_pLogCallbackFunction) {
+      return;
+   }
+   for(LogRing * pRing = pLogBuffering->m_pRings; NULL != pRing; pRing = pRing->m_pNext) {
+      std::unique_lock<std::mutex> lockRead(pRing->m_mutexRead, std::try_to_lock);
+      if(lockRead.owns_lock()) {
+         lockRead.unlock();
+         DrainLogRing(pRing);
+      }
+   }
+}
+
+class LogBufferingUnload final {
+public:
+   ~LogBufferingUnload() {
+      StopLogBufferingAtUnload();
+   }
+};
+static LogBufferingUnload g_logBufferingUnload;
+
+static LogRing * GetLogRing() {
+   LogRing * pRing = t_logRingOwner.GetRing();
+   if(NULL == pRing) {
+      void * const pMemory = malloc(sizeof(LogRing));
+      if(NULL == pMemory) {
+         return NULL;
+      }
+      pRing = new(pMemory) LogRing();
+      pRing->m_iWrite.store(0, std::memory_order_relaxed);
+      pRing->m_iRead.store(0, std::memory_order_relaxed);
+      pRing->m_cDropped.store(0, std::memory_order_relaxed);
+      pRing->m_bAbandoned.store(false, std::memory_order_relaxed);
+
+      LogBuffering * const pLogBuffering = g_pLogBuffering;
+      std::lock_guard<std::mutex> lock(pLogBuffering->m_mutex);
+      pRing->m_pNext = pLogBuffering->m_pRings;
+      pLogBuffering->m_pRings = pRing;
+      t_logRingOwner.SetRing(pRing);
+   }
+   return pRing;
+}
+
+// returns the record to fill, or NULL if the message should go straight to the callback
+static LogRecord * BeginBufferedLog(const TraceEbm traceLevel, LogRing ** const ppRingOut, bool * const pbDroppedOut) {
+   *pbDroppedOut = false;
+   if(traceLevel < Trace_Info || !g_bLogBuffered.load(std::memory_order_acquire)) {
+      if(g_bLogBuffered.load(std::memory_order_relaxed)) {
+         // keep the order of this thread's messages by delivering what it has buffered first
+         LogRing * const pRing = t_logRingOwner.GetRing();
+         if(NULL != pRing) {
+            DrainLogRing(pRing);
+         }
+      }
+      return NULL;
+   }
+
+   LogRing * const pRing = GetLogRing();
+   if(NULL == pRing) {
+      return NULL;
+   }
+   const size_t iWrite = pRing->m_iWrite.load(std::memory_order_relaxed);
+   if(k_cLogRecords == iWrite - pRing->m_iRead.load(std::memory_order_acquire)) {
+      pRing->m_cDropped.fetch_add(1, std::memory_order_relaxed);
+      *pbDroppedOut = true;
+      return NULL;
+   }
+   *ppRingOut = pRing;
+   LogRecord * const pRecord = &pRing->m_aRecords[iWrite % k_cLogRecords];
+   pRecord->m_traceLevel = traceLevel;
+   pRecord->m_sStatic = NULL;
+   return pRecord;
+}
+
+static void EndBufferedLog(LogRing * const pRing) {
+   const size_t iWrite = pRing->m_iWrite.load(std::memory_order_relaxed) + 1;
+   pRing->m_iWrite.store(iWrite, std::memory_order_release);
+   // pairs with the fence in DrainLogRing
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   if(iWrite - 1 == pRing->m_iRead.load(std::memory_order_relaxed)) {
+      // the ring was empty, so the flusher is either asleep or has already passed this ring. Later messages find
+      // the ring non-empty and do not need to wake it again
+      WakeLogFlusher(g_pLogBuffering);
+   }
+}
+
 EBM_API_BODY const char * EBM_CALLING_CONVENTION GetTraceLevelString(TraceEbm traceLevel) {
    static const char g_sTraceOff[] = "OFF";
    static const char g_sTraceError[] = "ERROR";
@@ -98,6 +441,10 @@ EBM_API_BODY void EBM_CALLING_CONVENTION SetTraceLevel(TraceEbm traceLevel) {
       sMessage = NULL;
    }
 
+   if(Trace_Info <= traceLevel) {
+      StartLogBuffering();
+   }
+
    if(g_traceLevel < traceLevel) {
       // if the new logging level is more permissive, then set it now. log level is an observable within the 
       // log callback even though the log callback shouldn't re-enter, but we are not very trusting.
@@ -110,6 +457,10 @@ EBM_API_BODY void EBM_CALLING_CONVENTION SetTraceLevel(TraceEbm traceLevel) {
    }
 
    g_traceLevel = traceLevel;
+
+   if(traceLevel < Trace_Info) {
+      StopLogBuffering();
+   }
 }
 
 INTERNAL_IMPORT_EXPORT_BODY void InteralLogWithArguments(const TraceEbm traceLevel, const char * const sMessage, ...) {
@@ -122,21 +473,37 @@ INTERNAL_IMPORT_EXPORT_BODY void InteralLogWithArguments(const TraceEbm traceLev
       // then immedicately deallocate it, so our caller doesn't need to hold valuable stack space all the way down when calling it's offspring functions.  
       // We also don't need to allocate any stack when logging is turned off.
 
+      static const char g_sLoggingParamError[] = "Error in vsnprintf parameters for logging.";
+
+      LogRing * pRing;
+      bool bDropped;
+      LogRecord * const pRecord = BeginBufferedLog(traceLevel, &pRing, &bDropped);
+      if(bDropped) {
+         return;
+      }
+
       va_list args;
-      char messageSpace[1024];
       va_start(args, sMessage);
-      // vsnprintf specifically says that the count parameter is in bytes of buffer space, but let's be safe and assume someone might change this to a 
-      // unicode function someday and that new function might be in characters instead of bytes.  For us #bytes == #chars.  If a unicode specific version 
-      // is in bytes it won't overflow, but it will waste memory
-
-      // turn off clang-tidy warning about insecurity of vsnprintf
-      // NOLINTNEXTLINE
-      if(vsnprintf(messageSpace, sizeof(messageSpace) / sizeof(messageSpace[0]), sMessage, args) < 0) {
-         static const char g_sLoggingParamError[] = "Error in vsnprintf parameters for logging.";
-         (*g_pLogCallbackFunction)(traceLevel, g_sLoggingParamError);
+      if(NULL != pRecord) {
+         // NOLINTNEXTLINE
+         if(vsnprintf(pRecord->m_sFormatted, k_cLogRecordChars, sMessage, args) < 0) {
+            pRecord->m_sStatic = g_sLoggingParamError;
+         }
+         EndBufferedLog(pRing);
       } else {
-         // if messageSpace overflows, we clip the message, but it's still legal
-         (*g_pLogCallbackFunction)(traceLevel, messageSpace);
+         char messageSpace[1024];
+         // vsnprintf specifically says that the count parameter is in bytes of buffer space, but let's be safe and assume someone might change this to a 
+         // unicode function someday and that new function might be in characters instead of bytes.  For us #bytes == #chars.  If a unicode specific version 
+         // is in bytes it won't overflow, but it will waste memory
+
+         // turn off clang-tidy warning about insecurity of vsnprintf
+         // NOLINTNEXTLINE
+         if(vsnprintf(messageSpace, sizeof(messageSpace) / sizeof(messageSpace[0]), sMessage, args) < 0) {
+            (*g_pLogCallbackFunction)(traceLevel, g_sLoggingParamError);
+         } else {
+            // if messageSpace overflows, we clip the message, but it's still legal
+            (*g_pLogCallbackFunction)(traceLevel, messageSpace);
+         }
       }
       va_end(args);
    }
@@ -146,8 +513,40 @@ INTERNAL_IMPORT_EXPORT_BODY void InteralLogWithoutArguments(const TraceEbm trace
    assert(NULL != g_pLogCallbackFunction);
    // it is illegal for g_pLogCallbackFunction to be NULL at this point, but in the interest of not crashing check it
    if(NULL != g_pLogCallbackFunction) {
-      (*g_pLogCallbackFunction)(traceLevel, sMessage);
+      LogRing * pRing;
+      bool bDropped;
+      LogRecord * const pRecord = BeginBufferedLog(traceLevel, &pRing, &bDropped);
+      if(NULL != pRecord) {
+         pRecord->m_sStatic = sMessage;
+         EndBufferedLog(pRing);
+      } else if(!bDropped) {
+         (*g_pLogCallbackFunction)(traceLevel, sMessage);
+      }
+   }
+}
+
+INTERNAL_IMPORT_EXPORT_BODY BoolEbm InteralLogCountDecrement(int * const pLogCount) {
+#if defined(_MSC_VER)
+   static_assert(sizeof(long) == sizeof(int), "_InterlockedCompareExchange works on long");
+   volatile long * const pCount = reinterpret_cast<volatile long *>(pLogCount);
+   long count = *pCount;
+   while(0 < count) {
+      const long countPrev = _InterlockedCompareExchange(pCount, count - 1, count);
+      if(countPrev == count) {
+         return EBM_TRUE;
+      }
+      count = countPrev;
+   }
+#else // _MSC_VER
+   int count = __atomic_load_n(pLogCount, __ATOMIC_RELAXED);
+   while(0 < count) {
+      // on failure count is reloaded with the current value
+      if(__atomic_compare_exchange_n(pLogCount, &count, count - 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+         return EBM_TRUE;
+      }
    }
+#endif // _MSC_VER
+   return EBM_FALSE;
 }
 
 INTERNAL_IMPORT_EXPORT_BODY void LogAssertFailure(
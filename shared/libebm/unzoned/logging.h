@@ -54,8 +54,17 @@ inline static const char * ObtainTruth(const BoolEbm b) {
 
 INTERNAL_EXPORT_VAR_INCLUDE TraceEbm g_traceLevel;
 
+// LOG calls above this trace level are compiled out. zones.h lowers it to Trace_Warning in the compute zones when
+// building with LOG_ELIDE_COMPUTE, so their hot loops have no Trace_Info or Trace_Verbose checks left in them.
+#ifndef LOG_TRACE_LEVEL_COMPILED
+#define LOG_TRACE_LEVEL_COMPILED Trace_Verbose
+#endif // LOG_TRACE_LEVEL_COMPILED
+
 INTERNAL_IMPORT_EXPORT_INCLUDE void InteralLogWithArguments(const TraceEbm traceLevel, const char * const sMessage, ...);
 INTERNAL_IMPORT_EXPORT_INCLUDE void InteralLogWithoutArguments(const TraceEbm traceLevel, const char * const sMessage);
+// atomically decrements *pLogCount if it is above zero, and returns EBM_FALSE if it was already zero. The counts
+// live in objects like Term that are shared by the views, so several threads can be counting the same messages.
+INTERNAL_IMPORT_EXPORT_INCLUDE BoolEbm InteralLogCountDecrement(int * const pLogCount);
 INTERNAL_IMPORT_EXPORT_INCLUDE void LogAssertFailure(
    const unsigned long long lineNumber,
    const char * const sFileName,
@@ -95,7 +104,7 @@ INTERNAL_IMPORT_EXPORT_INCLUDE void LogAssertFailure(
       const TraceEbm LOG__traceLevel = (traceLevel); \
       static_assert(Trace_Off < LOG__traceLevel, "traceLevel can't be Trace_Off or lower for call to LOG_0(traceLevel, sMessage, ...)"); \
       static_assert(LOG__traceLevel <= Trace_Verbose, "traceLevel can't be higher than Trace_Verbose for call to LOG_0(traceLevel, sMessage, ...)"); \
-      if(LOG__traceLevel <= g_traceLevel) { \
+      if(LOG__traceLevel <= LOG_TRACE_LEVEL_COMPILED && LOG__traceLevel <= g_traceLevel) { \
          static const char LOG__sMessage[] = (sMessage); \
          InteralLogWithoutArguments(LOG__traceLevel, LOG__sMessage); \
       } \
@@ -107,7 +116,7 @@ INTERNAL_IMPORT_EXPORT_INCLUDE void LogAssertFailure(
       static_assert(Trace_Off < LOG__traceLevel, "traceLevel can't be Trace_Off or lower for call to LOG_N(traceLevel, sMessage, ...)"); \
       static_assert(LOG__traceLevel <= Trace_Verbose, \
          "traceLevel can't be higher than Trace_Verbose for call to LOG_N(traceLevel, sMessage, ...)"); \
-      if(LOG__traceLevel <= g_traceLevel) { \
+      if(LOG__traceLevel <= LOG_TRACE_LEVEL_COMPILED && LOG__traceLevel <= g_traceLevel) { \
          static const char LOG__sMessage[] = (sMessage); \
          InteralLogWithArguments(LOG__traceLevel, LOG__sMessage, __VA_ARGS__); \
       } \
@@ -128,16 +137,13 @@ INTERNAL_IMPORT_EXPORT_INCLUDE void LogAssertFailure(
       static_assert(LOG__traceLevelBefore < LOG__traceLevelAfter, \
          "We only support increasing the required trace level after N iterations. It doesn't make sense to have equal values, otherwise just use LOG_0(..)"); \
       const TraceEbm LOG__traceLevel = g_traceLevel; \
-      if(LOG__traceLevelBefore <= LOG__traceLevel) { \
+      if(LOG__traceLevelBefore <= LOG_TRACE_LEVEL_COMPILED && LOG__traceLevelBefore <= LOG__traceLevel) { \
          do { \
             TraceEbm LOG__traceLevelLogging; \
-            if(LOG__traceLevel < LOG__traceLevelAfter) { \
-               int * const LOG__pLogCountDecrement = (pLogCountDecrement); \
-               const int LOG__logCount = *LOG__pLogCountDecrement - 1; \
-               if(LOG__logCount < 0) { \
+            if(LOG__traceLevel < LOG__traceLevelAfter || LOG_TRACE_LEVEL_COMPILED < LOG__traceLevelAfter) { \
+               if(EBM_FALSE == InteralLogCountDecrement(pLogCountDecrement)) { \
                   break; \
                } \
-               *LOG__pLogCountDecrement = LOG__logCount; \
                LOG__traceLevelLogging = LOG__traceLevelBefore; \
             } else { \
                LOG__traceLevelLogging = LOG__traceLevelAfter; \
@@ -163,16 +169,13 @@ INTERNAL_IMPORT_EXPORT_INCLUDE void LogAssertFailure(
       static_assert(LOG__traceLevelBefore < LOG__traceLevelAfter, \
          "We only support increasing the required trace level after N iterations and it doesn't make sense to have equal values, otherwise just use LOG_N(...)"); \
       const TraceEbm LOG__traceLevel = g_traceLevel; \
-      if(LOG__traceLevelBefore <= LOG__traceLevel) { \
+      if(LOG__traceLevelBefore <= LOG_TRACE_LEVEL_COMPILED && LOG__traceLevelBefore <= LOG__traceLevel) { \
          do { \
             TraceEbm LOG__traceLevelLogging; \
-            if(LOG__traceLevel < LOG__traceLevelAfter) { \
-               int * const LOG__pLogCountDecrement = (pLogCountDecrement); \
-               const int LOG__logCount = *LOG__pLogCountDecrement - 1; \
-               if(LOG__logCount < 0) { \
+            if(LOG__traceLevel < LOG__traceLevelAfter || LOG_TRACE_LEVEL_COMPILED < LOG__traceLevelAfter) { \
+               if(EBM_FALSE == InteralLogCountDecrement(pLogCountDecrement)) { \
                   break; \
                } \
-               *LOG__pLogCountDecrement = LOG__logCount; \
                LOG__traceLevelLogging = LOG__traceLevelBefore; \
             } else { \
                LOG__traceLevelLogging = LOG__traceLevelAfter; \